@@ -1857,6 +1857,65 @@ TEST_F(TestReadOperationWithConnectedSessionNoClient, AwaServerReadResponse_GetV
     AwaClientSession_Free(&clientSession);
 }
 
+TEST_F(TestReadOperationWithConnectedSessionNoClient, AwaServerReadResponse_GetValueAsOpaque_handles_blockwise_transfer)
+{
+    // start a client and wait for them to register with the server
+    AwaClientDaemonHorde horde( { "TestClient1" }, 61000);
+    ASSERT_TRUE(WaitForRegistration(session_, horde.GetClientIDs(), 1000));
+
+    AwaOpaque defaultValue = { NULL, 0 };
+
+    AwaClientSession * clientSession = AwaClientSession_New();
+    EXPECT_EQ(AwaError_Success, AwaClientSession_SetIPCAsUDP(clientSession, "127.0.0.1", 61000));
+    EXPECT_EQ(AwaError_Success, AwaClientSession_Connect(clientSession));
+
+    AwaObjectDefinition * objectDefinition = AwaObjectDefinition_New(1000, "TestObject1000", 1, 1);
+    EXPECT_EQ(AwaError_Success, AwaObjectDefinition_AddResourceDefinitionAsOpaque(objectDefinition, 0, "Resource0", true, AwaResourceOperations_ReadOnly, defaultValue));
+
+    AwaClientDefineOperation * clientDefineOperation = AwaClientDefineOperation_New(clientSession);  ASSERT_TRUE(NULL != clientDefineOperation);
+    AwaClientDefineOperation_Add(clientDefineOperation, objectDefinition);
+    EXPECT_EQ(AwaError_Success, AwaClientDefineOperation_Perform(clientDefineOperation, global::timeout));
+    AwaClientDefineOperation_Free(&clientDefineOperation);
+
+    AwaServerDefineOperation * serverDefineOperation = AwaServerDefineOperation_New(session_);       ASSERT_TRUE(NULL != serverDefineOperation);
+    AwaServerDefineOperation_Add(serverDefineOperation, objectDefinition);
+    EXPECT_EQ(AwaError_Success, AwaServerDefineOperation_Perform(serverDefineOperation, global::timeout));
+    AwaServerDefineOperation_Free(&serverDefineOperation);
+    AwaObjectDefinition_Free(&objectDefinition);
+
+    // several times larger than a single CoAP block
+    uint8_t expectedData[3000];
+    for (size_t i = 0; i < sizeof(expectedData); i++)
+    {
+        expectedData[i] = i % 251;
+    }
+    AwaOpaque opaque = { (void *)expectedData, sizeof(expectedData) };
+
+    AwaClientSetOperation * setOperation = AwaClientSetOperation_New(clientSession);
+    ASSERT_TRUE(NULL != setOperation);
+    EXPECT_EQ(AwaError_Success, AwaClientSetOperation_CreateObjectInstance(setOperation, "/1000/0"));
+    EXPECT_EQ(AwaError_Success, AwaClientSetOperation_AddValueAsOpaque(setOperation, "/1000/0/0", opaque));
+    EXPECT_EQ(AwaError_Success, AwaClientSetOperation_Perform(setOperation, global::timeout));
+    AwaClientSetOperation_Free(&setOperation);
+
+    AwaServerReadOperation * operation = AwaServerReadOperation_New(session_);
+    ASSERT_TRUE(NULL != operation);
+    EXPECT_EQ(AwaError_Success, AwaServerReadOperation_AddPath(operation, "TestClient1", "/1000/0/0"));
+    EXPECT_EQ(AwaError_Success, AwaServerReadOperation_Perform(operation, global::timeout));
+    const AwaServerReadResponse * response = AwaServerReadOperation_GetResponse(operation, "TestClient1");
+    ASSERT_TRUE(NULL != response);
+
+    AwaOpaque value = { 0 };
+    ASSERT_EQ(AwaError_Success, AwaServerReadResponse_GetValueAsOpaque(response, "/1000/0/0", &value));
+    EXPECT_EQ(opaque.Size, value.Size);
+    ASSERT_TRUE(NULL != value.Data);
+    EXPECT_EQ(0, std::memcmp(expectedData, value.Data, sizeof(expectedData)));
+    AwaServerReadOperation_Free(&operation);
+
+    AwaClientSession_Disconnect(clientSession);
+    AwaClientSession_Free(&clientSession);
+}
+
 TEST_F(TestReadOperationWithConnectedSessionNoClient, AwaServerReadResponse_GetValueAsIntegerPointer_handles_valid_opaque_path)
 {
     // start a client and wait for them to register with the server
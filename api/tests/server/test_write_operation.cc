@@ -297,6 +297,48 @@ TEST_F(TestWriteOperationWithConnectedServerAndClientSession, AwaServerWriteOper
     AwaServerWriteOperation_Free(&writeOperation);
 }
 
+TEST_F(TestWriteOperationWithConnectedServerAndClientSession, AwaServerWriteOperation_Perform_handles_blockwise_opaque_write)
+{
+    ObjectDescription object = { 1000, "Object1000", 0, 1, {
+            ResourceDescription(0, "Resource0", AwaResourceType_Opaque, 0, 1, AwaResourceOperations_ReadWrite),
+        }};
+    EXPECT_EQ(AwaError_Success, Define(client_session_, object));
+    EXPECT_EQ(AwaError_Success, Define(server_session_, object));
+
+    WaitForClientDefinition(AwaObjectDefinition_GetID(object.GetDefinition()));
+
+    AwaClientSetOperation * setOperation = AwaClientSetOperation_New(client_session_);
+    EXPECT_TRUE(setOperation != NULL);
+    EXPECT_EQ(AwaError_Success, AwaClientSetOperation_CreateObjectInstance(setOperation, "/1000/0"));
+    EXPECT_EQ(AwaError_Success, AwaClientSetOperation_Perform(setOperation, global::timeout));
+    AwaClientSetOperation_Free(&setOperation);
+
+    // several times larger than a single CoAP block
+    uint8_t expectedData[3000];
+    for (size_t i = 0; i < sizeof(expectedData); i++)
+    {
+        expectedData[i] = i % 253;
+    }
+    AwaOpaque opaque = { (void *)expectedData, sizeof(expectedData) };
+
+    AwaServerWriteOperation * writeOperation = AwaServerWriteOperation_New(server_session_, AwaWriteMode_Update); ASSERT_TRUE(NULL != writeOperation);
+    EXPECT_EQ(AwaError_Success, AwaServerWriteOperation_AddValueAsOpaque(writeOperation, "/1000/0/0", opaque));
+    EXPECT_EQ(AwaError_Success, AwaServerWriteOperation_Perform(writeOperation, global::clientEndpointName, global::timeout));
+    AwaServerWriteOperation_Free(&writeOperation);
+
+    AwaClientGetOperation * getOperation = AwaClientGetOperation_New(client_session_); ASSERT_TRUE(NULL != getOperation);
+    EXPECT_EQ(AwaError_Success, AwaClientGetOperation_AddPath(getOperation, "/1000/0/0"));
+    EXPECT_EQ(AwaError_Success, AwaClientGetOperation_Perform(getOperation, global::timeout));
+    const AwaClientGetResponse * getResponse = AwaClientGetOperation_GetResponse(getOperation); ASSERT_TRUE(NULL != getResponse);
+
+    AwaOpaque value = { 0 };
+    ASSERT_EQ(AwaError_Success, AwaClientGetResponse_GetValueAsOpaque(getResponse, "/1000/0/0", &value));
+    EXPECT_EQ(opaque.Size, value.Size);
+    ASSERT_TRUE(NULL != value.Data);
+    EXPECT_EQ(0, memcmp(expectedData, value.Data, sizeof(expectedData)));
+    AwaClientGetOperation_Free(&getOperation);
+}
+
 TEST_F(TestWriteOperationWithConnectedServerAndClientSession, AwaServerWriteOperation_Perform_put_existing_object_instance_should_succeed)
 {
     ObjectDescription object = { 1000, "Object1000", 0, 1,
@@ -0,0 +1,217 @@
+/************************************************************************************************************************
+ Copyright (c) 2016, Imagination Technologies Limited and/or its affiliated group companies.
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+ following conditions are met:
+     1. Redistributions of source code must retain the above copyright notice, this list of conditions and the
+        following disclaimer.
+     2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the
+        following disclaimer in the documentation and/or other materials provided with the distribution.
+     3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote
+        products derived from this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+ USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+************************************************************************************************************************/
+
+
+/* Supported-object index benchmark: gives a large number of synthetic clients a typical IPSO-heavy
+ * object list and reports heap used per client and the cost of Lwm2m_ClientSupportsObject-style
+ * lookups. A linked list of malloc'd entries, as used before the compact index, is measured for comparison.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <malloc.h>
+
+#include "lwm2m_list.h"
+#include "lwm2m_object_list.h"
+
+#define DEFAULT_NUM_CLIENTS (100000)
+#define NUM_LOOKUPS         (1000000)
+
+typedef struct
+{
+    struct ListHead list;
+    ObjectIDType ObjectID;
+    ObjectInstanceIDType InstanceID;
+} LinkedObjectListEntry;
+
+typedef struct
+{
+    ObjectIDType ObjectID;
+    int NumInstances;          // 0 for an object without instances
+} ReportedObject;
+
+// Device management objects plus a sensor gateway's worth of IPSO objects
+static const ReportedObject reportedObjects[] =
+{
+    { 1, 1 }, { 2, 4 }, { 3, 1 }, { 4, 1 }, { 5, 0 }, { 6, 1 }, { 7, 0 },
+    { 3303, 8 }, { 3304, 4 }, { 3311, 4 }, { 3315, 2 }, { 3200, 2 }, { 3201, 2 },
+};
+
+static double NowNs(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static size_t HeapInUse(void)
+{
+    return mallinfo2().uordblks;
+}
+
+static int NumEntries(void)
+{
+    int entries = 0;
+    size_t i;
+    for (i = 0; i < sizeof(reportedObjects) / sizeof(reportedObjects[0]); i++)
+    {
+        entries += (reportedObjects[i].NumInstances > 0) ? reportedObjects[i].NumInstances : 1;
+    }
+    return entries;
+}
+
+static void BuildLinkedList(struct ListHead * list)
+{
+    size_t i;
+    int instance;
+    ListInit(list);
+    for (i = 0; i < sizeof(reportedObjects) / sizeof(reportedObjects[0]); i++)
+    {
+        for (instance = (reportedObjects[i].NumInstances > 0) ? 0 : -1; instance < reportedObjects[i].NumInstances || instance == -1; instance++)
+        {
+            LinkedObjectListEntry * entry = malloc(sizeof(LinkedObjectListEntry));
+            entry->ObjectID = reportedObjects[i].ObjectID;
+            entry->InstanceID = instance;
+            ListAdd(&entry->list, list);
+            if (instance == -1)
+            {
+                break;
+            }
+        }
+    }
+}
+
+static bool LinkedListContains(struct ListHead * list, ObjectIDType objectID, ObjectInstanceIDType instanceID)
+{
+    struct ListHead * i;
+    ListForEach(i, list)
+    {
+        LinkedObjectListEntry * entry = ListEntry(i, LinkedObjectListEntry, list);
+        if ((entry->ObjectID == objectID) && ((entry->InstanceID == instanceID) || (instanceID == -1)))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+static void FreeLinkedList(struct ListHead * list)
+{
+    struct ListHead * i, * n;
+    ListForEachSafe(i, n, list)
+    {
+        LinkedObjectListEntry * entry = ListEntry(i, LinkedObjectListEntry, list);
+        free(entry);
+    }
+}
+
+static void BuildObjectList(ObjectList * list)
+{
+    size_t i;
+    int instance;
+    ObjectList_Init(list);
+    // add in reverse to exercise sorting
+    for (i = sizeof(reportedObjects) / sizeof(reportedObjects[0]); i-- > 0; )
+    {
+        if (reportedObjects[i].NumInstances == 0)
+        {
+            ObjectList_Add(list, reportedObjects[i].ObjectID, -1);
+        }
+        for (instance = 0; instance < reportedObjects[i].NumInstances; instance++)
+        {
+            ObjectList_Add(list, reportedObjects[i].ObjectID, instance);
+        }
+    }
+    ObjectList_Finalise(list);
+}
+
+int main(int argc, char ** argv)
+{
+    int numClients = (argc > 1) ? atoi(argv[1]) : DEFAULT_NUM_CLIENTS;
+    size_t numObjects = sizeof(reportedObjects) / sizeof(reportedObjects[0]);
+    int found = 0;
+    int i;
+    size_t before;
+    double start;
+
+    if (numClients <= 0)
+    {
+        fprintf(stderr, "Usage: %s [number of clients]\n", argv[0]);
+        return 1;
+    }
+
+    struct ListHead * linkedLists = malloc(numClients * sizeof(struct ListHead));
+    ObjectList * objectLists = malloc(numClients * sizeof(ObjectList));
+    if ((linkedLists == NULL) || (objectLists == NULL))
+    {
+        fprintf(stderr, "Out of memory\n");
+        return 1;
+    }
+
+    printf("%d clients, %d object list entries per client\n", numClients, NumEntries());
+
+    before = HeapInUse();
+    for (i = 0; i < numClients; i++)
+    {
+        BuildLinkedList(&linkedLists[i]);
+    }
+    printf("Linked list:  %8.1f heap bytes/client\n", (double)(HeapInUse() - before) / numClients);
+
+    before = HeapInUse();
+    for (i = 0; i < numClients; i++)
+    {
+        BuildObjectList(&objectLists[i]);
+    }
+    printf("Object index: %8.1f heap bytes/client (+%zu bytes inline)\n", (double)(HeapInUse() - before) / numClients, sizeof(ObjectList));
+
+    start = NowNs();
+    for (i = 0; i < NUM_LOOKUPS; i++)
+    {
+        const ReportedObject * object = &reportedObjects[i % numObjects];
+        found += LinkedListContains(&linkedLists[i % numClients], object->ObjectID, object->NumInstances - 1);
+    }
+    printf("Linked list lookup:  %.1f ns/lookup\n", (NowNs() - start) / NUM_LOOKUPS);
+
+    start = NowNs();
+    for (i = 0; i < NUM_LOOKUPS; i++)
+    {
+        const ReportedObject * object = &reportedObjects[i % numObjects];
+        found -= ObjectList_Contains(&objectLists[i % numClients], object->ObjectID, object->NumInstances - 1);
+    }
+    printf("Object index lookup: %.1f ns/lookup\n", (NowNs() - start) / NUM_LOOKUPS);
+
+    for (i = 0; i < numClients; i++)
+    {
+        FreeLinkedList(&linkedLists[i]);
+        ObjectList_Free(&objectLists[i]);
+    }
+    free(linkedLists);
+    free(objectLists);
+
+    if (found != 0)
+    {
+        fprintf(stderr, "Lookup results differ between representations\n");
+    }
+    return (found == 0) ? 0 : 1;
+}
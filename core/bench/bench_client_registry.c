@@ -0,0 +1,158 @@
+/************************************************************************************************************************
+ Copyright (c) 2016, Imagination Technologies Limited and/or its affiliated group companies.
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+ following conditions are met:
+     1. Redistributions of source code must retain the above copyright notice, this list of conditions and the
+        following disclaimer.
+     2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the
+        following disclaimer in the documentation and/or other materials provided with the distribution.
+     3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote
+        products derived from this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+ USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+************************************************************************************************************************/
+
+
+/* Client registry benchmark: registers a large number of synthetic clients in the server's
+ * client registry and reports the cost of name, location and address lookups. A linear walk of
+ * the client list, as used before the registry was indexed, is timed for comparison.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <arpa/inet.h>
+
+#include "lwm2m_registration.h"
+#include "lwm2m_client_registry.h"
+
+#define DEFAULT_NUM_CLIENTS (100000)
+#define NUM_LINEAR_LOOKUPS  (1000)
+
+static double NowNs(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static void MakeAddress(AddressType * address, int index)
+{
+    memset(address, 0, sizeof(*address));
+    address->Size = sizeof(struct sockaddr_in);
+    address->Addr.Sin.sin_family = AF_INET;
+    address->Addr.Sin.sin_port = htons(1024 + (index % 60000));
+    address->Addr.Sin.sin_addr.s_addr = htonl(0x0a000000 | (index / 60000));
+}
+
+static Lwm2mClientType * LinearLookupByName(struct ListHead * clientList, const char * endPointName)
+{
+    struct ListHead * i;
+    ListForEach(i, clientList)
+    {
+        Lwm2mClientType * c = ListEntry(i, Lwm2mClientType, list);
+        if (strcmp(c->EndPointName, endPointName) == 0)
+        {
+            return c;
+        }
+    }
+    return NULL;
+}
+
+int main(int argc, char ** argv)
+{
+    int numClients = (argc > 1) ? atoi(argv[1]) : DEFAULT_NUM_CLIENTS;
+    int misses = 0;
+    int i;
+    char name[32];
+    double start;
+
+    if (numClients <= 0)
+    {
+        fprintf(stderr, "Usage: %s [number of clients]\n", argv[0]);
+        return 1;
+    }
+
+    ClientRegistry * registry = ClientRegistry_Create();
+    Lwm2mClientType * clients = calloc(numClients, sizeof(Lwm2mClientType));
+    if ((registry == NULL) || (clients == NULL))
+    {
+        fprintf(stderr, "Out of memory\n");
+        return 1;
+    }
+
+    start = NowNs();
+    for (i = 0; i < numClients; i++)
+    {
+        snprintf(name, sizeof(name), "client-%d", i);
+        clients[i].EndPointName = strdup(name);
+        clients[i].Location = i + 1;
+        MakeAddress(&clients[i].Address, i);
+        ObjectList_Init(&clients[i].Objects);
+        if (ClientRegistry_Add(registry, &clients[i]) != 0)
+        {
+            fprintf(stderr, "Failed to add client %d\n", i);
+            return 1;
+        }
+    }
+    printf("Registered %d clients: %.1f ns/registration\n", numClients, (NowNs() - start) / numClients);
+
+    start = NowNs();
+    for (i = 0; i < numClients; i++)
+    {
+        snprintf(name, sizeof(name), "client-%d", i);
+        misses += (ClientRegistry_LookupByName(registry, name) != &clients[i]);
+    }
+    printf("Lookup by name:     %.1f ns/lookup\n", (NowNs() - start) / numClients);
+
+    start = NowNs();
+    for (i = 0; i < numClients; i++)
+    {
+        misses += (ClientRegistry_LookupByLocation(registry, i + 1) != &clients[i]);
+    }
+    printf("Lookup by location: %.1f ns/lookup\n", (NowNs() - start) / numClients);
+
+    start = NowNs();
+    for (i = 0; i < numClients; i++)
+    {
+        AddressType address;
+        MakeAddress(&address, i);
+        misses += (ClientRegistry_LookupByAddress(registry, &address) != &clients[i]);
+    }
+    printf("Lookup by address:  %.1f ns/lookup\n", (NowNs() - start) / numClients);
+
+    start = NowNs();
+    for (i = 0; i < NUM_LINEAR_LOOKUPS; i++)
+    {
+        int index = (int)(((long long)i * numClients) / NUM_LINEAR_LOOKUPS);
+        snprintf(name, sizeof(name), "client-%d", index);
+        misses += (LinearLookupByName(ClientRegistry_GetClientList(registry), name) != &clients[index]);
+    }
+    printf("Linear list walk:   %.1f ns/lookup (for comparison)\n", (NowNs() - start) / NUM_LINEAR_LOOKUPS);
+
+    start = NowNs();
+    for (i = 0; i < numClients; i++)
+    {
+        ClientRegistry_Remove(registry, &clients[i]);
+        free(clients[i].EndPointName);
+    }
+    printf("Deregistered %d clients: %.1f ns/deregistration\n", numClients, (NowNs() - start) / numClients);
+
+    if (misses != 0)
+    {
+        fprintf(stderr, "%d lookups returned the wrong client\n", misses);
+    }
+
+    free(clients);
+    ClientRegistry_Destroy(registry);
+    return (misses == 0) ? 0 : 1;
+}
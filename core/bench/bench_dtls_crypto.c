@@ -0,0 +1,207 @@
+/************************************************************************************************************************
+ Copyright (c) 2016, Imagination Technologies Limited and/or its affiliated group companies.
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+ following conditions are met:
+     1. Redistributions of source code must retain the above copyright notice, this list of conditions and the
+        following disclaimer.
+     2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the
+        following disclaimer in the documentation and/or other materials provided with the distribution.
+     3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote
+        products derived from this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+ USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+************************************************************************************************************************/
+
+/* DTLS record benchmark: establishes one PSK session in-process over a loopback datagram queue, then
+ * reports the per-packet cost of encrypting application data and of decrypting it, for a range of
+ * payload sizes. Decryption is timed both in place, as the network layer now does it, and into a
+ * separate buffer followed by a copy back, as it did through the old shared static buffer.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "lwm2m_debug.h"
+#include "dtls_abstraction.h"
+
+#define DEFAULT_NUM_PACKETS    (100000)
+#define MAX_DATAGRAMS          (32)
+#define MAX_DATAGRAM_SIZE      (2048)
+#define MAX_DELIVERIES         (64)
+#define MAX_PAYLOAD_SIZE       (1024)
+
+typedef struct
+{
+    NetworkAddress * Source;
+    int Length;
+    uint8_t Data[MAX_DATAGRAM_SIZE];
+} Datagram;
+
+static Datagram queue[MAX_DATAGRAMS];
+static int queueHead;
+static int queueCount;
+
+static NetworkAddress * clientAddress;
+static NetworkAddress * serverAddress;
+
+static const uint8_t pskKey[] = { 0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f };
+static const int payloadSizes[] = { 16, 64, 256, 512, MAX_PAYLOAD_SIZE };
+
+static double NowNs(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static NetworkAddress * NewAddress(int port)
+{
+    char uri[64];
+    sprintf(uri, "coaps://127.0.0.1:%d", port);
+    return NetworkAddress_New(uri, strlen(uri));
+}
+
+// Datagrams sent to the server arrive from the client, and the client only talks to the server
+static NetworkTransmissionError LoopbackSend(NetworkAddress * destAddress, const uint8_t * buffer, int bufferLength, void * context)
+{
+    (void)context;
+    if ((queueCount < MAX_DATAGRAMS) && (bufferLength <= MAX_DATAGRAM_SIZE))
+    {
+        Datagram * datagram = &queue[(queueHead + queueCount) % MAX_DATAGRAMS];
+        datagram->Source = (destAddress == serverAddress) ? clientAddress : serverAddress;
+        datagram->Length = bufferLength;
+        memcpy(datagram->Data, buffer, bufferLength);
+        queueCount++;
+    }
+    return NetworkTransmissionError_None;
+}
+
+static bool Connect(void)
+{
+    uint8_t plainText[] = "ping";
+    uint8_t encrypted[MAX_DATAGRAM_SIZE];
+    uint8_t decrypted[MAX_DATAGRAM_SIZE];
+    int length;
+    int deliveries;
+
+    DTLS_Encrypt(serverAddress, plainText, sizeof(plainText), encrypted, sizeof(encrypted), &length, NULL);
+    for (deliveries = 0; (queueCount > 0) && (deliveries < MAX_DELIVERIES); deliveries++)
+    {
+        Datagram * datagram = &queue[queueHead];
+        queueHead = (queueHead + 1) % MAX_DATAGRAMS;
+        queueCount--;
+        DTLS_Decrypt(datagram->Source, datagram->Data, datagram->Length, decrypted, sizeof(decrypted), &length, NULL);
+    }
+    queueHead = queueCount = 0;
+
+    // the handshake is complete once the server has accepted application data from the client
+    return DTLS_Encrypt(serverAddress, plainText, sizeof(plainText), encrypted, sizeof(encrypted), &length, NULL) &&
+           DTLS_Decrypt(clientAddress, encrypted, length, decrypted, sizeof(decrypted), &length, NULL);
+}
+
+// Encrypt then decrypt numPackets records of payloadSize bytes; returns the number that round-tripped intact
+static int RunPackets(int numPackets, int payloadSize, bool inPlace, double * encryptNs, double * decryptNs)
+{
+    uint8_t plainText[MAX_PAYLOAD_SIZE];
+    uint8_t record[MAX_PAYLOAD_SIZE + DTLS_MAX_RECORD_OVERHEAD];
+    uint8_t decrypted[MAX_PAYLOAD_SIZE + DTLS_MAX_RECORD_OVERHEAD];
+    int intact = 0;
+    int i;
+
+    memset(plainText, 0x5a, payloadSize);
+    *encryptNs = 0;
+    *decryptNs = 0;
+    for (i = 0; i < numPackets; i++)
+    {
+        int recordLength = 0;
+        int decryptedLength = 0;
+        plainText[0] = (uint8_t)i;
+
+        double start = NowNs();
+        if (!DTLS_Encrypt(serverAddress, plainText, payloadSize, record, payloadSize + DTLS_MAX_RECORD_OVERHEAD, &recordLength, NULL))
+        {
+            continue;
+        }
+        double encrypted = NowNs();
+        if (inPlace)
+        {
+            DTLS_Decrypt(clientAddress, record, recordLength, record, sizeof(record), &decryptedLength, NULL);
+        }
+        else if (DTLS_Decrypt(clientAddress, record, recordLength, decrypted, sizeof(decrypted), &decryptedLength, NULL) && (decryptedLength > 0))
+        {
+            memcpy(record, decrypted, decryptedLength);
+        }
+        double decryptedAt = NowNs();
+
+        *encryptNs += encrypted - start;
+        *decryptNs += decryptedAt - encrypted;
+        if ((decryptedLength == payloadSize) && (memcmp(record, plainText, payloadSize) == 0))
+        {
+            intact++;
+        }
+    }
+    *encryptNs /= numPackets;
+    *decryptNs /= numPackets;
+    return intact;
+}
+
+int main(int argc, char ** argv)
+{
+    int numPackets = (argc > 1) ? atoi(argv[1]) : DEFAULT_NUM_PACKETS;
+    int result = 0;
+    int i;
+
+    if (numPackets <= 0)
+    {
+        fprintf(stderr, "Usage: %s [number of packets]\n", argv[0]);
+        return 1;
+    }
+
+    Lwm2m_SetLogLevel(DebugLevel_Warning);
+    DTLS_Init();
+    DTLS_SetNetworkSendCallback(LoopbackSend);
+    DTLS_SetPSK("bench", pskKey, sizeof(pskKey));
+    clientAddress = NewAddress(40000);
+    serverAddress = NewAddress(5684);
+
+    if (Connect())
+    {
+        printf("%s, %d packets per payload size\n", DTLS_LibraryName, numPackets);
+        printf("%8s %14s %18s %18s %10s\n", "payload", "encrypt ns", "decrypt+copy ns", "in-place ns", "intact");
+        for (i = 0; i < (int)(sizeof(payloadSizes) / sizeof(payloadSizes[0])); i++)
+        {
+            double encryptNs;
+            double copyNs;
+            double inPlaceNs;
+            RunPackets(numPackets, payloadSizes[i], false, &encryptNs, &copyNs);
+            int intact = RunPackets(numPackets, payloadSizes[i], true, &encryptNs, &inPlaceNs);
+            printf("%8d %14.0f %18.0f %18.0f %5d/%d\n", payloadSizes[i], encryptNs, copyNs, inPlaceNs, intact, numPackets);
+            if (intact != numPackets)
+            {
+                result = 1;
+            }
+        }
+    }
+    else
+    {
+        fprintf(stderr, "Failed to establish a DTLS session\n");
+        result = 1;
+    }
+
+    DTLS_Reset(serverAddress);
+    DTLS_Reset(clientAddress);
+    NetworkAddress_Free(&serverAddress);
+    NetworkAddress_Free(&clientAddress);
+    DTLS_Shutdown();
+    return result;
+}
@@ -0,0 +1,237 @@
+/************************************************************************************************************************
+ Copyright (c) 2016, Imagination Technologies Limited and/or its affiliated group companies.
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+ following conditions are met:
+     1. Redistributions of source code must retain the above copyright notice, this list of conditions and the
+        following disclaimer.
+     2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the
+        following disclaimer in the documentation and/or other materials provided with the distribution.
+     3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote
+        products derived from this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+ USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+************************************************************************************************************************/
+
+/* DTLS handshake storm benchmark: many clients start certificate handshakes with one server at once,
+ * all in-process over a loopback datagram queue. For the server side it reports the longest time a
+ * single DTLS_Decrypt call held the caller, which is how long a daemon's main loop would stop serving
+ * other traffic, and the total time spent in those calls; first with handshakes run inline, then on a
+ * pool of worker threads.
+ */
+
+#include <poll.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "lwm2m_debug.h"
+#include "dtls_abstraction.h"
+#include "lwm2m_server_cert.h"
+
+#define DEFAULT_NUM_CLIENTS    (200)
+#define DEFAULT_NUM_WORKERS    (2)
+#define MAX_DATAGRAMS          (4096)
+#define MAX_DATAGRAM_SIZE      (2048)
+
+typedef struct
+{
+    NetworkAddress * Source;
+    NetworkAddress * Destination;
+    int Length;
+    uint8_t Data[MAX_DATAGRAM_SIZE];
+} Datagram;
+
+static Datagram * queue;
+static int queueHead;
+static int queueCount;
+
+static int numClients;
+static NetworkAddress ** clientAddresses;
+static NetworkAddress ** serverAddresses;
+
+// Marks DTLS_Decrypt calls made for the server, so replies are routed back to the right client
+static int serverContext;
+
+static double NowNs(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static NetworkAddress * NewAddress(int port)
+{
+    char uri[64];
+    sprintf(uri, "coaps://127.0.0.1:%d", port);
+    return NetworkAddress_New(uri, strlen(uri));
+}
+
+// Each client talks to its own server address, so client and server sessions never share a table key
+static NetworkTransmissionError LoopbackSend(NetworkAddress * destAddress, const uint8_t * buffer, int bufferLength, void * context)
+{
+    (void)context;
+    if ((queueCount < MAX_DATAGRAMS) && (bufferLength <= MAX_DATAGRAM_SIZE))
+    {
+        int i;
+        for (i = 0; i < numClients; i++)
+        {
+            if ((destAddress == serverAddresses[i]) || (destAddress == clientAddresses[i]))
+            {
+                Datagram * datagram = &queue[(queueHead + queueCount) % MAX_DATAGRAMS];
+                datagram->Destination = destAddress;
+                datagram->Source = (destAddress == serverAddresses[i]) ? clientAddresses[i] : serverAddresses[i];
+                datagram->Length = bufferLength;
+                memcpy(datagram->Data, buffer, bufferLength);
+                queueCount++;
+                break;
+            }
+        }
+    }
+    return NetworkTransmissionError_None;
+}
+
+static bool IsServerAddress(NetworkAddress * address)
+{
+    int i;
+    for (i = 0; i < numClients; i++)
+    {
+        if (address == serverAddresses[i])
+            return true;
+    }
+    return false;
+}
+
+// Start every client's handshake, then deliver datagrams until the storm is over. Returns the number of clients
+// that can send application data afterwards.
+static int RunStorm(int handshakeFd, double * longestStallNs, double * busyNs)
+{
+    uint8_t plainText[] = "ping";
+    uint8_t encrypted[MAX_DATAGRAM_SIZE];
+    uint8_t decrypted[MAX_DATAGRAM_SIZE];
+    int length;
+    int connected = 0;
+    int i;
+
+    *longestStallNs = 0;
+    *busyNs = 0;
+    for (i = 0; i < numClients; i++)
+    {
+        DTLS_Encrypt(serverAddresses[i], plainText, sizeof(plainText), encrypted, sizeof(encrypted), &length, &clientAddresses[i]);
+    }
+    while (true)
+    {
+        if (queueCount > 0)
+        {
+            Datagram * datagram = &queue[queueHead];
+            queueHead = (queueHead + 1) % MAX_DATAGRAMS;
+            queueCount--;
+            if (IsServerAddress(datagram->Destination))
+            {
+                double before = NowNs();
+                DTLS_Decrypt(datagram->Source, datagram->Data, datagram->Length, decrypted, sizeof(decrypted), &length, &serverContext);
+                double stall = NowNs() - before;
+                *busyNs += stall;
+                if (stall > *longestStallNs)
+                    *longestStallNs = stall;
+            }
+            else
+            {
+                DTLS_Decrypt(datagram->Source, datagram->Data, datagram->Length, decrypted, sizeof(decrypted), &length, NULL);
+            }
+        }
+        else if (handshakeFd >= 0)
+        {
+            struct pollfd fd = { handshakeFd, POLLIN, 0 };
+            if (poll(&fd, 1, 100) != 1)
+                break;
+            double before = NowNs();
+            DTLS_ProcessHandshakes();
+            *busyNs += NowNs() - before;
+        }
+        else
+        {
+            break;
+        }
+    }
+    for (i = 0; i < numClients; i++)
+    {
+        connected += DTLS_Encrypt(serverAddresses[i], plainText, sizeof(plainText), encrypted, sizeof(encrypted), &length, NULL);
+        DTLS_Reset(serverAddresses[i]);
+        DTLS_Reset(clientAddresses[i]);
+    }
+    queueHead = queueCount = 0;
+    return connected;
+}
+
+int main(int argc, char ** argv)
+{
+    numClients = (argc > 1) ? atoi(argv[1]) : DEFAULT_NUM_CLIENTS;
+    int numWorkers = (argc > 2) ? atoi(argv[2]) : DEFAULT_NUM_WORKERS;
+    double stallNs;
+    double busyNs;
+    int connected;
+    int i;
+
+    if ((numClients <= 0) || (numWorkers <= 0))
+    {
+        fprintf(stderr, "Usage: %s [number of clients] [number of workers]\n", argv[0]);
+        return 1;
+    }
+
+    queue = (Datagram *)malloc(MAX_DATAGRAMS * sizeof(Datagram));
+    clientAddresses = (NetworkAddress **)malloc(numClients * sizeof(NetworkAddress *));
+    serverAddresses = (NetworkAddress **)malloc(numClients * sizeof(NetworkAddress *));
+    if (!queue || !clientAddresses || !serverAddresses)
+    {
+        fprintf(stderr, "Out of memory\n");
+        return 1;
+    }
+
+    Lwm2m_SetLogLevel(DebugLevel_Warning);
+    DTLS_Init();
+    DTLS_SetNetworkSendCallback(LoopbackSend);
+    DTLS_SetCertificate(serverCert, sizeof(serverCert), AwaCertificateFormat_PEM);
+    for (i = 0; i < numClients; i++)
+    {
+        clientAddresses[i] = NewAddress(40000 + i);
+        serverAddresses[i] = NewAddress(20000 + i);
+    }
+
+    printf("%s, %d clients handshaking at once\n", DTLS_LibraryName, numClients);
+
+    connected = RunStorm(-1, &stallNs, &busyNs);
+    printf("Inline:     longest stall %8.2f ms, server loop busy %8.2f ms (%d/%d connected)\n", stallNs / 1e6, busyNs / 1e6, connected, numClients);
+
+    int handshakeFd = DTLS_SetHandshakeWorkers(numWorkers);
+    if (handshakeFd < 0)
+    {
+        fprintf(stderr, "Handshake workers are not supported with %s\n", DTLS_LibraryName);
+    }
+    else
+    {
+        connected = RunStorm(handshakeFd, &stallNs, &busyNs);
+        printf("%d workers:  longest stall %8.2f ms, server loop busy %8.2f ms (%d/%d connected)\n", numWorkers, stallNs / 1e6, busyNs / 1e6, connected, numClients);
+        DTLS_SetHandshakeWorkers(0);
+    }
+
+    for (i = 0; i < numClients; i++)
+    {
+        NetworkAddress_Free(&clientAddresses[i]);
+        NetworkAddress_Free(&serverAddresses[i]);
+    }
+    DTLS_Shutdown();
+    free(serverAddresses);
+    free(clientAddresses);
+    free(queue);
+    return 0;
+}
@@ -0,0 +1,173 @@
+/************************************************************************************************************************
+ Copyright (c) 2016, Imagination Technologies Limited and/or its affiliated group companies.
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+ following conditions are met:
+     1. Redistributions of source code must retain the above copyright notice, this list of conditions and the
+        following disclaimer.
+     2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the
+        following disclaimer in the documentation and/or other materials provided with the distribution.
+     3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote
+        products derived from this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+ USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+************************************************************************************************************************/
+
+/* DTLS resumption benchmark: runs client and server DTLS sessions in-process over a loopback
+ * datagram queue and reports the cost of a full PSK handshake against one that resumes an earlier
+ * session. Full handshakes connect to a different server address each time, so no resumption data
+ * is available; resumed handshakes reconnect to the same server after both sides drop the session.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "lwm2m_debug.h"
+#include "dtls_abstraction.h"
+
+#define DEFAULT_NUM_HANDSHAKES (1000)
+#define MAX_DATAGRAMS          (32)
+#define MAX_DATAGRAM_SIZE      (2048)
+#define MAX_DELIVERIES         (64)
+
+typedef struct
+{
+    NetworkAddress * Source;
+    int Length;
+    uint8_t Data[MAX_DATAGRAM_SIZE];
+} Datagram;
+
+static Datagram queue[MAX_DATAGRAMS];
+static int queueHead;
+static int queueCount;
+
+static NetworkAddress * clientAddress;
+static NetworkAddress * serverAddress;
+
+static const uint8_t pskKey[] = { 0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f };
+
+static double NowNs(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static NetworkAddress * NewAddress(int port)
+{
+    char uri[64];
+    sprintf(uri, "coaps://127.0.0.1:%d", port);
+    return NetworkAddress_New(uri, strlen(uri));
+}
+
+// Datagrams sent to the server arrive from the client, and the client only talks to the current server
+static NetworkTransmissionError LoopbackSend(NetworkAddress * destAddress, const uint8_t * buffer, int bufferLength, void * context)
+{
+    (void)context;
+    if ((queueCount < MAX_DATAGRAMS) && (bufferLength <= MAX_DATAGRAM_SIZE))
+    {
+        Datagram * datagram = &queue[(queueHead + queueCount) % MAX_DATAGRAMS];
+        datagram->Source = (destAddress == serverAddress) ? clientAddress : serverAddress;
+        datagram->Length = bufferLength;
+        memcpy(datagram->Data, buffer, bufferLength);
+        queueCount++;
+    }
+    return NetworkTransmissionError_None;
+}
+
+static bool Connect(void)
+{
+    uint8_t plainText[] = "ping";
+    uint8_t encrypted[MAX_DATAGRAM_SIZE];
+    uint8_t decrypted[MAX_DATAGRAM_SIZE];
+    int length;
+    int deliveries;
+
+    DTLS_Encrypt(serverAddress, plainText, sizeof(plainText), encrypted, sizeof(encrypted), &length, NULL);
+    for (deliveries = 0; (queueCount > 0) && (deliveries < MAX_DELIVERIES); deliveries++)
+    {
+        Datagram * datagram = &queue[queueHead];
+        queueHead = (queueHead + 1) % MAX_DATAGRAMS;
+        queueCount--;
+        DTLS_Decrypt(datagram->Source, datagram->Data, datagram->Length, decrypted, sizeof(decrypted), &length, NULL);
+    }
+    queueHead = queueCount = 0;
+
+    // the handshake is complete once the client can encrypt application data
+    return DTLS_Encrypt(serverAddress, plainText, sizeof(plainText), encrypted, sizeof(encrypted), &length, NULL);
+}
+
+static void Disconnect(void)
+{
+    DTLS_Reset(serverAddress);
+    DTLS_Reset(clientAddress);
+}
+
+int main(int argc, char ** argv)
+{
+    int numHandshakes = (argc > 1) ? atoi(argv[1]) : DEFAULT_NUM_HANDSHAKES;
+    int connected = 0;
+    int i;
+    double start;
+    double fullNs;
+    double resumedNs;
+    DTLS_SessionStats before;
+    DTLS_SessionStats after;
+
+    if (numHandshakes <= 0)
+    {
+        fprintf(stderr, "Usage: %s [number of handshakes]\n", argv[0]);
+        return 1;
+    }
+
+    Lwm2m_SetLogLevel(DebugLevel_Warning);
+    DTLS_Init();
+    DTLS_SetNetworkSendCallback(LoopbackSend);
+    DTLS_SetPSK("bench", pskKey, sizeof(pskKey));
+    clientAddress = NewAddress(40000);
+
+    printf("%s, %d PSK handshakes of each kind\n", DTLS_LibraryName, numHandshakes);
+
+    start = NowNs();
+    for (i = 0; i < numHandshakes; i++)
+    {
+        serverAddress = NewAddress(20000 + (i % 20000));
+        connected += Connect();
+        Disconnect();
+        NetworkAddress_Free(&serverAddress);
+    }
+    fullNs = NowNs() - start;
+    printf("Full handshake:    %8.1f us/handshake (%d/%d connected)\n", fullNs / 1000 / numHandshakes, connected, numHandshakes);
+
+    serverAddress = NewAddress(5684);
+    Connect();
+    Disconnect();
+
+    connected = 0;
+    DTLS_GetSessionStats(&before);
+    start = NowNs();
+    for (i = 0; i < numHandshakes; i++)
+    {
+        connected += Connect();
+        Disconnect();
+    }
+    resumedNs = NowNs() - start;
+    DTLS_GetSessionStats(&after);
+    printf("Resumed handshake: %8.1f us/handshake (%d/%d connected, %lu resumed)\n", resumedNs / 1000 / numHandshakes, connected, numHandshakes,
+           (after.Resumptions - before.Resumptions) / 2);
+    printf("Speedup: %.1fx\n", fullNs / resumedNs);
+
+    NetworkAddress_Free(&serverAddress);
+    NetworkAddress_Free(&clientAddress);
+    DTLS_Shutdown();
+    return 0;
+}
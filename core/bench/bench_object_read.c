@@ -0,0 +1,190 @@
+/************************************************************************************************************************
+ Copyright (c) 2016, Imagination Technologies Limited and/or its affiliated group companies.
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+ following conditions are met:
+     1. Redistributions of source code must retain the above copyright notice, this list of conditions and the
+        following disclaimer.
+     2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the
+        following disclaimer in the documentation and/or other materials provided with the distribution.
+     3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote
+        products derived from this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+ USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+************************************************************************************************************************/
+
+/* Object read benchmark: builds a client with one object of many instances and reports the cost per
+ * instance of walking it with the Lwm2mCore_GetNext functions, with a Lwm2mCoreIterator, and of building
+ * the tree a Read of the whole object serialises, on the heap and in a request arena. Every column should
+ * stay flat as the object grows; each GetNext call still looks up the path of the previous ID, which the
+ * iterator avoids.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <time.h>
+
+#include "lwm2m_core.h"
+#include "lwm2m_tree_builder.h"
+
+#define OBJECT_ID               (3303)      // IPSO temperature
+#define FIRST_RESOURCE_ID       (5600)
+#define RESOURCES_PER_INSTANCE  (5)
+#define MIN_INSTANCES           (250)
+#define DEFAULT_MAX_INSTANCES   (4000)
+#define REPEATS                 (5)
+
+static double NowNs(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static Lwm2mContextType * BuildClient(int numInstances)
+{
+    Lwm2mContextType * context = Lwm2mCore_Init(NULL, NULL);
+    int instanceID;
+    int resource;
+
+    Definition_RegisterObjectType(Lwm2mCore_GetDefinitions(context), "Temperature", OBJECT_ID, numInstances, 0, &defaultObjectOperationHandlers);
+    for (resource = 0; resource < RESOURCES_PER_INSTANCE; resource++)
+    {
+        Lwm2mCore_RegisterResourceType(context, "Value", OBJECT_ID, FIRST_RESOURCE_ID + resource, AwaResourceType_Integer,
+                                       MultipleInstancesEnum_Single, MandatoryEnum_Mandatory, AwaResourceOperations_ReadWrite, &defaultResourceOperationHandlers);
+    }
+
+    for (instanceID = 0; instanceID < numInstances; instanceID++)
+    {
+        Lwm2mCore_CreateObjectInstance(context, OBJECT_ID, instanceID);
+        for (resource = 0; resource < RESOURCES_PER_INSTANCE; resource++)
+        {
+            int64_t value = instanceID;
+            Lwm2mCore_SetResourceInstanceValue(context, OBJECT_ID, instanceID, FIRST_RESOURCE_ID + resource, 0, &value, sizeof(value));
+        }
+    }
+    return context;
+}
+
+static int WalkWithGetNext(Lwm2mContextType * context)
+{
+    int visited = 0;
+    int instanceID = -1;
+    while ((instanceID = Lwm2mCore_GetNextObjectInstanceID(context, OBJECT_ID, instanceID)) != -1)
+    {
+        int resourceID = -1;
+        while ((resourceID = Lwm2mCore_GetNextResourceID(context, OBJECT_ID, instanceID, resourceID)) != -1)
+        {
+            visited++;
+        }
+    }
+    return visited;
+}
+
+static int WalkWithIterator(Lwm2mContextType * context)
+{
+    Lwm2mCoreIterator instances;
+    int visited = 0;
+    int instanceID;
+
+    Lwm2mCore_InitIterator(context, &instances, OBJECT_ID, -1, -1);
+    while ((instanceID = Lwm2mCore_IteratorNext(&instances)) != -1)
+    {
+        Lwm2mCoreIterator resources;
+        Lwm2mCore_InitIterator(context, &resources, OBJECT_ID, instanceID, -1);
+        while (Lwm2mCore_IteratorNext(&resources) != -1)
+        {
+            visited++;
+        }
+    }
+    return visited;
+}
+
+static int ReadObject(Lwm2mContextType * context)
+{
+    Lwm2mTreeNode * tree = NULL;
+    int result = TreeBuilder_CreateTreeFromObject(&tree, NULL, context, Lwm2mRequestOrigin_Server, OBJECT_ID);
+    Lwm2mTreeNode_DeleteRecursive(tree);
+    return (result == AwaResult_Success) ? 0 : -1;
+}
+
+static int ReadObjectInArena(Lwm2mContextType * context)
+{
+    uint8_t arenaBlock[LWM2M_TREE_ARENA_INITIAL_SIZE];
+    MemoryArena arena;
+    Lwm2mTreeNode * tree = NULL;
+
+    MemoryArena_Init(&arena, arenaBlock, sizeof(arenaBlock), LWM2M_TREE_ARENA_BLOCK_SIZE);
+    int result = TreeBuilder_CreateTreeFromObject(&tree, &arena, context, Lwm2mRequestOrigin_Server, OBJECT_ID);
+    MemoryArena_Destroy(&arena);
+    return (result == AwaResult_Success) ? 0 : -1;
+}
+
+int main(int argc, char ** argv)
+{
+    int maxInstances = (argc > 1) ? atoi(argv[1]) : DEFAULT_MAX_INSTANCES;
+    int numInstances;
+
+    if (maxInstances < MIN_INSTANCES)
+    {
+        fprintf(stderr, "Usage: %s [largest number of object instances, at least %d]\n", argv[0], MIN_INSTANCES);
+        return 1;
+    }
+    Lwm2m_SetLogLevel(DebugLevel_Warning);
+
+    printf("%d resources per instance, ns per object instance:\n", RESOURCES_PER_INSTANCE);
+    printf("%10s %12s %12s %12s %12s\n", "instances", "GetNext walk", "iterator", "object read", "arena read");
+    for (numInstances = MIN_INSTANCES; numInstances <= maxInstances; numInstances *= 2)
+    {
+        Lwm2mContextType * context = BuildClient(numInstances);
+        double getNextNs = 0;
+        double iteratorNs = 0;
+        double readNs = 0;
+        double arenaReadNs = 0;
+        int repeat;
+
+        for (repeat = 0; repeat < REPEATS; repeat++)
+        {
+            double start = NowNs();
+            int visited = WalkWithGetNext(context);
+            getNextNs += NowNs() - start;
+
+            start = NowNs();
+            if (WalkWithIterator(context) != visited || visited != numInstances * RESOURCES_PER_INSTANCE)
+            {
+                fprintf(stderr, "Walks visited different resources\n");
+                return 1;
+            }
+            iteratorNs += NowNs() - start;
+
+            start = NowNs();
+            if (ReadObject(context) != 0)
+            {
+                fprintf(stderr, "Failed to read object %d\n", OBJECT_ID);
+                return 1;
+            }
+            readNs += NowNs() - start;
+
+            start = NowNs();
+            if (ReadObjectInArena(context) != 0)
+            {
+                fprintf(stderr, "Failed to read object %d\n", OBJECT_ID);
+                return 1;
+            }
+            arenaReadNs += NowNs() - start;
+        }
+        printf("%10d %12.1f %12.1f %12.1f %12.1f\n", numInstances, getNextNs / REPEATS / numInstances,
+               iteratorNs / REPEATS / numInstances, readNs / REPEATS / numInstances, arenaReadNs / REPEATS / numInstances);
+
+        Lwm2mCore_Destroy(context);
+    }
+    return 0;
+}
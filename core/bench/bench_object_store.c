@@ -0,0 +1,379 @@
+/************************************************************************************************************************
+ Copyright (c) 2016, Imagination Technologies Limited and/or its affiliated group companies.
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+ following conditions are met:
+     1. Redistributions of source code must retain the above copyright notice, this list of conditions and the
+        following disclaimer.
+     2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the
+        following disclaimer in the documentation and/or other materials provided with the distribution.
+     3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote
+        products derived from this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+ USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+************************************************************************************************************************/
+
+
+/* Object store benchmark: fills a store the way a gateway with many attached sensors does (one IPSO
+ * object instance per sensor, each with a handful of resources) and reports heap used, the cost of
+ * reading a resource value by path, of updating integer readings and short string values, and of walking
+ * every instance with the GetNext functions. A copy of the four-level linked list used before the store
+ * was indexed is measured for comparison.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <time.h>
+#include <malloc.h>
+
+#include "lwm2m_debug.h"
+#include "lwm2m_list.h"
+#include "lwm2m_object_store.h"
+
+#define DEFAULT_NUM_RESOURCE_INSTANCES  (10000)
+#define RESOURCES_PER_INSTANCE          (10)
+#define OBJECT_ID                       (3303)      // IPSO temperature
+#define FIRST_RESOURCE_ID               (5600)
+#define NUM_LOOKUPS                     (1000000)
+
+typedef struct
+{
+    struct ListHead list;
+    void * Value;
+    int Size;
+    int ID;
+} LinkedResourceInstance;
+
+typedef struct
+{
+    struct ListHead list;
+    struct ListHead Instance;
+    int ID;
+} LinkedResource;
+
+typedef struct
+{
+    struct ListHead list;
+    struct ListHead Resource;
+    int ID;
+} LinkedObjectInstance;
+
+typedef struct
+{
+    struct ListHead list;
+    struct ListHead Instance;
+    int ID;
+} LinkedObject;
+
+static double NowNs(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static size_t HeapInUse(void)
+{
+    return mallinfo2().uordblks;
+}
+
+// Deterministic spread of paths, the same for both stores
+static uint32_t NextRandom(uint32_t * state)
+{
+    *state = *state * 1664525u + 1013904223u;
+    return *state >> 8;
+}
+
+// The lookups of the linked store, one list walk per level
+static LinkedObject * LinkedFindObject(struct ListHead * objects, int objectID)
+{
+    struct ListHead * i;
+    ListForEach(i, objects)
+    {
+        LinkedObject * object = ListEntry(i, LinkedObject, list);
+        if (object->ID == objectID)
+        {
+            return object;
+        }
+    }
+    return NULL;
+}
+
+static LinkedObjectInstance * LinkedFindInstance(LinkedObject * object, int instanceID)
+{
+    struct ListHead * i;
+    ListForEach(i, &object->Instance)
+    {
+        LinkedObjectInstance * instance = ListEntry(i, LinkedObjectInstance, list);
+        if (instance->ID == instanceID)
+        {
+            return instance;
+        }
+    }
+    return NULL;
+}
+
+static LinkedResource * LinkedFindResource(LinkedObjectInstance * instance, int resourceID)
+{
+    struct ListHead * i;
+    ListForEach(i, &instance->Resource)
+    {
+        LinkedResource * resource = ListEntry(i, LinkedResource, list);
+        if (resource->ID == resourceID)
+        {
+            return resource;
+        }
+    }
+    return NULL;
+}
+
+static LinkedResourceInstance * LinkedFindResourceInstance(LinkedResource * resource, int resourceInstanceID)
+{
+    struct ListHead * i;
+    ListForEach(i, &resource->Instance)
+    {
+        LinkedResourceInstance * value = ListEntry(i, LinkedResourceInstance, list);
+        if (value->ID == resourceInstanceID)
+        {
+            return value;
+        }
+    }
+    return NULL;
+}
+
+static void BuildLinkedStore(struct ListHead * objects, int numInstances)
+{
+    LinkedObject * object = calloc(1, sizeof(LinkedObject));
+    int instanceID;
+    int resourceIndex;
+
+    ListInit(objects);
+    object->ID = OBJECT_ID;
+    ListInit(&object->Instance);
+    ListAdd(&object->list, objects);
+    for (instanceID = 0; instanceID < numInstances; instanceID++)
+    {
+        LinkedObjectInstance * instance = calloc(1, sizeof(LinkedObjectInstance));
+        instance->ID = instanceID;
+        ListInit(&instance->Resource);
+        ListAdd(&instance->list, &object->Instance);
+        for (resourceIndex = 0; resourceIndex < RESOURCES_PER_INSTANCE; resourceIndex++)
+        {
+            LinkedResource * resource = calloc(1, sizeof(LinkedResource));
+            LinkedResourceInstance * value = calloc(1, sizeof(LinkedResourceInstance));
+            resource->ID = FIRST_RESOURCE_ID + resourceIndex;
+            ListInit(&resource->Instance);
+            ListAdd(&resource->list, &instance->Resource);
+            value->Size = sizeof(int64_t);
+            value->Value = malloc(value->Size);
+            *(int64_t *)value->Value = instanceID;
+            ListAdd(&value->list, &resource->Instance);
+        }
+    }
+}
+
+static const void * LinkedGetValue(struct ListHead * objects, int objectID, int instanceID, int resourceID, int resourceInstanceID)
+{
+    LinkedObject * object = LinkedFindObject(objects, objectID);
+    LinkedObjectInstance * instance = object ? LinkedFindInstance(object, instanceID) : NULL;
+    LinkedResource * resource = instance ? LinkedFindResource(instance, resourceID) : NULL;
+    LinkedResourceInstance * value = resource ? LinkedFindResourceInstance(resource, resourceInstanceID) : NULL;
+    return value ? value->Value : NULL;
+}
+
+// As the linked store's GetNextObjectInstanceID: find the given instance, then return the one after it
+static int LinkedGetNextInstanceID(struct ListHead * objects, int objectID, int instanceID)
+{
+    LinkedObject * object = LinkedFindObject(objects, objectID);
+    if (object != NULL)
+    {
+        bool found = (instanceID == -1);
+        struct ListHead * i;
+        ListForEach(i, &object->Instance)
+        {
+            LinkedObjectInstance * instance = ListEntry(i, LinkedObjectInstance, list);
+            if (found)
+            {
+                return instance->ID;
+            }
+            found = (instance->ID == instanceID);
+        }
+    }
+    return -1;
+}
+
+static void FreeLinkedStore(struct ListHead * objects)
+{
+    struct ListHead * o, * on, * i, * in, * r, * rn, * v, * vn;
+    ListForEachSafe(o, on, objects)
+    {
+        LinkedObject * object = ListEntry(o, LinkedObject, list);
+        ListForEachSafe(i, in, &object->Instance)
+        {
+            LinkedObjectInstance * instance = ListEntry(i, LinkedObjectInstance, list);
+            ListForEachSafe(r, rn, &instance->Resource)
+            {
+                LinkedResource * resource = ListEntry(r, LinkedResource, list);
+                ListForEachSafe(v, vn, &resource->Instance)
+                {
+                    LinkedResourceInstance * value = ListEntry(v, LinkedResourceInstance, list);
+                    free(value->Value);
+                    free(value);
+                }
+                free(resource);
+            }
+            free(instance);
+        }
+        free(object);
+    }
+}
+
+static ObjectStore * BuildObjectStore(int numInstances)
+{
+    ObjectStore * store = ObjectStore_Create();
+    int instanceID;
+    int resource;
+
+    ObjectStore_CreateObjectInstance(store, OBJECT_ID, 0, numInstances);
+    for (instanceID = 0; instanceID < numInstances; instanceID++)
+    {
+        int64_t value = instanceID;
+        if (instanceID > 0)
+        {
+            ObjectStore_CreateObjectInstance(store, OBJECT_ID, instanceID, numInstances);
+        }
+        for (resource = 0; resource < RESOURCES_PER_INSTANCE; resource++)
+        {
+            bool changed;
+            ObjectStore_CreateResource(store, OBJECT_ID, instanceID, FIRST_RESOURCE_ID + resource);
+            ObjectStore_SetResourceInstanceValue(store, OBJECT_ID, instanceID, FIRST_RESOURCE_ID + resource, 0,
+                                                 sizeof(value), &value, 0, sizeof(value), &changed);
+        }
+    }
+    return store;
+}
+
+int main(int argc, char ** argv)
+{
+    int numResourceInstances = (argc > 1) ? atoi(argv[1]) : DEFAULT_NUM_RESOURCE_INSTANCES;
+    int numInstances = numResourceInstances / RESOURCES_PER_INSTANCE;
+    struct ListHead linkedStore;
+    ObjectStore * store;
+    int64_t checksum = 0;
+    uint32_t random;
+    size_t before;
+    double start;
+    int walked;
+    int id;
+    int i;
+
+    if (numInstances <= 0)
+    {
+        fprintf(stderr, "Usage: %s [number of resource instances, at least %d]\n", argv[0], RESOURCES_PER_INSTANCE);
+        return 1;
+    }
+    Lwm2m_SetLogLevel(DebugLevel_Warning);
+
+    printf("%d object instances, %d resources each: %d resource instances\n", numInstances, RESOURCES_PER_INSTANCE,
+           numInstances * RESOURCES_PER_INSTANCE);
+
+    before = HeapInUse();
+    start = NowNs();
+    BuildLinkedStore(&linkedStore, numInstances);
+    printf("Linked list:   built in %7.2f ms, %8.1f heap bytes/resource instance\n", (NowNs() - start) / 1e6,
+           (double)(HeapInUse() - before) / (numInstances * RESOURCES_PER_INSTANCE));
+
+    before = HeapInUse();
+    start = NowNs();
+    store = BuildObjectStore(numInstances);
+    if (store == NULL)
+    {
+        fprintf(stderr, "Out of memory\n");
+        return 1;
+    }
+    printf("Indexed store: built in %7.2f ms, %8.1f heap bytes/resource instance\n", (NowNs() - start) / 1e6,
+           (double)(HeapInUse() - before) / (numInstances * RESOURCES_PER_INSTANCE));
+
+    random = 1;
+    start = NowNs();
+    for (i = 0; i < NUM_LOOKUPS; i++)
+    {
+        uint32_t r = NextRandom(&random);
+        const int64_t * value = LinkedGetValue(&linkedStore, OBJECT_ID, r % numInstances, FIRST_RESOURCE_ID + (r / numInstances) % RESOURCES_PER_INSTANCE, 0);
+        checksum += *value;
+    }
+    printf("Linked list read:   %10.1f ns/read\n", (NowNs() - start) / NUM_LOOKUPS);
+
+    random = 1;
+    start = NowNs();
+    for (i = 0; i < NUM_LOOKUPS; i++)
+    {
+        uint32_t r = NextRandom(&random);
+        const void * value;
+        size_t size;
+        ObjectStore_GetResourceInstanceValue(store, OBJECT_ID, r % numInstances, FIRST_RESOURCE_ID + (r / numInstances) % RESOURCES_PER_INSTANCE, 0, &value, &size);
+        checksum -= *(const int64_t *)value;
+    }
+    printf("Indexed store read: %10.1f ns/read\n", (NowNs() - start) / NUM_LOOKUPS);
+
+    random = 1;
+    start = NowNs();
+    for (i = 0; i < NUM_LOOKUPS; i++)
+    {
+        uint32_t r = NextRandom(&random);
+        int64_t value = r;
+        bool changed;
+        ObjectStore_SetResourceInstanceValue(store, OBJECT_ID, r % numInstances, FIRST_RESOURCE_ID + (r / numInstances) % RESOURCES_PER_INSTANCE, 0,
+                                             sizeof(value), &value, 0, sizeof(value), &changed);
+    }
+    printf("Indexed store set:  %10.1f ns/set of an integer\n", (NowNs() - start) / NUM_LOOKUPS);
+
+    random = 1;
+    start = NowNs();
+    for (i = 0; i < NUM_LOOKUPS; i++)
+    {
+        // alternate the length, as a sensor's status or units string does
+        static const char * const strings[] = { "Cel", "Far", "OK", "Degraded" };
+        uint32_t r = NextRandom(&random);
+        const char * string = strings[r % 4];
+        bool changed;
+        ObjectStore_SetResourceInstanceValue(store, OBJECT_ID, r % numInstances, FIRST_RESOURCE_ID + (r / numInstances) % RESOURCES_PER_INSTANCE, 0,
+                                             strlen(string), string, 0, strlen(string), &changed);
+    }
+    printf("Indexed store set:  %10.1f ns/set of a short string\n", (NowNs() - start) / NUM_LOOKUPS);
+
+    walked = 0;
+    start = NowNs();
+    for (id = LinkedGetNextInstanceID(&linkedStore, OBJECT_ID, -1); id != -1; id = LinkedGetNextInstanceID(&linkedStore, OBJECT_ID, id))
+    {
+        walked++;
+    }
+    printf("Linked list walk:   %10.1f us for %d instances\n", (NowNs() - start) / 1e3, walked);
+
+    start = NowNs();
+    for (id = ObjectStore_GetNextObjectInstanceID(store, OBJECT_ID, -1); id != -1; id = ObjectStore_GetNextObjectInstanceID(store, OBJECT_ID, id))
+    {
+        walked--;
+    }
+    printf("Indexed store walk: %10.1f us for %d instances\n", (NowNs() - start) / 1e3, numInstances);
+
+    FreeLinkedStore(&linkedStore);
+    ObjectStore_Destroy(store);
+
+    if ((checksum != 0) || (walked != 0))
+    {
+        fprintf(stderr, "Results differ between stores\n");
+        return 1;
+    }
+    return 0;
+}
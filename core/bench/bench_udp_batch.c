@@ -0,0 +1,213 @@
+/************************************************************************************************************************
+ Copyright (c) 2016, Imagination Technologies Limited and/or its affiliated group companies.
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+ following conditions are met:
+     1. Redistributions of source code must retain the above copyright notice, this list of conditions and the
+        following disclaimer.
+     2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the
+        following disclaimer in the documentation and/or other materials provided with the distribution.
+     3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote
+        products derived from this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+ USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+************************************************************************************************************************/
+
+/* Batched datagram I/O benchmark: load generator threads keep a window of requests outstanding from
+ * many loopback peers, and the main thread answers each one the way coap_HandleMessage does, reading
+ * with NetworkSocket_Read and sending the reply inside a NetworkSocket_StartBatch/EndBatch pair. It
+ * reports datagrams handled per second with one datagram per system call and with full batches.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <poll.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+#include "lwm2m_debug.h"
+#include "network_abstraction_posix.h"
+
+#define DEFAULT_NUM_REQUESTS   (200000)
+#define NUM_GENERATORS         (4)
+#define PEERS_PER_GENERATOR    (8)
+#define WINDOW_PER_PEER        (4)          // small enough that the server's receive buffer never overflows
+#define REQUEST_SIZE           (40)         // about the size of a CoAP notification
+
+typedef struct
+{
+    struct sockaddr_in Server;
+    int NumRequests;
+    int Peers[PEERS_PER_GENERATOR];
+    int Answered;
+    pthread_t Thread;
+} LoadGenerator;
+
+static double NowNs(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static int SendRequest(LoadGenerator * generator, int peer)
+{
+    uint8_t request[REQUEST_SIZE];
+    memset(request, peer, sizeof(request));
+    return sendto(generator->Peers[peer], request, sizeof(request), 0, (struct sockaddr *)&generator->Server, sizeof(generator->Server)) == sizeof(request) ? 1 : 0;
+}
+
+// Keeps WINDOW_PER_PEER requests outstanding from each peer until every request has been answered
+static void * RunLoadGenerator(void * context)
+{
+    LoadGenerator * generator = (LoadGenerator *)context;
+    struct pollfd fds[PEERS_PER_GENERATOR];
+    int sent = 0;
+    int peer;
+    int window;
+
+    for (peer = 0; peer < PEERS_PER_GENERATOR; peer++)
+    {
+        fds[peer].fd = generator->Peers[peer];
+        fds[peer].events = POLLIN;
+        for (window = 0; (window < WINDOW_PER_PEER) && (sent < generator->NumRequests); window++)
+        {
+            sent += SendRequest(generator, peer);
+        }
+    }
+
+    while (generator->Answered < generator->NumRequests)
+    {
+        // replies lost to a full socket buffer are not retried, so give up once the server goes quiet
+        if (poll(fds, PEERS_PER_GENERATOR, 1000) <= 0)
+            break;
+        for (peer = 0; peer < PEERS_PER_GENERATOR; peer++)
+        {
+            uint8_t reply[REQUEST_SIZE];
+            while ((fds[peer].revents & POLLIN) && (recv(fds[peer].fd, reply, sizeof(reply), MSG_DONTWAIT) > 0))
+            {
+                generator->Answered++;
+                if (sent < generator->NumRequests)
+                {
+                    sent += SendRequest(generator, peer);
+                }
+            }
+        }
+    }
+    return NULL;
+}
+
+// Answer requests until the generators have had them all, returning the number handled
+static int Serve(NetworkSocket * networkSocket, int numRequests, double * finished, int * wakeups)
+{
+    struct pollfd fd = { NetworkSocket_GetFileDescriptor(networkSocket), POLLIN, 0 };
+    int handled = 0;
+    while ((handled < numRequests) && (poll(&fd, 1, 1000) > 0))
+    {
+        (*wakeups)++;
+        NetworkSocket_StartBatch(networkSocket);
+        do
+        {
+            uint8_t buffer[1024];
+            NetworkAddress * sourceAddress = NULL;
+            int readLength = 0;
+            if (NetworkSocket_Read(networkSocket, buffer, sizeof(buffer), &sourceAddress, &readLength) && (readLength > 0))
+            {
+                NetworkSocket_Send(networkSocket, sourceAddress, buffer, readLength);
+                handled++;
+                *finished = NowNs();
+            }
+        } while (NetworkSocket_HasPendingReads(networkSocket));
+        NetworkSocket_EndBatch(networkSocket);
+    }
+    return handled;
+}
+
+static int Run(int batchSize, int numRequests, double * datagramsPerSecond, double * perWakeup)
+{
+    LoadGenerator generators[NUM_GENERATORS];
+    struct sockaddr_in server;
+    socklen_t length = sizeof(server);
+    int handled = 0;
+    int wakeups = 0;
+    int index;
+    int peer;
+
+    NetworkSocket * networkSocket = NetworkSocket_New("127.0.0.1", NetworkSocketType_UDP, 0);
+    if (!networkSocket || !NetworkSocket_StartListening(networkSocket))
+        return -1;
+    NetworkSocket_SetBatchSize(networkSocket, batchSize);
+    getsockname(NetworkSocket_GetFileDescriptor(networkSocket), (struct sockaddr *)&server, &length);
+
+    double start = NowNs();
+    double finished = start;
+    for (index = 0; index < NUM_GENERATORS; index++)
+    {
+        memset(&generators[index], 0, sizeof(generators[index]));
+        generators[index].Server = server;
+        generators[index].NumRequests = numRequests / NUM_GENERATORS;
+        for (peer = 0; peer < PEERS_PER_GENERATOR; peer++)
+        {
+            generators[index].Peers[peer] = socket(AF_INET, SOCK_DGRAM, 0);
+        }
+        pthread_create(&generators[index].Thread, NULL, RunLoadGenerator, &generators[index]);
+    }
+    handled = Serve(networkSocket, (numRequests / NUM_GENERATORS) * NUM_GENERATORS, &finished, &wakeups);
+
+    // each request is a datagram in and a datagram out
+    *datagramsPerSecond = 2.0 * handled / ((finished - start) / 1e9);
+    *perWakeup = wakeups ? (double)handled / wakeups : 0;
+
+    for (index = 0; index < NUM_GENERATORS; index++)
+    {
+        pthread_join(generators[index].Thread, NULL);
+        for (peer = 0; peer < PEERS_PER_GENERATOR; peer++)
+        {
+            close(generators[index].Peers[peer]);
+        }
+    }
+    NetworkSocket_Free(&networkSocket);
+    return handled;
+}
+
+int main(int argc, char ** argv)
+{
+    int numRequests = (argc > 1) ? atoi(argv[1]) : DEFAULT_NUM_REQUESTS;
+    double datagramsPerSecond;
+    double perWakeup;
+    int batchSizes[] = { 1, NETWORK_BATCH_SIZE };
+    int index;
+
+    if (numRequests < NUM_GENERATORS)
+    {
+        fprintf(stderr, "Usage: %s [number of requests]\n", argv[0]);
+        return 1;
+    }
+    Lwm2m_SetLogLevel(DebugLevel_Error);
+
+    numRequests -= numRequests % NUM_GENERATORS;
+    printf("%d requests from %d loopback peers, %d outstanding each\n", numRequests, NUM_GENERATORS * PEERS_PER_GENERATOR, WINDOW_PER_PEER);
+    for (index = 0; index < sizeof(batchSizes) / sizeof(batchSizes[0]); index++)
+    {
+        int handled = Run(batchSizes[index], numRequests, &datagramsPerSecond, &perWakeup);
+        if (handled < 0)
+        {
+            fprintf(stderr, "Unable to open a loopback socket\n");
+            return 1;
+        }
+        printf("Batch size %2d: %10.0f datagrams/s, %5.1f requests per wakeup (%d/%d answered)\n", batchSizes[index], datagramsPerSecond, perWakeup, handled, numRequests);
+    }
+    return 0;
+}
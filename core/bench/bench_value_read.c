@@ -0,0 +1,131 @@
+/************************************************************************************************************************
+ Copyright (c) 2016, Imagination Technologies Limited and/or its affiliated group companies.
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+ following conditions are met:
+     1. Redistributions of source code must retain the above copyright notice, this list of conditions and the
+        following disclaimer.
+     2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the
+        following disclaimer in the documentation and/or other materials provided with the distribution.
+     3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote
+        products derived from this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+ USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+************************************************************************************************************************/
+
+/* Value read benchmark: reads one opaque resource of growing size and serialises it as TLV, the work a
+ * client does for a Read or a notification. The heap column copies the value from the object store into
+ * the tree and again into the payload; in a request arena the tree borrows the object store's copy, so only
+ * the serialiser touches the bytes.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+
+#include "lwm2m_core.h"
+#include "lwm2m_serdes.h"
+#include "lwm2m_tree_builder.h"
+
+#define OBJECT_ID           (20000)
+#define RESOURCE_ID         (0)
+#define MIN_VALUE_SIZE      (64)
+#define MAX_VALUE_SIZE      (32768)
+#define READS               (20000)
+
+static double NowNs(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static int ReadAndSerialise(Lwm2mContextType * context, MemoryArena * arena, char * payload, int payloadSize)
+{
+    Lwm2mTreeNode * tree = NULL;
+    int payloadLength = -1;
+
+    if (TreeBuilder_CreateTreeFromResource(&tree, arena, context, Lwm2mRequestOrigin_Server, OBJECT_ID, 0, RESOURCE_ID) == AwaResult_Success)
+    {
+        payloadLength = SerialiseResource(AwaContentType_ApplicationOmaLwm2mTLV, tree, OBJECT_ID, 0, RESOURCE_ID, payload, payloadSize);
+    }
+    if (arena == NULL)
+    {
+        Lwm2mTreeNode_DeleteRecursive(tree);
+    }
+    return payloadLength;
+}
+
+static double TimeReads(Lwm2mContextType * context, bool useArena, char * payload, int payloadSize, int valueSize)
+{
+    double start = NowNs();
+    int read;
+
+    for (read = 0; read < READS; read++)
+    {
+        uint8_t arenaBlock[LWM2M_TREE_ARENA_INITIAL_SIZE];
+        MemoryArena arena;
+        int payloadLength;
+
+        MemoryArena_Init(&arena, arenaBlock, sizeof(arenaBlock), LWM2M_TREE_ARENA_BLOCK_SIZE);
+        payloadLength = ReadAndSerialise(context, useArena ? &arena : NULL, payload, payloadSize);
+        MemoryArena_Destroy(&arena);
+        if (payloadLength < valueSize)
+        {
+            return -1;
+        }
+    }
+    return (NowNs() - start) / READS;
+}
+
+int main(void)
+{
+    Lwm2mContextType * context = Lwm2mCore_Init(NULL, NULL);
+    int payloadSize = MAX_VALUE_SIZE + 16;
+    char * payload = malloc(payloadSize);
+    uint8_t * value = malloc(MAX_VALUE_SIZE);
+    int valueSize;
+
+    if ((payload == NULL) || (value == NULL))
+    {
+        fprintf(stderr, "Out of memory\n");
+        return 1;
+    }
+    memset(value, 0xa5, MAX_VALUE_SIZE);
+    Lwm2m_SetLogLevel(DebugLevel_Warning);
+
+    Definition_RegisterObjectType(Lwm2mCore_GetDefinitions(context), "Blob", OBJECT_ID, MultipleInstancesEnum_Single, MandatoryEnum_Optional, &defaultObjectOperationHandlers);
+    Lwm2mCore_RegisterResourceType(context, "Data", OBJECT_ID, RESOURCE_ID, AwaResourceType_Opaque,
+                                   MultipleInstancesEnum_Single, MandatoryEnum_Mandatory, AwaResourceOperations_ReadWrite, &defaultResourceOperationHandlers);
+    Lwm2mCore_CreateObjectInstance(context, OBJECT_ID, 0);
+
+    printf("ns per read of one opaque resource, serialised as TLV:\n");
+    printf("%10s %12s %12s\n", "bytes", "heap read", "arena read");
+    for (valueSize = MIN_VALUE_SIZE; valueSize <= MAX_VALUE_SIZE; valueSize *= 2)
+    {
+        Lwm2mCore_SetResourceInstanceValue(context, OBJECT_ID, 0, RESOURCE_ID, 0, value, valueSize);
+
+        double heapNs = TimeReads(context, false, payload, payloadSize, valueSize);
+        double arenaNs = TimeReads(context, true, payload, payloadSize, valueSize);
+        if ((heapNs < 0) || (arenaNs < 0))
+        {
+            fprintf(stderr, "Failed to read %d byte value\n", valueSize);
+            return 1;
+        }
+        printf("%10d %12.1f %12.1f\n", valueSize, heapNs, arenaNs);
+    }
+
+    Lwm2mCore_Destroy(context);
+    free(value);
+    free(payload);
+    return 0;
+}
@@ -0,0 +1,965 @@
+/************************************************************************************************************************
+ Copyright (c) 2016, Imagination Technologies Limited and/or its affiliated group companies.
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+ following conditions are met:
+     1. Redistributions of source code must retain the above copyright notice, this list of conditions and the
+        following disclaimer.
+     2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the
+        following disclaimer in the documentation and/or other materials provided with the distribution.
+     3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote
+        products derived from this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+ USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+************************************************************************************************************************/
+
+
+/* Registration load generator: simulates many LWM2M clients from one process, each with its own UDP
+ * socket, against a running awa_serverd. Virtual clients register at a configurable rate, send
+ * periodic updates, answer the server's GET and Observe requests on /3/0/9 with TLV built by the core
+ * serialiser, send notifications, and deregister at the end. With --observe, a second thread asks the
+ * server over IPC to observe each client once it has registered, and times notifications through to the
+ * application. It reports registrations per second, request latency percentiles and the server's RSS.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <errno.h>
+#include <time.h>
+#include <getopt.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/types.h>
+
+#include "awa/server.h"
+#include "er-coap.h"
+#include "lwm2m_debug.h"
+#include "lwm2m_definition.h"
+#include "lwm2m_event_loop.h"
+#include "lwm2m_ring_queue.h"
+#include "lwm2m_serdes.h"
+#include "lwm2m_tree_node.h"
+
+#define CONTENT_FORMAT_LINK_FORMAT  (40)
+#define ACK_TIMEOUT                 (2000)      // milliseconds before the first retransmission, doubled each retry
+#define MAX_RETRANSMIT              (4)
+#define DRAIN_TIMEOUT               (30000)     // milliseconds to wait for outstanding deregistrations
+#define PROGRESS_INTERVAL           (1000)
+#define OBSERVE_TIMEOUT             (10000)
+#define OBSERVED_PATH               "/3/0/9"    // Device battery level
+
+typedef enum
+{
+    ClientState_Unregistered,
+    ClientState_Registered,
+    ClientState_Deregistered,
+    ClientState_Failed,
+} ClientState;
+
+typedef enum
+{
+    Request_None,
+    Request_Register,
+    Request_Update,
+    Request_Deregister,
+} RequestKind;
+
+typedef struct
+{
+    double * Values;
+    size_t Count;
+    size_t Capacity;
+} LatencySamples;
+
+typedef struct
+{
+    int Index;
+    int Socket;
+    char Name[32];
+    char Location[32];                  // registration path from the server, e.g. "rd/5"
+    ClientState State;
+    RequestKind Pending;
+    uint16_t NextMessageID;
+    uint16_t PendingMessageID;
+    uint8_t Request[COAP_MAX_PACKET_SIZE];
+    size_t RequestLength;
+    int Retries;
+    double SentAt;
+    EventLoopTimer RequestTimer;        // next request, or retransmission of the pending one
+    EventLoopTimer NotifyTimer;
+    bool Observed;
+    uint8_t ObserveToken[COAP_TOKEN_LEN];
+    uint8_t ObserveTokenLength;
+    uint32_t ObserveSequence;
+    uint16_t NotifyMessageID;
+} VirtualClient;
+
+typedef struct
+{
+    const char * ServerAddress;
+    const char * ServerPort;
+    int NumClients;
+    double Rate;                        // registrations and deregistrations started per second
+    int UpdateInterval;                 // seconds
+    int Lifetime;                       // seconds
+    bool Observe;
+    int IpcPort;
+    int NotifyInterval;                 // seconds
+    int Duration;                       // seconds to run once every client has been started
+    int ServerPid;
+} Options;
+
+typedef struct
+{
+    LatencySamples Register;
+    LatencySamples Update;
+    LatencySamples Deregister;
+    unsigned long Retransmissions;
+    unsigned long Timeouts;
+    unsigned long Rejected;             // requests answered with an error code
+    unsigned long RequestsAnswered;     // GET and Observe requests from the server
+    unsigned long NotificationsSent;
+    unsigned long NotificationsReset;
+    unsigned long SendErrors;
+    double FirstRegisterSent;
+    double LastRegisterDone;
+} MainStats;
+
+typedef struct
+{
+    LatencySamples Notify;              // value stamped by the virtual client to the observe callback
+    unsigned long Requested;
+    unsigned long Succeeded;
+    unsigned long Failed;
+} ObserverStats;
+
+static Options options =
+{
+    .ServerAddress = "127.0.0.1",
+    .ServerPort = "5683",
+    .NumClients = 1000,
+    .Rate = 200,
+    .UpdateInterval = 10,
+    .Lifetime = 60,
+    .Observe = false,
+    .IpcPort = 54321,
+    .NotifyInterval = 5,
+    .Duration = 10,
+    .ServerPid = 0,
+};
+
+static EventLoop * loop;
+static VirtualClient * clients;
+static MainStats stats;
+static ObserverStats observerStats;
+static double startTime;
+static bool stopping;
+static int numFinished;
+static int numDeregistersScheduled;
+
+static RingQueue registeredClients;     // main thread to observer thread
+static int observerRunning;
+static pthread_t observerThread;
+
+static ObjectDefinition * deviceDefinition;
+static Lwm2mTreeNode * batteryLevel;
+static Lwm2mTreeNode * batteryLevelValue;
+
+static double NowMs(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e3 + ts.tv_nsec / 1e6;
+}
+
+static void AddSample(LatencySamples * samples, double value)
+{
+    if (samples->Count == samples->Capacity)
+    {
+        size_t capacity = samples->Capacity ? samples->Capacity * 2 : 1024;
+        double * values = realloc(samples->Values, capacity * sizeof(double));
+        if (values == NULL)
+        {
+            return;
+        }
+        samples->Values = values;
+        samples->Capacity = capacity;
+    }
+    samples->Values[samples->Count++] = value;
+}
+
+static int CompareDoubles(const void * a, const void * b)
+{
+    double x = *(const double *)a;
+    double y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+static void PrintLatencies(const char * name, LatencySamples * samples)
+{
+    if (samples->Count == 0)
+    {
+        printf("  %-12s no samples\n", name);
+        return;
+    }
+    qsort(samples->Values, samples->Count, sizeof(double), CompareDoubles);
+    printf("  %-12s %8zu samples  p50 %8.2f ms  p90 %8.2f ms  p99 %8.2f ms  max %8.2f ms\n", name, samples->Count,
+           samples->Values[samples->Count * 50 / 100], samples->Values[samples->Count * 90 / 100],
+           samples->Values[samples->Count * 99 / 100], samples->Values[samples->Count - 1]);
+}
+
+// Resident set size of the server in kB, or -1 if it cannot be read
+static long ServerRss(void)
+{
+    char path[64];
+    char line[128];
+    long rss = -1;
+    FILE * file;
+
+    if (options.ServerPid <= 0)
+    {
+        return -1;
+    }
+    snprintf(path, sizeof(path), "/proc/%d/status", options.ServerPid);
+    if ((file = fopen(path, "r")) == NULL)
+    {
+        return -1;
+    }
+    while (fgets(line, sizeof(line), file) != NULL)
+    {
+        if (sscanf(line, "VmRSS: %ld kB", &rss) == 1)
+        {
+            break;
+        }
+    }
+    fclose(file);
+    return rss;
+}
+
+static int InitPayload(void)
+{
+    ResourceDefinition * resource;
+
+    deviceDefinition = Definition_NewObjectType("Device", 3, 1, 0, NULL);
+    if (deviceDefinition == NULL)
+    {
+        return -1;
+    }
+    resource = Definition_NewResourceType(deviceDefinition, "BatteryLevel", 9, AwaResourceType_Integer, 1, 0,
+                                          AwaResourceOperations_ReadOnly, NULL, NULL);
+    batteryLevel = Lwm2mTreeNode_Create();
+    batteryLevelValue = Lwm2mTreeNode_Create();
+    if ((resource == NULL) || (batteryLevel == NULL) || (batteryLevelValue == NULL))
+    {
+        return -1;
+    }
+    Lwm2mTreeNode_SetType(batteryLevel, Lwm2mTreeNodeType_Resource);
+    Lwm2mTreeNode_SetID(batteryLevel, 9);
+    Lwm2mTreeNode_SetDefinition(batteryLevel, resource);
+    Lwm2mTreeNode_SetType(batteryLevelValue, Lwm2mTreeNodeType_ResourceInstance);
+    Lwm2mTreeNode_SetID(batteryLevelValue, 0);
+    Lwm2mTreeNode_AddChild(batteryLevel, batteryLevelValue);
+    return 0;
+}
+
+// The reported value is the time since start, so the observer can work out how long a notification took
+static int SerialisePayload(uint8_t * buffer, int length)
+{
+    int64_t value = (int64_t)(NowMs() - startTime);
+    Lwm2mTreeNode_SetValue(batteryLevelValue, (const uint8_t *)&value, sizeof(value));
+    return SerialiseResource(AwaContentType_ApplicationOmaLwm2mTLV, batteryLevel, 3, 0, 9, (char *)buffer, length);
+}
+
+static void Send(VirtualClient * client, const uint8_t * buffer, size_t length)
+{
+    if (send(client->Socket, buffer, length, 0) < 0)
+    {
+        stats.SendErrors++;
+    }
+}
+
+static void SendRequest(VirtualClient * client, RequestKind kind)
+{
+    coap_packet_t packet;
+    char query[96];
+    uint16_t messageID = client->NextMessageID++;
+    uint8_t token[2] = { messageID >> 8, messageID & 0xff };
+
+    coap_init_message(&packet, COAP_TYPE_CON, (kind == Request_Deregister) ? COAP_DELETE : COAP_POST, messageID);
+    coap_set_token(&packet, token, sizeof(token));
+    if (kind == Request_Register)
+    {
+        static const char objectLinks[] = "</1/0>,</3/0>";
+        snprintf(query, sizeof(query), "ep=%s&lt=%d&b=U", client->Name, options.Lifetime);
+        coap_set_header_uri_path(&packet, "rd");
+        coap_set_header_uri_query(&packet, query);
+        coap_set_header_content_format(&packet, CONTENT_FORMAT_LINK_FORMAT);
+        coap_set_payload(&packet, objectLinks, sizeof(objectLinks) - 1);
+        if (stats.FirstRegisterSent == 0)
+        {
+            stats.FirstRegisterSent = NowMs();
+        }
+    }
+    else
+    {
+        coap_set_header_uri_path(&packet, client->Location);
+    }
+
+    client->RequestLength = coap_serialize_message(&packet, client->Request);
+    client->Pending = kind;
+    client->PendingMessageID = messageID;
+    client->Retries = 0;
+    client->SentAt = NowMs();
+    Send(client, client->Request, client->RequestLength);
+    EventLoop_StartTimer(loop, &client->RequestTimer, ACK_TIMEOUT);
+}
+
+static void Finish(VirtualClient * client, ClientState state)
+{
+    client->State = state;
+    client->Observed = false;
+    EventLoop_StopTimer(loop, &client->RequestTimer);
+    EventLoop_StopTimer(loop, &client->NotifyTimer);
+    numFinished++;
+}
+
+// Start deregistering, spread out at the configured rate
+static void ScheduleDeregister(VirtualClient * client)
+{
+    EventLoop_StopTimer(loop, &client->NotifyTimer);
+    client->Observed = false;
+    EventLoop_StartTimer(loop, &client->RequestTimer, (int)(numDeregistersScheduled++ * 1000.0 / options.Rate));
+}
+
+static void RequestDone(VirtualClient * client, bool succeeded)
+{
+    RequestKind kind = client->Pending;
+    double latency = NowMs() - client->SentAt;
+
+    client->Pending = Request_None;
+    EventLoop_StopTimer(loop, &client->RequestTimer);
+
+    switch (kind)
+    {
+        case Request_Register:
+            if (!succeeded)
+            {
+                Finish(client, ClientState_Failed);
+                break;
+            }
+            AddSample(&stats.Register, latency);
+            stats.LastRegisterDone = NowMs();
+            client->State = ClientState_Registered;
+            if (stopping)
+            {
+                ScheduleDeregister(client);
+                break;
+            }
+            if (options.Observe)
+            {
+                RingQueue_Push(&registeredClients, client);
+            }
+            EventLoop_StartTimer(loop, &client->RequestTimer, options.UpdateInterval * 1000);
+            break;
+
+        case Request_Update:
+            if (succeeded)
+            {
+                AddSample(&stats.Update, latency);
+            }
+            if (stopping)
+            {
+                ScheduleDeregister(client);
+                break;
+            }
+            EventLoop_StartTimer(loop, &client->RequestTimer, options.UpdateInterval * 1000);
+            break;
+
+        case Request_Deregister:
+            if (succeeded)
+            {
+                AddSample(&stats.Deregister, latency);
+            }
+            Finish(client, ClientState_Deregistered);
+            break;
+
+        default:
+            break;
+    }
+}
+
+static void RequestTimerCallback(EventLoop * eventLoop, void * context)
+{
+    VirtualClient * client = context;
+
+    (void)eventLoop;
+    if (client->Pending != Request_None)
+    {
+        if (client->Retries < MAX_RETRANSMIT)
+        {
+            client->Retries++;
+            stats.Retransmissions++;
+            Send(client, client->Request, client->RequestLength);
+            EventLoop_StartTimer(loop, &client->RequestTimer, ACK_TIMEOUT << client->Retries);
+        }
+        else
+        {
+            stats.Timeouts++;
+            RequestDone(client, false);
+        }
+    }
+    else if (client->State == ClientState_Unregistered)
+    {
+        SendRequest(client, Request_Register);
+    }
+    else if (client->State == ClientState_Registered)
+    {
+        SendRequest(client, stopping ? Request_Deregister : Request_Update);
+    }
+}
+
+static void SendNotification(VirtualClient * client)
+{
+    coap_packet_t packet;
+    uint8_t payload[64];
+    uint8_t buffer[COAP_MAX_PACKET_SIZE];
+    int payloadLength = SerialisePayload(payload, sizeof(payload));
+
+    if (payloadLength < 0)
+    {
+        return;
+    }
+    client->NotifyMessageID = client->NextMessageID++;
+    coap_init_message(&packet, COAP_TYPE_NON, CONTENT_2_05, client->NotifyMessageID);
+    coap_set_token(&packet, client->ObserveToken, client->ObserveTokenLength);
+    coap_set_header_observe(&packet, ++client->ObserveSequence);
+    coap_set_header_content_format(&packet, AwaContentType_ApplicationOmaLwm2mTLV);
+    coap_set_payload(&packet, payload, payloadLength);
+    Send(client, buffer, coap_serialize_message(&packet, buffer));
+    stats.NotificationsSent++;
+}
+
+static void NotifyTimerCallback(EventLoop * eventLoop, void * context)
+{
+    VirtualClient * client = context;
+
+    (void)eventLoop;
+    if (client->Observed && !stopping)
+    {
+        SendNotification(client);
+        EventLoop_StartTimer(loop, &client->NotifyTimer, options.NotifyInterval * 1000);
+    }
+}
+
+// Answer a request from the server: only reads of the battery level are supported
+static void HandleServerRequest(VirtualClient * client, coap_packet_t * request)
+{
+    coap_packet_t response;
+    uint8_t payload[64];
+    uint8_t buffer[COAP_MAX_PACKET_SIZE];
+    const char * path = NULL;
+    int pathLength = coap_get_header_uri_path(request, &path);
+    uint32_t observe = 0;
+
+    if (request->type == COAP_TYPE_CON)
+    {
+        coap_init_message(&response, COAP_TYPE_ACK, CONTENT_2_05, request->mid);
+    }
+    else
+    {
+        coap_init_message(&response, COAP_TYPE_NON, CONTENT_2_05, client->NextMessageID++);
+    }
+    coap_set_token(&response, request->token, request->token_len);
+
+    if (request->code != COAP_GET)
+    {
+        response.code = METHOD_NOT_ALLOWED_4_05;
+    }
+    else if ((pathLength != strlen(OBSERVED_PATH) - 1) || (memcmp(path, OBSERVED_PATH + 1, pathLength) != 0))
+    {
+        response.code = NOT_FOUND_4_04;
+    }
+    else
+    {
+        int payloadLength = SerialisePayload(payload, sizeof(payload));
+        if (payloadLength < 0)
+        {
+            response.code = INTERNAL_SERVER_ERROR_5_00;
+        }
+        else
+        {
+            coap_set_header_content_format(&response, AwaContentType_ApplicationOmaLwm2mTLV);
+            coap_set_payload(&response, payload, payloadLength);
+        }
+
+        if (IS_OPTION(request, COAP_OPTION_OBSERVE) && (coap_get_header_observe(request, &observe), observe == 0))
+        {
+            memcpy(client->ObserveToken, request->token, request->token_len);
+            client->ObserveTokenLength = request->token_len;
+            coap_set_header_observe(&response, ++client->ObserveSequence);
+            if (!client->Observed && !stopping)
+            {
+                client->Observed = true;
+                EventLoop_StartTimer(loop, &client->NotifyTimer, options.NotifyInterval * 1000);
+            }
+        }
+        else if (IS_OPTION(request, COAP_OPTION_OBSERVE))
+        {
+            client->Observed = false;
+            EventLoop_StopTimer(loop, &client->NotifyTimer);
+        }
+    }
+
+    Send(client, buffer, coap_serialize_message(&response, buffer));
+    stats.RequestsAnswered++;
+}
+
+static void HandleResponse(VirtualClient * client, coap_packet_t * response)
+{
+    bool succeeded = false;
+
+    if (response->type == COAP_TYPE_ACK)
+    {
+        switch (client->Pending)
+        {
+            case Request_Register:
+                if (response->code == CREATED_2_01)
+                {
+                    const char * location = NULL;
+                    int length = coap_get_header_location_path(response, &location);
+                    if ((length > 0) && (length < sizeof(client->Location)))
+                    {
+                        memcpy(client->Location, location, length);
+                        client->Location[length] = '\0';
+                        succeeded = true;
+                    }
+                }
+                break;
+            case Request_Update:
+                succeeded = (response->code == CHANGED_2_04);
+                break;
+            case Request_Deregister:
+                succeeded = (response->code == DELETED_2_02);
+                break;
+            default:
+                break;
+        }
+    }
+    if (!succeeded)
+    {
+        stats.Rejected++;
+    }
+    RequestDone(client, succeeded);
+}
+
+static void ClientReadable(EventLoop * eventLoop, int fd, void * context)
+{
+    VirtualClient * client = context;
+    uint8_t buffer[COAP_MAX_PACKET_SIZE];
+    coap_packet_t packet;
+    ssize_t length;
+
+    (void)eventLoop;
+    while ((length = recv(fd, buffer, sizeof(buffer), 0)) >= 0)
+    {
+        if (coap_parse_message(&packet, buffer, length) != NO_ERROR)
+        {
+            continue;
+        }
+        if ((packet.code >= COAP_GET) && (packet.code <= COAP_DELETE))
+        {
+            HandleServerRequest(client, &packet);
+        }
+        else if ((client->Pending != Request_None) && (packet.mid == client->PendingMessageID) &&
+                 ((packet.type == COAP_TYPE_ACK) || (packet.type == COAP_TYPE_RST)))
+        {
+            HandleResponse(client, &packet);
+        }
+        else if ((packet.type == COAP_TYPE_RST) && (packet.mid == client->NotifyMessageID) && client->Observed)
+        {
+            // the server has forgotten the observation
+            client->Observed = false;
+            EventLoop_StopTimer(loop, &client->NotifyTimer);
+            stats.NotificationsReset++;
+        }
+    }
+}
+
+static int OpenClientSocket(const struct addrinfo * server)
+{
+    int fd = socket(server->ai_family, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0)
+    {
+        return -1;
+    }
+    if (connect(fd, server->ai_addr, server->ai_addrlen) != 0)
+    {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+static void ObservationCallback(const AwaChangeSet * changeSet, void * context)
+{
+    const AwaInteger * value = NULL;
+
+    (void)context;
+    if (AwaChangeSet_GetValueAsIntegerPointer(changeSet, OBSERVED_PATH, &value) == AwaError_Success)
+    {
+        AddSample(&observerStats.Notify, NowMs() - startTime - *value);
+    }
+}
+
+// Observe each client the main thread hands over and time the notifications that arrive. Each client gets
+// its own operation, as the server handles one client per IPC request.
+static void * ObserverThread(void * context)
+{
+    AwaServerSession * session = context;
+    AwaServerObservation ** observations = calloc(options.NumClients, sizeof(AwaServerObservation *));
+    int i;
+
+    while (__atomic_load_n(&observerRunning, __ATOMIC_ACQUIRE))
+    {
+        VirtualClient * client = RingQueue_Pop(&registeredClients);
+
+        if ((client != NULL) && (observations != NULL))
+        {
+            AwaServerObserveOperation * operation = AwaServerObserveOperation_New(session);
+            const AwaServerObserveResponse * response;
+            const AwaPathResult * result = NULL;
+
+            observations[client->Index] = AwaServerObservation_New(client->Name, OBSERVED_PATH, ObservationCallback, NULL);
+            AwaServerObserveOperation_AddObservation(operation, observations[client->Index]);
+            observerStats.Requested++;
+            if (AwaServerObserveOperation_Perform(operation, OBSERVE_TIMEOUT) == AwaError_Success)
+            {
+                response = AwaServerObserveOperation_GetResponse(operation, client->Name);
+                result = (response != NULL) ? AwaServerObserveResponse_GetPathResult(response, OBSERVED_PATH) : NULL;
+            }
+            if ((result != NULL) && (AwaPathResult_GetError(result) == AwaError_Success))
+            {
+                observerStats.Succeeded++;
+            }
+            else
+            {
+                observerStats.Failed++;
+            }
+            AwaServerObserveOperation_Free(&operation);
+        }
+
+        AwaServerSession_Process(session, (client != NULL) ? 0 : 50);
+        AwaServerSession_DispatchCallbacks(session);
+    }
+
+    if (observations != NULL)
+    {
+        for (i = 0; i < options.NumClients; i++)
+        {
+            AwaServerObservation_Free(&observations[i]);
+        }
+        free(observations);
+    }
+    return NULL;
+}
+
+static AwaServerSession * ConnectObserver(void)
+{
+    AwaServerSession * session = AwaServerSession_New();
+    if (session == NULL)
+    {
+        return NULL;
+    }
+    if ((AwaServerSession_SetIPCAsUDP(session, "127.0.0.1", options.IpcPort) != AwaError_Success) ||
+        (AwaServerSession_Connect(session) != AwaError_Success))
+    {
+        AwaServerSession_Free(&session);
+    }
+    return session;
+}
+
+static void StopObserver(AwaServerSession ** session)
+{
+    if (*session != NULL)
+    {
+        __atomic_store_n(&observerRunning, 0, __ATOMIC_RELEASE);
+        pthread_join(observerThread, NULL);
+        AwaServerSession_Disconnect(*session);
+        AwaServerSession_Free(session);
+    }
+}
+
+// Begin deregistering: clients waiting on a response deregister once it arrives
+static void Stop(void)
+{
+    int i;
+
+    stopping = true;
+    for (i = 0; i < options.NumClients; i++)
+    {
+        VirtualClient * client = &clients[i];
+        if (client->Pending != Request_None)
+        {
+            continue;
+        }
+        if (client->State == ClientState_Registered)
+        {
+            ScheduleDeregister(client);
+        }
+        else if (client->State == ClientState_Unregistered)
+        {
+            Finish(client, ClientState_Deregistered);
+        }
+    }
+}
+
+static void PrintProgress(long * peakRss)
+{
+    int registered = 0;
+    int observed = 0;
+    long rss = ServerRss();
+    int i;
+
+    for (i = 0; i < options.NumClients; i++)
+    {
+        registered += (clients[i].State == ClientState_Registered);
+        observed += clients[i].Observed;
+    }
+    if (rss > *peakRss)
+    {
+        *peakRss = rss;
+    }
+    printf("%6.1f s: %d registered, %d observed, %lu notifications, %lu retransmissions, server RSS %ld kB\n",
+           (NowMs() - startTime) / 1000, registered, observed, stats.NotificationsSent, stats.Retransmissions, rss);
+    fflush(stdout);
+}
+
+static void PrintUsage(const char * program)
+{
+    fprintf(stderr,
+            "Usage: %s [options]\n"
+            "  -s, --server=ADDRESS        server address (default 127.0.0.1)\n"
+            "  -p, --port=PORT             server CoAP port (default 5683)\n"
+            "  -n, --clients=N             virtual clients (default 1000)\n"
+            "  -r, --rate=N                registrations started per second (default 200)\n"
+            "  -u, --updateInterval=SECS   time between registration updates (default 10)\n"
+            "  -l, --lifetime=SECS         registration lifetime (default 60)\n"
+            "  -o, --observe               observe every client through the server API\n"
+            "  -i, --ipcPort=PORT          server IPC port, with --observe (default 54321)\n"
+            "  -t, --notifyInterval=SECS   time between notifications from an observed client (default 5)\n"
+            "  -d, --duration=SECS         run time after the last client has started (default 10)\n"
+            "  -P, --serverPid=PID         report the server's resident set size\n",
+            program);
+}
+
+static int ParseOptions(int argc, char ** argv)
+{
+    static const struct option longOptions[] =
+    {
+        { "server", required_argument, NULL, 's' },
+        { "port", required_argument, NULL, 'p' },
+        { "clients", required_argument, NULL, 'n' },
+        { "rate", required_argument, NULL, 'r' },
+        { "updateInterval", required_argument, NULL, 'u' },
+        { "lifetime", required_argument, NULL, 'l' },
+        { "observe", no_argument, NULL, 'o' },
+        { "ipcPort", required_argument, NULL, 'i' },
+        { "notifyInterval", required_argument, NULL, 't' },
+        { "duration", required_argument, NULL, 'd' },
+        { "serverPid", required_argument, NULL, 'P' },
+        { NULL, 0, NULL, 0 },
+    };
+    int option;
+
+    while ((option = getopt_long(argc, argv, "s:p:n:r:u:l:oi:t:d:P:", longOptions, NULL)) != -1)
+    {
+        switch (option)
+        {
+            case 's': options.ServerAddress = optarg; break;
+            case 'p': options.ServerPort = optarg; break;
+            case 'n': options.NumClients = atoi(optarg); break;
+            case 'r': options.Rate = atof(optarg); break;
+            case 'u': options.UpdateInterval = atoi(optarg); break;
+            case 'l': options.Lifetime = atoi(optarg); break;
+            case 'o': options.Observe = true; break;
+            case 'i': options.IpcPort = atoi(optarg); break;
+            case 't': options.NotifyInterval = atoi(optarg); break;
+            case 'd': options.Duration = atoi(optarg); break;
+            case 'P': options.ServerPid = atoi(optarg); break;
+            default: return -1;
+        }
+    }
+    if ((optind != argc) || (options.NumClients <= 0) || (options.Rate <= 0) || (options.UpdateInterval <= 0) ||
+        (options.Lifetime <= 0) || (options.NotifyInterval <= 0) || (options.Duration < 0))
+    {
+        return -1;
+    }
+    return 0;
+}
+
+int main(int argc, char ** argv)
+{
+    struct addrinfo hints = { .ai_socktype = SOCK_DGRAM };
+    struct addrinfo * server = NULL;
+    struct rlimit limit;
+    AwaServerSession * observerSession = NULL;
+    double rampMs;
+    double stopAt;
+    double drainUntil;
+    double nextProgress;
+    long startRss;
+    long peakRss;
+    double elapsed;
+    int i;
+
+    if (ParseOptions(argc, argv) != 0)
+    {
+        PrintUsage(argv[0]);
+        return 1;
+    }
+    Lwm2m_SetLogLevel(DebugLevel_Warning);
+
+    if (getaddrinfo(options.ServerAddress, options.ServerPort, &hints, &server) != 0)
+    {
+        fprintf(stderr, "Unable to resolve %s:%s\n", options.ServerAddress, options.ServerPort);
+        return 1;
+    }
+
+    // one socket per virtual client
+    if (getrlimit(RLIMIT_NOFILE, &limit) == 0)
+    {
+        limit.rlim_cur = limit.rlim_max;
+        setrlimit(RLIMIT_NOFILE, &limit);
+    }
+
+    loop = EventLoop_New();
+    clients = calloc(options.NumClients, sizeof(VirtualClient));
+    if ((loop == NULL) || (clients == NULL) || (InitPayload() != 0) ||
+        (RingQueue_Init(&registeredClients, options.NumClients) != 0))
+    {
+        fprintf(stderr, "Out of memory\n");
+        return 1;
+    }
+
+    if (options.Observe)
+    {
+        if ((observerSession = ConnectObserver()) == NULL)
+        {
+            fprintf(stderr, "Unable to connect to the server API on port %d\n", options.IpcPort);
+            return 1;
+        }
+        __atomic_store_n(&observerRunning, 1, __ATOMIC_RELEASE);
+        if (pthread_create(&observerThread, NULL, ObserverThread, observerSession) != 0)
+        {
+            fprintf(stderr, "Unable to start the observer thread\n");
+            return 1;
+        }
+    }
+
+    srandom(getpid());
+    startTime = NowMs();
+    for (i = 0; i < options.NumClients; i++)
+    {
+        VirtualClient * client = &clients[i];
+        client->Index = i;
+        client->NextMessageID = random();
+        snprintf(client->Name, sizeof(client->Name), "loadgen-%d-%d", getpid(), i);
+        EventLoop_InitTimer(&client->RequestTimer, RequestTimerCallback, client);
+        EventLoop_InitTimer(&client->NotifyTimer, NotifyTimerCallback, client);
+        client->Socket = OpenClientSocket(server);
+        if ((client->Socket < 0) || (EventLoop_AddFd(loop, client->Socket, ClientReadable, client) != 0))
+        {
+            fprintf(stderr, "Unable to open a socket for client %d: %s\n", i, strerror(errno));
+            return 1;
+        }
+        EventLoop_StartTimer(loop, &client->RequestTimer, (int)(i * 1000.0 / options.Rate));
+    }
+    freeaddrinfo(server);
+
+    printf("%d clients registering at %.0f/s against %s:%s, updating every %d s%s\n", options.NumClients, options.Rate,
+           options.ServerAddress, options.ServerPort, options.UpdateInterval, options.Observe ? ", observed" : "");
+    rampMs = options.NumClients * 1000.0 / options.Rate;
+    stopAt = startTime + rampMs + options.Duration * 1000.0;
+    drainUntil = 0;
+    nextProgress = startTime + PROGRESS_INTERVAL;
+    startRss = ServerRss();
+    peakRss = startRss;
+
+    while (numFinished < options.NumClients)
+    {
+        double now = NowMs();
+        if (!stopping && (now >= stopAt))
+        {
+            StopObserver(&observerSession);
+            Stop();
+            drainUntil = now + rampMs + DRAIN_TIMEOUT;
+        }
+        if (stopping && (now >= drainUntil))
+        {
+            break;
+        }
+        if (now >= nextProgress)
+        {
+            PrintProgress(&peakRss);
+            nextProgress += PROGRESS_INTERVAL;
+        }
+        if ((EventLoop_RunOnce(loop, 100) < 0) && (errno != EINTR))
+        {
+            perror("EventLoop_RunOnce");
+            break;
+        }
+    }
+    elapsed = (stats.LastRegisterDone - stats.FirstRegisterSent) / 1000;
+
+    printf("\nRegistrations: %zu of %d in %.2f s, %.1f/s\n", stats.Register.Count, options.NumClients, elapsed,
+           (elapsed > 0) ? stats.Register.Count / elapsed : 0);
+    printf("Request latency:\n");
+    PrintLatencies("register", &stats.Register);
+    PrintLatencies("update", &stats.Update);
+    PrintLatencies("deregister", &stats.Deregister);
+    printf("Retransmissions %lu, timeouts %lu, rejected %lu, send errors %lu, unfinished %d\n", stats.Retransmissions,
+           stats.Timeouts, stats.Rejected, stats.SendErrors, options.NumClients - numFinished);
+    printf("Server requests answered %lu, notifications sent %lu, reset %lu\n", stats.RequestsAnswered,
+           stats.NotificationsSent, stats.NotificationsReset);
+    if (options.Observe)
+    {
+        printf("Observations requested %lu, succeeded %lu, failed %lu\n", observerStats.Requested,
+               observerStats.Succeeded, observerStats.Failed);
+        PrintLatencies("notify", &observerStats.Notify);
+    }
+    if (options.ServerPid > 0)
+    {
+        printf("Server RSS: start %ld kB, peak %ld kB, end %ld kB\n", startRss, peakRss, ServerRss());
+    }
+
+    StopObserver(&observerSession);
+    for (i = 0; i < options.NumClients; i++)
+    {
+        EventLoop_RemoveFd(loop, clients[i].Socket);
+        close(clients[i].Socket);
+    }
+    EventLoop_Free(&loop);
+    free(clients);
+    RingQueue_Destroy(&registeredClients);
+    Lwm2mTreeNode_DeleteRecursive(batteryLevel);
+    Definition_FreeObjectType(deviceDefinition);
+    free(stats.Register.Values);
+    free(stats.Update.Values);
+    free(stats.Deregister.Values);
+    free(observerStats.Notify.Values);
+    return 0;
+}
@@ -185,19 +185,23 @@ static void BootstrapTransactionCallback(void * context, AddressType * addr, con
             char payload[MAX_PAYLOAD_LENGTH];
             int payloadLen;
             Lwm2mTreeNode * objectInstance;
+            uint8_t arenaBlock[LWM2M_TREE_ARENA_INITIAL_SIZE];
+            MemoryArena arena;
+
+            MemoryArena_Init(&arena, arenaBlock, sizeof(arenaBlock), LWM2M_TREE_ARENA_BLOCK_SIZE);
 
             // Write object, with callback to write next object on success
             sprintf(uri, "%s/%d", server, client->ObjectID); // Since we are creating a new object instance, we must post to the object level
-            TreeBuilder_CreateTreeFromObjectInstance(&objectInstance, client->Context, Lwm2mRequestOrigin_BootstrapServer, client->ObjectID, client->ObjectInstanceID);
+            TreeBuilder_CreateTreeFromObjectInstance(&objectInstance, &arena, client->Context, Lwm2mRequestOrigin_BootstrapServer, client->ObjectID, client->ObjectInstanceID);
 
             // Wrap the object instance in an object node
-            Lwm2mTreeNode * object = Lwm2mTreeNode_Create();
+            Lwm2mTreeNode * object = Lwm2mTreeNode_CreateInArena(&arena);
             Lwm2mTreeNode_SetType(object, Lwm2mTreeNodeType_Object);
             Lwm2mTreeNode_SetID(object, client->ObjectID);
             Lwm2mTreeNode_AddChild(object, objectInstance);
 
             payloadLen = SerialiseObject(AwaContentType_ApplicationOmaLwm2mTLV_Old, object, client->ObjectID, payload, sizeof(payload));
-            Lwm2mTreeNode_DeleteRecursive(object);
+            MemoryArena_Destroy(&arena);
 
             Lwm2m_Debug("Put to %s\n", uri);
             coap_PutRequest(context, uri, AwaContentType_ApplicationOmaLwm2mTLV_Old, payload, payloadLen, BootstrapTransactionCallback);
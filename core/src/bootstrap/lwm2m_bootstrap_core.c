@@ -116,6 +116,15 @@ int Lwm2mCore_GetResourceInstanceValue(Lwm2mContextType * context, ObjectIDType
                                                 bufferLen);
 }
 
+bool Lwm2mCore_IsResourceValueStable(Lwm2mContextType * context, ObjectIDType objectID, ResourceIDType resourceID)
+{
+    // every value is read from the object store
+    (void)context;
+    (void)objectID;
+    (void)resourceID;
+    return true;
+}
+
 ObjectInstanceIDType Lwm2mCore_GetNextObjectInstanceID(Lwm2mContextType * context, ObjectIDType  objectID, ObjectInstanceIDType objectInstanceID)
 {
     return ObjectStore_GetNextObjectInstanceID(context->Store, objectID, objectInstanceID);
@@ -131,6 +140,16 @@ ResourceInstanceIDType Lwm2mCore_GetNextResourceInstanceID(Lwm2mContextType * co
     return ObjectStore_GetNextResourceInstanceID(context->Store, objectID, objectInstanceID, resourceID, resourceInstanceID);
 }
 
+int Lwm2mCore_InitIterator(Lwm2mContextType * context, Lwm2mCoreIterator * iterator, ObjectIDType objectID, ObjectInstanceIDType objectInstanceID, ResourceIDType resourceID)
+{
+    return ObjectStore_InitIterator(context->Store, iterator, objectID, objectInstanceID, resourceID);
+}
+
+int Lwm2mCore_IteratorNext(Lwm2mCoreIterator * iterator)
+{
+    return ObjectStore_IteratorNext(iterator);
+}
+
 int Lwm2mCore_AddResourceEndPoint(Lwm2mContextType * context, const char * path, EndpointHandlerFunction handler)
 {
     return Lwm2mEndPoint_AddResourceEndPoint(&context->EndPointList, path, handler);
@@ -192,15 +211,14 @@ Lwm2mContextType * Lwm2mCore_Init(CoapInfo * coap)
  * @brief Update the LWM2M state machine
  *
  * @param[in] content
- * @returns time until next service (TODO)
+ * @returns time until next service, always -1: bootstraps are started by requests to /bs and
+ *          carried on by their CoAP responses, so there is nothing to wake up for in between
  */
 int Lwm2mCore_Process(Lwm2mContextType * context)
 {
-    int nextTick = 10;
-
     Lwm2mBootstrap_BootStrapUpdate(context);
 
-    return nextTick;
+    return -1;
 }
 
 void Lwm2mCore_Destroy(Lwm2mContextType * context)
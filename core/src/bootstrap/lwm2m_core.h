@@ -44,6 +44,8 @@
 extern "C" {
 #endif
 
+typedef ObjectStoreIterator Lwm2mCoreIterator;
+
 Lwm2mContextType * Lwm2mCore_Init(CoapInfo * coap);
 
 // Update the LWM2M state machine, process any message timeouts, registration attempts etc.
@@ -58,6 +60,10 @@ void Lwm2mCore_Destroy(Lwm2mContextType * context);
 int Lwm2mCore_GetResourceInstanceValue(Lwm2mContextType * context, ObjectIDType objectID, ObjectInstanceIDType objectInstanceID, ResourceIDType resourceID,
                                        ResourceInstanceIDType resourceInstanceID, const void ** buffer, size_t * bufferLen);
 
+// True if values from Lwm2mCore_GetResourceInstanceValue for this resource stay valid until the resource is next
+// changed, rather than being produced by a handler that may reuse its buffer.
+bool Lwm2mCore_IsResourceValueStable(Lwm2mContextType * context, ObjectIDType objectID, ResourceIDType resourceID);
+
 int Lwm2mCore_GetResourceInstanceLength(Lwm2mContextType * context, ObjectIDType objectID, ObjectInstanceIDType objectInstanceID, ResourceIDType resourceID, ResourceInstanceIDType resourceInstanceID);
 int Lwm2mCore_GetResourceInstanceCount(Lwm2mContextType * context, ObjectIDType objectID, ObjectInstanceIDType objectInstanceID, ResourceIDType resourceID);
 
@@ -84,6 +90,10 @@ ObjectInstanceIDType Lwm2mCore_GetNextObjectInstanceID(Lwm2mContextType * contex
 ResourceIDType Lwm2mCore_GetNextResourceID(Lwm2mContextType * context, ObjectIDType objectID, ObjectInstanceIDType objectInstanceID, ResourceIDType resourceID);
 ResourceInstanceIDType Lwm2mCore_GetNextResourceInstanceID(Lwm2mContextType * context, ObjectIDType objectID, ObjectInstanceIDType objectInstanceID, ResourceIDType resourceID, ResourceInstanceIDType resourceInstanceID);
 
+// Walk the children of a path (objects if objectID is -1) without looking the previous ID up again on each step
+int Lwm2mCore_InitIterator(Lwm2mContextType * context, Lwm2mCoreIterator * iterator, ObjectIDType objectID, ObjectInstanceIDType objectInstanceID, ResourceIDType resourceID);
+int Lwm2mCore_IteratorNext(Lwm2mCoreIterator * iterator);
+
 int Lwm2mCore_AddResourceEndPoint(Lwm2mContextType * context, const char * path, EndpointHandlerFunction handler);
 DefinitionRegistry * Lwm2mCore_GetDefinitions(Lwm2mContextType * context);
 
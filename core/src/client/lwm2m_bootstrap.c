@@ -183,6 +183,39 @@ void Lwm2m_BootStrapInit(Lwm2mContextType * context)
     Lwm2mCore_AddResourceEndPoint(context, "/bs", BootstrapEndpointHandler);
 }
 
+// Time until the bootstrap state next needs attention, or -1 if it waits on registration or the bootstrap server
+static int GetBootStrapTimeout(Lwm2mContextType * context, uint32_t now)
+{
+    int timeout = -1;
+    uint32_t clientHoldOff;
+    enum { SERVER_BOOTSTRAP = 0 };
+
+    switch (Lwm2mCore_GetBootstrapState(context))
+    {
+        case Lwm2mBootStrapState_NotBootStrapped:
+            timeout = 0;
+            break;
+
+        case Lwm2mBootStrapState_ClientHoldOff:
+        case Lwm2mBootStrapState_BootStrapFailed:
+            Lwm2m_GetClientHoldOff(context, SERVER_BOOTSTRAP, &clientHoldOff);
+            timeout = Lwm2mCore_GetTimeRemaining(now, Lwm2mCore_GetLastBootStrapUpdate(context), clientHoldOff * 1000);
+            break;
+
+        case Lwm2mBootStrapState_BootStrapPending:
+            timeout = Lwm2mCore_GetTimeRemaining(now, Lwm2mCore_GetLastBootStrapUpdate(context), BOOTSTRAP_TIMEOUT);
+            break;
+
+        case Lwm2mBootStrapState_BootStrapFinishPending:
+            timeout = Lwm2mCore_GetTimeRemaining(now, Lwm2mCore_GetLastBootStrapUpdate(context), BOOTSTRAP_FINISHED_TIMEOUT);
+            break;
+
+        default:
+            break;
+    }
+    return timeout;
+}
+
 /* The LWM2M Client MUST follow the procedure specified as below when attempting to bootstrap a LWM2M Device:
  * 1. If the LWM2M Device has Smartcard, the LWM2M Client tries to obtain Bootstrap Information
  *    from the Smartcard using the Bootstrap from Smartcard mode.
@@ -194,7 +227,7 @@ void Lwm2m_BootStrapInit(Lwm2mContextType * context)
  *    LWM2M Server Object Instances, and the LWM2M Client hasn’t received a Server Initiated Bootstrap
  *    within the ClientHoldOffTime, the LWM2M Client performs the Client Initiated Bootstrap.
  */
-void Lwm2m_UpdateBootStrapState(Lwm2mContextType * context)
+int Lwm2m_UpdateBootStrapState(Lwm2mContextType * context)
 {
     uint32_t now = Lwm2mCore_GetTickCountMs();
     uint32_t clientHoldOff;
@@ -284,4 +317,5 @@ void Lwm2m_UpdateBootStrapState(Lwm2mContextType * context)
         default:
             Lwm2m_Error("Unhandled bootstrap state %d\n", Lwm2mCore_GetBootstrapState(context));
     }
+    return GetBootStrapTimeout(context, now);
 }
@@ -47,7 +47,8 @@ typedef enum
 
 } Lwm2mBootStrapState;
 
-void Lwm2m_UpdateBootStrapState(Lwm2mContextType * context);
+// Returns milliseconds until the bootstrap state next needs updating, or -1 if it is waiting on something else
+int Lwm2m_UpdateBootStrapState(Lwm2mContextType * context);
 
 void Lwm2m_BootStrapInit(Lwm2mContextType * context);
 
@@ -130,7 +130,7 @@ static int SerialiseOIR(Lwm2mTreeNode * root, AwaContentType acceptContentType,
 }
 
 // Deserialise the encoded buffer provided into the Object references by OIR. Return number of bytes deserialised, negative on failure
-static int DeserialiseOIR(Lwm2mTreeNode ** dest, AwaContentType contentType, Lwm2mContextType * context, int oir[], int oirLength,
+static int DeserialiseOIR(Lwm2mTreeNode ** dest, MemoryArena * arena, AwaContentType contentType, Lwm2mContextType * context, int oir[], int oirLength,
         const char * buffer, size_t len)
 {
     /* If the content type is not specified in the payload of a response message,
@@ -145,17 +145,17 @@ static int DeserialiseOIR(Lwm2mTreeNode ** dest, AwaContentType contentType, Lwm
     if (oirLength == 1)
     {
         Lwm2m_Debug("Deserialise object %d:\n", oir[0]);
-        len = DeserialiseObject(contentType, dest, context->Definitions, oir[0], buffer, len);
+        len = DeserialiseObject(contentType, dest, arena, context->Definitions, oir[0], buffer, len);
     }
     else if (oirLength == 2)
     {
         Lwm2m_Debug("Deserialise object instance %d/%d:\n", oir[0], oir[1]);
-        len = DeserialiseObjectInstance(contentType, dest, context->Definitions, oir[0], oir[1], buffer, len);
+        len = DeserialiseObjectInstance(contentType, dest, arena, context->Definitions, oir[0], oir[1], buffer, len);
     }
     else if (oirLength == 3)
     {
         Lwm2m_Debug("Deserialise resource %d/%d/%d:\n", oir[0], oir[1], oir[2]);
-        len = DeserialiseResource(contentType, dest, context->Definitions, oir[0], oir[1], oir[2], buffer, len);
+        len = DeserialiseResource(contentType, dest, arena, context->Definitions, oir[0], oir[1], oir[2], buffer, len);
     }
 
     return len;
@@ -1219,10 +1219,11 @@ static int ResourceExecute(Lwm2mContextType * context, ObjectIDType objectID, Ob
 int Lwm2mCore_GetResourceInstanceCount(Lwm2mContextType * context, ObjectIDType objectID, ObjectInstanceIDType objectInstanceID,
         ResourceIDType resourceID)
 {
-    int valueID = -1;
+    Lwm2mCoreIterator iterator;
     int count = 0;
 
-    while ((valueID = Lwm2mCore_GetNextResourceInstanceID(context, objectID, objectInstanceID, resourceID, valueID)) != -1)
+    Lwm2mCore_InitIterator(context, &iterator, objectID, objectInstanceID, resourceID);
+    while (Lwm2mCore_IteratorNext(&iterator) != -1)
     {
         count++;
     }
@@ -1265,6 +1266,16 @@ ResourceInstanceIDType Lwm2mCore_GetNextResourceInstanceID(Lwm2mContextType * co
     return Lwm2mObjectTree_GetNextResourceInstanceID(&context->ObjectTree, &iterator);
 }
 
+int Lwm2mCore_InitIterator(Lwm2mContextType * context, Lwm2mCoreIterator * iterator, ObjectIDType objectID, ObjectInstanceIDType objectInstanceID, ResourceIDType resourceID)
+{
+    return Lwm2mObjectTree_InitChildIterator(iterator, &context->ObjectTree, objectID, objectInstanceID, resourceID);
+}
+
+int Lwm2mCore_IteratorNext(Lwm2mCoreIterator * iterator)
+{
+    return Lwm2mObjectTree_ChildIteratorNext(iterator);
+}
+
 int Lwm2mCore_GetResourceInstanceValue(Lwm2mContextType * context, ObjectIDType objectID, ObjectInstanceIDType objectInstanceID,
         ResourceIDType resourceID, ResourceInstanceIDType resourceInstanceID, const void ** value, size_t * valueBufferSize)
 {
@@ -1306,6 +1317,23 @@ int Lwm2mCore_GetResourceInstanceValue(Lwm2mContextType * context, ObjectIDType
     return -1;
 }
 
+bool Lwm2mCore_IsResourceValueStable(Lwm2mContextType * context, ObjectIDType objectID, ResourceIDType resourceID)
+{
+    ResourceDefinition * definition = Definition_LookupResourceDefinition(context->Definitions, objectID, resourceID);
+    if (definition == NULL)
+    {
+        return false;
+    }
+
+    if (definition->Handlers.Read != NULL)
+    {
+        return definition->Handlers.Read == ObjectStoreReadHandler;
+    }
+
+    // static client pointer storage: the default handler returns the address of the application's own variable
+    return definition->DataPointers != NULL;
+}
+
 /**
  * @brief Iterate through all instances of an Object in the object store and construct
  *        a list in the CoRE link format.
@@ -1330,8 +1358,10 @@ static int Lwm2mCore_GetObjectListForObjectID(Lwm2mContextType * context, Object
         *first = false;
     }
 
-    ObjectInstanceIDType objectInstanceID = -1;
-    while ((objectInstanceID = Lwm2mCore_GetNextObjectInstanceID(context, objectID, objectInstanceID)) != -1)
+    Lwm2mCoreIterator iterator;
+    ObjectInstanceIDType objectInstanceID;
+    Lwm2mCore_InitIterator(context, &iterator, objectID, -1, -1);
+    while ((objectInstanceID = Lwm2mCore_IteratorNext(&iterator)) != -1)
     {
         pos += snprintf(buffer + pos, len - pos, "%s<%s%d/%d>", *first ? "" : ",", altPath ? altPath : "/", objectID, objectInstanceID);
         *first = false;
@@ -1404,18 +1434,32 @@ static int HandleNotification(void * ctxt, AddressType * addr, int sequence, con
 
     matches = sscanf(OirToUri(key), "%5d/%5d/%5d", &oir[0], &oir[1], &oir[2]);
 
+    uint8_t arenaBlock[LWM2M_TREE_ARENA_INITIAL_SIZE];
+    MemoryArena arena;
+    MemoryArena_Init(&arena, arenaBlock, sizeof(arenaBlock), LWM2M_TREE_ARENA_BLOCK_SIZE);
+
     Lwm2mTreeNode * dest;
-    if (TreeBuilder_CreateTreeFromOIR(&dest, context, origin, oir, matches) == AwaResult_Success)
+    if (TreeBuilder_CreateTreeFromOIR(&dest, &arena, context, origin, oir, matches) == AwaResult_Success)
     {
-        char payload[1024];
-        int payloadLen = SerialiseOIR(dest, contentType, oir, matches, &payloadContentType, payload, sizeof(payload));
-        if (payloadLen >= 0)
+        // notifications too large for one message are sent in Block2 blocks by the CoAP layer
+        size_t maxPayloadSize = coap_GetMaxPayloadSize();
+        char * payload = malloc(maxPayloadSize);
+        if (payload != NULL)
         {
-            Lwm2m_Debug("Send Notify to %s\n", path);
-            coap_SendNotify(addr, path, token, tokenLength, payloadContentType, payload, payloadLen, sequence);
+            int payloadLen = SerialiseOIR(dest, contentType, oir, matches, &payloadContentType, payload, maxPayloadSize);
+            if (payloadLen >= 0)
+            {
+                Lwm2m_Debug("Send Notify to %s\n", path);
+                coap_SendNotify(addr, path, token, tokenLength, payloadContentType, payload, payloadLen, sequence);
+            }
+            free(payload);
+        }
+        else
+        {
+            Lwm2m_Error("Unable to allocate memory for notification to %s\n", path);
         }
     }
-    Lwm2mTreeNode_DeleteRecursive(dest);
+    MemoryArena_Destroy(&arena);
     return 0;
 }
 
@@ -1450,12 +1494,16 @@ static int HandleObserveRequest(void * ctxt, AddressType * addr, const char * pa
         int len = 0;
         if (Lwm2mCore_Observe(context, addr, token, tokenLength, oir[0], oir[1], oir[2], contentType, HandleNotification, NULL ) != -1)
         {
+            uint8_t arenaBlock[LWM2M_TREE_ARENA_INITIAL_SIZE];
+            MemoryArena arena;
+            MemoryArena_Init(&arena, arenaBlock, sizeof(arenaBlock), LWM2M_TREE_ARENA_BLOCK_SIZE);
+
             Lwm2mTreeNode * root;
-            if ((result = TreeBuilder_CreateTreeFromOIR(&root, context, origin, oir, matches)) == AwaResult_Success)
+            if ((result = TreeBuilder_CreateTreeFromOIR(&root, &arena, context, origin, oir, matches)) == AwaResult_Success)
             {
                 len = SerialiseOIR(root, contentType, oir, matches, responseContentType, responseContent, *responseContentLen);
             }
-            Lwm2mTreeNode_DeleteRecursive(root);
+            MemoryArena_Destroy(&arena);
         }
 
         *responseContentLen = (len >= 0) ? len : 0;
@@ -1492,12 +1540,16 @@ static int HandleCancelObserveRequest(void * ctxt, AddressType * addr, const cha
         Lwm2mCore_CancelObserve(context, addr, oir[0], oir[1], oir[2]);
 
         // Perform "GET", to return clientID in content.
+        uint8_t arenaBlock[LWM2M_TREE_ARENA_INITIAL_SIZE];
+        MemoryArena arena;
+        MemoryArena_Init(&arena, arenaBlock, sizeof(arenaBlock), LWM2M_TREE_ARENA_BLOCK_SIZE);
+
         Lwm2mTreeNode * root;
-        if ((result = TreeBuilder_CreateTreeFromOIR(&root, context, origin, oir, matches)) == AwaResult_Success)
+        if ((result = TreeBuilder_CreateTreeFromOIR(&root, &arena, context, origin, oir, matches)) == AwaResult_Success)
         {
             len = SerialiseOIR(root, contentType, oir, matches, responseContentType, responseContent, *responseContentLen);
         }
-        Lwm2mTreeNode_DeleteRecursive(root);
+        MemoryArena_Destroy(&arena);
 
         if (len >= 0)
         {
@@ -1544,8 +1596,12 @@ static int HandleGetRequest(void * ctxt, AddressType * addr, const char * path,
     else
     {
         Lwm2m_Debug("Read\n");
+        uint8_t arenaBlock[LWM2M_TREE_ARENA_INITIAL_SIZE];
+        MemoryArena arena;
+        MemoryArena_Init(&arena, arenaBlock, sizeof(arenaBlock), LWM2M_TREE_ARENA_BLOCK_SIZE);
+
         Lwm2mTreeNode * root;
-        if ((result = TreeBuilder_CreateTreeFromOIR(&root, context, origin, oir, matches)) == AwaResult_Success)
+        if ((result = TreeBuilder_CreateTreeFromOIR(&root, &arena, context, origin, oir, matches)) == AwaResult_Success)
         {
             len = SerialiseOIR(root, acceptContentType, oir, matches, responseContentType, responseContent, *responseContentLen);
         }
@@ -1554,7 +1610,7 @@ static int HandleGetRequest(void * ctxt, AddressType * addr, const char * path,
             // Not found or some other failure.
             len = -1;
         }
-        Lwm2mTreeNode_DeleteRecursive(root);
+        MemoryArena_Destroy(&arena);
     }
 
     *responseContentLen = (len < 0) ? 0 : len;
@@ -1615,8 +1671,12 @@ static int HandlePostRequest(void * ctxt, AddressType * addr, const char * path,
     else
     {
         // Handle WRITE and CREATE
+        uint8_t arenaBlock[LWM2M_TREE_ARENA_INITIAL_SIZE];
+        MemoryArena arena;
+        MemoryArena_Init(&arena, arenaBlock, sizeof(arenaBlock), LWM2M_TREE_ARENA_BLOCK_SIZE);
+
         Lwm2mTreeNode * root = NULL;
-        len = DeserialiseOIR(&root, contentType, context, oir, matches, requestContent, requestContentLen);
+        len = DeserialiseOIR(&root, &arena, contentType, context, oir, matches, requestContent, requestContentLen);
 
         if (len >= 0)
         {
@@ -1636,7 +1696,7 @@ static int HandlePostRequest(void * ctxt, AddressType * addr, const char * path,
 
                     // This is an object node with resource values but no object instance.
                     // Treat it as an object instance node and add it to an object node.
-                    Lwm2mTreeNode * object = Lwm2mTreeNode_Create();
+                    Lwm2mTreeNode * object = Lwm2mTreeNode_CreateInArena(&arena);
                     Lwm2mTreeNode_SetID(object, oir[0]);
                     Lwm2mTreeNode_SetType(object, Lwm2mTreeNodeType_Object);
                     Lwm2mTreeNode_AddChild(object, root);
@@ -1693,7 +1753,7 @@ static int HandlePostRequest(void * ctxt, AddressType * addr, const char * path,
             Lwm2m_Error("Failed to deserialise content type %d, len %d\n", contentType, len);
             *responseCode = AwaResult_BadRequest;
         }
-        Lwm2mTreeNode_DeleteRecursive(root);
+        MemoryArena_Destroy(&arena);
     }
     return 0;
 }
@@ -2026,11 +2086,15 @@ static int HandlePutRequest(void * ctxt, AddressType * addr, const char * path,
     // Replace operation: must be O/I or O/I/R
     if ((oir[0] != -1) && (oir[1] != -1))
     {
-        Lwm2mTreeNode * root;
+        uint8_t arenaBlock[LWM2M_TREE_ARENA_INITIAL_SIZE];
+        MemoryArena arena;
+        MemoryArena_Init(&arena, arenaBlock, sizeof(arenaBlock), LWM2M_TREE_ARENA_BLOCK_SIZE);
+
+        Lwm2mTreeNode * root = NULL;
         int len;
 
         // Create new resource instance with the values provided.
-        len = DeserialiseOIR(&root, contentType, context, oir, matches, requestContent, requestContentLen);
+        len = DeserialiseOIR(&root, &arena, contentType, context, oir, matches, requestContent, requestContentLen);
 
         if (len >= 0)
         {
@@ -2084,7 +2148,9 @@ static int HandlePutRequest(void * ctxt, AddressType * addr, const char * path,
         {
             *responseCode = AwaResult_BadRequest;
         }
+        // Frees the default values PrepareObjectForReplace added to the tree on the heap
         Lwm2mTreeNode_DeleteRecursive(root);
+        MemoryArena_Destroy(&arena);
     }
     else
     {
@@ -2120,10 +2186,13 @@ static int HandleBootstrapPutRequest(void * ctxt, AddressType * addr, const char
     *responseCode = AwaResult_BadRequest;
 
     matches = sscanf(path, "/%5d/%5d/%5d", &oir[0], &oir[1], &oir[2]);
-    Lwm2mTreeNode * root;
+    uint8_t arenaBlock[LWM2M_TREE_ARENA_INITIAL_SIZE];
+    MemoryArena arena;
+    MemoryArena_Init(&arena, arenaBlock, sizeof(arenaBlock), LWM2M_TREE_ARENA_BLOCK_SIZE);
+    Lwm2mTreeNode * root = NULL;
 
     // Create new resource instance with the values provided.
-    int len = DeserialiseOIR(&root, contentType, context, oir, matches, requestContent, requestContentLen);
+    int len = DeserialiseOIR(&root, &arena, contentType, context, oir, matches, requestContent, requestContentLen);
     if (len >= 0)
     {
         switch (Lwm2mTreeNode_GetType(root))
@@ -2154,7 +2223,7 @@ static int HandleBootstrapPutRequest(void * ctxt, AddressType * addr, const char
             break;
         }
     }
-    Lwm2mTreeNode_DeleteRecursive(root);
+    MemoryArena_Destroy(&arena);
     return result;
 }
 
@@ -2299,26 +2368,32 @@ int Lwm2mCore_GetEndPointClientName(Lwm2mContextType * context, char * buffer, i
     return strlen(buffer);
 }
 
-// Update the LWM2M state machine, process any message timeouts, registeration attempts etc. Returns time until next service.
+// Update the LWM2M state machine, process any message timeouts, registeration attempts etc. Returns milliseconds
+// until the next service is due, or -1 if nothing is timed and only a message or local change can create work.
 int Lwm2mCore_Process(Lwm2mContextType * context)
 {
-    int nextTick = 1000;
+    int nextTick = -1;
 
     // Update state machine.
     if ((context->BootStrapState == Lwm2mBootStrapState_BootStrapped) || (context->BootStrapState == Lwm2mBootStrapState_CheckExisting))
     {
         // successfully bootstrapped, so we can now register with the servers.
-        Lwm2m_UpdateRegistrationState(context);
+        nextTick = Lwm2m_UpdateRegistrationState(context);
     }
 
     if (context->BootStrapState != Lwm2mBootStrapState_BootStrapped)
     {
         // We haven't bootstrapped yet, so keep trying.
-        Lwm2m_UpdateBootStrapState(context);
+        Lwm2mBootStrapState previousState = context->BootStrapState;
+        nextTick = Lwm2mCore_EarliestTimeout(nextTick, Lwm2m_UpdateBootStrapState(context));
+        if (context->BootStrapState != previousState)
+        {
+            // the new state may hand over to registration, which has not seen it yet
+            nextTick = 0;
+        }
     }
 
-    Lwm2m_UpdateObservers(context);
-    return nextTick;
+    return Lwm2mCore_EarliestTimeout(nextTick, Lwm2m_UpdateObservers(context));
 }
 
 AwaClientRegistrationStatus Lwm2mCore_GetRegistrationStatus(Lwm2mContextType * context)
@@ -48,6 +48,8 @@
 extern "C" {
 #endif
 
+typedef Lwm2mObjectTreeChildIterator Lwm2mCoreIterator;
+
 #define LWM2M_MAX_OIR_PATH_LEN  32
 
 // Default handlers for objects and resources. (TODO: these shouldn't really be externs)
@@ -89,6 +91,10 @@ void Lwm2mCore_Destroy(Lwm2mContextType * context);
 int Lwm2mCore_GetResourceInstanceValue(Lwm2mContextType * context, ObjectIDType objectID, ObjectInstanceIDType objectInstanceID, ResourceIDType resourceID,
                                        ResourceInstanceIDType resourceInstanceID, const void ** value, size_t * valueBufferSize);
 
+// True if values from Lwm2mCore_GetResourceInstanceValue for this resource stay valid until the resource is next
+// changed, rather than being produced by a handler that may reuse its buffer.
+bool Lwm2mCore_IsResourceValueStable(Lwm2mContextType * context, ObjectIDType objectID, ResourceIDType resourceID);
+
 int Lwm2mCore_GetResourceInstanceCount(Lwm2mContextType * context, ObjectIDType objectID, ObjectInstanceIDType objectInstanceID, ResourceIDType resourceID);
 
 int Lwm2mCore_CreateObjectInstance(Lwm2mContextType * context, ObjectIDType objectID, ObjectInstanceIDType objectInstanceID);
@@ -113,6 +119,10 @@ ObjectInstanceIDType Lwm2mCore_GetNextObjectInstanceID(Lwm2mContextType * contex
 ResourceIDType Lwm2mCore_GetNextResourceID(Lwm2mContextType * context, ObjectIDType objectID, ObjectInstanceIDType objectInstanceID, ResourceIDType resourceID);
 ResourceInstanceIDType Lwm2mCore_GetNextResourceInstanceID(Lwm2mContextType * context, ObjectIDType objectID, ObjectInstanceIDType objectInstanceID, ResourceIDType resourceID, ResourceInstanceIDType resourceInstanceID);
 
+// Walk the children of a path (objects if objectID is -1) without looking the previous ID up again on each step
+int Lwm2mCore_InitIterator(Lwm2mContextType * context, Lwm2mCoreIterator * iterator, ObjectIDType objectID, ObjectInstanceIDType objectInstanceID, ResourceIDType resourceID);
+int Lwm2mCore_IteratorNext(Lwm2mCoreIterator * iterator);
+
 AwaResult Lwm2mCore_Delete(Lwm2mContextType * context, Lwm2mRequestOrigin requestOrigin, ObjectIDType objectID, ObjectInstanceIDType objectInstanceID, ResourceIDType resourceID, ResourceInstanceIDType resourceInstanceID, bool replace);
 
 int Lwm2mCore_Observe(Lwm2mContextType * context, AddressType * addr, const char * token, int tokenLength, ObjectIDType objectID, ObjectInstanceIDType objectInstanceID,
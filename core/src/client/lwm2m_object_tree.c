@@ -22,50 +22,84 @@
 
 
 #include <stdlib.h>
+#include <stdint.h>
 
 #include "lwm2m_object_tree.h"
 #include "lwm2m_debug.h"
 
 
-static Lwm2mTreeNode * Lwm2mTree_LookupNodeFromID(Lwm2mTreeNode * parentNode, uint16_t id)
+// Index entry for a node below the root, keyed by its parent and ID
+typedef struct
 {
-    if (parentNode == NULL)
-    {
-        return NULL;
-    }
+    HashTableNode IndexNode;
+    Lwm2mTreeNode * Parent;
+    Lwm2mTreeNode * Node;
+    int ID;
+} IndexEntry;
 
-    Lwm2mTreeNode * objectNode = Lwm2mTreeNode_GetFirstChild(parentNode);
-    while (objectNode != NULL)
-    {
-        int nodeId;
-        Lwm2mTreeNode_GetID(objectNode, &nodeId);
+static uint32_t HashChild(const Lwm2mTreeNode * parentNode, int id)
+{
+    return HashTable_HashUInt32((uint32_t)((uintptr_t)parentNode >> 4) ^ HashTable_HashUInt32((uint32_t)id));
+}
 
-        if (nodeId == id)
+static IndexEntry * LookupIndexEntry(Lwm2mObjectTree * objectTree, Lwm2mTreeNode * parentNode, int id)
+{
+    HashTableNode * node;
+    for (node = HashTable_FindFirst(&objectTree->Index, HashChild(parentNode, id)); node != NULL; node = HashTable_FindNext(node))
+    {
+        IndexEntry * entry = HashTableEntry(node, IndexEntry, IndexNode);
+        if ((entry->Parent == parentNode) && (entry->ID == id))
         {
-            return objectNode;
+            return entry;
         }
-
-        objectNode = Lwm2mTreeNode_GetNextChild(parentNode, objectNode);
     }
     return NULL;
 }
 
-static Lwm2mTreeNode * Lwm2mObjectTree_CreateNode(Lwm2mTreeNode * parent, uint16_t id, Lwm2mTreeNodeType type)
+static Lwm2mTreeNode * Lwm2mTree_LookupNodeFromID(Lwm2mObjectTree * objectTree, Lwm2mTreeNode * parentNode, uint16_t id)
+{
+    if (parentNode == NULL)
+    {
+        return NULL;
+    }
+
+    IndexEntry * entry = LookupIndexEntry(objectTree, parentNode, id);
+    return (entry != NULL) ? entry->Node : NULL;
+}
+
+static Lwm2mTreeNode * Lwm2mObjectTree_CreateNode(Lwm2mObjectTree * objectTree, Lwm2mTreeNode * parent, uint16_t id, Lwm2mTreeNodeType type)
 {
     if (parent == NULL)
     {
         return NULL;
     }
 
-    Lwm2mTreeNode * newNode = Lwm2mTree_LookupNodeFromID(parent, id);
+    Lwm2mTreeNode * newNode = Lwm2mTree_LookupNodeFromID(objectTree, parent, id);
     if (newNode)
     {
         return newNode;
     }
 
+    IndexEntry * entry = (IndexEntry *)malloc(sizeof(IndexEntry));
+    if (entry == NULL)
+    {
+        return NULL;
+    }
+
     newNode = Lwm2mTreeNode_Create();
     if (newNode == NULL)
     {
+        free(entry);
+        return NULL;
+    }
+
+    entry->Parent = parent;
+    entry->Node = newNode;
+    entry->ID = id;
+    if (HashTable_Insert(&objectTree->Index, &entry->IndexNode, HashChild(parent, id)) != 0)
+    {
+        Lwm2mTreeNode_Delete(newNode);
+        free(entry);
         return NULL;
     }
 
@@ -76,6 +110,32 @@ static Lwm2mTreeNode * Lwm2mObjectTree_CreateNode(Lwm2mTreeNode * parent, uint16
     return newNode;
 }
 
+// Drop a node and everything below it from the index, before the nodes themselves are deleted
+static void Lwm2mObjectTree_Unindex(Lwm2mObjectTree * objectTree, Lwm2mTreeNode * node)
+{
+    Lwm2mTreeNode * child = Lwm2mTreeNode_GetFirstChild(node);
+    while (child != NULL)
+    {
+        Lwm2mObjectTree_Unindex(objectTree, child);
+        child = Lwm2mTreeNode_GetNextChild(node, child);
+    }
+
+    int id;
+    Lwm2mTreeNode_GetID(node, &id);
+    IndexEntry * entry = LookupIndexEntry(objectTree, Lwm2mTreeNode_GetParent(node), id);
+    if (entry != NULL)
+    {
+        HashTable_Remove(&objectTree->Index, &entry->IndexNode);
+        free(entry);
+    }
+}
+
+static void Lwm2mObjectTree_DeleteNode(Lwm2mObjectTree * objectTree, Lwm2mTreeNode * node)
+{
+    Lwm2mObjectTree_Unindex(objectTree, node);
+    Lwm2mTreeNode_DeleteRecursive(node);
+}
+
 static Lwm2mTreeNode * Lwm2mObjectTree_LookupNodeFromOIR(Lwm2mObjectTree * objectTree, ObjectIDType objectID, ObjectInstanceIDType objectInstanceID, ResourceIDType resourceID, ResourceInstanceIDType resourceInstanceID)
 {
     if (objectTree == NULL)
@@ -83,7 +143,7 @@ static Lwm2mTreeNode * Lwm2mObjectTree_LookupNodeFromOIR(Lwm2mObjectTree * objec
         return NULL;
     }
 
-    Lwm2mTreeNode * objectNode = Lwm2mTree_LookupNodeFromID(objectTree->RootNode, objectID);
+    Lwm2mTreeNode * objectNode = Lwm2mTree_LookupNodeFromID(objectTree, objectTree->RootNode, objectID);
     if (objectNode == NULL)
     {
         return NULL;
@@ -93,7 +153,7 @@ static Lwm2mTreeNode * Lwm2mObjectTree_LookupNodeFromOIR(Lwm2mObjectTree * objec
         return objectNode;
     }
 
-    Lwm2mTreeNode * instanceNode = Lwm2mTree_LookupNodeFromID(objectNode, objectInstanceID);
+    Lwm2mTreeNode * instanceNode = Lwm2mTree_LookupNodeFromID(objectTree, objectNode, objectInstanceID);
     if (instanceNode == NULL)
     {
         return NULL;
@@ -103,7 +163,7 @@ static Lwm2mTreeNode * Lwm2mObjectTree_LookupNodeFromOIR(Lwm2mObjectTree * objec
         return instanceNode;
     }
 
-    Lwm2mTreeNode * resourceNode = Lwm2mTree_LookupNodeFromID(instanceNode, resourceID);
+    Lwm2mTreeNode * resourceNode = Lwm2mTree_LookupNodeFromID(objectTree, instanceNode, resourceID);
     if (resourceNode == NULL)
     {
         return NULL;
@@ -113,7 +173,7 @@ static Lwm2mTreeNode * Lwm2mObjectTree_LookupNodeFromOIR(Lwm2mObjectTree * objec
         return resourceNode;
     }
 
-    return Lwm2mTree_LookupNodeFromID(resourceNode, resourceInstanceID);
+    return Lwm2mTree_LookupNodeFromID(objectTree, resourceNode, resourceInstanceID);
 }
 
 int Lwm2mObjectTree_Init(Lwm2mObjectTree * objectTree)
@@ -124,6 +184,7 @@ int Lwm2mObjectTree_Init(Lwm2mObjectTree * objectTree)
     }
 
     objectTree->RootNode = Lwm2mTreeNode_Create();
+    HashTable_Init(&objectTree->Index);
     return 0;
 }
 
@@ -134,6 +195,15 @@ int Lwm2mObjectTree_Destroy(Lwm2mObjectTree * objectTree)
         return -1;
     }
 
+    HashTableNode * node = HashTable_First(&objectTree->Index);
+    while (node != NULL)
+    {
+        HashTableNode * next = HashTable_Next(&objectTree->Index, node);
+        free(HashTableEntry(node, IndexEntry, IndexNode));
+        node = next;
+    }
+    HashTable_Destroy(&objectTree->Index);
+
     Lwm2mTreeNode_DeleteRecursive(objectTree->RootNode);
     return 0;
 }
@@ -145,13 +215,13 @@ int Lwm2mObjectTree_AddObject(Lwm2mObjectTree * objectTree, ObjectIDType objectI
         return -1;
     }
 
-    Lwm2mTreeNode * objectNode = Lwm2mTree_LookupNodeFromID(objectTree->RootNode, objectID);
+    Lwm2mTreeNode * objectNode = Lwm2mTree_LookupNodeFromID(objectTree, objectTree->RootNode, objectID);
     if (objectNode != NULL)
     {
         return -1;
     }
 
-    objectNode = Lwm2mObjectTree_CreateNode(objectTree->RootNode, objectID, Lwm2mTreeNodeType_Object);
+    objectNode = Lwm2mObjectTree_CreateNode(objectTree, objectTree->RootNode, objectID, Lwm2mTreeNodeType_Object);
     if (objectNode == NULL)
     {
         return -1;
@@ -167,23 +237,23 @@ int Lwm2mObjectTree_AddObjectInstance(Lwm2mObjectTree * objectTree, ObjectIDType
         return -1;
     }
 
-    Lwm2mTreeNode * objectNode = Lwm2mTree_LookupNodeFromID(objectTree->RootNode, objectID);
+    Lwm2mTreeNode * objectNode = Lwm2mTree_LookupNodeFromID(objectTree, objectTree->RootNode, objectID);
     if (objectNode == NULL)
     {
-        objectNode = Lwm2mObjectTree_CreateNode(objectTree->RootNode, objectID, Lwm2mTreeNodeType_Object);
+        objectNode = Lwm2mObjectTree_CreateNode(objectTree, objectTree->RootNode, objectID, Lwm2mTreeNodeType_Object);
         if (objectNode == NULL)
         {
             return -1;
         }
     }
 
-    Lwm2mTreeNode * instanceNode = Lwm2mTree_LookupNodeFromID(objectNode, objectInstanceID);
+    Lwm2mTreeNode * instanceNode = Lwm2mTree_LookupNodeFromID(objectTree, objectNode, objectInstanceID);
     if (instanceNode)
     {
         return -1;
     }
 
-    instanceNode = Lwm2mObjectTree_CreateNode(objectNode, objectInstanceID, Lwm2mTreeNodeType_ObjectInstance);
+    instanceNode = Lwm2mObjectTree_CreateNode(objectTree, objectNode, objectInstanceID, Lwm2mTreeNodeType_ObjectInstance);
     if (instanceNode == NULL)
     {
         return -1;
@@ -199,33 +269,33 @@ int Lwm2mObjectTree_AddResource(Lwm2mObjectTree * objectTree, ObjectIDType objec
         return -1;
     }
 
-    Lwm2mTreeNode * objectNode = Lwm2mTree_LookupNodeFromID(objectTree->RootNode, objectID);
+    Lwm2mTreeNode * objectNode = Lwm2mTree_LookupNodeFromID(objectTree, objectTree->RootNode, objectID);
     if (objectNode == NULL)
     {
-        objectNode = Lwm2mObjectTree_CreateNode(objectTree->RootNode, objectID, Lwm2mTreeNodeType_Object);
+        objectNode = Lwm2mObjectTree_CreateNode(objectTree, objectTree->RootNode, objectID, Lwm2mTreeNodeType_Object);
         if (objectNode == NULL)
         {
             return -1;
         }
     }
 
-    Lwm2mTreeNode * instanceNode = Lwm2mTree_LookupNodeFromID(objectNode, objectInstanceID);
+    Lwm2mTreeNode * instanceNode = Lwm2mTree_LookupNodeFromID(objectTree, objectNode, objectInstanceID);
     if (instanceNode == NULL)
     {
-        instanceNode = Lwm2mObjectTree_CreateNode(objectNode, objectInstanceID, Lwm2mTreeNodeType_ObjectInstance);
+        instanceNode = Lwm2mObjectTree_CreateNode(objectTree, objectNode, objectInstanceID, Lwm2mTreeNodeType_ObjectInstance);
         if (instanceNode == NULL)
         {
             return -1;
         }
     }
 
-    Lwm2mTreeNode * resourceNode = Lwm2mTree_LookupNodeFromID(instanceNode, resourceID);
+    Lwm2mTreeNode * resourceNode = Lwm2mTree_LookupNodeFromID(objectTree, instanceNode, resourceID);
     if (resourceNode)
     {
         return -1;
     }
 
-    resourceNode = Lwm2mObjectTree_CreateNode(instanceNode, resourceID, Lwm2mTreeNodeType_Resource);
+    resourceNode = Lwm2mObjectTree_CreateNode(objectTree, instanceNode, resourceID, Lwm2mTreeNodeType_Resource);
     if (resourceNode == NULL)
     {
         return -1;
@@ -241,43 +311,43 @@ int Lwm2mObjectTree_AddResourceInstance(Lwm2mObjectTree * objectTree, ObjectIDTy
         return -1;
     }
 
-    Lwm2mTreeNode * objectNode = Lwm2mTree_LookupNodeFromID(objectTree->RootNode, objectID);
+    Lwm2mTreeNode * objectNode = Lwm2mTree_LookupNodeFromID(objectTree, objectTree->RootNode, objectID);
     if (objectNode == NULL)
     {
-        objectNode = Lwm2mObjectTree_CreateNode(objectTree->RootNode, objectID, Lwm2mTreeNodeType_Object);
+        objectNode = Lwm2mObjectTree_CreateNode(objectTree, objectTree->RootNode, objectID, Lwm2mTreeNodeType_Object);
         if (objectNode == NULL)
         {
             return -1;
         }
     }
 
-    Lwm2mTreeNode * instanceNode = Lwm2mTree_LookupNodeFromID(objectNode, objectInstanceID);
+    Lwm2mTreeNode * instanceNode = Lwm2mTree_LookupNodeFromID(objectTree, objectNode, objectInstanceID);
     if (instanceNode == NULL)
     {
-        instanceNode = Lwm2mObjectTree_CreateNode(objectNode, objectInstanceID, Lwm2mTreeNodeType_ObjectInstance);
+        instanceNode = Lwm2mObjectTree_CreateNode(objectTree, objectNode, objectInstanceID, Lwm2mTreeNodeType_ObjectInstance);
         if (instanceNode == NULL)
         {
             return -1;
         }
     }
 
-    Lwm2mTreeNode * resourceNode = Lwm2mTree_LookupNodeFromID(instanceNode, resourceID);
+    Lwm2mTreeNode * resourceNode = Lwm2mTree_LookupNodeFromID(objectTree, instanceNode, resourceID);
     if (resourceNode == NULL)
     {
-        resourceNode = Lwm2mObjectTree_CreateNode(instanceNode, resourceID, Lwm2mTreeNodeType_Resource);
+        resourceNode = Lwm2mObjectTree_CreateNode(objectTree, instanceNode, resourceID, Lwm2mTreeNodeType_Resource);
         if (resourceNode == NULL)
         {
             return -1;
         }
     }
 
-    Lwm2mTreeNode * resourceInstanceNode = Lwm2mTree_LookupNodeFromID(resourceNode, resourceInstanceID);
+    Lwm2mTreeNode * resourceInstanceNode = Lwm2mTree_LookupNodeFromID(objectTree, resourceNode, resourceInstanceID);
     if (resourceInstanceNode != NULL)
     {
         return -1;
     }
 
-    resourceInstanceNode = Lwm2mObjectTree_CreateNode(resourceNode, resourceInstanceID, Lwm2mTreeNodeType_ResourceInstance);
+    resourceInstanceNode = Lwm2mObjectTree_CreateNode(objectTree, resourceNode, resourceInstanceID, Lwm2mTreeNodeType_ResourceInstance);
     if (resourceInstanceNode == NULL)
     {
         return -1;
@@ -293,11 +363,11 @@ int Lwm2mObjectTree_DeleteObject(Lwm2mObjectTree * objectTree, ObjectIDType obje
         return -1;
     }
 
-    Lwm2mTreeNode * objectNode = Lwm2mTree_LookupNodeFromID(objectTree->RootNode, objectID);
+    Lwm2mTreeNode * objectNode = Lwm2mTree_LookupNodeFromID(objectTree, objectTree->RootNode, objectID);
     if (objectNode == NULL)
         return -1;
 
-    Lwm2mTreeNode_DeleteRecursive(objectNode);
+    Lwm2mObjectTree_DeleteNode(objectTree, objectNode);
     return 0;
 }
 
@@ -314,7 +384,7 @@ int Lwm2mObjectTree_DeleteObjectInstance(Lwm2mObjectTree * objectTree, ObjectIDT
         return -1;
     }
 
-    Lwm2mTreeNode_DeleteRecursive(instanceNode);
+    Lwm2mObjectTree_DeleteNode(objectTree, instanceNode);
     return 0;
 }
 
@@ -331,7 +401,7 @@ int Lwm2mObjectTree_DeleteResource(Lwm2mObjectTree * objectTree, ObjectIDType ob
         return -1;
     }
 
-    Lwm2mTreeNode_DeleteRecursive(resourceNode);
+    Lwm2mObjectTree_DeleteNode(objectTree, resourceNode);
     return 0;
 }
 
@@ -348,7 +418,7 @@ int Lwm2mObjectTree_DeleteResourceInstance(Lwm2mObjectTree * objectTree, ObjectI
         return -1;
     }
 
-    Lwm2mTreeNode_Delete(resourceInstanceNode);
+    Lwm2mObjectTree_DeleteNode(objectTree, resourceInstanceNode);
     return 0;
 }
 
@@ -387,7 +457,7 @@ int Lwm2mObjectTree_GetNextObjectID(Lwm2mObjectTree * objectTree, Lwm2mObjectTre
     }
     else
     {
-        objectNode = Lwm2mTree_LookupNodeFromID(objectTree->RootNode, iterator->ObjectID);
+        objectNode = Lwm2mTree_LookupNodeFromID(objectTree, objectTree->RootNode, iterator->ObjectID);
         if (objectNode == NULL)
         {
             return -1;
@@ -411,7 +481,7 @@ int Lwm2mObjectTree_GetNextObjectInstanceID(Lwm2mObjectTree * objectTree, Lwm2mO
         return -1;
     }
 
-    Lwm2mTreeNode * objectNode = Lwm2mTree_LookupNodeFromID(objectTree->RootNode, iterator->ObjectID);
+    Lwm2mTreeNode * objectNode = Lwm2mTree_LookupNodeFromID(objectTree, objectTree->RootNode, iterator->ObjectID);
     if (objectNode == NULL)
     {
         return -1;
@@ -426,7 +496,7 @@ int Lwm2mObjectTree_GetNextObjectInstanceID(Lwm2mObjectTree * objectTree, Lwm2mO
     }
     else
     {
-        instanceNode = Lwm2mTree_LookupNodeFromID(objectNode, iterator->ObjectInstanceID);
+        instanceNode = Lwm2mTree_LookupNodeFromID(objectTree, objectNode, iterator->ObjectInstanceID);
         if (instanceNode == NULL)
         {
             return -1;
@@ -450,13 +520,13 @@ int Lwm2mObjectTree_GetNextResourceID(Lwm2mObjectTree * objectTree, Lwm2mObjectT
         return -1;
     }
 
-    Lwm2mTreeNode * objectNode = Lwm2mTree_LookupNodeFromID(objectTree->RootNode, iterator->ObjectID);
+    Lwm2mTreeNode * objectNode = Lwm2mTree_LookupNodeFromID(objectTree, objectTree->RootNode, iterator->ObjectID);
     if (objectNode == NULL)
     {
         return -1;
     }
 
-    Lwm2mTreeNode * instanceNode = Lwm2mTree_LookupNodeFromID(objectNode, iterator->ObjectInstanceID);
+    Lwm2mTreeNode * instanceNode = Lwm2mTree_LookupNodeFromID(objectTree, objectNode, iterator->ObjectInstanceID);
     if (instanceNode == NULL)
     {
         return -1;
@@ -471,7 +541,7 @@ int Lwm2mObjectTree_GetNextResourceID(Lwm2mObjectTree * objectTree, Lwm2mObjectT
     }
     else
     {
-        resourceNode = Lwm2mTree_LookupNodeFromID(instanceNode, iterator->ResourceID);
+        resourceNode = Lwm2mTree_LookupNodeFromID(objectTree, instanceNode, iterator->ResourceID);
         if (resourceNode == NULL)
         {
             return -1;
@@ -496,19 +566,19 @@ int Lwm2mObjectTree_GetNextResourceInstanceID(Lwm2mObjectTree * objectTree, Lwm2
         return -1;
     }
 
-    Lwm2mTreeNode * objectNode = Lwm2mTree_LookupNodeFromID(objectTree->RootNode, iterator->ObjectID);
+    Lwm2mTreeNode * objectNode = Lwm2mTree_LookupNodeFromID(objectTree, objectTree->RootNode, iterator->ObjectID);
     if (objectNode == NULL)
     {
         return -1;
     }
 
-    Lwm2mTreeNode * instanceNode = Lwm2mTree_LookupNodeFromID(objectNode, iterator->ObjectInstanceID);
+    Lwm2mTreeNode * instanceNode = Lwm2mTree_LookupNodeFromID(objectTree, objectNode, iterator->ObjectInstanceID);
     if (instanceNode == NULL)
     {
         return -1;
     }
 
-    Lwm2mTreeNode * resourceNode = Lwm2mTree_LookupNodeFromID(instanceNode, iterator->ResourceID);
+    Lwm2mTreeNode * resourceNode = Lwm2mTree_LookupNodeFromID(objectTree, instanceNode, iterator->ResourceID);
     if (resourceNode == NULL)
     {
         return -1;
@@ -523,7 +593,7 @@ int Lwm2mObjectTree_GetNextResourceInstanceID(Lwm2mObjectTree * objectTree, Lwm2
     }
     else
     {
-        resourceInstanceNode = Lwm2mTree_LookupNodeFromID(resourceNode, iterator->ResourceInstanceID);
+        resourceInstanceNode = Lwm2mTree_LookupNodeFromID(objectTree, resourceNode, iterator->ResourceInstanceID);
         if (resourceInstanceNode == NULL)
         {
             return -1;
@@ -541,6 +611,43 @@ int Lwm2mObjectTree_GetNextResourceInstanceID(Lwm2mObjectTree * objectTree, Lwm2
     return iterator->ResourceInstanceID;
 }
 
+int Lwm2mObjectTree_InitChildIterator(Lwm2mObjectTreeChildIterator * iterator, Lwm2mObjectTree * objectTree, ObjectIDType objectID, ObjectInstanceIDType objectInstanceID, ResourceIDType resourceID)
+{
+    iterator->Parent = NULL;
+    iterator->Next = NULL;
+
+    // an ID below an unspecified one names no path
+    if ((objectTree == NULL) || ((objectID == -1) && (objectInstanceID != -1)) || ((objectInstanceID == -1) && (resourceID != -1)))
+    {
+        return -1;
+    }
+
+    iterator->Parent = (objectID == -1) ? objectTree->RootNode : Lwm2mObjectTree_LookupNodeFromOIR(objectTree, objectID, objectInstanceID, resourceID, -1);
+    if (iterator->Parent == NULL)
+    {
+        return -1;
+    }
+
+    iterator->Next = Lwm2mTreeNode_GetFirstChild(iterator->Parent);
+    return 0;
+}
+
+int Lwm2mObjectTree_ChildIteratorNext(Lwm2mObjectTreeChildIterator * iterator)
+{
+    Lwm2mTreeNode * child = iterator->Next;
+    int id;
+
+    if (child == NULL)
+    {
+        return -1;
+    }
+
+    // Step past the child before returning it, so the caller may delete it
+    iterator->Next = Lwm2mTreeNode_GetNextChild(iterator->Parent, child);
+    Lwm2mTreeNode_GetID(child, &id);
+    return id;
+}
+
 bool Lwm2mObjectTree_Exists(Lwm2mObjectTree * objectTree, ObjectIDType objectID, ObjectInstanceIDType objectInstanceID, ResourceIDType resourceID, ResourceInstanceIDType resourceInstanceID)
 {
     return (Lwm2mObjectTree_LookupNodeFromOIR(objectTree, objectID, objectInstanceID, resourceID, resourceInstanceID) != NULL);
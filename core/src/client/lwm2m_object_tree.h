@@ -34,11 +34,13 @@ extern "C" {
 
 #include "lwm2m_tree_node.h"
 #include "lwm2m_types.h"
+#include "lwm2m_hash_table.h"
 
 
 typedef struct
 {
     Lwm2mTreeNode * RootNode;
+    HashTable Index;                    // every node below the root, by parent and ID
 
 } Lwm2mObjectTree;
 
@@ -51,6 +53,14 @@ typedef struct
 
 } Lwm2mObjectTreeIterator;
 
+// Cursor over the children of one node, unlike Lwm2mObjectTreeIterator which looks its position up again on each step
+typedef struct
+{
+    Lwm2mTreeNode * Parent;
+    Lwm2mTreeNode * Next;               // already fetched, so the child last returned may be deleted
+
+} Lwm2mObjectTreeChildIterator;
+
 
 int Lwm2mObjectTree_Init(Lwm2mObjectTree * objectTree);
 int Lwm2mObjectTree_Destroy(Lwm2mObjectTree * objectTree);
@@ -71,6 +81,10 @@ int Lwm2mObjectTree_GetNextObjectInstanceID(Lwm2mObjectTree * objectTree, Lwm2mO
 int Lwm2mObjectTree_GetNextResourceID(Lwm2mObjectTree * objectTree, Lwm2mObjectTreeIterator * iterator);
 int Lwm2mObjectTree_GetNextResourceInstanceID(Lwm2mObjectTree * objectTree, Lwm2mObjectTreeIterator * iterator);
 
+// Walk the objects (objectID -1), the instances of an object, the resources of an object instance, or the instances of a resource
+int Lwm2mObjectTree_InitChildIterator(Lwm2mObjectTreeChildIterator * iterator, Lwm2mObjectTree * objectTree, ObjectIDType objectID, ObjectInstanceIDType objectInstanceID, ResourceIDType resourceID);
+int Lwm2mObjectTree_ChildIteratorNext(Lwm2mObjectTreeChildIterator * iterator);
+
 int Lwm2mObjectTree_GetNumObjectInstances(Lwm2mObjectTree * objectTree, ObjectIDType ObjectID);
 
 bool Lwm2mObjectTree_Exists(Lwm2mObjectTree * objectTree, ObjectIDType objectID, ObjectInstanceIDType objectInstanceID, ResourceIDType resourceID, ResourceInstanceIDType resourceInstanceID);
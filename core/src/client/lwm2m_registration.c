@@ -63,6 +63,7 @@
 
 #define REGISTRATION_RETRY_ATTEMPTS (10)
 #define REGISTRATION_TIMEOUT        (30000)
+#define REGISTRATION_RESOLVE_RETRY  (1000)      // ms between attempts while the server address is unresolved
 
 
 static void HandleRegisterUpdateResponse(void * ctxt, AddressType* address, const char * responsePath, int responseCode, AwaContentType contentType, char * payload, size_t payloadLen);
@@ -289,6 +290,42 @@ void Lwm2m_SetUpdateRegistration(Lwm2mContextType * context)
     }
 }
 
+// Time until the registration state of a server next needs attention, or -1 if it waits on a response or nothing.
+// stateChanged is true if this pass moved the server into its current state.
+static int GetRegistrationTimeout(Lwm2mContextType * context, Lwm2mServerType * server, uint32_t now, bool stateChanged)
+{
+    int timeout = -1;
+    uint32_t lifeTime;
+
+    switch (server->RegistrationState)
+    {
+        case Lwm2mRegistrationState_Register:
+        case Lwm2mRegistrationState_Deregister:
+            // still here after a pass means the request could not be sent, e.g. the address is not resolved yet
+            timeout = stateChanged ? 0 : Lwm2mCore_GetTimeRemaining(now, server->LastUpdate, REGISTRATION_RESOLVE_RETRY);
+            break;
+
+        case Lwm2mRegistrationState_Registering:
+        case Lwm2mRegistrationState_UpdatingRegistration:
+            timeout = Lwm2mCore_GetTimeRemaining(now, server->LastUpdate, REGISTRATION_TIMEOUT);
+            break;
+
+        case Lwm2mRegistrationState_Registered:
+            lifeTime = Lwm2mServerObject_GetLifeTime(context, server->ShortServerID);
+            timeout = server->UpdateRegistration ? 0 : Lwm2mCore_GetTimeRemaining(now, server->LastUpdate, (lifeTime * 1000) / 2);
+            break;
+
+        case Lwm2mRegistrationState_RegisterFailedRetry:
+            lifeTime = Lwm2mServerObject_GetLifeTime(context, server->ShortServerID);
+            timeout = (server->Attempts >= REGISTRATION_RETRY_ATTEMPTS) ? 0 : Lwm2mCore_GetTimeRemaining(now, server->LastUpdate, lifeTime * 1000);
+            break;
+
+        default:
+            break;
+    }
+    return timeout;
+}
+
 // Update the registration state of all servers in the serverList.
 // If a server is in the Register state, then send a registration request to that server.
 // If a server is Registered and it's last update request is greater than the server
@@ -302,10 +339,12 @@ int32_t Lwm2m_UpdateRegistrationState(Lwm2mContextType * context)
     uint32_t lifeTime;
     int failedCount = 0;
     int serverCount = 0;
+    int nextTimeout = -1;
     struct ListHead * i;
     ListForEach(i, Lwm2mCore_GetServerList(context))
     {
         Lwm2mServerType * server = ListEntry(i, Lwm2mServerType, list);
+        Lwm2mRegistrationState previousState = server->RegistrationState;
         serverCount++;
 
         switch (server->RegistrationState)
@@ -389,6 +428,8 @@ int32_t Lwm2m_UpdateRegistrationState(Lwm2mContextType * context)
                 failedCount++;
                 break;
         }
+
+        nextTimeout = Lwm2mCore_EarliestTimeout(nextTimeout, GetRegistrationTimeout(context, server, now, server->RegistrationState != previousState));
     }
 
     // If all server registrations have failed, then pass control back to the bootstrap
@@ -414,7 +455,7 @@ int32_t Lwm2m_UpdateRegistrationState(Lwm2mContextType * context)
             Lwm2mCore_SetBootstrapState(context, Lwm2mBootStrapState_NotBootStrapped);
         }
     }
-    return 0;
+    return nextTimeout;
 }
 
 // Return aggregated registration status for all servers in the serverList.
@@ -33,6 +33,7 @@
 
 #define MAX_ADDRESS_LENGTH           (50)
 #define DEFAULT_CLIENT_HOLD_OFF_TIME (30)
+#define MAX_PROCESS_WAIT             (1000)    // the application changes resources without waking the client, so check at least this often
 
 
 struct _AwaStaticClient
@@ -387,7 +388,7 @@ int AwaStaticClient_Process(AwaStaticClient * client)
         }
 
         int timeout;
-        timeout = Lwm2mCore_Process(client->Context);
+        timeout = Lwm2mCore_EarliestTimeout(Lwm2mCore_Process(client->Context), MAX_PROCESS_WAIT);
         result = coap_WaitMessage(timeout, client->CoAPInfo->fd);
     }
     return result;
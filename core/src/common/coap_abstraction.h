@@ -38,6 +38,11 @@ extern "C" {
 #define COAP_OBSERVE_REQUEST 4
 #define COAP_CANCEL_OBSERVE_REQUEST 5
 
+// Default largest response or notification payload; anything over one CoAP message is transferred in Block2 blocks
+#ifndef COAP_MAX_PAYLOAD_SIZE
+#define COAP_MAX_PAYLOAD_SIZE (8192)
+#endif
+
 typedef struct
 {
     int type;
@@ -71,6 +76,7 @@ typedef void (*NotificationFreeCallback)(void * context);
 typedef struct
 {
     int fd;
+    int ipv6fd;     // also read from when listening on both IPv4 and IPv6, otherwise -1
 } CoapInfo;
 
 extern const char * coap_LibraryName;
@@ -82,11 +88,19 @@ void coap_SetCertificate(const uint8_t * cert, int certLength, AwaCertificateFor
 void coap_SetPSK(const char * identity, const uint8_t * key, int keyLength);
 
 int coap_Destroy(void);
-void coap_Process(void);
+
+// Service retransmissions and timeouts. Returns milliseconds until the next CoAP deadline, or -1 if none is pending.
+int coap_Process(void);
 void coap_HandleMessage(void);
 
 void coap_SetLogLevel(int logLevel);
 
+// The largest payload a response, notification or reassembled Block1/Block2 transfer may have, COAP_MAX_PAYLOAD_SIZE
+// unless changed. Payloads are serialised whole before being split into blocks, so this much is allocated per response.
+// Takes effect at the next coap_Init().
+void coap_SetMaxPayloadSize(size_t maxPayloadSize);
+size_t coap_GetMaxPayloadSize(void);
+
 void coap_GetRequest(void * context, const char * path, AwaContentType contentType, TransactionCallback callback);
 void coap_PostRequest(void * context, const char * uri, AwaContentType contentType, const char * payload, int payloadLen, TransactionCallback callback);
 void coap_PutRequest(void * context, const char * path, AwaContentType contentType, const char * payload, int payloadLen, TransactionCallback callback);
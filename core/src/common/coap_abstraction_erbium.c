@@ -26,6 +26,11 @@
 #include "lwm2m_debug.h"
 #include "network_abstraction.h"
 #include "dtls_abstraction.h"
+#include "lwm2m_hash_table.h"
+#include "coap_observation_table.h"
+#include "coap_block1_transfers.h"
+#include "lwm2m_timer_queue.h"
+#include "lwm2m_util.h"
 
 #include "er-resource.h"
 #include "er-coap-engine.h"
@@ -35,14 +40,64 @@
 #define MAX_COAP_PATH 64
 #endif
 
+// How long to wait for a separate response after the request was acknowledged (EXCHANGE_LIFETIME, RFC 7252 4.8.2)
+#ifndef COAP_EXCHANGE_LIFETIME_MS
+#define COAP_EXCHANGE_LIFETIME_MS (247000)
+#endif
+
+// Block size asked of peers for Block2 transfers; below COAP_MAX_BLOCK_SIZE it is also requested up front on GETs
+#ifndef COAP_BLOCK2_PREFERRED_SIZE
+#define COAP_BLOCK2_PREFERRED_SIZE COAP_MAX_BLOCK_SIZE
+#endif
+
+// How many times a Block2 transfer starts again from the first block because the representation changed part way
+#ifndef COAP_BLOCK2_MAX_RESTARTS
+#define COAP_BLOCK2_MAX_RESTARTS (2)
+#endif
+
+// Bounds on Block1 uploads received from peers: the largest payload and how many may be reassembled at once
+#ifndef COAP_BLOCK1_MAX_PAYLOAD
+#define COAP_BLOCK1_MAX_PAYLOAD MaxPayloadSize
+#endif
+#ifndef COAP_BLOCK1_MAX_TRANSFERS
+#define COAP_BLOCK1_MAX_TRANSFERS (4)
+#endif
+
+// The request payload of a Block1 upload, sent a block at a time
+typedef struct
+{
+    coap_method_t Method;
+    AwaContentType ContentType;
+    char Query[128];
+    uint16_t BlockSize;
+    size_t Sent;                            // bytes sent so far, including the block awaiting acknowledgement
+    size_t Length;
+    uint8_t * Payload;
+} Block1Upload;
+
+// An outstanding request, from the time it is sent until its response is delivered or it times out
 typedef struct
 {
+    HashTableNode MessageIDNode;
+    HashTableNode TokenNode;
+    TimerQueueNode SeparateResponseTimer;   // scheduled once an empty ACK says a separate response will follow
+    uint16_t MessageID;
+    uint8_t Token[COAP_TOKEN_LEN];
+    uint8_t TokenLength;
     AddressType Address;
     char Path[MAX_COAP_PATH];
     TransactionCallback Callback;
     void * Context;
-    bool TransactionUsed;
-    coap_transaction_t * TransactionPtr;
+    coap_transaction_t * TransactionPtr;    // NULL once the request has been acknowledged
+    NetworkAddress * RemoteAddress;         // where follow-up Block2 requests are sent
+    AwaContentType Accept;
+    bool Notification;                      // fetching the rest of a notification rather than a response
+    uint8_t * Payload;                      // Block2 blocks received so far
+    size_t PayloadLength;
+    uint8_t ETag[COAP_ETAG_LEN];            // of the representation the blocks so far belong to
+    uint8_t ETagLength;
+    uint8_t Restarts;
+    Block1Upload * Upload;                  // set while a large request payload is being sent in Block1 blocks
 } TransactionType;
 
 #define COAP_OPTION_TO_RESPONSE_CODE(N) (((N >> 5) * 100) | (N & 0x1f))
@@ -55,49 +110,446 @@ static RequestHandler requestHandler = NULL;
 
 const char * coap_LibraryName = "Erbium";
 
-#ifndef MAX_COAP_TRANSACTIONS
-#define MAX_COAP_TRANSACTIONS (2)
-#endif
-
-int CurrentTransactionIndex = 0;
-TransactionType CurrentTransaction[MAX_COAP_TRANSACTIONS];
+// Outstanding requests, indexed by message ID and by token
+static HashTable TransactionsByMessageID;
+static HashTable TransactionsByToken;
+static TimerQueue SeparateResponseTimers;
+static uint32_t NextToken;
 
 static NetworkSocket * networkSocket = NULL;
 extern NetworkAddress * sourceAddress;
 
+// Responses are built here rather than in the transaction buffer so that they may span several Block2 blocks
+static char * ResponseBuffer = NULL;
+static size_t MaxPayloadSize = COAP_MAX_PAYLOAD_SIZE;
+
 typedef enum
 {
     ObserveState_None, ObserveState_Establish, ObserveState_Cancel
 } ObserveState;
 
-typedef struct
-{
-    NetworkAddress * Address;
-    char Path[MAX_COAP_PATH];
-    int Token;
-    TransactionCallback Callback;
-    void * Context;
-} Observation;
+// Observations established on remote resources, indexed by token and by address and path
+static CoapObservationTable * Observations = NULL;
 
-#ifndef MAX_COAP_OBSERVATIONS
-#define MAX_COAP_OBSERVATIONS (10)
-#endif
-
-Observation Observations[MAX_COAP_OBSERVATIONS];
+// Block1 uploads being received from peers
+static CoapBlock1Transfers * Block1Transfers = NULL;
 
 static int coap_HandleRequest(void *packet, void *response, uint8_t *buffer, uint16_t preferred_size, int32_t *offset);
 static int addObserve(NetworkAddress * remoteAddress, char * path, TransactionCallback callback, void * context);
 static int removeObserve(NetworkAddress * remoteAddress, char * path);
 
+static TransactionType * findTransactionByMessageID(uint16_t messageID)
+{
+    HashTableNode * node;
+    for (node = HashTable_FindFirst(&TransactionsByMessageID, HashTable_HashUInt32(messageID)); node != NULL; node = HashTable_FindNext(node))
+    {
+        TransactionType * transaction = HashTableEntry(node, TransactionType, MessageIDNode);
+        if (transaction->MessageID == messageID)
+        {
+            return transaction;
+        }
+    }
+    return NULL;
+}
+
+static TransactionType * findTransactionByToken(const uint8_t * token, uint8_t tokenLength)
+{
+    HashTableNode * node;
+    for (node = HashTable_FindFirst(&TransactionsByToken, HashTable_HashBytes(token, tokenLength)); node != NULL; node = HashTable_FindNext(node))
+    {
+        TransactionType * transaction = HashTableEntry(node, TransactionType, TokenNode);
+        if ((transaction->TokenLength == tokenLength) && (memcmp(transaction->Token, token, tokenLength) == 0))
+        {
+            return transaction;
+        }
+    }
+    return NULL;
+}
+
+// Message IDs and tokens of outstanding requests must be unique, even if the 16-bit message ID wraps.
+// Returns false if every message ID is taken by an outstanding request.
+static bool newMessageID(uint16_t * messageID)
+{
+    uint32_t attempts;
+    for (attempts = 0; attempts <= UINT16_MAX; attempts++)
+    {
+        *messageID = coap_get_mid();
+        if (findTransactionByMessageID(*messageID) == NULL)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+static uint32_t newToken(void)
+{
+    uint32_t token;
+    do
+    {
+        token = NextToken++;
+    } while ((token == 0) || (findTransactionByToken((const uint8_t *)&token, sizeof(token)) != NULL));
+    return token;
+}
+
+static TransactionType * newTransaction(uint16_t messageID, const uint8_t * token, uint8_t tokenLength)
+{
+    TransactionType * transaction = malloc(sizeof(TransactionType));
+    if (transaction != NULL)
+    {
+        memset(transaction, 0, sizeof(TransactionType));
+        transaction->MessageID = messageID;
+        memcpy(transaction->Token, token, tokenLength);
+        transaction->TokenLength = tokenLength;
+        TimerQueue_InitNode(&transaction->SeparateResponseTimer);
+
+        if (HashTable_Insert(&TransactionsByMessageID, &transaction->MessageIDNode, HashTable_HashUInt32(messageID)) != 0)
+        {
+            free(transaction);
+            transaction = NULL;
+        }
+        else if (HashTable_Insert(&TransactionsByToken, &transaction->TokenNode, HashTable_HashBytes(token, tokenLength)) != 0)
+        {
+            HashTable_Remove(&TransactionsByMessageID, &transaction->MessageIDNode);
+            free(transaction);
+            transaction = NULL;
+        }
+    }
+    return transaction;
+}
+
+static void freeTransaction(TransactionType * transaction)
+{
+    if (transaction->TransactionPtr != NULL)
+    {
+        coap_clear_transaction(&transaction->TransactionPtr);
+    }
+    TimerQueue_Cancel(&SeparateResponseTimers, &transaction->SeparateResponseTimer);
+    HashTable_Remove(&TransactionsByMessageID, &transaction->MessageIDNode);
+    HashTable_Remove(&TransactionsByToken, &transaction->TokenNode);
+    free(transaction->Payload);
+    free(transaction->Upload);
+    NetworkAddress_Free(&transaction->RemoteAddress);
+    free(transaction);
+}
+
+static void dispatchResponse(TransactionType * transaction, coap_packet_t * response);
+
+// Service CoAP retransmissions and separate response timeouts. Returns milliseconds until the next deadline, or -1.
+static int checkTimeouts(void)
+{
+    int timeout = coap_check_transactions();
+    uint64_t now = Lwm2mCore_GetTickCountMs();
+    TimerQueueNode * node;
+    int separateResponseTimeout;
+    int block1Timeout;
+
+    while ((node = TimerQueue_PopExpired(&SeparateResponseTimers, now)) != NULL)
+    {
+        TransactionType * transaction = TimerQueueEntry(node, TransactionType, SeparateResponseTimer);
+        Lwm2m_Warning("Timed out waiting for separate response to %s\n", transaction->Path);
+        dispatchResponse(transaction, NULL);
+        freeTransaction(transaction);
+    }
+
+    separateResponseTimeout = TimerQueue_GetTimeout(&SeparateResponseTimers, now);
+    if ((separateResponseTimeout >= 0) && ((timeout < 0) || (separateResponseTimeout < timeout)))
+    {
+        timeout = separateResponseTimeout;
+    }
+
+    block1Timeout = (Block1Transfers != NULL) ? CoapBlock1Transfers_Expire(Block1Transfers, now) : -1;
+    if ((block1Timeout >= 0) && ((timeout < 0) || (block1Timeout < timeout)))
+    {
+        timeout = block1Timeout;
+    }
+    return timeout;
+}
+
+static void dispatchResponse(TransactionType * transaction, coap_packet_t * response)
+{
+    unsigned int ContentType = 0;
+    const char *url = NULL;
+    char * payload = NULL;
+    char uriBuf[64] =
+    { 0 };
+
+    if (transaction->Callback)
+    {
+        if (response != NULL )
+        {
+            int urlLen = 0;
+            if (transaction->Notification)
+            {
+                // observation callbacks are given the observed path as registered
+                strcpy(uriBuf, transaction->Path);
+            }
+            else if ((urlLen = coap_get_header_location_path(response, &url)))
+            {
+                uriBuf[0] = '/';
+                memcpy(&uriBuf[1], url, urlLen);
+            }
+            else
+            {
+                uriBuf[0] = '/';
+                urlLen = strlen(transaction->Path);
+                memcpy(&uriBuf[1], transaction->Path, urlLen);
+            }
+            coap_get_header_content_format(response, &ContentType);
+            int payloadLen;
+            if (transaction->Payload != NULL)
+            {
+                payload = (char *)transaction->Payload;
+                payloadLen = transaction->PayloadLength;
+            }
+            else
+            {
+                payloadLen = coap_get_payload(response, (const uint8_t **) &payload);
+            }
+
+            transaction->Callback(transaction->Context, &transaction->Address, uriBuf, COAP_OPTION_TO_RESPONSE_CODE(response->code),
+                    ContentType, payload, payloadLen);
+        }
+        else
+        {
+            transaction->Callback(transaction->Context, NULL, NULL, 0, 0, NULL, 0);
+        }
+    }
+}
+
+void coap_CoapRequestCallback(void *callback_data, void *response);
+
+// Give a blockwise exchange's next request a new message ID; it keeps the original token
+static int renewMessageID(TransactionType * transaction)
+{
+    uint16_t messageID;
+    if (!newMessageID(&messageID))
+    {
+        Lwm2m_Error("No free message ID for the next block of %s\n", transaction->Path);
+        return -1;
+    }
+    HashTable_Remove(&TransactionsByMessageID, &transaction->MessageIDNode);
+    TimerQueue_Cancel(&SeparateResponseTimers, &transaction->SeparateResponseTimer);
+    transaction->MessageID = messageID;
+    return HashTable_Insert(&TransactionsByMessageID, &transaction->MessageIDNode, HashTable_HashUInt32(transaction->MessageID));
+}
+
+static int sendRequest(TransactionType * transaction, coap_packet_t * request)
+{
+    int result = -1;
+    coap_transaction_t * next;
+    if ((next = coap_new_transaction(networkSocket, transaction->MessageID, transaction->RemoteAddress)))
+    {
+        next->callback = coap_CoapRequestCallback;
+        next->callback_data = transaction;
+        next->packet_len = coap_serialize_message(request, next->packet);
+        transaction->TransactionPtr = next;
+
+        coap_send_transaction(next);
+        result = 0;
+    }
+    return result;
+}
+
+// Ask for the next block of a Block2 transfer
+static int requestNextBlock(TransactionType * transaction, uint16_t blockSize)
+{
+    int result = -1;
+    coap_packet_t request;
+
+    if (renewMessageID(transaction) == 0)
+    {
+        coap_init_message(&request, COAP_TYPE_CON, COAP_GET, transaction->MessageID);
+        coap_set_header_uri_path(&request, transaction->Path);
+        if (transaction->Accept != AwaContentType_None)
+        {
+            coap_set_header_accept(&request, transaction->Accept);
+        }
+        coap_set_header_block2(&request, transaction->PayloadLength / blockSize, 0, blockSize);
+        coap_set_token(&request, transaction->Token, transaction->TokenLength);
+
+        Lwm2m_Debug("Requesting block %lu of %s\n", (unsigned long)(transaction->PayloadLength / blockSize), transaction->Path);
+        result = sendRequest(transaction, &request);
+    }
+    return result;
+}
+
+// Add the next Block1 block of an upload to a request
+static void setUploadBlock(Block1Upload * upload, coap_packet_t * request)
+{
+    size_t length = upload->Length - upload->Sent;
+    bool more = length > upload->BlockSize;
+    if (more)
+    {
+        length = upload->BlockSize;
+    }
+    coap_set_header_block1(request, upload->Sent / upload->BlockSize, more, upload->BlockSize);
+    coap_set_payload(request, &upload->Payload[upload->Sent], length);
+    upload->Sent += length;
+}
+
+// Send the next block of an upload once the peer has asked for it with 2.31 Continue.
+// Returns true if the exchange continues with another block.
+static bool continueUpload(TransactionType * transaction, coap_packet_t * response, bool * failed)
+{
+    Block1Upload * upload = transaction->Upload;
+    coap_packet_t request;
+    uint16_t blockSize;
+
+    *failed = false;
+    if ((upload == NULL) || (response == NULL) || (response->code != CONTINUE_2_31) || (upload->Sent >= upload->Length) ||
+        !coap_get_header_block1(response, NULL, NULL, &blockSize, NULL))
+    {
+        return false;
+    }
+
+    // the peer may ask for smaller blocks, never larger ones
+    if (blockSize < upload->BlockSize)
+    {
+        upload->BlockSize = blockSize;
+    }
+
+    if (renewMessageID(transaction) == 0)
+    {
+        coap_init_message(&request, COAP_TYPE_CON, upload->Method, transaction->MessageID);
+        coap_set_header_uri_path(&request, transaction->Path);
+        if (strlen(upload->Query) > 0)
+        {
+            coap_set_header_uri_query(&request, upload->Query);
+        }
+        coap_set_header_content_format(&request, upload->ContentType);
+        coap_set_token(&request, transaction->Token, transaction->TokenLength);
+        setUploadBlock(upload, &request);
+
+        Lwm2m_Debug("Sending %lu of %lu bytes to %s\n", (unsigned long)upload->Sent, (unsigned long)upload->Length, transaction->Path);
+        *failed = (sendRequest(transaction, &request) != 0);
+    }
+    else
+    {
+        *failed = true;
+    }
+    return !*failed;
+}
+
+// Append a Block2 block to the transaction's payload. Returns true while further blocks are being fetched.
+static bool collectBlock(TransactionType * transaction, coap_packet_t * response, bool * failed)
+{
+    bool pending = false;
+    uint32_t offset;
+    uint16_t blockSize;
+    uint8_t more;
+    const uint8_t * block;
+    int blockLength;
+    const uint8_t * etag = NULL;
+    int etagLength;
+
+    *failed = false;
+    if ((response == NULL) || (response->code >= BAD_REQUEST_4_00) || !coap_get_header_block2(response, NULL, &more, &blockSize, &offset))
+    {
+        return false;
+    }
+
+    blockLength = coap_get_payload(response, &block);
+    etagLength = coap_get_header_etag(response, &etag);
+    if (offset == 0)
+    {
+        transaction->ETagLength = etagLength;
+        if (etagLength > 0)
+        {
+            memcpy(transaction->ETag, etag, etagLength);
+        }
+    }
+    else if ((etagLength != transaction->ETagLength) || ((etagLength > 0) && (memcmp(etag, transaction->ETag, etagLength) != 0)))
+    {
+        // the resource changed between blocks (RFC 7959 2.4): the blocks so far cannot be combined with this one
+        if (transaction->Restarts++ < COAP_BLOCK2_MAX_RESTARTS)
+        {
+            Lwm2m_Debug("Block2 transfer of %s changed at offset %lu, restarting\n", transaction->Path, (unsigned long)offset);
+            transaction->PayloadLength = 0;
+            pending = (requestNextBlock(transaction, blockSize) == 0);
+            *failed = !pending;
+        }
+        else
+        {
+            Lwm2m_Error("Block2 transfer of %s keeps changing, giving up\n", transaction->Path);
+            *failed = true;
+        }
+        return pending;
+    }
+
+    if (offset != transaction->PayloadLength)
+    {
+        Lwm2m_Error("Block2 transfer of %s out of sequence: expected offset %lu, received %lu\n", transaction->Path,
+                    (unsigned long)transaction->PayloadLength, (unsigned long)offset);
+        *failed = true;
+    }
+    else if (offset + blockLength > MaxPayloadSize)
+    {
+        Lwm2m_Error("Block2 transfer of %s exceeds %lu bytes\n", transaction->Path, (unsigned long)MaxPayloadSize);
+        *failed = true;
+    }
+    else
+    {
+        uint8_t * payload = realloc(transaction->Payload, offset + blockLength + 1);
+        if (payload != NULL)
+        {
+            memcpy(&payload[offset], block, blockLength);
+            transaction->Payload = payload;
+            transaction->PayloadLength = offset + blockLength;
+            transaction->Payload[transaction->PayloadLength] = '\0';
+
+            if (more)
+            {
+                // continue at our preferred size if the peer offered larger blocks
+                if (blockSize > COAP_BLOCK2_PREFERRED_SIZE)
+                {
+                    blockSize = COAP_BLOCK2_PREFERRED_SIZE;
+                }
+                pending = (requestNextBlock(transaction, blockSize) == 0);
+                *failed = !pending;
+            }
+        }
+        else
+        {
+            Lwm2m_Error("Unable to allocate memory for Block2 transfer of %s\n", transaction->Path);
+            *failed = true;
+        }
+    }
+    return pending;
+}
+
+// Deliver a response, or fetch its next block. Frees the transaction once the exchange is over.
+static void handleResponse(TransactionType * transaction, coap_packet_t * response)
+{
+    bool failed;
+    if (continueUpload(transaction, response, &failed))
+    {
+        return;
+    }
+    if (failed || !collectBlock(transaction, response, &failed))
+    {
+        dispatchResponse(transaction, failed ? NULL : response);
+        freeTransaction(transaction);
+    }
+}
+
 CoapInfo * coap_Init(const char * ipAddress, int port, bool secure, int logLevel)
 {
     (void) logLevel;
     CoapInfo * result = NULL;
-    memset(CurrentTransaction, 0, sizeof(CurrentTransaction));
-    memset(Observations, 0, sizeof(Observations));
+    HashTable_Init(&TransactionsByMessageID);
+    HashTable_Init(&TransactionsByToken);
+    TimerQueue_Init(&SeparateResponseTimers);
+    NextToken = rand();
+    CoapObservationTable_Destroy(Observations);
+    Observations = CoapObservationTable_Create();
     coap_init_connection(port);
     coap_init_transactions();
     coap_set_service_callback(coap_HandleRequest);
+    free(ResponseBuffer);
+    ResponseBuffer = malloc(MaxPayloadSize);
+    CoapBlock1Transfers_Destroy(Block1Transfers);
+    Block1Transfers = CoapBlock1Transfers_Create(COAP_BLOCK1_MAX_PAYLOAD, COAP_BLOCK1_MAX_TRANSFERS, COAP_EXCHANGE_LIFETIME_MS);
     DTLS_Init();
     if (secure)
     	networkSocket = NetworkSocket_New(ipAddress, NetworkSocketType_UDP | NetworkSocketType_Secure, port);
@@ -108,7 +560,9 @@ CoapInfo * coap_Init(const char * ipAddress, int port, bool secure, int logLevel
         if (NetworkSocket_StartListening(networkSocket))
         {
             Lwm2m_Info("Bind port: %d\n", port);
+            int fds[2];
             coapInfo.fd = NetworkSocket_GetFileDescriptor(networkSocket);
+            coapInfo.ipv6fd = (NetworkSocket_GetFileDescriptors(networkSocket, fds, 2) > 1) ? fds[1] : -1;
             result = &coapInfo;
         }
     }
@@ -146,14 +600,108 @@ void coap_SetLogLevel(int logLevel)
     // TODO - set log level for Erbium (replace PRINTFs)
 }
 
+void coap_SetMaxPayloadSize(size_t maxPayloadSize)
+{
+    MaxPayloadSize = maxPayloadSize;
+}
+
+size_t coap_GetMaxPayloadSize(void)
+{
+    return MaxPayloadSize;
+}
+
+// Tag a representation sent in Block2 blocks, so that a peer fetching the rest can tell if it changes in between
+static void setBlock2ETag(coap_packet_t * packet, const char * payload, size_t payloadLength)
+{
+    uint32_t etag = HashTable_HashBytes(payload, payloadLength);
+    coap_set_header_etag(packet, (const uint8_t *)&etag, sizeof(etag));
+}
+
 int coap_WaitMessage(int timeout, int fd)
 {
     (void)fd;
     coap_receive(networkSocket);
-    coap_check_transactions();
+    int nextTimeout = checkTimeouts();
+    if ((nextTimeout >= 0) && (nextTimeout < timeout))
+    {
+        timeout = nextTimeout;
+    }
     return timeout;
 }
 
+// Collect a Block1 request into its transfer. Returns true once the final block has arrived;
+// otherwise the response acknowledging the block, or reporting the failed transfer, is complete.
+static bool collectBlock1(coap_packet_t * request, coap_packet_t * response, const char * path, CoapBlock1Transfer ** transfer)
+{
+    bool complete = false;
+    uint64_t now = Lwm2mCore_GetTickCountMs();
+    uint32_t num;
+    uint32_t offset;
+    uint16_t blockSize;
+    uint8_t more;
+    const uint8_t * block = NULL;
+    int blockLength = coap_get_payload(request, &block);
+
+    coap_get_header_block1(request, &num, &more, &blockSize, &offset);
+
+    if (Block1Transfers == NULL)
+    {
+        *transfer = NULL;
+    }
+    else
+    {
+        *transfer = CoapBlock1Transfers_Find(Block1Transfers, sourceAddress, path);
+        // a first block restarts the upload, unless it repeats the only block received so far
+        if ((offset == 0) && ((*transfer == NULL) || ((*transfer)->Length != (size_t)blockLength) ||
+                              (memcmp((*transfer)->Payload, block, blockLength) != 0)))
+        {
+            *transfer = CoapBlock1Transfers_Start(Block1Transfers, sourceAddress, path, now);
+        }
+    }
+
+    if (*transfer == NULL)
+    {
+        coap_set_status_code(response, (offset == 0) ? SERVICE_UNAVAILABLE_5_03 : REQUEST_ENTITY_INCOMPLETE_4_08);
+        return false;
+    }
+
+    switch (CoapBlock1Transfers_Append(Block1Transfers, *transfer, offset, block, blockLength, now))
+    {
+    case CoapBlock1Result_Success:
+        // acknowledge the block, asking for smaller ones if the peer's exceed ours
+        coap_set_header_block1(response, num, more, MIN(blockSize, COAP_MAX_BLOCK_SIZE));
+        if (more)
+        {
+            coap_set_status_code(response, CONTINUE_2_31);
+        }
+        else
+        {
+            complete = true;
+        }
+        break;
+
+    case CoapBlock1Result_Duplicate:
+        // the peer did not see our ACK, so acknowledge the block again without appending it
+        Lwm2m_Debug("Block1 transfer of %s repeated block %lu\n", path, (unsigned long)num);
+        coap_set_header_block1(response, num, more, MIN(blockSize, COAP_MAX_BLOCK_SIZE));
+        coap_set_status_code(response, CONTINUE_2_31);
+        break;
+
+    case CoapBlock1Result_Incomplete:
+        Lwm2m_Error("Block1 transfer of %s out of sequence at offset %lu\n", path, (unsigned long)offset);
+        coap_set_status_code(response, REQUEST_ENTITY_INCOMPLETE_4_08);
+        CoapBlock1Transfers_Finish(Block1Transfers, *transfer);
+        break;
+
+    case CoapBlock1Result_TooLarge:
+        Lwm2m_Error("Block1 transfer of %s exceeds %lu bytes\n", path, (unsigned long)COAP_BLOCK1_MAX_PAYLOAD);
+        coap_set_status_code(response, REQUEST_ENTITY_TOO_LARGE_4_13);
+        CoapBlock1Transfers_Finish(Block1Transfers, *transfer);
+        break;
+    }
+    return complete;
+}
+
 static int coap_HandleRequest(void *packet, void *response, uint8_t *buffer, uint16_t preferred_size, int32_t *offset)
 {
     (void)offset;
@@ -165,10 +713,17 @@ static int coap_HandleRequest(void *packet, void *response, uint8_t *buffer, uin
     unsigned int content = 0;
 
     coap_packet_t * const request = (coap_packet_t *) packet;
+    CoapBlock1Transfer * block1Transfer = NULL;
 
     CoapResponse coapResponse =
     { .responseContent = (char *)buffer, .responseContentLen = preferred_size, .responseCode = 400, };
 
+    if (ResponseBuffer != NULL)
+    {
+        coapResponse.responseContent = ResponseBuffer;
+        coapResponse.responseContentLen = MaxPayloadSize;
+    }
+
     payloadLen = coap_get_payload(request, &payload);
 
     if ((urlLen = coap_get_header_uri_path(request, &url)))
@@ -179,6 +734,17 @@ static int coap_HandleRequest(void *packet, void *response, uint8_t *buffer, uin
         uriBuf[0] = '/';
         memcpy(&uriBuf[1], url, urlLen);
 
+        if (((method == METHOD_PUT) || (method == METHOD_POST)) && IS_OPTION(request, COAP_OPTION_BLOCK1))
+        {
+            if (!collectBlock1(request, response, uriBuf, &block1Transfer))
+            {
+                return result;
+            }
+            // handle the reassembled request as though it had arrived in one piece
+            payload = block1Transfer->Payload;
+            payloadLen = block1Transfer->Length;
+        }
+
         char queryBuf[128] = "?";
         const char * query = NULL;
 
@@ -270,7 +836,19 @@ static int coap_HandleRequest(void *packet, void *response, uint8_t *buffer, uin
 
         if (coapResponse.responseContentLen > 0 && coapResponse.responseCode == 205)
         {
-            coap_set_payload(response, coapResponse.responseContent, coapResponse.responseContentLen);
+            // not coap_set_payload(), which truncates to one block: the engine splits larger payloads into Block2 blocks
+            ((coap_packet_t *)response)->payload = (uint8_t *)coapResponse.responseContent;
+            ((coap_packet_t *)response)->payload_len = coapResponse.responseContentLen;
+            if (IS_OPTION(request, COAP_OPTION_BLOCK2) || (coapResponse.responseContentLen > preferred_size))
+            {
+                // each block is served from a fresh serialisation of the resource
+                setBlock2ETag(response, coapResponse.responseContent, coapResponse.responseContentLen);
+            }
+        }
+
+        if (block1Transfer != NULL)
+        {
+            CoapBlock1Transfers_Finish(Block1Transfers, block1Transfer);
         }
     }
 
@@ -327,46 +905,57 @@ void coap_CoapRequestCallback(void *callback_data, void *response)
 {
     TransactionType * transaction = (TransactionType *) callback_data;
     coap_packet_t * coap_response = (coap_packet_t *) response;
-    unsigned int ContentType = 0;
-    const char *url = NULL;
-    char * payload = NULL;
-    char uriBuf[64] =
-    { 0 };
 
     if (transaction != NULL)
     {
-        if (transaction->Callback)
-        {
-            if (response != NULL )
-            {
-                int urlLen = 0;
-                if ((urlLen = coap_get_header_location_path(response, &url)))
-                {
-                    uriBuf[0] = '/';
-                    memcpy(&uriBuf[1], url, urlLen);
-                }
-                else
-                {
-                    uriBuf[0] = '/';
-                    urlLen = strlen(transaction->Path);
-                    memcpy(&uriBuf[1], transaction->Path, urlLen);
-                }
-                coap_get_header_content_format(response, &ContentType);
-                int payloadLen = coap_get_payload(response,
-                                                  (const uint8_t **) &payload);
+        // Erbium has already freed its transaction
+        transaction->TransactionPtr = NULL;
 
-                transaction->Callback(transaction->Context, &transaction->Address, uriBuf, COAP_OPTION_TO_RESPONSE_CODE(coap_response->code),
-                        ContentType, payload, payloadLen);
-            }
-            else
-            {
-                transaction->Callback(transaction->Context, NULL, NULL, 0, 0, NULL, 0);
-            }
+        if ((coap_response != NULL) && (coap_response->type == COAP_TYPE_ACK) && (coap_response->code == 0))
+        {
+            // empty ACK: the response will follow in a separate message carrying our token
+            TimerQueue_Schedule(&SeparateResponseTimers, &transaction->SeparateResponseTimer, Lwm2mCore_GetTickCountMs() + COAP_EXCHANGE_LIFETIME_MS);
+        }
+        else if ((coap_response != NULL) && (findTransactionByToken(coap_response->token, coap_response->token_len) != transaction))
+        {
+            // the ACK is for our message, but a piggybacked response must also carry our token; wait for one that does
+            Lwm2m_Warning("Ignoring response to %s with a mismatched token\n", transaction->Path);
+            TimerQueue_Schedule(&SeparateResponseTimers, &transaction->SeparateResponseTimer, Lwm2mCore_GetTickCountMs() + COAP_EXCHANGE_LIFETIME_MS);
+        }
+        else
+        {
+            handleResponse(transaction, coap_response);
         }
-        transaction->TransactionUsed = false;
     }
 }
 
+void coap_handle_separate_response(NetworkAddress * sourceAddress, coap_packet_t * message)
+{
+    TransactionType * transaction = findTransactionByToken(message->token, message->token_len);
+    if ((transaction != NULL) && (NetworkAddress_Compare(transaction->RemoteAddress, sourceAddress) == 0))
+    {
+        handleResponse(transaction, message);
+    }
+}
+
+static Block1Upload * newUpload(coap_method_t method, AwaContentType contentType, const char * query, const char * payload, int payloadLen)
+{
+    Block1Upload * upload = malloc(sizeof(Block1Upload) + payloadLen);
+    if (upload != NULL)
+    {
+        upload->Method = method;
+        upload->ContentType = contentType;
+        strncpy(upload->Query, query, sizeof(upload->Query) - 1);
+        upload->Query[sizeof(upload->Query) - 1] = '\0';
+        upload->BlockSize = COAP_MAX_BLOCK_SIZE;
+        upload->Sent = 0;
+        upload->Length = payloadLen;
+        upload->Payload = (uint8_t *)(upload + 1);
+        memcpy(upload->Payload, payload, payloadLen);
+    }
+    return upload;
+}
+
 void coap_createCoapRequest(coap_method_t method, const char * uri, AwaContentType contentType, ObserveState observeState,
         const char * payload, int payloadLen, TransactionCallback callback, void * context)
 {
@@ -376,6 +965,10 @@ void coap_createCoapRequest(coap_method_t method, const char * uri, AwaContentTy
     char query[128] =
     { 0 };
     coap_transaction_t *transaction;
+    TransactionType * requestTransaction;
+    Block1Upload * upload = NULL;
+    uint16_t messageID;
+    uint32_t token = 0;
     NetworkAddress * remoteAddress = NetworkAddress_New(uri, strlen(uri));
 
     if (!remoteAddress)
@@ -396,7 +989,13 @@ void coap_createCoapRequest(coap_method_t method, const char * uri, AwaContentTy
     //Lwm2m_Debug("Coap request path: %s\n", path);
     //Lwm2m_Debug("Coap request query: %s\n", query);
 
-    coap_init_message(&request, COAP_TYPE_CON, method, coap_get_mid());
+    if (!newMessageID(&messageID))
+    {
+        Lwm2m_Error("No free message ID for CoAP request to %s\n", uri);
+        NetworkAddress_Free(&remoteAddress);
+        return;
+    }
+    coap_init_message(&request, COAP_TYPE_CON, method, messageID);
 
     coap_set_header_uri_path(&request, path);
     if (strlen(query) > 0)
@@ -409,6 +1008,13 @@ void coap_createCoapRequest(coap_method_t method, const char * uri, AwaContentTy
         {
             coap_set_header_content_format(&request, contentType);
             coap_set_payload(&request, payload, payloadLen);
+
+            if ((payloadLen > COAP_MAX_BLOCK_SIZE) && ((upload = newUpload(method, contentType, query, payload, payloadLen)) == NULL))
+            {
+                Lwm2m_Error("Unable to allocate memory for CoAP request to %s\n", uri);
+                NetworkAddress_Free(&remoteAddress);
+                return;
+            }
         }
         else
         {
@@ -416,65 +1022,107 @@ void coap_createCoapRequest(coap_method_t method, const char * uri, AwaContentTy
         }
     }
 
+    if ((method == COAP_GET) && (COAP_BLOCK2_PREFERRED_SIZE < COAP_MAX_BLOCK_SIZE))
+    {
+        // early negotiation: ask for smaller blocks than the peer would otherwise send
+        coap_set_header_block2(&request, 0, 0, COAP_BLOCK2_PREFERRED_SIZE);
+    }
+
 
     if (method == COAP_GET)
     {
         if (observeState == ObserveState_Establish)
         {
             coap_set_header_observe(&request, 0);
-            int token = addObserve(remoteAddress, path, callback, context);
-            if (token != 0)
-                coap_set_token(&request, (const uint8_t *) &token,
-                               sizeof(token));
+            token = addObserve(remoteAddress, path, callback, context);
 
         }
         else if (observeState == ObserveState_Cancel)
         {
             coap_set_header_observe(&request, 1);
-            int token = removeObserve(remoteAddress, path);
-            if (token != 0)
-                coap_set_token(&request, (const uint8_t *) &token,
-                               sizeof(token));
+            token = removeObserve(remoteAddress, path);
         }
     }
 
-//    if (CurrentTransaction[CurrentTransactionIndex].TransactionUsed && CurrentTransaction[CurrentTransactionIndex].TransactionPtr)
-//    {
-//        Lwm2m_Warning("Canceled previous transaction [%d]: %p\n", CurrentTransactionIndex,
-//                CurrentTransaction[CurrentTransactionIndex].TransactionPtr);
-//        coap_clear_transaction(&CurrentTransaction[CurrentTransactionIndex].TransactionPtr);
-//    }
+    if (token == 0)
+    {
+        token = newToken();
+    }
+    coap_set_token(&request, (const uint8_t *) &token, sizeof(token));
+
+    requestTransaction = newTransaction(messageID, (const uint8_t *) &token, sizeof(token));
+    if (requestTransaction == NULL)
+    {
+        Lwm2m_Error("Unable to allocate memory for CoAP request to %s\n", uri);
+        free(upload);
+        NetworkAddress_Free(&remoteAddress);
+        return;
+    }
+
+    if (upload != NULL)
+    {
+        // too large for one message: send the first block now and the rest as the peer asks for them
+        requestTransaction->Upload = upload;
+        setUploadBlock(upload, &request);
+    }
 
     //if ((transaction = coap_new_transaction(request.mid, remote_ipaddr, uip_htons(remote_port))))
     if ((transaction = coap_new_transaction(networkSocket, request.mid, remoteAddress)))
     {
         transaction->callback = coap_CoapRequestCallback;
-        memcpy(CurrentTransaction[CurrentTransactionIndex].Path, path, MAX_COAP_PATH);
-        CurrentTransaction[CurrentTransactionIndex].Callback = callback;
-        CurrentTransaction[CurrentTransactionIndex].Context = context;
-        CurrentTransaction[CurrentTransactionIndex].TransactionUsed = true;
-        CurrentTransaction[CurrentTransactionIndex].TransactionPtr = transaction;
-        NetworkAddress_SetAddressType(remoteAddress, &CurrentTransaction[CurrentTransactionIndex].Address);
+        memcpy(requestTransaction->Path, path, MAX_COAP_PATH);
+        requestTransaction->Callback = callback;
+        requestTransaction->Context = context;
+        requestTransaction->TransactionPtr = transaction;
+        requestTransaction->RemoteAddress = remoteAddress;
+        requestTransaction->Accept = (method == COAP_GET) ? contentType : AwaContentType_None;
+        NetworkAddress_SetAddressType(remoteAddress, &requestTransaction->Address);
 
-        transaction->callback_data = &CurrentTransaction[CurrentTransactionIndex];
+        transaction->callback_data = requestTransaction;
 
         transaction->packet_len = coap_serialize_message(&request, transaction->packet);
 
-        Lwm2m_Debug("Sending transaction [%d]: %p\n", CurrentTransactionIndex, (void*)CurrentTransaction[CurrentTransactionIndex].TransactionPtr);
+        Lwm2m_Debug("Sending transaction %u: %p\n", messageID, (void*)transaction);
         coap_send_transaction(transaction);
-
-        CurrentTransactionIndex++;
-
-        if (CurrentTransactionIndex >= MAX_COAP_TRANSACTIONS)
-        {
-            CurrentTransactionIndex = 0;
-        }
+    }
+    else
+    {
+        freeTransaction(requestTransaction);
+        NetworkAddress_Free(&remoteAddress);
     }
 }
 
 int coap_Destroy(void)
 {
     Lwm2m_Info("Close port: \n");     //  TODO - remove
+
+    // abandon outstanding requests
+    HashTableNode * node = HashTable_First(&TransactionsByMessageID);
+    while (node != NULL)
+    {
+        HashTableNode * next = HashTable_Next(&TransactionsByMessageID, node);
+        freeTransaction(HashTableEntry(node, TransactionType, MessageIDNode));
+        node = next;
+    }
+    HashTable_Destroy(&TransactionsByMessageID);
+    HashTable_Destroy(&TransactionsByToken);
+    TimerQueue_Destroy(&SeparateResponseTimers);
+
+    CoapObservationTable_Destroy(Observations);
+    Observations = NULL;
+
+    free(ResponseBuffer);
+    ResponseBuffer = NULL;
+    CoapBlock1Transfers_Destroy(Block1Transfers);
+    Block1Transfers = NULL;
+
+    MemoryPoolStats poolStats;
+    coap_get_transaction_pool_stats(&poolStats);
+    Lwm2m_Info("CoAP transaction pool: peak %lu in use, %lu allocations (%lu reused), %lu failures\n",
+               (unsigned long)poolStats.Peak, (unsigned long)poolStats.Allocations, (unsigned long)poolStats.Reused,
+               (unsigned long)poolStats.AllocationFailures);
+    coap_destroy_transactions();
+
     if (networkSocket)
         NetworkSocket_Free(&networkSocket);
     // TODO - close any open sessions
@@ -483,14 +1131,20 @@ int coap_Destroy(void)
     return 0;
 }
 
-void coap_Process(void)
+int coap_Process(void)
 {
-    coap_check_transactions();
+    return checkTimeouts();
 }
 
 void coap_HandleMessage(void)
 {
-    coap_receive(networkSocket);
+    // handle every datagram the socket read ahead, and send what they produce together
+    NetworkSocket_StartBatch(networkSocket);
+    do
+    {
+        coap_receive(networkSocket);
+    } while (NetworkSocket_HasPendingReads(networkSocket));
+    NetworkSocket_EndBatch(networkSocket);
 }
 
 void coap_GetRequest(void * context, const char * path, AwaContentType contentType, TransactionCallback callback)
@@ -552,6 +1206,13 @@ void coap_SendNotify(AddressType * addr, const char * path, const char * token,
         {
             coap_set_header_content_format(&notify, contentType);
             coap_set_payload(&notify, payload, payloadLen);
+            if (payloadLen > COAP_MAX_BLOCK_SIZE)
+            {
+                // the observer fetches the remaining blocks with GET requests
+                coap_set_header_block2(&notify, 0, 1, COAP_MAX_BLOCK_SIZE);
+                coap_set_payload(&notify, payload, COAP_MAX_BLOCK_SIZE);
+                setBlock2ETag(&notify, payload, payloadLen);
+            }
         }
 
         coap_set_token(&notify, (unsigned char *)token, tokenSize);
@@ -563,6 +1224,7 @@ void coap_SendNotify(AddressType * addr, const char * path, const char * token,
 
             coap_send_transaction(transaction); // for NON confirmable messages this will call coap_clear_transaction();
         }
+        NetworkAddress_Free(&remoteAddress);
     }
 }
 
@@ -593,65 +1255,49 @@ int coap_DeregisterUri(const char * path)
 static int addObserve(NetworkAddress * remoteAddress, char * path, TransactionCallback callback, void * context)
 {
     int result = 0;
-    int index;
-    Observation * observation = NULL;
-    for (index = 0; index < MAX_COAP_OBSERVATIONS; index++)
-    {
-        if (Observations[index].Token == 0)
-        {
-            observation = &Observations[index];
-            break;
-        }
-    }
+    CoapObservation * observation = CoapObservationTable_Add(Observations, remoteAddress, path, callback, context);
     if (observation)
     {
-        observation->Address = remoteAddress;
-        int length = strlen(path);
-        memcpy(observation->Path, path, length);
-        observation->Path[length] = '\0';
-        bool found;
-        do
-        {
-            result = rand();
-            if (result == 0)
-                found = true;
-            else
-            {
-                found = false;
-                for (index = 0; index < MAX_COAP_OBSERVATIONS; index++)
-                {
-                    if (Observations[index].Token == result)
-                    {
-                        found = true;
-                        break;
-                    }
-                }
-            }
-        } while (found);
-        observation->Token = result;
-        observation->Callback =  callback;
-        observation->Context = context;
+        result = observation->Token;
     }
     return result;
 }
 
 static int removeObserve(NetworkAddress * remoteAddress, char * path)
 {
-    (void)remoteAddress;
     int result = 0;
-    int index;
-    for (index = 0; index < MAX_COAP_OBSERVATIONS; index++)
+    CoapObservation * observation = CoapObservationTable_FindByAddressAndPath(Observations, remoteAddress, path);
+    if (observation)
     {
-        if ((NetworkAddress_Compare(Observations[index].Address, sourceAddress) == 0) && (strcmp(Observations[index].Path,path) == 0))
-        {
-            result = Observations[index].Token;
-            memset(&Observations[index],0, sizeof(Observation));
-            break;
-        }
+        result = observation->Token;
+        CoapObservationTable_Remove(Observations, observation);
     }
     return result;
 }
 
+// A notification too large for one message carries its first block; fetch the rest as a new request on the observer's behalf
+static void fetchNotificationBlocks(CoapObservation * observation, NetworkAddress * sourceAddress, coap_packet_t * message, unsigned int contentType)
+{
+    uint32_t token = newToken();
+    uint16_t messageID;
+    TransactionType * transaction = newMessageID(&messageID) ? newTransaction(messageID, (const uint8_t *) &token, sizeof(token)) : NULL;
+    if (transaction != NULL)
+    {
+        strncpy(transaction->Path, observation->Path, MAX_COAP_PATH - 1);
+        transaction->Callback = observation->Callback;
+        transaction->Context = observation->Context;
+        transaction->RemoteAddress = NetworkAddress_Retain(sourceAddress);
+        transaction->Accept = contentType;
+        transaction->Notification = true;
+        NetworkAddress_SetAddressType(sourceAddress, &transaction->Address);
+
+        handleResponse(transaction, message);
+    }
+    else
+    {
+        Lwm2m_Error("Unable to allocate memory for Block2 notification of %s\n", observation->Path);
+    }
+}
 
 void coap_handle_notification(NetworkAddress * sourceAddress, coap_packet_t * message)
 {
@@ -659,29 +1305,29 @@ void coap_handle_notification(NetworkAddress * sourceAddress, coap_packet_t * me
     {
         int token;
         memcpy(&token, message->token, sizeof(int));
-        Observation * observation = NULL;
-        int index;
-        for (index = 0; index < MAX_COAP_OBSERVATIONS; index++)
-        {
-            if ((Observations[index].Token == token) && (NetworkAddress_Compare(Observations[index].Address, sourceAddress) == 0))
-            {
-                observation = &Observations[index];
-                break;
-            }
-        }
+        CoapObservation * observation = CoapObservationTable_FindByToken(Observations, token, sourceAddress);
         if (observation && observation->Callback)
         {
             AddressType address;
             unsigned int ContentType = 0;
             char * payload = NULL;
 
-            NetworkAddress_SetAddressType(sourceAddress, &address);
+            uint8_t more = 0;
+
             coap_get_header_content_format(message, &ContentType);
-            int payloadLen = coap_get_payload(message,
-                                              (const uint8_t **) &payload);
+            if (coap_get_header_block2(message, NULL, &more, NULL, NULL) && more)
+            {
+                fetchNotificationBlocks(observation, sourceAddress, message, ContentType);
+            }
+            else
+            {
+                NetworkAddress_SetAddressType(sourceAddress, &address);
+                int payloadLen = coap_get_payload(message,
+                                                  (const uint8_t **) &payload);
 
-            observation->Callback(observation->Context, &address, observation->Path, COAP_OPTION_TO_RESPONSE_CODE(message->code),
-                    ContentType, payload, payloadLen);
+                observation->Callback(observation->Context, &address, observation->Path, COAP_OPTION_TO_RESPONSE_CODE(message->code),
+                        ContentType, payload, payloadLen);
+            }
         }
     }
 
@@ -44,6 +44,7 @@
 #include "lwm2m_util.h"
 #include "lwm2m_list.h"
 #include "lwm2m_debug.h"
+#include "lwm2m_endpoints.h"
 
 #define WITH_POSIX 1
 //#define  COAP_4_1_1  // build against libcoap 4.1.1 (last released version)
@@ -93,6 +94,12 @@ static coap_context_t * coapContext = NULL;
 static void * context = NULL;
 static CoapInfo coapInfo;
 static RequestHandler requestHandler = NULL;
+static size_t MaxPayloadSize = COAP_MAX_PAYLOAD_SIZE;
+
+// Path of the resource that handles requests for paths with no resource of their own, and how many wildcard
+// routes rely on it
+#define COAP_UNKNOWN_RESOURCE_PATH "*"
+static int WildcardRoutes = 0;
 
 
 void coap_Reset(const char * uri)
@@ -789,9 +796,28 @@ int coap_RegisterUri(const char * uri)
     }
 
     coap_resource_t * r;
+    char * resourceUri;
+
+    if (Lwm2mEndPoint_IsWildcardPath(uri))
+    {
+        // libcoap dispatches on exact resource keys, so wildcard routes (e.g. /rd/<location>) are reached
+        // through the catch-all resource that lib/libcoap/patches adds for paths without a resource of their own
+        if (WildcardRoutes++ > 0)
+        {
+            return 0;
+        }
+        uri = COAP_UNKNOWN_RESOURCE_PATH;
+    }
+
+    // the caller's copy of the path need not outlive the call, so the resource keeps its own
+    resourceUri = strdup(uri);
+    if (resourceUri == NULL)
+    {
+        return -1;
+    }
 
     Lwm2m_Debug("register %s\n", uri);
-    r = coap_resource_init(uri, strlen(uri), 0);
+    r = coap_resource_init((unsigned char *)resourceUri, strlen(resourceUri), COAP_RESOURCE_FLAGS_RELEASE_URI);
 
     coap_register_handler(r, COAP_REQUEST_GET,    coap_HandleRequest);
     coap_register_handler(r, COAP_REQUEST_POST,   coap_HandleRequest);
@@ -812,9 +838,18 @@ int coap_DeregisterUri(const char * uri)
         return -1;
     }
 
+    if (Lwm2mEndPoint_IsWildcardPath(uri))
+    {
+        if ((WildcardRoutes == 0) || (--WildcardRoutes > 0))
+        {
+            return 0;
+        }
+        uri = COAP_UNKNOWN_RESOURCE_PATH;
+    }
+
     coap_key_t key;
     memset(key, 0, sizeof(key));
-    coap_hash_path(uri, strlen(uri), key);
+    coap_hash_path((const unsigned char *)uri, strlen(uri), key);
     coap_delete_resource(context, key);
 
     Lwm2m_Debug("deregister %s\n", uri);
@@ -859,12 +894,13 @@ void coap_HandleMessage(void)
 #endif
 }
 
-void coap_Process(void)
+int coap_Process(void)
 {
     coap_context_t * ctx = coapContext;
 
     coap_queue_t *nextpdu;
     coap_tick_t now;
+    int timeout = -1;
 
     nextpdu = coap_peek_next( ctx );
 
@@ -896,6 +932,12 @@ void coap_Process(void)
 
         nextpdu = coap_peek_next( ctx );
     }
+
+    if (nextpdu)
+    {
+        timeout = ((nextpdu->t - (now - ctx->sendqueue_basetime)) * 1000) / COAP_TICKS_PER_SECOND;
+    }
+    return timeout;
 }
 
 static void coap_SendRequest(int messageType, void * context, char * token, int tokenSize, const char * path, AwaContentType contentType,
@@ -1150,6 +1192,7 @@ CoapInfo * coap_Init(const char * ipAddress, int port, bool secure, int logLevel
     coap_register_response_handler(coapContext, coap_ResponseHandler);
 
     coapInfo.fd = coapContext->sockfd;
+    coapInfo.ipv6fd = -1;
 
     ListInit(&transactionCallbackList);
     ListInit(&notifyCallbackList);
@@ -1176,6 +1219,17 @@ void coap_SetLogLevel(int logLevel)
     coap_set_log_level(logLevel);
 }
 
+// Responses here fit one message and are never sent in blocks; the setting only bounds notifications serialised by the caller
+void coap_SetMaxPayloadSize(size_t maxPayloadSize)
+{
+    MaxPayloadSize = maxPayloadSize;
+}
+
+size_t coap_GetMaxPayloadSize(void)
+{
+    return MaxPayloadSize;
+}
+
 static void DestroyLists(void)
 {
     struct ListHead * i, * n;
@@ -1211,6 +1265,8 @@ static void DestroyLists(void)
 int coap_Destroy(void)
 {
     coap_free_context(coapContext);
+    coapContext = NULL;
+    WildcardRoutes = 0;
     DestroyLists();
 
     return 0;
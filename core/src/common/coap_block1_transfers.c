@@ -0,0 +1,201 @@
+/************************************************************************************************************************
+ Copyright (c) 2016, Imagination Technologies Limited and/or its affiliated group companies.
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+ following conditions are met:
+     1. Redistributions of source code must retain the above copyright notice, this list of conditions and the
+        following disclaimer.
+     2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the
+        following disclaimer in the documentation and/or other materials provided with the distribution.
+     3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote
+        products derived from this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+ USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+************************************************************************************************************************/
+
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "lwm2m_debug.h"
+#include "coap_block1_transfers.h"
+
+struct _CoapBlock1Transfers
+{
+    HashTable AddressPathIndex;
+    TimerQueue ExpiryTimers;
+    MemoryPool Buffers;                 // each object is a CoapBlock1Transfer followed by its payload buffer
+    size_t MaxPayload;
+    uint32_t TimeoutMs;
+};
+
+#ifndef COAP_BLOCK1_POOL_MAX_FREE
+#define COAP_BLOCK1_POOL_MAX_FREE (1)
+#endif
+
+static uint32_t HashAddressAndPath(NetworkAddress * address, const char * path)
+{
+    return HashTable_HashUInt32(NetworkAddress_Hash(address) ^ HashTable_HashString(path));
+}
+
+CoapBlock1Transfers * CoapBlock1Transfers_Create(size_t maxPayload, size_t maxTransfers, uint32_t timeoutMs)
+{
+    CoapBlock1Transfers * transfers = malloc(sizeof(CoapBlock1Transfers));
+    if (transfers != NULL)
+    {
+        HashTable_Init(&transfers->AddressPathIndex);
+        TimerQueue_Init(&transfers->ExpiryTimers);
+        MemoryPool_Init(&transfers->Buffers, sizeof(CoapBlock1Transfer) + maxPayload, maxTransfers, COAP_BLOCK1_POOL_MAX_FREE);
+        transfers->MaxPayload = maxPayload;
+        transfers->TimeoutMs = timeoutMs;
+    }
+    else
+    {
+        Lwm2m_Error("Unable to allocate memory for Block1 transfers\n");
+    }
+    return transfers;
+}
+
+void CoapBlock1Transfers_Destroy(CoapBlock1Transfers * transfers)
+{
+    if (transfers != NULL)
+    {
+        HashTableNode * node = HashTable_First(&transfers->AddressPathIndex);
+        while (node != NULL)
+        {
+            HashTableNode * next = HashTable_Next(&transfers->AddressPathIndex, node);
+            CoapBlock1Transfers_Finish(transfers, HashTableEntry(node, CoapBlock1Transfer, AddressPathNode));
+            node = next;
+        }
+        HashTable_Destroy(&transfers->AddressPathIndex);
+        TimerQueue_Destroy(&transfers->ExpiryTimers);
+        MemoryPool_Destroy(&transfers->Buffers);
+        free(transfers);
+    }
+}
+
+CoapBlock1Transfer * CoapBlock1Transfers_Find(CoapBlock1Transfers * transfers, NetworkAddress * address, const char * path)
+{
+    HashTableNode * node;
+    for (node = HashTable_FindFirst(&transfers->AddressPathIndex, HashAddressAndPath(address, path)); node != NULL; node = HashTable_FindNext(node))
+    {
+        CoapBlock1Transfer * transfer = HashTableEntry(node, CoapBlock1Transfer, AddressPathNode);
+        if ((NetworkAddress_Compare(transfer->Address, address) == 0) && (strcmp(transfer->Path, path) == 0))
+        {
+            return transfer;
+        }
+    }
+    return NULL;
+}
+
+CoapBlock1Transfer * CoapBlock1Transfers_Start(CoapBlock1Transfers * transfers, NetworkAddress * address, const char * path, uint64_t now)
+{
+    CoapBlock1Transfer * transfer = NULL;
+
+    if (strlen(path) >= MAX_COAP_BLOCK1_PATH)
+    {
+        Lwm2m_Error("Block1 transfer path too long: %s\n", path);
+        return NULL;
+    }
+
+    transfer = CoapBlock1Transfers_Find(transfers, address, path);
+    if (transfer != NULL)
+    {
+        // the peer has restarted its upload
+        CoapBlock1Transfers_Finish(transfers, transfer);
+    }
+
+    transfer = MemoryPool_Alloc(&transfers->Buffers);
+    if (transfer != NULL)
+    {
+        TimerQueue_InitNode(&transfer->ExpiryTimer);
+        transfer->Address = address;
+        strcpy(transfer->Path, path);
+        transfer->Length = 0;
+        transfer->LastBlockOffset = 0;
+        transfer->Payload = (uint8_t *)(transfer + 1);
+
+        if ((HashTable_Insert(&transfers->AddressPathIndex, &transfer->AddressPathNode, HashAddressAndPath(address, path)) != 0) ||
+            (TimerQueue_Schedule(&transfers->ExpiryTimers, &transfer->ExpiryTimer, now + transfers->TimeoutMs) != 0))
+        {
+            HashTable_Remove(&transfers->AddressPathIndex, &transfer->AddressPathNode);
+            MemoryPool_Free(&transfers->Buffers, transfer);
+            transfer = NULL;
+        }
+        else
+        {
+            NetworkAddress_Retain(address);
+        }
+    }
+    else
+    {
+        Lwm2m_Warning("Too many Block1 transfers in progress, refusing %s\n", path);
+    }
+    return transfer;
+}
+
+CoapBlock1Result CoapBlock1Transfers_Append(CoapBlock1Transfers * transfers, CoapBlock1Transfer * transfer, size_t offset,
+                                            const uint8_t * block, size_t blockLength, uint64_t now)
+{
+    CoapBlock1Result result;
+    if ((transfer->Length > 0) && (offset == transfer->LastBlockOffset) && (offset + blockLength == transfer->Length) &&
+        (memcmp(&transfer->Payload[offset], block, blockLength) == 0))
+    {
+        TimerQueue_Schedule(&transfers->ExpiryTimers, &transfer->ExpiryTimer, now + transfers->TimeoutMs);
+        result = CoapBlock1Result_Duplicate;
+    }
+    else if (offset != transfer->Length)
+    {
+        result = CoapBlock1Result_Incomplete;
+    }
+    else if (offset + blockLength > transfers->MaxPayload)
+    {
+        result = CoapBlock1Result_TooLarge;
+    }
+    else
+    {
+        memcpy(&transfer->Payload[offset], block, blockLength);
+        transfer->LastBlockOffset = offset;
+        transfer->Length = offset + blockLength;
+        TimerQueue_Schedule(&transfers->ExpiryTimers, &transfer->ExpiryTimer, now + transfers->TimeoutMs);
+        result = CoapBlock1Result_Success;
+    }
+    return result;
+}
+
+void CoapBlock1Transfers_Finish(CoapBlock1Transfers * transfers, CoapBlock1Transfer * transfer)
+{
+    HashTable_Remove(&transfers->AddressPathIndex, &transfer->AddressPathNode);
+    TimerQueue_Cancel(&transfers->ExpiryTimers, &transfer->ExpiryTimer);
+    NetworkAddress_Free(&transfer->Address);
+    MemoryPool_Free(&transfers->Buffers, transfer);
+}
+
+int CoapBlock1Transfers_Expire(CoapBlock1Transfers * transfers, uint64_t now)
+{
+    TimerQueueNode * node;
+    while ((node = TimerQueue_PopExpired(&transfers->ExpiryTimers, now)) != NULL)
+    {
+        CoapBlock1Transfer * transfer = TimerQueueEntry(node, CoapBlock1Transfer, ExpiryTimer);
+        Lwm2m_Warning("Block1 transfer of %s timed out after %lu bytes\n", transfer->Path, (unsigned long)transfer->Length);
+        CoapBlock1Transfers_Finish(transfers, transfer);
+    }
+    return TimerQueue_GetTimeout(&transfers->ExpiryTimers, now);
+}
+
+size_t CoapBlock1Transfers_GetCount(const CoapBlock1Transfers * transfers)
+{
+    return HashTable_Count(&transfers->AddressPathIndex);
+}
+
+void CoapBlock1Transfers_GetPoolStats(const CoapBlock1Transfers * transfers, MemoryPoolStats * stats)
+{
+    MemoryPool_GetStats(&transfers->Buffers, stats);
+}
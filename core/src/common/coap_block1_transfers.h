@@ -0,0 +1,96 @@
+/************************************************************************************************************************
+ Copyright (c) 2016, Imagination Technologies Limited and/or its affiliated group companies.
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+ following conditions are met:
+     1. Redistributions of source code must retain the above copyright notice, this list of conditions and the
+        following disclaimer.
+     2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the
+        following disclaimer in the documentation and/or other materials provided with the distribution.
+     3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote
+        products derived from this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+ USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+************************************************************************************************************************/
+
+#ifndef COAP_BLOCK1_TRANSFERS_H
+#define COAP_BLOCK1_TRANSFERS_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "lwm2m_hash_table.h"
+#include "lwm2m_timer_queue.h"
+#include "lwm2m_pool.h"
+#include "network_abstraction.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Block1 uploads being received from remote endpoints, indexed by remote address and path. Each transfer
+ * reassembles into a buffer of MaxPayload bytes taken from a pool that also caps how many transfers may
+ * be in progress at once, so memory stays bounded however many peers start uploads. Transfers that stop
+ * receiving blocks are expired after a timeout.
+ */
+
+#ifndef MAX_COAP_BLOCK1_PATH
+#define MAX_COAP_BLOCK1_PATH (64)
+#endif
+
+typedef enum
+{
+    CoapBlock1Result_Success,
+    CoapBlock1Result_Duplicate,         // retransmission of the last block appended, e.g. because its ACK was lost
+    CoapBlock1Result_Incomplete,        // block does not follow on from those received so far
+    CoapBlock1Result_TooLarge,          // block would take the payload past MaxPayload
+} CoapBlock1Result;
+
+typedef struct _CoapBlock1Transfers CoapBlock1Transfers;
+
+typedef struct
+{
+    HashTableNode AddressPathNode;
+    TimerQueueNode ExpiryTimer;
+    NetworkAddress * Address;
+    char Path[MAX_COAP_BLOCK1_PATH];
+    size_t Length;                      // bytes received so far
+    size_t LastBlockOffset;             // where the last block appended starts
+    uint8_t * Payload;
+} CoapBlock1Transfer;
+
+CoapBlock1Transfers * CoapBlock1Transfers_Create(size_t maxPayload, size_t maxTransfers, uint32_t timeoutMs);
+void CoapBlock1Transfers_Destroy(CoapBlock1Transfers * transfers);
+
+// Start a new transfer, replacing any already in progress for the same address and path.
+// Returns NULL if the maximum number of transfers are in progress or the path is too long.
+CoapBlock1Transfer * CoapBlock1Transfers_Start(CoapBlock1Transfers * transfers, NetworkAddress * address, const char * path, uint64_t now);
+
+CoapBlock1Transfer * CoapBlock1Transfers_Find(CoapBlock1Transfers * transfers, NetworkAddress * address, const char * path);
+
+// Append the block at offset and restart the transfer's timeout. A repeat of the last block appended, with
+// the same offset and contents, is not appended again.
+CoapBlock1Result CoapBlock1Transfers_Append(CoapBlock1Transfers * transfers, CoapBlock1Transfer * transfer, size_t offset,
+                                            const uint8_t * block, size_t blockLength, uint64_t now);
+
+// Remove a transfer and return its buffer to the pool
+void CoapBlock1Transfers_Finish(CoapBlock1Transfers * transfers, CoapBlock1Transfer * transfer);
+
+// Finish any transfers whose timeout has passed. Returns milliseconds until the next expiry, or -1 if none.
+int CoapBlock1Transfers_Expire(CoapBlock1Transfers * transfers, uint64_t now);
+
+size_t CoapBlock1Transfers_GetCount(const CoapBlock1Transfers * transfers);
+void CoapBlock1Transfers_GetPoolStats(const CoapBlock1Transfers * transfers, MemoryPoolStats * stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // COAP_BLOCK1_TRANSFERS_H
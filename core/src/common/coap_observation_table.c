@@ -0,0 +1,173 @@
+/************************************************************************************************************************
+ Copyright (c) 2016, Imagination Technologies Limited and/or its affiliated group companies.
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+ following conditions are met:
+     1. Redistributions of source code must retain the above copyright notice, this list of conditions and the
+        following disclaimer.
+     2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the
+        following disclaimer in the documentation and/or other materials provided with the distribution.
+     3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote
+        products derived from this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+ USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+************************************************************************************************************************/
+
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "lwm2m_debug.h"
+#include "coap_observation_table.h"
+
+struct _CoapObservationTable
+{
+    HashTable TokenIndex;
+    HashTable AddressPathIndex;
+};
+
+static uint32_t HashToken(int token)
+{
+    return HashTable_HashUInt32((uint32_t)token);
+}
+
+static uint32_t HashAddressAndPath(NetworkAddress * address, const char * path)
+{
+    return HashTable_HashUInt32(NetworkAddress_Hash(address) ^ HashTable_HashString(path));
+}
+
+static CoapObservation * FindByToken(CoapObservationTable * table, int token)
+{
+    HashTableNode * node;
+    for (node = HashTable_FindFirst(&table->TokenIndex, HashToken(token)); node != NULL; node = HashTable_FindNext(node))
+    {
+        CoapObservation * observation = HashTableEntry(node, CoapObservation, TokenNode);
+        if (observation->Token == token)
+        {
+            return observation;
+        }
+    }
+    return NULL;
+}
+
+CoapObservationTable * CoapObservationTable_Create(void)
+{
+    CoapObservationTable * table = malloc(sizeof(CoapObservationTable));
+    if (table != NULL)
+    {
+        HashTable_Init(&table->TokenIndex);
+        HashTable_Init(&table->AddressPathIndex);
+    }
+    else
+    {
+        Lwm2m_Error("Unable to allocate memory for observation table\n");
+    }
+    return table;
+}
+
+void CoapObservationTable_Destroy(CoapObservationTable * table)
+{
+    if (table != NULL)
+    {
+        HashTableNode * node = HashTable_First(&table->TokenIndex);
+        while (node != NULL)
+        {
+            HashTableNode * next = HashTable_Next(&table->TokenIndex, node);
+            CoapObservationTable_Remove(table, HashTableEntry(node, CoapObservation, TokenNode));
+            node = next;
+        }
+        HashTable_Destroy(&table->TokenIndex);
+        HashTable_Destroy(&table->AddressPathIndex);
+        free(table);
+    }
+}
+
+CoapObservation * CoapObservationTable_Add(CoapObservationTable * table, NetworkAddress * address, const char * path,
+                                           TransactionCallback callback, void * context)
+{
+    CoapObservation * observation = NULL;
+    size_t length = strlen(path);
+
+    if (length >= MAX_COAP_OBSERVATION_PATH)
+    {
+        Lwm2m_Error("Observation path too long: %s\n", path);
+    }
+    else if ((observation = malloc(sizeof(CoapObservation))) == NULL)
+    {
+        Lwm2m_Error("Unable to allocate memory for observation of %s\n", path);
+    }
+    else
+    {
+        int token;
+        do
+        {
+            token = rand();
+        } while ((token == 0) || (FindByToken(table, token) != NULL));
+
+        memset(observation, 0, sizeof(CoapObservation));
+        observation->Address = NetworkAddress_Retain(address);
+        memcpy(observation->Path, path, length + 1);
+        observation->Token = token;
+        observation->Callback = callback;
+        observation->Context = context;
+
+        if (HashTable_Insert(&table->TokenIndex, &observation->TokenNode, HashToken(token)) != 0)
+        {
+            NetworkAddress_Free(&observation->Address);
+            free(observation);
+            observation = NULL;
+        }
+        else if (HashTable_Insert(&table->AddressPathIndex, &observation->AddressPathNode, HashAddressAndPath(address, path)) != 0)
+        {
+            HashTable_Remove(&table->TokenIndex, &observation->TokenNode);
+            NetworkAddress_Free(&observation->Address);
+            free(observation);
+            observation = NULL;
+        }
+    }
+    return observation;
+}
+
+void CoapObservationTable_Remove(CoapObservationTable * table, CoapObservation * observation)
+{
+    HashTable_Remove(&table->TokenIndex, &observation->TokenNode);
+    HashTable_Remove(&table->AddressPathIndex, &observation->AddressPathNode);
+    NetworkAddress_Free(&observation->Address);
+    free(observation);
+}
+
+CoapObservation * CoapObservationTable_FindByToken(CoapObservationTable * table, int token, NetworkAddress * address)
+{
+    CoapObservation * observation = FindByToken(table, token);
+    if ((observation != NULL) && (NetworkAddress_Compare(observation->Address, address) != 0))
+    {
+        observation = NULL;
+    }
+    return observation;
+}
+
+CoapObservation * CoapObservationTable_FindByAddressAndPath(CoapObservationTable * table, NetworkAddress * address, const char * path)
+{
+    HashTableNode * node;
+    for (node = HashTable_FindFirst(&table->AddressPathIndex, HashAddressAndPath(address, path)); node != NULL; node = HashTable_FindNext(node))
+    {
+        CoapObservation * observation = HashTableEntry(node, CoapObservation, AddressPathNode);
+        if ((strcmp(observation->Path, path) == 0) && (NetworkAddress_Compare(observation->Address, address) == 0))
+        {
+            return observation;
+        }
+    }
+    return NULL;
+}
+
+size_t CoapObservationTable_GetCount(const CoapObservationTable * table)
+{
+    return HashTable_Count(&table->TokenIndex);
+}
@@ -0,0 +1,78 @@
+/************************************************************************************************************************
+ Copyright (c) 2016, Imagination Technologies Limited and/or its affiliated group companies.
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+ following conditions are met:
+     1. Redistributions of source code must retain the above copyright notice, this list of conditions and the
+        following disclaimer.
+     2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the
+        following disclaimer in the documentation and/or other materials provided with the distribution.
+     3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote
+        products derived from this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+ USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+************************************************************************************************************************/
+
+
+#ifndef COAP_OBSERVATION_TABLE_H
+#define COAP_OBSERVATION_TABLE_H
+
+#include <stddef.h>
+
+#include "lwm2m_hash_table.h"
+#include "network_abstraction.h"
+#include "coap_abstraction.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Observations this endpoint has established on remote resources. Each is indexed by its token, to
+ * dispatch incoming notifications, and by remote address and path, to find the observation to cancel,
+ * so both are O(1) however many observations are active. The table grows as needed.
+ */
+
+#ifndef MAX_COAP_OBSERVATION_PATH
+#define MAX_COAP_OBSERVATION_PATH (64)
+#endif
+
+typedef struct _CoapObservationTable CoapObservationTable;
+
+typedef struct
+{
+    HashTableNode TokenNode;
+    HashTableNode AddressPathNode;
+    NetworkAddress * Address;
+    char Path[MAX_COAP_OBSERVATION_PATH];
+    int Token;
+    TransactionCallback Callback;
+    void * Context;
+} CoapObservation;
+
+CoapObservationTable * CoapObservationTable_Create(void);
+void CoapObservationTable_Destroy(CoapObservationTable * table);
+
+// Add an observation with a new, unique, non-zero token. Returns NULL if out of memory or the path is too long.
+CoapObservation * CoapObservationTable_Add(CoapObservationTable * table, NetworkAddress * address, const char * path,
+                                           TransactionCallback callback, void * context);
+
+// Remove and free an observation
+void CoapObservationTable_Remove(CoapObservationTable * table, CoapObservation * observation);
+
+CoapObservation * CoapObservationTable_FindByToken(CoapObservationTable * table, int token, NetworkAddress * address);
+CoapObservation * CoapObservationTable_FindByAddressAndPath(CoapObservationTable * table, NetworkAddress * address, const char * path);
+
+size_t CoapObservationTable_GetCount(const CoapObservationTable * table);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // COAP_OBSERVATION_TABLE_H
@@ -33,6 +33,7 @@ extern "C" {
 #endif
 
 #include "network_abstraction.h"
+#include "dtls_psk_keystore.h"
 
 typedef enum
 {
@@ -45,6 +46,21 @@ typedef enum
 } NetworkTransmissionError;
 
 
+typedef struct
+{
+    unsigned long Live;                 // sessions currently held
+    unsigned long Peak;                 // highest Live seen
+    unsigned long Handshakes;           // sessions set up
+    unsigned long Resumptions;          // handshakes that resumed an earlier session instead of a full handshake
+    unsigned long Rebinds;              // sessions moved to a new peer address by their connection ID
+    unsigned long Evictions;            // least recently used sessions dropped to stay within capacity
+    unsigned long IdleExpiries;         // sessions dropped after going unused for the idle timeout
+} DTLS_SessionStats;
+
+// Upper bound on the bytes a DTLS record adds to its plaintext: header and connection ID, explicit IV, MAC and
+// block padding for the cipher suites offered. An encryptedBuffer this much larger than the plaintext always fits.
+#define DTLS_MAX_RECORD_OVERHEAD (128)
+
 typedef NetworkTransmissionError (*DTLS_NetworkSendCallback)(NetworkAddress * destAddress,const uint8_t * buffer, int bufferLength, void *context);
 
 extern const char * DTLS_LibraryName;
@@ -53,6 +69,7 @@ void DTLS_Init(void);
 
 void DTLS_Shutdown(void);
 
+// decryptBuffer may be the encrypted buffer itself, in which case the plaintext overwrites the record in place
 bool DTLS_Decrypt(NetworkAddress * sourceAddress, uint8_t * encrypted, int encryptedLength, uint8_t * decryptBuffer, int decryptBufferLength, int * decryptedLength, void *context);
 
 bool DTLS_Encrypt(NetworkAddress * destAddress, uint8_t * plainText, int plainTextLength, uint8_t * encryptedBuffer, int encryptedBufferLength, int * encryptedLength, void *context);
@@ -65,6 +82,27 @@ void DTLS_SetNetworkSendCallback(DTLS_NetworkSendCallback sendCallback);
 
 void DTLS_SetPSK(const char * identity, const uint8_t * key, int keyLength);
 
+// Run server handshake steps on numWorkers threads, so a burst of handshakes doesn't stall the caller's loop;
+// established sessions are still decrypted inline. 0 returns to running handshakes inline. Returns an eventfd
+// that is readable when DTLS_ProcessHandshakes() has work, or -1 if handshakes run inline.
+int DTLS_SetHandshakeWorkers(int numWorkers);
+
+// Send what finished handshake steps produced and start the next ones. Returns the number of records that
+// arrived during a handshake and are now waiting to be read through NetworkSocket_Read.
+int DTLS_ProcessHandshakes(void);
+
+// Take a record held back during its session's handshake, for the socket passed as the DTLS_Decrypt context
+bool DTLS_TakeDeferredRecord(void * context, NetworkAddress ** sourceAddress, uint8_t * buffer, int bufferLength, int * recordLength);
+
+// Accept only clients whose PSK identity is in keystore; while one is installed, servers no longer accept the
+// identity given to DTLS_SetPSK. The keystore must remain valid until replaced by another call; NULL removes it.
+void DTLS_SetPSKKeystore(const DTLS_PSKKeystore * keystore);
+
+// Bound the session table: at most maxSessions (0 for no limit), each dropped after idleTimeoutMs unused (0 to keep)
+void DTLS_SetSessionLimits(int maxSessions, int idleTimeoutMs);
+
+void DTLS_GetSessionStats(DTLS_SessionStats * stats);
+
 #ifdef __cplusplus
 }
 #endif
@@ -21,10 +21,13 @@
 ************************************************************************************************************************/
 
 #include <stdbool.h>
+#include <stdlib.h>
 #include <string.h>
 
 #include "lwm2m_debug.h"
+#include "lwm2m_util.h"
 #include "dtls_abstraction.h"
+#include "dtls_session_table.h"
 
 #ifndef CYASSL_DTLS
 #define CYASSL_DTLS
@@ -44,7 +47,7 @@
 
 typedef struct
 {
-    NetworkAddress * NetworkAddress;
+    DTLS_SessionTableEntry Entry;
     CYASSL * Session;
     CYASSL_CTX * Context;
     bool SessionEstablished;
@@ -54,13 +57,9 @@ typedef struct
     int BufferLength;
 }DTLS_Session;
 
-#ifndef MAX_DTLS_SESSIONS
-    #define MAX_DTLS_SESSIONS 3
-#endif
-
 const char * DTLS_LibraryName = "CyaSSL";
 
-static DTLS_Session sessions[MAX_DTLS_SESSIONS];
+static DTLS_SessionTable Sessions;
 
 static uint8_t * certificate = NULL;
 static int certificateLength = 0;
@@ -69,17 +68,20 @@ static AwaCertificateFormat certificateFormat;
 static const char * pskIdentity = NULL;
 static const uint8_t * pskKey = NULL;
 static int pskKeyLength = 0;
+static const DTLS_PSKKeystore * pskKeystore = NULL;
 
 static DTLS_NetworkSendCallback NetworkSend = NULL;
 
 static DTLS_Session * AllocateSession(NetworkAddress * address, bool client, void * context);
 static DTLS_Session * GetSession(NetworkAddress * address);
 static void FreeSession(DTLS_Session * session);
-static void SetupNewSession(int index, NetworkAddress * networkAddress, bool client);
+static void ReleaseSession(DTLS_SessionTableEntry * entry);
+static void SetupNewSession(DTLS_Session * session, NetworkAddress * networkAddress, bool client);
 static int DecryptCallBack(CYASSL *sslSessioon, char *recieveBuffer, int receiveBufferLegth, void *vp);
 static int EncryptCallBack(CYASSL *sslSessioon, char *sendBuffer, int sendBufferLength, void *vp);
 static unsigned int PSKCallBack(CYASSL *sslSession, const char* hint, char* identity, unsigned int id_max_len, unsigned char* key, unsigned int key_max_len);
 static unsigned int ServerPSKCallBack(WOLFSSL *sslSessioon, const char* identity, unsigned char* key, unsigned int key_max_len);
+static const uint8_t * FindServerPSK(const char * identity, size_t identityLength, size_t * keyLength);
 static int SSLSendCallBack(CYASSL *sslSessioon, char *sendBuffer, int sendBufferLength, void *vp);
 
 
@@ -145,7 +147,7 @@ void WOLFSSL_BUFFER(byte* buffer, word32 length)
 
 void DTLS_Init(void)
 {
-    memset(sessions,0,sizeof(DTLS_Session) * MAX_DTLS_SESSIONS);
+    DTLS_SessionTable_Init(&Sessions, MAX_DTLS_SESSIONS, DTLS_SESSION_IDLE_TIMEOUT_MS, ReleaseSession);
     CyaSSL_Init();
 #ifdef DEBUG_WOLFSSL
     CyaSSL_Debugging_ON();
@@ -156,14 +158,7 @@ void DTLS_Init(void)
 
 void DTLS_Shutdown(void)
 {
-    int index;
-    for (index = 0;index < MAX_DTLS_SESSIONS; index++)
-    {
-        if (sessions[index].Context)
-        {
-            FreeSession(&sessions[index]);
-        }
-    }
+    DTLS_SessionTable_Destroy(&Sessions);
     CyaSSL_Cleanup();
 }
 
@@ -202,6 +197,40 @@ void DTLS_SetPSK(const char * identity, const uint8_t * key, int keyLength)
     }
 }
 
+void DTLS_SetPSKKeystore(const DTLS_PSKKeystore * keystore)
+{
+    pskKeystore = keystore;
+}
+
+int DTLS_SetHandshakeWorkers(int numWorkers)
+{
+    if (numWorkers > 0)
+    {
+        Lwm2m_Warning("DTLS handshake workers are not supported with %s\n", DTLS_LibraryName);
+    }
+    return -1;
+}
+
+int DTLS_ProcessHandshakes(void)
+{
+    return 0;
+}
+
+bool DTLS_TakeDeferredRecord(void * context, NetworkAddress ** sourceAddress, uint8_t * buffer, int bufferLength, int * recordLength)
+{
+    return false;
+}
+
+void DTLS_SetSessionLimits(int maxSessions, int idleTimeoutMs)
+{
+    DTLS_SessionTable_SetLimits(&Sessions, maxSessions, idleTimeoutMs);
+}
+
+void DTLS_GetSessionStats(DTLS_SessionStats * stats)
+{
+    DTLS_SessionTable_GetStats(&Sessions, stats);
+}
+
 
 bool DTLS_Decrypt(NetworkAddress * sourceAddress, uint8_t * encrypted, int encryptedLength, uint8_t * decryptBuffer, int decryptBufferLength, int * decryptedLength, void *context)
 {
@@ -283,39 +312,55 @@ bool DTLS_Encrypt(NetworkAddress * destAddress, uint8_t * plainText, int plainTe
 
 static DTLS_Session * AllocateSession(NetworkAddress * address, bool client, void * context)
 {
-    DTLS_Session * result = NULL;
-    int index;
-    for (index = 0;index < MAX_DTLS_SESSIONS; index++)
+    DTLS_Session * session = malloc(sizeof(DTLS_Session));
+    if (session)
     {
-        if (!sessions[index].Context)
+        memset(session, 0, sizeof(DTLS_Session));
+        SetupNewSession(session, address, client);
+        if (!session->Session || (DTLS_SessionTable_Add(&Sessions, &session->Entry, address, Lwm2mCore_GetTickCountMs()) != 0))
+        {
+            ReleaseSession(&session->Entry);
+            session = NULL;
+        }
+        else
         {
-            SetupNewSession(index, address, client);
-            sessions[index].UserContext = context;
-            CyaSSL_SetIOSend(sessions[index].Context, SSLSendCallBack);
-            result = &sessions[index];
-            break;
+            session->UserContext = context;
+            CyaSSL_SetIOSend(session->Context, SSLSendCallBack);
         }
     }
-    return result;
+    if (!session)
+    {
+        Lwm2m_Error("Unable to allocate DTLS session\n");
+    }
+    return session;
 }
 
 static DTLS_Session * GetSession(NetworkAddress * address)
 {
     DTLS_Session * result = NULL;
-    int index;
-    for (index = 0;index < MAX_DTLS_SESSIONS; index++)
+    uint64_t now = Lwm2mCore_GetTickCountMs();
+    DTLS_SessionTable_Expire(&Sessions, now);
+    DTLS_SessionTableEntry * entry = DTLS_SessionTable_Find(&Sessions, address, now);
+    if (entry)
     {
-        if (NetworkAddress_Compare(sessions[index].NetworkAddress,address) == 0)
-        {
-            result = &sessions[index];
-            break;
-        }
+        result = DTLS_SessionEntry(entry, DTLS_Session, Entry);
     }
     return result;
 }
 
 static void FreeSession(DTLS_Session * session)
 {
+    if (session)
+    {
+        DTLS_SessionTable_Remove(&Sessions, &session->Entry);
+        ReleaseSession(&session->Entry);
+    }
+}
+
+// Release a session that is no longer in the session table
+static void ReleaseSession(DTLS_SessionTableEntry * entry)
+{
+    DTLS_Session * session = DTLS_SessionEntry(entry, DTLS_Session, Entry);
     if (session)
     {
         if (session->Session)
@@ -327,15 +372,14 @@ static void FreeSession(DTLS_Session * session)
         {
             CyaSSL_CTX_free(session->Context);
         }
-        memset(session,0, sizeof(DTLS_Session));
+        NetworkAddress_Free(&session->Entry.Address);
+        free(session);
     }
 }
 
 
-static void SetupNewSession(int index, NetworkAddress * networkAddress, bool client)
+static void SetupNewSession(DTLS_Session * session, NetworkAddress * networkAddress, bool client)
 {
-    DTLS_Session * session = &sessions[index];
-    session->NetworkAddress = networkAddress;
     session->Client = client;
     if (client)
         session->Context =  CyaSSL_CTX_new(CyaDTLSv1_2_client_method());
@@ -372,21 +416,23 @@ static void SetupNewSession(int index, NetworkAddress * networkAddress, bool cli
             CyaSSL_CTX_use_certificate_buffer(session->Context, certificatePart, certificatePartLength, format);
             CyaSSL_CTX_use_PrivateKey_buffer(session->Context, privateKey, privateKeyLength, format);
         }
-        if (pskIdentity)
+        bool usePSK = pskIdentity || (pskKeystore && !client);
+        if (usePSK)
         {
             if (client)
                 CyaSSL_CTX_set_psk_client_callback(session->Context, PSKCallBack);
             else
             {
                 CyaSSL_CTX_set_psk_server_callback(session->Context, ServerPSKCallBack);
-                CyaSSL_CTX_use_psk_identity_hint(session->Context, pskIdentity);
+                if (pskIdentity)
+                    CyaSSL_CTX_use_psk_identity_hint(session->Context, pskIdentity);
             }
         }
-        if (certificate &&  pskIdentity)
+        if (certificate &&  usePSK)
             CyaSSL_CTX_set_cipher_list(session->Context, CERTCIPHERSUITES ":" PSKCIPHERSUITES );
         else if (certificate)
             CyaSSL_CTX_set_cipher_list(session->Context, CERTCIPHERSUITES);
-        else if (pskIdentity)
+        else if (usePSK)
             CyaSSL_CTX_set_cipher_list(session->Context, PSKCIPHERSUITES);
 //        if (caCertificate)
 //        {
@@ -399,7 +445,9 @@ static void SetupNewSession(int index, NetworkAddress * networkAddress, bool cli
         if (session->Session)
         {
             CyaSSL_dtls_set_peer(session->Session, networkAddress, sizeof(struct sockaddr_storage));
-            CyaSSL_set_fd(session->Session, index);
+            // the I/O callbacks find their session through the I/O context rather than a socket
+            CyaSSL_SetIOReadCtx(session->Session, session);
+            CyaSSL_SetIOWriteCtx(session->Session, session);
             CyaSSL_set_using_nonblock(session->Session, 1);
             CyaSSL_SetIORecv(session->Context, DecryptCallBack);
         }
@@ -410,8 +458,7 @@ static void SetupNewSession(int index, NetworkAddress * networkAddress, bool cli
 static int DecryptCallBack(CYASSL *sslSessioon, char *recieveBuffer, int receiveBufferLegth, void *vp)
 {
     int result;
-    int index = CyaSSL_get_fd(sslSessioon);
-    DTLS_Session * session = &sessions[index];
+    DTLS_Session * session = (DTLS_Session *)vp;
     if (session->BufferLength > 0)
     {
         if (receiveBufferLegth < session->BufferLength)
@@ -436,8 +483,7 @@ static int DecryptCallBack(CYASSL *sslSessioon, char *recieveBuffer, int receive
 static int EncryptCallBack(CYASSL *sslSessioon, char *sendBuffer, int sendBufferLength, void *vp)
 {
     int result;
-    int index = CyaSSL_get_fd(sslSessioon);
-    DTLS_Session * session = &sessions[index];
+    DTLS_Session * session = (DTLS_Session *)vp;
     if (session->BufferLength > 0)
     {
         if (sendBufferLength < session->BufferLength)
@@ -461,8 +507,37 @@ static int EncryptCallBack(CYASSL *sslSessioon, char *sendBuffer, int sendBuffer
 
 static unsigned int ServerPSKCallBack(WOLFSSL *sslSessioon, const char* identity, unsigned char* key, unsigned int key_max_len)
 {
-    memcpy(key, pskKey, pskKeyLength);
-    return pskKeyLength;
+    (void)sslSessioon;
+    unsigned int result = 0;
+    size_t keyLength;
+    const uint8_t * keyData = FindServerPSK(identity, strlen(identity), &keyLength);
+    if (!keyData)
+    {
+        Lwm2m_Warning("Unknown PSK identity: %s\n", identity);
+    }
+    else if (keyLength <= key_max_len)
+    {
+        memcpy(key, keyData, keyLength);
+        result = keyLength;
+    }
+    return result;
+}
+
+// Without a keystore every client is offered the single configured key, as before. With one, only identities
+// it holds are accepted: the configured identity is typically the well-known default and must not bypass it.
+static const uint8_t * FindServerPSK(const char * identity, size_t identityLength, size_t * keyLength)
+{
+    const uint8_t * result = NULL;
+    if (pskKeystore)
+    {
+        result = DTLS_PSKKeystore_Find(pskKeystore, identity, identityLength, keyLength);
+    }
+    else if (pskIdentity)
+    {
+        result = pskKey;
+        *keyLength = pskKeyLength;
+    }
+    return result;
 }
 
 static unsigned int PSKCallBack(CYASSL *sslSession, const char* hint, char* identity, unsigned int id_max_len, unsigned char* key, unsigned int key_max_len)
@@ -478,11 +553,10 @@ static unsigned int PSKCallBack(CYASSL *sslSession, const char* hint, char* iden
 static int SSLSendCallBack(CYASSL *sslSessioon, char *sendBuffer, int sendBufferLength, void *vp)
 {
     int result;
-    int index = CyaSSL_get_fd(sslSessioon);
-    DTLS_Session * session = &sessions[index];
+    DTLS_Session * session = (DTLS_Session *)vp;
     if (NetworkSend)
     {
-        NetworkTransmissionError error = NetworkSend(session->NetworkAddress, sendBuffer, sendBufferLength, session->UserContext);
+        NetworkTransmissionError error = NetworkSend(session->Entry.Address, sendBuffer, sendBufferLength, session->UserContext);
         switch(error)
         {
             case NetworkTransmissionError_None:
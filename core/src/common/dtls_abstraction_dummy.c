@@ -60,6 +60,42 @@ void DTLS_SetPSK(const char * identity, const uint8_t * key, int keyLength)
 	(void)keyLength;
 }
 
+void DTLS_SetPSKKeystore(const DTLS_PSKKeystore * keystore)
+{
+	(void)keystore;
+}
+
+int DTLS_SetHandshakeWorkers(int numWorkers)
+{
+	(void)numWorkers;
+	return -1;
+}
+
+int DTLS_ProcessHandshakes(void)
+{
+	return 0;
+}
+
+bool DTLS_TakeDeferredRecord(void * context, NetworkAddress ** sourceAddress, uint8_t * buffer, int bufferLength, int * recordLength)
+{
+	(void)context;
+	(void)sourceAddress;
+	(void)buffer;
+	(void)bufferLength;
+	(void)recordLength;
+	return false;
+}
+
+void DTLS_SetSessionLimits(int maxSessions, int idleTimeoutMs)
+{
+	(void)maxSessions;
+	(void)idleTimeoutMs;
+}
+
+void DTLS_GetSessionStats(DTLS_SessionStats * stats)
+{
+	memset(stats, 0, sizeof(*stats));
+}
 
 bool DTLS_Decrypt(NetworkAddress * sourceAddress, uint8_t * encrypted, int encryptedLength, uint8_t * decryptBuffer, int decryptBufferLength, int * decryptedLength, void *context)
 {
@@ -21,10 +21,14 @@
 ************************************************************************************************************************/
 
 #include <stdbool.h>
+#include <stdlib.h>
 #include <string.h>
 
 #include "lwm2m_debug.h"
+#include "lwm2m_util.h"
 #include "dtls_abstraction.h"
+#include "dtls_session_table.h"
+#include "dtls_handshake_pool.h"
 
 #include <errno.h>
 
@@ -47,23 +51,29 @@ typedef enum
 
 typedef struct
 {
-    NetworkAddress * NetworkAddress;
+    DTLS_SessionTableEntry Entry;
     gnutls_session_t Session;
     void * Credentials;
     uint8_t CredentialType;
+    bool Client;
     bool SessionEstablished;
     void * UserContext;
     uint8_t * Buffer;
     int BufferLength;
+    bool Busy;                          // a handshake step is running on a worker thread
+    bool Released;                      // dropped from the session table while busy, freed once the step completes
+    DTLS_HandshakeJob * Job;            // step in progress, collecting the datagrams it sends
+    struct ListHead Deferred;           // records received while busy, as unsubmitted jobs
+    int NumDeferred;
+    struct ListHead ReadyNode;          // on ReadySessions while established with deferred records to read
 }DTLS_Session;
 
-#ifndef MAX_DTLS_SESSIONS
-    #define MAX_DTLS_SESSIONS 3
-#endif
+// Records held per session while a handshake step runs on a worker; a flight rarely needs more than one
+#define MAX_DEFERRED_RECORDS (8)
 
 const char * DTLS_LibraryName = "GnuTLS";
 
-static DTLS_Session sessions[MAX_DTLS_SESSIONS];
+static DTLS_SessionTable Sessions;
 
 static uint8_t * certificate = NULL;
 static int certificateLength = 0;
@@ -73,22 +83,41 @@ static const char * pskIdentity = NULL;
 
 static  gnutls_datum_t pskKey;
 
+static const DTLS_PSKKeystore * pskKeystore = NULL;
+
+// Handshake workers read the PSK keystore, so it is only swapped while they are kept out
+static pthread_mutex_t pskLock = PTHREAD_MUTEX_INITIALIZER;
+
+static DTLS_HandshakePool HandshakePool;
+static struct ListHead ReadySessions = LIST_INIT(ReadySessions);
+
 static  DTLS_NetworkSendCallback NetworkSend = NULL;
 
 //Comment out as init of DH params takes a while
 //static gnutls_dh_params_t _DHParameters;
 static gnutls_priority_t _PriorityCache;
 static gnutls_certificate_credentials_t _CertCredentials = NULL;
+// Key protecting the session tickets this server issues, so returning clients can resume without a full handshake
+static gnutls_datum_t _TicketKey;
 
 
 static DTLS_Session * GetSession(NetworkAddress * address);
-static void SetupNewSession(int index, NetworkAddress * networkAddress, bool client);
+static DTLS_Session * NewSession(NetworkAddress * networkAddress, bool client);
+static void SetupNewSession(DTLS_Session * session, bool client);
+static bool Handshake(DTLS_Session * session);
 static void FreeSession(DTLS_Session * session);
+static void ReleaseSession(DTLS_SessionTableEntry * entry);
 static ssize_t DecryptCallBack(gnutls_transport_ptr_t context, void *recieveBuffer, size_t receiveBufferLegth);
 static ssize_t EncryptCallBack(gnutls_transport_ptr_t context, const void * sendBuffer,size_t sendBufferLength);
 static int PSKClientCallBack(gnutls_session_t session, char **username, gnutls_datum_t * key);
 static int PSKCallBack(gnutls_session_t session, const char *username, gnutls_datum_t * key);
+static const uint8_t * FindServerPSK(const char * identity, size_t identityLength, size_t * keyLength);
 static ssize_t SSLSendCallBack(gnutls_transport_ptr_t context, const void * sendBuffer,size_t sendBufferLength);
+static ssize_t DeferredSendCallBack(gnutls_transport_ptr_t context, const void * sendBuffer, size_t sendBufferLength);
+static void OffloadHandshake(DTLS_Session * session, const uint8_t * record, int recordLength);
+static void StartHandshakeStep(DTLS_Session * session, DTLS_HandshakeJob * job);
+static void RunHandshakeStep(DTLS_HandshakeJob * job);
+static void CompleteHandshakeStep(DTLS_Session * session, DTLS_HandshakeJob * job);
 #if GNUTLS_VERSION_MAJOR >= 3
 static int ReceiveTimeout(gnutls_transport_ptr_t context, unsigned int ms);
 static int CertificateVerify(gnutls_session_t session);
@@ -98,8 +127,13 @@ static int CertificateVerify(gnutls_session_t session);
 
 void DTLS_Init(void)
 {
-    memset(sessions,0,sizeof(DTLS_Session) * MAX_DTLS_SESSIONS);
+    DTLS_SessionTable_Init(&Sessions, MAX_DTLS_SESSIONS, DTLS_SESSION_IDLE_TIMEOUT_MS, ReleaseSession);
     gnutls_global_init();
+    if (gnutls_session_ticket_key_generate(&_TicketKey) != GNUTLS_E_SUCCESS)
+    {
+        Lwm2m_Warning("Unable to generate DTLS session ticket key, session resumption disabled\n");
+        _TicketKey.data = NULL;
+    }
     //    unsigned int bits = gnutls_sec_param_to_pk_bits(GNUTLS_PK_DH, GNUTLS_SEC_PARAM_LEGACY);
     //    gnutls_dh_params_init(&_DHParameters);
     //    gnutls_dh_params_generate2(_DHParameters, bits);
@@ -112,20 +146,20 @@ void DTLS_Init(void)
 
 void DTLS_Shutdown(void)
 {
-    int index;
-    for (index = 0;index < MAX_DTLS_SESSIONS; index++)
-    {
-        if (sessions[index].Session)
-        {
-            FreeSession(&sessions[index]);
-        }
-    }
+    DTLS_SetHandshakeWorkers(0);
+    DTLS_SessionTable_Destroy(&Sessions);
     if (_CertCredentials)
     {
         gnutls_certificate_free_credentials(_CertCredentials);
         _CertCredentials = NULL;
     }
 //  gnutls_dh_params_deinit(_DHParameters);
+    if (_TicketKey.data)
+    {
+        gnutls_memset(_TicketKey.data, 0, _TicketKey.size);
+        gnutls_free(_TicketKey.data);
+        _TicketKey.data = NULL;
+    }
     gnutls_priority_deinit(_PriorityCache);
     gnutls_global_deinit();
 }
@@ -164,12 +198,103 @@ void DTLS_SetPSK(const char * identity, const uint8_t * key, int keyLength)
     }
 }
 
+void DTLS_SetPSKKeystore(const DTLS_PSKKeystore * keystore)
+{
+    pthread_mutex_lock(&pskLock);
+    pskKeystore = keystore;
+    pthread_mutex_unlock(&pskLock);
+}
+
+int DTLS_SetHandshakeWorkers(int numWorkers)
+{
+    DTLS_HandshakePool_Stop(&HandshakePool);
+    DTLS_ProcessHandshakes();
+    if ((numWorkers > 0) && (DTLS_HandshakePool_Start(&HandshakePool, numWorkers, RunHandshakeStep) != 0))
+    {
+        Lwm2m_Warning("Running DTLS handshakes in the main loop\n");
+    }
+    return DTLS_HandshakePool_GetEventFd(&HandshakePool);
+}
+
+int DTLS_ProcessHandshakes(void)
+{
+    DTLS_HandshakeJob * job;
+    while ((job = DTLS_HandshakePool_TakeCompleted(&HandshakePool)) != NULL)
+    {
+        DTLS_Session * session = (DTLS_Session *)job->Session;
+        session->Busy = false;
+        if (session->Released)
+        {
+            ReleaseSession(&session->Entry);
+        }
+        else
+        {
+            CompleteHandshakeStep(session, job);
+        }
+        DTLS_HandshakeJob_Free(&job);
+    }
+
+    int waiting = 0;
+    struct ListHead * item;
+    ListForEach(item, &ReadySessions)
+    {
+        DTLS_Session * session = ListEntry(item, DTLS_Session, ReadyNode);
+        waiting += session->NumDeferred;
+    }
+    return waiting;
+}
+
+bool DTLS_TakeDeferredRecord(void * context, NetworkAddress ** sourceAddress, uint8_t * buffer, int bufferLength, int * recordLength)
+{
+    bool result = false;
+    struct ListHead * item;
+    ListForEach(item, &ReadySessions)
+    {
+        DTLS_Session * session = ListEntry(item, DTLS_Session, ReadyNode);
+        if (session->UserContext == context)
+        {
+            DTLS_HandshakeJob * record = ListEntry(session->Deferred.Next, DTLS_HandshakeJob, List);
+            ListRemove(&record->List);
+            session->NumDeferred--;
+            if (session->NumDeferred == 0)
+            {
+                ListRemove(&session->ReadyNode);
+            }
+            if (record->RecordLength <= bufferLength)
+            {
+                memcpy(buffer, record->Record, record->RecordLength);
+                *recordLength = record->RecordLength;
+                *sourceAddress = session->Entry.Address;
+                result = true;
+            }
+            DTLS_HandshakeJob_Free(&record);
+            break;
+        }
+    }
+    return result;
+}
+
+void DTLS_SetSessionLimits(int maxSessions, int idleTimeoutMs)
+{
+    DTLS_SessionTable_SetLimits(&Sessions, maxSessions, idleTimeoutMs);
+}
+
+void DTLS_GetSessionStats(DTLS_SessionStats * stats)
+{
+    DTLS_SessionTable_GetStats(&Sessions, stats);
+}
+
 
 bool DTLS_Decrypt(NetworkAddress * sourceAddress, uint8_t * encrypted, int encryptedLength, uint8_t * decryptBuffer, int decryptBufferLength, int * decryptedLength, void *context)
 {
     bool result = false;
     DTLS_Session * session = GetSession(sourceAddress);
-    if (session)
+    if (session && (session->Busy || (!session->SessionEstablished && !session->Client && DTLS_HandshakePool_IsRunning(&HandshakePool))))
+    {
+        *decryptedLength = 0;
+        OffloadHandshake(session, encrypted, encryptedLength);
+    }
+    else if (session)
     {
         session->Buffer = encrypted;
         session->BufferLength = encryptedLength;
@@ -186,7 +311,7 @@ bool DTLS_Decrypt(NetworkAddress * sourceAddress, uint8_t * encrypted, int encry
         else
         {
             *decryptedLength = 0;
-            session->SessionEstablished = (gnutls_handshake(session->Session) == GNUTLS_E_SUCCESS);
+            session->SessionEstablished = Handshake(session);
             if (session->SessionEstablished)
                 Lwm2m_Info("Session established");
         }
@@ -194,18 +319,21 @@ bool DTLS_Decrypt(NetworkAddress * sourceAddress, uint8_t * encrypted, int encry
 
     if (!session)
     {
-        int index;
-        for (index = 0;index < MAX_DTLS_SESSIONS; index++)
+        session = NewSession(sourceAddress, false);
+        if (session)
         {
-            if (!sessions[index].Session)
+            session->UserContext = context;
+            gnutls_transport_set_push_function(session->Session, SSLSendCallBack);
+            if (DTLS_HandshakePool_IsRunning(&HandshakePool))
             {
-                SetupNewSession(index, sourceAddress, false);
-                sessions[index].UserContext = context;
-                gnutls_transport_set_push_function(sessions[index].Session, SSLSendCallBack);
-                sessions[index].Buffer = encrypted;
-                sessions[index].BufferLength = encryptedLength;
-                sessions[index].SessionEstablished = (gnutls_handshake(sessions[index].Session) == GNUTLS_E_SUCCESS);
-                break;
+                *decryptedLength = 0;
+                OffloadHandshake(session, encrypted, encryptedLength);
+            }
+            else
+            {
+                session->Buffer = encrypted;
+                session->BufferLength = encryptedLength;
+                session->SessionEstablished = Handshake(session);
             }
         }
     }
@@ -216,7 +344,11 @@ bool DTLS_Encrypt(NetworkAddress * destAddress, uint8_t * plainText, int plainTe
 {
     bool result = false;
     DTLS_Session * session = GetSession(destAddress);
-    if (session)
+    if (session && session->Busy)
+    {
+        // still handshaking on a worker thread
+    }
+    else if (session)
     {
         if (session->SessionEstablished)
         {
@@ -234,24 +366,19 @@ bool DTLS_Encrypt(NetworkAddress * destAddress, uint8_t * plainText, int plainTe
         {
             session->UserContext = context;
             gnutls_transport_set_push_function(session->Session, SSLSendCallBack);
-            session->SessionEstablished = (gnutls_handshake(session->Session) == GNUTLS_E_SUCCESS);
+            session->SessionEstablished = Handshake(session);
             if (session->SessionEstablished)
                 Lwm2m_Info("DTLS Session established\n");
         }
     }
     else
     {
-        int index;
-        for (index = 0;index < MAX_DTLS_SESSIONS; index++)
+        session = NewSession(destAddress, true);
+        if (session)
         {
-            if (!sessions[index].Session)
-            {
-                SetupNewSession(index, destAddress, true);
-                sessions[index].UserContext = context;
-                gnutls_transport_set_push_function(sessions[index].Session, SSLSendCallBack);
-                sessions[index].SessionEstablished = (gnutls_handshake(sessions[index].Session) == GNUTLS_E_SUCCESS);
-                break;
-            }
+            session->UserContext = context;
+            gnutls_transport_set_push_function(session->Session, SSLSendCallBack);
+            session->SessionEstablished = Handshake(session);
         }
     }
     return result;
@@ -260,23 +387,52 @@ bool DTLS_Encrypt(NetworkAddress * destAddress, uint8_t * plainText, int plainTe
 static DTLS_Session * GetSession(NetworkAddress * address)
 {
     DTLS_Session * result = NULL;
-    int index;
-    for (index = 0;index < MAX_DTLS_SESSIONS; index++)
+    uint64_t now = Lwm2mCore_GetTickCountMs();
+    DTLS_SessionTable_Expire(&Sessions, now);
+    DTLS_SessionTableEntry * entry = DTLS_SessionTable_Find(&Sessions, address, now);
+    if (entry)
     {
-        if (NetworkAddress_Compare(sessions[index].NetworkAddress,address) == 0)
+        result = DTLS_SessionEntry(entry, DTLS_Session, Entry);
+    }
+    return result;
+}
+
+static DTLS_Session * NewSession(NetworkAddress * networkAddress, bool client)
+{
+    DTLS_Session * session = malloc(sizeof(DTLS_Session));
+    if (session)
+    {
+        memset(session, 0, sizeof(DTLS_Session));
+        ListInit(&session->Deferred);
+        ListInit(&session->ReadyNode);
+        SetupNewSession(session, client);
+        if (!session->Session || (DTLS_SessionTable_Add(&Sessions, &session->Entry, networkAddress, Lwm2mCore_GetTickCountMs()) != 0))
         {
-            result = &sessions[index];
-            break;
+            ReleaseSession(&session->Entry);
+            session = NULL;
+        }
+        else if (client)
+        {
+            size_t resumptionLength;
+            void * resumption = DTLS_SessionTable_TakeResumption(&Sessions, networkAddress, &resumptionLength);
+            if (resumption)
+            {
+                gnutls_session_set_data(session->Session, resumption, resumptionLength);
+                free(resumption);
+            }
         }
     }
-    return result;
+    if (!session)
+    {
+        Lwm2m_Error("Unable to allocate DTLS session\n");
+    }
+    return session;
 }
 
-static void SetupNewSession(int index, NetworkAddress * networkAddress, bool client)
+static void SetupNewSession(DTLS_Session * session, bool client)
 {
-    DTLS_Session * session = &sessions[index];
-    session->NetworkAddress = networkAddress;
     unsigned int flags;
+    session->Client = client;
 #if GNUTLS_VERSION_MAJOR >= 3
     if (client)
         flags = GNUTLS_CLIENT | GNUTLS_DATAGRAM | GNUTLS_NONBLOCK;
@@ -328,11 +484,11 @@ static void SetupNewSession(int index, NetworkAddress * networkAddress, bool cli
                 gnutls_credentials_set(session->Session, GNUTLS_CRD_CERTIFICATE, _CertCredentials);
             }
         }
-        if (pskIdentity)
+        if (pskIdentity || pskKeystore)
         {
             if (client)
             {
-                if (!certificate)
+                if (pskIdentity && !certificate)
                 {
                     gnutls_psk_client_credentials_t credentials;
                     if (gnutls_psk_allocate_client_credentials(&credentials) == GNUTLS_E_SUCCESS)
@@ -370,6 +526,10 @@ static void SetupNewSession(int index, NetworkAddress * networkAddress, bool cli
         if (!client)
         {
             gnutls_certificate_server_set_request(session->Session, GNUTLS_CERT_REQUEST); // GNUTLS_CERT_IGNORE  Don't require Client Cert
+            if (_TicketKey.data)
+            {
+                gnutls_session_ticket_enable_server(session->Session, &_TicketKey);
+            }
         }
 
 #if GNUTLS_VERSION_MAJOR >= 3
@@ -378,8 +538,137 @@ static void SetupNewSession(int index, NetworkAddress * networkAddress, bool cli
     }
 }
 
+static bool Handshake(DTLS_Session * session)
+{
+    bool established = (gnutls_handshake(session->Session) == GNUTLS_E_SUCCESS);
+    if (established && gnutls_session_is_resumed(session->Session))
+    {
+        DTLS_SessionTable_CountResumption(&Sessions);
+    }
+    return established;
+}
+
+// Hand a handshake record to the worker pool, or hold it until the session's current step completes
+static void OffloadHandshake(DTLS_Session * session, const uint8_t * record, int recordLength)
+{
+    if (session->Busy && (session->NumDeferred >= MAX_DEFERRED_RECORDS))
+    {
+        Lwm2m_Debug("DTLS session busy, dropping record\n");
+        return;
+    }
+    DTLS_HandshakeJob * job = DTLS_HandshakeJob_New(session, record, recordLength);
+    if (!job)
+    {
+        Lwm2m_Error("Unable to allocate DTLS handshake job\n");
+    }
+    else if (session->Busy)
+    {
+        ListAdd(&job->List, &session->Deferred);
+        session->NumDeferred++;
+    }
+    else
+    {
+        StartHandshakeStep(session, job);
+    }
+}
+
+static void StartHandshakeStep(DTLS_Session * session, DTLS_HandshakeJob * job)
+{
+    if (DTLS_HandshakePool_Submit(&HandshakePool, job) == 0)
+    {
+        session->Busy = true;
+    }
+    else
+    {
+        // the peer retransmits its flight, by which time the backlog may have cleared
+        Lwm2m_Debug("DTLS handshake queue full, dropping record\n");
+        DTLS_HandshakeJob_Free(&job);
+    }
+}
+
+// Runs on a worker thread. The main loop leaves a busy session alone, and output is kept for it to send.
+static void RunHandshakeStep(DTLS_HandshakeJob * job)
+{
+    DTLS_Session * session = (DTLS_Session *)job->Session;
+    session->Job = job;
+    session->Buffer = job->Record;
+    session->BufferLength = job->RecordLength;
+    gnutls_transport_set_push_function(session->Session, DeferredSendCallBack);
+    job->Result = gnutls_handshake(session->Session);
+    gnutls_transport_set_push_function(session->Session, SSLSendCallBack);
+    session->Job = NULL;
+}
+
+static void CompleteHandshakeStep(DTLS_Session * session, DTLS_HandshakeJob * job)
+{
+    struct ListHead * item;
+    ListForEach(item, &job->Output)
+    {
+        DTLS_HandshakeOutput * output = ListEntry(item, DTLS_HandshakeOutput, List);
+        SSLSendCallBack(session, output->Data, output->Length);
+    }
+    if (job->Run && (job->Result == GNUTLS_E_SUCCESS))
+    {
+        session->SessionEstablished = true;
+        if (gnutls_session_is_resumed(session->Session))
+        {
+            DTLS_SessionTable_CountResumption(&Sessions);
+        }
+        Lwm2m_Info("Session established\n");
+    }
+
+    if (session->NumDeferred > 0)
+    {
+        if (session->SessionEstablished)
+        {
+            // application data that followed the handshake, to be read through the network layer
+            if (session->ReadyNode.Next == &session->ReadyNode)
+            {
+                ListAdd(&session->ReadyNode, &ReadySessions);
+            }
+        }
+        else
+        {
+            DTLS_HandshakeJob * next = ListEntry(session->Deferred.Next, DTLS_HandshakeJob, List);
+            ListRemove(&next->List);
+            session->NumDeferred--;
+            StartHandshakeStep(session, next);
+        }
+    }
+}
+
 static void FreeSession(DTLS_Session * session)
 {
+    DTLS_SessionTable_Remove(&Sessions, &session->Entry);
+    ReleaseSession(&session->Entry);
+}
+
+// Release a session that is no longer in the session table
+static void ReleaseSession(DTLS_SessionTableEntry * entry)
+{
+    DTLS_Session * session = DTLS_SessionEntry(entry, DTLS_Session, Entry);
+    if (session->Busy)
+    {
+        // a worker still owns it; DTLS_ProcessHandshakes releases it when the step completes
+        session->Released = true;
+        return;
+    }
+    while (session->Deferred.Next != &session->Deferred)
+    {
+        DTLS_HandshakeJob * record = ListEntry(session->Deferred.Next, DTLS_HandshakeJob, List);
+        ListRemove(&record->List);
+        DTLS_HandshakeJob_Free(&record);
+    }
+    ListRemove(&session->ReadyNode);
+    if (session->Client && session->SessionEstablished)
+    {
+        gnutls_datum_t resumption;
+        if (gnutls_session_get_data2(session->Session, &resumption) == GNUTLS_E_SUCCESS)
+        {
+            DTLS_SessionTable_SaveResumption(&Sessions, session->Entry.Address, resumption.data, resumption.size);
+            gnutls_free(resumption.data);
+        }
+    }
     if (session->Credentials)
     {
         if (session->CredentialType == CredentialType_ClientPSK)
@@ -388,9 +677,12 @@ static void FreeSession(DTLS_Session * session)
             gnutls_psk_free_server_credentials(session->Credentials);
 
     }
-    gnutls_deinit(session->Session);
-    memset(session,0, sizeof(DTLS_Session));
-
+    if (session->Session)
+    {
+        gnutls_deinit(session->Session);
+    }
+    NetworkAddress_Free(&session->Entry.Address);
+    free(session);
 }
 
 #if GNUTLS_VERSION_MAJOR >= 3
@@ -467,11 +759,40 @@ static int PSKClientCallBack(gnutls_session_t session, char **username, gnutls_d
 static int PSKCallBack(gnutls_session_t session, const char *username, gnutls_datum_t * key)
 {
     (void)session;
-    (void)username;
-    key->data = gnutls_malloc(pskKey.size);
-    key->size = pskKey.size;
-    memcpy(key->data, pskKey.data, pskKey.size);
-    return 0;
+    int result = -1;
+    size_t keyLength;
+    pthread_mutex_lock(&pskLock);
+    const uint8_t * keyData = FindServerPSK(username, strlen(username), &keyLength);
+    if (keyData)
+    {
+        key->data = gnutls_malloc(keyLength);
+        key->size = keyLength;
+        memcpy(key->data, keyData, keyLength);
+        result = 0;
+    }
+    pthread_mutex_unlock(&pskLock);
+    if (result != 0)
+    {
+        Lwm2m_Warning("Unknown PSK identity: %s\n", username);
+    }
+    return result;
+}
+
+// Without a keystore every client is offered the single configured key, as before. With one, only identities
+// it holds are accepted: the configured identity is typically the well-known default and must not bypass it.
+static const uint8_t * FindServerPSK(const char * identity, size_t identityLength, size_t * keyLength)
+{
+    const uint8_t * result = NULL;
+    if (pskKeystore)
+    {
+        result = DTLS_PSKKeystore_Find(pskKeystore, identity, identityLength, keyLength);
+    }
+    else if (pskIdentity)
+    {
+        result = pskKey.data;
+        *keyLength = pskKey.size;
+    }
+    return result;
 }
 
 #if GNUTLS_VERSION_MAJOR >= 3
@@ -497,13 +818,24 @@ static int ReceiveTimeout(gnutls_transport_ptr_t context, unsigned int ms)
 }
 #endif
 
+static ssize_t DeferredSendCallBack(gnutls_transport_ptr_t context, const void * sendBuffer, size_t sendBufferLength)
+{
+    DTLS_Session * session = (DTLS_Session *)context;
+    if (DTLS_HandshakeJob_AddOutput(session->Job, sendBuffer, sendBufferLength) != 0)
+    {
+        errno = ENOMEM;
+        return -1;
+    }
+    return sendBufferLength;
+}
+
 static ssize_t SSLSendCallBack(gnutls_transport_ptr_t context, const void * sendBuffer,size_t sendBufferLength)
 {
     ssize_t result;
     DTLS_Session * session = (DTLS_Session *)context;
     if (NetworkSend)
     {
-        NetworkTransmissionError error = NetworkSend(session->NetworkAddress, sendBuffer, sendBufferLength, session->UserContext);
+        NetworkTransmissionError error = NetworkSend(session->Entry.Address, sendBuffer, sendBufferLength, session->UserContext);
         if (error == NetworkTransmissionError_None)
             result = sendBufferLength;
         else
@@ -21,10 +21,13 @@
 ************************************************************************************************************************/
 
 #include <stdbool.h>
+#include <stdlib.h>
 #include <string.h>
 
 #include "lwm2m_debug.h"
+#include "lwm2m_util.h"
 #include "dtls_abstraction.h"
+#include "dtls_session_table.h"
 
 #include <errno.h>
 #include <stdio.h>
@@ -43,26 +46,55 @@
 #include "mbedtls/timing.h"
 #include "mbedtls/pk.h"
 #include "mbedtls/ssl_cookie.h"
+#include "mbedtls/version.h"
+
+// Session tickets, client resumption and connection IDs have not yet been built and run against a real mbedTLS,
+// so they stay off unless configured with WITH_MBEDTLS_SESSION_REUSE
+#if defined(DTLS_MBEDTLS_SESSION_REUSE)
+
+#if defined(MBEDTLS_SSL_TICKET_C)
+#define DTLS_SESSION_TICKETS
+#include "mbedtls/ssl_ticket.h"
+#endif
+
+// Session data can only be carried between client sessions by mbedTLS 2.19 onwards
+#if defined(MBEDTLS_SSL_CLI_C) && (MBEDTLS_VERSION_NUMBER >= 0x02130000)
+#define DTLS_CLIENT_RESUMPTION
+#endif
+
+#if defined(MBEDTLS_SSL_DTLS_CONNECTION_ID)
+#define DTLS_CONNECTION_ID
+#endif
+
+#endif
+
+#if defined(DTLS_CONNECTION_ID)
+// Length of the connection ID a server session asks its client to put in every record (RFC 9146)
+#ifndef DTLS_CONNECTION_ID_LENGTH
+#define DTLS_CONNECTION_ID_LENGTH (4)
+#endif
+#endif
+
+#ifndef DTLS_SESSION_TICKET_LIFETIME_S
+#define DTLS_SESSION_TICKET_LIFETIME_S (86400)
+#endif
 
 typedef struct
 {
-    NetworkAddress * NetworkAddress;
+    DTLS_SessionTableEntry Entry;
     mbedtls_ssl_context Context;
     mbedtls_ssl_config Config;
     bool InUse;
+    bool Client;
     bool SessionEstablished;
     void * UserContext;
     uint8_t * Buffer;
     int BufferLength;
 } DTLS_Session;
 
-#ifndef MAX_DTLS_SESSIONS
-    #define MAX_DTLS_SESSIONS 3
-#endif
-
 const char * DTLS_LibraryName = "mbedTLS";
 
-static DTLS_Session sessions[MAX_DTLS_SESSIONS];
+static DTLS_SessionTable Sessions;
 
 static uint8_t * certificate = NULL;
 static int certificateLength = 0;
@@ -71,17 +103,29 @@ static AwaCertificateFormat certificateFormat;
 static const char * pskIdentity = NULL;
 static const uint8_t * pskKey = NULL;
 static int pskKeyLength = 0;
+static const DTLS_PSKKeystore * pskKeystore = NULL;
 
 static DTLS_NetworkSendCallback NetworkSend = NULL;
 
 static int supportedCipherSuites[6];
 
 static DTLS_Session * GetSession(NetworkAddress * address);
-static void SetupNewSession(int index, NetworkAddress * networkAddress, bool client);
+static DTLS_Session * NewSession(NetworkAddress * networkAddress, bool client);
+static void SetupNewSession(DTLS_Session * session, bool client);
 static void FreeSession(DTLS_Session * session);
+static void ReleaseSession(DTLS_SessionTableEntry * entry);
+#if defined(DTLS_CLIENT_RESUMPTION)
+static void SaveResumption(DTLS_Session * session);
+static void LoadResumption(DTLS_Session * session, NetworkAddress * networkAddress);
+#endif
+#if defined(DTLS_CONNECTION_ID)
+static void AssignConnectionId(DTLS_Session * session);
+static DTLS_Session * GetSessionByConnectionId(uint8_t * encrypted, int encryptedLength);
+#endif
 static int DecryptCallBack(void * context, unsigned char * recieveBuffer, size_t receiveBufferLegth);
 static int EncryptCallBack(void * context, const unsigned char * sendBuffer,size_t sendBufferLength);
 static int PSKCallBack(void * parameter, mbedtls_ssl_context * context, const unsigned char * identity, size_t identityLength);
+static const uint8_t * FindServerPSK(const char * identity, size_t identityLength, size_t * keyLength);
 static int SSLSendCallBack(void * context, const unsigned char * sendBuffer, size_t sendBufferLength);
 
 
@@ -91,13 +135,17 @@ static mbedtls_timing_delay_context timer;
 static mbedtls_x509_crt cacert;
 static mbedtls_pk_context privateKey;
 static mbedtls_ssl_cookie_ctx cookie_context;
+#if defined(DTLS_SESSION_TICKETS)
+// Protects the session tickets this server issues, so returning clients can resume without a full handshake
+static mbedtls_ssl_ticket_context ticketContext;
+#endif
 
 #define SUCCESS (0)
 
 
 void DTLS_Init(void)
 {
-    memset(sessions, 0, sizeof(sessions));
+    DTLS_SessionTable_Init(&Sessions, MAX_DTLS_SESSIONS, DTLS_SESSION_IDLE_TIMEOUT_MS, ReleaseSession);
     mbedtls_entropy_init(&entropy);
     mbedtls_ctr_drbg_init(&secureRandom);
     mbedtls_ctr_drbg_seed(&secureRandom, mbedtls_entropy_func, &entropy, NULL, 0);
@@ -105,18 +153,21 @@ void DTLS_Init(void)
     mbedtls_pk_init(&privateKey);
     mbedtls_ssl_cookie_init(&cookie_context);
     mbedtls_ssl_cookie_setup(&cookie_context, mbedtls_ctr_drbg_random, &secureRandom);
+#if defined(DTLS_SESSION_TICKETS)
+    mbedtls_ssl_ticket_init(&ticketContext);
+    if (mbedtls_ssl_ticket_setup(&ticketContext, mbedtls_ctr_drbg_random, &secureRandom, MBEDTLS_CIPHER_AES_128_GCM, DTLS_SESSION_TICKET_LIFETIME_S) != SUCCESS)
+    {
+        Lwm2m_Warning("Unable to set up DTLS session tickets, session resumption disabled\n");
+    }
+#endif
 }
 
 void DTLS_Shutdown(void)
 {
-    int index;
-    for (index = 0;index < MAX_DTLS_SESSIONS; index++)
-    {
-        if (sessions[index].InUse)
-        {
-            FreeSession(&sessions[index]);
-        }
-    }
+    DTLS_SessionTable_Destroy(&Sessions);
+#if defined(DTLS_SESSION_TICKETS)
+    mbedtls_ssl_ticket_free(&ticketContext);
+#endif
     mbedtls_ctr_drbg_free(&secureRandom);
     mbedtls_entropy_free(&entropy);
 }
@@ -159,10 +210,53 @@ void DTLS_SetPSK(const char * identity, const uint8_t * key, int keyLength)
     }
 }
 
+void DTLS_SetPSKKeystore(const DTLS_PSKKeystore * keystore)
+{
+    pskKeystore = keystore;
+}
+
+int DTLS_SetHandshakeWorkers(int numWorkers)
+{
+    if (numWorkers > 0)
+    {
+        Lwm2m_Warning("DTLS handshake workers are not supported with %s\n", DTLS_LibraryName);
+    }
+    return -1;
+}
+
+int DTLS_ProcessHandshakes(void)
+{
+    return 0;
+}
+
+bool DTLS_TakeDeferredRecord(void * context, NetworkAddress ** sourceAddress, uint8_t * buffer, int bufferLength, int * recordLength)
+{
+    return false;
+}
+
+void DTLS_SetSessionLimits(int maxSessions, int idleTimeoutMs)
+{
+    DTLS_SessionTable_SetLimits(&Sessions, maxSessions, idleTimeoutMs);
+}
+
+void DTLS_GetSessionStats(DTLS_SessionStats * stats)
+{
+    DTLS_SessionTable_GetStats(&Sessions, stats);
+}
+
 bool DTLS_Decrypt(NetworkAddress * sourceAddress, uint8_t * encrypted, int encryptedLength, uint8_t * decryptBuffer, int decryptBufferLength, int * decryptedLength, void *context)
 {
     bool result = false;
+    bool rebinding = false;
     DTLS_Session * session = GetSession(sourceAddress);
+#if defined(DTLS_CONNECTION_ID)
+    if (!session)
+    {
+        // a peer whose address has changed, e.g. after NAT rebinding, can still be found by its connection ID
+        session = GetSessionByConnectionId(encrypted, encryptedLength);
+        rebinding = (session != NULL);
+    }
+#endif
     if (session)
     {
         session->Buffer = encrypted;
@@ -171,7 +265,16 @@ bool DTLS_Decrypt(NetworkAddress * sourceAddress, uint8_t * encrypted, int encry
         {
             *decryptedLength = mbedtls_ssl_read(&session->Context, decryptBuffer, decryptBufferLength);
             result = (*decryptedLength > 0);
-            if (!result)
+            if (rebinding)
+            {
+                // only follow the peer to its new address once a record from there has been authenticated
+                if (result)
+                {
+                    Lwm2m_Info("DTLS session moved to new peer address\n");
+                    DTLS_SessionTable_Rebind(&Sessions, &session->Entry, sourceAddress);
+                }
+            }
+            else if (!result)
             {
                 FreeSession(session);
                 session = NULL;
@@ -186,21 +289,16 @@ bool DTLS_Decrypt(NetworkAddress * sourceAddress, uint8_t * encrypted, int encry
         }
     }
 
-    if (!session)
+    if (!session && !rebinding)
     {
-        int index;
-        for (index = 0;index < MAX_DTLS_SESSIONS; index++)
+        session = NewSession(sourceAddress, false);
+        if (session)
         {
-            if (!sessions[index].InUse)
-            {
-                SetupNewSession(index, sourceAddress, false);
-                sessions[index].UserContext = context;
-                sessions[index].Context.f_send = SSLSendCallBack;
-                sessions[index].Buffer = encrypted;
-                sessions[index].BufferLength = encryptedLength;
-                sessions[index].SessionEstablished = (mbedtls_ssl_handshake(&sessions[index].Context) == SUCCESS);
-                break;
-            }
+            session->UserContext = context;
+            session->Context.f_send = SSLSendCallBack;
+            session->Buffer = encrypted;
+            session->BufferLength = encryptedLength;
+            session->SessionEstablished = (mbedtls_ssl_handshake(&session->Context) == SUCCESS);
         }
     }
     return result;
@@ -235,17 +333,12 @@ bool DTLS_Encrypt(NetworkAddress * destAddress, uint8_t * plainText, int plainTe
     }
     else
     {
-        int index;
-        for (index = 0;index < MAX_DTLS_SESSIONS; index++)
+        session = NewSession(destAddress, true);
+        if (session)
         {
-            if (!sessions[index].InUse)
-            {
-                SetupNewSession(index, destAddress, true);
-                sessions[index].UserContext = context;
-                sessions[index].Context.f_send = SSLSendCallBack;
-                sessions[index].SessionEstablished = (mbedtls_ssl_handshake(&sessions[index].Context) == SUCCESS);
-                break;
-            }
+            session->UserContext = context;
+            session->Context.f_send = SSLSendCallBack;
+            session->SessionEstablished = (mbedtls_ssl_handshake(&session->Context) == SUCCESS);
         }
     }
     return result;
@@ -254,23 +347,52 @@ bool DTLS_Encrypt(NetworkAddress * destAddress, uint8_t * plainText, int plainTe
 static DTLS_Session * GetSession(NetworkAddress * address)
 {
     DTLS_Session * result = NULL;
-    int index;
-    for (index = 0;index < MAX_DTLS_SESSIONS; index++)
+    uint64_t now = Lwm2mCore_GetTickCountMs();
+    DTLS_SessionTable_Expire(&Sessions, now);
+    DTLS_SessionTableEntry * entry = DTLS_SessionTable_Find(&Sessions, address, now);
+    if (entry)
     {
-        if (NetworkAddress_Compare(sessions[index].NetworkAddress,address) == 0)
+        result = DTLS_SessionEntry(entry, DTLS_Session, Entry);
+    }
+    return result;
+}
+
+static DTLS_Session * NewSession(NetworkAddress * networkAddress, bool client)
+{
+    DTLS_Session * session = malloc(sizeof(DTLS_Session));
+    if (session)
+    {
+        memset(session, 0, sizeof(DTLS_Session));
+        SetupNewSession(session, client);
+        if (!session->InUse || (DTLS_SessionTable_Add(&Sessions, &session->Entry, networkAddress, Lwm2mCore_GetTickCountMs()) != 0))
         {
-            result = &sessions[index];
-            break;
+            ReleaseSession(&session->Entry);
+            session = NULL;
         }
+#if defined(DTLS_CLIENT_RESUMPTION)
+        else if (client)
+        {
+            LoadResumption(session, networkAddress);
+        }
+#endif
+#if defined(DTLS_CONNECTION_ID)
+        else if (!client)
+        {
+            AssignConnectionId(session);
+        }
+#endif
     }
-    return result;
+    if (!session)
+    {
+        Lwm2m_Error("Unable to allocate DTLS session\n");
+    }
+    return session;
 }
 
-static void SetupNewSession(int index, NetworkAddress * networkAddress, bool client)
+static void SetupNewSession(DTLS_Session * session, bool client)
 {
     int flags;
-    DTLS_Session * session = &sessions[index];
-    session->NetworkAddress = networkAddress;
+    session->Client = client;
     mbedtls_ssl_context * context = &session->Context;
     mbedtls_ssl_config * config = &session->Config;
 
@@ -288,7 +410,14 @@ static void SetupNewSession(int index, NetworkAddress * networkAddress, bool cli
     if (!client)
     {
         mbedtls_ssl_conf_dtls_cookies(config, NULL, NULL, &cookie_context);
+#if defined(DTLS_SESSION_TICKETS)
+        mbedtls_ssl_conf_session_tickets_cb(config, mbedtls_ssl_ticket_write, mbedtls_ssl_ticket_parse, &ticketContext);
+#endif
     }
+#if defined(DTLS_CONNECTION_ID)
+    // clients need no connection ID of their own, the server's address does not change
+    mbedtls_ssl_conf_cid(config, client ? 0 : DTLS_CONNECTION_ID_LENGTH, MBEDTLS_SSL_UNEXPECTED_CID_IGNORE);
+#endif
 
     int cipherIndex = 0;
     if (certificate || !pskIdentity)
@@ -303,7 +432,7 @@ static void SetupNewSession(int index, NetworkAddress * networkAddress, bool cli
         }
         mbedtls_ssl_conf_authmode(config, MBEDTLS_SSL_VERIFY_OPTIONAL);
     }
-    if (pskIdentity)
+    if (pskIdentity || (pskKeystore && !client))
     {
         supportedCipherSuites[cipherIndex] = MBEDTLS_TLS_ECDHE_PSK_WITH_AES_128_CBC_SHA256;
         cipherIndex++;
@@ -330,17 +459,117 @@ static void SetupNewSession(int index, NetworkAddress * networkAddress, bool cli
     {
         mbedtls_ssl_set_bio(context, session, SSLSendCallBack, DecryptCallBack, NULL);
         mbedtls_ssl_set_timer_cb(context, &timer, mbedtls_timing_set_delay, mbedtls_timing_get_delay);
+#if defined(DTLS_CONNECTION_ID)
+        if (client)
+        {
+            mbedtls_ssl_set_cid(context, MBEDTLS_SSL_CID_ENABLED, NULL, 0);
+        }
+#endif
         session->InUse = true;
     }
 }
 
+#if defined(DTLS_CONNECTION_ID)
+static void AssignConnectionId(DTLS_Session * session)
+{
+    unsigned char connectionId[DTLS_CONNECTION_ID_LENGTH];
+    int attempts = 0;
+    do
+    {
+        mbedtls_ctr_drbg_random(&secureRandom, connectionId, sizeof(connectionId));
+        attempts++;
+    } while ((DTLS_SessionTable_FindByConnectionId(&Sessions, connectionId, sizeof(connectionId), session->Entry.LastUsed) != NULL) && (attempts < 4));
+
+    if ((mbedtls_ssl_set_cid(&session->Context, MBEDTLS_SSL_CID_ENABLED, connectionId, sizeof(connectionId)) != SUCCESS) ||
+        (DTLS_SessionTable_SetConnectionId(&Sessions, &session->Entry, connectionId, sizeof(connectionId)) != 0))
+    {
+        Lwm2m_Warning("Unable to assign DTLS connection ID\n");
+    }
+}
+
+static DTLS_Session * GetSessionByConnectionId(uint8_t * encrypted, int encryptedLength)
+{
+    DTLS_Session * result = NULL;
+    const uint8_t * connectionId;
+    if (DTLS_SessionTable_ParseConnectionId(encrypted, encryptedLength, DTLS_CONNECTION_ID_LENGTH, &connectionId) == 0)
+    {
+        DTLS_SessionTableEntry * entry = DTLS_SessionTable_FindByConnectionId(&Sessions, connectionId, DTLS_CONNECTION_ID_LENGTH, Lwm2mCore_GetTickCountMs());
+        if (entry)
+        {
+            result = DTLS_SessionEntry(entry, DTLS_Session, Entry);
+            if (!result->SessionEstablished)
+            {
+                result = NULL;
+            }
+        }
+    }
+    return result;
+}
+#endif
+
+#if defined(DTLS_CLIENT_RESUMPTION)
+// Keep an established client session's state so the next connection to this server can resume it
+static void SaveResumption(DTLS_Session * session)
+{
+    mbedtls_ssl_session saved;
+    mbedtls_ssl_session_init(&saved);
+    if (mbedtls_ssl_get_session(&session->Context, &saved) == SUCCESS)
+    {
+        size_t length = 0;
+        mbedtls_ssl_session_save(&saved, NULL, 0, &length);
+        unsigned char * data = malloc(length);
+        if (data && (mbedtls_ssl_session_save(&saved, data, length, &length) == SUCCESS))
+        {
+            DTLS_SessionTable_SaveResumption(&Sessions, session->Entry.Address, data, length);
+        }
+        free(data);
+    }
+    mbedtls_ssl_session_free(&saved);
+}
+
+static void LoadResumption(DTLS_Session * session, NetworkAddress * networkAddress)
+{
+    size_t length;
+    unsigned char * data = DTLS_SessionTable_TakeResumption(&Sessions, networkAddress, &length);
+    if (data)
+    {
+        mbedtls_ssl_session saved;
+        mbedtls_ssl_session_init(&saved);
+        if (mbedtls_ssl_session_load(&saved, data, length) == SUCCESS)
+        {
+            mbedtls_ssl_set_session(&session->Context, &saved);
+        }
+        mbedtls_ssl_session_free(&saved);
+        free(data);
+    }
+}
+#endif
+
 static void FreeSession(DTLS_Session * session)
 {
-    mbedtls_ssl_close_notify(&session->Context);
-    mbedtls_ssl_session_reset(&session->Context);
+    DTLS_SessionTable_Remove(&Sessions, &session->Entry);
+    ReleaseSession(&session->Entry);
+}
+
+// Release a session that is no longer in the session table
+static void ReleaseSession(DTLS_SessionTableEntry * entry)
+{
+    DTLS_Session * session = DTLS_SessionEntry(entry, DTLS_Session, Entry);
+#if defined(DTLS_CLIENT_RESUMPTION)
+    if (session->Client && session->SessionEstablished)
+    {
+        SaveResumption(session);
+    }
+#endif
+    if (session->InUse)
+    {
+        mbedtls_ssl_close_notify(&session->Context);
+        mbedtls_ssl_session_reset(&session->Context);
+    }
     mbedtls_ssl_free(&session->Context);
     mbedtls_ssl_config_free(&session->Config);
-    memset(session,0, sizeof(DTLS_Session));
+    NetworkAddress_Free(&session->Entry.Address);
+    free(session);
 }
 
 static int DecryptCallBack(void * context, unsigned char * recieveBuffer, size_t receiveBufferLegth)
@@ -395,8 +624,36 @@ static int EncryptCallBack(void * context, const unsigned char * sendBuffer, siz
 
 static int PSKCallBack(void * parameter, mbedtls_ssl_context * context, const unsigned char * identity, size_t identityLength)
 {
-    mbedtls_ssl_set_hs_psk(context, pskKey, pskKeyLength);
-    return 0;
+    (void)parameter;
+    int result = -1;
+    size_t keyLength;
+    const uint8_t * key = FindServerPSK((const char *)identity, identityLength, &keyLength);
+    if (key)
+    {
+        result = mbedtls_ssl_set_hs_psk(context, key, keyLength);
+    }
+    else
+    {
+        Lwm2m_Warning("Unknown PSK identity: %.*s\n", (int)identityLength, identity);
+    }
+    return result;
+}
+
+// Without a keystore every client is offered the single configured key, as before. With one, only identities
+// it holds are accepted: the configured identity is typically the well-known default and must not bypass it.
+static const uint8_t * FindServerPSK(const char * identity, size_t identityLength, size_t * keyLength)
+{
+    const uint8_t * result = NULL;
+    if (pskKeystore)
+    {
+        result = DTLS_PSKKeystore_Find(pskKeystore, identity, identityLength, keyLength);
+    }
+    else if (pskIdentity)
+    {
+        result = pskKey;
+        *keyLength = pskKeyLength;
+    }
+    return result;
 }
 
 static int SSLSendCallBack(void * context, const unsigned char * sendBuffer, size_t sendBufferLength)
@@ -405,7 +662,7 @@ static int SSLSendCallBack(void * context, const unsigned char * sendBuffer, siz
     DTLS_Session * session = (DTLS_Session *)context;
     if (NetworkSend)
     {
-        NetworkTransmissionError error = NetworkSend(session->NetworkAddress, sendBuffer, sendBufferLength, session->UserContext);
+        NetworkTransmissionError error = NetworkSend(session->Entry.Address, sendBuffer, sendBufferLength, session->UserContext);
         if (error == NetworkTransmissionError_None)
             result = sendBufferLength;
         else
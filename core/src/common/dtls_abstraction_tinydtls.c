@@ -21,10 +21,13 @@
 ************************************************************************************************************************/
 
 #include <stdbool.h>
+#include <stdlib.h>
 #include <string.h>
 
 #include "lwm2m_debug.h"
+#include "lwm2m_util.h"
 #include "dtls_abstraction.h"
+#include "dtls_session_table.h"
 
 #ifndef DTLSv12
 #define DTLSv12
@@ -53,7 +56,7 @@ typedef enum
 
 typedef struct
 {
-    NetworkAddress * NetworkAddress;
+    DTLS_SessionTableEntry Entry;
     session_t Session;
     dtls_context_t * Context;
     dtls_handler_t Callbacks;
@@ -66,13 +69,9 @@ typedef struct
     int BufferLength;
 }DTLS_Session;
 
-#ifndef MAX_DTLS_SESSIONS
-    #define MAX_DTLS_SESSIONS 3
-#endif
-
 const char * DTLS_LibraryName = "TinyDTLS";
 
-static DTLS_Session sessions[MAX_DTLS_SESSIONS];
+static DTLS_SessionTable Sessions;
 
 static uint8_t * certificate = NULL;
 static int certificateLength = 0;
@@ -81,6 +80,7 @@ static AwaCertificateFormat certificateFormat;
 static const char * pskIdentity = NULL;
 static const uint8_t * pskKey = NULL;
 static int pskKeyLength = 0;
+static const DTLS_PSKKeystore * pskKeystore = NULL;
 
 static DTLS_NetworkSendCallback NetworkSend = NULL;
 
@@ -88,8 +88,10 @@ static DTLS_NetworkSendCallback NetworkSend = NULL;
 static DTLS_Session * AllocateSession(NetworkAddress * address, bool client, void * context);
 static int DummySendCallBack(struct dtls_context_t *context, session_t *session, uint8 * sendBuffer, size_t sendBufferLength);
 static DTLS_Session * GetSession(NetworkAddress * address);
-static void SetupNewSession(int index, NetworkAddress * networkAddress, bool client);
+static void SetupNewSession(DTLS_Session * session, bool client);
+static void BindSession(DTLS_Session * session);
 static void FreeSession(DTLS_Session * session);
+static void ReleaseSession(DTLS_SessionTableEntry * entry);
 #ifdef DTLS_ECC
 static int CertificateVerify(struct dtls_context_t *ctx, const session_t *session, const unsigned char *other_pub_x, const unsigned char *other_pub_y, size_t key_size);
 #endif
@@ -107,7 +109,7 @@ static dtls_context_t * dtlsContext;
 
 void DTLS_Init(void)
 {
-    memset(sessions,0,sizeof(DTLS_Session) * MAX_DTLS_SESSIONS);
+    DTLS_SessionTable_Init(&Sessions, MAX_DTLS_SESSIONS, DTLS_SESSION_IDLE_TIMEOUT_MS, ReleaseSession);
     dtls_init();
 #ifdef WITH_CONTIKI
     dtlsContext  = dtls_new_context(NULL);
@@ -116,14 +118,7 @@ void DTLS_Init(void)
 
 void DTLS_Shutdown(void)
 {
-    int index;
-    for (index = 0;index < MAX_DTLS_SESSIONS; index++)
-    {
-        if (sessions[index].Context)
-        {
-            FreeSession(&sessions[index]);
-        }
-    }
+    DTLS_SessionTable_Destroy(&Sessions);
 #ifdef WITH_CONTIKI
     dtls_free_context(dtlsContext);
 #endif
@@ -163,6 +158,40 @@ void DTLS_SetPSK(const char * identity, const uint8_t * key, int keyLength)
     }
 }
 
+void DTLS_SetPSKKeystore(const DTLS_PSKKeystore * keystore)
+{
+    pskKeystore = keystore;
+}
+
+int DTLS_SetHandshakeWorkers(int numWorkers)
+{
+    if (numWorkers > 0)
+    {
+        Lwm2m_Warning("DTLS handshake workers are not supported with %s\n", DTLS_LibraryName);
+    }
+    return -1;
+}
+
+int DTLS_ProcessHandshakes(void)
+{
+    return 0;
+}
+
+bool DTLS_TakeDeferredRecord(void * context, NetworkAddress ** sourceAddress, uint8_t * buffer, int bufferLength, int * recordLength)
+{
+    return false;
+}
+
+void DTLS_SetSessionLimits(int maxSessions, int idleTimeoutMs)
+{
+    DTLS_SessionTable_SetLimits(&Sessions, maxSessions, idleTimeoutMs);
+}
+
+void DTLS_GetSessionStats(DTLS_SessionStats * stats)
+{
+    DTLS_SessionTable_GetStats(&Sessions, stats);
+}
+
 
 bool DTLS_Decrypt(NetworkAddress * sourceAddress, uint8_t * encrypted, int encryptedLength, uint8_t * decryptBuffer, int decryptBufferLength, int * decryptedLength, void *context)
 {
@@ -179,7 +208,7 @@ bool DTLS_Decrypt(NetworkAddress * sourceAddress, uint8_t * encrypted, int encry
         session->Buffer = decryptBuffer;
         session->BufferLength = decryptBufferLength;
         bool hadSessionEstablished = session->SessionEstablished;
-        dtls_set_app_data(session->Context, session);
+        BindSession(session);
         if (dtls_handle_message(session->Context, &session->Session, encrypted, encryptedLength) == TINY_DTLS_SUCCESS)
         {
             *decryptedLength = decryptBufferLength - session->BufferLength;
@@ -223,7 +252,7 @@ bool DTLS_Encrypt(NetworkAddress * destAddress, uint8_t * plainText, int plainTe
             session->Callbacks.write = EncryptCallBack;
             session->Buffer = encryptedBuffer;
             session->BufferLength = encryptedBufferLength;
-            dtls_set_app_data(session->Context, session);
+            BindSession(session);
             int written = dtls_write(session->Context, &session->Session, plainText, plainTextLength);
             if (written >= 0)
             {
@@ -238,7 +267,7 @@ bool DTLS_Encrypt(NetworkAddress * destAddress, uint8_t * plainText, int plainTe
             dtls_peer_t * peer = dtls_get_peer(session->Context, &session->Session);
             if (!peer)
             {
-                dtls_set_app_data(session->Context, session);
+                BindSession(session);
                 dtls_connect(session->Context, &session->Session);
             }
         }
@@ -256,7 +285,7 @@ bool DTLS_Encrypt(NetworkAddress * destAddress, uint8_t * plainText, int plainTe
             }
             if (!peer)
             {
-                dtls_set_app_data(session->Context, session);
+                BindSession(session);
                 dtls_connect(session->Context, &session->Session);
             }
         }
@@ -266,40 +295,44 @@ bool DTLS_Encrypt(NetworkAddress * destAddress, uint8_t * plainText, int plainTe
 
 static DTLS_Session * AllocateSession(NetworkAddress * address, bool client, void * context)
 {
-    DTLS_Session * result = NULL;
-    int index;
-    for (index = 0;index < MAX_DTLS_SESSIONS; index++)
+    DTLS_Session * session = malloc(sizeof(DTLS_Session));
+    if (session)
     {
-        if (!sessions[index].Context)
+        memset(session, 0, sizeof(DTLS_Session));
+        SetupNewSession(session, client);
+        if (!session->Context || (DTLS_SessionTable_Add(&Sessions, &session->Entry, address, Lwm2mCore_GetTickCountMs()) != 0))
         {
-            SetupNewSession(index, address, client);
-            sessions[index].UserContext = context;
-            sessions[index].Callbacks.write = SSLSendCallBack;
-            result = &sessions[index];
-            break;
+            ReleaseSession(&session->Entry);
+            session = NULL;
+        }
+        else
+        {
+            session->UserContext = context;
+            session->Callbacks.write = SSLSendCallBack;
         }
     }
-    return result;
+    if (!session)
+    {
+        Lwm2m_Error("Unable to allocate DTLS session\n");
+    }
+    return session;
 }
 
 static DTLS_Session * GetSession(NetworkAddress * address)
 {
     DTLS_Session * result = NULL;
-    int index;
-    for (index = 0;index < MAX_DTLS_SESSIONS; index++)
+    uint64_t now = Lwm2mCore_GetTickCountMs();
+    DTLS_SessionTable_Expire(&Sessions, now);
+    DTLS_SessionTableEntry * entry = DTLS_SessionTable_Find(&Sessions, address, now);
+    if (entry)
     {
-        if (NetworkAddress_Compare(sessions[index].NetworkAddress,address) == 0)
-        {
-            result = &sessions[index];
-            break;
-        }
+        result = DTLS_SessionEntry(entry, DTLS_Session, Entry);
     }
     return result;
 }
 
-static void SetupNewSession(int index, NetworkAddress * networkAddress, bool client)
+static void SetupNewSession(DTLS_Session * session, bool client)
 {
-    DTLS_Session * session = &sessions[index];
     if (!client)
         session->Callbacks.event = EventCallBack;
     session->Callbacks.read = DecryptCallBack;
@@ -311,7 +344,6 @@ static void SetupNewSession(int index, NetworkAddress * networkAddress, bool cli
     session->Callbacks.get_ecdsa_key = GetCertificate;
     session->Callbacks.verify_ecdsa_key = CertificateVerify;
 #endif
-    session->NetworkAddress = networkAddress;
 #ifdef WITH_CONTIKI
     session->Context = dtlsContext;
 #else
@@ -328,11 +360,29 @@ static void SetupNewSession(int index, NetworkAddress * networkAddress, bool cli
     }
 }
 
+// Make the session current on its context; under Contiki the context and its handler are shared by all sessions
+static void BindSession(DTLS_Session * session)
+{
+    dtls_set_app_data(session->Context, session);
+#ifdef WITH_CONTIKI
+    dtls_set_handler(session->Context, &session->Callbacks);
+#endif
+}
+
 static void FreeSession(DTLS_Session * session)
 {
+    DTLS_SessionTable_Remove(&Sessions, &session->Entry);
+    ReleaseSession(&session->Entry);
+}
+
+// Release a session that is no longer in the session table
+static void ReleaseSession(DTLS_SessionTableEntry * entry)
+{
+    DTLS_Session * session = DTLS_SessionEntry(entry, DTLS_Session, Entry);
     if (session->Context)
     {
         session->Callbacks.write = DummySendCallBack;
+        BindSession(session);
         dtls_peer_t * peer = dtls_get_peer(session->Context, &session->Session);
         if (peer)
         {
@@ -342,7 +392,8 @@ static void FreeSession(DTLS_Session * session)
         dtls_free_context(session->Context);
 #endif
     }
-    memset(session,0, sizeof(DTLS_Session));
+    NetworkAddress_Free(&session->Entry.Address);
+    free(session);
 }
 
 #if GNUTLS_VERSION_MAJOR >= 3
@@ -367,7 +418,8 @@ static int DecryptCallBack(struct dtls_context_t *context, session_t *session, u
         {
             result =  dtlsSession->BufferLength;
         }
-        memcpy(dtlsSession->Buffer, recieveBuffer, result);
+        // tinydtls decrypts within the received datagram, which may also be the destination
+        memmove(dtlsSession->Buffer, recieveBuffer, result);
         dtlsSession->BufferLength = dtlsSession->BufferLength - result;
         dtlsSession->Buffer += result;
     }
@@ -440,6 +492,11 @@ static int PSKCallBack(struct dtls_context_t *ctx, const session_t *session, dtl
         {
             Lwm2m_Debug("got psk_identity_hint: '%.*s'\n", (int)id_len, id);
         }
+        if (!pskIdentity && (type == DTLS_PSK_HINT) && pskKeystore)
+        {
+            // Keystore-only server: send no hint
+            return 0;
+        }
         if (!pskIdentity)
         {
             Lwm2m_Error("psk identity is not set\n");
@@ -455,20 +512,33 @@ static int PSKCallBack(struct dtls_context_t *ctx, const session_t *session, dtl
         memcpy(result, pskIdentity, pskIdentityLength);
         return pskIdentityLength;
     case DTLS_PSK_KEY:
-        pskIdentityLength = strlen(pskIdentity);
-        if (id_len != (size_t)pskIdentityLength || memcmp(pskIdentity, id, id_len) != 0)
+    {
+        size_t keyLength = 0;
+        const uint8_t * key = NULL;
+        if (pskKeystore)
+        {
+            // only identities in the keystore are accepted, not the (typically well-known default) configured one
+            key = DTLS_PSKKeystore_Find(pskKeystore, (const char *)id, id_len, &keyLength);
+        }
+        else if (pskIdentity && (id_len == strlen(pskIdentity)) && (memcmp(pskIdentity, id, id_len) == 0))
+        {
+            key = pskKey;
+            keyLength = pskKeyLength;
+        }
+        if (!key)
         {
             Lwm2m_Warning("PSK for unknown id requested, exiting\n");
             return dtls_alert_fatal_create(DTLS_ALERT_ILLEGAL_PARAMETER);
         }
-        else if (result_length < (size_t)pskKeyLength)
+        else if (result_length < keyLength)
         {
             Lwm2m_Warning("cannot set psk -- buffer too small\n");
             return dtls_alert_fatal_create(DTLS_ALERT_INTERNAL_ERROR);
         }
 
-        memcpy(result, pskKey, pskKeyLength);
-        return pskKeyLength;
+        memcpy(result, key, keyLength);
+        return keyLength;
+    }
     default:
         Lwm2m_Warning("unsupported request type: %d\n", type);
     }
@@ -484,7 +554,7 @@ static int SSLSendCallBack(struct dtls_context_t *context, session_t *session, u
     DTLS_Session * dtlsSession = (DTLS_Session *)dtls_get_app_data(context);
     if (dtlsSession && NetworkSend)
     {
-        NetworkTransmissionError error = NetworkSend(dtlsSession->NetworkAddress, sendBuffer, sendBufferLength, dtlsSession->UserContext);
+        NetworkTransmissionError error = NetworkSend(dtlsSession->Entry.Address, sendBuffer, sendBufferLength, dtlsSession->UserContext);
         if (error == NetworkTransmissionError_None)
             result = sendBufferLength;
         else
@@ -0,0 +1,262 @@
+/************************************************************************************************************************
+ Copyright (c) 2016, Imagination Technologies Limited and/or its affiliated group companies.
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+ following conditions are met:
+     1. Redistributions of source code must retain the above copyright notice, this list of conditions and the
+        following disclaimer.
+     2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the
+        following disclaimer in the documentation and/or other materials provided with the distribution.
+     3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote
+        products derived from this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+ USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+************************************************************************************************************************/
+
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/eventfd.h>
+
+#include "lwm2m_debug.h"
+#include "dtls_handshake_pool.h"
+
+static void * WorkerThread(void * context)
+{
+    DTLS_HandshakePool * pool = (DTLS_HandshakePool *)context;
+    pthread_mutex_lock(&pool->Lock);
+    while (!pool->Stopping)
+    {
+        if (pool->Queue.Next == &pool->Queue)
+        {
+            pthread_cond_wait(&pool->Wakeup, &pool->Lock);
+            continue;
+        }
+        DTLS_HandshakeJob * job = ListEntry(pool->Queue.Next, DTLS_HandshakeJob, List);
+        ListRemove(&job->List);
+        pool->Queued--;
+        pthread_mutex_unlock(&pool->Lock);
+
+        pool->Work(job);
+        job->Run = true;
+
+        pthread_mutex_lock(&pool->Lock);
+        ListAdd(&job->List, &pool->Completed);
+        uint64_t signal = 1;
+        if (write(pool->EventFd, &signal, sizeof(signal)) != sizeof(signal))
+        {
+            Lwm2m_Error("Failed to signal DTLS handshake completion: %s\n", strerror(errno));
+        }
+    }
+    pthread_mutex_unlock(&pool->Lock);
+    return NULL;
+}
+
+int DTLS_HandshakePool_Start(DTLS_HandshakePool * pool, int numThreads, DTLS_HandshakeWorkFunction work)
+{
+    if (pool->Completed.Next != NULL)
+    {
+        pthread_mutex_destroy(&pool->Lock);
+        pthread_cond_destroy(&pool->Wakeup);
+    }
+    memset(pool, 0, sizeof(*pool));
+    ListInit(&pool->Queue);
+    ListInit(&pool->Completed);
+    pool->Work = work;
+    pthread_mutex_init(&pool->Lock, NULL);
+    pthread_cond_init(&pool->Wakeup, NULL);
+    pool->EventFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (pool->EventFd < 0)
+    {
+        Lwm2m_Error("Failed to create DTLS handshake eventfd: %s\n", strerror(errno));
+        return -1;
+    }
+
+    pool->Threads = (pthread_t *)malloc(numThreads * sizeof(pthread_t));
+    if (pool->Threads)
+    {
+        for (pool->NumThreads = 0; pool->NumThreads < numThreads; pool->NumThreads++)
+        {
+            if (pthread_create(&pool->Threads[pool->NumThreads], NULL, WorkerThread, pool) != 0)
+            {
+                Lwm2m_Error("Failed to start DTLS handshake worker %d\n", pool->NumThreads);
+                break;
+            }
+        }
+    }
+    if (pool->NumThreads < numThreads)
+    {
+        DTLS_HandshakePool_Stop(pool);
+        return -1;
+    }
+    Lwm2m_Info("Running DTLS handshakes on %d worker threads\n", numThreads);
+    return 0;
+}
+
+void DTLS_HandshakePool_Stop(DTLS_HandshakePool * pool)
+{
+    if ((pool->Completed.Next == NULL) || (pool->EventFd < 0))
+    {
+        // never started, or already stopped
+        return;
+    }
+    pthread_mutex_lock(&pool->Lock);
+    pool->Stopping = true;
+    pthread_cond_broadcast(&pool->Wakeup);
+    pthread_mutex_unlock(&pool->Lock);
+
+    int i;
+    for (i = 0; i < pool->NumThreads; i++)
+    {
+        pthread_join(pool->Threads[i], NULL);
+    }
+    free(pool->Threads);
+    pool->Threads = NULL;
+    pool->NumThreads = 0;
+
+    // hand unstarted jobs back so their sessions can be released
+    while (pool->Queue.Next != &pool->Queue)
+    {
+        struct ListHead * item = pool->Queue.Next;
+        ListRemove(item);
+        ListAdd(item, &pool->Completed);
+    }
+    pool->Queued = 0;
+
+    Lwm2m_Info("DTLS handshake pool: %lu steps submitted, %lu dropped, peak queue %lu\n",
+               (unsigned long)pool->Stats.Submitted, (unsigned long)pool->Stats.Dropped, (unsigned long)pool->Stats.PeakQueued);
+    close(pool->EventFd);
+    pool->EventFd = -1;
+}
+
+bool DTLS_HandshakePool_IsRunning(const DTLS_HandshakePool * pool)
+{
+    return (pool->NumThreads > 0);
+}
+
+int DTLS_HandshakePool_GetEventFd(const DTLS_HandshakePool * pool)
+{
+    return DTLS_HandshakePool_IsRunning(pool) ? pool->EventFd : -1;
+}
+
+int DTLS_HandshakePool_Submit(DTLS_HandshakePool * pool, DTLS_HandshakeJob * job)
+{
+    int result = -1;
+    if (DTLS_HandshakePool_IsRunning(pool))
+    {
+        pthread_mutex_lock(&pool->Lock);
+        if (pool->Queued < DTLS_HANDSHAKE_QUEUE_LENGTH)
+        {
+            ListAdd(&job->List, &pool->Queue);
+            pool->Queued++;
+            pool->Stats.Submitted++;
+            if (pool->Queued > pool->Stats.PeakQueued)
+            {
+                pool->Stats.PeakQueued = pool->Queued;
+            }
+            pthread_cond_signal(&pool->Wakeup);
+            result = 0;
+        }
+        else
+        {
+            pool->Stats.Dropped++;
+        }
+        pthread_mutex_unlock(&pool->Lock);
+    }
+    return result;
+}
+
+DTLS_HandshakeJob * DTLS_HandshakePool_TakeCompleted(DTLS_HandshakePool * pool)
+{
+    DTLS_HandshakeJob * job = NULL;
+    if (pool->Completed.Next == NULL)
+    {
+        // never started
+        return NULL;
+    }
+    pthread_mutex_lock(&pool->Lock);
+    if (pool->Completed.Next != &pool->Completed)
+    {
+        job = ListEntry(pool->Completed.Next, DTLS_HandshakeJob, List);
+        ListRemove(&job->List);
+    }
+    else if (pool->EventFd >= 0)
+    {
+        // reset the eventfd counter while holding the lock, so a worker finishing now signals it again
+        uint64_t count;
+        if (read(pool->EventFd, &count, sizeof(count)) < 0 && errno != EAGAIN)
+        {
+            Lwm2m_Error("Failed to read DTLS handshake eventfd: %s\n", strerror(errno));
+        }
+    }
+    pthread_mutex_unlock(&pool->Lock);
+    return job;
+}
+
+void DTLS_HandshakePool_GetStats(DTLS_HandshakePool * pool, DTLS_HandshakePoolStats * stats)
+{
+    if (pool->Completed.Next != NULL)
+    {
+        pthread_mutex_lock(&pool->Lock);
+        *stats = pool->Stats;
+        pthread_mutex_unlock(&pool->Lock);
+    }
+    else
+    {
+        memset(stats, 0, sizeof(*stats));
+    }
+}
+
+DTLS_HandshakeJob * DTLS_HandshakeJob_New(void * session, const uint8_t * record, int recordLength)
+{
+    DTLS_HandshakeJob * job = (DTLS_HandshakeJob *)malloc(sizeof(DTLS_HandshakeJob) + recordLength);
+    if (job)
+    {
+        memset(job, 0, sizeof(DTLS_HandshakeJob));
+        ListInit(&job->List);
+        ListInit(&job->Output);
+        job->Session = session;
+        job->Record = (uint8_t *)(job + 1);
+        job->RecordLength = recordLength;
+        memcpy(job->Record, record, recordLength);
+    }
+    return job;
+}
+
+int DTLS_HandshakeJob_AddOutput(DTLS_HandshakeJob * job, const uint8_t * data, int length)
+{
+    DTLS_HandshakeOutput * output = (DTLS_HandshakeOutput *)malloc(sizeof(DTLS_HandshakeOutput) + length);
+    if (!output)
+    {
+        return -1;
+    }
+    output->Length = length;
+    memcpy(output->Data, data, length);
+    ListAdd(&output->List, &job->Output);
+    return 0;
+}
+
+void DTLS_HandshakeJob_Free(DTLS_HandshakeJob ** job)
+{
+    if (job && *job)
+    {
+        struct ListHead * item;
+        struct ListHead * next;
+        ListForEachSafe(item, next, &(*job)->Output)
+        {
+            DTLS_HandshakeOutput * output = ListEntry(item, DTLS_HandshakeOutput, List);
+            ListRemove(&output->List);
+            free(output);
+        }
+        free(*job);
+        *job = NULL;
+    }
+}
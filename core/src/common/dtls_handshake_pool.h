@@ -0,0 +1,126 @@
+/************************************************************************************************************************
+ Copyright (c) 2016, Imagination Technologies Limited and/or its affiliated group companies.
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+ following conditions are met:
+     1. Redistributions of source code must retain the above copyright notice, this list of conditions and the
+        following disclaimer.
+     2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the
+        following disclaimer in the documentation and/or other materials provided with the distribution.
+     3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote
+        products derived from this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+ USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+************************************************************************************************************************/
+
+#ifndef DTLS_HANDSHAKE_POOL_H
+#define DTLS_HANDSHAKE_POOL_H
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "lwm2m_list.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ *  Worker threads for DTLS handshake steps. The main loop submits a job holding one received datagram
+ *  for a session that is still handshaking; a worker runs the backend's handshake step on it and
+ *  collects the datagrams the step wants to send, rather than sending them. Finished jobs are queued
+ *  for the main loop and an eventfd is signalled, so the main loop sends the output and updates its
+ *  session table on its own thread. A session must have at most one job outstanding at a time.
+ *
+ *  The queue of waiting jobs is bounded: when it is full, submission fails and the datagram should be
+ *  dropped, leaving the peer to retransmit its flight once the backlog has cleared.
+ */
+
+#ifndef DTLS_HANDSHAKE_QUEUE_LENGTH
+#define DTLS_HANDSHAKE_QUEUE_LENGTH (256)
+#endif
+
+typedef struct
+{
+    size_t Submitted;                   // jobs accepted
+    size_t Dropped;                     // jobs refused because the queue was full
+    size_t PeakQueued;                  // highest number of jobs waiting for a worker
+} DTLS_HandshakePoolStats;
+
+typedef struct
+{
+    struct ListHead List;
+    int Length;
+    uint8_t Data[];
+} DTLS_HandshakeOutput;
+
+typedef struct
+{
+    struct ListHead List;
+    void * Session;                     // backend session the step runs for
+    uint8_t * Record;                   // received datagram to feed to the handshake
+    int RecordLength;
+    struct ListHead Output;             // DTLS_HandshakeOutput datagrams for the main loop to send
+    int Result;                         // backend status of the handshake step
+    bool Run;                           // false if the pool stopped before a worker reached the job
+} DTLS_HandshakeJob;
+
+typedef void (*DTLS_HandshakeWorkFunction)(DTLS_HandshakeJob * job);
+
+typedef struct
+{
+    pthread_t * Threads;
+    int NumThreads;
+    pthread_mutex_t Lock;
+    pthread_cond_t Wakeup;
+    struct ListHead Queue;
+    struct ListHead Completed;
+    size_t Queued;
+    int EventFd;
+    bool Stopping;
+    DTLS_HandshakeWorkFunction Work;
+    DTLS_HandshakePoolStats Stats;
+} DTLS_HandshakePool;
+
+// Start numThreads workers running work. Returns 0 on success, or -1 with no threads left running.
+int DTLS_HandshakePool_Start(DTLS_HandshakePool * pool, int numThreads, DTLS_HandshakeWorkFunction work);
+
+// Join the workers after their current jobs. Jobs still queued move to the completed list with Run false,
+// so the caller can take them back with DTLS_HandshakePool_TakeCompleted before starting the pool again.
+void DTLS_HandshakePool_Stop(DTLS_HandshakePool * pool);
+
+bool DTLS_HandshakePool_IsRunning(const DTLS_HandshakePool * pool);
+
+// Readable whenever completed jobs are waiting; -1 when the pool is not running
+int DTLS_HandshakePool_GetEventFd(const DTLS_HandshakePool * pool);
+
+// Returns 0 if the job was queued, or -1 if the pool is not running or its queue is full
+int DTLS_HandshakePool_Submit(DTLS_HandshakePool * pool, DTLS_HandshakeJob * job);
+
+// Returns the next completed job, or NULL if there are none. Clears the eventfd once the list is empty.
+DTLS_HandshakeJob * DTLS_HandshakePool_TakeCompleted(DTLS_HandshakePool * pool);
+
+void DTLS_HandshakePool_GetStats(DTLS_HandshakePool * pool, DTLS_HandshakePoolStats * stats);
+
+// Returns a job holding a copy of record, or NULL if memory is exhausted
+DTLS_HandshakeJob * DTLS_HandshakeJob_New(void * session, const uint8_t * record, int recordLength);
+
+// Called by the work function to keep a datagram for the main loop to send. Returns 0 or -1.
+int DTLS_HandshakeJob_AddOutput(DTLS_HandshakeJob * job, const uint8_t * data, int length);
+
+void DTLS_HandshakeJob_Free(DTLS_HandshakeJob ** job);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // DTLS_HANDSHAKE_POOL_H
@@ -0,0 +1,298 @@
+/************************************************************************************************************************
+ Copyright (c) 2016, Imagination Technologies Limited and/or its affiliated group companies.
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+ following conditions are met:
+     1. Redistributions of source code must retain the above copyright notice, this list of conditions and the
+        following disclaimer.
+     2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the
+        following disclaimer in the documentation and/or other materials provided with the distribution.
+     3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote
+        products derived from this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+ USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+************************************************************************************************************************/
+
+#include <stdlib.h>
+#include <string.h>
+#ifndef CONTIKI
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+#include "lwm2m_debug.h"
+#include "lwm2m_hash_table.h"
+#include "dtls_psk_keystore.h"
+
+// Longest identity accepted; the TLS limit is 2^16-1 but real identities are far shorter
+#define MAX_PSK_IDENTITY_LENGTH (128)
+#define MAX_PSK_KEY_LENGTH      (64)
+
+typedef struct
+{
+    HashTableNode Node;
+    size_t IdentityOffset;              // into Identities, not NUL terminated
+    uint32_t IdentityLength;
+    uint32_t KeyLength;
+    size_t KeyOffset;                   // into Keys
+} KeystoreEntry;
+
+struct _DTLS_PSKKeystore
+{
+    KeystoreEntry * Entries;
+    size_t Count;
+    char * Identities;
+    uint8_t * Keys;
+    HashTable Index;
+};
+
+static int HexValue(char c)
+{
+    int value = -1;
+    if ((c >= '0') && (c <= '9'))
+        value = c - '0';
+    else if ((c >= 'a') && (c <= 'f'))
+        value = c - 'a' + 10;
+    else if ((c >= 'A') && (c <= 'F'))
+        value = c - 'A' + 10;
+    return value;
+}
+
+// Decode hex digits into key, returning the number of bytes or -1 if the text is not a valid key
+static int DecodeKey(const char * hex, size_t hexLength, uint8_t * key)
+{
+    size_t i;
+    if ((hexLength == 0) || ((hexLength % 2) != 0) || (hexLength / 2 > MAX_PSK_KEY_LENGTH))
+    {
+        return -1;
+    }
+    for (i = 0; i < hexLength; i += 2)
+    {
+        int high = HexValue(hex[i]);
+        int low = HexValue(hex[i + 1]);
+        if ((high < 0) || (low < 0))
+        {
+            return -1;
+        }
+        key[i / 2] = (uint8_t)((high << 4) | low);
+    }
+    return hexLength / 2;
+}
+
+static KeystoreEntry * FindEntry(const DTLS_PSKKeystore * keystore, const char * identity, size_t identityLength)
+{
+    HashTableNode * node;
+    for (node = HashTable_FindFirst(&keystore->Index, HashTable_HashBytes(identity, identityLength)); node != NULL; node = HashTable_FindNext(node))
+    {
+        KeystoreEntry * entry = HashTableEntry(node, KeystoreEntry, Node);
+        if ((entry->IdentityLength == identityLength) && (memcmp(&keystore->Identities[entry->IdentityOffset], identity, identityLength) == 0))
+        {
+            return entry;
+        }
+    }
+    return NULL;
+}
+
+// Parse one line, without its line terminator, into the next free entry. Returns 0 if an entry was added.
+static int ParseLine(DTLS_PSKKeystore * keystore, const char * line, size_t length, size_t * identitiesUsed, size_t * keysUsed, int lineNumber)
+{
+    const char * separator;
+    size_t identityLength;
+    int keyLength;
+
+    while ((length > 0) && ((line[length - 1] == '\r') || (line[length - 1] == ' ') || (line[length - 1] == '\t')))
+    {
+        length--;
+    }
+    if ((length == 0) || (line[0] == '#'))
+    {
+        return -1;
+    }
+
+    // keys are hex so cannot contain ':', identities may
+    for (separator = line + length - 1; (separator >= line) && (*separator != ':'); separator--)
+        ;
+    identityLength = separator - line;
+    if ((separator < line) || (identityLength == 0) || (identityLength > MAX_PSK_IDENTITY_LENGTH))
+    {
+        Lwm2m_Warning("PSK keystore line %d: expected IDENTITY:HEXKEY\n", lineNumber);
+        return -1;
+    }
+
+    keyLength = DecodeKey(separator + 1, length - identityLength - 1, &keystore->Keys[*keysUsed]);
+    if (keyLength < 0)
+    {
+        Lwm2m_Warning("PSK keystore line %d: invalid key\n", lineNumber);
+        return -1;
+    }
+
+    if (FindEntry(keystore, line, identityLength) != NULL)
+    {
+        Lwm2m_Warning("PSK keystore line %d: duplicate identity %.*s ignored\n", lineNumber, (int)identityLength, line);
+        return -1;
+    }
+
+    KeystoreEntry * entry = &keystore->Entries[keystore->Count];
+    memcpy(&keystore->Identities[*identitiesUsed], line, identityLength);
+    entry->IdentityOffset = *identitiesUsed;
+    entry->IdentityLength = identityLength;
+    entry->KeyOffset = *keysUsed;
+    entry->KeyLength = keyLength;
+    if (HashTable_Insert(&keystore->Index, &entry->Node, HashTable_HashBytes(line, identityLength)) != 0)
+    {
+        return -1;
+    }
+    keystore->Count++;
+    *identitiesUsed += identityLength;
+    *keysUsed += keyLength;
+    return 0;
+}
+
+#ifndef CONTIKI
+
+DTLS_PSKKeystore * DTLS_PSKKeystore_Load(const char * path)
+{
+    DTLS_PSKKeystore * keystore = NULL;
+    struct stat fileStatus;
+    int fd = open(path, O_RDONLY);
+    if (fd < 0)
+    {
+        Lwm2m_Error("Unable to open PSK keystore %s\n", path);
+        goto error;
+    }
+    if (fstat(fd, &fileStatus) != 0)
+    {
+        Lwm2m_Error("Unable to read PSK keystore %s\n", path);
+        goto error_close;
+    }
+
+    keystore = calloc(1, sizeof(DTLS_PSKKeystore));
+    if (keystore == NULL)
+    {
+        goto error_close;
+    }
+    HashTable_Init(&keystore->Index);
+
+    if (fileStatus.st_size > 0)
+    {
+        // the mapping is only read while parsing, so the file may be rewritten in place once loaded
+        size_t mappingLength = fileStatus.st_size;
+        const char * mapping = mmap(NULL, mappingLength, PROT_READ, MAP_PRIVATE, fd, 0);
+        const char * text;
+        const char * end;
+        size_t maxEntries = 1;
+        size_t identitiesUsed = 0;
+        size_t keysUsed = 0;
+        int lineNumber = 1;
+
+        if (mapping == MAP_FAILED)
+        {
+            Lwm2m_Error("Unable to map PSK keystore %s\n", path);
+            goto error_free;
+        }
+        text = mapping;
+        end = text + mappingLength;
+
+        // size for the worst case, one entry per line, the whole file as identities and half as key bytes, then trim
+        const char * newline;
+        for (newline = memchr(text, '\n', end - text); newline != NULL; newline = memchr(newline + 1, '\n', end - newline - 1))
+        {
+            maxEntries++;
+        }
+        keystore->Entries = malloc(maxEntries * sizeof(KeystoreEntry));
+        keystore->Identities = malloc(mappingLength);
+        keystore->Keys = malloc(mappingLength / 2 + 1);
+        if ((keystore->Entries == NULL) || (keystore->Identities == NULL) || (keystore->Keys == NULL))
+        {
+            Lwm2m_Error("Out of memory loading PSK keystore %s\n", path);
+            munmap((void *)mapping, mappingLength);
+            goto error_free;
+        }
+
+        while (text < end)
+        {
+            newline = memchr(text, '\n', end - text);
+            const char * lineEnd = (newline != NULL) ? newline : end;
+            ParseLine(keystore, text, lineEnd - text, &identitiesUsed, &keysUsed, lineNumber++);
+            text = lineEnd + 1;
+        }
+        munmap((void *)mapping, mappingLength);
+
+        // entries are referenced by the index so cannot move; identities and keys are found by offset so are trimmed
+        if (identitiesUsed > 0)
+        {
+            char * identities = realloc(keystore->Identities, identitiesUsed);
+            if (identities != NULL)
+            {
+                keystore->Identities = identities;
+            }
+        }
+        if (keysUsed > 0)
+        {
+            uint8_t * keys = realloc(keystore->Keys, keysUsed);
+            if (keys != NULL)
+            {
+                keystore->Keys = keys;
+            }
+        }
+    }
+    close(fd);
+    Lwm2m_Info("Loaded %lu PSK identities from %s\n", (unsigned long)keystore->Count, path);
+    return keystore;
+
+error_free:
+    DTLS_PSKKeystore_Free(&keystore);
+error_close:
+    close(fd);
+error:
+    return NULL;
+}
+
+#else
+
+DTLS_PSKKeystore * DTLS_PSKKeystore_Load(const char * path)
+{
+    Lwm2m_Error("PSK keystore files are not supported on this platform\n");
+    return NULL;
+}
+
+#endif
+
+void DTLS_PSKKeystore_Free(DTLS_PSKKeystore ** keystore)
+{
+    if ((keystore != NULL) && (*keystore != NULL))
+    {
+        HashTable_Destroy(&(*keystore)->Index);
+        free((*keystore)->Entries);
+        free((*keystore)->Identities);
+        free((*keystore)->Keys);
+        free(*keystore);
+        *keystore = NULL;
+    }
+}
+
+const uint8_t * DTLS_PSKKeystore_Find(const DTLS_PSKKeystore * keystore, const char * identity, size_t identityLength, size_t * keyLength)
+{
+    const uint8_t * key = NULL;
+    KeystoreEntry * entry = FindEntry(keystore, identity, identityLength);
+    if (entry != NULL)
+    {
+        key = &keystore->Keys[entry->KeyOffset];
+        *keyLength = entry->KeyLength;
+    }
+    return key;
+}
+
+size_t DTLS_PSKKeystore_GetCount(const DTLS_PSKKeystore * keystore)
+{
+    return keystore->Count;
+}
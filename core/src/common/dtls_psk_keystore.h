@@ -0,0 +1,57 @@
+/************************************************************************************************************************
+ Copyright (c) 2016, Imagination Technologies Limited and/or its affiliated group companies.
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+ following conditions are met:
+     1. Redistributions of source code must retain the above copyright notice, this list of conditions and the
+        following disclaimer.
+     2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the
+        following disclaimer in the documentation and/or other materials provided with the distribution.
+     3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote
+        products derived from this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+ USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+************************************************************************************************************************/
+
+#ifndef DTLS_PSK_KEYSTORE_H
+#define DTLS_PSK_KEYSTORE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Pre-shared keys for DTLS peers, indexed by PSK identity so a server's PSK lookup costs the same
+ * however many devices it serves. A keystore is loaded from a text file with one IDENTITY:HEXKEY
+ * entry per line; blank lines and lines starting with '#' are ignored. The file is memory-mapped
+ * only while it is parsed; identities and decoded keys are copied into the keystore, so the file may
+ * be edited or truncated in place once it has loaded.
+ * A keystore is immutable once loaded: to reload, load a new one and free the old.
+ */
+
+typedef struct _DTLS_PSKKeystore DTLS_PSKKeystore;
+
+// Returns NULL if the file cannot be read. Invalid lines are skipped with a warning.
+DTLS_PSKKeystore * DTLS_PSKKeystore_Load(const char * path);
+
+void DTLS_PSKKeystore_Free(DTLS_PSKKeystore ** keystore);
+
+// Returns the key for an identity, or NULL if the identity is not in the keystore
+const uint8_t * DTLS_PSKKeystore_Find(const DTLS_PSKKeystore * keystore, const char * identity, size_t identityLength, size_t * keyLength);
+
+size_t DTLS_PSKKeystore_GetCount(const DTLS_PSKKeystore * keystore);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // DTLS_PSK_KEYSTORE_H
@@ -0,0 +1,342 @@
+/************************************************************************************************************************
+ Copyright (c) 2016, Imagination Technologies Limited and/or its affiliated group companies.
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+ following conditions are met:
+     1. Redistributions of source code must retain the above copyright notice, this list of conditions and the
+        following disclaimer.
+     2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the
+        following disclaimer in the documentation and/or other materials provided with the distribution.
+     3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote
+        products derived from this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+ USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+************************************************************************************************************************/
+
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "lwm2m_debug.h"
+#include "dtls_session_table.h"
+
+// DTLS 1.2 record carrying a connection ID (RFC 9146): content type, version, epoch and sequence number precede the CID
+#define DTLS_CONTENT_TYPE_TLS12_CID (25)
+#define DTLS_RECORD_CID_OFFSET      (11)
+
+/* Resumption data is keyed by the hash of the server address rather than by the address itself, as
+ * the NetworkAddress may be freed once the client has disconnected. A hash collision only costs a
+ * failed resumption attempt: the server rejects the session and a full handshake follows.
+ */
+typedef struct
+{
+    HashTableNode Node;
+    struct ListHead List;
+    uint32_t AddressHash;
+    void * Data;
+    size_t Length;
+} ResumptionEntry;
+
+static DTLS_SessionTableEntry * Oldest(DTLS_SessionTable * table)
+{
+    DTLS_SessionTableEntry * entry = NULL;
+    if (table->UseList.Next != &table->UseList)
+    {
+        entry = ListEntry(table->UseList.Next, DTLS_SessionTableEntry, UseList);
+    }
+    return entry;
+}
+
+static void FreeResumption(DTLS_SessionTable * table, ResumptionEntry * resumption)
+{
+    HashTable_Remove(&table->ResumptionIndex, &resumption->Node);
+    ListRemove(&resumption->List);
+    free(resumption->Data);
+    free(resumption);
+}
+
+static ResumptionEntry * FindResumption(DTLS_SessionTable * table, uint32_t addressHash)
+{
+    HashTableNode * node;
+    for (node = HashTable_FindFirst(&table->ResumptionIndex, addressHash); node != NULL; node = HashTable_FindNext(node))
+    {
+        ResumptionEntry * resumption = HashTableEntry(node, ResumptionEntry, Node);
+        if (resumption->AddressHash == addressHash)
+        {
+            return resumption;
+        }
+    }
+    return NULL;
+}
+
+static uint32_t HashConnectionId(const uint8_t * connectionId, size_t length)
+{
+    return HashTable_HashBytes(connectionId, length);
+}
+
+static void Release(DTLS_SessionTable * table, DTLS_SessionTableEntry * entry)
+{
+    DTLS_SessionTable_Remove(table, entry);
+    if (table->Free != NULL)
+    {
+        table->Free(entry);
+    }
+}
+
+void DTLS_SessionTable_Init(DTLS_SessionTable * table, size_t capacity, uint32_t idleTimeoutMs, DTLS_SessionFreeFunction freeFunction)
+{
+    HashTable_Init(&table->AddressIndex);
+    HashTable_Init(&table->ConnectionIdIndex);
+    ListInit(&table->UseList);
+    HashTable_Init(&table->ResumptionIndex);
+    ListInit(&table->ResumptionList);
+    table->Capacity = capacity;
+    table->IdleTimeoutMs = idleTimeoutMs;
+    table->Free = freeFunction;
+    memset(&table->Stats, 0, sizeof(table->Stats));
+}
+
+void DTLS_SessionTable_Destroy(DTLS_SessionTable * table)
+{
+    DTLS_SessionTableEntry * entry;
+    while ((entry = Oldest(table)) != NULL)
+    {
+        Release(table, entry);
+    }
+    while (table->ResumptionList.Next != &table->ResumptionList)
+    {
+        ResumptionEntry * resumption = ListEntry(table->ResumptionList.Next, ResumptionEntry, List);
+        FreeResumption(table, resumption);
+    }
+    HashTable_Destroy(&table->AddressIndex);
+    HashTable_Destroy(&table->ConnectionIdIndex);
+    HashTable_Destroy(&table->ResumptionIndex);
+}
+
+void DTLS_SessionTable_SetLimits(DTLS_SessionTable * table, size_t capacity, uint32_t idleTimeoutMs)
+{
+    table->Capacity = capacity;
+    table->IdleTimeoutMs = idleTimeoutMs;
+    while ((table->Capacity > 0) && (HashTable_Count(&table->AddressIndex) > table->Capacity))
+    {
+        Release(table, Oldest(table));
+        table->Stats.Evictions++;
+    }
+}
+
+DTLS_SessionTableEntry * DTLS_SessionTable_Find(DTLS_SessionTable * table, NetworkAddress * address, uint64_t now)
+{
+    HashTableNode * node;
+    for (node = HashTable_FindFirst(&table->AddressIndex, NetworkAddress_Hash(address)); node != NULL; node = HashTable_FindNext(node))
+    {
+        DTLS_SessionTableEntry * entry = HashTableEntry(node, DTLS_SessionTableEntry, AddressNode);
+        if (NetworkAddress_Compare(entry->Address, address) == 0)
+        {
+            entry->LastUsed = now;
+            ListRemove(&entry->UseList);
+            ListAdd(&entry->UseList, &table->UseList);
+            return entry;
+        }
+    }
+    return NULL;
+}
+
+int DTLS_SessionTable_Add(DTLS_SessionTable * table, DTLS_SessionTableEntry * entry, NetworkAddress * address, uint64_t now)
+{
+    int result = -1;
+
+    if ((table->Capacity > 0) && (HashTable_Count(&table->AddressIndex) >= table->Capacity))
+    {
+        DTLS_SessionTableEntry * oldest = Oldest(table);
+        Lwm2m_Debug("DTLS session table full, evicting least recently used session\n");
+        Release(table, oldest);
+        table->Stats.Evictions++;
+    }
+
+    entry->Address = NetworkAddress_Retain(address);
+    entry->LastUsed = now;
+    entry->ConnectionIdLength = 0;
+    if (HashTable_Insert(&table->AddressIndex, &entry->AddressNode, NetworkAddress_Hash(address)) == 0)
+    {
+        ListAdd(&entry->UseList, &table->UseList);
+        table->Stats.Handshakes++;
+        table->Stats.Live = HashTable_Count(&table->AddressIndex);
+        if (table->Stats.Live > table->Stats.Peak)
+        {
+            table->Stats.Peak = table->Stats.Live;
+        }
+        result = 0;
+    }
+    return result;
+}
+
+void DTLS_SessionTable_Remove(DTLS_SessionTable * table, DTLS_SessionTableEntry * entry)
+{
+    if (HashTable_Remove(&table->AddressIndex, &entry->AddressNode) == 0)
+    {
+        ListRemove(&entry->UseList);
+        if (entry->ConnectionIdLength > 0)
+        {
+            HashTable_Remove(&table->ConnectionIdIndex, &entry->ConnectionIdNode);
+            entry->ConnectionIdLength = 0;
+        }
+        table->Stats.Live = HashTable_Count(&table->AddressIndex);
+    }
+}
+
+void DTLS_SessionTable_Expire(DTLS_SessionTable * table, uint64_t now)
+{
+    DTLS_SessionTableEntry * entry;
+    if (table->IdleTimeoutMs > 0)
+    {
+        // the oldest session is the first to go idle
+        while (((entry = Oldest(table)) != NULL) && (entry->LastUsed + table->IdleTimeoutMs <= now))
+        {
+            Release(table, entry);
+            table->Stats.IdleExpiries++;
+        }
+    }
+}
+
+int DTLS_SessionTable_SetConnectionId(DTLS_SessionTable * table, DTLS_SessionTableEntry * entry, const uint8_t * connectionId, size_t length)
+{
+    int result = -1;
+    if ((length > 0) && (length <= DTLS_MAX_CONNECTION_ID_LENGTH))
+    {
+        if (entry->ConnectionIdLength > 0)
+        {
+            HashTable_Remove(&table->ConnectionIdIndex, &entry->ConnectionIdNode);
+            entry->ConnectionIdLength = 0;
+        }
+        memcpy(entry->ConnectionId, connectionId, length);
+        if (HashTable_Insert(&table->ConnectionIdIndex, &entry->ConnectionIdNode, HashConnectionId(connectionId, length)) == 0)
+        {
+            entry->ConnectionIdLength = length;
+            result = 0;
+        }
+    }
+    return result;
+}
+
+DTLS_SessionTableEntry * DTLS_SessionTable_FindByConnectionId(DTLS_SessionTable * table, const uint8_t * connectionId, size_t length, uint64_t now)
+{
+    HashTableNode * node;
+    for (node = HashTable_FindFirst(&table->ConnectionIdIndex, HashConnectionId(connectionId, length)); node != NULL; node = HashTable_FindNext(node))
+    {
+        DTLS_SessionTableEntry * entry = HashTableEntry(node, DTLS_SessionTableEntry, ConnectionIdNode);
+        if ((entry->ConnectionIdLength == length) && (memcmp(entry->ConnectionId, connectionId, length) == 0))
+        {
+            entry->LastUsed = now;
+            ListRemove(&entry->UseList);
+            ListAdd(&entry->UseList, &table->UseList);
+            return entry;
+        }
+    }
+    return NULL;
+}
+
+void DTLS_SessionTable_Rebind(DTLS_SessionTable * table, DTLS_SessionTableEntry * entry, NetworkAddress * address)
+{
+    HashTableNode * node;
+    for (node = HashTable_FindFirst(&table->AddressIndex, NetworkAddress_Hash(address)); node != NULL; node = HashTable_FindNext(node))
+    {
+        DTLS_SessionTableEntry * existing = HashTableEntry(node, DTLS_SessionTableEntry, AddressNode);
+        if ((existing != entry) && (NetworkAddress_Compare(existing->Address, address) == 0))
+        {
+            Release(table, existing);
+            break;
+        }
+    }
+
+    // the bucket array already exists, so reinserting cannot fail
+    HashTable_Remove(&table->AddressIndex, &entry->AddressNode);
+    NetworkAddress * previous = entry->Address;
+    entry->Address = NetworkAddress_Retain(address);
+    NetworkAddress_Free(&previous);
+    HashTable_Insert(&table->AddressIndex, &entry->AddressNode, NetworkAddress_Hash(address));
+    table->Stats.Rebinds++;
+    table->Stats.Live = HashTable_Count(&table->AddressIndex);
+}
+
+int DTLS_SessionTable_ParseConnectionId(const uint8_t * datagram, int datagramLength, size_t connectionIdLength, const uint8_t ** connectionId)
+{
+    int result = -1;
+    if ((connectionIdLength > 0) && (datagramLength >= (int)(DTLS_RECORD_CID_OFFSET + connectionIdLength)) && (datagram[0] == DTLS_CONTENT_TYPE_TLS12_CID))
+    {
+        *connectionId = &datagram[DTLS_RECORD_CID_OFFSET];
+        result = 0;
+    }
+    return result;
+}
+
+int DTLS_SessionTable_SaveResumption(DTLS_SessionTable * table, NetworkAddress * address, const void * data, size_t length)
+{
+    int result = -1;
+    uint32_t addressHash = NetworkAddress_Hash(address);
+    ResumptionEntry * resumption = FindResumption(table, addressHash);
+    if (resumption != NULL)
+    {
+        FreeResumption(table, resumption);
+    }
+    else if (HashTable_Count(&table->ResumptionIndex) >= DTLS_RESUMPTION_CACHE_SIZE)
+    {
+        resumption = ListEntry(table->ResumptionList.Next, ResumptionEntry, List);
+        FreeResumption(table, resumption);
+    }
+
+    resumption = malloc(sizeof(ResumptionEntry));
+    if (resumption != NULL)
+    {
+        resumption->AddressHash = addressHash;
+        resumption->Length = length;
+        resumption->Data = malloc(length);
+        if ((resumption->Data != NULL) && (HashTable_Insert(&table->ResumptionIndex, &resumption->Node, addressHash) == 0))
+        {
+            memcpy(resumption->Data, data, length);
+            ListAdd(&resumption->List, &table->ResumptionList);
+            result = 0;
+        }
+        else
+        {
+            free(resumption->Data);
+            free(resumption);
+        }
+    }
+    return result;
+}
+
+void * DTLS_SessionTable_TakeResumption(DTLS_SessionTable * table, NetworkAddress * address, size_t * length)
+{
+    void * data = NULL;
+    ResumptionEntry * resumption = FindResumption(table, NetworkAddress_Hash(address));
+    if (resumption != NULL)
+    {
+        data = resumption->Data;
+        *length = resumption->Length;
+        resumption->Data = NULL;
+        FreeResumption(table, resumption);
+    }
+    return data;
+}
+
+void DTLS_SessionTable_CountResumption(DTLS_SessionTable * table)
+{
+    table->Stats.Resumptions++;
+}
+
+size_t DTLS_SessionTable_GetCount(const DTLS_SessionTable * table)
+{
+    return HashTable_Count(&table->AddressIndex);
+}
+
+void DTLS_SessionTable_GetStats(const DTLS_SessionTable * table, DTLS_SessionStats * stats)
+{
+    *stats = table->Stats;
+}
@@ -0,0 +1,144 @@
+/************************************************************************************************************************
+ Copyright (c) 2016, Imagination Technologies Limited and/or its affiliated group companies.
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+ following conditions are met:
+     1. Redistributions of source code must retain the above copyright notice, this list of conditions and the
+        following disclaimer.
+     2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the
+        following disclaimer in the documentation and/or other materials provided with the distribution.
+     3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote
+        products derived from this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+ USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+************************************************************************************************************************/
+
+#ifndef DTLS_SESSION_TABLE_H
+#define DTLS_SESSION_TABLE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "lwm2m_hash_table.h"
+#include "lwm2m_list.h"
+#include "dtls_abstraction.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* DTLS sessions held by a backend, indexed by peer address and kept in least-recently-used order.
+ * Each backend embeds a DTLS_SessionTableEntry in its own session structure and allocates sessions
+ * as peers appear; the table grows with them up to Capacity, beyond which the least recently used
+ * session is evicted to make room. Sessions unused for IdleTimeoutMs are also released.
+ *
+ * Backends that negotiate a DTLS Connection ID (RFC 9146) also index the session by its CID, so a
+ * record from a peer whose address has changed (e.g. after NAT rebinding) can still find its session.
+ * The table also keeps a small cache of resumption data for client sessions, so that reconnecting
+ * to a server can resume the previous session rather than repeat a full handshake.
+ */
+
+#ifndef MAX_DTLS_SESSIONS
+#define MAX_DTLS_SESSIONS (1024)
+#endif
+
+#ifndef DTLS_SESSION_IDLE_TIMEOUT_MS
+#define DTLS_SESSION_IDLE_TIMEOUT_MS (0)
+#endif
+
+#ifndef DTLS_MAX_CONNECTION_ID_LENGTH
+#define DTLS_MAX_CONNECTION_ID_LENGTH (8)
+#endif
+
+// Number of servers whose client session resumption data is kept
+#ifndef DTLS_RESUMPTION_CACHE_SIZE
+#define DTLS_RESUMPTION_CACHE_SIZE (16)
+#endif
+
+typedef struct
+{
+    HashTableNode AddressNode;
+    struct ListHead UseList;
+    NetworkAddress * Address;
+    uint64_t LastUsed;
+    HashTableNode ConnectionIdNode;
+    uint8_t ConnectionId[DTLS_MAX_CONNECTION_ID_LENGTH];
+    size_t ConnectionIdLength;          // 0 if the session has no connection ID
+} DTLS_SessionTableEntry;
+
+#define DTLS_SessionEntry(ptr, type, member) \
+    ((type *)((char *)(ptr) - ((size_t) &((type*)0)->member)))
+
+// Called to release a backend session the table has evicted or expired; it has already been removed
+typedef void (*DTLS_SessionFreeFunction)(DTLS_SessionTableEntry * entry);
+
+typedef struct
+{
+    HashTable AddressIndex;
+    HashTable ConnectionIdIndex;
+    struct ListHead UseList;            // least recently used first
+    HashTable ResumptionIndex;
+    struct ListHead ResumptionList;     // least recently saved first
+    size_t Capacity;                    // 0 for no limit
+    uint32_t IdleTimeoutMs;             // 0 for no idle timeout
+    DTLS_SessionFreeFunction Free;
+    DTLS_SessionStats Stats;
+} DTLS_SessionTable;
+
+void DTLS_SessionTable_Init(DTLS_SessionTable * table, size_t capacity, uint32_t idleTimeoutMs, DTLS_SessionFreeFunction freeFunction);
+
+// Release every session
+void DTLS_SessionTable_Destroy(DTLS_SessionTable * table);
+
+// Change the limits; sessions over a reduced capacity are evicted now
+void DTLS_SessionTable_SetLimits(DTLS_SessionTable * table, size_t capacity, uint32_t idleTimeoutMs);
+
+// Find the session for an address, marking it most recently used
+DTLS_SessionTableEntry * DTLS_SessionTable_Find(DTLS_SessionTable * table, NetworkAddress * address, uint64_t now);
+
+// Add a newly set up session, evicting the least recently used if the table is full. Returns 0 on success, -1 if out of memory.
+// The entry takes a reference to address, which the backend drops with NetworkAddress_Free when it frees the session.
+int DTLS_SessionTable_Add(DTLS_SessionTable * table, DTLS_SessionTableEntry * entry, NetworkAddress * address, uint64_t now);
+
+// Remove a session the backend is about to release itself
+void DTLS_SessionTable_Remove(DTLS_SessionTable * table, DTLS_SessionTableEntry * entry);
+
+// Release sessions that have been idle for longer than the idle timeout
+void DTLS_SessionTable_Expire(DTLS_SessionTable * table, uint64_t now);
+
+// Index a session by the connection ID its peer puts in records sent to us. Returns 0 on success, -1 on failure.
+int DTLS_SessionTable_SetConnectionId(DTLS_SessionTable * table, DTLS_SessionTableEntry * entry, const uint8_t * connectionId, size_t length);
+
+// Find the session for a connection ID, marking it most recently used
+DTLS_SessionTableEntry * DTLS_SessionTable_FindByConnectionId(DTLS_SessionTable * table, const uint8_t * connectionId, size_t length, uint64_t now);
+
+// Move a session to a new peer address, replacing any session already held for that address
+void DTLS_SessionTable_Rebind(DTLS_SessionTable * table, DTLS_SessionTableEntry * entry, NetworkAddress * address);
+
+// If a datagram starts with a DTLS 1.2 record carrying a connection ID of the given length, point connectionId at it and return 0; otherwise return -1.
+int DTLS_SessionTable_ParseConnectionId(const uint8_t * datagram, int datagramLength, size_t connectionIdLength, const uint8_t ** connectionId);
+
+// Keep a client session's resumption data for the server at address, replacing any saved earlier. Returns 0 on success, -1 if out of memory.
+int DTLS_SessionTable_SaveResumption(DTLS_SessionTable * table, NetworkAddress * address, const void * data, size_t length);
+
+// Remove and return the resumption data saved for address, or NULL if there is none. The caller frees the data.
+void * DTLS_SessionTable_TakeResumption(DTLS_SessionTable * table, NetworkAddress * address, size_t * length);
+
+// Count a handshake that resumed an earlier session
+void DTLS_SessionTable_CountResumption(DTLS_SessionTable * table);
+
+size_t DTLS_SessionTable_GetCount(const DTLS_SessionTable * table);
+void DTLS_SessionTable_GetStats(const DTLS_SessionTable * table, DTLS_SessionStats * stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // DTLS_SESSION_TABLE_H
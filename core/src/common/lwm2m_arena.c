@@ -0,0 +1,105 @@
+/************************************************************************************************************************
+ Copyright (c) 2016, Imagination Technologies Limited and/or its affiliated group companies.
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+ following conditions are met:
+     1. Redistributions of source code must retain the above copyright notice, this list of conditions and the
+        following disclaimer.
+     2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the
+        following disclaimer in the documentation and/or other materials provided with the distribution.
+     3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote
+        products derived from this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+ USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+************************************************************************************************************************/
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "lwm2m_arena.h"
+
+typedef union
+{
+    void * Pointer;
+    long long Integer;
+    double Float;
+} MemoryArenaAlignment;
+
+#define ARENA_ALIGNMENT         (sizeof(MemoryArenaAlignment))
+#define ARENA_ALIGN(size)       (((size) + ARENA_ALIGNMENT - 1) & ~(ARENA_ALIGNMENT - 1))
+
+// Heap blocks are chained through a header ahead of their storage
+struct _MemoryArenaBlock
+{
+    MemoryArenaBlock * Next;
+    MemoryArenaAlignment Data[];
+};
+
+static uint8_t * AlignPointer(uint8_t * pointer)
+{
+    return (uint8_t *)ARENA_ALIGN((uintptr_t)pointer);
+}
+
+void MemoryArena_Init(MemoryArena * arena, void * initialBlock, size_t initialBlockSize, size_t blockSize)
+{
+    memset(arena, 0, sizeof(MemoryArena));
+    arena->BlockSize = ARENA_ALIGN(blockSize);
+    if ((initialBlock != NULL) && (initialBlockSize >= ARENA_ALIGNMENT))
+    {
+        arena->Next = AlignPointer(initialBlock);
+        arena->End = (uint8_t *)initialBlock + initialBlockSize;
+    }
+}
+
+void MemoryArena_Destroy(MemoryArena * arena)
+{
+    while (arena->HeapBlocks != NULL)
+    {
+        MemoryArenaBlock * block = arena->HeapBlocks;
+        arena->HeapBlocks = block->Next;
+        free(block);
+    }
+    arena->Next = NULL;
+    arena->End = NULL;
+}
+
+void * MemoryArena_Alloc(MemoryArena * arena, size_t size)
+{
+    void * result = NULL;
+    size = ARENA_ALIGN((size > 0) ? size : 1);
+
+    if ((arena->Next == NULL) || ((size_t)(arena->End - arena->Next) < size))
+    {
+        // Oversized allocations get a block of their own
+        size_t blockSize = (size > arena->BlockSize) ? size : arena->BlockSize;
+        MemoryArenaBlock * block = malloc(sizeof(MemoryArenaBlock) + blockSize);
+        if (block == NULL)
+        {
+            arena->Stats.AllocationFailures++;
+            return NULL;
+        }
+        block->Next = arena->HeapBlocks;
+        arena->HeapBlocks = block;
+        arena->Next = (uint8_t *)block->Data;
+        arena->End = arena->Next + blockSize;
+        arena->Stats.HeapBlocks++;
+    }
+
+    result = arena->Next;
+    arena->Next += size;
+    arena->Stats.Allocations++;
+    arena->Stats.BytesAllocated += size;
+    return result;
+}
+
+void MemoryArena_GetStats(const MemoryArena * arena, MemoryArenaStats * stats)
+{
+    *stats = arena->Stats;
+}
@@ -0,0 +1,77 @@
+/************************************************************************************************************************
+ Copyright (c) 2016, Imagination Technologies Limited and/or its affiliated group companies.
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+ following conditions are met:
+     1. Redistributions of source code must retain the above copyright notice, this list of conditions and the
+        following disclaimer.
+     2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the
+        following disclaimer in the documentation and/or other materials provided with the distribution.
+     3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote
+        products derived from this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+ USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+************************************************************************************************************************/
+
+#ifndef LWM2M_ARENA_H
+#define LWM2M_ARENA_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ *  Bump allocator for data that lives exactly as long as one request. Allocations are carved from
+ *  the current block in order and are never freed individually; MemoryArena_Destroy releases them
+ *  all at once. The first block may be supplied by the caller - typically a buffer on the stack of
+ *  the request handler - so that small requests do not touch the heap at all. Once it is full,
+ *  further blocks of BlockSize bytes are taken from the heap.
+ *
+ *  An arena has no locking, and belongs to the thread handling the request that owns it.
+ */
+
+typedef struct
+{
+    size_t Allocations;                 // successful allocations
+    size_t BytesAllocated;              // bytes handed out, including alignment padding
+    size_t HeapBlocks;                  // blocks taken from the heap
+    size_t AllocationFailures;          // allocations failed by malloc
+} MemoryArenaStats;
+
+typedef struct _MemoryArenaBlock MemoryArenaBlock;
+
+typedef struct
+{
+    size_t BlockSize;
+    uint8_t * Next;                     // free space in the current block
+    uint8_t * End;
+    MemoryArenaBlock * HeapBlocks;      // most recent first
+    MemoryArenaStats Stats;
+} MemoryArena;
+
+// initialBlock may be NULL, in which case the first allocation takes a block from the heap
+void MemoryArena_Init(MemoryArena * arena, void * initialBlock, size_t initialBlockSize, size_t blockSize);
+
+// Release every allocation made from the arena, which is left empty
+void MemoryArena_Destroy(MemoryArena * arena);
+
+// Returns uninitialised memory aligned for any type, or NULL if memory is exhausted
+void * MemoryArena_Alloc(MemoryArena * arena, size_t size);
+
+void MemoryArena_GetStats(const MemoryArena * arena, MemoryArenaStats * stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // LWM2M_ARENA_H
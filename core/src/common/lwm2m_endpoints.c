@@ -31,9 +31,112 @@
 #include "lwm2m_endpoints.h"
 #include "coap_abstraction.h"
 
+static bool IsWildcardPath(const char * path, size_t * prefixLength)
+{
+    size_t length = strlen(path);
+    bool isWildcard = (length >= 2) && (path[length - 2] == '/') && (strcmp(&path[length - 1], ENDPOINT_WILDCARD) == 0);
+    if (isWildcard)
+    {
+        *prefixLength = length - 1;
+    }
+    return isWildcard;
+}
+
+static HashTable * GetIndex(ResourceEndPointList * endPointList, const char * path, uint32_t * hash)
+{
+    HashTable * index;
+    size_t prefixLength;
+    if (IsWildcardPath(path, &prefixLength))
+    {
+        index = &endPointList->WildcardIndex;
+        *hash = HashTable_HashBytes(path, prefixLength);
+    }
+    else
+    {
+        index = &endPointList->ExactIndex;
+        *hash = HashTable_HashString(path);
+    }
+    return index;
+}
+
+// Look up the endpoint registered for the first length characters of path, which need not be null terminated there
+static ResourceEndPoint * FindExact(ResourceEndPointList * endPointList, const char * path, size_t length)
+{
+    HashTableNode * node;
+    for (node = HashTable_FindFirst(&endPointList->ExactIndex, HashTable_HashBytes(path, length)); node != NULL; node = HashTable_FindNext(node))
+    {
+        ResourceEndPoint * endPoint = HashTableEntry(node, ResourceEndPoint, PathNode);
+        if ((strncmp(endPoint->Path, path, length) == 0) && (endPoint->Path[length] == '\0'))
+        {
+            return endPoint;
+        }
+    }
+    return NULL;
+}
+
+// Look up a wildcard endpoint whose prefix matches the first length characters of path, up to its last "/"
+static ResourceEndPoint * FindWildcard(ResourceEndPointList * endPointList, const char * path, size_t length)
+{
+    size_t prefixLength = length;
+    while ((prefixLength > 0) && (path[prefixLength - 1] != '/'))
+    {
+        prefixLength--;
+    }
+
+    // the wildcard segment must not be empty
+    if ((prefixLength > 0) && (prefixLength < length))
+    {
+        HashTableNode * node;
+        for (node = HashTable_FindFirst(&endPointList->WildcardIndex, HashTable_HashBytes(path, prefixLength)); node != NULL; node = HashTable_FindNext(node))
+        {
+            ResourceEndPoint * endPoint = HashTableEntry(node, ResourceEndPoint, PathNode);
+            if ((strncmp(endPoint->Path, path, prefixLength) == 0) && (strcmp(&endPoint->Path[prefixLength], ENDPOINT_WILDCARD) == 0))
+            {
+                return endPoint;
+            }
+        }
+    }
+    return NULL;
+}
+
+// Look up the endpoint registered with exactly this path, which may itself be a wildcard
+static ResourceEndPoint * FindRegistered(ResourceEndPointList * endPointList, const char * path)
+{
+    uint32_t hash;
+    HashTable * index = GetIndex(endPointList, path, &hash);
+    HashTableNode * node;
+    for (node = HashTable_FindFirst(index, hash); node != NULL; node = HashTable_FindNext(node))
+    {
+        ResourceEndPoint * endPoint = HashTableEntry(node, ResourceEndPoint, PathNode);
+        if (strcmp(endPoint->Path, path) == 0)
+        {
+            return endPoint;
+        }
+    }
+    return NULL;
+}
+
+static ResourceEndPoint * FindMatching(ResourceEndPointList * endPointList, const char * path, size_t length)
+{
+    ResourceEndPoint * endPoint = FindExact(endPointList, path, length);
+    if (endPoint == NULL)
+    {
+        endPoint = FindWildcard(endPointList, path, length);
+    }
+    return endPoint;
+}
+
+bool Lwm2mEndPoint_IsWildcardPath(const char * path)
+{
+    size_t prefixLength;
+    return IsWildcardPath(path, &prefixLength);
+}
+
 int Lwm2mEndPoint_InitEndPointList(ResourceEndPointList * endPointList)
 {
     ListInit(&endPointList->EndPoint);
+    HashTable_Init(&endPointList->ExactIndex);
+    HashTable_Init(&endPointList->WildcardIndex);
     return 0;
 }
 
@@ -52,6 +155,8 @@ int Lwm2mEndPoint_DestroyEndPointList(ResourceEndPointList * endPointList)
         free(endPoint->Path);
         free(endPoint);
     }
+    HashTable_Destroy(&endPointList->ExactIndex);
+    HashTable_Destroy(&endPointList->WildcardIndex);
     return 0;
 }
 
@@ -61,67 +166,66 @@ int Lwm2mEndPoint_DestroyEndPointList(ResourceEndPointList * endPointList)
  */
 ResourceEndPoint * Lwm2mEndPoint_FindResourceEndPointAncestors(ResourceEndPointList * endPointList, const char * path)
 {
-    char * element = strdup(path);
-
-    struct ListHead * i;
-    while (strlen(element) > 0)
+    size_t length = strlen(path);
+    while (length > 0)
     {
-        ListForEach(i, &endPointList->EndPoint)
+        ResourceEndPoint * endPoint = FindMatching(endPointList, path, length);
+        if (endPoint != NULL)
         {
-            ResourceEndPoint * endPoint = ListEntry(i, ResourceEndPoint, list);
-            if (!strcmp(endPoint->Path, element))
-            {
-                free(element);
-                return endPoint;
-            }
+            return endPoint;
         }
+
         // strip path back to previous "/"
-        char * pos = strrchr(element, '/');
-        if (pos != NULL)
+        while ((length > 0) && (path[length - 1] != '/'))
         {
-            *pos = 0; // null terminate at last "/"
+            length--;
         }
-        else
+        if (length == 0)
         {
             break;
         }
+        length--;
     }
-    free(element);
     return NULL;
 }
 
 ResourceEndPoint * Lwm2mEndPoint_FindResourceEndPoint(ResourceEndPointList * endPointList, const char * path)
 {
-    struct ListHead * i;
-    ListForEach(i, &endPointList->EndPoint)
-    {
-        ResourceEndPoint * endPoint = ListEntry(i, ResourceEndPoint, list);
-        if (!strcmp(endPoint->Path, path))
-        {
-            return endPoint;
-        }
-    }
-    return NULL;
+    return FindMatching(endPointList, path, strlen(path));
 }
 
 int Lwm2mEndPoint_AddResourceEndPoint(ResourceEndPointList * endPointList, const char * path, EndpointHandlerFunction handler)
 {
     int result = -1;
-    ResourceEndPoint * endPoint = Lwm2mEndPoint_FindResourceEndPoint(endPointList, path);
+    ResourceEndPoint * endPoint = FindRegistered(endPointList, path);
 
     if (endPoint == NULL)
     {
         endPoint = malloc(sizeof(ResourceEndPoint));
         if (endPoint != NULL)
         {
+            uint32_t hash;
+            HashTable * index = GetIndex(endPointList, path, &hash);
+
             endPoint->Root = strdup("/");
             endPoint->Path = strdup(path);
             endPoint->Handler = handler;
 
-            ListAdd(&endPoint->list, &endPointList->EndPoint);
+            if (HashTable_Insert(index, &endPoint->PathNode, hash) == 0)
+            {
+                ListAdd(&endPoint->list, &endPointList->EndPoint);
 
-            coap_RegisterUri(path);
-            result = 0;
+                coap_RegisterUri(path);
+                result = 0;
+            }
+            else
+            {
+                Lwm2m_Error("Unable to index Resource end point %s\n", path);
+                free(endPoint->Root);
+                free(endPoint->Path);
+                free(endPoint);
+                result = -1;
+            }
         }
         else
         {
@@ -141,10 +245,12 @@ int Lwm2mEndPoint_AddResourceEndPoint(ResourceEndPointList * endPointList, const
 int Lwm2mEndPoint_RemoveResourceEndPoint(ResourceEndPointList * endPointList, const char * path)
 {
     int result = -1;
-    ResourceEndPoint * endPoint = Lwm2mEndPoint_FindResourceEndPoint(endPointList, path);
+    ResourceEndPoint * endPoint = FindRegistered(endPointList, path);
 
     if (endPoint != NULL)
     {
+        uint32_t hash;
+        HashTable_Remove(GetIndex(endPointList, path, &hash), &endPoint->PathNode);
         ListRemove(&endPoint->list);
 
         coap_DeregisterUri(path);
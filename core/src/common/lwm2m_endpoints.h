@@ -30,6 +30,7 @@
 #include <stdint.h>
 
 #include "lwm2m_list.h"
+#include "lwm2m_hash_table.h"
 #include "lwm2m_debug.h"
 #include "lwm2m_types.h"
 
@@ -40,9 +41,15 @@ extern "C" {
 typedef int (*EndpointHandlerFunction)(int type, void * ctxt, AddressType * addr, const char * path, const char * query, const char * token,
                                        int tokenLength, AwaContentType contentType, const char * requestContent, size_t requestContentLen,
                                        AwaContentType * responseContentType, char * responseContent, size_t * responseContentLen, int * responseCode);
+
+// An endpoint path whose last segment is ENDPOINT_WILDCARD matches any single path segment in its place,
+// e.g. "/rd/" ENDPOINT_WILDCARD matches "/rd/1" and "/rd/42", but not "/rd" or "/rd/1/2". Exact paths take precedence.
+#define ENDPOINT_WILDCARD "*"
+
 typedef struct
 {
     struct ListHead     list;  // Next/Prev pointers
+    HashTableNode PathNode;    // Exact or wildcard path index
     char * Root;               // "/" by default, or "/lwm2m"
     char * Path;
     EndpointHandlerFunction Handler;
@@ -52,6 +59,8 @@ typedef struct
 typedef struct
 {
     struct ListHead EndPoint;
+    HashTable ExactIndex;      // keyed on the full path
+    HashTable WildcardIndex;   // keyed on the path up to and including the last "/", without the "*"
 
 } ResourceEndPointList;
 
@@ -64,6 +73,8 @@ ResourceEndPoint * Lwm2mEndPoint_FindResourceEndPointAncestors(ResourceEndPointL
 int Lwm2mEndPoint_AddResourceEndPoint(ResourceEndPointList * endPointList, const char * path, EndpointHandlerFunction handler);
 int Lwm2mEndPoint_RemoveResourceEndPoint(ResourceEndPointList * endPointList, const char * path);
 
+bool Lwm2mEndPoint_IsWildcardPath(const char * path);
+
 #ifdef __cplusplus
 }
 #endif
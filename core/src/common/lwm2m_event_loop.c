@@ -0,0 +1,342 @@
+/************************************************************************************************************************
+ Copyright (c) 2016, Imagination Technologies Limited and/or its affiliated group companies.
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+ following conditions are met:
+     1. Redistributions of source code must retain the above copyright notice, this list of conditions and the
+        following disclaimer.
+     2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the
+        following disclaimer in the documentation and/or other materials provided with the distribution.
+     3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote
+        products derived from this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+ USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+************************************************************************************************************************/
+
+
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/timerfd.h>
+
+#include "lwm2m_debug.h"
+#include "lwm2m_util.h"
+#include "lwm2m_list.h"
+#include "lwm2m_hash_table.h"
+#include "lwm2m_event_loop.h"
+
+#define EVENT_LOOP_MAX_EVENTS (32)      // fd events collected per wait
+
+typedef struct
+{
+    HashTableNode Node;                 // in Watches, by fd
+    struct ListHead Removed;            // in Removed once the fd is no longer watched
+    int Fd;
+    EventLoop_FdCallback Callback;      // NULL once removed
+    void * Context;
+} EventLoopWatch;
+
+struct _EventLoop
+{
+    int EpollFd;
+    int TimerFd;
+    uint64_t ArmedDeadline;             // deadline the timerfd is set for, 0 if disarmed
+    HashTable Watches;
+    struct ListHead Removed;            // watches removed while dispatching, freed once the wakeup's events are done
+    bool Dispatching;
+    TimerQueue Timers;
+    EventLoopStats Stats;
+};
+
+static EventLoopWatch * FindWatch(const EventLoop * loop, int fd)
+{
+    HashTableNode * node;
+    for (node = HashTable_FindFirst(&loop->Watches, HashTable_HashUInt32(fd)); node != NULL; node = HashTable_FindNext(node))
+    {
+        EventLoopWatch * watch = HashTableEntry(node, EventLoopWatch, Node);
+        if (watch->Fd == fd)
+        {
+            return watch;
+        }
+    }
+    return NULL;
+}
+
+static void FreeRemovedWatches(EventLoop * loop)
+{
+    struct ListHead * i, * n;
+    ListForEachSafe(i, n, &loop->Removed)
+    {
+        EventLoopWatch * watch = ListEntry(i, EventLoopWatch, Removed);
+        ListRemove(&watch->Removed);
+        free(watch);
+    }
+}
+
+// Point the timerfd at the earliest timer. Returns how long the wait may last for the timers' sake:
+// -1 if the timerfd will end it, 0 if a timer is already due.
+static int ArmTimerFd(EventLoop * loop, uint64_t now)
+{
+    int result = -1;
+    TimerQueueNode * next = TimerQueue_Peek(&loop->Timers);
+    uint64_t deadline = (next != NULL) ? next->Deadline : 0;
+
+    if ((next != NULL) && (deadline <= now))
+    {
+        result = 0;
+    }
+    else if (deadline != loop->ArmedDeadline)
+    {
+        struct itimerspec setting;
+        memset(&setting, 0, sizeof(setting));
+        if (next != NULL)
+        {
+            uint64_t delay = deadline - now;
+            setting.it_value.tv_sec = delay / 1000;
+            setting.it_value.tv_nsec = (delay % 1000) * 1000000;
+            loop->Stats.TimerfdArms++;
+        }
+        if (timerfd_settime(loop->TimerFd, 0, &setting, NULL) == 0)
+        {
+            loop->ArmedDeadline = deadline;
+        }
+        else
+        {
+            Lwm2m_Error("Failed to set event loop timer: %s\n", strerror(errno));
+            loop->ArmedDeadline = 0;
+            result = TimerQueue_GetTimeout(&loop->Timers, now);
+        }
+    }
+    return result;
+}
+
+static int RunTimers(EventLoop * loop)
+{
+    int run = 0;
+    uint64_t now = Lwm2mCore_GetTickCountMs();
+    // a timer restarted with no delay from its own callback runs on the next wakeup, not again now
+    size_t limit = TimerQueue_Count(&loop->Timers);
+    TimerQueueNode * node;
+
+    while (((size_t)run < limit) && ((node = TimerQueue_PopExpired(&loop->Timers, now)) != NULL))
+    {
+        EventLoopTimer * timer = TimerQueueEntry(node, EventLoopTimer, Node);
+        timer->Callback(loop, timer->Context);
+        run++;
+    }
+    loop->Stats.TimersRun += run;
+    return run;
+}
+
+EventLoop * EventLoop_New(void)
+{
+    EventLoop * loop = (EventLoop *)malloc(sizeof(*loop));
+    if (loop != NULL)
+    {
+        memset(loop, 0, sizeof(*loop));
+        HashTable_Init(&loop->Watches);
+        ListInit(&loop->Removed);
+        TimerQueue_Init(&loop->Timers);
+        loop->EpollFd = epoll_create1(EPOLL_CLOEXEC);
+        loop->TimerFd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+
+        struct epoll_event event;
+        memset(&event, 0, sizeof(event));
+        event.events = EPOLLIN;
+        event.data.ptr = NULL;          // the timerfd is the only fd without a watch
+
+        if ((loop->EpollFd < 0) || (loop->TimerFd < 0) || (epoll_ctl(loop->EpollFd, EPOLL_CTL_ADD, loop->TimerFd, &event) != 0))
+        {
+            Lwm2m_Error("Failed to create event loop: %s\n", strerror(errno));
+            EventLoop_Free(&loop);
+        }
+    }
+    return loop;
+}
+
+void EventLoop_Free(EventLoop ** loop)
+{
+    if ((loop != NULL) && (*loop != NULL))
+    {
+        HashTableNode * node;
+        while ((node = HashTable_First(&(*loop)->Watches)) != NULL)
+        {
+            HashTable_Remove(&(*loop)->Watches, node);
+            free(HashTableEntry(node, EventLoopWatch, Node));
+        }
+        FreeRemovedWatches(*loop);
+        HashTable_Destroy(&(*loop)->Watches);
+        TimerQueue_Destroy(&(*loop)->Timers);
+        if ((*loop)->TimerFd >= 0)
+        {
+            close((*loop)->TimerFd);
+        }
+        if ((*loop)->EpollFd >= 0)
+        {
+            close((*loop)->EpollFd);
+        }
+        free(*loop);
+        *loop = NULL;
+    }
+}
+
+int EventLoop_AddFd(EventLoop * loop, int fd, EventLoop_FdCallback callback, void * context)
+{
+    int result = -1;
+    if ((loop != NULL) && (fd >= 0) && (callback != NULL) && (FindWatch(loop, fd) == NULL))
+    {
+        EventLoopWatch * watch = (EventLoopWatch *)malloc(sizeof(*watch));
+        if (watch != NULL)
+        {
+            struct epoll_event event;
+            memset(&event, 0, sizeof(event));
+            event.events = EPOLLIN;
+            event.data.ptr = watch;
+
+            memset(watch, 0, sizeof(*watch));
+            ListInit(&watch->Removed);
+            watch->Fd = fd;
+            watch->Callback = callback;
+            watch->Context = context;
+
+            if (HashTable_Insert(&loop->Watches, &watch->Node, HashTable_HashUInt32(fd)) != 0)
+            {
+                free(watch);
+            }
+            else if (epoll_ctl(loop->EpollFd, EPOLL_CTL_ADD, fd, &event) != 0)
+            {
+                Lwm2m_Error("Failed to watch fd %d: %s\n", fd, strerror(errno));
+                HashTable_Remove(&loop->Watches, &watch->Node);
+                free(watch);
+            }
+            else
+            {
+                result = 0;
+            }
+        }
+    }
+    return result;
+}
+
+int EventLoop_RemoveFd(EventLoop * loop, int fd)
+{
+    int result = -1;
+    EventLoopWatch * watch = (loop != NULL) ? FindWatch(loop, fd) : NULL;
+    if (watch != NULL)
+    {
+        // the fd may already be closed, which removed it from the epoll set
+        epoll_ctl(loop->EpollFd, EPOLL_CTL_DEL, fd, NULL);
+        HashTable_Remove(&loop->Watches, &watch->Node);
+        watch->Callback = NULL;
+        if (loop->Dispatching)
+        {
+            // an event for it may still be waiting in this wakeup's batch
+            ListAdd(&watch->Removed, &loop->Removed);
+        }
+        else
+        {
+            free(watch);
+        }
+        result = 0;
+    }
+    return result;
+}
+
+void EventLoop_InitTimer(EventLoopTimer * timer, EventLoop_TimerCallback callback, void * context)
+{
+    TimerQueue_InitNode(&timer->Node);
+    timer->Callback = callback;
+    timer->Context = context;
+}
+
+int EventLoop_StartTimer(EventLoop * loop, EventLoopTimer * timer, int delay)
+{
+    int result = 0;
+    if (delay < 0)
+    {
+        EventLoop_StopTimer(loop, timer);
+    }
+    else
+    {
+        result = TimerQueue_Schedule(&loop->Timers, &timer->Node, Lwm2mCore_GetTickCountMs() + delay);
+    }
+    return result;
+}
+
+void EventLoop_StopTimer(EventLoop * loop, EventLoopTimer * timer)
+{
+    TimerQueue_Cancel(&loop->Timers, &timer->Node);
+}
+
+bool EventLoop_IsTimerRunning(const EventLoopTimer * timer)
+{
+    return TimerQueue_IsScheduled(&timer->Node);
+}
+
+int EventLoop_RunOnce(EventLoop * loop, int timeout)
+{
+    struct epoll_event events[EVENT_LOOP_MAX_EVENTS];
+    int run = 0;
+    int count;
+    int i;
+
+    int timerTimeout = ArmTimerFd(loop, Lwm2mCore_GetTickCountMs());
+    if ((timerTimeout >= 0) && ((timeout < 0) || (timerTimeout < timeout)))
+    {
+        // a timer is already due, or the timerfd could not be set for it
+        timeout = timerTimeout;
+    }
+
+    count = epoll_wait(loop->EpollFd, events, EVENT_LOOP_MAX_EVENTS, timeout);
+    if (count < 0)
+    {
+        return -1;
+    }
+
+    loop->Dispatching = true;
+    for (i = 0; i < count; i++)
+    {
+        EventLoopWatch * watch = (EventLoopWatch *)events[i].data.ptr;
+        if (watch == NULL)
+        {
+            uint64_t expirations;
+            if (read(loop->TimerFd, &expirations, sizeof(expirations)) < 0)
+            {
+                // nothing to clear; the timers are checked below regardless
+            }
+            loop->ArmedDeadline = 0;
+        }
+        else if (watch->Callback != NULL)
+        {
+            watch->Callback(loop, watch->Fd, watch->Context);
+            loop->Stats.FdEvents++;
+            run++;
+        }
+    }
+    loop->Dispatching = false;
+    FreeRemovedWatches(loop);
+
+    run += RunTimers(loop);
+    if (run > 0)
+    {
+        loop->Stats.Wakeups++;
+    }
+    return run;
+}
+
+void EventLoop_GetStats(const EventLoop * loop, EventLoopStats * stats)
+{
+    if ((loop != NULL) && (stats != NULL))
+    {
+        *stats = loop->Stats;
+    }
+}
@@ -0,0 +1,91 @@
+/************************************************************************************************************************
+ Copyright (c) 2016, Imagination Technologies Limited and/or its affiliated group companies.
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+ following conditions are met:
+     1. Redistributions of source code must retain the above copyright notice, this list of conditions and the
+        following disclaimer.
+     2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the
+        following disclaimer in the documentation and/or other materials provided with the distribution.
+     3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote
+        products derived from this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+ USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+************************************************************************************************************************/
+
+
+#ifndef LWM2M_EVENT_LOOP_H
+#define LWM2M_EVENT_LOOP_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "lwm2m_timer_queue.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ *  Event loop shared by the daemons. File descriptors are watched with epoll, and timers are kept in
+ *  a TimerQueue behind one timerfd armed for the earliest deadline, so a wait lasts exactly until an
+ *  fd is readable or a timer is due, however many of either are registered. Timers are embedded in
+ *  their owner, like TimerQueueNode, and are run after the fd callbacks of the same wakeup, so an fd
+ *  callback can defer follow-up work to a timer started with no delay. Linux only.
+ */
+
+typedef struct _EventLoop EventLoop;
+
+typedef void (*EventLoop_FdCallback)(EventLoop * loop, int fd, void * context);
+typedef void (*EventLoop_TimerCallback)(EventLoop * loop, void * context);
+
+typedef struct
+{
+    TimerQueueNode Node;
+    EventLoop_TimerCallback Callback;
+    void * Context;
+} EventLoopTimer;
+
+typedef struct
+{
+    unsigned long Wakeups;              // waits that ended with something to do
+    unsigned long FdEvents;             // fd callbacks run
+    unsigned long TimersRun;            // timer callbacks run
+    unsigned long TimerfdArms;          // timerfd reprogrammed for a new earliest deadline
+} EventLoopStats;
+
+EventLoop * EventLoop_New(void);
+void EventLoop_Free(EventLoop ** loop);
+
+// Call back whenever fd is readable, until removed. Returns 0 on success, -1 on error (including fd already added).
+int EventLoop_AddFd(EventLoop * loop, int fd, EventLoop_FdCallback callback, void * context);
+
+// Stop watching fd. Safe to call from any callback, including the fd's own. Returns 0 on success, -1 if not found.
+int EventLoop_RemoveFd(EventLoop * loop, int fd);
+
+void EventLoop_InitTimer(EventLoopTimer * timer, EventLoop_TimerCallback callback, void * context);
+
+// Run the timer's callback after delay milliseconds, rescheduling it if already started. A negative delay stops it.
+// Returns 0 on success, -1 if out of memory.
+int EventLoop_StartTimer(EventLoop * loop, EventLoopTimer * timer, int delay);
+void EventLoop_StopTimer(EventLoop * loop, EventLoopTimer * timer);
+bool EventLoop_IsTimerRunning(const EventLoopTimer * timer);
+
+// Wait up to timeout milliseconds (-1 for no limit) for a readable fd or a due timer, then run their callbacks.
+// Returns the number of callbacks run, or -1 if the wait failed (errno is EINTR if a signal interrupted it).
+int EventLoop_RunOnce(EventLoop * loop, int timeout);
+
+void EventLoop_GetStats(const EventLoop * loop, EventLoopStats * stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // LWM2M_EVENT_LOOP_H
@@ -0,0 +1,209 @@
+/************************************************************************************************************************
+ Copyright (c) 2016, Imagination Technologies Limited and/or its affiliated group companies.
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+ following conditions are met:
+     1. Redistributions of source code must retain the above copyright notice, this list of conditions and the
+        following disclaimer.
+     2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the
+        following disclaimer in the documentation and/or other materials provided with the distribution.
+     3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote
+        products derived from this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+ USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+************************************************************************************************************************/
+
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "lwm2m_hash_table.h"
+
+#define HASH_TABLE_INITIAL_BUCKETS (16)
+
+#define FNV_OFFSET_BASIS (2166136261u)
+#define FNV_PRIME        (16777619u)
+
+static size_t BucketIndex(const HashTable * table, uint32_t hash)
+{
+    return hash & (table->BucketCount - 1);
+}
+
+static int Resize(HashTable * table, size_t bucketCount)
+{
+    int result = -1;
+    HashTableNode ** buckets = calloc(bucketCount, sizeof(HashTableNode *));
+    if (buckets != NULL)
+    {
+        size_t i;
+        for (i = 0; i < table->BucketCount; i++)
+        {
+            HashTableNode * node = table->Buckets[i];
+            while (node != NULL)
+            {
+                HashTableNode * next = node->Next;
+                size_t index = node->Hash & (bucketCount - 1);
+                node->Next = buckets[index];
+                buckets[index] = node;
+                node = next;
+            }
+        }
+        free(table->Buckets);
+        table->Buckets = buckets;
+        table->BucketCount = bucketCount;
+        result = 0;
+    }
+    return result;
+}
+
+void HashTable_Init(HashTable * table)
+{
+    table->Buckets = NULL;
+    table->BucketCount = 0;
+    table->Count = 0;
+}
+
+void HashTable_Destroy(HashTable * table)
+{
+    free(table->Buckets);
+    HashTable_Init(table);
+}
+
+int HashTable_Insert(HashTable * table, HashTableNode * node, uint32_t hash)
+{
+    int result = 0;
+
+    if (table->BucketCount == 0)
+    {
+        result = Resize(table, HASH_TABLE_INITIAL_BUCKETS);
+    }
+    else if (table->Count >= table->BucketCount)
+    {
+        // Keep the load factor at or below 1. If growing fails the table still works, just with longer chains.
+        Resize(table, table->BucketCount * 2);
+    }
+
+    if (result == 0)
+    {
+        size_t index = BucketIndex(table, hash);
+        node->Hash = hash;
+        node->Next = table->Buckets[index];
+        table->Buckets[index] = node;
+        table->Count++;
+    }
+    return result;
+}
+
+int HashTable_Remove(HashTable * table, HashTableNode * node)
+{
+    int result = -1;
+    if (table->BucketCount > 0)
+    {
+        HashTableNode ** link = &table->Buckets[BucketIndex(table, node->Hash)];
+        while (*link != NULL)
+        {
+            if (*link == node)
+            {
+                *link = node->Next;
+                node->Next = NULL;
+                table->Count--;
+                result = 0;
+                break;
+            }
+            link = &(*link)->Next;
+        }
+    }
+    return result;
+}
+
+HashTableNode * HashTable_FindFirst(const HashTable * table, uint32_t hash)
+{
+    HashTableNode * node = NULL;
+    if (table->BucketCount > 0)
+    {
+        node = table->Buckets[BucketIndex(table, hash)];
+        while ((node != NULL) && (node->Hash != hash))
+        {
+            node = node->Next;
+        }
+    }
+    return node;
+}
+
+HashTableNode * HashTable_FindNext(const HashTableNode * node)
+{
+    HashTableNode * next = node->Next;
+    while ((next != NULL) && (next->Hash != node->Hash))
+    {
+        next = next->Next;
+    }
+    return next;
+}
+
+static HashTableNode * FirstInBucketFrom(const HashTable * table, size_t index)
+{
+    HashTableNode * node = NULL;
+    for (; (index < table->BucketCount) && (node == NULL); index++)
+    {
+        node = table->Buckets[index];
+    }
+    return node;
+}
+
+HashTableNode * HashTable_First(const HashTable * table)
+{
+    return FirstInBucketFrom(table, 0);
+}
+
+HashTableNode * HashTable_Next(const HashTable * table, const HashTableNode * node)
+{
+    return (node->Next != NULL) ? node->Next : FirstInBucketFrom(table, BucketIndex(table, node->Hash) + 1);
+}
+
+size_t HashTable_Count(const HashTable * table)
+{
+    return table->Count;
+}
+
+// 32-bit FNV-1a
+uint32_t HashTable_HashBytes(const void * data, size_t length)
+{
+    const uint8_t * bytes = data;
+    uint32_t hash = FNV_OFFSET_BASIS;
+    size_t i;
+    for (i = 0; i < length; i++)
+    {
+        hash ^= bytes[i];
+        hash *= FNV_PRIME;
+    }
+    return hash;
+}
+
+uint32_t HashTable_HashString(const char * string)
+{
+    uint32_t hash = FNV_OFFSET_BASIS;
+    while (*string != '\0')
+    {
+        hash ^= (uint8_t)*string++;
+        hash *= FNV_PRIME;
+    }
+    return hash;
+}
+
+// Integer finaliser from MurmurHash3, spreads sequential IDs across buckets
+uint32_t HashTable_HashUInt32(uint32_t value)
+{
+    value ^= value >> 16;
+    value *= 0x85ebca6bu;
+    value ^= value >> 13;
+    value *= 0xc2b2ae35u;
+    value ^= value >> 16;
+    return value;
+}
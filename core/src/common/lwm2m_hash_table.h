@@ -0,0 +1,99 @@
+/************************************************************************************************************************
+ Copyright (c) 2016, Imagination Technologies Limited and/or its affiliated group companies.
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+ following conditions are met:
+     1. Redistributions of source code must retain the above copyright notice, this list of conditions and the
+        following disclaimer.
+     2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the
+        following disclaimer in the documentation and/or other materials provided with the distribution.
+     3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote
+        products derived from this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+ USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+************************************************************************************************************************/
+
+
+#ifndef LWM2M_HASH_TABLE_H
+#define LWM2M_HASH_TABLE_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ *  Intrusive chained hash table. Like ListHead, the node is embedded in the indexed structure, so
+ *  insertion and removal never allocate per entry. The caller supplies the hash of the key and
+ *  compares keys itself while walking the nodes that share that hash:
+ *
+ *     struct {
+ *         HashTableNode NameNode;
+ *         char * Name;
+ *     } Entry;
+ *
+ *     HashTable_Insert(&table, &entry->NameNode, HashTable_HashString(entry->Name));
+ *
+ *     HashTableNode * node;
+ *     for (node = HashTable_FindFirst(&table, hash); node != NULL; node = HashTable_FindNext(node))
+ *     {
+ *         Entry * entry = HashTableEntry(node, Entry, NameNode);
+ *         if (strcmp(entry->Name, name) == 0) ...
+ *     }
+ */
+
+typedef struct _HashTableNode
+{
+    struct _HashTableNode * Next;
+    uint32_t Hash;
+} HashTableNode;
+
+typedef struct
+{
+    HashTableNode ** Buckets;
+    size_t BucketCount;                 // always zero or a power of two
+    size_t Count;
+} HashTable;
+
+#define HashTableEntry(ptr, type, member) \
+    ((type *)((char *)(ptr) - ((size_t) &((type*)0)->member)))
+
+// Initialise an empty table. Buckets are allocated lazily on the first insert.
+void HashTable_Init(HashTable * table);
+
+// Release the bucket array. Entries are owned by the caller and are not freed.
+void HashTable_Destroy(HashTable * table);
+
+// Returns 0 on success, -1 if the bucket array could not be allocated.
+int HashTable_Insert(HashTable * table, HashTableNode * node, uint32_t hash);
+
+// Returns 0 if the node was found and removed, -1 otherwise.
+int HashTable_Remove(HashTable * table, HashTableNode * node);
+
+HashTableNode * HashTable_FindFirst(const HashTable * table, uint32_t hash);
+HashTableNode * HashTable_FindNext(const HashTableNode * node);
+
+// Iterate over every node in the table, in no particular order. Nodes must not be inserted while iterating.
+HashTableNode * HashTable_First(const HashTable * table);
+HashTableNode * HashTable_Next(const HashTable * table, const HashTableNode * node);
+
+size_t HashTable_Count(const HashTable * table);
+
+uint32_t HashTable_HashBytes(const void * data, size_t length);
+uint32_t HashTable_HashString(const char * string);
+uint32_t HashTable_HashUInt32(uint32_t value);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // LWM2M_HASH_TABLE_H
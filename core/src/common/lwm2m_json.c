@@ -510,7 +510,7 @@ static int JsonSerialiseObject(SerdesContext * serdesContext, Lwm2mTreeNode * no
     return pos;
 }
 
-static Lwm2mTreeNode * AddObjectNode(Lwm2mTreeNode * root, const DefinitionRegistry * registry, ObjectIDType objectID)
+static Lwm2mTreeNode * AddObjectNode(Lwm2mTreeNode * root, MemoryArena * arena, const DefinitionRegistry * registry, ObjectIDType objectID)
 {
     Lwm2mTreeNode * objectNode = (root != NULL) ? Lwm2mTreeNode_FindNode(root, objectID) : NULL;
     if (objectNode == NULL)
@@ -523,7 +523,7 @@ static Lwm2mTreeNode * AddObjectNode(Lwm2mTreeNode * root, const DefinitionRegis
             return NULL;
         }
 
-        objectNode = Lwm2mTreeNode_Create();
+        objectNode = Lwm2mTreeNode_CreateInArena(arena);
         Lwm2mTreeNode_SetID(objectNode, objectID);
         Lwm2mTreeNode_SetType(objectNode, Lwm2mTreeNodeType_Object);
 
@@ -543,13 +543,13 @@ static Lwm2mTreeNode * AddObjectNode(Lwm2mTreeNode * root, const DefinitionRegis
     return objectNode;
 }
 
-static Lwm2mTreeNode * AddObjectInstanceNode(Lwm2mTreeNode * objectNode, const DefinitionRegistry * registry, ObjectIDType instanceID)
+static Lwm2mTreeNode * AddObjectInstanceNode(Lwm2mTreeNode * objectNode, MemoryArena * arena, const DefinitionRegistry * registry, ObjectIDType instanceID)
 {
     // Lookup instance node and create it if it doesn't exist.
     Lwm2mTreeNode * instanceNode = (objectNode != NULL) ? Lwm2mTreeNode_FindNode(objectNode, instanceID) : NULL;
     if (instanceNode == NULL)
     {
-        instanceNode = Lwm2mTreeNode_Create();
+        instanceNode = Lwm2mTreeNode_CreateInArena(arena);
         Lwm2mTreeNode_SetID(instanceNode, instanceID);
         Lwm2mTreeNode_SetType(instanceNode, Lwm2mTreeNodeType_ObjectInstance);
         Lwm2mTreeNode_SetDefinition(instanceNode, Lwm2mTreeNode_GetDefinition(objectNode));
@@ -562,7 +562,7 @@ static Lwm2mTreeNode * AddObjectInstanceNode(Lwm2mTreeNode * objectNode, const D
     return instanceNode;
 }
 
-static Lwm2mTreeNode * AddResourceNode(Lwm2mTreeNode * instanceNode, const DefinitionRegistry * registry, ObjectIDType objectID, ResourceIDType resourceID)
+static Lwm2mTreeNode * AddResourceNode(Lwm2mTreeNode * instanceNode, MemoryArena * arena, const DefinitionRegistry * registry, ObjectIDType objectID, ResourceIDType resourceID)
 {
     Lwm2mTreeNode * resourceNode = (instanceNode != NULL) ? Lwm2mTreeNode_FindNode(instanceNode, resourceID) : NULL;
     if (resourceNode == NULL)
@@ -575,7 +575,7 @@ static Lwm2mTreeNode * AddResourceNode(Lwm2mTreeNode * instanceNode, const Defin
             return NULL;
         }
 
-        resourceNode = Lwm2mTreeNode_Create();
+        resourceNode = Lwm2mTreeNode_CreateInArena(arena);
         Lwm2mTreeNode_SetID(resourceNode, resourceID);
         Lwm2mTreeNode_SetType(resourceNode, Lwm2mTreeNodeType_Resource);
 
@@ -595,7 +595,7 @@ static Lwm2mTreeNode * AddResourceNode(Lwm2mTreeNode * instanceNode, const Defin
     return resourceNode;
 }
 
-static int JsonDeserialise(Lwm2mTreeNode ** dest, const DefinitionRegistry * registry, ObjectIDType objectID,
+static int JsonDeserialise(Lwm2mTreeNode ** dest, MemoryArena * arena, const DefinitionRegistry * registry, ObjectIDType objectID,
                            ObjectInstanceIDType instanceID, ResourceIDType resourceID, const uint8_t * buf, int bufferLen)
 {
     int result;
@@ -635,7 +635,7 @@ static int JsonDeserialise(Lwm2mTreeNode ** dest, const DefinitionRegistry * reg
         strncpy(basename, JsonTokenToString(buffer, t), BASENAME_SIZE);
         basename[BASENAME_SIZE - 1] = '\0'; // Defensive
 
-        *dest = Lwm2mTreeNode_Create();
+        *dest = Lwm2mTreeNode_CreateInArena(arena);
         Lwm2mTreeNode_SetType(*dest, Lwm2mTreeNodeType_Root);
     }
     else
@@ -643,19 +643,19 @@ static int JsonDeserialise(Lwm2mTreeNode ** dest, const DefinitionRegistry * reg
         if (resourceID != -1)
         {
             sprintf(basename, "/%d/%d/%d/", objectID, instanceID, resourceID);
-            *dest = AddResourceNode(NULL, registry, objectID, resourceID);
+            *dest = AddResourceNode(NULL, arena, registry, objectID, resourceID);
         }
         else
         {
             if (instanceID != -1)
             {
                 sprintf(basename, "/%d/%d/", objectID, instanceID);
-                *dest = AddObjectInstanceNode(NULL, registry, objectID);
+                *dest = AddObjectInstanceNode(NULL, arena, registry, objectID);
             }
             else
             {
                 sprintf(basename, "/%d/", objectID);
-                *dest = AddObjectNode(NULL, registry, objectID);
+                *dest = AddObjectNode(NULL, arena, registry, objectID);
             }
         }
     }
@@ -730,19 +730,19 @@ static int JsonDeserialise(Lwm2mTreeNode ** dest, const DefinitionRegistry * reg
 
             if (Lwm2mTreeNode_GetType(*dest) == Lwm2mTreeNodeType_Root)
             {
-                Lwm2mTreeNode * objectNode = AddObjectNode(*dest, registry, objectID);
-                Lwm2mTreeNode * instanceNode = AddObjectInstanceNode(objectNode, registry, instanceID);
-                resourceNode = AddResourceNode(instanceNode, registry, objectID, resourceID);
+                Lwm2mTreeNode * objectNode = AddObjectNode(*dest, arena, registry, objectID);
+                Lwm2mTreeNode * instanceNode = AddObjectInstanceNode(objectNode, arena, registry, instanceID);
+                resourceNode = AddResourceNode(instanceNode, arena, registry, objectID, resourceID);
             }
             else if (Lwm2mTreeNode_GetType(*dest) == Lwm2mTreeNodeType_Object)
             {
-                Lwm2mTreeNode * instanceNode = AddObjectInstanceNode(*dest, registry, instanceID);
-                resourceNode = AddResourceNode(instanceNode, registry, objectID, resourceID);
+                Lwm2mTreeNode * instanceNode = AddObjectInstanceNode(*dest, arena, registry, instanceID);
+                resourceNode = AddResourceNode(instanceNode, arena, registry, objectID, resourceID);
             }
             else if (Lwm2mTreeNode_GetType(*dest) == Lwm2mTreeNodeType_ObjectInstance)
             {
                 // lookup resource node, create if doesn't exist.
-                resourceNode = AddResourceNode(*dest, registry, objectID, resourceID);
+                resourceNode = AddResourceNode(*dest, arena, registry, objectID, resourceID);
             }
             else
             {
@@ -787,7 +787,7 @@ static int JsonDeserialise(Lwm2mTreeNode ** dest, const DefinitionRegistry * reg
             }
             char * value = JsonTokenToString(buffer, t);
 
-            resourceValueNode = Lwm2mTreeNode_Create();
+            resourceValueNode = Lwm2mTreeNode_CreateInArena(arena);
             Lwm2mTreeNode_SetID(resourceValueNode, resourceInstanceID);
             Lwm2mTreeNode_SetType(resourceValueNode, Lwm2mTreeNodeType_ResourceInstance);
 
@@ -943,22 +943,22 @@ static int JsonDeserialise(Lwm2mTreeNode ** dest, const DefinitionRegistry * reg
     return result;
 }
 
-static int JsonDeserialiseResource(SerdesContext * serdesContext, Lwm2mTreeNode ** dest, const DefinitionRegistry * registry, ObjectIDType objectID,
+static int JsonDeserialiseResource(SerdesContext * serdesContext, Lwm2mTreeNode ** dest, MemoryArena * arena, const DefinitionRegistry * registry, ObjectIDType objectID,
                                    ObjectInstanceIDType instanceID, ResourceIDType resourceID, const uint8_t * buf, int bufferLen)
 {
-    return JsonDeserialise(dest, registry, objectID, instanceID, resourceID, buf, bufferLen);
+    return JsonDeserialise(dest, arena, registry, objectID, instanceID, resourceID, buf, bufferLen);
 }
 
-static int JsonDeserialiseObjectInstance(SerdesContext * serdesContext, Lwm2mTreeNode ** dest, const DefinitionRegistry * registry,
+static int JsonDeserialiseObjectInstance(SerdesContext * serdesContext, Lwm2mTreeNode ** dest, MemoryArena * arena, const DefinitionRegistry * registry,
                                          ObjectIDType objectID, ObjectInstanceIDType instanceID, const uint8_t * buf, int bufferLen)
 {
-    return JsonDeserialise(dest, registry, objectID, instanceID, -1, buf, bufferLen);
+    return JsonDeserialise(dest, arena, registry, objectID, instanceID, -1, buf, bufferLen);
 }
 
-static int JsonDeserialiseObject(SerdesContext * serdesContext, Lwm2mTreeNode ** dest, const DefinitionRegistry * registry,
+static int JsonDeserialiseObject(SerdesContext * serdesContext, Lwm2mTreeNode ** dest, MemoryArena * arena, const DefinitionRegistry * registry,
                                  ObjectIDType objectID, const uint8_t * buf, int bufferLen)
 {
-    return JsonDeserialise(dest, registry, objectID, -1, -1, buf, bufferLen);
+    return JsonDeserialise(dest, arena, registry, objectID, -1, -1, buf, bufferLen);
 }
 
 // Map JSON serdes function delegates
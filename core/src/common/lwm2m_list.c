@@ -25,18 +25,13 @@
 
 void ListAdd(struct ListHead * newEntry, struct ListHead * head)
 {
-    struct ListHead * pos;
-    struct ListHead * next = head;
-
-    ListForEach(pos, head)
-    {
-        next = pos;
-    }
+    // head->Prev is kept pointing at the tail, so appending does not need to walk the list
+    struct ListHead * tail = head->Prev;
 
-    //next->Prev     = newEntry;
     newEntry->Next = head;
-    newEntry->Prev = next;
-    next->Next     = newEntry;
+    newEntry->Prev = tail;
+    tail->Next     = newEntry;
+    head->Prev     = newEntry;
 }
 
 
@@ -20,119 +20,187 @@
  USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 ************************************************************************************************************************/
 
-
 #include <stdio.h>
 #include <string.h>
 #include <stdbool.h>
 #include <stdint.h>
-#include <stdbool.h>
 #include <stdlib.h>
 
 #include "lwm2m_types.h"
 #include "lwm2m_limits.h"
 #include "lwm2m_object_store.h"
-#include "lwm2m_list.h"
+#include "lwm2m_hash_table.h"
 #include "lwm2m_debug.h"
 #include "lwm2m_util.h"
 #include "lwm2m_result.h"
 
+// Header of every object, object instance and resource; always the first member so the entry can be cast back
+typedef struct
+{
+    HashTableNode IndexNode;            // in the store's path index
+    ObjectIDType ObjectID;
+    ObjectInstanceIDType ObjectInstanceID;  // -1 for an object
+    ResourceIDType ResourceID;          // -1 for an object or object instance
+    int Position;                       // index in the parent's children
+} StoreEntry;
+
 typedef struct
 {
-    struct ListHead list;             // prev/next pointers
+    StoreEntry ** Entries;              // in creation order
+    int Count;
+    int Capacity;
+} EntryArray;
 
-    void * Value;
+#ifndef OBJECT_STORE_INLINE_VALUE_SIZE
+    #define OBJECT_STORE_INLINE_VALUE_SIZE  (16)    // values this long or shorter are kept inside the instance
+#endif
+
+typedef struct
+{
+    ResourceInstanceIDType ID;
     int Size;
-    int ID;
+    union
+    {
+        void * Heap;                    // if Size is over OBJECT_STORE_INLINE_VALUE_SIZE
+        uint8_t Inline[OBJECT_STORE_INLINE_VALUE_SIZE];
+    } Value;
 } ResourceInstance;
 
 typedef struct
 {
-    struct ListHead list;             // prev/next pointers
-    struct ListHead Instance;
-    int ID;
+    StoreEntry Entry;
+    ResourceInstance * Instances;       // sorted by ID
+    int NumInstances;
+    int Capacity;
 } Resource;
 
 typedef struct
 {
-    struct ListHead list;              // prev/next pointers
-    struct ListHead Resource;
-    int ID;                            // Instance ID
+    StoreEntry Entry;
+    EntryArray Resources;
 } ObjectInstance;
 
 typedef struct
 {
-    struct ListHead list;              // prev/next pointers
-    struct ListHead Instance;          // Linked list of object instances
-    int ID;
+    StoreEntry Entry;
+    EntryArray Instances;
 } Object;
 
-static Object * LookupObject(const ObjectStore * store, ObjectIDType objectID)
+struct _ObjectStore
+{
+    HashTable Index;                    // every entry, by path
+    EntryArray Objects;
+};
+
+static uint32_t HashPath(ObjectIDType objectID, ObjectInstanceIDType objectInstanceID, ResourceIDType resourceID)
+{
+    uint32_t hash = HashTable_HashUInt32(((uint32_t)objectID << 16) ^ (uint16_t)objectInstanceID);
+    return HashTable_HashUInt32(hash ^ (uint32_t)resourceID);
+}
+
+static StoreEntry * LookupEntry(const ObjectStore * store, ObjectIDType objectID, ObjectInstanceIDType objectInstanceID, ResourceIDType resourceID)
 {
-    struct ListHead * i;
-    ListForEach(i, &store->objectList)
+    HashTableNode * node;
+    for (node = HashTable_FindFirst(&store->Index, HashPath(objectID, objectInstanceID, resourceID)); node != NULL; node = HashTable_FindNext(node))
     {
-        Object * object = ListEntry(i, Object, list);
-        if (object->ID == objectID)
+        StoreEntry * entry = HashTableEntry(node, StoreEntry, IndexNode);
+        if ((entry->ObjectID == objectID) && (entry->ObjectInstanceID == objectInstanceID) && (entry->ResourceID == resourceID))
         {
-            return object;
+            return entry;
         }
     }
     return NULL;
 }
 
-static ObjectInstance * GetObjectInstance(Object * object, ObjectInstanceIDType objectInstanceID)
+static Object * LookupObject(const ObjectStore * store, ObjectIDType objectID)
+{
+    return (Object *)LookupEntry(store, objectID, -1, -1);
+}
+
+static ObjectInstance * LookupObjectInstance(const ObjectStore * store, ObjectIDType objectID, ObjectInstanceIDType objectInstanceID)
 {
-    struct ListHead * i;
-    ListForEach(i, &object->Instance)
+    // -1 would find the object itself
+    return (objectInstanceID != -1) ? (ObjectInstance *)LookupEntry(store, objectID, objectInstanceID, -1) : NULL;
+}
+
+static Resource * LookupResource(const ObjectStore * store, ObjectIDType objectID, ObjectInstanceIDType objectInstanceID, ResourceIDType resourceID)
+{
+    return ((objectInstanceID != -1) && (resourceID != -1)) ? (Resource *)LookupEntry(store, objectID, objectInstanceID, resourceID) : NULL;
+}
+
+static int EntryArray_Append(EntryArray * array, StoreEntry * entry)
+{
+    if (array->Count == array->Capacity)
     {
-        ObjectInstance * instance = ListEntry(i, ObjectInstance, list);
-        if (instance->ID == objectInstanceID)
+        int capacity = (array->Capacity == 0) ? 4 : array->Capacity * 2;
+        StoreEntry ** entries = (StoreEntry **)realloc(array->Entries, capacity * sizeof(StoreEntry *));
+        if (entries == NULL)
         {
-            return instance;
+            return -1;
         }
+        array->Entries = entries;
+        array->Capacity = capacity;
     }
-
-    return NULL;
+    entry->Position = array->Count;
+    array->Entries[array->Count++] = entry;
+    return 0;
 }
 
-static ObjectInstance * LookupObjectInstance(const ObjectStore * store, ObjectIDType objectID, ObjectInstanceIDType objectInstanceID)
+// Remove an entry, keeping the others in creation order
+static void EntryArray_Remove(EntryArray * array, StoreEntry * entry)
 {
-    Object * object = LookupObject(store, objectID);
-    if (object != NULL)
+    int i;
+    for (i = entry->Position + 1; i < array->Count; i++)
     {
-        return GetObjectInstance(object, objectInstanceID);
+        array->Entries[i - 1] = array->Entries[i];
+        array->Entries[i - 1]->Position = i - 1;
     }
-    return NULL;
+    array->Count--;
 }
 
-// Retrieve a pointer to a Resource from an Object instance
-static Resource * GetResource(ObjectInstance * instance, ResourceIDType resourceID)
+static void EntryArray_Destroy(EntryArray * array)
 {
-    struct ListHead * i;
-    ListForEach(i, &instance->Resource)
+    free(array->Entries);
+    array->Entries = NULL;
+    array->Count = array->Capacity = 0;
+}
+
+// ID of the child after entry, or of the first child. Not found if entry is NULL and first is false.
+static int EntryArray_GetNextID(const EntryArray * array, const StoreEntry * entry, bool first)
+{
+    int position = first ? 0 : ((entry != NULL) ? entry->Position + 1 : array->Count);
+    if (position < array->Count)
     {
-        Resource * resource = ListEntry(i, Resource, list);
-        if (resource->ID == resourceID)
-        {
-            return resource;
-        }
+        const StoreEntry * next = array->Entries[position];
+        AwaResult_SetResult(AwaResult_Success);
+        return (next->ResourceID != -1) ? next->ResourceID : next->ObjectInstanceID;
     }
-    return NULL;
+    AwaResult_SetResult(AwaResult_NotFound);
+    return -1;
 }
 
-static Resource * LookupResource(const ObjectStore * store, ObjectIDType objectID, ObjectInstanceIDType objectInstanceID, ResourceIDType resourceID)
+static int AddEntry(ObjectStore * store, EntryArray * parent, StoreEntry * entry,
+                    ObjectIDType objectID, ObjectInstanceIDType objectInstanceID, ResourceIDType resourceID)
 {
-    ObjectInstance * instance = LookupObjectInstance(store, objectID, objectInstanceID);
-    if (instance != NULL)
+    entry->ObjectID = objectID;
+    entry->ObjectInstanceID = objectInstanceID;
+    entry->ResourceID = resourceID;
+
+    if (HashTable_Insert(&store->Index, &entry->IndexNode, HashPath(objectID, objectInstanceID, resourceID)) != 0)
     {
-        return GetResource(instance, resourceID);
+        return -1;
     }
-    return NULL;
+    if (EntryArray_Append(parent, entry) != 0)
+    {
+        HashTable_Remove(&store->Index, &entry->IndexNode);
+        return -1;
+    }
+    return 0;
 }
 
-static Resource * CreateResource(ObjectInstance * instance, ResourceIDType resourceID)
+static Resource * CreateResource(ObjectStore * store, ObjectInstance * instance, ResourceIDType resourceID)
 {
-    Resource * resource = GetResource(instance, resourceID);
+    Resource * resource = LookupResource(store, instance->Entry.ObjectID, instance->Entry.ObjectInstanceID, resourceID);
     if (resource)
     {
         // already exists
@@ -148,30 +216,84 @@ static Resource * CreateResource(ObjectInstance * instance, ResourceIDType resou
         return NULL;
     }
 
-    resource->ID = resourceID;
-    ListInit(&resource->Instance);
+    resource->Instances = NULL;
+    resource->NumInstances = 0;
+    resource->Capacity = 0;
 
     // Add to instance.
-    ListAdd(&resource->list, &instance->Resource);
+    if (AddEntry(store, &instance->Resources, &resource->Entry, instance->Entry.ObjectID, instance->Entry.ObjectInstanceID, resourceID) != 0)
+    {
+        free(resource);
+        AwaResult_SetResult(AwaResult_OutOfMemory);
+        return NULL;
+    }
 
     AwaResult_SetResult(AwaResult_Success);
     return resource;
 }
 
-static ResourceInstance * GetResourceInstance(Resource * resource, ResourceInstanceIDType resourceInstanceID)
+// Binary search for a resource instance. Returns its index, or -1 with *insertAt set to where it belongs.
+static int FindResourceInstance(const Resource * resource, ResourceInstanceIDType resourceInstanceID, int * insertAt)
 {
-    int count = 0;
-    struct ListHead * i;
-    ListForEach(i, &resource->Instance)
+    int low = 0;
+    int high = resource->NumInstances;
+    while (low < high)
     {
-        ResourceInstance * resource = ListEntry(i, ResourceInstance, list);
-        if (resource->ID == resourceInstanceID)
+        int middle = (low + high) / 2;
+        if (resource->Instances[middle].ID < resourceInstanceID)
         {
-            return resource;
+            low = middle + 1;
+        }
+        else
+        {
+            high = middle;
         }
-        count++;
     }
-    return NULL;
+    if (insertAt != NULL)
+    {
+        *insertAt = low;
+    }
+    return ((low < resource->NumInstances) && (resource->Instances[low].ID == resourceInstanceID)) ? low : -1;
+}
+
+static void * GetValue(ResourceInstance * instance)
+{
+    return (instance->Size > OBJECT_STORE_INLINE_VALUE_SIZE) ? instance->Value.Heap : instance->Value.Inline;
+}
+
+static void FreeValue(ResourceInstance * instance)
+{
+    if (instance->Size > OBJECT_STORE_INLINE_VALUE_SIZE)
+    {
+        free(instance->Value.Heap);
+    }
+}
+
+// Resize and zero a value, moving it between the instance and the heap as needed. The value is unchanged on failure.
+static int ResizeValue(ResourceInstance * instance, int valueSize)
+{
+    if (valueSize > OBJECT_STORE_INLINE_VALUE_SIZE)
+    {
+        void * heap = (instance->Size > OBJECT_STORE_INLINE_VALUE_SIZE) ? realloc(instance->Value.Heap, valueSize) : malloc(valueSize);
+        if (heap == NULL)
+        {
+            return -1;
+        }
+        instance->Value.Heap = heap;
+    }
+    else
+    {
+        FreeValue(instance);
+    }
+    instance->Size = valueSize;
+    memset(GetValue(instance), 0, valueSize);
+    return 0;
+}
+
+static ResourceInstance * GetResourceInstance(Resource * resource, ResourceInstanceIDType resourceInstanceID)
+{
+    int index = FindResourceInstance(resource, resourceInstanceID, NULL);
+    return (index >= 0) ? &resource->Instances[index] : NULL;
 }
 
 ResourceIDType ObjectStore_GetNextResourceID(ObjectStore * store, ObjectIDType objectID, ObjectInstanceIDType objectInstanceID, ResourceIDType resourceID)
@@ -179,28 +301,13 @@ ResourceIDType ObjectStore_GetNextResourceID(ObjectStore * store, ObjectIDType o
     ObjectInstance * instance = LookupObjectInstance(store, objectID, objectInstanceID);
     if (instance != NULL)
     {
-        bool found = (resourceID == -1) ? true : false;
-        struct ListHead * i;
-        ListForEach(i, &instance->Resource)
-        {
-            Resource * resource = ListEntry(i, Resource, list);
-            if (found)
-            {
-                AwaResult_SetResult(AwaResult_Success);
-                return resource->ID;
-            }
-
-            if (resource->ID == resourceID)
-            {
-                found = true;
-            }
-        }
+        return EntryArray_GetNextID(&instance->Resources, (StoreEntry *)LookupResource(store, objectID, objectInstanceID, resourceID), resourceID == -1);
     }
     AwaResult_SetResult(AwaResult_NotFound);
     return -1;
 }
 
-Object * CreateObject(ObjectStore * store, ObjectIDType objectID)
+static Object * CreateObject(ObjectStore * store, ObjectIDType objectID)
 {
     Object * object = LookupObject(store, objectID);
     if (object != NULL)
@@ -217,18 +324,22 @@ Object * CreateObject(ObjectStore * store, ObjectIDType objectID)
         return NULL;
     }
 
-    object->ID = objectID;
-    ListInit(&object->Instance);
+    memset(&object->Instances, 0, sizeof(object->Instances));
 
-    ListAdd(&object->list, &store->objectList);
+    if (AddEntry(store, &store->Objects, &object->Entry, objectID, -1, -1) != 0)
+    {
+        free(object);
+        AwaResult_SetResult(AwaResult_OutOfMemory);
+        return NULL;
+    }
 
     AwaResult_SetResult(AwaResult_Success);
     return object;
 }
 
-static ObjectInstance * CreateObjectInstance(Object * object, ObjectInstanceIDType objectInstanceID)
+static ObjectInstance * CreateObjectInstance(ObjectStore * store, Object * object, ObjectInstanceIDType objectInstanceID)
 {
-    ObjectInstance * instance = GetObjectInstance(object, objectInstanceID);
+    ObjectInstance * instance = LookupObjectInstance(store, object->Entry.ObjectID, objectInstanceID);
     if (instance != NULL)
     {
         AwaResult_SetResult(AwaResult_AlreadyCreated);
@@ -243,18 +354,57 @@ static ObjectInstance * CreateObjectInstance(Object * object, ObjectInstanceIDTy
         return NULL;
     }
 
-    instance->ID = objectInstanceID;
-    ListInit(&instance->Resource);
+    memset(&instance->Resources, 0, sizeof(instance->Resources));
 
     // Add instance to object
-    ListAdd(&instance->list, &object->Instance);
+    if (AddEntry(store, &object->Instances, &instance->Entry, object->Entry.ObjectID, objectInstanceID, -1) != 0)
+    {
+        free(instance);
+        AwaResult_SetResult(AwaResult_OutOfMemory);
+        return NULL;
+    }
 
-    Lwm2m_Debug("CreateObjectInstance %d %d\n", object->ID, objectInstanceID);
+    Lwm2m_Debug("CreateObjectInstance %d %d\n", object->Entry.ObjectID, objectInstanceID);
 
     AwaResult_SetResult(AwaResult_Success);
     return instance;
 }
 
+// Free a resource and its values, leaving it in its parent's children
+static void FreeResource(ObjectStore * store, Resource * resource)
+{
+    int i;
+    for (i = 0; i < resource->NumInstances; i++)
+    {
+        FreeValue(&resource->Instances[i]);
+    }
+    free(resource->Instances);
+    HashTable_Remove(&store->Index, &resource->Entry.IndexNode);
+    free(resource);
+}
+
+static void FreeObjectInstance(ObjectStore * store, ObjectInstance * instance)
+{
+    int i;
+    for (i = 0; i < instance->Resources.Count; i++)
+    {
+        FreeResource(store, (Resource *)instance->Resources.Entries[i]);
+    }
+    EntryArray_Destroy(&instance->Resources);
+    HashTable_Remove(&store->Index, &instance->Entry.IndexNode);
+    free(instance);
+}
+
+static void FreeObjectInstances(ObjectStore * store, Object * object)
+{
+    int i;
+    for (i = 0; i < object->Instances.Count; i++)
+    {
+        FreeObjectInstance(store, (ObjectInstance *)object->Instances.Entries[i]);
+    }
+    object->Instances.Count = 0;
+}
+
 static int DeleteResourceInstance(ObjectStore * store, ObjectIDType objectID, ObjectInstanceIDType objectInstanceID, ResourceIDType resourceID, ResourceInstanceIDType resourceInstanceID)
 {
     int result = -1;
@@ -262,17 +412,13 @@ static int DeleteResourceInstance(ObjectStore * store, ObjectIDType objectID, Ob
 
     if (resource != NULL)
     {
-        struct ListHead * pos, *n;
-        ListForEachSafe(pos, n, &resource->Instance)
+        int index = FindResourceInstance(resource, resourceInstanceID, NULL);
+        if (index >= 0)
         {
-            ResourceInstance * rInst = ListEntry(pos, ResourceInstance, list);
-            if (rInst->ID == resourceInstanceID)
-            {
-                free(rInst->Value);
-                ListRemove(pos);
-                free(rInst);
-                result = 0;
-            }
+            FreeValue(&resource->Instances[index]);
+            memmove(&resource->Instances[index], &resource->Instances[index + 1], (resource->NumInstances - index - 1) * sizeof(ResourceInstance));
+            resource->NumInstances--;
+            result = 0;
         }
     }
 
@@ -281,44 +427,32 @@ static int DeleteResourceInstance(ObjectStore * store, ObjectIDType objectID, Ob
 
 static int DeleteResource(ObjectStore * store, ObjectIDType objectID, ObjectInstanceIDType objectInstanceID, ResourceIDType resourceID)
 {
+    ObjectInstance * instance = LookupObjectInstance(store, objectID, objectInstanceID);
     Resource * resource = LookupResource(store, objectID, objectInstanceID, resourceID);
 
-    if (resource == NULL)
+    if ((instance == NULL) || (resource == NULL))
     {
         return -1;
     }
 
-    struct ListHead * pos, *n;
-    ListForEachSafe(pos, n, &resource->Instance)
-    {
-        ResourceInstance * rInst = ListEntry(pos, ResourceInstance, list);
-        free(rInst->Value);
-        ListRemove(pos);
-        free(rInst);
-    }
-    ListRemove(&resource->list);
-    free(resource);
+    EntryArray_Remove(&instance->Resources, &resource->Entry);
+    FreeResource(store, resource);
 
     return 0;
 }
 
 static int DeleteInstance(ObjectStore * store, ObjectIDType objectID, ObjectInstanceIDType objectInstanceID)
 {
+    Object * object = LookupObject(store, objectID);
     ObjectInstance * instance = LookupObjectInstance(store, objectID, objectInstanceID);
 
-    if (instance == NULL)
+    if ((object == NULL) || (instance == NULL))
     {
         return -1;
     }
 
-    struct ListHead * pos, *n;
-    ListForEachSafe(pos, n, &instance->Resource)
-    {
-        Resource * resource = ListEntry(pos, Resource, list);
-        DeleteResource(store, objectID, objectInstanceID, resource->ID);
-    }
-    ListRemove(&instance->list);
-    free(instance);
+    EntryArray_Remove(&object->Instances, &instance->Entry);
+    FreeObjectInstance(store, instance);
 
     return 0;
 }
@@ -332,12 +466,7 @@ static int DeleteObjectInstances(ObjectStore * store, ObjectIDType objectID)
         return -1;
     }
 
-    struct ListHead * pos, *n;
-    ListForEachSafe(pos, n, &object->Instance)
-    {
-        ObjectInstance * instance = ListEntry(pos, ObjectInstance, list);
-        DeleteInstance(store, objectID, instance->ID);
-    }
+    FreeObjectInstances(store, object);
     return 0;
 }
 
@@ -376,7 +505,7 @@ int ObjectStore_GetResourceInstanceValue(ObjectStore * store, ObjectIDType objec
             return -1;
         }
 
-        *ValueBuffer = instance->Value;
+        *ValueBuffer = GetValue(instance);
         *ValueBufferSize = instance->Size;
         AwaResult_SetResult(AwaResult_Success);
         return instance->Size;
@@ -389,101 +518,83 @@ int ObjectStore_SetResourceInstanceValue(ObjectStore * store, ObjectIDType objec
                                          ResourceIDType resourceID, ResourceInstanceIDType resourceInstanceID, int valueSize,
                                          const void * valueBuffer, int valueBufferPos, int valueBufferLen, bool * changed)
 {
-    Object * obj;
-    ObjectInstance * inst;
     Resource * r;
     ResourceInstance * rInst;
+    int index;
 
     *changed = false;
 
-    obj = LookupObject(store, objectID);
-    if (obj == NULL)
-    {
-        Lwm2m_Error("Failed to lookup object %d\n", objectID);
-        return -1;
-    }
-
-    inst = LookupObjectInstance(store, objectID, objectInstanceID);
-    if (inst == NULL)
-    {
-        Lwm2m_Error("Failed to lookup object %d instance %d\n", objectID, objectInstanceID);
-        return -1;
-    }
-
+    // Resources are looked up directly; the object and instance are only checked to report what is missing
     r = LookupResource(store, objectID, objectInstanceID, resourceID);
     if (r == NULL)
     {
-        Lwm2m_Error("Failed to lookup object %d instance %d resource %d\n", objectID, objectInstanceID, resourceID);
+        if (LookupObject(store, objectID) == NULL)
+        {
+            Lwm2m_Error("Failed to lookup object %d\n", objectID);
+        }
+        else if (LookupObjectInstance(store, objectID, objectInstanceID) == NULL)
+        {
+            Lwm2m_Error("Failed to lookup object %d instance %d\n", objectID, objectInstanceID);
+        }
+        else
+        {
+            Lwm2m_Error("Failed to lookup object %d instance %d resource %d\n", objectID, objectInstanceID, resourceID);
+        }
         return -1;
     }
 
     // create a new resource instance, or resize the existing one.
-    rInst = GetResourceInstance(r, resourceInstanceID);
-    if (rInst == NULL)
+    if (FindResourceInstance(r, resourceInstanceID, &index) < 0)
     {
-        rInst = (ResourceInstance *)malloc(sizeof(ResourceInstance));
-        if (rInst == NULL)
+        ResourceInstance created = { .ID = resourceInstanceID, .Size = 0 };
+
+        if (r->NumInstances == r->Capacity)
         {
-            Lwm2m_Error("Failed to allocate memory\n");
-            AwaResult_SetResult(AwaResult_OutOfMemory);
-            return -1;
+            int capacity = (r->Capacity == 0) ? 1 : r->Capacity * 2;
+            ResourceInstance * instances = (ResourceInstance *)realloc(r->Instances, capacity * sizeof(ResourceInstance));
+            if (instances == NULL)
+            {
+                Lwm2m_Error("Failed to allocate memory\n");
+                AwaResult_SetResult(AwaResult_OutOfMemory);
+                return -1;
+            }
+            r->Instances = instances;
+            r->Capacity = capacity;
         }
 
-        rInst->ID = resourceInstanceID;
-
-        rInst->Value = malloc(valueSize);
-
-        if (rInst->Value == NULL)
+        if (ResizeValue(&created, valueSize) != 0)
         {
-            free(rInst);
             Lwm2m_Error("Failed to allocate memory\n");
             AwaResult_SetResult(AwaResult_OutOfMemory);
             return -1;
         }
 
-        memset(rInst->Value, 0, valueSize);
-
-        rInst->Size = valueSize;
+        // keep the instances in ID order
+        memmove(&r->Instances[index + 1], &r->Instances[index], (r->NumInstances - index) * sizeof(ResourceInstance));
+        r->NumInstances++;
 
-        struct ListHead * i;
-        struct ListHead * addPostion = &r->Instance;
-        ListForEach(i, &r->Instance)
-        {
-            ResourceInstance * resource = ListEntry(i, ResourceInstance, list);
-            if (resourceInstanceID < resource->ID)
-            {
-                break;
-            }
-            addPostion =  i;
-        }
-        ListInsertAfter(&rInst->list, addPostion);
+        rInst = &r->Instances[index];
+        *rInst = created;
     }
     else
     {
+        rInst = &r->Instances[index];
+
         // re-alloc memory if the size has changed.
-        if (rInst->Size != valueSize)
+        if ((rInst->Size != valueSize) && (ResizeValue(rInst, valueSize) != 0))
         {
-            void * temp = realloc(rInst->Value, valueSize);
-            if (temp == NULL)
-            {
-                Lwm2m_Error("Failed to realloc memory\n");
-                AwaResult_SetResult(AwaResult_OutOfMemory);
-                return -1;
-            }
-
-            rInst->Value = temp;
-            rInst->Size = valueSize;
-
-            memset(rInst->Value, 0, valueSize);
+            Lwm2m_Error("Failed to realloc memory\n");
+            AwaResult_SetResult(AwaResult_OutOfMemory);
+            return -1;
         }
     }
 
     if ((valueBufferPos < valueSize && valueBufferPos >= 0) || (valueBufferPos == valueSize && valueSize == 0/*Allow empty opaque data*/))
     {
-        if (memcmp((char *)(rInst->Value) + valueBufferPos, valueBuffer, valueBufferLen))
+        char * value = (char *)GetValue(rInst);
+        if (memcmp(value + valueBufferPos, valueBuffer, valueBufferLen))
         {
-            memcpy((char *)(rInst->Value) + valueBufferPos, valueBuffer,
-                   valueBufferLen);
+            memcpy(value + valueBufferPos, valueBuffer, valueBufferLen);
             *changed = true;
         }
 
@@ -507,86 +618,27 @@ ObjectStore * ObjectStore_Create(void)
 
     memset(store, 0, sizeof(ObjectStore));
 
-    ListInit(&store->objectList);
+    HashTable_Init(&store->Index);
 
     AwaResult_SetResult(AwaResult_Success);
     return store;
 }
 
-static void DestroyResourceInstanceList(struct ListHead * resourceInstanceList)
-{
-    if (resourceInstanceList != NULL)
-    {
-        struct ListHead * i, * n;
-        ListForEachSafe(i, n, resourceInstanceList)
-        {
-            ResourceInstance * resourceInstance = ListEntry(i, ResourceInstance, list);
-            if (resourceInstance != NULL)
-            {
-                free(resourceInstance->Value);
-                free(resourceInstance);
-            }
-        }
-    }
-}
-
-static void DestroyResourceList(struct ListHead * resourceList)
-{
-    if (resourceList != NULL)
-    {
-        struct ListHead * i, * n;
-        ListForEachSafe(i, n, resourceList)
-        {
-            Resource * resource = ListEntry(i, Resource, list);
-            if (resource != NULL)
-            {
-                DestroyResourceInstanceList(&resource->Instance);
-                free(resource);
-            }
-        }
-    }
-}
-
-static void DestroyInstanceList(struct ListHead * instanceList)
-{
-    if (instanceList != NULL)
-    {
-        struct ListHead * i, * n;
-        ListForEachSafe(i, n, instanceList)
-        {
-            ObjectInstance * objectInstance = ListEntry(i, ObjectInstance, list);
-            if (objectInstance != NULL)
-            {
-                DestroyResourceList(&objectInstance->Resource);
-                free(objectInstance);
-            }
-        }
-    }
-}
-
-static void DestroyObjectList(struct ListHead * objectList)
-{
-    if (objectList != NULL)
-    {
-        struct ListHead * i, * n;
-        ListForEachSafe(i, n, objectList)
-        {
-            Object * object = ListEntry(i, Object, list);
-            if (object != NULL)
-            {
-                DestroyInstanceList(&object->Instance);
-                free(object);
-            }
-        }
-    }
-}
-
 void ObjectStore_Destroy(ObjectStore * store)
 {
     if (store != NULL)
     {
         // loop through all objects and free them
-        DestroyObjectList(&store->objectList);
+        int i;
+        for (i = 0; i < store->Objects.Count; i++)
+        {
+            Object * object = (Object *)store->Objects.Entries[i];
+            FreeObjectInstances(store, object);
+            EntryArray_Destroy(&object->Instances);
+            free(object);
+        }
+        EntryArray_Destroy(&store->Objects);
+        HashTable_Destroy(&store->Index);
         free(store);
     }
 }
@@ -596,7 +648,7 @@ int ObjectStore_GetObjectNumInstances(ObjectStore * store, ObjectIDType objectID
     Object * object = LookupObject(store, objectID);
     if (object != NULL)
     {
-        return ListCount(&object->Instance);
+        return object->Instances.Count;
     }
     return 0;
 }
@@ -606,7 +658,7 @@ int ObjectStore_GetInstanceNumResources(ObjectStore * store, ObjectIDType object
     ObjectInstance * instance = LookupObjectInstance(store, objectID, objectInstanceID);
     if (instance != NULL)
     {
-        return ListCount(&instance->Resource);
+        return instance->Resources.Count;
     }
     return 0;
 }
@@ -616,7 +668,7 @@ int ObjectStore_GetResourceNumInstances(ObjectStore * store, ObjectIDType object
     Resource * resource = LookupResource(store, objectID, objectInstanceID, resourceID);
     if (resource != NULL)
     {
-        return ListCount(&resource->Instance);
+        return resource->NumInstances;
     }
     return 0;
 }
@@ -646,22 +698,7 @@ ObjectInstanceIDType ObjectStore_GetNextObjectInstanceID(ObjectStore * store, Ob
     Object * object = LookupObject(store, objectID);
     if (object != NULL)
     {
-        bool found = (objectInstanceID == -1);
-        struct ListHead * i;
-        ListForEach(i, &object->Instance)
-        {
-            ObjectInstance * instance = ListEntry(i, ObjectInstance, list);
-            if (found)
-            {
-                AwaResult_SetResult(AwaResult_Success);
-                return instance->ID;
-            }
-
-            if (instance->ID == objectInstanceID)
-            {
-                found = true;
-            }
-        }
+        return EntryArray_GetNextID(&object->Instances, (StoreEntry *)LookupObjectInstance(store, objectID, objectInstanceID), objectInstanceID == -1);
     }
     AwaResult_SetResult(AwaResult_NotFound);
     return -1;
@@ -673,27 +710,87 @@ ResourceInstanceIDType ObjectStore_GetNextResourceInstanceID(ObjectStore * store
     Resource * resource = LookupResource(store, objectID, objectInstanceID, resourceID);
     if (resource != NULL)
     {
-        bool found = (resourceInstanceID == -1);
-        struct ListHead * i;
-        ListForEach(i, &resource->Instance)
+        int index = 0;
+        if (resourceInstanceID != -1)
         {
-            ResourceInstance * instance = ListEntry(i, ResourceInstance, list);
-            if (found)
-            {
-                AwaResult_SetResult(AwaResult_Success);
-                return instance->ID;
-            }
-
-            if (instance->ID == resourceInstanceID)
-            {
-                found = true;
-            }
+            index = FindResourceInstance(resource, resourceInstanceID, NULL);
+            index = (index >= 0) ? index + 1 : resource->NumInstances;
+        }
+        if (index < resource->NumInstances)
+        {
+            AwaResult_SetResult(AwaResult_Success);
+            return resource->Instances[index].ID;
         }
     }
     AwaResult_SetResult(AwaResult_NotFound);
     return -1;
 }
 
+int ObjectStore_InitIterator(ObjectStore * store, ObjectStoreIterator * iterator, ObjectIDType objectID, ObjectInstanceIDType objectInstanceID, ResourceIDType resourceID)
+{
+    iterator->Parent = NULL;
+    iterator->Level = 0;
+    iterator->Position = 0;
+
+    if (((objectID == -1) && (objectInstanceID != -1)) || ((objectInstanceID == -1) && (resourceID != -1)))
+    {
+        // an ID below an unspecified one names no path
+    }
+    else if (objectID == -1)
+    {
+        iterator->Parent = &store->Objects;
+    }
+    else if (objectInstanceID == -1)
+    {
+        Object * object = LookupObject(store, objectID);
+        iterator->Parent = (object != NULL) ? &object->Instances : NULL;
+    }
+    else if (resourceID == -1)
+    {
+        ObjectInstance * instance = LookupObjectInstance(store, objectID, objectInstanceID);
+        iterator->Parent = (instance != NULL) ? &instance->Resources : NULL;
+    }
+    else
+    {
+        iterator->Parent = LookupResource(store, objectID, objectInstanceID, resourceID);
+        iterator->Level = 1;
+    }
+
+    if (iterator->Parent == NULL)
+    {
+        AwaResult_SetResult(AwaResult_NotFound);
+        return -1;
+    }
+    AwaResult_SetResult(AwaResult_Success);
+    return 0;
+}
+
+int ObjectStore_IteratorNext(ObjectStoreIterator * iterator)
+{
+    if (iterator->Parent == NULL)
+    {
+        return -1;
+    }
+
+    if (iterator->Level == 1)
+    {
+        const Resource * resource = (const Resource *)iterator->Parent;
+        return (iterator->Position < resource->NumInstances) ? resource->Instances[iterator->Position++].ID : -1;
+    }
+
+    const EntryArray * children = (const EntryArray *)iterator->Parent;
+    if (iterator->Position < children->Count)
+    {
+        const StoreEntry * entry = children->Entries[iterator->Position++];
+        if (entry->ResourceID != -1)
+        {
+            return entry->ResourceID;
+        }
+        return (entry->ObjectInstanceID != -1) ? entry->ObjectInstanceID : entry->ObjectID;
+    }
+    return -1;
+}
+
 int ObjectStore_Delete(ObjectStore * store, ObjectIDType objectID, ObjectInstanceIDType objectInstanceID, ResourceIDType resourceID, ResourceInstanceIDType resourceInstanceID)
 {
 
@@ -726,16 +823,15 @@ ResourceIDType ObjectStore_CreateResource(ObjectStore * store, ObjectIDType obje
         AwaResult_SetResult(AwaResult_NotFound);
         goto error;
     }
-    Resource * resource = CreateResource(instance, resourceID);
+    Resource * resource = CreateResource(store, instance, resourceID);
     if (resource != NULL)
     {
-        Lwm2m_Debug("Created new resource ID: %d for object %d instance %d\n", resource->ID, objectID, objectInstanceID);
-        return resource->ID;
+        Lwm2m_Debug("Created new resource ID: %d for object %d instance %d\n", resource->Entry.ResourceID, objectID, objectInstanceID);
+        return resource->Entry.ResourceID;
     }
 error:
     return -1;
 }
-
 ObjectInstanceIDType ObjectStore_CreateObjectInstance(ObjectStore * store, ObjectIDType objectID, ObjectInstanceIDType objectInstanceID, int maxInstances)
 {
     AwaResult result = AwaResult_Unspecified;
@@ -774,7 +870,7 @@ ObjectInstanceIDType ObjectStore_CreateObjectInstance(ObjectStore * store, Objec
     }
 
     // Create the new object instance
-    ObjectInstance * instance = CreateObjectInstance(obj, objectInstanceID);
+    ObjectInstance * instance = CreateObjectInstance(store, obj, objectInstanceID);
     if (instance == NULL)
     {
         Lwm2m_Error("Failed to create object instance\n");
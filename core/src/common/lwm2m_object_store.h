@@ -28,16 +28,29 @@
 #include <stdbool.h>
 
 #include "lwm2m_types.h"
-#include "lwm2m_list.h"
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+/*
+ *  Every object, object instance and resource is indexed by its full path, so a lookup at any level is a
+ *  single hash probe rather than a walk of each level in turn. Children are kept in creation order in
+ *  dense arrays, and resource instances inline in ID order, which is the order the GetNext functions
+ *  return them in. Values of up to OBJECT_STORE_INLINE_VALUE_SIZE bytes - integers, floats, booleans,
+ *  object links and short strings - are held in the resource instance itself, so a value returned by
+ *  ObjectStore_GetResourceInstanceValue is only valid until its resource is next changed.
+ */
+typedef struct _ObjectStore ObjectStore;
+
+// Cursor over the children of one path, each step constant time. Values may be set while iterating, but nothing
+// may be created or deleted under the path until the walk is finished.
 typedef struct
 {
-    struct ListHead objectList;
-} ObjectStore;
+    void * Parent;                      // children of the path, NULL if it does not exist
+    int Level;                          // 1 if Parent is a resource, 0 otherwise
+    int Position;                       // of the next child
+} ObjectStoreIterator;
 
 ObjectStore * ObjectStore_Create(void);
 
@@ -62,6 +75,13 @@ ObjectInstanceIDType ObjectStore_GetNextObjectInstanceID(ObjectStore * store, Ob
 ResourceInstanceIDType ObjectStore_GetNextResourceInstanceID(ObjectStore * store, ObjectIDType objectID, ObjectInstanceIDType objectInstanceID,
                                                              ResourceIDType resourceID, ResourceInstanceIDType resourceInstanceID);
 
+// Walk the objects (objectID -1), the instances of an object, the resources of an object instance, or the
+// instances of a resource, in the same order as the GetNext functions. Returns -1 if the path does not exist.
+int ObjectStore_InitIterator(ObjectStore * store, ObjectStoreIterator * iterator, ObjectIDType objectID, ObjectInstanceIDType objectInstanceID, ResourceIDType resourceID);
+
+// The ID of the next child, or -1 when there are none left
+int ObjectStore_IteratorNext(ObjectStoreIterator * iterator);
+
 ObjectStore * ObjectStore_Create(void);
 void ObjectStore_Destroy(ObjectStore * store);
 
@@ -351,10 +351,11 @@ int Lwm2m_CancelObserve(void * ctxt, AddressType * addr, ObjectIDType objectID,
     return -1;
 }
 
-void Lwm2m_UpdateObservers(void * ctxt)
+int Lwm2m_UpdateObservers(void * ctxt)
 {
     Lwm2mContextType * context = (Lwm2mContextType *) ctxt;
     uint32_t now = Lwm2mCore_GetTickCountMs();
+    int nextTimeout = -1;
 
     struct ListHead * observerItem, *n;
     ListForEachSafe(observerItem, n, Lwm2mCore_GetObserverList(context))
@@ -386,5 +387,21 @@ void Lwm2m_UpdateObservers(void * ctxt)
             observer->Changed = false;
             observer->LastUpdate = now;
         }
+
+        // a notification is due once strictly more than the period has elapsed
+        if (observer->Changed)
+        {
+            nextTimeout = Lwm2mCore_EarliestTimeout(nextTimeout, Lwm2mCore_GetTimeRemaining(now, observer->LastUpdate, (uint32_t)minimumPeriod * 1000 + 1));
+        }
+        if (maximumPeriod > 0)
+        {
+            nextTimeout = Lwm2mCore_EarliestTimeout(nextTimeout, Lwm2mCore_GetTimeRemaining(now, observer->LastUpdate, (uint32_t)maximumPeriod * 1000 + 1));
+        }
+        else if (maximumPeriod == 0)
+        {
+            // notifying on every pass; keep to the once a second this used to be serviced at
+            nextTimeout = Lwm2mCore_EarliestTimeout(nextTimeout, 1000);
+        }
     }
+    return nextTimeout;
 }
@@ -54,7 +54,8 @@ typedef struct
 } Lwm2mObserverType;
 
 // Send out pending notifications to any observers of objects, object instances and resources.
-void Lwm2m_UpdateObservers(void * ctxt);
+// Returns milliseconds until the next notification falls due, or -1 if none will without a change.
+int Lwm2m_UpdateObservers(void * ctxt);
 
 void Lwm2m_FreeObservers(void * ctxt);
 
@@ -87,7 +87,7 @@ static int OpaqueSerialiseResource(SerdesContext * serdesContext, Lwm2mTreeNode
     return resourceLength;
 }
 
-static int OpaqueDeserialiseResource(SerdesContext * serdesContext, Lwm2mTreeNode ** dest, const DefinitionRegistry * registry, ObjectIDType objectID,
+static int OpaqueDeserialiseResource(SerdesContext * serdesContext, Lwm2mTreeNode ** dest, MemoryArena * arena, const DefinitionRegistry * registry, ObjectIDType objectID,
                                      ObjectInstanceIDType objectInstanceID, ResourceIDType resourceID, const uint8_t * buffer, int bufferLen)
 {
     (void)serdesContext;
@@ -96,7 +96,7 @@ static int OpaqueDeserialiseResource(SerdesContext * serdesContext, Lwm2mTreeNod
     int result = -1;
     ResourceDefinition * definition;
 
-    *dest = Lwm2mTreeNode_Create();
+    *dest = Lwm2mTreeNode_CreateInArena(arena);
     Lwm2mTreeNode_SetID(*dest, resourceID);
     Lwm2mTreeNode_SetType(*dest, Lwm2mTreeNodeType_Resource);
 
@@ -120,7 +120,7 @@ static int OpaqueDeserialiseResource(SerdesContext * serdesContext, Lwm2mTreeNod
         return -1;
     }
 
-    Lwm2mTreeNode * resourceValueNode = Lwm2mTreeNode_Create();
+    Lwm2mTreeNode * resourceValueNode = Lwm2mTreeNode_CreateInArena(arena);
     Lwm2mTreeNode_SetID(resourceValueNode, 0);
     Lwm2mTreeNode_SetType(resourceValueNode, Lwm2mTreeNodeType_ResourceInstance);
 
@@ -160,7 +160,7 @@ static int PTSerialiseResource(SerdesContext * serdesContext, Lwm2mTreeNode * no
     return resourceLength;
 }
 
-static int PTDeserialiseResource(SerdesContext * serdesContext, Lwm2mTreeNode ** dest, const DefinitionRegistry * registry, ObjectIDType objectID,
+static int PTDeserialiseResource(SerdesContext * serdesContext, Lwm2mTreeNode ** dest, MemoryArena * arena, const DefinitionRegistry * registry, ObjectIDType objectID,
                                  ObjectInstanceIDType objectInstanceID, ResourceIDType resourceID, const uint8_t * buffer, int bufferLen)
 {
     (void)serdesContext;
@@ -168,7 +168,7 @@ static int PTDeserialiseResource(SerdesContext * serdesContext, Lwm2mTreeNode **
     int result = -1;
     ResourceDefinition * definition;
 
-    *dest = Lwm2mTreeNode_Create();
+    *dest = Lwm2mTreeNode_CreateInArena(arena);
     Lwm2mTreeNode_SetID(*dest, resourceID);
     Lwm2mTreeNode_SetType(*dest, Lwm2mTreeNodeType_Resource);
 
@@ -186,7 +186,7 @@ static int PTDeserialiseResource(SerdesContext * serdesContext, Lwm2mTreeNode **
         return -1;
     }
 
-    Lwm2mTreeNode * resourceValueNode = Lwm2mTreeNode_Create();
+    Lwm2mTreeNode * resourceValueNode = Lwm2mTreeNode_CreateInArena(arena);
     Lwm2mTreeNode_SetID(resourceValueNode, 0);
     Lwm2mTreeNode_SetType(resourceValueNode, Lwm2mTreeNodeType_ResourceInstance);
 
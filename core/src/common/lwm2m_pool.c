@@ -0,0 +1,112 @@
+/************************************************************************************************************************
+ Copyright (c) 2016, Imagination Technologies Limited and/or its affiliated group companies.
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+ following conditions are met:
+     1. Redistributions of source code must retain the above copyright notice, this list of conditions and the
+        following disclaimer.
+     2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the
+        following disclaimer in the documentation and/or other materials provided with the distribution.
+     3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote
+        products derived from this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+ USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+************************************************************************************************************************/
+
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "lwm2m_pool.h"
+
+// Free objects are linked through their own storage
+struct _MemoryPoolFreeObject
+{
+    MemoryPoolFreeObject * Next;
+};
+
+void MemoryPool_Init(MemoryPool * pool, size_t objectSize, size_t maxObjects, size_t maxFree)
+{
+    memset(pool, 0, sizeof(MemoryPool));
+    pool->ObjectSize = (objectSize < sizeof(MemoryPoolFreeObject)) ? sizeof(MemoryPoolFreeObject) : objectSize;
+    pool->MaxObjects = maxObjects;
+    pool->MaxFree = maxFree;
+}
+
+void MemoryPool_Destroy(MemoryPool * pool)
+{
+    while (pool->FreeList != NULL)
+    {
+        MemoryPoolFreeObject * object = pool->FreeList;
+        pool->FreeList = object->Next;
+        free(object);
+    }
+    pool->Stats.Free = 0;
+}
+
+void * MemoryPool_Alloc(MemoryPool * pool)
+{
+    void * result = NULL;
+
+    if ((pool->MaxObjects == 0) || (pool->Stats.InUse < pool->MaxObjects))
+    {
+        if (pool->FreeList != NULL)
+        {
+            MemoryPoolFreeObject * object = pool->FreeList;
+            pool->FreeList = object->Next;
+            pool->Stats.Free--;
+            pool->Stats.Reused++;
+            result = object;
+        }
+        else
+        {
+            result = malloc(pool->ObjectSize);
+        }
+    }
+
+    if (result != NULL)
+    {
+        pool->Stats.Allocations++;
+        pool->Stats.InUse++;
+        if (pool->Stats.InUse > pool->Stats.Peak)
+        {
+            pool->Stats.Peak = pool->Stats.InUse;
+        }
+    }
+    else
+    {
+        pool->Stats.AllocationFailures++;
+    }
+    return result;
+}
+
+void MemoryPool_Free(MemoryPool * pool, void * object)
+{
+    if (object != NULL)
+    {
+        pool->Stats.InUse--;
+        if (pool->Stats.Free < pool->MaxFree)
+        {
+            MemoryPoolFreeObject * freeObject = (MemoryPoolFreeObject *)object;
+            freeObject->Next = pool->FreeList;
+            pool->FreeList = freeObject;
+            pool->Stats.Free++;
+        }
+        else
+        {
+            free(object);
+        }
+    }
+}
+
+void MemoryPool_GetStats(const MemoryPool * pool, MemoryPoolStats * stats)
+{
+    *stats = pool->Stats;
+}
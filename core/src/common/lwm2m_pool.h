@@ -0,0 +1,76 @@
+/************************************************************************************************************************
+ Copyright (c) 2016, Imagination Technologies Limited and/or its affiliated group companies.
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+ following conditions are met:
+     1. Redistributions of source code must retain the above copyright notice, this list of conditions and the
+        following disclaimer.
+     2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the
+        following disclaimer in the documentation and/or other materials provided with the distribution.
+     3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote
+        products derived from this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+ USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+************************************************************************************************************************/
+
+
+#ifndef LWM2M_POOL_H
+#define LWM2M_POOL_H
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ *  Fixed-size object pool. Freed objects are kept on a free list and handed out again by the next
+ *  allocation, so steady-state traffic does not touch malloc/free. Two high-water marks bound it:
+ *  MaxObjects caps the number of objects in use (0 for no limit), and MaxFree caps how many freed
+ *  objects are retained for reuse; objects freed beyond that are returned to the heap.
+ */
+
+typedef struct
+{
+    size_t InUse;                       // objects currently allocated
+    size_t Peak;                        // highest InUse seen
+    size_t Free;                        // objects held on the free list
+    size_t Allocations;                 // successful allocations
+    size_t Reused;                      // allocations satisfied from the free list
+    size_t AllocationFailures;          // allocations refused by MaxObjects or failed by malloc
+} MemoryPoolStats;
+
+typedef struct _MemoryPoolFreeObject MemoryPoolFreeObject;
+
+typedef struct
+{
+    size_t ObjectSize;
+    size_t MaxObjects;
+    size_t MaxFree;
+    MemoryPoolFreeObject * FreeList;
+    MemoryPoolStats Stats;
+} MemoryPool;
+
+void MemoryPool_Init(MemoryPool * pool, size_t objectSize, size_t maxObjects, size_t maxFree);
+
+// Release the objects on the free list. Objects still in use remain owned by the caller.
+void MemoryPool_Destroy(MemoryPool * pool);
+
+// Returns an uninitialised object, or NULL if MaxObjects are in use or memory is exhausted
+void * MemoryPool_Alloc(MemoryPool * pool);
+void MemoryPool_Free(MemoryPool * pool, void * object);
+
+void MemoryPool_GetStats(const MemoryPool * pool, MemoryPoolStats * stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // LWM2M_POOL_H
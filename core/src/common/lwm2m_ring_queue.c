@@ -0,0 +1,85 @@
+/************************************************************************************************************************
+ Copyright (c) 2016, Imagination Technologies Limited and/or its affiliated group companies.
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+ following conditions are met:
+     1. Redistributions of source code must retain the above copyright notice, this list of conditions and the
+        following disclaimer.
+     2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the
+        following disclaimer in the documentation and/or other materials provided with the distribution.
+     3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote
+        products derived from this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+ USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+************************************************************************************************************************/
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "lwm2m_ring_queue.h"
+
+int RingQueue_Init(RingQueue * queue, size_t capacity)
+{
+    size_t size = 1;
+    memset(queue, 0, sizeof(RingQueue));
+    while (size < capacity)
+    {
+        size <<= 1;
+    }
+    queue->Entries = (void **)malloc(size * sizeof(void *));
+    if (queue->Entries == NULL)
+    {
+        return -1;
+    }
+    queue->Mask = size - 1;
+    return 0;
+}
+
+void RingQueue_Destroy(RingQueue * queue)
+{
+    free(queue->Entries);
+    memset(queue, 0, sizeof(RingQueue));
+}
+
+bool RingQueue_Push(RingQueue * queue, void * entry)
+{
+    size_t tail = __atomic_load_n(&queue->Tail, __ATOMIC_RELAXED);
+    size_t head = __atomic_load_n(&queue->Head, __ATOMIC_ACQUIRE);
+    if ((queue->Entries == NULL) || (tail - head > queue->Mask))
+    {
+        return false;
+    }
+    queue->Entries[tail & queue->Mask] = entry;
+    __atomic_store_n(&queue->Tail, tail + 1, __ATOMIC_RELEASE);
+    return true;
+}
+
+void * RingQueue_Pop(RingQueue * queue)
+{
+    void * entry = NULL;
+    size_t head = __atomic_load_n(&queue->Head, __ATOMIC_RELAXED);
+    size_t tail = __atomic_load_n(&queue->Tail, __ATOMIC_ACQUIRE);
+    if (head != tail)
+    {
+        entry = queue->Entries[head & queue->Mask];
+        __atomic_store_n(&queue->Head, head + 1, __ATOMIC_RELEASE);
+    }
+    return entry;
+}
+
+size_t RingQueue_Count(RingQueue * queue)
+{
+    return __atomic_load_n(&queue->Tail, __ATOMIC_ACQUIRE) - __atomic_load_n(&queue->Head, __ATOMIC_ACQUIRE);
+}
+
+size_t RingQueue_Capacity(const RingQueue * queue)
+{
+    return (queue->Entries != NULL) ? queue->Mask + 1 : 0;
+}
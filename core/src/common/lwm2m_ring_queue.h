@@ -0,0 +1,64 @@
+/************************************************************************************************************************
+ Copyright (c) 2016, Imagination Technologies Limited and/or its affiliated group companies.
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+ following conditions are met:
+     1. Redistributions of source code must retain the above copyright notice, this list of conditions and the
+        following disclaimer.
+     2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the
+        following disclaimer in the documentation and/or other materials provided with the distribution.
+     3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote
+        products derived from this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+ USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+************************************************************************************************************************/
+
+#ifndef LWM2M_RING_QUEUE_H
+#define LWM2M_RING_QUEUE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ *  Bounded single-producer, single-consumer queue of pointers. One thread pushes and one other thread
+ *  pops, without locks: each side owns one index and publishes it with release ordering, so an entry
+ *  is fully written before the other side can see it. Capacity is rounded up to a power of two.
+ */
+
+typedef struct
+{
+    void ** Entries;
+    size_t Mask;                        // capacity - 1
+    size_t Head;                        // next entry to pop, written only by the consumer
+    size_t Tail;                        // next entry to push, written only by the producer
+} RingQueue;
+
+int RingQueue_Init(RingQueue * queue, size_t capacity);
+void RingQueue_Destroy(RingQueue * queue);
+
+// Returns false if the queue is full
+bool RingQueue_Push(RingQueue * queue, void * entry);
+
+// Returns NULL if the queue is empty
+void * RingQueue_Pop(RingQueue * queue);
+
+// Entries waiting; exact from either thread only while the other is idle
+size_t RingQueue_Count(RingQueue * queue);
+size_t RingQueue_Capacity(const RingQueue * queue);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // LWM2M_RING_QUEUE_H
@@ -120,28 +120,28 @@ int SerialiseResource(AwaContentType type, Lwm2mTreeNode * node, ObjectIDType ob
     return -1;
 }
 
-int DeserialiseObject(AwaContentType type, Lwm2mTreeNode ** dest, const DefinitionRegistry * registry,
+int DeserialiseObject(AwaContentType type, Lwm2mTreeNode ** dest, MemoryArena * arena, const DefinitionRegistry * registry,
                       ObjectIDType objectID, const char * buffer, int bufferLen)
 {
     SerialiserDeserialiser * serdes = GetSerialiserDeserialiser(type);
     if ((serdes != NULL) && serdes->DeserialiseObject)
     {
         SerdesContext serdesContext = NULL;
-        return serdes->DeserialiseObject(&serdesContext, dest, registry, objectID,
+        return serdes->DeserialiseObject(&serdesContext, dest, arena, registry, objectID,
                                          (const uint8_t *)buffer, bufferLen);
     }
     Lwm2m_Error("Deserialiser not found for type %d\n", type);
     return -1;
 }
 
-int DeserialiseObjectInstance(int type, Lwm2mTreeNode ** dest, const DefinitionRegistry * registry, ObjectIDType objectID,
+int DeserialiseObjectInstance(int type, Lwm2mTreeNode ** dest, MemoryArena * arena, const DefinitionRegistry * registry, ObjectIDType objectID,
                               ObjectInstanceIDType objectInstanceID, const char * buffer, int bufferLen)
 {
     SerialiserDeserialiser * serdes = GetSerialiserDeserialiser(type);
     if ((serdes != NULL) && serdes->DeserialiseObjectInstance)
     {
         SerdesContext serdesContext = NULL;
-        return serdes->DeserialiseObjectInstance(&serdesContext, dest, registry, objectID, objectInstanceID,
+        return serdes->DeserialiseObjectInstance(&serdesContext, dest, arena, registry, objectID, objectInstanceID,
                                                  (const uint8_t *)buffer,
                                                  bufferLen);
     }
@@ -149,14 +149,14 @@ int DeserialiseObjectInstance(int type, Lwm2mTreeNode ** dest, const DefinitionR
     return -1;
 }
 
-int DeserialiseResource(int type, Lwm2mTreeNode ** dest, const DefinitionRegistry * registry, ObjectIDType objectID,
+int DeserialiseResource(int type, Lwm2mTreeNode ** dest, MemoryArena * arena, const DefinitionRegistry * registry, ObjectIDType objectID,
                         ObjectInstanceIDType objectInstanceID, ResourceIDType resourceID, const char * buffer, int bufferLen)
 {
     SerialiserDeserialiser * serdes = GetSerialiserDeserialiser(type);
     if ((serdes != NULL) && serdes->DeserialiseResource)
     {
         SerdesContext serdesContext = NULL;
-        return serdes->DeserialiseResource(&serdesContext, dest, registry, objectID, objectInstanceID, resourceID,
+        return serdes->DeserialiseResource(&serdesContext, dest, arena, registry, objectID, objectInstanceID, resourceID,
                                            (const uint8_t *)buffer, bufferLen);
     }
     Lwm2m_Error("Deserialiser not found for type %d\n", type);
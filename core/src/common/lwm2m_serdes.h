@@ -45,10 +45,10 @@ typedef struct
     int (*SerialiseResource)(SerdesContext * serdesContext, Lwm2mTreeNode * node, ObjectIDType objectID,
                              ObjectInstanceIDType objectInstanceID, ResourceIDType resourceID, uint8_t * buffer, int len);
 
-    int (*DeserialiseObject)(SerdesContext * serdesContext, Lwm2mTreeNode ** dest, const DefinitionRegistry * registry, ObjectIDType objectID, const uint8_t * buffer, int len);
-    int (*DeserialiseObjectInstance)(SerdesContext * serdesContext, Lwm2mTreeNode ** dest, const DefinitionRegistry * registry,
+    int (*DeserialiseObject)(SerdesContext * serdesContext, Lwm2mTreeNode ** dest, MemoryArena * arena, const DefinitionRegistry * registry, ObjectIDType objectID, const uint8_t * buffer, int len);
+    int (*DeserialiseObjectInstance)(SerdesContext * serdesContext, Lwm2mTreeNode ** dest, MemoryArena * arena, const DefinitionRegistry * registry,
                                      ObjectIDType objectID, ObjectInstanceIDType objectInstanceID, const uint8_t * buffer, int len);
-    int (*DeserialiseResource)(SerdesContext * serdesContext, Lwm2mTreeNode ** dest,  const DefinitionRegistry * registry,
+    int (*DeserialiseResource)(SerdesContext * serdesContext, Lwm2mTreeNode ** dest, MemoryArena * arena, const DefinitionRegistry * registry,
                                ObjectIDType objectID, ObjectInstanceIDType objectInstanceID, ResourceIDType resourceID, const uint8_t * buffer, int len);
 
 } SerialiserDeserialiser;
@@ -57,10 +57,11 @@ int SerialiseObject(AwaContentType type, Lwm2mTreeNode * node, ObjectIDType obje
 int SerialiseObjectInstance(AwaContentType type, Lwm2mTreeNode * node, ObjectIDType objectID, ObjectInstanceIDType objectInstanceID, char * buffer, int len);
 int SerialiseResource(AwaContentType type, Lwm2mTreeNode * node, ObjectIDType objectID, ObjectInstanceIDType objectInstanceID, ResourceIDType resourceID, char * buffer, int len);
 
-int DeserialiseObject(AwaContentType type, Lwm2mTreeNode ** dest, const DefinitionRegistry * registry, ObjectIDType objectID, const char * buffer, int bufferLen);
-int DeserialiseObjectInstance(AwaContentType type, Lwm2mTreeNode ** dest, const DefinitionRegistry * registry, ObjectIDType objectID,
+// Decoded trees are built in arena, or on the heap if it is NULL
+int DeserialiseObject(AwaContentType type, Lwm2mTreeNode ** dest, MemoryArena * arena, const DefinitionRegistry * registry, ObjectIDType objectID, const char * buffer, int bufferLen);
+int DeserialiseObjectInstance(AwaContentType type, Lwm2mTreeNode ** dest, MemoryArena * arena, const DefinitionRegistry * registry, ObjectIDType objectID,
                               ObjectInstanceIDType objectInstanceID, const char * buffer, int bufferLen);
-int DeserialiseResource(AwaContentType type, Lwm2mTreeNode ** dest, const DefinitionRegistry * registry, ObjectIDType objectID,
+int DeserialiseResource(AwaContentType type, Lwm2mTreeNode ** dest, MemoryArena * arena, const DefinitionRegistry * registry, ObjectIDType objectID,
                         ObjectInstanceIDType objectInstanceID, ResourceIDType resourceID, const char * buffer, int bufferLen);
 
 #ifdef __cplusplus
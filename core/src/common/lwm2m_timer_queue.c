@@ -0,0 +1,210 @@
+/************************************************************************************************************************
+ Copyright (c) 2016, Imagination Technologies Limited and/or its affiliated group companies.
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+ following conditions are met:
+     1. Redistributions of source code must retain the above copyright notice, this list of conditions and the
+        following disclaimer.
+     2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the
+        following disclaimer in the documentation and/or other materials provided with the distribution.
+     3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote
+        products derived from this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+ USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+************************************************************************************************************************/
+
+
+#include <stdlib.h>
+#include <limits.h>
+
+#include "lwm2m_timer_queue.h"
+
+#define TIMER_QUEUE_INITIAL_CAPACITY (16)
+
+// Positions are 1-based so that a zeroed node reads as unscheduled
+#define PARENT(position) ((position) / 2)
+#define LEFT(position)   ((position) * 2)
+
+static TimerQueueNode * NodeAt(const TimerQueue * queue, size_t position)
+{
+    return queue->Nodes[position - 1];
+}
+
+static void Place(TimerQueue * queue, TimerQueueNode * node, size_t position)
+{
+    queue->Nodes[position - 1] = node;
+    node->Position = position;
+}
+
+static void SiftUp(TimerQueue * queue, TimerQueueNode * node, size_t position)
+{
+    while ((position > 1) && (NodeAt(queue, PARENT(position))->Deadline > node->Deadline))
+    {
+        Place(queue, NodeAt(queue, PARENT(position)), position);
+        position = PARENT(position);
+    }
+    Place(queue, node, position);
+}
+
+static void SiftDown(TimerQueue * queue, TimerQueueNode * node, size_t position)
+{
+    while (LEFT(position) <= queue->Count)
+    {
+        size_t child = LEFT(position);
+        if ((child < queue->Count) && (NodeAt(queue, child + 1)->Deadline < NodeAt(queue, child)->Deadline))
+        {
+            child++;
+        }
+        if (NodeAt(queue, child)->Deadline >= node->Deadline)
+        {
+            break;
+        }
+        Place(queue, NodeAt(queue, child), position);
+        position = child;
+    }
+    Place(queue, node, position);
+}
+
+static void Reposition(TimerQueue * queue, TimerQueueNode * node, size_t position)
+{
+    if ((position > 1) && (NodeAt(queue, PARENT(position))->Deadline > node->Deadline))
+    {
+        SiftUp(queue, node, position);
+    }
+    else
+    {
+        SiftDown(queue, node, position);
+    }
+}
+
+void TimerQueue_Init(TimerQueue * queue)
+{
+    queue->Nodes = NULL;
+    queue->Count = 0;
+    queue->Capacity = 0;
+}
+
+void TimerQueue_Destroy(TimerQueue * queue)
+{
+    size_t i;
+    for (i = 0; i < queue->Count; i++)
+    {
+        queue->Nodes[i]->Position = 0;
+    }
+    free(queue->Nodes);
+    TimerQueue_Init(queue);
+}
+
+void TimerQueue_InitNode(TimerQueueNode * node)
+{
+    node->Deadline = 0;
+    node->Position = 0;
+}
+
+bool TimerQueue_IsScheduled(const TimerQueueNode * node)
+{
+    return node->Position != 0;
+}
+
+int TimerQueue_Schedule(TimerQueue * queue, TimerQueueNode * node, uint64_t deadline)
+{
+    int result = 0;
+    if (TimerQueue_IsScheduled(node))
+    {
+        node->Deadline = deadline;
+        Reposition(queue, node, node->Position);
+    }
+    else
+    {
+        if (queue->Count == queue->Capacity)
+        {
+            size_t capacity = (queue->Capacity == 0) ? TIMER_QUEUE_INITIAL_CAPACITY : queue->Capacity * 2;
+            TimerQueueNode ** nodes = realloc(queue->Nodes, capacity * sizeof(TimerQueueNode *));
+            if (nodes != NULL)
+            {
+                queue->Nodes = nodes;
+                queue->Capacity = capacity;
+            }
+            else
+            {
+                result = -1;
+            }
+        }
+
+        if (result == 0)
+        {
+            node->Deadline = deadline;
+            queue->Count++;
+            SiftUp(queue, node, queue->Count);
+        }
+    }
+    return result;
+}
+
+void TimerQueue_Cancel(TimerQueue * queue, TimerQueueNode * node)
+{
+    if (TimerQueue_IsScheduled(node))
+    {
+        size_t position = node->Position;
+        TimerQueueNode * last = NodeAt(queue, queue->Count);
+        queue->Count--;
+        node->Position = 0;
+        if (last != node)
+        {
+            Reposition(queue, last, position);
+        }
+    }
+}
+
+TimerQueueNode * TimerQueue_Peek(const TimerQueue * queue)
+{
+    return (queue->Count > 0) ? NodeAt(queue, 1) : NULL;
+}
+
+TimerQueueNode * TimerQueue_PopExpired(TimerQueue * queue, uint64_t now)
+{
+    TimerQueueNode * node = TimerQueue_Peek(queue);
+    if ((node != NULL) && (node->Deadline <= now))
+    {
+        TimerQueue_Cancel(queue, node);
+    }
+    else
+    {
+        node = NULL;
+    }
+    return node;
+}
+
+int TimerQueue_GetTimeout(const TimerQueue * queue, uint64_t now)
+{
+    int timeout = -1;
+    TimerQueueNode * node = TimerQueue_Peek(queue);
+    if (node != NULL)
+    {
+        if (node->Deadline <= now)
+        {
+            timeout = 0;
+        }
+        else if ((node->Deadline - now) > INT_MAX)
+        {
+            timeout = INT_MAX;
+        }
+        else
+        {
+            timeout = (int)(node->Deadline - now);
+        }
+    }
+    return timeout;
+}
+
+size_t TimerQueue_Count(const TimerQueue * queue)
+{
+    return queue->Count;
+}
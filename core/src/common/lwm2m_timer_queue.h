@@ -0,0 +1,85 @@
+/************************************************************************************************************************
+ Copyright (c) 2016, Imagination Technologies Limited and/or its affiliated group companies.
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+ following conditions are met:
+     1. Redistributions of source code must retain the above copyright notice, this list of conditions and the
+        following disclaimer.
+     2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the
+        following disclaimer in the documentation and/or other materials provided with the distribution.
+     3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote
+        products derived from this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+ USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+************************************************************************************************************************/
+
+
+#ifndef LWM2M_TIMER_QUEUE_H
+#define LWM2M_TIMER_QUEUE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ *  Deadline-ordered timer queue (binary min-heap). Nodes are embedded in the owning structure,
+ *  so scheduling does not allocate per timer; reschedule and cancel are O(log n), finding the
+ *  next deadline is O(1). Deadlines are absolute times in milliseconds, as returned by
+ *  Lwm2mCore_GetTickCountMs().
+ */
+
+typedef struct
+{
+    uint64_t Deadline;
+    size_t Position;                    // 1-based position in the heap, 0 when not scheduled
+} TimerQueueNode;
+
+typedef struct
+{
+    TimerQueueNode ** Nodes;
+    size_t Count;
+    size_t Capacity;
+} TimerQueue;
+
+#define TimerQueueEntry(ptr, type, member) \
+    ((type *)((char *)(ptr) - ((size_t) &((type*)0)->member)))
+
+void TimerQueue_Init(TimerQueue * queue);
+void TimerQueue_Destroy(TimerQueue * queue);
+
+void TimerQueue_InitNode(TimerQueueNode * node);
+bool TimerQueue_IsScheduled(const TimerQueueNode * node);
+
+// Schedule a node, or move it if it is already scheduled. Returns 0 on success, -1 if out of memory.
+int TimerQueue_Schedule(TimerQueue * queue, TimerQueueNode * node, uint64_t deadline);
+
+// Remove a node from the queue. Does nothing if the node is not scheduled.
+void TimerQueue_Cancel(TimerQueue * queue, TimerQueueNode * node);
+
+// Return the node with the earliest deadline, or NULL if the queue is empty
+TimerQueueNode * TimerQueue_Peek(const TimerQueue * queue);
+
+// Remove and return the earliest node if its deadline is at or before now, otherwise return NULL
+TimerQueueNode * TimerQueue_PopExpired(TimerQueue * queue, uint64_t now);
+
+// Milliseconds until the earliest deadline (0 if already due), or -1 if the queue is empty
+int TimerQueue_GetTimeout(const TimerQueue * queue, uint64_t now);
+
+size_t TimerQueue_Count(const TimerQueue * queue);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // LWM2M_TIMER_QUEUE_H
@@ -919,14 +919,14 @@ static int TlvSerialiseObject(SerdesContext * serdesContext, Lwm2mTreeNode * nod
  * @param[in] length length of buffer
  * @return int -1 on error
  */
-static int TlvDeserialiseResourceInstance(Lwm2mTreeNode ** dest, const DefinitionRegistry * registry, ObjectIDType objectID,
+static int TlvDeserialiseResourceInstance(Lwm2mTreeNode ** dest, MemoryArena * arena, const DefinitionRegistry * registry, ObjectIDType objectID,
                                           ObjectInstanceIDType objectInstanceID, ResourceIDType resourceID, int resID, const uint8_t * buffer, int len)
 {
     (void)objectInstanceID;
 
     int result = -1;
 
-    *dest = Lwm2mTreeNode_Create();
+    *dest = Lwm2mTreeNode_CreateInArena(arena);
     Lwm2mTreeNode_SetID(*dest, resID);
     Lwm2mTreeNode_SetType(*dest, Lwm2mTreeNodeType_ResourceInstance);
 
@@ -1004,7 +1004,7 @@ static int TlvDeserialiseResourceInstance(Lwm2mTreeNode ** dest, const Definitio
  * @param[in] length length of buffer
  * @return int -1 on error
  */
-static int TlvDeserialiseResource(SerdesContext * serdesContext, Lwm2mTreeNode ** dest, const DefinitionRegistry * registry,
+static int TlvDeserialiseResource(SerdesContext * serdesContext, Lwm2mTreeNode ** dest, MemoryArena * arena, const DefinitionRegistry * registry,
                                   ObjectIDType objectID, ObjectInstanceIDType objectInstanceID, ResourceIDType resourceID, const uint8_t * buffer, int bufferLen)
 {
     (void)serdesContext;
@@ -1012,7 +1012,7 @@ static int TlvDeserialiseResource(SerdesContext * serdesContext, Lwm2mTreeNode *
     uint16_t identifier;
     ResourceDefinition * definition;
 
-    *dest = Lwm2mTreeNode_Create();
+    *dest = Lwm2mTreeNode_CreateInArena(arena);
     Lwm2mTreeNode_SetID(*dest, resourceID);
     Lwm2mTreeNode_SetType(*dest, Lwm2mTreeNodeType_Resource);
 
@@ -1042,7 +1042,7 @@ static int TlvDeserialiseResource(SerdesContext * serdesContext, Lwm2mTreeNode *
     if (type == TLV_TYPE_IDENT_RESOURCE_VALUE)
     {
         Lwm2mTreeNode * resourceValueNode;
-        int result = TlvDeserialiseResourceInstance(&resourceValueNode, registry, objectID, objectInstanceID, resourceID, 0, &buffer[headerLen], resourceLen);
+        int result = TlvDeserialiseResourceInstance(&resourceValueNode, arena, registry, objectID, objectInstanceID, resourceID, 0, &buffer[headerLen], resourceLen);
         if (result != -1)
         {
             Lwm2mTreeNode_AddChild(*dest, resourceValueNode);
@@ -1093,7 +1093,7 @@ static int TlvDeserialiseResource(SerdesContext * serdesContext, Lwm2mTreeNode *
 
             pos += valueIndex;
 
-            result = TlvDeserialiseResourceInstance(&resourceValueNode, registry, objectID, objectInstanceID, resourceID, identifier, &resourceBuffer[pos], length);
+            result = TlvDeserialiseResourceInstance(&resourceValueNode, arena, registry, objectID, objectInstanceID, resourceID, identifier, &resourceBuffer[pos], length);
 
             if (result == -1)
             {
@@ -1121,12 +1121,12 @@ static int TlvDeserialiseResource(SerdesContext * serdesContext, Lwm2mTreeNode *
  * @param[in] length length of buffer
  * @return int -1 on error
  */
-static int TlvDeserialiseObjectInstance(SerdesContext * serdesContext, Lwm2mTreeNode ** dest, const DefinitionRegistry * registry,
+static int TlvDeserialiseObjectInstance(SerdesContext * serdesContext, Lwm2mTreeNode ** dest, MemoryArena * arena, const DefinitionRegistry * registry,
                                         ObjectIDType objectID, ObjectInstanceIDType objectInstanceID, const uint8_t * buffer, int bufferLen)
 {
     int pos = 0;
 
-    *dest = Lwm2mTreeNode_Create();
+    *dest = Lwm2mTreeNode_CreateInArena(arena);
     Lwm2mTreeNode_SetID(*dest, objectInstanceID);
     Lwm2mTreeNode_SetType(*dest, Lwm2mTreeNodeType_ObjectInstance);
 
@@ -1173,7 +1173,7 @@ static int TlvDeserialiseObjectInstance(SerdesContext * serdesContext, Lwm2mTree
         {
             int result;
             Lwm2mTreeNode * resourceNode;
-            result = TlvDeserialiseResource(serdesContext, &resourceNode, registry, objectID, objectInstanceID, identifier, &buffer[pos], bufferLen - pos);
+            result = TlvDeserialiseResource(serdesContext, &resourceNode, arena, registry, objectID, objectInstanceID, identifier, &buffer[pos], bufferLen - pos);
             if (result < 0)
             {
                 Lwm2mTreeNode_DeleteRecursive(resourceNode);
@@ -1200,12 +1200,12 @@ static int TlvDeserialiseObjectInstance(SerdesContext * serdesContext, Lwm2mTree
  * @param[in] length length of buffer
  * @return int -1 on error
  */
-static int TlvDeserialiseObject(SerdesContext * serdesContext, Lwm2mTreeNode ** dest,
+static int TlvDeserialiseObject(SerdesContext * serdesContext, Lwm2mTreeNode ** dest, MemoryArena * arena,
         const DefinitionRegistry * registry, ObjectIDType objectID, const uint8_t * buffer, int bufferLen)
 {
     int pos = 0;
     ObjectDefinition * definition;
-    *dest = Lwm2mTreeNode_Create();
+    *dest = Lwm2mTreeNode_CreateInArena(arena);
     Lwm2mTreeNode_SetID(*dest, objectID);
     Lwm2mTreeNode_SetType(*dest, Lwm2mTreeNodeType_Object);
 
@@ -1244,7 +1244,7 @@ static int TlvDeserialiseObject(SerdesContext * serdesContext, Lwm2mTreeNode **
 
             // strip off the object instance header, pass instanceID into function.
             pos += headerLen;
-            result = TlvDeserialiseObjectInstance(serdesContext, &instanceNode, registry, objectID, identifier, &buffer[pos], length);
+            result = TlvDeserialiseObjectInstance(serdesContext, &instanceNode, arena, registry, objectID, identifier, &buffer[pos], length);
 
             if(result > 0)
             {
@@ -1265,7 +1265,7 @@ static int TlvDeserialiseObject(SerdesContext * serdesContext, Lwm2mTreeNode **
                 // case where we receive a "CREATE" with no object instance ID (client should generate it)
                 Lwm2mTreeNode * instanceNode;
                 ObjectInstanceIDType objectInstanceID = -1;  // instance ID will be generated
-                result = TlvDeserialiseObjectInstance(serdesContext, &instanceNode, registry, objectID, objectInstanceID, buffer, bufferLen);
+                result = TlvDeserialiseObjectInstance(serdesContext, &instanceNode, arena, registry, objectID, objectInstanceID, buffer, bufferLen);
                 if (result > 0)
                 {
                     Lwm2mTreeNode_AddChild(*dest, instanceNode);
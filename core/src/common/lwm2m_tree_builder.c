@@ -41,11 +41,13 @@
 #include "lwm2m_result.h"
 #include "lwm2m_request_origin.h"
 
-static AwaResult ReadResourceInstanceFromStoreAndCreateTree(Lwm2mTreeNode ** dest, Lwm2mContextType * context, ObjectIDType objectID,
+// If borrowValue is set the node references the value where the core keeps it, instead of copying it,
+// so it must only be used for arena trees, which do not outlive the request that built them.
+static AwaResult ReadResourceInstanceFromStoreAndCreateTree(Lwm2mTreeNode ** dest, MemoryArena * arena, bool borrowValue, Lwm2mContextType * context, ObjectIDType objectID,
                                                             ObjectInstanceIDType objectInstanceID, ResourceIDType resourceID, ResourceInstanceIDType resourceInstanceID)
 {
     AwaResult result = AwaResult_Unspecified;
-    *dest = Lwm2mTreeNode_Create();
+    *dest = Lwm2mTreeNode_CreateInArena(arena);
     const void * value = NULL;
     size_t valueLength = 0;
 
@@ -61,7 +63,8 @@ static AwaResult ReadResourceInstanceFromStoreAndCreateTree(Lwm2mTreeNode ** des
 
     Lwm2m_Debug("Treebuilder length: %d\n", (int)valueLength);
 
-    if (Lwm2mTreeNode_SetValue(*dest, (const uint8_t *)value, valueLength) != 0)
+    if ((borrowValue ? Lwm2mTreeNode_SetValueReference(*dest, (const uint8_t *)value, valueLength)
+                     : Lwm2mTreeNode_SetValue(*dest, (const uint8_t *)value, valueLength)) != 0)
     {
         Lwm2m_Error("ERROR: Failed to set value for resource instance node\n");
         result = AwaResult_BadRequest;
@@ -72,11 +75,11 @@ error:
     return result;
 }
 
-AwaResult TreeBuilder_CreateTreeFromResource(Lwm2mTreeNode ** dest, Lwm2mContextType * context, Lwm2mRequestOrigin requestOrigin,
+AwaResult TreeBuilder_CreateTreeFromResource(Lwm2mTreeNode ** dest, MemoryArena * arena, Lwm2mContextType * context, Lwm2mRequestOrigin requestOrigin,
                                        ObjectIDType objectID, ObjectInstanceIDType objectInstanceID, ResourceIDType resourceID)
 {
     AwaResult result = AwaResult_Unspecified;
-    *dest = Lwm2mTreeNode_Create();
+    *dest = Lwm2mTreeNode_CreateInArena(arena);
     Lwm2mTreeNode_SetID(*dest, resourceID);
     Lwm2mTreeNode_SetType(*dest, Lwm2mTreeNodeType_Resource);
     ResourceDefinition * definition = Definition_LookupResourceDefinition(Lwm2mCore_GetDefinitions(context), objectID, resourceID);
@@ -102,14 +105,18 @@ AwaResult TreeBuilder_CreateTreeFromResource(Lwm2mTreeNode ** dest, Lwm2mContext
         goto error;
     }
 
+    bool borrowValue = (arena != NULL) && Lwm2mCore_IsResourceValueStable(context, objectID, resourceID);
+
     if (IS_MULTIPLE_INSTANCE(definition))
     {
-        int resourceInstanceID = -1;
-        while ((resourceInstanceID = Lwm2mCore_GetNextResourceInstanceID(context, objectID, objectInstanceID, resourceID, resourceInstanceID)) != -1)
+        Lwm2mCoreIterator iterator;
+        int resourceInstanceID;
+        Lwm2mCore_InitIterator(context, &iterator, objectID, objectInstanceID, resourceID);
+        while ((resourceInstanceID = Lwm2mCore_IteratorNext(&iterator)) != -1)
         {
             Lwm2mTreeNode * resourceValueNode;
 
-            if ((result = ReadResourceInstanceFromStoreAndCreateTree(&resourceValueNode, context, objectID, objectInstanceID, resourceID, resourceInstanceID)) == AwaResult_Success)
+            if ((result = ReadResourceInstanceFromStoreAndCreateTree(&resourceValueNode, arena, borrowValue, context, objectID, objectInstanceID, resourceID, resourceInstanceID)) == AwaResult_Success)
             {
                 Lwm2mTreeNode_AddChild(*dest, resourceValueNode);
             }
@@ -125,7 +132,7 @@ AwaResult TreeBuilder_CreateTreeFromResource(Lwm2mTreeNode ** dest, Lwm2mContext
     {
         Lwm2mTreeNode * resourceValueNode;
         int resourceInstanceID = 0;
-        if ((result = ReadResourceInstanceFromStoreAndCreateTree(&resourceValueNode, context, objectID, objectInstanceID, resourceID, resourceInstanceID)) == AwaResult_Success)
+        if ((result = ReadResourceInstanceFromStoreAndCreateTree(&resourceValueNode, arena, borrowValue, context, objectID, objectInstanceID, resourceID, resourceInstanceID)) == AwaResult_Success)
         {
             Lwm2mTreeNode_AddChild(*dest, resourceValueNode);
         }
@@ -141,23 +148,25 @@ error:
     return result;
 }
 
-int TreeBuilder_CreateTreeFromObjectInstance(Lwm2mTreeNode ** dest, Lwm2mContextType * context, Lwm2mRequestOrigin requestOrigin,
+int TreeBuilder_CreateTreeFromObjectInstance(Lwm2mTreeNode ** dest, MemoryArena * arena, Lwm2mContextType * context, Lwm2mRequestOrigin requestOrigin,
                                              ObjectIDType objectID, ObjectInstanceIDType objectInstanceID)
 {
     AwaResult result = AwaResult_Success;
-    *dest = Lwm2mTreeNode_Create();
+    *dest = Lwm2mTreeNode_CreateInArena(arena);
     Lwm2mTreeNode_SetID(*dest, objectInstanceID);
     Lwm2mTreeNode_SetType(*dest, Lwm2mTreeNodeType_ObjectInstance);
 
-    int resourceID = -1;
+    Lwm2mCoreIterator iterator;
+    int resourceID;
 
-    while ((resourceID = Lwm2mCore_GetNextResourceID(context, objectID, objectInstanceID, resourceID)) != -1)
+    Lwm2mCore_InitIterator(context, &iterator, objectID, objectInstanceID, -1);
+    while ((resourceID = Lwm2mCore_IteratorNext(&iterator)) != -1)
     {
         if (Definition_IsResourceTypeExecutable(Lwm2mCore_GetDefinitions(context), objectID, resourceID) == 0)
         {
             Lwm2mTreeNode * resourceNode;
 
-            if ((result = TreeBuilder_CreateTreeFromResource(&resourceNode, context, requestOrigin, objectID, objectInstanceID, resourceID)) == AwaResult_Success)
+            if ((result = TreeBuilder_CreateTreeFromResource(&resourceNode, arena, context, requestOrigin, objectID, objectInstanceID, resourceID)) == AwaResult_Success)
             {
                 Lwm2mTreeNode_AddChild(*dest, resourceNode);
             }
@@ -178,10 +187,10 @@ int TreeBuilder_CreateTreeFromObjectInstance(Lwm2mTreeNode ** dest, Lwm2mContext
     return result;
 }
 
-int TreeBuilder_CreateTreeFromObject(Lwm2mTreeNode ** dest, Lwm2mContextType * context, Lwm2mRequestOrigin requestOrigin, ObjectIDType objectID)
+int TreeBuilder_CreateTreeFromObject(Lwm2mTreeNode ** dest, MemoryArena * arena, Lwm2mContextType * context, Lwm2mRequestOrigin requestOrigin, ObjectIDType objectID)
 {
     AwaResult result = AwaResult_Success;
-    *dest = Lwm2mTreeNode_Create();
+    *dest = Lwm2mTreeNode_CreateInArena(arena);
     Lwm2mTreeNode_SetID(*dest, objectID);
     Lwm2mTreeNode_SetType(*dest, Lwm2mTreeNodeType_Object);
 
@@ -201,11 +210,13 @@ int TreeBuilder_CreateTreeFromObject(Lwm2mTreeNode ** dest, Lwm2mContextType * c
         goto error;
     }
 
-    int instanceID = -1;
-    while ((instanceID = Lwm2mCore_GetNextObjectInstanceID(context, objectID, instanceID)) != -1)
+    Lwm2mCoreIterator iterator;
+    int instanceID;
+    Lwm2mCore_InitIterator(context, &iterator, objectID, -1, -1);
+    while ((instanceID = Lwm2mCore_IteratorNext(&iterator)) != -1)
     {
         Lwm2mTreeNode * objectInstanceNode;
-        if ((result = TreeBuilder_CreateTreeFromObjectInstance(&objectInstanceNode, context, requestOrigin, objectID, instanceID)) == AwaResult_Success)
+        if ((result = TreeBuilder_CreateTreeFromObjectInstance(&objectInstanceNode, arena, context, requestOrigin, objectID, instanceID)) == AwaResult_Success)
         {
             Lwm2mTreeNode_AddChild(*dest, objectInstanceNode);
         }
@@ -226,22 +237,22 @@ error:
     return result;
 }
 
-AwaResult TreeBuilder_CreateTreeFromOIR(Lwm2mTreeNode ** dest, Lwm2mContextType * context, Lwm2mRequestOrigin requestOrigin, int OIR[], int OIRLength)
+AwaResult TreeBuilder_CreateTreeFromOIR(Lwm2mTreeNode ** dest, MemoryArena * arena, Lwm2mContextType * context, Lwm2mRequestOrigin requestOrigin, int OIR[], int OIRLength)
 {
     AwaResult result = AwaResult_Unspecified;
     if (dest != NULL)
     {
         if (OIRLength == 1)
         {
-            result = TreeBuilder_CreateTreeFromObject(dest, context, requestOrigin, OIR[0]);
+            result = TreeBuilder_CreateTreeFromObject(dest, arena, context, requestOrigin, OIR[0]);
         }
         else if (OIRLength == 2)
         {
-            result = TreeBuilder_CreateTreeFromObjectInstance(dest, context, requestOrigin, OIR[0], OIR[1]);
+            result = TreeBuilder_CreateTreeFromObjectInstance(dest, arena, context, requestOrigin, OIR[0], OIR[1]);
         }
         else if (OIRLength == 3)
         {
-            result = TreeBuilder_CreateTreeFromResource(dest, context, requestOrigin, OIR[0], OIR[1], OIR[2]);
+            result = TreeBuilder_CreateTreeFromResource(dest, arena, context, requestOrigin, OIR[0], OIR[1], OIR[2]);
         }
         else
         {
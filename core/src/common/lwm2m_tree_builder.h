@@ -36,11 +36,12 @@ extern "C" {
 #include "lwm2m_request_origin.h"
 #include "lwm2m_result.h"
 
-AwaResult TreeBuilder_CreateTreeFromOIR(Lwm2mTreeNode ** dest, Lwm2mContextType * context, Lwm2mRequestOrigin requestOrigin, int OIR[], int OIRLength);
-AwaResult TreeBuilder_CreateTreeFromObject(Lwm2mTreeNode ** dest, Lwm2mContextType * context, Lwm2mRequestOrigin requestOrigin, ObjectIDType objectID);
-AwaResult TreeBuilder_CreateTreeFromObjectInstance(Lwm2mTreeNode ** dest, Lwm2mContextType * context, Lwm2mRequestOrigin requestOrigin,
+// Trees are built in arena, or on the heap if it is NULL
+AwaResult TreeBuilder_CreateTreeFromOIR(Lwm2mTreeNode ** dest, MemoryArena * arena, Lwm2mContextType * context, Lwm2mRequestOrigin requestOrigin, int OIR[], int OIRLength);
+AwaResult TreeBuilder_CreateTreeFromObject(Lwm2mTreeNode ** dest, MemoryArena * arena, Lwm2mContextType * context, Lwm2mRequestOrigin requestOrigin, ObjectIDType objectID);
+AwaResult TreeBuilder_CreateTreeFromObjectInstance(Lwm2mTreeNode ** dest, MemoryArena * arena, Lwm2mContextType * context, Lwm2mRequestOrigin requestOrigin,
                                              ObjectIDType objectID, ObjectInstanceIDType objectInstanceID);
-AwaResult TreeBuilder_CreateTreeFromResource(Lwm2mTreeNode ** dest, Lwm2mContextType * context, Lwm2mRequestOrigin requestOrigin,
+AwaResult TreeBuilder_CreateTreeFromResource(Lwm2mTreeNode ** dest, MemoryArena * arena, Lwm2mContextType * context, Lwm2mRequestOrigin requestOrigin,
                                        ObjectIDType objectID, ObjectInstanceIDType objectInstanceID, ResourceIDType resourceID);
 
 #ifdef __cplusplus
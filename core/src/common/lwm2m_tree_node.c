@@ -45,6 +45,8 @@ typedef struct
     uint16_t Length;                    // 0 if not a resource instance.
     bool Create;                        // create flag
     bool Replace;                       // replace flag
+    bool Borrowed;                      // Value belongs to the caller of Lwm2mTreeNode_SetValueReference
+    MemoryArena * Arena;                // NULL if the node and its value are on the heap
 
 } _Lwm2mTreeNode;
 
@@ -60,22 +62,41 @@ static void Lwm2mTreeNode_Init(Lwm2mTreeNode * node)
     _node->Definition = NULL;
     _node->Create     = false;
     _node->Replace    = false;
+    _node->Borrowed   = false;
+    _node->Arena      = NULL;
     ListInit(&_node->Children);
 }
 
 Lwm2mTreeNode * Lwm2mTreeNode_Create(void)
 {
-    _Lwm2mTreeNode * node = malloc(sizeof(_Lwm2mTreeNode));
+    return Lwm2mTreeNode_CreateInArena(NULL);
+}
+
+Lwm2mTreeNode * Lwm2mTreeNode_CreateInArena(MemoryArena * arena)
+{
+    _Lwm2mTreeNode * node = (arena != NULL) ? MemoryArena_Alloc(arena, sizeof(_Lwm2mTreeNode)) : malloc(sizeof(_Lwm2mTreeNode));
     if (node == NULL)
     {
         return NULL;
     }
 
     Lwm2mTreeNode_Init((Lwm2mTreeNode *)node);
+    node->Arena = arena;
 
     return (Lwm2mTreeNode *)node;
 }
 
+MemoryArena * Lwm2mTreeNode_GetArena(Lwm2mTreeNode * node)
+{
+    _Lwm2mTreeNode * _node = (_Lwm2mTreeNode *)node;
+    if (node == NULL)
+    {
+        return NULL;
+    }
+
+    return _node->Arena;
+}
+
 int Lwm2mTreeNode_SetType(Lwm2mTreeNode * node, Lwm2mTreeNodeType type)
 {
     _Lwm2mTreeNode * _node = (_Lwm2mTreeNode *)node;
@@ -111,7 +132,28 @@ int Lwm2mTreeNode_SetValue(Lwm2mTreeNode * node, const uint8_t * value, uint16_t
     if ((node == NULL) || (value == NULL))
         return -1;
 
-    if (_node->Length != length)
+    if (_node->Borrowed)
+    {
+        // never write through, or reallocate, memory the node does not own
+        _node->Value = NULL;
+        _node->Length = 0;
+        _node->Borrowed = false;
+    }
+
+    if (_node->Arena != NULL)
+    {
+        // Arena values are never freed, so a shorter value reuses the space of the current one
+        if (length > _node->Length)
+        {
+            void * temp = MemoryArena_Alloc(_node->Arena, length);
+            if (temp == NULL)
+            {
+                return -1;
+            }
+            _node->Value = temp;
+        }
+    }
+    else if (_node->Length != length)
     {
         void * temp = realloc(_node->Value, length);
         if (temp == NULL)
@@ -126,6 +168,29 @@ int Lwm2mTreeNode_SetValue(Lwm2mTreeNode * node, const uint8_t * value, uint16_t
     return 0;
 }
 
+int Lwm2mTreeNode_SetValueReference(Lwm2mTreeNode * node, const uint8_t * value, uint16_t length)
+{
+    _Lwm2mTreeNode * _node = (_Lwm2mTreeNode *)node;
+    if ((node == NULL) || (value == NULL))
+        return -1;
+
+    if ((_node->Arena == NULL) && !_node->Borrowed)
+    {
+        free(_node->Value);
+    }
+    _node->Value = (uint8_t *)value;
+    _node->Length = length;
+    _node->Borrowed = true;
+
+    return 0;
+}
+
+bool Lwm2mTreeNode_IsValueBorrowed(Lwm2mTreeNode * node)
+{
+    _Lwm2mTreeNode * _node = (_Lwm2mTreeNode *)node;
+    return (node != NULL) ? _node->Borrowed : false;
+}
+
 const uint8_t * Lwm2mTreeNode_GetValue(Lwm2mTreeNode * node, uint16_t * length)
 {
     uint8_t * result = NULL;
@@ -251,6 +316,18 @@ int Lwm2mTreeNode_AddChild(Lwm2mTreeNode * node, Lwm2mTreeNode * child)
 
     struct ListHead * i;
     struct ListHead * addPostion = &_node->Children;
+
+    // Trees are mostly built in ID order, so try the end of the list before searching it
+    if (_node->Children.Prev != &_node->Children)
+    {
+        _Lwm2mTreeNode * last = ListEntry(_node->Children.Prev, _Lwm2mTreeNode, _List);
+        if (last->ID <= _child->ID)
+        {
+            ListInsertAfter(&_child->_List, &last->_List);
+            return 0;
+        }
+    }
+
     ListForEach(i, &_node->Children)
     {
         _Lwm2mTreeNode * item = ListEntry(i, _Lwm2mTreeNode, _List);
@@ -354,8 +431,14 @@ int Lwm2mTreeNode_Delete(Lwm2mTreeNode * node)
         ListRemove(&_node->_List);
     }
 
-    free(_node->Value);
-    free(_node);
+    if (_node->Arena == NULL)
+    {
+        if (!_node->Borrowed)
+        {
+            free(_node->Value);
+        }
+        free(_node);
+    }
     return 0;
 }
 
@@ -380,8 +463,14 @@ int Lwm2mTreeNode_DeleteRecursive(Lwm2mTreeNode * node)
         child = next;
     }
 
-    free(_node->Value);
-    free(_node);
+    if (_node->Arena == NULL)
+    {
+        if (!_node->Borrowed)
+        {
+            free(_node->Value);
+        }
+        free(_node);
+    }
     return 0;
 }
 
@@ -411,7 +500,7 @@ Lwm2mTreeNode * Lwm2mTreeNode_FindOrCreateChildNode(Lwm2mTreeNode * parent, int
         child = Lwm2mTreeNode_FindNode(parent, childID);
         if (child == NULL)
         {
-            child = Lwm2mTreeNode_Create();
+            child = Lwm2mTreeNode_CreateInArena(Lwm2mTreeNode_GetArena(parent));
             Lwm2mTreeNode_SetID(child, childID);
             Lwm2mTreeNode_SetType(child, childType);
             Lwm2mTreeNode_SetCreateFlag(child, create);
@@ -444,9 +533,10 @@ static void Lwm2mTreeNode_CopyChildren(Lwm2mTreeNode * parent, Lwm2mTreeNode * p
     while (child != NULL)
     {
         Lwm2mTreeNode * childCopy = Lwm2mTreeNode_Create();
-        Lwm2mTreeNode_AddChild(parentCopy, childCopy);
 
+        // the ID decides where the copy is placed among its siblings
         Lwm2mTreeNode_CopySingleNode(child, childCopy);
+        Lwm2mTreeNode_AddChild(parentCopy, childCopy);
         Lwm2mTreeNode_CopyChildren(child, childCopy);
 
         child = Lwm2mTreeNode_GetNextChild(parent, child);
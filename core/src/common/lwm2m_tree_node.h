@@ -27,10 +27,20 @@
 #include <stdbool.h>
 #include <stdint.h>
 
+#include "lwm2m_arena.h"
+
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+#ifndef LWM2M_TREE_ARENA_INITIAL_SIZE
+    #define LWM2M_TREE_ARENA_INITIAL_SIZE  (512)    // stack block a request handler builds its trees in
+#endif
+
+#ifndef LWM2M_TREE_ARENA_BLOCK_SIZE
+    #define LWM2M_TREE_ARENA_BLOCK_SIZE  (4096)     // heap blocks taken once the stack block is full
+#endif
+
 typedef enum
 {
     Lwm2mTreeNodeType_ResourceInstance,
@@ -45,6 +55,11 @@ typedef struct _Lwm2mTreeNode Lwm2mTreeNode;
 
 Lwm2mTreeNode * Lwm2mTreeNode_Create(void);
 
+// Nodes created in an arena, and their values, are released by MemoryArena_Destroy rather than by
+// Lwm2mTreeNode_Delete. Children made by Lwm2mTreeNode_FindOrCreateChildNode share their parent's arena.
+Lwm2mTreeNode * Lwm2mTreeNode_CreateInArena(MemoryArena * arena);
+MemoryArena * Lwm2mTreeNode_GetArena(Lwm2mTreeNode * node);
+
 int Lwm2mTreeNode_SetType(Lwm2mTreeNode * node, Lwm2mTreeNodeType type);
 Lwm2mTreeNodeType Lwm2mTreeNode_GetType(Lwm2mTreeNode * node);
 
@@ -54,6 +69,11 @@ void * Lwm2mTreeNode_GetDefinition(Lwm2mTreeNode * node);
 int Lwm2mTreeNode_SetValue(Lwm2mTreeNode * node, const uint8_t * value, uint16_t length);
 const uint8_t * Lwm2mTreeNode_GetValue(Lwm2mTreeNode * node, uint16_t * length);
 
+// Point the node at value without copying it, so serialisers read straight from the source. The caller
+// keeps value valid, and unchanged, until the node is deleted or given a new value.
+int Lwm2mTreeNode_SetValueReference(Lwm2mTreeNode * node, const uint8_t * value, uint16_t length);
+bool Lwm2mTreeNode_IsValueBorrowed(Lwm2mTreeNode * node);
+
 int Lwm2mTreeNode_SetID(Lwm2mTreeNode * node, int id);
 int Lwm2mTreeNode_GetID(Lwm2mTreeNode * node, int * id);
 
@@ -80,6 +100,7 @@ int Lwm2mTreeNode_DeleteRecursive(Lwm2mTreeNode * node);
 
 int Lwm2mTreeNode_CompareRecursive(Lwm2mTreeNode * node1, Lwm2mTreeNode * node2);
 
+// The copy is made on the heap, so it may outlive the arena root was created in
 Lwm2mTreeNode * Lwm2mTreeNode_CopyRecursive(Lwm2mTreeNode * root);
 
 #ifdef __cplusplus
@@ -28,6 +28,7 @@
 #include <stdbool.h>
 #include <errno.h>
 #include <inttypes.h>
+#include <limits.h>
 
 #include "lwm2m_util.h"
 #include "lwm2m_list.h"
@@ -67,6 +68,22 @@ const char * OirToUri(ObjectInstanceResourceKey key)
     return &buffer[0];
 }
 
+int Lwm2mCore_GetTimeRemaining(uint32_t now, uint32_t since, uint32_t period)
+{
+    uint32_t elapsed = now - since;
+    uint32_t remaining = (elapsed >= period) ? 0 : period - elapsed;
+    return (remaining > INT_MAX) ? INT_MAX : (int)remaining;
+}
+
+int Lwm2mCore_EarliestTimeout(int timeout1, int timeout2)
+{
+    if ((timeout1 < 0) || ((timeout2 >= 0) && (timeout2 < timeout1)))
+    {
+        return timeout2;
+    }
+    return timeout1;
+}
+
 int8_t ptrToInt8(void * ptr)
 {
     int8_t temp = 0;
@@ -53,6 +53,12 @@ const char * OirToUri(ObjectInstanceResourceKey key);
 // Get the system tick count in milliseconds
 uint64_t Lwm2mCore_GetTickCountMs(void);
 
+// Milliseconds left of a period that started at since, or 0 if it has passed. Handles 32-bit tick counts wrapping.
+int Lwm2mCore_GetTimeRemaining(uint32_t now, uint32_t since, uint32_t period);
+
+// The sooner of two timeouts in milliseconds, where -1 means none
+int Lwm2mCore_EarliestTimeout(int timeout1, int timeout2);
+
 int8_t ptrToInt8(void * ptr);
 int16_t ptrToInt16(void * ptr);
 int32_t ptrToInt32(void * ptr);
@@ -60,8 +60,15 @@ NetworkAddress * NetworkAddress_New(const char * uri, int uriLength);
 
 int NetworkAddress_Compare(NetworkAddress * addressX, NetworkAddress * addressY);
 
+// Hash of the address and port, consistent with NetworkAddress_Compare
+uint32_t NetworkAddress_Hash(const NetworkAddress * address);
+
 void NetworkAddress_SetAddressType(NetworkAddress * address, AddressType * addressType);
 
+// Take another reference to an address, e.g. one returned by NetworkSocket_Read that is kept after the next read.
+// Each reference is released with NetworkAddress_Free.
+NetworkAddress * NetworkAddress_Retain(NetworkAddress * address);
+
 void NetworkAddress_Free(NetworkAddress ** address);
 
 bool NetworkAddress_IsSecure(const NetworkAddress * address);
@@ -72,6 +79,10 @@ NetworkSocketError NetworkSocket_GetError(NetworkSocket * networkSocket);
 
 int NetworkSocket_GetFileDescriptor(NetworkSocket * networkSocket);
 
+// Fill fds with every descriptor the socket reads from, e.g. both its IPv4 and IPv6 sockets, so a caller can wait
+// on all of them. Returns the number filled in, at most maxFds.
+int NetworkSocket_GetFileDescriptors(NetworkSocket * networkSocket, int * fds, int maxFds);
+
 void NetworkSocket_SetCertificate(NetworkSocket * networkSocket, const uint8_t * cert, int certLength, AwaCertificateFormat format);
 
 void NetworkSocket_SetPSK(NetworkSocket * networkSocket, const char * identity, const uint8_t * key, int keyLength);
@@ -84,6 +95,15 @@ bool NetworkSocket_Read(NetworkSocket * networkSocket, uint8_t * buffer, int buf
 
 bool NetworkSocket_Send(NetworkSocket * networkSocket, NetworkAddress * destAddress, uint8_t * buffer, int bufferLength);
 
+// Between StartBatch and EndBatch datagrams sent on the socket are held, then sent together by EndBatch.
+// EndBatch returns false if any could not be sent.
+void NetworkSocket_StartBatch(NetworkSocket * networkSocket);
+bool NetworkSocket_EndBatch(NetworkSocket * networkSocket);
+
+// True if the last read fetched more datagrams than it returned, which NetworkSocket_Read hands out
+// without waiting for the socket to become readable again
+bool NetworkSocket_HasPendingReads(NetworkSocket * networkSocket);
+
 void NetworkSocket_Free(NetworkSocket ** networkSocket);
 
 #ifdef __cplusplus
@@ -33,6 +33,7 @@
 #endif
 
 #include "lwm2m_debug.h"
+#include "lwm2m_hash_table.h"
 #include "lwm2m_util.h"
 #include "network_abstraction.h"
 #include "dtls_abstraction.h"
@@ -283,6 +284,15 @@ void NetworkAddress_SetAddressType(NetworkAddress * address, AddressType * addre
     }
 }
 
+NetworkAddress * NetworkAddress_Retain(NetworkAddress * address)
+{
+    if (address)
+    {
+        address->useCount++;
+    }
+    return address;
+}
+
 void NetworkAddress_Free(NetworkAddress ** address)
 {
     // TODO - review when addresses are freed (e.g. after client bootstrap, or connection lost ?)
@@ -307,6 +317,16 @@ void NetworkAddress_Free(NetworkAddress ** address)
     }
 }
 
+uint32_t NetworkAddress_Hash(const NetworkAddress * address)
+{
+    uint32_t result = 0;
+    if (address)
+    {
+        result = HashTable_HashBytes(&address->Address, sizeof(uip_ipaddr_t)) ^ address->Port;
+    }
+    return result;
+}
+
 bool NetworkAddress_IsSecure(const NetworkAddress * address)
 {
     bool result = false;
@@ -393,6 +413,14 @@ int NetworkSocket_GetFileDescriptor(NetworkSocket * networkSocket)
     return result;
 }
 
+int NetworkSocket_GetFileDescriptors(NetworkSocket * networkSocket, int * fds, int maxFds)
+{
+    (void)networkSocket;
+    (void)fds;
+    (void)maxFds;
+    return 0;
+}
+
 void NetworkSocket_SetCertificate(NetworkSocket * networkSocket, const uint8_t * cert, int certLength, AwaCertificateFormat format)
 {
     DTLS_SetCertificate(cert, certLength, format);
@@ -481,13 +509,8 @@ bool NetworkSocket_Read(NetworkSocket * networkSocket, uint8_t * buffer, int buf
                    }
                    if ((*readLength > 0) && *sourceAddress && (*sourceAddress)->Secure)
                    {
-                       if (DTLS_Decrypt(*sourceAddress, buffer, *readLength, encryptBuffer, ENCRYPT_BUFFER_LENGTH, readLength, networkSocket))
-                       {
-                           if (*readLength > 0)
-                           {
-                               memcpy(buffer, encryptBuffer, *readLength);
-                           }
-                       }
+                       // decrypt in place: the plaintext is never longer than the record it came from
+                       DTLS_Decrypt(*sourceAddress, buffer, *readLength, buffer, bufferLength, readLength, networkSocket);
                    }
                 }
                 else
@@ -554,6 +577,23 @@ bool NetworkSocket_Send(NetworkSocket * networkSocket, NetworkAddress * destAddr
     return result;
 }
 
+// uIP hands over one datagram per event and sends each straight away, so batches are empty
+void NetworkSocket_StartBatch(NetworkSocket * networkSocket)
+{
+    (void)networkSocket;
+}
+
+bool NetworkSocket_EndBatch(NetworkSocket * networkSocket)
+{
+    return networkSocket && (networkSocket->LastError == NetworkSocketError_NoError);
+}
+
+bool NetworkSocket_HasPendingReads(NetworkSocket * networkSocket)
+{
+    (void)networkSocket;
+    return false;
+}
+
 void NetworkSocket_Free(NetworkSocket ** networkSocket)
 {
     if (networkSocket && *networkSocket)
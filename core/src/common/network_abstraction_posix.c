@@ -28,13 +28,16 @@
 #include <unistd.h>
 
 #include <sys/socket.h>
+#include <sys/uio.h>
 #define SOCKET_ERROR            (-1)
 #include <netinet/in.h>
 #include <arpa/inet.h>
 
 #include "lwm2m_debug.h"
+#include "lwm2m_hash_table.h"
+#include "lwm2m_list.h"
 #include "lwm2m_util.h"
-#include "network_abstraction.h"
+#include "network_abstraction_posix.h"
 #include "dtls_abstraction.h"
 
 struct _NetworkAddress
@@ -48,8 +51,36 @@ struct _NetworkAddress
     } Address;
     bool Secure;
     int useCount;
+    bool Cached;                        // in networkAddressCache, and freed from there
+    HashTableNode AddressNode;
+    HashTableNode UriNode;              // indexed by uri only if Uri is set
+    char * Uri;
+    int UriLength;
+    struct ListHead IdleList;           // linked while useCount is 0
+    uint64_t LastUsed;
 };
 
+// recvmmsg and sendmmsg are Linux only; elsewhere a batch is filled and sent one datagram at a time
+#if defined(__linux__) && !defined(RIOT)
+    #define USE_MMSG
+#endif
+
+typedef struct
+{
+    struct sockaddr_storage Address;
+    socklen_t AddressLength;
+    int Socket;                         // the IPv4 or IPv6 socket a held datagram goes out on
+    int Length;
+    uint8_t Data[NETWORK_BATCH_DATAGRAM_SIZE];
+} NetworkDatagram;
+
+typedef struct
+{
+    NetworkDatagram Datagrams[NETWORK_BATCH_SIZE];
+    int Count;
+    int Next;                           // next received datagram to hand out
+} NetworkBatch;
+
 struct _NetworkSocket
 {
     int Socket;
@@ -58,14 +89,14 @@ struct _NetworkSocket
     NetworkSocketType SocketType;
     uint16_t Port;
     NetworkSocketError LastError;
+    uint8_t * SendBuffer;       // holds encrypted records on their way out, grown to fit the largest sent
+    int SendBufferLength;
+    int BatchSize;              // datagrams moved per system call, 1 to read and send them one at a time
+    bool Batching;              // between NetworkSocket_StartBatch and NetworkSocket_EndBatch
+    NetworkBatch * Received;    // read ahead by the last receive, allocated on first use
+    NetworkBatch * Held;        // sends held until the batch ends
 };
 
-typedef struct
-{
-    char * uri;
-    NetworkAddress * address;
-} NetworkAddressCache;
-
 typedef enum
 {
     UriParseState_Scheme,
@@ -75,95 +106,189 @@ typedef enum
 
 #define MAX_URI_LENGTH  (256)
 
-#ifndef MAX_NETWORK_ADDRESS_CACHE
-    #define MAX_NETWORK_ADDRESS_CACHE  (5)
-#endif
-
-static NetworkAddressCache networkAddressCache[MAX_NETWORK_ADDRESS_CACHE] = {{0}};
+/* Every address handed out is kept in a table hashed by address and port, and by the uri it was
+ * created from, so a datagram from a known peer costs one hash lookup and no allocation. Addresses
+ * nobody holds a reference to (useCount 0) sit on an idle list in least recently used order and
+ * are evicted once idle for longer than the timeout, or when there are more than the idle limit.
+ * An address returned by NetworkSocket_Read holds no reference and remains valid until the next
+ * read; anything that keeps it for longer must take one with NetworkAddress_Retain.
+ */
+typedef struct
+{
+    HashTable AddressIndex;
+    HashTable UriIndex;
+    struct ListHead IdleList;
+    size_t NumIdle;
+    size_t MaxIdle;
+    uint64_t IdleTimeout;
+    NetworkAddressCacheStats Stats;
+} NetworkAddressCache;
 
-#ifndef ENCRYPT_BUFFER_LENGTH
-#define ENCRYPT_BUFFER_LENGTH 1024
-#endif
+static NetworkAddressCache networkAddressCache = { .IdleList = LIST_INIT(networkAddressCache.IdleList), .MaxIdle = NETWORK_ADDRESS_CACHE_MAX_IDLE, .IdleTimeout = NETWORK_ADDRESS_CACHE_IDLE_TIMEOUT };
 
-static uint8_t encryptBuffer[ENCRYPT_BUFFER_LENGTH];
+static uint32_t hashUri(const char * uri, int uriLength)
+{
+    return HashTable_HashBytes(uri, uriLength);
+}
 
 static NetworkAddress * getCachedAddressByUri(const char * uri, int uriLength)
 {
     NetworkAddress * result = NULL;
-    int index;
-    for (index = 0; index < MAX_NETWORK_ADDRESS_CACHE; index++)
+    HashTableNode * node;
+    for (node = HashTable_FindFirst(&networkAddressCache.UriIndex, hashUri(uri, uriLength)); node != NULL; node = HashTable_FindNext(node))
     {
-        if (networkAddressCache[index].uri && (memcmp(networkAddressCache[index].uri, uri, uriLength) == 0))
+        NetworkAddress * address = HashTableEntry(node, NetworkAddress, UriNode);
+        if ((address->UriLength == uriLength) && (memcmp(address->Uri, uri, uriLength) == 0))
         {
-            //Lwm2m_Debug("Address uri matched: %s\n", networkAddressCache[index].uri);
-            result = networkAddressCache[index].address;
+            result = address;
             break;
         }
     }
     return result;
 }
 
-static NetworkAddress * getCachedAddress(NetworkAddress * matchAddress, const char * uri, int uriLength)
+static NetworkAddress * getCachedAddress(NetworkAddress * matchAddress)
 {
     NetworkAddress * result = NULL;
-    int index;
-    for (index = 0; index < MAX_NETWORK_ADDRESS_CACHE; index++)
+    HashTableNode * node;
+    for (node = HashTable_FindFirst(&networkAddressCache.AddressIndex, NetworkAddress_Hash(matchAddress)); node != NULL; node = HashTable_FindNext(node))
     {
-        NetworkAddress * address = networkAddressCache[index].address;
-        if (address)
+        NetworkAddress * address = HashTableEntry(node, NetworkAddress, AddressNode);
+        if (NetworkAddress_Compare(matchAddress, address) == 0)
         {
-            if (NetworkAddress_Compare(matchAddress, address) == 0)
+            result = address;
+            break;
+        }
+    }
+    return result;
+}
+
+static void setCachedAddressUri(NetworkAddress * address, const char * uri, int uriLength)
+{
+    if (address->Uri == NULL && uri && uriLength > 0)
+    {
+        address->Uri = (char *)malloc(uriLength + 1);
+        if (address->Uri)
+        {
+            memcpy(address->Uri, uri, uriLength);
+            address->Uri[uriLength] = 0;
+            address->UriLength = uriLength;
+            if (HashTable_Insert(&networkAddressCache.UriIndex, &address->UriNode, hashUri(uri, uriLength)) == 0)
             {
-                if (uri && uriLength > 0 && networkAddressCache[index].uri == NULL)
-                {
-                    // Add info to cached address
-                    address->Secure = matchAddress->Secure;
-                    networkAddressCache[index].uri = (char *)malloc(uriLength + 1);
-                    if (networkAddressCache[index].uri)
-                    {
-                        memcpy(networkAddressCache[index].uri, uri, uriLength);
-                        networkAddressCache[index].uri[uriLength] = 0;
-                        Lwm2m_Debug("Address add uri: %s\n", networkAddressCache[index].uri);
-                    }
-                }
-                result = address;
-                break;
+                Lwm2m_Debug("Address add uri: %s\n", address->Uri);
+            }
+            else
+            {
+                free(address->Uri);
+                address->Uri = NULL;
+                address->UriLength = 0;
             }
         }
     }
+}
+
+static bool addCachedAddress(NetworkAddress * address, const char * uri, int uriLength)
+{
+    bool result = false;
+    if (HashTable_Insert(&networkAddressCache.AddressIndex, &address->AddressNode, NetworkAddress_Hash(address)) == 0)
+    {
+        address->Cached = true;
+        setCachedAddressUri(address, uri, uriLength);
+        networkAddressCache.Stats.Live++;
+        if (networkAddressCache.Stats.Live > networkAddressCache.Stats.PeakLive)
+            networkAddressCache.Stats.PeakLive = networkAddressCache.Stats.Live;
+        result = true;
+    }
     return result;
 }
 
-static void addCachedAddress(NetworkAddress * address, const char * uri, int uriLength)
+static void freeCachedAddress(NetworkAddress * address)
+{
+    if (address->Uri)
+    {
+        Lwm2m_Debug("Address free: %s\n", address->Uri);
+        HashTable_Remove(&networkAddressCache.UriIndex, &address->UriNode);
+        free(address->Uri);
+    }
+    HashTable_Remove(&networkAddressCache.AddressIndex, &address->AddressNode);
+    networkAddressCache.Stats.Live--;
+    free(address);
+}
+
+// Put an address nobody references at the most recently used end of the idle list
+static void setAddressIdle(NetworkAddress * address, uint64_t now)
+{
+    if (address->IdleList.Next != &address->IdleList)
+        ListRemove(&address->IdleList);
+    else
+        networkAddressCache.NumIdle++;
+    ListAdd(&address->IdleList, &networkAddressCache.IdleList);
+    address->LastUsed = now;
+}
+
+static void evictIdleAddresses(uint64_t now)
+{
+    while (networkAddressCache.NumIdle > 0)
+    {
+        NetworkAddress * oldest = ListEntry(networkAddressCache.IdleList.Next, NetworkAddress, IdleList);
+        if ((networkAddressCache.NumIdle <= networkAddressCache.MaxIdle) && (now - oldest->LastUsed < networkAddressCache.IdleTimeout))
+            break;
+        ListRemove(&oldest->IdleList);
+        networkAddressCache.NumIdle--;
+        networkAddressCache.Stats.Evicted++;
+        freeCachedAddress(oldest);
+    }
+}
+
+NetworkAddress * NetworkAddress_Retain(NetworkAddress * address)
 {
     if (address)
     {
-        int index;
-        for (index = 0; index < MAX_NETWORK_ADDRESS_CACHE; index++)
+        if (address->useCount == 0 && address->IdleList.Next != &address->IdleList)
         {
-            if (networkAddressCache[index].address == NULL)
-            {
-                if (uri && uriLength > 0)
-                {
-                    networkAddressCache[index].uri = (char *)malloc(uriLength + 1);
-                    if (networkAddressCache[index].uri)
-                    {
-                        memcpy(networkAddressCache[index].uri, uri, uriLength);
-                        networkAddressCache[index].uri[uriLength] = 0;
-                        networkAddressCache[index].address = address;
-                        Lwm2m_Debug("Address add: %s\n", networkAddressCache[index].uri);
-                    }
-                }
-                else
-                {
-                    networkAddressCache[index].address = address;
-                    networkAddressCache[index].uri = NULL;
-                    Lwm2m_Debug("Address add (received)\n");    // TODO - print remote address
-                }
-                break;
-            }
+            ListRemove(&address->IdleList);
+            networkAddressCache.NumIdle--;
         }
+        address->useCount++;
     }
+    return address;
+}
+
+void NetworkAddress_SetCacheLimits(size_t maxIdle, uint64_t idleTimeoutMs)
+{
+    networkAddressCache.MaxIdle = maxIdle;
+    networkAddressCache.IdleTimeout = idleTimeoutMs;
+    evictIdleAddresses(Lwm2mCore_GetTickCountMs());
+}
+
+void NetworkAddress_GetCacheStats(NetworkAddressCacheStats * stats)
+{
+    if (stats)
+    {
+        *stats = networkAddressCache.Stats;
+        stats->Idle = networkAddressCache.NumIdle;
+    }
+}
+
+int NetworkAddress_GetShard(const NetworkAddress * address, int numShards)
+{
+    int result = 0;
+    if (address && (numShards > 1))
+    {
+        uint32_t hash = 0;
+        if (address->Address.Sa.sa_family == AF_INET)
+        {
+            hash = ntohl(address->Address.Sin.sin_addr.s_addr) ^ ntohs(address->Address.Sin.sin_port);
+        }
+        else if (address->Address.Sa.sa_family == AF_INET6)
+        {
+            uint32_t words[4];
+            memcpy(words, &address->Address.Sin6.sin6_addr, sizeof(words));
+            hash = ntohl(words[0]) ^ ntohl(words[1]) ^ ntohl(words[2]) ^ ntohl(words[3]) ^ ntohs(address->Address.Sin6.sin6_port);
+        }
+        result = ((hash * 0x9E3779B1) >> 16) % numShards;
+    }
+    return result;
 }
 
 static int getUriHostLength(const char * uri, int uriLength)
@@ -187,12 +312,110 @@ static int getUriHostLength(const char * uri, int uriLength)
     return result;
 }
 
+static NetworkBatch * getBatch(NetworkBatch ** batch)
+{
+    if (*batch == NULL)
+    {
+        *batch = (NetworkBatch *)malloc(sizeof(NetworkBatch));
+        if (*batch)
+        {
+            (*batch)->Count = 0;
+            (*batch)->Next = 0;
+        }
+        else
+        {
+            Lwm2m_Error("Failed to allocate datagram batch\n");
+        }
+    }
+    return *batch;
+}
+
+static void flushHeldDatagrams(NetworkSocket * networkSocket)
+{
+    NetworkBatch * batch = networkSocket->Held;
+    int index = 0;
+    while (batch && (index < batch->Count))
+    {
+#ifdef USE_MMSG
+        // one sendmmsg per run of datagrams going out on the same socket
+        struct mmsghdr messages[NETWORK_BATCH_SIZE];
+        struct iovec vectors[NETWORK_BATCH_SIZE];
+        int socketHandle = batch->Datagrams[index].Socket;
+        int count = 0;
+        while ((index + count < batch->Count) && (batch->Datagrams[index + count].Socket == socketHandle))
+        {
+            NetworkDatagram * datagram = &batch->Datagrams[index + count];
+            vectors[count].iov_base = datagram->Data;
+            vectors[count].iov_len = datagram->Length;
+            memset(&messages[count], 0, sizeof(messages[count]));
+            messages[count].msg_hdr.msg_name = &datagram->Address;
+            messages[count].msg_hdr.msg_namelen = datagram->AddressLength;
+            messages[count].msg_hdr.msg_iov = &vectors[count];
+            messages[count].msg_hdr.msg_iovlen = 1;
+            count++;
+        }
+        int sent = sendmmsg(socketHandle, messages, count, 0);
+        if (sent == SOCKET_ERROR)
+        {
+            if ((errno != EWOULDBLOCK) && (errno != EINTR))
+            {
+                // drop the datagram that failed and carry on with the rest
+                networkSocket->LastError = NetworkSocketError_SendError;
+                index++;
+            }
+        }
+        else
+        {
+            index += sent;
+        }
+#else
+        NetworkDatagram * datagram = &batch->Datagrams[index];
+        if ((sendto(datagram->Socket, datagram->Data, datagram->Length, 0, (struct sockaddr *)&datagram->Address, datagram->AddressLength) != SOCKET_ERROR) ||
+            ((errno != EWOULDBLOCK) && (errno != EINTR)))
+        {
+            index++;
+        }
+#endif
+    }
+    if (batch)
+    {
+        batch->Count = 0;
+    }
+}
+
+// Keep a datagram to send when the batch ends. Returns false if it has to be sent now.
+static bool holdDatagram(NetworkSocket * networkSocket, int socketHandle, NetworkAddress * destAddress, const uint8_t * buffer, int bufferLength)
+{
+    bool result = false;
+    NetworkBatch * batch;
+    if (networkSocket->Batching && (networkSocket->BatchSize > 1) && (bufferLength <= NETWORK_BATCH_DATAGRAM_SIZE) &&
+        ((batch = getBatch(&networkSocket->Held)) != NULL))
+    {
+        if (batch->Count >= networkSocket->BatchSize)
+        {
+            flushHeldDatagrams(networkSocket);
+        }
+        NetworkDatagram * datagram = &batch->Datagrams[batch->Count++];
+        memcpy(&datagram->Address, &destAddress->Address, sizeof(datagram->Address));
+        datagram->AddressLength = sizeof(struct sockaddr_storage);
+        datagram->Socket = socketHandle;
+        datagram->Length = bufferLength;
+        memcpy(datagram->Data, buffer, bufferLength);
+        result = true;
+    }
+    return result;
+}
+
 static bool sendUDP(NetworkSocket * networkSocket, NetworkAddress * destAddress, const uint8_t * buffer, int bufferLength)
 {
     bool result = false;
     int socketHandle = networkSocket->Socket;
     if (destAddress->Address.Sa.sa_family == AF_INET6)
         socketHandle = networkSocket->SocketIPv6;
+    if (holdDatagram(networkSocket, socketHandle, destAddress, buffer, bufferLength))
+        return true;
+    // datagrams held earlier, e.g. for the same peer, must not be overtaken by one too large to hold
+    flushHeldDatagrams(networkSocket);
     size_t addressLength = sizeof(struct sockaddr_storage);
     while (bufferLength > 0)
     {
@@ -232,12 +455,25 @@ static NetworkTransmissionError SendDTLS(NetworkAddress * destAddress, const uin
     return result;
 }
 
-NetworkAddress * NetworkAddress_FromIPAddress(const char * ipAddress, uint16_t port)
+// Allocates an address holding one reference, not yet in the cache
+static NetworkAddress * newAddress(void)
 {
-    NetworkAddress * result;
     size_t size = sizeof(struct _NetworkAddress);
-    result = (NetworkAddress *)malloc(size);
-    memset(result, 0, size);
+    NetworkAddress * result = (NetworkAddress *)malloc(size);
+    if (result)
+    {
+        memset(result, 0, size);
+        ListInit(&result->IdleList);
+        result->useCount = 1;
+    }
+    return result;
+}
+
+NetworkAddress * NetworkAddress_FromIPAddress(const char * ipAddress, uint16_t port)
+{
+    NetworkAddress * result = newAddress();
+    if (!result)
+        return NULL;
     if (inet_pton(AF_INET, ipAddress, &result->Address.Sin.sin_addr) == 1)
     {
         result->Address.Sin.sin_family = AF_INET;
@@ -265,6 +501,7 @@ NetworkSocket * NetworkSocket_New(const char * ipAddress, NetworkSocketType sock
         memset(result, 0, size);
         result->SocketType = socketType;
         result->Port = port;
+        result->BatchSize = NETWORK_BATCH_SIZE;
         DTLS_SetNetworkSendCallback(SendDTLS);
         if (ipAddress && (*ipAddress != '\0'))
         {
@@ -315,6 +552,23 @@ int NetworkAddress_Compare(NetworkAddress * address1, NetworkAddress * address2)
     return result;
 }
 
+uint32_t NetworkAddress_Hash(const NetworkAddress * address)
+{
+    uint32_t result = 0;
+    if (address)
+    {
+        if (address->Address.Sa.sa_family == AF_INET)
+        {
+            result = HashTable_HashBytes(&address->Address.Sin.sin_addr, sizeof(address->Address.Sin.sin_addr)) ^ address->Address.Sin.sin_port;
+        }
+        else if (address->Address.Sa.sa_family == AF_INET6)
+        {
+            result = HashTable_HashBytes(&address->Address.Sin6.sin6_addr, sizeof(address->Address.Sin6.sin6_addr)) ^ address->Address.Sin6.sin6_port;
+        }
+    }
+    return result;
+}
+
 bool NetworkAddress_IsSecure(const NetworkAddress * address)
 {
     bool result = false;
@@ -347,6 +601,19 @@ int NetworkSocket_GetFileDescriptor(NetworkSocket * networkSocket)
     return result;
 }
 
+int NetworkSocket_GetFileDescriptors(NetworkSocket * networkSocket, int * fds, int maxFds)
+{
+    int count = 0;
+    if (networkSocket && fds)
+    {
+        if ((count < maxFds) && (networkSocket->Socket != SOCKET_ERROR))
+            fds[count++] = networkSocket->Socket;
+        if ((count < maxFds) && (networkSocket->SocketIPv6 != SOCKET_ERROR))
+            fds[count++] = networkSocket->SocketIPv6;
+    }
+    return count;
+}
+
 void NetworkSocket_Free(NetworkSocket ** networkSocket)
 {
     if (networkSocket && *networkSocket)
@@ -357,11 +624,32 @@ void NetworkSocket_Free(NetworkSocket ** networkSocket)
             close((*networkSocket)->SocketIPv6);
         if ((*networkSocket)->BindAddress)
             NetworkAddress_Free(&(*networkSocket)->BindAddress);
+        free((*networkSocket)->SendBuffer);
+        free((*networkSocket)->Received);
+        free((*networkSocket)->Held);
+        evictIdleAddresses(UINT64_MAX);
         free(*networkSocket);
         *networkSocket = NULL;
     }
 }
 
+// Each socket keeps its own buffer for outgoing records, sized to the largest message sent so far
+static uint8_t * getSendBuffer(NetworkSocket * networkSocket, int length)
+{
+    if (length > networkSocket->SendBufferLength)
+    {
+        uint8_t * sendBuffer = (uint8_t *)realloc(networkSocket->SendBuffer, length);
+        if (!sendBuffer)
+        {
+            Lwm2m_Error("Failed to allocate %d byte send buffer\n", length);
+            return NULL;
+        }
+        networkSocket->SendBuffer = sendBuffer;
+        networkSocket->SendBufferLength = length;
+    }
+    return networkSocket->SendBuffer;
+}
+
 bool NetworkSocket_Send(NetworkSocket * networkSocket, NetworkAddress * destAddress, uint8_t * buffer, int bufferLength)
 {
     bool result = false;
@@ -377,9 +665,10 @@ bool NetworkSocket_Send(NetworkSocket * networkSocket, NetworkAddress * destAddr
                     if (destAddress->Secure)
                     {
                         int encryptedBytes;
-                        if (DTLS_Encrypt(destAddress, buffer, bufferLength, encryptBuffer, ENCRYPT_BUFFER_LENGTH, &encryptedBytes, networkSocket))
+                        uint8_t * sendBuffer = getSendBuffer(networkSocket, bufferLength + DTLS_MAX_RECORD_OVERHEAD);
+                        if (sendBuffer && DTLS_Encrypt(destAddress, buffer, bufferLength, sendBuffer, networkSocket->SendBufferLength, &encryptedBytes, networkSocket))
                         {
-                            buffer = encryptBuffer;
+                            buffer = sendBuffer;
                             bufferLength = encryptedBytes;
                         }
                         else
@@ -434,15 +723,137 @@ void NetworkAddress_SetAddressType(NetworkAddress * address, AddressType * addre
     }
 }
 
+// The cached address a datagram came from; it holds no reference and stays valid until the next read
+static NetworkAddress * getSourceAddress(NetworkSocket * networkSocket, const struct sockaddr_storage * sourceSocket, socklen_t sourceSocketLength)
+{
+    NetworkAddress * networkAddress = NULL;
+    NetworkAddress matchAddress;
+    uint64_t now = Lwm2mCore_GetTickCountMs();
+    memset(&matchAddress, 0, sizeof(matchAddress));
+    memcpy(&matchAddress.Address.Sa, sourceSocket, sourceSocketLength);
+
+    // The address returned by the previous read is no longer in use, so idle addresses may go now
+    evictIdleAddresses(now);
+    networkAddress = getCachedAddress(&matchAddress);
+    if (networkAddress)
+    {
+        networkAddressCache.Stats.Hits++;
+    }
+    else
+    {
+        networkAddressCache.Stats.Misses++;
+        networkAddress = newAddress();
+        if (networkAddress)
+        {
+            // Uri is unknown until the address is looked up by NetworkAddress_New
+            memcpy(&networkAddress->Address, &matchAddress.Address, sizeof(networkAddress->Address));
+            networkAddress->Secure = (networkSocket->SocketType & NetworkSocketType_Secure) == NetworkSocketType_Secure;
+            networkAddress->useCount = 0;
+            if (!addCachedAddress(networkAddress, NULL, 0))
+            {
+                free(networkAddress);
+                networkAddress = NULL;
+            }
+        }
+    }
+    if (networkAddress && networkAddress->useCount == 0)
+    {
+        setAddressIdle(networkAddress, now);
+    }
+    return networkAddress;
+}
+
+// Read as many datagrams as have arrived, up to the batch size. Returns the number read, or -1 on error.
+static int receiveBatch(NetworkSocket * networkSocket, int socketHandle, NetworkBatch * batch)
+{
+    int count = 0;
+#ifdef USE_MMSG
+    struct mmsghdr messages[NETWORK_BATCH_SIZE];
+    struct iovec vectors[NETWORK_BATCH_SIZE];
+    int index;
+    memset(messages, 0, sizeof(messages));
+    for (index = 0; index < networkSocket->BatchSize; index++)
+    {
+        vectors[index].iov_base = batch->Datagrams[index].Data;
+        vectors[index].iov_len = NETWORK_BATCH_DATAGRAM_SIZE;
+        messages[index].msg_hdr.msg_name = &batch->Datagrams[index].Address;
+        messages[index].msg_hdr.msg_namelen = sizeof(struct sockaddr_storage);
+        messages[index].msg_hdr.msg_iov = &vectors[index];
+        messages[index].msg_hdr.msg_iovlen = 1;
+    }
+    errno = 0;
+    count = recvmmsg(socketHandle, messages, networkSocket->BatchSize, 0, NULL);
+    for (index = 0; index < count; index++)
+    {
+        batch->Datagrams[index].AddressLength = messages[index].msg_hdr.msg_namelen;
+        batch->Datagrams[index].Length = messages[index].msg_len;
+    }
+#else
+    while (count < networkSocket->BatchSize)
+    {
+        NetworkDatagram * datagram = &batch->Datagrams[count];
+        datagram->AddressLength = sizeof(struct sockaddr_storage);
+        errno = 0;
+        datagram->Length = recvfrom(socketHandle, datagram->Data, NETWORK_BATCH_DATAGRAM_SIZE, 0, (struct sockaddr *)&datagram->Address, &datagram->AddressLength);
+        if (datagram->Length == SOCKET_ERROR)
+        {
+            if (count == 0)
+                count = SOCKET_ERROR;
+            else
+                errno = 0;
+            break;
+        }
+        count++;
+    }
+#endif
+    return count;
+}
+
 static bool readUDP(NetworkSocket * networkSocket, int socketHandle, uint8_t * buffer, int bufferLength, NetworkAddress ** sourceAddress, int *readLength)
 {
     bool result = false;
     struct sockaddr_storage sourceSocket;
     socklen_t sourceSocketLength = sizeof(struct sockaddr_storage);
+    NetworkBatch * batch = NULL;
+    if ((networkSocket->BatchSize > 1) && (bufferLength <= NETWORK_BATCH_DATAGRAM_SIZE))
+    {
+        batch = getBatch(&networkSocket->Received);
+    }
+
     errno = 0;
-    *readLength = recvfrom(socketHandle, buffer, bufferLength, 0,
-                           (struct sockaddr *)&sourceSocket,
-                           &sourceSocketLength);
+    if (batch)
+    {
+        if (batch->Next >= batch->Count)
+        {
+            batch->Next = 0;
+            batch->Count = receiveBatch(networkSocket, socketHandle, batch);
+        }
+        if (batch->Count == SOCKET_ERROR)
+        {
+            batch->Count = 0;
+            *readLength = SOCKET_ERROR;
+        }
+        else if (batch->Next < batch->Count)
+        {
+            NetworkDatagram * datagram = &batch->Datagrams[batch->Next++];
+            // a datagram longer than the buffer is truncated, as recvfrom would
+            *readLength = (datagram->Length < bufferLength) ? datagram->Length : bufferLength;
+            memcpy(buffer, datagram->Data, *readLength);
+            memcpy(&sourceSocket, &datagram->Address, datagram->AddressLength);
+            sourceSocketLength = datagram->AddressLength;
+        }
+        else
+        {
+            *readLength = SOCKET_ERROR;
+            errno = EWOULDBLOCK;
+        }
+    }
+    else
+    {
+        *readLength = recvfrom(socketHandle, buffer, bufferLength, 0,
+                               (struct sockaddr *)&sourceSocket,
+                               &sourceSocketLength);
+    }
     int lastError = errno;
     if (*readLength == SOCKET_ERROR)
     {
@@ -458,25 +869,7 @@ static bool readUDP(NetworkSocket * networkSocket, int socketHandle, uint8_t * b
     }
     else
     {
-        NetworkAddress * networkAddress = NULL;
-        NetworkAddress matchAddress;
-        size_t size = sizeof(struct _NetworkAddress);
-        memset(&matchAddress, 0, size);
-        memcpy(&matchAddress.Address.Sa, &sourceSocket, sourceSocketLength);
-        matchAddress.Secure = (networkSocket->SocketType & NetworkSocketType_Secure) == NetworkSocketType_Secure;
-        networkAddress = getCachedAddress(&matchAddress, NULL, 0);
-
-        if (networkAddress == NULL)
-        {
-            networkAddress = (NetworkAddress *)malloc(size);
-            if (networkAddress)
-            {
-                // Add new address to cache (note: uri and secure is unknown)
-                memcpy(networkAddress, &matchAddress, size);
-                addCachedAddress(networkAddress, NULL, 0);
-                networkAddress->useCount++;         // TODO - ensure addresses are freed? (after t/o or transaction or DTLS session closed)
-            }
-        }
+        NetworkAddress * networkAddress = getSourceAddress(networkSocket, &sourceSocket, sourceSocketLength);
         if (networkAddress)
         {
             *sourceAddress = networkAddress;
@@ -486,6 +879,44 @@ static bool readUDP(NetworkSocket * networkSocket, int socketHandle, uint8_t * b
     return result;
 }
 
+bool NetworkSocket_HasPendingReads(NetworkSocket * networkSocket)
+{
+    return networkSocket && networkSocket->Received && (networkSocket->Received->Next < networkSocket->Received->Count);
+}
+
+void NetworkSocket_StartBatch(NetworkSocket * networkSocket)
+{
+    if (networkSocket)
+    {
+        networkSocket->Batching = true;
+    }
+}
+
+bool NetworkSocket_EndBatch(NetworkSocket * networkSocket)
+{
+    bool result = false;
+    if (networkSocket)
+    {
+        networkSocket->Batching = false;
+        flushHeldDatagrams(networkSocket);
+        result = (networkSocket->LastError == NetworkSocketError_NoError);
+    }
+    return result;
+}
+
+void NetworkSocket_SetBatchSize(NetworkSocket * networkSocket, int batchSize)
+{
+    if (networkSocket)
+    {
+        if (batchSize < 1)
+            batchSize = 1;
+        else if (batchSize > NETWORK_BATCH_SIZE)
+            batchSize = NETWORK_BATCH_SIZE;
+        flushHeldDatagrams(networkSocket);
+        networkSocket->BatchSize = batchSize;
+    }
+}
+
 NetworkAddress * NetworkAddress_New(const char * uri, int uriLength)
 {
     NetworkAddress * result = NULL;
@@ -594,11 +1025,9 @@ NetworkAddress * NetworkAddress_New(const char * uri, int uriLength)
                 AddressType resolvedAddress;
                 if (Lwm2mCore_ResolveAddressByName((unsigned char*)hostname, strlen(hostname), &resolvedAddress))
                 {
-                    size_t size = sizeof(struct _NetworkAddress);
-                    networkAddress = (NetworkAddress *) malloc(size);
+                    networkAddress = newAddress();
                     if (networkAddress)
                     {
-                        memset(networkAddress, 0, size);
                         if (resolvedAddress.Addr.Sa.sa_family == AF_INET)
                         {
                             networkAddress->Address.Sin.sin_family = AF_INET;
@@ -622,28 +1051,27 @@ NetworkAddress * NetworkAddress_New(const char * uri, int uriLength)
             if (networkAddress)
             {
                 networkAddress->Secure = secure;
-                result = getCachedAddress(networkAddress, uri, uriHostLength);
+                result = getCachedAddress(networkAddress);
                 if (result)
                 {
-                    // Matched existing address
+                    // Matched an existing address, e.g. one a datagram was received from
+                    result->Secure = secure;
+                    setCachedAddressUri(result, uri, uriHostLength);
                     free(networkAddress);
+                    NetworkAddress_Retain(result);
                 }
                 else
                 {
+                    // Still usable if it could not be cached; it is freed with its last reference
+                    addCachedAddress(networkAddress, uri, uriHostLength);
                     result = networkAddress;
                 }
             }
-
         }
     }
-
-    if (result)
+    else
     {
-        if (result->useCount == 0)
-        {
-            addCachedAddress(result, uri, uriHostLength);
-        }
-        result->useCount++;
+        NetworkAddress_Retain(result);
     }
 
     return result;
@@ -651,32 +1079,21 @@ NetworkAddress * NetworkAddress_New(const char * uri, int uriLength)
 
 void NetworkAddress_Free(NetworkAddress ** address)
 {
-    // TODO - review when addresses are freed (e.g. after client bootstrap, or connection lost ?)
     if (address && *address)
     {
-        (*address)->useCount--;
+        if ((*address)->useCount > 0)
+            (*address)->useCount--;
         if ((*address)->useCount == 0)
         {
-            int index;
-            for (index = 0; index < MAX_NETWORK_ADDRESS_CACHE; index++)
+            if ((*address)->Cached)
             {
-                if (networkAddressCache[index].address == *address)
-                {
-                    if (networkAddressCache[index].uri)
-                    {
-                        Lwm2m_Debug("Address free: %s\n", networkAddressCache[index].uri);
-                        free(networkAddressCache[index].uri);
-                        networkAddressCache[index].uri = NULL;
-                    }
-                    else
-                    {
-                        Lwm2m_Debug("Address free\n");
-                    }
-                    networkAddressCache[index].address = NULL;
-                    break;
-                }
+                // Kept for the next datagram or lookup, until evicted
+                setAddressIdle(*address, Lwm2mCore_GetTickCountMs());
+            }
+            else
+            {
+                free(*address);
             }
-            free(*address);
         }
         *address = NULL;
     }
@@ -826,7 +1243,12 @@ bool NetworkSocket_Read(NetworkSocket * networkSocket, uint8_t * buffer, int buf
             {
                 if (sourceAddress)
                 {
-                   if ((networkSocket->Socket != SOCKET_ERROR) && readUDP(networkSocket, networkSocket->Socket, buffer, bufferLength, sourceAddress, readLength))
+                   if (DTLS_TakeDeferredRecord(networkSocket, sourceAddress, buffer, bufferLength, readLength))
+                   {
+                       // a record that arrived while its session was handshaking on a worker thread
+                       result = true;
+                   }
+                   else if ((networkSocket->Socket != SOCKET_ERROR) && readUDP(networkSocket, networkSocket->Socket, buffer, bufferLength, sourceAddress, readLength))
                    {
                        result = true;
                        if (*readLength == 0)
@@ -840,13 +1262,8 @@ bool NetworkSocket_Read(NetworkSocket * networkSocket, uint8_t * buffer, int buf
                    }
                    if ((*readLength > 0) && *sourceAddress && (*sourceAddress)->Secure)
                    {
-                       if (DTLS_Decrypt(*sourceAddress, buffer, *readLength, encryptBuffer, ENCRYPT_BUFFER_LENGTH, readLength, networkSocket))
-                       {
-                           if (*readLength > 0)
-                           {
-                               memcpy(buffer, encryptBuffer, *readLength);
-                           }
-                       }
+                       // decrypt in place: the plaintext is never longer than the record it came from
+                       DTLS_Decrypt(*sourceAddress, buffer, *readLength, buffer, bufferLength, readLength, networkSocket);
                    }
                 }
                 else
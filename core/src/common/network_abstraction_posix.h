@@ -29,7 +29,44 @@ extern "C" {
 
 #include "network_abstraction.h"
 
+#ifndef NETWORK_ADDRESS_CACHE_MAX_IDLE
+    #define NETWORK_ADDRESS_CACHE_MAX_IDLE  (1024)
+#endif
+
+#ifndef NETWORK_ADDRESS_CACHE_IDLE_TIMEOUT
+    #define NETWORK_ADDRESS_CACHE_IDLE_TIMEOUT  (5 * 60 * 1000)     // milliseconds
+#endif
+
+#ifndef NETWORK_BATCH_SIZE
+    #define NETWORK_BATCH_SIZE  (16)                // most datagrams moved by one recvmmsg or sendmmsg
+#endif
+
+#ifndef NETWORK_BATCH_DATAGRAM_SIZE
+    #define NETWORK_BATCH_DATAGRAM_SIZE  (2048)     // larger datagrams bypass the batch
+#endif
+
+typedef struct
+{
+    unsigned long Hits;                 // datagrams from a peer already in the address cache
+    unsigned long Misses;               // datagrams from a new peer, which cost an allocation
+    unsigned long Evicted;              // idle addresses freed
+    size_t Live;                        // addresses in the cache, referenced or idle
+    size_t PeakLive;
+    size_t Idle;                        // addresses nothing holds a reference to
+} NetworkAddressCacheStats;
+
 NetworkAddress * NetworkAddress_FromIPAddress(const char * ipAddress, uint16_t port);
+
+// Limit how many unreferenced addresses are kept for returning peers, and for how long
+void NetworkAddress_SetCacheLimits(size_t maxIdle, uint64_t idleTimeoutMs);
+void NetworkAddress_GetCacheStats(NetworkAddressCacheStats * stats);
+
+// The shard, out of numShards, that owns the peer at address: a hash of its address and port, so state kept
+// per shard always finds the same owner for a given peer
+int NetworkAddress_GetShard(const NetworkAddress * address, int numShards);
+
+// Datagrams moved per system call, at most NETWORK_BATCH_SIZE; 1 reads and sends them one at a time
+void NetworkSocket_SetBatchSize(NetworkSocket * networkSocket, int batchSize);
 NetworkSocket * NetworkSocket_New(const char * ipAddress, NetworkSocketType socketType, uint16_t port);
 bool NetworkSocket_Send(NetworkSocket * networkSocket, NetworkAddress * destAddress, uint8_t * buffer, int bufferLength);
 
@@ -38,6 +75,7 @@ int NetworkAddress_Compare(NetworkAddress * address1, NetworkAddress * address2)
 bool NetworkAddress_IsSecure(const NetworkAddress * address);
 NetworkSocketError NetworkSocket_GetError(NetworkSocket * networkSocket);
 int NetworkSocket_GetFileDescriptor(NetworkSocket * networkSocket);
+int NetworkSocket_GetFileDescriptors(NetworkSocket * networkSocket, int * fds, int maxFds);
 void NetworkSocket_Free(NetworkSocket ** networkSocket);
 void NetworkSocket_SetCertificate(NetworkSocket * networkSocket, const uint8_t * cert, int certLength, AwaCertificateFormat format);
 void NetworkSocket_SetPSK(NetworkSocket * networkSocket, const char * identity, const uint8_t * key, int keyLength);
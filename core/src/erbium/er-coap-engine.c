@@ -156,7 +156,7 @@ int coap_receive(NetworkSocket * networkSocket)
                                     {
                                         PRINTF("Blockwise: unaware resource with payload length %u/%u\n", response->payload_len,
                                                 block_size);
-                                        if (block_offset >= response->payload_len)
+                                        if ((block_offset > 0) && (block_offset >= response->payload_len))
                                         {
                                             PRINTF("handle_incoming_data(): block_offset >= response->payload_len\n");
 
@@ -193,6 +193,14 @@ int coap_receive(NetworkSocket * networkSocket)
 
                                     coap_set_header_block2(response, 0, new_offset != -1, COAP_MAX_BLOCK_SIZE);
                                     coap_set_payload(response, response->payload, MIN(response->payload_len, COAP_MAX_BLOCK_SIZE));
+                                }
+                                else if (response->payload_len > block_size)
+                                {
+                                    /* unaware resource produced more than one message can carry: start a Block2 transfer */
+                                    PRINTF("Blockwise: unaware resource with payload length %u, sending first block\n", response->payload_len);
+
+                                    coap_set_header_block2(response, 0, 1, block_size);
+                                    coap_set_payload(response, response->payload, block_size);
                                 } /* blockwise transfer handling */
                             } /* no errors/hooks */
                             /* successful service callback */
@@ -240,7 +248,9 @@ int coap_receive(NetworkSocket * networkSocket)
                     //coap_remove_observer_by_mid(sourceAddress, message->mid); //TODO add
                 }
 
-                if ((transaction = coap_get_transaction_by_mid(message->mid)))
+                /* only an ACK or RST echoes the message ID of our message; the ID is only unique per peer */
+                if (((message->type == COAP_TYPE_ACK) || (message->type == COAP_TYPE_RST)) &&
+                    (transaction = coap_get_transaction_by_mid(message->mid, sourceAddress)))
                 {
                     /* free transaction memory before callback, as it may create a new transaction */
                     restful_response_handler callback = transaction->callback;
@@ -264,6 +274,20 @@ int coap_receive(NetworkSocket * networkSocket)
                     coap_handle_notification(sourceAddress, message);
                 }
 //#endif /* COAP_OBSERVE_CLIENT */
+                /* separate response to a request that was acknowledged with an empty ACK */
+                else if ((message->type == COAP_TYPE_CON || message->type == COAP_TYPE_NON) && message->code >= CREATED_2_01)
+                {
+                    PRINTF("Separate response\n");
+                    coap_handle_separate_response(sourceAddress, message);
+
+                    if (message->type == COAP_TYPE_CON)
+                    {
+                        /* acknowledge it, reusing the input buffer now the response has been handled */
+                        coap_init_message(response, COAP_TYPE_ACK, 0, message->mid);
+                        int ackLength = coap_serialize_message(response, CoapBuffer);
+                        NetworkSocket_Send(networkSocket, sourceAddress, CoapBuffer, ackLength);
+                    }
+                }
             } /* request or response */
         } /* parsed correctly */
 
@@ -64,6 +64,7 @@ coap_separate_reject(void)
 /**
  * \brief Initiate a separate response with an empty ACK
  * \param request The request to accept
+ * \param sourceAddress The peer the request came from
  * \param separate_store A pointer to the data structure that will store the
  *   relevant information for the response
  *
@@ -73,10 +74,10 @@ coap_separate_reject(void)
  * then retry later.
  */
 void
-coap_separate_accept(void *request, coap_separate_t *separate_store)
+coap_separate_accept(void *request, NetworkAddress *sourceAddress, coap_separate_t *separate_store)
 {
   coap_packet_t *const coap_req = (coap_packet_t *)request;
-  coap_transaction_t *const t = coap_get_transaction_by_mid(coap_req->mid);
+  coap_transaction_t *const t = coap_get_transaction_by_mid(coap_req->mid, sourceAddress);
 
   PRINTF("Separate ACCEPT: /%.*s MID %u\n", (int)coap_req->uri_path_len,
          coap_req->uri_path, coap_req->mid);
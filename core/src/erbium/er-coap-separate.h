@@ -63,7 +63,7 @@ typedef struct coap_separate
 int coap_separate_handler(resource_t *resource, void *request,
                           void *response);
 void coap_separate_reject(void);
-void coap_separate_accept(void *request, coap_separate_t *separate_store);
+void coap_separate_accept(void *request, NetworkAddress *sourceAddress, coap_separate_t *separate_store);
 void coap_separate_resume(void *response, coap_separate_t *separate_store,
                           uint8_t code);
 
@@ -37,7 +37,9 @@
  */
 
 #include "string.h"
+#include <stdlib.h>
 #include "../common/lwm2m_list.h"
+#include "../common/lwm2m_util.h"
 #include "er-coap-transactions.h"
 
 /*---------------------------------------------------------------------------*/
@@ -45,36 +47,151 @@
 //LIST(transactions_list);
 
 
-struct ListHead transactions_list = {0};
+/* all open transactions, indexed by message ID */
+static HashTable transactions_by_mid;
 
-//static struct process *transaction_handler_process = NULL;
+/* transactions whose last send failed, retried on every check */
+static struct ListHead pending_list = {0};
+
+/* transactions are recycled rather than malloc'd and freed for every message */
+static MemoryPool transaction_pool;
+
+/* retransmission deadlines of all transactions waiting for an ACK or for a failed send to succeed */
+static TimerQueue retransmit_queue;
 
 /*---------------------------------------------------------------------------*/
 /*- Internal API ------------------------------------------------------------*/
 /*---------------------------------------------------------------------------*/
-//void
-//coap_register_as_transaction_handler()
-//{
-//  transaction_handler_process = PROCESS_CURRENT();
-//}
+
+static bool coap_is_confirmable(const coap_transaction_t * t)
+{
+    return COAP_TYPE_CON == ((COAP_HEADER_TYPE_MASK & t->packet[0]) >> COAP_HEADER_TYPE_POSITION);
+}
+
+static bool coap_transmit(coap_transaction_t * t)
+{
+    bool sent = NetworkSocket_Send(t->networkSocket, t->remoteAddress, t->packet, t->packet_len);
+    if (sent && !t->sent)
+    {
+        ListRemove(&t->pending);
+    }
+    else if (!sent && t->sent)
+    {
+        PRINTF("Failed to send transaction %u\n", t->mid);
+        ListAdd(&t->pending, &pending_list);
+    }
+    t->sent = sent;
+    return sent;
+}
+
+/* start the retransmission timer, or double it after a retransmission */
+static void coap_schedule_retransmission(coap_transaction_t * t)
+{
+    if (t->retrans_counter == 0)
+    {
+        t->retrans_interval = COAP_RESPONSE_TIMEOUT_MS + (rand() % COAP_RESPONSE_TIMEOUT_BACKOFF_MASK);
+        PRINTF("Initial interval %u ms\n", t->retrans_interval);
+    }
+    else
+    {
+        t->retrans_interval <<= 1;  /* double */
+        PRINTF("Doubled (%u) interval %u ms\n", t->retrans_counter, t->retrans_interval);
+    }
+
+    if (TimerQueue_Schedule(&retransmit_queue, &t->retrans_timer, Lwm2mCore_GetTickCountMs() + t->retrans_interval) != 0)
+    {
+        PRINTF("Unable to schedule retransmission of transaction %u\n", t->mid);
+    }
+}
+
+static void coap_timeout_transaction(coap_transaction_t * t)
+{
+    /* timed out */
+    PRINTF("Timeout\n");
+    restful_response_handler callback = t->callback;
+    void *callback_data = t->callback_data;
+
+    /* handle observers */
+    //coap_remove_observer_by_client(t->session);	// TODO - restore when observe supported
+
+    coap_clear_transaction(&t);
+
+    if(callback)
+    {
+        callback(callback_data, NULL);
+    }
+}
+
+static void coap_retransmit_transaction(coap_transaction_t * t)
+{
+    if(t->retrans_counter < COAP_MAX_RETRANSMIT)
+    {
+        ++(t->retrans_counter);
+        PRINTF("Retransmitting %u (%u)\n", t->mid, t->retrans_counter);
+
+        coap_schedule_retransmission(t);
+        if (coap_transmit(t) && !coap_is_confirmable(t))
+        {
+            coap_clear_transaction(&t);
+        }
+    }
+    else
+    {
+        coap_timeout_transaction(t);
+    }
+}
 
 void coap_init_transactions(void)
 {
-	ListInit(&transactions_list);
+    HashTable_Init(&transactions_by_mid);
+    ListInit(&pending_list);
+    TimerQueue_Init(&retransmit_queue);
+    MemoryPool_Init(&transaction_pool, sizeof(coap_transaction_t), COAP_TRANSACTION_POOL_MAX, COAP_TRANSACTION_POOL_MAX_FREE);
+}
+
+void coap_destroy_transactions(void)
+{
+    HashTableNode * node = HashTable_First(&transactions_by_mid);
+    while (node != NULL)
+    {
+        HashTableNode * next = HashTable_Next(&transactions_by_mid, node);
+        coap_transaction_t * t = HashTableEntry(node, coap_transaction_t, mid_node);
+        coap_clear_transaction(&t);
+        node = next;
+    }
+    HashTable_Destroy(&transactions_by_mid);
+    TimerQueue_Destroy(&retransmit_queue);
+    MemoryPool_Destroy(&transaction_pool);
+}
+
+void coap_get_transaction_pool_stats(MemoryPoolStats * stats)
+{
+    MemoryPool_GetStats(&transaction_pool, stats);
 }
 
 coap_transaction_t * coap_new_transaction(NetworkSocket * networkSocket, uint16_t mid, NetworkAddress * remoteAddress)
 {
-    coap_transaction_t * t = (coap_transaction_t *)malloc(sizeof(*t)); //memb_alloc(&transactions_memb);
+    coap_transaction_t * t = (coap_transaction_t *)MemoryPool_Alloc(&transaction_pool); //memb_alloc(&transactions_memb);
     if(t)
     {
         memset(t, 0, sizeof(coap_transaction_t));
         t->mid = mid;
         t->retrans_counter = 0;
         t->networkSocket = networkSocket;
-        t->remoteAddress = remoteAddress;
+        t->remoteAddress = NetworkAddress_Retain(remoteAddress);
+        TimerQueue_InitNode(&t->retrans_timer);
 
-        ListAdd(&t->list, &transactions_list); /* list itself makes sure same element is not added twice */
+        if (HashTable_Insert(&transactions_by_mid, &t->mid_node, HashTable_HashUInt32(mid)) == 0)
+        {
+            /* not yet sent, so it starts out on the pending list */
+            ListAdd(&t->pending, &pending_list);
+        }
+        else
+        {
+            NetworkAddress_Free(&t->remoteAddress);
+            MemoryPool_Free(&transaction_pool, t);
+            t = NULL;
+        }
     }
 
     return t;
@@ -84,67 +201,16 @@ void coap_send_transaction(coap_transaction_t *t)
 {
     PRINTF("Sending transaction %u\n", t->mid);
 
-
-    //coap_send_message(&t->addr, t->port, t->packet, t->packet_len);
-    if (NetworkSocket_Send(t->networkSocket, t->remoteAddress, t->packet, t->packet_len))
+    if (coap_transmit(t) && !coap_is_confirmable(t))
     {
-        t->sent = true;
-        if(COAP_TYPE_CON ==
-                ((COAP_HEADER_TYPE_MASK & t->packet[0]) >> COAP_HEADER_TYPE_POSITION))
-        {
-            if(t->retrans_counter < COAP_MAX_RETRANSMIT)
-            {
-                /* not timed out yet */
-                PRINTF("Keeping transaction %u\n", t->mid);
-
-                if(t->retrans_counter == 0)
-                {
-    //                t->retrans_timer.timer.interval =
-    //                        COAP_RESPONSE_TIMEOUT_TICKS + (random_rand()
-    //                                %
-    //                                (clock_time_t)
-    //                                COAP_RESPONSE_TIMEOUT_BACKOFF_MASK);
-    //                PRINTF("Initial interval %f\n",
-    //                        (float)t->retrans_timer.timer.interval / CLOCK_SECOND);
-                }
-                else
-                {
-    //                t->retrans_timer.timer.interval <<= 1;  /* double */
-    //                PRINTF("Doubled (%u) interval %f\n", t->retrans_counter,
-    //                        (float)t->retrans_timer.timer.interval / CLOCK_SECOND);
-                }
-
-    //            PROCESS_CONTEXT_BEGIN(transaction_handler_process);
-    //            etimer_restart(&t->retrans_timer);        /* interval updated above */
-    //            PROCESS_CONTEXT_END(transaction_handler_process);
-
-                t = NULL;
-            }
-            else
-            {
-                /* timed out */
-                PRINTF("Timeout\n");
-                restful_response_handler callback = t->callback;
-                void *callback_data = t->callback_data;
-
-                /* handle observers */
-                //coap_remove_observer_by_client(t->session);	// TODO - restore when observe supported
-
-                coap_clear_transaction(&t);
-
-                if(callback)
-                {
-                    callback(callback_data, NULL);
-                }
-            }
-        } else {
-            coap_clear_transaction(&t);
-        }
+        coap_clear_transaction(&t);
     }
-    else
+    else if (!TimerQueue_IsScheduled(&t->retrans_timer))
     {
-        PRINTF("Failed to sened transaciton %u\n", t->mid);
-        t->sent = false;
+        /* keep confirmable messages until acknowledged, and failed sends until they go out; either way
+         * the transaction is reclaimed once COAP_MAX_RETRANSMIT retransmissions have timed out */
+        PRINTF("Keeping transaction %u\n", t->mid);
+        coap_schedule_retransmission(t);
     }
 }
 /*---------------------------------------------------------------------------*/
@@ -154,22 +220,27 @@ void coap_clear_transaction(coap_transaction_t **t)
     {
         PRINTF("Freeing transaction %u: %p\n", (*t)->mid, (*t));
 
-        //etimer_stop(&t->retrans_timer);
-        ListRemove(&(*t)->list);
-        free(*t);
+        TimerQueue_Cancel(&retransmit_queue, &(*t)->retrans_timer);
+        if (!(*t)->sent)
+        {
+            ListRemove(&(*t)->pending);
+        }
+        HashTable_Remove(&transactions_by_mid, &(*t)->mid_node);
+        NetworkAddress_Free(&(*t)->remoteAddress);
+        MemoryPool_Free(&transaction_pool, *t);
         *t = NULL;
     }
 }
 
-coap_transaction_t * coap_get_transaction_by_mid(uint16_t mid)
+coap_transaction_t * coap_get_transaction_by_mid(uint16_t mid, NetworkAddress * remoteAddress)
 {
-    struct ListHead * i = NULL;
+    HashTableNode * node;
 
-    ListForEach(i, &transactions_list)
+    for (node = HashTable_FindFirst(&transactions_by_mid, HashTable_HashUInt32(mid)); node != NULL; node = HashTable_FindNext(node))
     {
-        struct coap_transaction * t = ListEntry(i, struct coap_transaction, list);
+        struct coap_transaction * t = HashTableEntry(node, struct coap_transaction, mid_node);
 
-        if(t->mid == mid) {
+        if((t->mid == mid) && (NetworkAddress_Compare(t->remoteAddress, remoteAddress) == 0)) {
             PRINTF("Found transaction for MID %u: %p\n", t->mid, t);
             return t;
         }
@@ -177,24 +248,35 @@ coap_transaction_t * coap_get_transaction_by_mid(uint16_t mid)
     return NULL;
 }
 /*---------------------------------------------------------------------------*/
-void coap_check_transactions(void)
+int coap_check_transactions(void)
 {
     struct ListHead * current = NULL;
     struct ListHead * next = NULL;
+    TimerQueueNode * node;
+    uint64_t now;
+    int timeout;
 
-    ListForEachSafe(current ,next, &transactions_list)
+    ListForEachSafe(current, next, &pending_list)
     {
+        coap_transaction_t *t = ListEntry(current, struct coap_transaction, pending);
 
-        coap_transaction_t *t = ListEntry(current, struct coap_transaction, list);
-
-        //if(t->retrans_timer == 0)
-        if (!t->sent)
+        if (coap_transmit(t) && !coap_is_confirmable(t))
         {
-            //++(t->retrans_counter);
-            //PRINTF("Retransmitting %u (%u)\n", t->mid, t->retrans_counter);
-            coap_send_transaction(t);
+            coap_clear_transaction(&t);
         }
     }
 
+    now = Lwm2mCore_GetTickCountMs();
+    while ((node = TimerQueue_PopExpired(&retransmit_queue, now)) != NULL)
+    {
+        coap_retransmit_transaction(TimerQueueEntry(node, coap_transaction_t, retrans_timer));
+    }
+
+    timeout = TimerQueue_GetTimeout(&retransmit_queue, now);
+    if ((pending_list.Next != &pending_list) && ((timeout < 0) || (timeout > COAP_SEND_RETRY_INTERVAL_MS)))
+    {
+        timeout = COAP_SEND_RETRY_INTERVAL_MS;
+    }
+    return timeout;
 }
 /*---------------------------------------------------------------------------*/
@@ -40,30 +40,54 @@
 #define COAP_TRANSACTIONS_H_
 
 #include "../common/lwm2m_list.h"
+#include "../common/lwm2m_hash_table.h"
+#include "../common/lwm2m_timer_queue.h"
+#include "../common/lwm2m_pool.h"
 #include "er-coap.h"
 #include "er-resource.h"
 #include "network_abstraction.h"
 
 /*
- * Modulo mask (thus +1) for a random number to get the tick number for the random
- * retransmission time between COAP_RESPONSE_TIMEOUT and COAP_RESPONSE_TIMEOUT*COAP_RESPONSE_RANDOM_FACTOR.
+ * Modulo mask (thus +1) for a random number to get the initial retransmission time between
+ * COAP_RESPONSE_TIMEOUT and COAP_RESPONSE_TIMEOUT*COAP_RESPONSE_RANDOM_FACTOR, in milliseconds (RFC 7252 4.8).
  */
-#define COAP_RESPONSE_TIMEOUT_TICKS         (CLOCK_SECOND * COAP_RESPONSE_TIMEOUT)
-#define COAP_RESPONSE_TIMEOUT_BACKOFF_MASK  (long)((CLOCK_SECOND * COAP_RESPONSE_TIMEOUT * ((float)COAP_RESPONSE_RANDOM_FACTOR - 1.0)) + 0.5) + 1
+#define COAP_RESPONSE_TIMEOUT_MS            (COAP_RESPONSE_TIMEOUT * 1000)
+#define COAP_RESPONSE_TIMEOUT_BACKOFF_MASK  ((long)((COAP_RESPONSE_TIMEOUT_MS * ((float)COAP_RESPONSE_RANDOM_FACTOR - 1.0)) + 0.5) + 1)
+
+/*
+ * Interval at which a transaction whose send failed (e.g. while a DTLS handshake is in progress) is retried,
+ * in addition to being retried whenever coap_check_transactions() runs.
+ */
+#ifndef COAP_SEND_RETRY_INTERVAL_MS
+#define COAP_SEND_RETRY_INTERVAL_MS         (1000)
+#endif
+
+/*
+ * High-water marks for the transaction pool: the most transactions that may be open at once (0 for no limit),
+ * and the most freed transactions kept for reuse rather than returned to the heap.
+ */
+#ifndef COAP_TRANSACTION_POOL_MAX
+#define COAP_TRANSACTION_POOL_MAX           (0)
+#endif
+
+#ifndef COAP_TRANSACTION_POOL_MAX_FREE
+#define COAP_TRANSACTION_POOL_MAX_FREE      (64)
+#endif
 
 /* container for transactions with message buffer and retransmission info */
 typedef struct coap_transaction
 {
-    struct ListHead list;
+    HashTableNode mid_node;             /* indexed by mid for matching ACKs and responses */
 
     uint16_t mid;
-    //struct etimer retrans_timer;
-    uint32_t retrans_timer;
+    TimerQueueNode retrans_timer;       /* scheduled while waiting for an ACK or to give up on a failed send */
+    uint32_t retrans_interval;          /* current retransmission timeout in ms, doubled on each retransmission */
     uint8_t retrans_counter;
 
     NetworkSocket * networkSocket;
     NetworkAddress * remoteAddress;
     bool sent;
+    struct ListHead pending;            /* linked into the pending list while sent is false */
 
     restful_response_handler callback;
     void *callback_data;
@@ -76,11 +100,19 @@ typedef struct coap_transaction
 void coap_register_as_transaction_handler(void);
 
 void coap_init_transactions(void);
+void coap_destroy_transactions(void);
 coap_transaction_t * coap_new_transaction(NetworkSocket * networkSocket, uint16_t mid, NetworkAddress * remoteAddress);
 void coap_send_transaction(coap_transaction_t *t);
 void coap_clear_transaction(coap_transaction_t **t);
-coap_transaction_t *coap_get_transaction_by_mid(uint16_t mid);
+/* message IDs are only unique per peer, so the transaction must also have been sent to remoteAddress */
+coap_transaction_t *coap_get_transaction_by_mid(uint16_t mid, NetworkAddress * remoteAddress);
+
+/* Retry failed sends, retransmit unacknowledged confirmable messages whose timeout has expired and
+ * give up on those that have reached COAP_MAX_RETRANSMIT. Returns the number of milliseconds until
+ * the next retransmission is due, or -1 if there are no transactions waiting on a timer.
+ */
+int coap_check_transactions(void);
 
-void coap_check_transactions(void);
+void coap_get_transaction_pool_stats(MemoryPoolStats * stats);
 
 #endif /* COAP_TRANSACTIONS_H_ */
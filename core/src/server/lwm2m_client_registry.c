@@ -0,0 +1,202 @@
+/************************************************************************************************************************
+ Copyright (c) 2016, Imagination Technologies Limited and/or its affiliated group companies.
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+ following conditions are met:
+     1. Redistributions of source code must retain the above copyright notice, this list of conditions and the
+        following disclaimer.
+     2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the
+        following disclaimer in the documentation and/or other materials provided with the distribution.
+     3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote
+        products derived from this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+ USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+************************************************************************************************************************/
+
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "lwm2m_hash_table.h"
+#include "lwm2m_timer_queue.h"
+#include "lwm2m_debug.h"
+#include "lwm2m_client_registry.h"
+
+struct _ClientRegistry
+{
+    struct ListHead ClientList;               // Registered clients, in registration order
+    HashTable NameIndex;                      // Lwm2mClientType.NameNode, keyed on EndPointName
+    HashTable LocationIndex;                  // Lwm2mClientType.LocationNode, keyed on Location
+    HashTable AddressIndex;                   // Lwm2mClientType.AddressNode, keyed on Address
+    TimerQueue ExpiryQueue;                   // Lwm2mClientType.ExpiryNode, ordered by registration expiry
+};
+
+static uint32_t HashAddress(const AddressType * address)
+{
+    // Keyed on sa_data (port and leading address bytes), consistent with the address comparison below
+    return HashTable_HashBytes(address->Addr.Sa.sa_data, sizeof(address->Addr.Sa.sa_data));
+}
+
+static bool AddressMatches(const AddressType * x, const AddressType * y)
+{
+    return memcmp(x->Addr.Sa.sa_data, y->Addr.Sa.sa_data, sizeof(x->Addr.Sa.sa_data)) == 0;
+}
+
+ClientRegistry * ClientRegistry_Create(void)
+{
+    ClientRegistry * registry = malloc(sizeof(*registry));
+    if (registry != NULL)
+    {
+        ListInit(&registry->ClientList);
+        HashTable_Init(&registry->NameIndex);
+        HashTable_Init(&registry->LocationIndex);
+        HashTable_Init(&registry->AddressIndex);
+        TimerQueue_Init(&registry->ExpiryQueue);
+    }
+    else
+    {
+        Lwm2m_Error("Failed to allocate memory for client registry\n");
+    }
+    return registry;
+}
+
+void ClientRegistry_Destroy(ClientRegistry * registry)
+{
+    if (registry != NULL)
+    {
+        HashTable_Destroy(&registry->NameIndex);
+        HashTable_Destroy(&registry->LocationIndex);
+        HashTable_Destroy(&registry->AddressIndex);
+        TimerQueue_Destroy(&registry->ExpiryQueue);
+        free(registry);
+    }
+}
+
+struct ListHead * ClientRegistry_GetClientList(ClientRegistry * registry)
+{
+    return &registry->ClientList;
+}
+
+size_t ClientRegistry_GetCount(const ClientRegistry * registry)
+{
+    return HashTable_Count(&registry->LocationIndex);
+}
+
+int ClientRegistry_Add(ClientRegistry * registry, Lwm2mClientType * client)
+{
+    int result = -1;
+    TimerQueue_InitNode(&client->ExpiryNode);
+    if (HashTable_Insert(&registry->NameIndex, &client->NameNode, HashTable_HashString(client->EndPointName)) == 0)
+    {
+        if (HashTable_Insert(&registry->LocationIndex, &client->LocationNode, HashTable_HashUInt32(client->Location)) == 0)
+        {
+            if (HashTable_Insert(&registry->AddressIndex, &client->AddressNode, HashAddress(&client->Address)) == 0)
+            {
+                ListAdd(&client->list, &registry->ClientList);
+                result = 0;
+            }
+            else
+            {
+                HashTable_Remove(&registry->LocationIndex, &client->LocationNode);
+                HashTable_Remove(&registry->NameIndex, &client->NameNode);
+            }
+        }
+        else
+        {
+            HashTable_Remove(&registry->NameIndex, &client->NameNode);
+        }
+    }
+
+    if (result != 0)
+    {
+        Lwm2m_Error("Failed to allocate memory for client registry index\n");
+    }
+    return result;
+}
+
+void ClientRegistry_Remove(ClientRegistry * registry, Lwm2mClientType * client)
+{
+    HashTable_Remove(&registry->NameIndex, &client->NameNode);
+    HashTable_Remove(&registry->LocationIndex, &client->LocationNode);
+    HashTable_Remove(&registry->AddressIndex, &client->AddressNode);
+    TimerQueue_Cancel(&registry->ExpiryQueue, &client->ExpiryNode);
+    ListRemove(&client->list);
+}
+
+int ClientRegistry_UpdateAddress(ClientRegistry * registry, Lwm2mClientType * client, const AddressType * address)
+{
+    HashTable_Remove(&registry->AddressIndex, &client->AddressNode);
+    memcpy(&client->Address, address, sizeof(AddressType));
+    return HashTable_Insert(&registry->AddressIndex, &client->AddressNode, HashAddress(&client->Address));
+}
+
+int ClientRegistry_ScheduleExpiry(ClientRegistry * registry, Lwm2mClientType * client, uint64_t expiryTime)
+{
+    return TimerQueue_Schedule(&registry->ExpiryQueue, &client->ExpiryNode, expiryTime);
+}
+
+Lwm2mClientType * ClientRegistry_PopExpired(ClientRegistry * registry, uint64_t now)
+{
+    TimerQueueNode * node = TimerQueue_PopExpired(&registry->ExpiryQueue, now);
+    return (node != NULL) ? TimerQueueEntry(node, Lwm2mClientType, ExpiryNode) : NULL;
+}
+
+int ClientRegistry_GetNextExpiryTimeout(const ClientRegistry * registry, uint64_t now)
+{
+    return TimerQueue_GetTimeout(&registry->ExpiryQueue, now);
+}
+
+Lwm2mClientType * ClientRegistry_LookupByName(const ClientRegistry * registry, const char * endPointName)
+{
+    Lwm2mClientType * client = NULL;
+    HashTableNode * node;
+    for (node = HashTable_FindFirst(&registry->NameIndex, HashTable_HashString(endPointName)); node != NULL; node = HashTable_FindNext(node))
+    {
+        Lwm2mClientType * c = HashTableEntry(node, Lwm2mClientType, NameNode);
+        if (strcmp(c->EndPointName, endPointName) == 0)
+        {
+            client = c;
+            break;
+        }
+    }
+    return client;
+}
+
+Lwm2mClientType * ClientRegistry_LookupByLocation(const ClientRegistry * registry, int location)
+{
+    Lwm2mClientType * client = NULL;
+    HashTableNode * node;
+    for (node = HashTable_FindFirst(&registry->LocationIndex, HashTable_HashUInt32(location)); node != NULL; node = HashTable_FindNext(node))
+    {
+        Lwm2mClientType * c = HashTableEntry(node, Lwm2mClientType, LocationNode);
+        if (c->Location == location)
+        {
+            client = c;
+            break;
+        }
+    }
+    return client;
+}
+
+Lwm2mClientType * ClientRegistry_LookupByAddress(const ClientRegistry * registry, const AddressType * address)
+{
+    Lwm2mClientType * client = NULL;
+    HashTableNode * node;
+    for (node = HashTable_FindFirst(&registry->AddressIndex, HashAddress(address)); node != NULL; node = HashTable_FindNext(node))
+    {
+        Lwm2mClientType * c = HashTableEntry(node, Lwm2mClientType, AddressNode);
+        if (AddressMatches(&c->Address, address))
+        {
+            client = c;
+            break;
+        }
+    }
+    return client;
+}
@@ -0,0 +1,71 @@
+/************************************************************************************************************************
+ Copyright (c) 2016, Imagination Technologies Limited and/or its affiliated group companies.
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+ following conditions are met:
+     1. Redistributions of source code must retain the above copyright notice, this list of conditions and the
+        following disclaimer.
+     2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the
+        following disclaimer in the documentation and/or other materials provided with the distribution.
+     3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote
+        products derived from this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+ USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+************************************************************************************************************************/
+
+
+#ifndef LWM2M_CLIENT_REGISTRY_H
+#define LWM2M_CLIENT_REGISTRY_H
+
+#include "lwm2m_list.h"
+#include "lwm2m_types.h"
+#include "lwm2m_registration.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* The client registry owns the list of registered clients and keeps hash indexes on endpoint name,
+ * /rd location and transport address, so that each lookup is O(1) regardless of the number of clients.
+ * Registration expiry is ordered by deadline, so ageing only visits clients that are due.
+ * Clients themselves are allocated and freed by the registration code.
+ */
+
+ClientRegistry * ClientRegistry_Create(void);
+void ClientRegistry_Destroy(ClientRegistry * registry);
+
+struct ListHead * ClientRegistry_GetClientList(ClientRegistry * registry);
+size_t ClientRegistry_GetCount(const ClientRegistry * registry);
+
+// EndPointName, Location and Address must be set before the client is added
+int ClientRegistry_Add(ClientRegistry * registry, Lwm2mClientType * client);
+void ClientRegistry_Remove(ClientRegistry * registry, Lwm2mClientType * client);
+
+// Change a registered client's address, keeping the address index in sync
+int ClientRegistry_UpdateAddress(ClientRegistry * registry, Lwm2mClientType * client, const AddressType * address);
+
+// Set (or move) the absolute time in milliseconds at which a registered client's registration expires
+int ClientRegistry_ScheduleExpiry(ClientRegistry * registry, Lwm2mClientType * client, uint64_t expiryTime);
+
+// Remove and return one client whose registration has expired by now, or NULL if none are due
+Lwm2mClientType * ClientRegistry_PopExpired(ClientRegistry * registry, uint64_t now);
+
+// Milliseconds until the next registration expires, or -1 if no expiry is scheduled
+int ClientRegistry_GetNextExpiryTimeout(const ClientRegistry * registry, uint64_t now);
+
+Lwm2mClientType * ClientRegistry_LookupByName(const ClientRegistry * registry, const char * endPointName);
+Lwm2mClientType * ClientRegistry_LookupByLocation(const ClientRegistry * registry, int location);
+Lwm2mClientType * ClientRegistry_LookupByAddress(const ClientRegistry * registry, const AddressType * address);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // LWM2M_CLIENT_REGISTRY_H
@@ -44,9 +44,14 @@
 extern "C" {
 #endif
 
+typedef ObjectStoreIterator Lwm2mCoreIterator;
+
+typedef struct _ClientRegistry ClientRegistry;
+
 Lwm2mContextType * Lwm2mCore_Init(CoapInfo * coap, AwaContentType contentType);
 
-// Update the LWM2M state machine, process any message timeouts, registration attempts etc.
+// Update the LWM2M state machine, process any message timeouts, registration attempts etc. Returns milliseconds until
+// the next registration expires, or -1 if no client is registered.
 int Lwm2mCore_Process(Lwm2mContextType * context);
 
 int Lwm2mCore_GetEndPointClientName(Lwm2mContextType * context, char * buffer, int len);
@@ -60,6 +65,10 @@ void Lwm2mCore_Destroy(Lwm2mContextType * context);
 int Lwm2mCore_GetResourceInstanceValue(Lwm2mContextType * context, ObjectIDType objectID, ObjectInstanceIDType objectInstanceID, ResourceIDType resourceID,
                                        ResourceInstanceIDType resourceInstanceID, const void ** Value, size_t * ValueBufferSize);
 
+// True if values from Lwm2mCore_GetResourceInstanceValue for this resource stay valid until the resource is next
+// changed, rather than being produced by a handler that may reuse its buffer.
+bool Lwm2mCore_IsResourceValueStable(Lwm2mContextType * context, ObjectIDType objectID, ResourceIDType resourceID);
+
 int Lwm2mCore_GetResourceInstanceLength(Lwm2mContextType * context, ObjectIDType objectID, ObjectInstanceIDType objectInstanceID, ResourceIDType resourceID, ResourceInstanceIDType resourceInstanceID);
 int Lwm2mCore_GetResourceInstanceCount(Lwm2mContextType * context, ObjectIDType objectID, ObjectInstanceIDType objectInstanceID, ResourceIDType resourceID);
 
@@ -84,6 +93,10 @@ ObjectInstanceIDType Lwm2mCore_GetNextObjectInstanceID(Lwm2mContextType * contex
 ResourceIDType Lwm2mCore_GetNextResourceID(Lwm2mContextType * context, ObjectIDType objectID, ObjectInstanceIDType objectInstanceID, ResourceIDType resourceID);
 ResourceInstanceIDType Lwm2mCore_GetNextResourceInstanceID(Lwm2mContextType * context, ObjectIDType objectID, ObjectInstanceIDType objectInstanceID, ResourceIDType resourceID, ResourceInstanceIDType resourceInstanceID);
 
+// Walk the children of a path (objects if objectID is -1) without looking the previous ID up again on each step
+int Lwm2mCore_InitIterator(Lwm2mContextType * context, Lwm2mCoreIterator * iterator, ObjectIDType objectID, ObjectInstanceIDType objectInstanceID, ResourceIDType resourceID);
+int Lwm2mCore_IteratorNext(Lwm2mCoreIterator * iterator);
+
 
 int Lwm2mCore_AddResourceEndPoint(Lwm2mContextType * context, const char * path, EndpointHandlerFunction handler);
 int Lwm2mCore_RemoveResourceEndPoint(Lwm2mContextType * context, const char * path);
@@ -91,6 +104,7 @@ int Lwm2mCore_RemoveResourceEndPoint(Lwm2mContextType * context, const char * pa
 DefinitionRegistry * Lwm2mCore_GetDefinitions(Lwm2mContextType * context);
 
 struct ListHead * Lwm2mCore_GetClientList(Lwm2mContextType * context);
+ClientRegistry * Lwm2mCore_GetClientRegistry(Lwm2mContextType * context);
 AwaContentType Lwm2mCore_GetContentType(Lwm2mContextType * context);
 int Lwm2mCore_GetLastLocation(Lwm2mContextType * context);
 struct ListHead * Lwm2mCore_GetEventRecordList(Lwm2mContextType * context);
@@ -0,0 +1,191 @@
+/************************************************************************************************************************
+ Copyright (c) 2016, Imagination Technologies Limited and/or its affiliated group companies.
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+ following conditions are met:
+     1. Redistributions of source code must retain the above copyright notice, this list of conditions and the
+        following disclaimer.
+     2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the
+        following disclaimer in the documentation and/or other materials provided with the distribution.
+     3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote
+        products derived from this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+ USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+************************************************************************************************************************/
+
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "lwm2m_object_list.h"
+
+#define OBJECT_LIST_INITIAL_CAPACITY (8)
+#define OBJECT_LIST_MAX_ID           (0xFFFE)
+
+static uint32_t EntryKey(uint16_t objectID, uint16_t instanceID)
+{
+    return ((uint32_t)objectID << 16) | instanceID;
+}
+
+static int CompareEntries(const void * x, const void * y)
+{
+    uint32_t keyX = EntryKey(((const ObjectListEntry *)x)->ObjectID, ((const ObjectListEntry *)x)->InstanceID);
+    uint32_t keyY = EntryKey(((const ObjectListEntry *)y)->ObjectID, ((const ObjectListEntry *)y)->InstanceID);
+    return (keyX > keyY) - (keyX < keyY);
+}
+
+// Index of the first entry whose key is not less than key
+static uint32_t LowerBound(const ObjectList * list, uint32_t key)
+{
+    uint32_t low = 0;
+    uint32_t high = list->Count;
+    while (low < high)
+    {
+        uint32_t middle = low + (high - low) / 2;
+        if (EntryKey(list->Entries[middle].ObjectID, list->Entries[middle].InstanceID) < key)
+        {
+            low = middle + 1;
+        }
+        else
+        {
+            high = middle;
+        }
+    }
+    return low;
+}
+
+void ObjectList_Init(ObjectList * list)
+{
+    memset(list, 0, sizeof(*list));
+}
+
+void ObjectList_Free(ObjectList * list)
+{
+    free(list->Entries);
+    ObjectList_Init(list);
+}
+
+void ObjectList_Clear(ObjectList * list)
+{
+    list->Count = 0;
+    list->CommonObjects = 0;
+}
+
+int ObjectList_Add(ObjectList * list, ObjectIDType objectID, ObjectInstanceIDType instanceID)
+{
+    int result = -1;
+    if ((objectID >= 0) && (objectID <= OBJECT_LIST_MAX_ID) && (instanceID >= -1) && (instanceID <= OBJECT_LIST_MAX_ID))
+    {
+        result = 0;
+        if (list->Count == list->Capacity)
+        {
+            uint32_t capacity = (list->Capacity == 0) ? OBJECT_LIST_INITIAL_CAPACITY : list->Capacity * 2;
+            ObjectListEntry * entries = realloc(list->Entries, capacity * sizeof(ObjectListEntry));
+            if (entries != NULL)
+            {
+                list->Entries = entries;
+                list->Capacity = capacity;
+            }
+            else
+            {
+                result = -1;
+            }
+        }
+
+        if (result == 0)
+        {
+            list->Entries[list->Count].ObjectID = objectID;
+            list->Entries[list->Count].InstanceID = (instanceID == -1) ? OBJECT_LIST_NO_INSTANCE : instanceID;
+            list->Count++;
+        }
+    }
+    return result;
+}
+
+void ObjectList_Finalise(ObjectList * list)
+{
+    uint32_t i, count = 0;
+
+    qsort(list->Entries, list->Count, sizeof(ObjectListEntry), CompareEntries);
+
+    list->CommonObjects = 0;
+    for (i = 0; i < list->Count; i++)
+    {
+        if ((count == 0) || (CompareEntries(&list->Entries[count - 1], &list->Entries[i]) != 0))
+        {
+            list->Entries[count++] = list->Entries[i];
+        }
+        if (list->Entries[i].ObjectID < OBJECT_LIST_COMMON_OBJECTS)
+        {
+            list->CommonObjects |= (uint64_t)1 << list->Entries[i].ObjectID;
+        }
+    }
+    list->Count = count;
+
+    if (list->Count == 0)
+    {
+        free(list->Entries);
+        list->Entries = NULL;
+        list->Capacity = 0;
+    }
+    else if (list->Count < list->Capacity)
+    {
+        ObjectListEntry * entries = realloc(list->Entries, list->Count * sizeof(ObjectListEntry));
+        if (entries != NULL)
+        {
+            list->Entries = entries;
+            list->Capacity = list->Count;
+        }
+    }
+}
+
+bool ObjectList_Contains(const ObjectList * list, ObjectIDType objectID, ObjectInstanceIDType instanceID)
+{
+    bool contains = false;
+    if ((objectID >= 0) && (objectID <= OBJECT_LIST_MAX_ID))
+    {
+        if ((instanceID == -1) && (objectID < OBJECT_LIST_COMMON_OBJECTS))
+        {
+            contains = (list->CommonObjects & ((uint64_t)1 << objectID)) != 0;
+        }
+        else if (instanceID == -1)
+        {
+            uint32_t index = LowerBound(list, EntryKey(objectID, 0));
+            contains = (index < list->Count) && (list->Entries[index].ObjectID == objectID);
+        }
+        else if ((instanceID >= 0) && (instanceID <= OBJECT_LIST_MAX_ID))
+        {
+            uint32_t key = EntryKey(objectID, instanceID);
+            uint32_t index = LowerBound(list, key);
+            contains = (index < list->Count) && (EntryKey(list->Entries[index].ObjectID, list->Entries[index].InstanceID) == key);
+        }
+    }
+    return contains;
+}
+
+size_t ObjectList_GetCount(const ObjectList * list)
+{
+    return list->Count;
+}
+
+ObjectIDType ObjectList_GetObjectID(const ObjectList * list, size_t index)
+{
+    return list->Entries[index].ObjectID;
+}
+
+ObjectInstanceIDType ObjectList_GetInstanceID(const ObjectList * list, size_t index)
+{
+    return (list->Entries[index].InstanceID == OBJECT_LIST_NO_INSTANCE) ? -1 : list->Entries[index].InstanceID;
+}
+
+size_t ObjectList_GetMemoryUsage(const ObjectList * list)
+{
+    return list->Capacity * sizeof(ObjectListEntry);
+}
@@ -0,0 +1,89 @@
+/************************************************************************************************************************
+ Copyright (c) 2016, Imagination Technologies Limited and/or its affiliated group companies.
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+ following conditions are met:
+     1. Redistributions of source code must retain the above copyright notice, this list of conditions and the
+        following disclaimer.
+     2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the
+        following disclaimer in the documentation and/or other materials provided with the distribution.
+     3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote
+        products derived from this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+ USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+************************************************************************************************************************/
+
+
+#ifndef LWM2M_OBJECT_LIST_H
+#define LWM2M_OBJECT_LIST_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "lwm2m_types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Compact record of the objects and object instances a client reported at registration. Entries are kept
+ * as a sorted array of 16-bit ID pairs, so membership tests are a binary search, and a bitmap of the
+ * common low-numbered objects answers "is this object supported at all" without searching.
+ */
+
+#define OBJECT_LIST_NO_INSTANCE     (0xFFFF)   // entry names an object without an instance, e.g. </5>
+#define OBJECT_LIST_COMMON_OBJECTS  (64)       // object IDs below this are also tracked in the bitmap
+
+typedef struct
+{
+    uint16_t ObjectID;
+    uint16_t InstanceID;               // OBJECT_LIST_NO_INSTANCE if no instance was listed
+
+} ObjectListEntry;
+
+typedef struct
+{
+    ObjectListEntry * Entries;         // sorted by ObjectID then InstanceID, without duplicates
+    uint32_t Count;
+    uint32_t Capacity;
+    uint64_t CommonObjects;            // bit n is set if object n is listed
+
+} ObjectList;
+
+void ObjectList_Init(ObjectList * list);
+void ObjectList_Free(ObjectList * list);
+
+// Remove all entries, keeping the allocation for reuse
+void ObjectList_Clear(ObjectList * list);
+
+/* Append an entry. instanceID may be -1 for an object without instances. Entries may be added in any order,
+ * but ObjectList_Finalise must be called before the list is queried. Returns 0 on success or -1 on error.
+ */
+int ObjectList_Add(ObjectList * list, ObjectIDType objectID, ObjectInstanceIDType instanceID);
+
+// Sort and de-duplicate entries and release unused capacity
+void ObjectList_Finalise(ObjectList * list);
+
+// True if the object instance is listed, or if instanceID is -1 and any entry for the object is listed
+bool ObjectList_Contains(const ObjectList * list, ObjectIDType objectID, ObjectInstanceIDType instanceID);
+
+size_t ObjectList_GetCount(const ObjectList * list);
+ObjectIDType ObjectList_GetObjectID(const ObjectList * list, size_t index);
+ObjectInstanceIDType ObjectList_GetInstanceID(const ObjectList * list, size_t index);
+
+// Heap bytes held by the list
+size_t ObjectList_GetMemoryUsage(const ObjectList * list);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // LWM2M_OBJECT_LIST_H
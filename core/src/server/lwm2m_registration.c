@@ -30,11 +30,14 @@
 #include "lwm2m_result.h"
 #include "lwm2m_endpoints.h"
 #include "server/lwm2m_registration.h"
+#include "server/lwm2m_client_registry.h"
 
 #define QUERY_EP_NAME  "ep="
 #define QUERY_LIFETIME "lt="
 #define QUERY_BINDING  "b="
 
+#define REGISTRATION_PATH_PREFIX "/rd/"
+
 typedef struct
 {
     const char * EndPointName;
@@ -52,8 +55,6 @@ typedef struct
 
 } EventRecord;
 
-static void DestroyObjectList(struct ListHead * objectList);
-
 static int RegistrationEndpointHandler(int type, void * ctxt, AddressType * addr, const char * path, const char * query, const char * token,
                                        int tokenLength, AwaContentType contentType, const char * requestContent, size_t requestContentLen,
                                        AwaContentType * responseContentType, char * responseContent, size_t * responseContentLen, int * responseCode);
@@ -107,38 +108,20 @@ static void Lwm2m_SplitUpQuery(const char * query, RegistrationQueryString * res
 
 bool Lwm2m_ClientSupportsObject(Lwm2mClientType * client, ObjectIDType objectID, ObjectInstanceIDType instanceID)
 {
-    bool clientSupportsObject = false;
-    struct ListHead * i;
-    ListForEach(i, &client->ObjectList)
-    {
-        ObjectListEntry * entry = ListEntry(i, ObjectListEntry, list);
-        if ((entry->ObjectID == objectID) &&
-            ((entry->InstanceID == instanceID) || (instanceID == -1)))
-        {
-            clientSupportsObject = true;
-            break;
-        }
-    }
-    return clientSupportsObject;
+    return ObjectList_Contains(&client->Objects, objectID, instanceID);
 }
 
 // parse object list in "CoRE" format
 static void Lwm2m_ParseObjectList(Lwm2mClientType * client, const char * objectList, int objectListLength)
 {
+    char altPath[128];
+    strcpy(altPath, "/"); // Assume root path is "/" until proven otherwise
+
     // clear all entries out of object list
-    struct ListHead * i, * n;
-    ListForEachSafe(i, n, &client->ObjectList)
-    {
-        ObjectListEntry * entry = ListEntry(i, ObjectListEntry, list);
-        ListRemove(i);
-        free(entry);
-    }
+    ObjectList_Clear(&client->Objects);
 
     if ((objectListLength > 0) && (objectList != NULL))
     {
-        char altPath[128];
-        strcpy(altPath, "/"); // Assume root path is "/" until proven otherwise
-
         char * str = strndup(objectList, objectListLength);
         const char delim[] = ", ";
         char * savePointer;
@@ -192,17 +175,11 @@ static void Lwm2m_ParseObjectList(Lwm2mClientType * client, const char * objectL
                     continue;
                 }
 
-                // Create new entry, perhaps check for duplicates?
-                ObjectListEntry * entry = malloc(sizeof(ObjectListEntry));
-                if (entry == NULL)
+                // Duplicates are removed when the list is finalised
+                if (ObjectList_Add(&client->Objects, object, instance) != 0)
                 {
-                    break;
+                    Lwm2m_Error("Unable to add object %d instance %d to object list\n", object, instance);
                 }
-
-                entry->ObjectID = object;
-                entry->InstanceID = instance;
-
-                ListAdd(&entry->list, &client->ObjectList);
             }
 
         skip:
@@ -210,19 +187,22 @@ static void Lwm2m_ParseObjectList(Lwm2mClientType * client, const char * objectL
         }
 
         free(str);
+    }
 
-        // Debug, printout list
-        ListForEach(i, &client->ObjectList)
+    ObjectList_Finalise(&client->Objects);
+
+    // Debug, printout list
+    size_t index;
+    for (index = 0; index < ObjectList_GetCount(&client->Objects); index++)
+    {
+        ObjectInstanceIDType instanceID = ObjectList_GetInstanceID(&client->Objects, index);
+        if (instanceID != -1)
         {
-            ObjectListEntry * entry = ListEntry(i, ObjectListEntry, list);
-            if (entry->InstanceID != -1)
-            {
-                Lwm2m_Info("Path %s Object %d, Instance %d\n", altPath, entry->ObjectID, entry->InstanceID);
-            }
-            else
-            {
-                Lwm2m_Info("Path %s Object %d\n", altPath, entry->ObjectID);
-            }
+            Lwm2m_Info("Path %s Object %d, Instance %d\n", altPath, ObjectList_GetObjectID(&client->Objects, index), instanceID);
+        }
+        else
+        {
+            Lwm2m_Info("Path %s Object %d\n", altPath, ObjectList_GetObjectID(&client->Objects, index));
         }
     }
 }
@@ -237,51 +217,17 @@ static void Lwm2m_ReleaseQueryString(RegistrationQueryString * queryString)
 
 Lwm2mClientType * Lwm2m_LookupClientByName(Lwm2mContextType * context, const char * endPointName)
 {
-    Lwm2mClientType * client = NULL;
-    struct ListHead * i;
-    ListForEach(i, Lwm2mCore_GetClientList(context))
-    {
-        Lwm2mClientType * c = ListEntry(i, Lwm2mClientType, list);
-        if (strcmp(c->EndPointName, endPointName) == 0)
-        {
-            client = c;
-            break;
-        }
-    }
-    return client;
+    return ClientRegistry_LookupByName(Lwm2mCore_GetClientRegistry(context), endPointName);
 }
 
 static Lwm2mClientType * Lwm2m_LookupClientByLocation(Lwm2mContextType * context, int location)
 {
-    Lwm2mClientType * client = NULL;
-    struct ListHead * i;
-    ListForEach(i, Lwm2mCore_GetClientList(context))
-    {
-        Lwm2mClientType * c = ListEntry(i, Lwm2mClientType, list);
-        if (c->Location == location)
-        {
-            client = c;
-            break;
-        }
-    }
-    return client;
+    return ClientRegistry_LookupByLocation(Lwm2mCore_GetClientRegistry(context), location);
 }
 
 Lwm2mClientType * Lwm2m_LookupClientByAddress(Lwm2mContextType * context, AddressType * address)
 {
-    Lwm2mClientType * client = NULL;
-    struct ListHead * i;
-    ListForEach(i, Lwm2mCore_GetClientList(context))
-    {
-        Lwm2mClientType * c = ListEntry(i, Lwm2mClientType, list);
-
-        if (memcmp(c->Address.Addr.Sa.sa_data, address->Addr.Sa.sa_data, sizeof(c->Address.Addr.Sa.sa_data)) == 0)
-        {
-            client = c;
-            break;
-        }
-    }
-    return client;
+    return ClientRegistry_LookupByAddress(Lwm2mCore_GetClientRegistry(context), address);
 }
 
 static void DispatchRegistrationEventCallbacks(Lwm2mContextType * lwm2mContext, RegistrationEventType eventType, void * parameter)
@@ -313,7 +259,7 @@ static int Lwm2m_UpdateClient(Lwm2mContextType * context, int location, int life
     Lwm2mClientType * client = Lwm2m_LookupClientByLocation(context, location);
     if (client)
     {
-        uint32_t now = Lwm2mCore_GetTickCountMs();
+        uint64_t now = Lwm2mCore_GetTickCountMs();
 
         if (lifeTime > 0)
         {
@@ -324,7 +270,7 @@ static int Lwm2m_UpdateClient(Lwm2mContextType * context, int location, int life
             client->LifeTime = LIFETIME_DEFAULT;
         }
 
-        memcpy(&client->Address, addr, sizeof(AddressType));
+        ClientRegistry_UpdateAddress(Lwm2mCore_GetClientRegistry(context), client, addr);
 
         if (contentType == AwaContentType_ApplicationLinkFormat)
         {
@@ -332,6 +278,10 @@ static int Lwm2m_UpdateClient(Lwm2mContextType * context, int location, int life
         }
 
         client->LastUpdateTime = now;
+        if (ClientRegistry_ScheduleExpiry(Lwm2mCore_GetClientRegistry(context), client, now + (uint64_t)client->LifeTime * 1000) != 0)
+        {
+            Lwm2m_Error("Failed to schedule lifetime expiry for client \'%s\'\n", client->EndPointName);
+        }
 
         DispatchRegistrationEventCallbacks(context, registrationEventType, client);
 
@@ -354,25 +304,27 @@ static int Lwm2m_RegisterClient(Lwm2mContextType * context, const char * endPoin
         client = malloc(sizeof(Lwm2mClientType));
         if (client != NULL)
         {
-            char RegisterLocation[128] = {0};
-
             client->EndPointName = strdup(endPointName);
             client->BindingMode = bindingMode;
             client->SupportsJson = false;
 
             client->Location = Lwm2mCore_GetLastLocation(context) + 1;
             Lwm2mCore_SetLastLocation(context, client->Location);
+            memcpy(&client->Address, addr, sizeof(AddressType));
 
-            ListInit(&client->ObjectList);
+            ObjectList_Init(&client->Objects);
 
-            ListAdd(&client->list, Lwm2mCore_GetClientList(context));
-
-            sprintf(RegisterLocation, "/rd/%d", client->Location);
-            Lwm2mCore_AddResourceEndPoint(context, RegisterLocation, UpdateEndpointHandler);
-
-            result = Lwm2m_UpdateClient(context, client->Location, lifeTime, bindingMode, addr, contentType, objectList, objectListLength, RegistrationEventType_Register);
+            if (ClientRegistry_Add(Lwm2mCore_GetClientRegistry(context), client) == 0)
+            {
+                result = Lwm2m_UpdateClient(context, client->Location, lifeTime, bindingMode, addr, contentType, objectList, objectListLength, RegistrationEventType_Register);
 
-            Lwm2m_Info("Client registered: \'%s\'\n", endPointName);
+                Lwm2m_Info("Client registered: \'%s\'\n", endPointName);
+            }
+            else
+            {
+                free(client->EndPointName);
+                free(client);
+            }
         }
         else
         {
@@ -388,13 +340,8 @@ static int Lwm2m_RegisterClient(Lwm2mContextType * context, const char * endPoin
 
 static void Lwm2m_DeregisterClient(Lwm2mContextType * context, Lwm2mClientType * client)
 {
-    char RegisterLocation[128] = {0};
-
-    ListRemove(&client->list);
-    DestroyObjectList(&client->ObjectList);
-
-    sprintf(RegisterLocation, "/rd/%d", client->Location);
-    Lwm2mCore_RemoveResourceEndPoint(context, RegisterLocation);
+    ClientRegistry_Remove(Lwm2mCore_GetClientRegistry(context), client);
+    ObjectList_Free(&client->Objects);
 
     Lwm2m_Info("Client deregistered: \'%s\'\n", client->EndPointName);
 
@@ -469,6 +416,24 @@ done:
     return 0;
 }
 
+// Parse the numeric location from a /rd/<location> path
+static bool ParseLocation(const char * path, int32_t * location)
+{
+    bool result = false;
+    const char * locationStr = path + strlen(REGISTRATION_PATH_PREFIX);
+    if ((strncmp(path, REGISTRATION_PATH_PREFIX, strlen(REGISTRATION_PATH_PREFIX)) == 0) && (*locationStr >= '0') && (*locationStr <= '9'))
+    {
+        char * end;
+        long value = strtol(locationStr, &end, 10);
+        if ((*end == '\0') && (value <= INT32_MAX))
+        {
+            *location = (int32_t)value;
+            result = true;
+        }
+    }
+    return result;
+}
+
 // handler called when a client puts to /rd/<location>
 static int RegisterPut(void * ctxt, AddressType * addr, const char * path,
                        const char * query, AwaContentType contentType,
@@ -485,7 +450,7 @@ static int RegisterPut(void * ctxt, AddressType * addr, const char * path,
 
     *responseContentLen = 0;
 
-    if (sscanf(path, "/rd/%10d\n", &location) != 1)
+    if (!ParseLocation(path, &location))
     {
         *responseCode = AwaResult_BadRequest;
         goto done;
@@ -519,7 +484,7 @@ static int RegisterDelete(void * ctxt, AddressType * addr, const char * path, co
 
     *responseContentLen = 0;
 
-    if (sscanf(path, "/rd/%10d\n", &location) != 1)
+    if (!ParseLocation(path, &location))
     {
         *responseCode = AwaResult_BadRequest;
         goto done;
@@ -540,9 +505,8 @@ done:
 }
 
 
-/* This function is called when a CoAP request is made to any endpoints created during the registration phase.
- * i.e when a Registration message is handled, a new endpoint is created for the client /rd/<location>. these
- * end points are handled here.
+/* This function is called when a CoAP request is made to /rd/<location>. A single wildcard endpoint serves
+ * every registered client; the location is parsed from the path and resolved through the client registry.
  */
 static int UpdateEndpointHandler(int type, void * ctxt, AddressType * addr, const char * path, const char * query, const char * token,
                                  int tokenLength, AwaContentType contentType, const char * requestContent, size_t requestContentLen,
@@ -591,49 +555,31 @@ static int RegistrationEndpointHandler(int type, void * ctxt, AddressType * addr
 
 int32_t Lwm2m_AgeRegistrations(Lwm2mContextType * context)
 {
-    uint32_t now = Lwm2mCore_GetTickCountMs();
-    struct ListHead * i, *n;
+    uint64_t now = Lwm2mCore_GetTickCountMs();
+    ClientRegistry * registry = Lwm2mCore_GetClientRegistry(context);
+    Lwm2mClientType * client;
 
-    ListForEachSafe(i, n, Lwm2mCore_GetClientList(context))
+    while ((client = ClientRegistry_PopExpired(registry, now)) != NULL)
     {
-        Lwm2mClientType * client = ListEntry(i, Lwm2mClientType, list);
+        Lwm2m_Error("Client \'%s\' Lifetime Expired\n", client->EndPointName);
 
-        if ((now - client->LastUpdateTime) > (client->LifeTime * 1000))
-        {
-            Lwm2m_Error("Client \'%s\' Lifetime Expired\n", client->EndPointName);
-
-            Lwm2m_DeregisterClient(context, client);
-        }
+        Lwm2m_DeregisterClient(context, client);
     }
-    return 0;
+    return ClientRegistry_GetNextExpiryTimeout(registry, now);
 }
 
 int Lwm2m_RegistrationInit(Lwm2mContextType * context)
 {
-    // Initialise client list
-    ListInit(Lwm2mCore_GetClientList(context));
     Lwm2mCore_SetLastLocation(context, 0);
 
     Lwm2mCore_AddResourceEndPoint(context, "/rd", RegistrationEndpointHandler);
+    Lwm2mCore_AddResourceEndPoint(context, "/rd/" ENDPOINT_WILDCARD, UpdateEndpointHandler);
 
     ListInit(Lwm2mCore_GetEventRecordList(context));
 
     return 0;
 }
 
-static void DestroyObjectList(struct ListHead * objectList)
-{
-    if (objectList != NULL)
-    {
-        struct ListHead * i, * n;
-        ListForEachSafe(i, n, objectList)
-        {
-            ObjectListEntry * object = ListEntry(i, ObjectListEntry, list);
-            free(object);
-        }
-    }
-}
-
 static void DestroyClientList(struct ListHead * clientList)
 {
     if (clientList != NULL)
@@ -644,7 +590,7 @@ static void DestroyClientList(struct ListHead * clientList)
             Lwm2mClientType * client = ListEntry(i, Lwm2mClientType, list);
             if (client != NULL)
             {
-                DestroyObjectList(&client->ObjectList);
+                ObjectList_Free(&client->Objects);
                 free(client->EndPointName);
                 free(client);
             }
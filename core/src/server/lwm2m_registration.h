@@ -29,6 +29,9 @@
 #include <stdio.h>
 
 #include "lwm2m_core.h"
+#include "lwm2m_hash_table.h"
+#include "lwm2m_timer_queue.h"
+#include "lwm2m_object_list.h"
 #include "coap_abstraction.h"
 #include "../../api/src/ipc_defs.h"
 
@@ -61,24 +64,20 @@ typedef enum
     RegistrationEventType_Deregister,
 } RegistrationEventType;
 
-typedef struct
-{
-    struct ListHead list;
-    ObjectIDType ObjectID;
-    ObjectInstanceIDType InstanceID;
-
-} ObjectListEntry;
-
 // Information about Registered Clients
 typedef struct
 {
     struct ListHead list;
+    HashTableNode NameNode;            // Client registry index on EndPointName
+    HashTableNode LocationNode;        // Client registry index on Location
+    HashTableNode AddressNode;         // Client registry index on Address
+    TimerQueueNode ExpiryNode;         // Client registry expiry queue, due LifeTime after LastUpdateTime
     char * EndPointName;               // Clients "unique" end point name
     AddressType Address;               // Clients address information
     int LifeTime;                      // Lifetime in seconds, 86400 is the default.
     BindingMode BindingMode;           // Binding mode, currently only "U" is supported.
     uint32_t LastUpdateTime;           // Time the client last sent an update or registration request to the server
-    struct ListHead ObjectList;        // List of supported objects, object instances
+    ObjectList Objects;                // Supported objects, object instances
     char * ResourceType;               // RFC6690 Resource Type parameter
     bool SupportsJson;                 // The Client supports JSON for all objects
     int Location;                      // /rd/location, this should probably be a string
@@ -89,7 +88,8 @@ int Lwm2m_RegistrationInit(Lwm2mContextType * context);
 void Lwm2m_RegistrationDestroy(Lwm2mContextType * context);
 
 /* Age the client registrations. The registration will be removed by the server if a registration or update
- * has not been received with the client lifetime.
+ * has not been received with the client lifetime. Only clients that are due are visited.
+ * Returns the number of milliseconds until the next registration expires, or -1 if no clients are registered.
  */
 int32_t Lwm2m_AgeRegistrations(Lwm2mContextType * context);
 
@@ -36,6 +36,7 @@
 #include "lwm2m_core.h"
 #include "lwm2m_result.h"
 #include "server/lwm2m_registration.h"
+#include "server/lwm2m_client_registry.h"
 
 struct _Lwm2mContextType
 {
@@ -43,7 +44,7 @@ struct _Lwm2mContextType
     DefinitionRegistry * Definitions;
     ResourceEndPointList EndPointList;        // CoAP endpoints
     CoapInfo * Coap;                          // CoAP library context information
-    struct ListHead ClientList;               // List of registered clients
+    ClientRegistry * Clients;                 // Registered clients, indexed by name, location and address
     int LastLocation;                         // Used for registration, creates /rd/0, /rd/1 etc
     AwaContentType ContentType;                  // Used to set CoAP content type
     struct ListHead EventRecordList;          // Used to dispatch event callbacks
@@ -95,6 +96,16 @@ ResourceInstanceIDType Lwm2mCore_GetNextResourceInstanceID(Lwm2mContextType * co
     return ObjectStore_GetNextResourceInstanceID(context->Store, objectID, objectInstanceID, resourceID, resourceInstanceID);
 }
 
+int Lwm2mCore_InitIterator(Lwm2mContextType * context, Lwm2mCoreIterator * iterator, ObjectIDType objectID, ObjectInstanceIDType objectInstanceID, ResourceIDType resourceID)
+{
+    return ObjectStore_InitIterator(context->Store, iterator, objectID, objectInstanceID, resourceID);
+}
+
+int Lwm2mCore_IteratorNext(Lwm2mCoreIterator * iterator)
+{
+    return ObjectStore_IteratorNext(iterator);
+}
+
 // This function is called by the CoAP library to handle any requests
 static int Lwm2mCore_HandleRequest(CoapRequest * request, CoapResponse * response)
 {
@@ -135,7 +146,12 @@ int Lwm2mCore_RemoveResourceEndPoint(Lwm2mContextType * context, const char * pa
 
 struct ListHead * Lwm2mCore_GetClientList(Lwm2mContextType * context)
 {
-    return &context->ClientList;
+    return ClientRegistry_GetClientList(context->Clients);
+}
+
+ClientRegistry * Lwm2mCore_GetClientRegistry(Lwm2mContextType * context)
+{
+    return context->Clients;
 }
 
 AwaContentType Lwm2mCore_GetContentType(Lwm2mContextType * context)
@@ -166,6 +182,7 @@ Lwm2mContextType * Lwm2mCore_Init(CoapInfo * coap, AwaContentType contentType)
     context->Coap = coap;
     context->Store = ObjectStore_Create();
     context->Definitions = DefinitionRegistry_Create();
+    context->Clients = ClientRegistry_Create();
     context->ContentType = contentType;
 
     Lwm2mEndPoint_InitEndPointList(&context->EndPointList);
@@ -183,6 +200,7 @@ void Lwm2mCore_Destroy(Lwm2mContextType * context)
     Lwm2mEndPoint_DestroyEndPointList(&context->EndPointList);
     ObjectStore_Destroy(context->Store);
     Lwm2m_RegistrationDestroy(context);
+    ClientRegistry_Destroy(context->Clients);
     DefinitionRegistry_Destroy(context->Definitions);
 }
 
@@ -190,7 +208,6 @@ bool qClientRegisterEvent = false;
 
 int Lwm2mCore_Process(Lwm2mContextType * context)
 {
-    int nextTick = 1000;
-    Lwm2m_AgeRegistrations(context);
-    return nextTick;
+    // CoAP retransmissions report their own deadline from coap_Process(), so only registration expiry is timed here
+    return Lwm2m_AgeRegistrations(context);
 }
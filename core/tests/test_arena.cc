@@ -0,0 +1,104 @@
+/************************************************************************************************************************
+ Copyright (c) 2016, Imagination Technologies Limited and/or its affiliated group companies.
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+ following conditions are met:
+     1. Redistributions of source code must retain the above copyright notice, this list of conditions and the
+        following disclaimer.
+     2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the
+        following disclaimer in the documentation and/or other materials provided with the distribution.
+     3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote
+        products derived from this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+ USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+************************************************************************************************************************/
+
+
+#include <gtest/gtest.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "lwm2m_arena.h"
+
+TEST(MemoryArenaTestSuite, test_allocations_come_from_initial_block)
+{
+    uint8_t block[256];
+    MemoryArena arena;
+    MemoryArenaStats stats;
+    MemoryArena_Init(&arena, block, sizeof(block), 1024);
+
+    uint8_t * first = (uint8_t *)MemoryArena_Alloc(&arena, 10);
+    uint8_t * second = (uint8_t *)MemoryArena_Alloc(&arena, 10);
+    ASSERT_TRUE(NULL != first);
+    ASSERT_TRUE(NULL != second);
+    EXPECT_TRUE((first >= block) && (second + 10 <= block + sizeof(block)));
+    EXPECT_TRUE(second >= first + 10);
+    memset(first, 0xA5, 10);
+    memset(second, 0x5A, 10);
+    EXPECT_EQ(0xA5, first[9]);
+
+    MemoryArena_GetStats(&arena, &stats);
+    EXPECT_EQ(2u, stats.Allocations);
+    EXPECT_EQ(0u, stats.HeapBlocks);
+
+    MemoryArena_Destroy(&arena);
+}
+
+TEST(MemoryArenaTestSuite, test_allocations_are_aligned)
+{
+    uint8_t block[256];
+    MemoryArena arena;
+    MemoryArena_Init(&arena, block + 1, sizeof(block) - 1, 1024);
+
+    for (size_t size = 1; size < 20; size++)
+    {
+        void * allocation = MemoryArena_Alloc(&arena, size);
+        ASSERT_TRUE(NULL != allocation);
+        EXPECT_EQ(0u, (uintptr_t)allocation % sizeof(void *));
+    }
+
+    MemoryArena_Destroy(&arena);
+}
+
+TEST(MemoryArenaTestSuite, test_full_block_spills_to_heap)
+{
+    uint8_t block[64];
+    MemoryArena arena;
+    MemoryArenaStats stats;
+    MemoryArena_Init(&arena, block, sizeof(block), 128);
+
+    for (int i = 0; i < 20; i++)
+    {
+        ASSERT_TRUE(NULL != MemoryArena_Alloc(&arena, 16));
+    }
+
+    MemoryArena_GetStats(&arena, &stats);
+    EXPECT_EQ(20u, stats.Allocations);
+    EXPECT_LT(0u, stats.HeapBlocks);
+
+    MemoryArena_Destroy(&arena);
+}
+
+TEST(MemoryArenaTestSuite, test_oversized_allocation)
+{
+    MemoryArena arena;
+    MemoryArenaStats stats;
+    MemoryArena_Init(&arena, NULL, 0, 64);
+
+    uint8_t * large = (uint8_t *)MemoryArena_Alloc(&arena, 1000);
+    ASSERT_TRUE(NULL != large);
+    memset(large, 0, 1000);
+    EXPECT_TRUE(NULL != MemoryArena_Alloc(&arena, 8));
+
+    MemoryArena_GetStats(&arena, &stats);
+    EXPECT_EQ(2u, stats.HeapBlocks);
+
+    MemoryArena_Destroy(&arena);
+}
@@ -0,0 +1,175 @@
+/************************************************************************************************************************
+ Copyright (c) 2016, Imagination Technologies Limited and/or its affiliated group companies.
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+ following conditions are met:
+     1. Redistributions of source code must retain the above copyright notice, this list of conditions and the
+        following disclaimer.
+     2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the
+        following disclaimer in the documentation and/or other materials provided with the distribution.
+     3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote
+        products derived from this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+ USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+************************************************************************************************************************/
+
+#include <gtest/gtest.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "coap_block1_transfers.h"
+
+#define MAX_PAYLOAD     (1024)
+#define MAX_TRANSFERS   (2)
+#define TIMEOUT_MS      (1000)
+
+class CoapBlock1TransfersTestSuite : public testing::Test
+{
+protected:
+    void SetUp()
+    {
+        transfers_ = CoapBlock1Transfers_Create(MAX_PAYLOAD, MAX_TRANSFERS, TIMEOUT_MS);
+        ASSERT_TRUE(NULL != transfers_);
+        for (int i = 0; i < 3; i++)
+        {
+            char uri[64];
+            sprintf(uri, "coap://127.0.0.1:%d", 21000 + i);
+            addresses_[i] = NetworkAddress_New(uri, strlen(uri));
+            ASSERT_TRUE(NULL != addresses_[i]);
+        }
+        for (size_t i = 0; i < sizeof(block_); i++)
+        {
+            block_[i] = i & 0xff;
+        }
+    }
+
+    void TearDown()
+    {
+        CoapBlock1Transfers_Destroy(transfers_);
+        for (int i = 0; i < 3; i++)
+        {
+            NetworkAddress_Free(&addresses_[i]);
+        }
+    }
+
+    CoapBlock1Transfers * transfers_;
+    NetworkAddress * addresses_[3];
+    uint8_t block_[256];
+};
+
+TEST_F(CoapBlock1TransfersTestSuite, test_reassembles_blocks_in_order)
+{
+    CoapBlock1Transfer * transfer = CoapBlock1Transfers_Start(transfers_, addresses_[0], "/1000/0", 0);
+    ASSERT_TRUE(NULL != transfer);
+    EXPECT_EQ(transfer, CoapBlock1Transfers_Find(transfers_, addresses_[0], "/1000/0"));
+    EXPECT_TRUE(NULL == CoapBlock1Transfers_Find(transfers_, addresses_[1], "/1000/0"));
+    EXPECT_TRUE(NULL == CoapBlock1Transfers_Find(transfers_, addresses_[0], "/1000/1"));
+
+    for (size_t offset = 0; offset < 1024; offset += sizeof(block_))
+    {
+        EXPECT_EQ(CoapBlock1Result_Success, CoapBlock1Transfers_Append(transfers_, transfer, offset, block_, sizeof(block_), 0));
+    }
+    ASSERT_EQ(1024u, transfer->Length);
+    EXPECT_EQ(0, memcmp(block_, &transfer->Payload[768], sizeof(block_)));
+
+    CoapBlock1Transfers_Finish(transfers_, transfer);
+    EXPECT_EQ(0u, CoapBlock1Transfers_GetCount(transfers_));
+}
+
+TEST_F(CoapBlock1TransfersTestSuite, test_rejects_out_of_sequence_and_oversized_blocks)
+{
+    CoapBlock1Transfer * transfer = CoapBlock1Transfers_Start(transfers_, addresses_[0], "/1000/0", 0);
+    ASSERT_TRUE(NULL != transfer);
+
+    EXPECT_EQ(CoapBlock1Result_Incomplete, CoapBlock1Transfers_Append(transfers_, transfer, 256, block_, sizeof(block_), 0));
+    EXPECT_EQ(0u, transfer->Length);
+
+    for (size_t offset = 0; offset < 1024; offset += sizeof(block_))
+    {
+        EXPECT_EQ(CoapBlock1Result_Success, CoapBlock1Transfers_Append(transfers_, transfer, offset, block_, sizeof(block_), 0));
+    }
+    EXPECT_EQ(CoapBlock1Result_TooLarge, CoapBlock1Transfers_Append(transfers_, transfer, 1024, block_, 1, 0));
+}
+
+TEST_F(CoapBlock1TransfersTestSuite, test_repeated_last_block_is_a_duplicate)
+{
+    uint8_t other[sizeof(block_)];
+    memset(other, 0x5a, sizeof(other));
+
+    CoapBlock1Transfer * transfer = CoapBlock1Transfers_Start(transfers_, addresses_[0], "/1000/0", 0);
+    ASSERT_TRUE(NULL != transfer);
+    EXPECT_EQ(CoapBlock1Result_Success, CoapBlock1Transfers_Append(transfers_, transfer, 0, block_, sizeof(block_), 0));
+    EXPECT_EQ(CoapBlock1Result_Duplicate, CoapBlock1Transfers_Append(transfers_, transfer, 0, block_, sizeof(block_), 0));
+    EXPECT_EQ(CoapBlock1Result_Success, CoapBlock1Transfers_Append(transfers_, transfer, 256, other, sizeof(other), 0));
+
+    // the peer retransmits the block whose ACK was lost; it is not appended twice
+    EXPECT_EQ(CoapBlock1Result_Duplicate, CoapBlock1Transfers_Append(transfers_, transfer, 256, other, sizeof(other), TIMEOUT_MS / 2));
+    EXPECT_EQ(512u, transfer->Length);
+
+    // the duplicate kept the transfer alive
+    EXPECT_EQ(TIMEOUT_MS / 2, CoapBlock1Transfers_Expire(transfers_, TIMEOUT_MS));
+    EXPECT_EQ(1u, CoapBlock1Transfers_GetCount(transfers_));
+
+    // only the last block counts, and only with the same contents
+    EXPECT_EQ(CoapBlock1Result_Incomplete, CoapBlock1Transfers_Append(transfers_, transfer, 0, block_, sizeof(block_), 0));
+    EXPECT_EQ(CoapBlock1Result_Incomplete, CoapBlock1Transfers_Append(transfers_, transfer, 256, block_, sizeof(block_), 0));
+    EXPECT_EQ(CoapBlock1Result_Incomplete, CoapBlock1Transfers_Append(transfers_, transfer, 256, other, 128, 0));
+
+    EXPECT_EQ(CoapBlock1Result_Success, CoapBlock1Transfers_Append(transfers_, transfer, 512, block_, sizeof(block_), 0));
+    EXPECT_EQ(768u, transfer->Length);
+    EXPECT_EQ(0, memcmp(other, &transfer->Payload[256], sizeof(other)));
+    EXPECT_EQ(0, memcmp(block_, &transfer->Payload[512], sizeof(block_)));
+}
+
+TEST_F(CoapBlock1TransfersTestSuite, test_restart_replaces_transfer)
+{
+    CoapBlock1Transfer * transfer = CoapBlock1Transfers_Start(transfers_, addresses_[0], "/1000/0", 0);
+    ASSERT_TRUE(NULL != transfer);
+    EXPECT_EQ(CoapBlock1Result_Success, CoapBlock1Transfers_Append(transfers_, transfer, 0, block_, sizeof(block_), 0));
+
+    transfer = CoapBlock1Transfers_Start(transfers_, addresses_[0], "/1000/0", 0);
+    ASSERT_TRUE(NULL != transfer);
+    EXPECT_EQ(0u, transfer->Length);
+    EXPECT_EQ(1u, CoapBlock1Transfers_GetCount(transfers_));
+}
+
+TEST_F(CoapBlock1TransfersTestSuite, test_limits_transfers_and_reuses_buffers)
+{
+    ASSERT_TRUE(NULL != CoapBlock1Transfers_Start(transfers_, addresses_[0], "/1000/0", 0));
+    CoapBlock1Transfer * transfer = CoapBlock1Transfers_Start(transfers_, addresses_[1], "/1000/0", 0);
+    ASSERT_TRUE(NULL != transfer);
+    EXPECT_TRUE(NULL == CoapBlock1Transfers_Start(transfers_, addresses_[2], "/1000/0", 0));
+
+    CoapBlock1Transfers_Finish(transfers_, transfer);
+    EXPECT_TRUE(NULL != CoapBlock1Transfers_Start(transfers_, addresses_[2], "/1000/0", 0));
+
+    MemoryPoolStats stats;
+    CoapBlock1Transfers_GetPoolStats(transfers_, &stats);
+    EXPECT_EQ(2u, stats.InUse);
+    EXPECT_EQ(1u, stats.Reused);
+    EXPECT_EQ(1u, stats.AllocationFailures);
+}
+
+TEST_F(CoapBlock1TransfersTestSuite, test_expires_idle_transfers)
+{
+    CoapBlock1Transfer * transfer = CoapBlock1Transfers_Start(transfers_, addresses_[0], "/1000/0", 0);
+    ASSERT_TRUE(NULL != transfer);
+    ASSERT_TRUE(NULL != CoapBlock1Transfers_Start(transfers_, addresses_[1], "/1000/0", 0));
+    EXPECT_EQ(TIMEOUT_MS, CoapBlock1Transfers_Expire(transfers_, 0));
+
+    // a new block restarts the timeout
+    EXPECT_EQ(CoapBlock1Result_Success, CoapBlock1Transfers_Append(transfers_, transfer, 0, block_, sizeof(block_), 500));
+    EXPECT_EQ(500, CoapBlock1Transfers_Expire(transfers_, TIMEOUT_MS));
+    EXPECT_EQ(1u, CoapBlock1Transfers_GetCount(transfers_));
+    EXPECT_EQ(transfer, CoapBlock1Transfers_Find(transfers_, addresses_[0], "/1000/0"));
+
+    EXPECT_EQ(-1, CoapBlock1Transfers_Expire(transfers_, TIMEOUT_MS + 500));
+    EXPECT_EQ(0u, CoapBlock1Transfers_GetCount(transfers_));
+}
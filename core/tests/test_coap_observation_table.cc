@@ -0,0 +1,164 @@
+/************************************************************************************************************************
+ Copyright (c) 2016, Imagination Technologies Limited and/or its affiliated group companies.
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+ following conditions are met:
+     1. Redistributions of source code must retain the above copyright notice, this list of conditions and the
+        following disclaimer.
+     2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the
+        following disclaimer in the documentation and/or other materials provided with the distribution.
+     3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote
+        products derived from this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+ USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+************************************************************************************************************************/
+
+
+#include <gtest/gtest.h>
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+#include "coap_observation_table.h"
+
+#define NUM_ADDRESSES         (100)
+#define PATHS_PER_ADDRESS     (1000)
+
+class CoapObservationTableTestSuite : public testing::Test
+{
+protected:
+    void SetUp()
+    {
+        table_ = CoapObservationTable_Create();
+        ASSERT_TRUE(NULL != table_);
+        for (int i = 0; i < NUM_ADDRESSES; i++)
+        {
+            char uri[64];
+            sprintf(uri, "coap://127.0.0.1:%d", 20000 + i);
+            NetworkAddress * address = NetworkAddress_New(uri, strlen(uri));
+            ASSERT_TRUE(NULL != address);
+            addresses_.push_back(address);
+        }
+    }
+
+    void TearDown()
+    {
+        CoapObservationTable_Destroy(table_);
+        for (size_t i = 0; i < addresses_.size(); i++)
+        {
+            NetworkAddress_Free(&addresses_[i]);
+        }
+    }
+
+    static void MakePath(char * path, int index)
+    {
+        sprintf(path, "3303/%d/5700", index);
+    }
+
+    CoapObservationTable * table_;
+    std::vector<NetworkAddress *> addresses_;
+};
+
+TEST_F(CoapObservationTableTestSuite, test_add_and_find)
+{
+    CoapObservation * observation = CoapObservationTable_Add(table_, addresses_[0], "3/0/9", NULL, this);
+    ASSERT_TRUE(NULL != observation);
+    EXPECT_NE(0, observation->Token);
+    EXPECT_STREQ("3/0/9", observation->Path);
+    EXPECT_EQ(this, observation->Context);
+    EXPECT_EQ(1u, CoapObservationTable_GetCount(table_));
+
+    EXPECT_EQ(observation, CoapObservationTable_FindByToken(table_, observation->Token, addresses_[0]));
+    EXPECT_EQ(observation, CoapObservationTable_FindByAddressAndPath(table_, addresses_[0], "3/0/9"));
+}
+
+TEST_F(CoapObservationTableTestSuite, test_find_requires_matching_address)
+{
+    CoapObservation * observation = CoapObservationTable_Add(table_, addresses_[0], "3/0/9", NULL, NULL);
+    ASSERT_TRUE(NULL != observation);
+
+    EXPECT_TRUE(NULL == CoapObservationTable_FindByToken(table_, observation->Token, addresses_[1]));
+    EXPECT_TRUE(NULL == CoapObservationTable_FindByAddressAndPath(table_, addresses_[1], "3/0/9"));
+    EXPECT_TRUE(NULL == CoapObservationTable_FindByAddressAndPath(table_, addresses_[0], "3/0/10"));
+}
+
+TEST_F(CoapObservationTableTestSuite, test_remove)
+{
+    CoapObservation * observation = CoapObservationTable_Add(table_, addresses_[0], "3/0/9", NULL, NULL);
+    ASSERT_TRUE(NULL != observation);
+    int token = observation->Token;
+
+    CoapObservationTable_Remove(table_, observation);
+    EXPECT_EQ(0u, CoapObservationTable_GetCount(table_));
+    EXPECT_TRUE(NULL == CoapObservationTable_FindByToken(table_, token, addresses_[0]));
+    EXPECT_TRUE(NULL == CoapObservationTable_FindByAddressAndPath(table_, addresses_[0], "3/0/9"));
+}
+
+TEST_F(CoapObservationTableTestSuite, test_path_too_long)
+{
+    char path[MAX_COAP_OBSERVATION_PATH + 1];
+    memset(path, 'a', sizeof(path) - 1);
+    path[sizeof(path) - 1] = '\0';
+    EXPECT_TRUE(NULL == CoapObservationTable_Add(table_, addresses_[0], path, NULL, NULL));
+    EXPECT_EQ(0u, CoapObservationTable_GetCount(table_));
+}
+
+TEST_F(CoapObservationTableTestSuite, test_100k_observations)
+{
+    std::vector<int> tokens;
+    char path[MAX_COAP_OBSERVATION_PATH];
+
+    for (int i = 0; i < NUM_ADDRESSES; i++)
+    {
+        for (int j = 0; j < PATHS_PER_ADDRESS; j++)
+        {
+            MakePath(path, j);
+            CoapObservation * observation = CoapObservationTable_Add(table_, addresses_[i], path, NULL, NULL);
+            ASSERT_TRUE(NULL != observation);
+            tokens.push_back(observation->Token);
+        }
+    }
+    ASSERT_EQ((size_t)NUM_ADDRESSES * PATHS_PER_ADDRESS, CoapObservationTable_GetCount(table_));
+
+    // every notification and every cancellation resolves to the right observation
+    for (int i = 0; i < NUM_ADDRESSES; i++)
+    {
+        for (int j = 0; j < PATHS_PER_ADDRESS; j++)
+        {
+            MakePath(path, j);
+            CoapObservation * observation = CoapObservationTable_FindByToken(table_, tokens[i * PATHS_PER_ADDRESS + j], addresses_[i]);
+            ASSERT_TRUE(NULL != observation);
+            ASSERT_STREQ(path, observation->Path);
+            ASSERT_EQ(observation, CoapObservationTable_FindByAddressAndPath(table_, addresses_[i], path));
+        }
+    }
+
+    // cancel every other observation
+    for (int i = 0; i < NUM_ADDRESSES; i++)
+    {
+        for (int j = 0; j < PATHS_PER_ADDRESS; j += 2)
+        {
+            MakePath(path, j);
+            CoapObservation * observation = CoapObservationTable_FindByAddressAndPath(table_, addresses_[i], path);
+            ASSERT_TRUE(NULL != observation);
+            CoapObservationTable_Remove(table_, observation);
+        }
+    }
+    ASSERT_EQ((size_t)NUM_ADDRESSES * PATHS_PER_ADDRESS / 2, CoapObservationTable_GetCount(table_));
+
+    for (int i = 0; i < NUM_ADDRESSES; i++)
+    {
+        for (int j = 0; j < PATHS_PER_ADDRESS; j++)
+        {
+            CoapObservation * observation = CoapObservationTable_FindByToken(table_, tokens[i * PATHS_PER_ADDRESS + j], addresses_[i]);
+            ASSERT_EQ(j % 2 == 1, observation != NULL);
+        }
+    }
+}
@@ -0,0 +1,475 @@
+/************************************************************************************************************************
+ Copyright (c) 2016, Imagination Technologies Limited and/or its affiliated group companies.
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+ following conditions are met:
+     1. Redistributions of source code must retain the above copyright notice, this list of conditions and the
+        following disclaimer.
+     2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the
+        following disclaimer in the documentation and/or other materials provided with the distribution.
+     3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote
+        products derived from this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+ USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+************************************************************************************************************************/
+
+#include <gtest/gtest.h>
+#include <string>
+#include <string.h>
+#include <unistd.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+#include "coap_abstraction.h"
+#include "lwm2m_debug.h"
+extern "C" {
+#include "erbium/er-coap.h"
+}
+
+// Drives the Erbium CoAP abstraction against a peer socket that plays the server, to check that responses
+// reach the request they belong to however many requests are outstanding.
+class CoapOutstandingRequestsTestSuite : public testing::Test
+{
+protected:
+    struct Response
+    {
+        int Calls;
+        int Code;
+        std::string Payload;
+    };
+
+    struct Request
+    {
+        coap_packet_t Packet;
+        uint8_t Buffer[COAP_MAX_PACKET_SIZE];
+        struct sockaddr_in From;
+    };
+
+    void SetUp()
+    {
+        Lwm2m_SetLogLevel(DebugLevel_Warning);
+        coapInfo_ = coap_Init("127.0.0.1", 0, false, 0);
+        ASSERT_TRUE(NULL != coapInfo_);
+
+        struct sockaddr_in local;
+        peer_ = OpenPeer(&local);
+        ASSERT_LE(0, peer_);
+        snprintf(uri_, sizeof(uri_), "coap://127.0.0.1:%d/3/0/", ntohs(local.sin_port));
+    }
+
+    static int OpenPeer(struct sockaddr_in * local)
+    {
+        int fd = socket(AF_INET, SOCK_DGRAM, 0);
+        socklen_t length = sizeof(*local);
+        memset(local, 0, sizeof(*local));
+        local->sin_family = AF_INET;
+        inet_pton(AF_INET, "127.0.0.1", &local->sin_addr);
+        if ((fd >= 0) && ((bind(fd, (struct sockaddr *)local, sizeof(*local)) != 0) || (getsockname(fd, (struct sockaddr *)local, &length) != 0)))
+        {
+            close(fd);
+            fd = -1;
+        }
+        return fd;
+    }
+
+    void TearDown()
+    {
+        close(peer_);
+        coap_Destroy();
+        coap_SetMaxPayloadSize(COAP_MAX_PAYLOAD_SIZE);
+        coap_SetRequestHandler(NULL);
+    }
+
+    static void Callback(void * context, AddressType * addr, const char * responsePath, int responseCode, AwaContentType contentType, char * payload, size_t payloadLen)
+    {
+        Response * response = (Response *)context;
+        response->Calls++;
+        response->Code = responseCode;
+        response->Payload.assign(payload != NULL ? payload : "", payloadLen);
+    }
+
+    void Get(int resourceID, Response * response)
+    {
+        char uri[96];
+        snprintf(uri, sizeof(uri), "%s%d", uri_, resourceID);
+        response->Calls = 0;
+        response->Code = 0;
+        response->Payload.clear();
+        coap_GetRequest(response, uri, AwaContentType_ApplicationOmaLwm2mTLV, Callback);
+    }
+
+    bool ReceiveRequest(Request * request)
+    {
+        struct pollfd fd = { peer_, POLLIN, 0 };
+        socklen_t length = sizeof(request->From);
+        if (poll(&fd, 1, 1000) != 1)
+            return false;
+        int received = recvfrom(peer_, request->Buffer, sizeof(request->Buffer), 0, (struct sockaddr *)&request->From, &length);
+        return (received > 0) && (coap_parse_message(&request->Packet, request->Buffer, received) == NO_ERROR);
+    }
+
+    void Send(const Request & request, coap_message_type_t type, uint8_t code, uint16_t mid, const char * payload)
+    {
+        SendFrom(peer_, request, type, code, mid, request.Packet.token, request.Packet.token_len, payload);
+    }
+
+    void SendFrom(int fd, const Request & request, coap_message_type_t type, uint8_t code, uint16_t mid, const uint8_t * token, size_t tokenLength, const char * payload)
+    {
+        coap_packet_t message;
+        uint8_t buffer[COAP_MAX_PACKET_SIZE];
+        coap_init_message(&message, type, code, mid);
+        if (code != 0)
+        {
+            coap_set_token(&message, token, tokenLength);
+            coap_set_payload(&message, payload, strlen(payload));
+        }
+        size_t length = coap_serialize_message(&message, buffer);
+        ASSERT_EQ((ssize_t)length, sendto(fd, buffer, length, 0, (const struct sockaddr *)&request.From, sizeof(request.From)));
+    }
+
+    // Respond in the ACK that acknowledges the request
+    void Respond(const Request & request, const char * payload)
+    {
+        Send(request, COAP_TYPE_ACK, CONTENT_2_05, request.Packet.mid, payload);
+    }
+
+    // Respond with one 16-byte Block2 block of a representation tagged etag
+    void RespondBlock(const Request & request, uint8_t more, uint32_t etag, const char * payload)
+    {
+        coap_packet_t message;
+        uint8_t buffer[COAP_MAX_PACKET_SIZE];
+        uint32_t num = 0;
+        coap_get_header_block2((void *)&request.Packet, &num, NULL, NULL, NULL);
+        coap_init_message(&message, COAP_TYPE_ACK, CONTENT_2_05, request.Packet.mid);
+        coap_set_token(&message, request.Packet.token, request.Packet.token_len);
+        coap_set_header_block2(&message, num, more, 16);
+        coap_set_header_etag(&message, (const uint8_t *)&etag, sizeof(etag));
+        coap_set_payload(&message, payload, strlen(payload));
+        size_t length = coap_serialize_message(&message, buffer);
+        ASSERT_EQ((ssize_t)length, sendto(peer_, buffer, length, 0, (const struct sockaddr *)&request.From, sizeof(request.From)));
+    }
+
+    // Let the abstraction handle whatever the peer has sent
+    void Process()
+    {
+        struct pollfd fd = { coapInfo_->fd, POLLIN, 0 };
+        while (poll(&fd, 1, 100) == 1)
+        {
+            coap_HandleMessage();
+        }
+    }
+
+    CoapInfo * coapInfo_;
+    int peer_;
+    char uri_[64];
+};
+
+TEST_F(CoapOutstandingRequestsTestSuite, test_responses_reach_their_requests)
+{
+    const int numRequests = 5;
+    Response responses[numRequests];
+    Request requests[numRequests];
+
+    for (int i = 0; i < numRequests; i++)
+    {
+        Get(i, &responses[i]);
+    }
+    for (int i = 0; i < numRequests; i++)
+    {
+        ASSERT_TRUE(ReceiveRequest(&requests[i]));
+        for (int j = 0; j < i; j++)
+        {
+            EXPECT_NE(requests[j].Packet.mid, requests[i].Packet.mid);
+        }
+    }
+
+    // answer in the opposite order to the requests
+    for (int i = numRequests - 1; i >= 0; i--)
+    {
+        char payload[16];
+        snprintf(payload, sizeof(payload), "value %d", i);
+        Respond(requests[i], payload);
+    }
+    Process();
+
+    for (int i = 0; i < numRequests; i++)
+    {
+        char payload[16];
+        snprintf(payload, sizeof(payload), "value %d", i);
+        EXPECT_EQ(1, responses[i].Calls);
+        EXPECT_EQ(205, responses[i].Code);
+        EXPECT_EQ(payload, responses[i].Payload);
+    }
+}
+
+TEST_F(CoapOutstandingRequestsTestSuite, test_separate_response_matched_by_token)
+{
+    Response first;
+    Response second;
+    Response third;
+    Request requests[3];
+
+    Get(1, &first);
+    Get(2, &second);
+    Get(3, &third);
+    for (int i = 0; i < 3; i++)
+    {
+        ASSERT_TRUE(ReceiveRequest(&requests[i]));
+    }
+
+    // the second request is acknowledged now and answered later, after the others
+    Send(requests[1], COAP_TYPE_ACK, 0, requests[1].Packet.mid, NULL);
+    Respond(requests[0], "first");
+    Respond(requests[2], "third");
+    Process();
+    EXPECT_EQ(1, first.Calls);
+    EXPECT_EQ(0, second.Calls);
+    EXPECT_EQ(1, third.Calls);
+
+    // the separate response has a message ID of its own; only its token identifies the request
+    uint16_t separateMid = requests[1].Packet.mid + 1000;
+    Send(requests[1], COAP_TYPE_CON, CONTENT_2_05, separateMid, "second");
+    Process();
+    EXPECT_EQ(1, second.Calls);
+    EXPECT_EQ(205, second.Code);
+    EXPECT_EQ("second", second.Payload);
+    EXPECT_EQ("first", first.Payload);
+    EXPECT_EQ("third", third.Payload);
+
+    // a confirmable separate response is acknowledged
+    Request ack;
+    ASSERT_TRUE(ReceiveRequest(&ack));
+    EXPECT_EQ(COAP_TYPE_ACK, ack.Packet.type);
+    EXPECT_EQ(separateMid, ack.Packet.mid);
+}
+
+TEST_F(CoapOutstandingRequestsTestSuite, test_message_id_wraparound_skips_outstanding_request)
+{
+    Response outstanding;
+    Response later;
+    Request requests[2];
+
+    Get(1, &outstanding);
+    ASSERT_TRUE(ReceiveRequest(&requests[0]));
+    uint16_t outstandingMid = requests[0].Packet.mid;
+
+    // use up message IDs until the 16-bit counter has wrapped round to the outstanding request's
+    while (coap_get_mid() != (uint16_t)(outstandingMid - 1))
+        ;
+
+    Get(2, &later);
+    ASSERT_TRUE(ReceiveRequest(&requests[1]));
+    EXPECT_EQ((uint16_t)(outstandingMid + 1), requests[1].Packet.mid);
+
+    Respond(requests[1], "later");
+    Respond(requests[0], "outstanding");
+    Process();
+    EXPECT_EQ(1, outstanding.Calls);
+    EXPECT_EQ("outstanding", outstanding.Payload);
+    EXPECT_EQ(1, later.Calls);
+    EXPECT_EQ("later", later.Payload);
+}
+
+TEST_F(CoapOutstandingRequestsTestSuite, test_response_from_another_peer_is_ignored)
+{
+    Response response;
+    Request request;
+
+    Get(1, &response);
+    ASSERT_TRUE(ReceiveRequest(&request));
+
+    // message IDs are only unique per peer: another peer's ACK with the same ID and token is not the response
+    struct sockaddr_in otherAddress;
+    int other = OpenPeer(&otherAddress);
+    ASSERT_LE(0, other);
+    SendFrom(other, request, COAP_TYPE_ACK, CONTENT_2_05, request.Packet.mid, request.Packet.token, request.Packet.token_len, "other");
+    Process();
+    close(other);
+    EXPECT_EQ(0, response.Calls);
+
+    Respond(request, "value");
+    Process();
+    EXPECT_EQ(1, response.Calls);
+    EXPECT_EQ("value", response.Payload);
+}
+
+TEST_F(CoapOutstandingRequestsTestSuite, test_confirmable_message_reusing_request_mid_is_not_the_response)
+{
+    Response response;
+    Request request;
+
+    Get(1, &response);
+    ASSERT_TRUE(ReceiveRequest(&request));
+
+    // a peer's own confirmable message may reuse the ID of our request; only an ACK or RST echoes it
+    const uint8_t otherToken[] = { 0x5a, 0xa5 };
+    SendFrom(peer_, request, COAP_TYPE_CON, CONTENT_2_05, request.Packet.mid, otherToken, sizeof(otherToken), "notification");
+    Process();
+    EXPECT_EQ(0, response.Calls);
+
+    Request ack;
+    ASSERT_TRUE(ReceiveRequest(&ack));
+    EXPECT_EQ(COAP_TYPE_ACK, ack.Packet.type);
+
+    Respond(request, "value");
+    Process();
+    EXPECT_EQ(1, response.Calls);
+    EXPECT_EQ("value", response.Payload);
+}
+
+TEST_F(CoapOutstandingRequestsTestSuite, test_piggybacked_response_with_wrong_token_is_ignored)
+{
+    Response response;
+    Request request;
+
+    Get(1, &response);
+    ASSERT_TRUE(ReceiveRequest(&request));
+
+    // the ACK settles the message, but its response is not ours; the right one may still follow separately
+    const uint8_t otherToken[] = { 0x5a, 0xa5 };
+    SendFrom(peer_, request, COAP_TYPE_ACK, CONTENT_2_05, request.Packet.mid, otherToken, sizeof(otherToken), "other");
+    Process();
+    EXPECT_EQ(0, response.Calls);
+
+    Send(request, COAP_TYPE_NON, CONTENT_2_05, request.Packet.mid + 1000, "value");
+    Process();
+    EXPECT_EQ(1, response.Calls);
+    EXPECT_EQ("value", response.Payload);
+}
+
+TEST_F(CoapOutstandingRequestsTestSuite, test_block2_transfer_restarts_when_representation_changes)
+{
+    Response response;
+    Request request;
+
+    Get(1, &response);
+    ASSERT_TRUE(ReceiveRequest(&request));
+    RespondBlock(request, 1, 0x1111, "old-block-0-----");
+    Process();
+
+    // the resource changed after the first block was served: its blocks cannot be combined with the new ones
+    ASSERT_TRUE(ReceiveRequest(&request));
+    RespondBlock(request, 0, 0x2222, "new-block-1");
+    Process();
+    EXPECT_EQ(0, response.Calls);
+
+    uint32_t num = 1;
+    ASSERT_TRUE(ReceiveRequest(&request));
+    ASSERT_TRUE(coap_get_header_block2(&request.Packet, &num, NULL, NULL, NULL));
+    EXPECT_EQ(0u, num);
+    RespondBlock(request, 1, 0x2222, "new-block-0-----");
+    Process();
+    ASSERT_TRUE(ReceiveRequest(&request));
+    RespondBlock(request, 0, 0x2222, "new-block-1");
+    Process();
+
+    EXPECT_EQ(1, response.Calls);
+    EXPECT_EQ(205, response.Code);
+    EXPECT_EQ("new-block-0-----new-block-1", response.Payload);
+}
+
+TEST_F(CoapOutstandingRequestsTestSuite, test_block2_transfer_fails_when_representation_keeps_changing)
+{
+    Response response;
+    Request request;
+    uint32_t etag = 1;
+
+    Get(1, &response);
+    ASSERT_TRUE(ReceiveRequest(&request));
+    RespondBlock(request, 1, etag, "block-0---------");
+    Process();
+    while ((response.Calls == 0) && ReceiveRequest(&request))
+    {
+        uint32_t num = 0;
+        coap_get_header_block2(&request.Packet, &num, NULL, NULL, NULL);
+        if (num > 0)
+        {
+            etag++;
+        }
+        RespondBlock(request, 1, etag, "block-----------");
+        Process();
+    }
+
+    EXPECT_EQ(1, response.Calls);
+    EXPECT_EQ(0, response.Code);
+    EXPECT_GT(10u, etag);
+}
+
+TEST_F(CoapOutstandingRequestsTestSuite, test_block2_transfer_limited_to_max_payload_size)
+{
+    Response response;
+    Request request;
+
+    coap_Destroy();
+    coap_SetMaxPayloadSize(24);
+    coapInfo_ = coap_Init("127.0.0.1", 0, false, 0);
+    ASSERT_TRUE(NULL != coapInfo_);
+
+    Get(1, &response);
+    ASSERT_TRUE(ReceiveRequest(&request));
+    RespondBlock(request, 1, 0x1111, "block-0---------");
+    Process();
+    ASSERT_TRUE(ReceiveRequest(&request));
+    RespondBlock(request, 0, 0x1111, "block-1---------");
+    Process();
+
+    EXPECT_EQ(1, response.Calls);
+    EXPECT_EQ(0, response.Code);
+}
+
+static std::string ServedPayload;
+
+static int ServePayload(CoapRequest * request, CoapResponse * response)
+{
+    memcpy(response->responseContent, ServedPayload.data(), ServedPayload.size());
+    response->responseContentLen = ServedPayload.size();
+    response->responseContentType = AwaContentType_ApplicationPlainText;
+    response->responseCode = 205;
+    return 0;
+}
+
+TEST_F(CoapOutstandingRequestsTestSuite, test_block2_response_tagged_with_representation)
+{
+    struct sockaddr_in local;
+    socklen_t length = sizeof(local);
+    ASSERT_EQ(0, getsockname(coapInfo_->fd, (struct sockaddr *)&local, &length));
+    coap_SetRequestHandler(ServePayload);
+    ServedPayload.assign(COAP_MAX_BLOCK_SIZE + 10, 'a');
+
+    uint32_t etags[3];
+    for (uint32_t i = 0; i < 3; i++)
+    {
+        // the third request finds the resource changed
+        if (i == 2)
+        {
+            ServedPayload.assign(COAP_MAX_BLOCK_SIZE + 10, 'b');
+        }
+
+        coap_packet_t get;
+        uint8_t buffer[COAP_MAX_PACKET_SIZE];
+        coap_init_message(&get, COAP_TYPE_CON, COAP_GET, 0x4000 + i);
+        coap_set_header_uri_path(&get, "3/0/1");
+        coap_set_header_block2(&get, i % 2, 0, COAP_MAX_BLOCK_SIZE);
+        size_t getLength = coap_serialize_message(&get, buffer);
+        ASSERT_EQ((ssize_t)getLength, sendto(peer_, buffer, getLength, 0, (const struct sockaddr *)&local, sizeof(local)));
+        Process();
+
+        Request response;
+        const uint8_t * etag = NULL;
+        ASSERT_TRUE(ReceiveRequest(&response));
+        ASSERT_EQ((int)sizeof(etags[i]), coap_get_header_etag(&response.Packet, &etag));
+        memcpy(&etags[i], etag, sizeof(etags[i]));
+    }
+
+    EXPECT_EQ(etags[0], etags[1]);
+    EXPECT_NE(etags[1], etags[2]);
+}
@@ -0,0 +1,139 @@
+/************************************************************************************************************************
+ Copyright (c) 2016, Imagination Technologies Limited and/or its affiliated group companies.
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+ following conditions are met:
+     1. Redistributions of source code must retain the above copyright notice, this list of conditions and the
+        following disclaimer.
+     2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the
+        following disclaimer in the documentation and/or other materials provided with the distribution.
+     3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote
+        products derived from this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+ USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+************************************************************************************************************************/
+
+#include <gtest/gtest.h>
+#include <string>
+#include <string.h>
+#include <unistd.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+#include "coap_abstraction.h"
+#include "lwm2m_debug.h"
+
+// Sends raw CoAP requests to the abstraction to check that a path registered with coap_RegisterUri reaches the
+// request handler. The messages are built by hand so that the suite runs unchanged against every CoAP backend.
+class CoapRegisteredUrisTestSuite : public testing::Test
+{
+protected:
+    void SetUp()
+    {
+        Lwm2m_SetLogLevel(DebugLevel_Warning);
+        requests_ = 0;
+        path_.clear();
+        coapInfo_ = coap_Init("127.0.0.1", 0, false, 0);
+        ASSERT_TRUE(NULL != coapInfo_);
+        coap_SetRequestHandler(HandleRequest);
+
+        socklen_t length = sizeof(server_);
+        ASSERT_EQ(0, getsockname(coapInfo_->fd, (struct sockaddr *)&server_, &length));
+
+        peer_ = socket(AF_INET, SOCK_DGRAM, 0);
+        ASSERT_LE(0, peer_);
+    }
+
+    void TearDown()
+    {
+        close(peer_);
+        coap_Destroy();
+    }
+
+    static int HandleRequest(CoapRequest * request, CoapResponse * response)
+    {
+        requests_++;
+        path_ = request->path;
+        response->responseContentLen = 0;
+        response->responseCode = 204;
+        return 0;
+    }
+
+    // Send a confirmable PUT to /rd/<location> and return the code of the response, or -1 if none arrives
+    int PutLocation(const char * location, uint16_t mid)
+    {
+        uint8_t message[32] = { 0x40, 0x03, (uint8_t)(mid >> 8), (uint8_t)mid, 0xb2, 'r', 'd' };
+        size_t length = 7;
+        message[length++] = (uint8_t)strlen(location);
+        memcpy(&message[length], location, strlen(location));
+        length += strlen(location);
+        EXPECT_EQ((ssize_t)length, sendto(peer_, message, length, 0, (const struct sockaddr *)&server_, sizeof(server_)));
+
+        struct pollfd fd = { coapInfo_->fd, POLLIN, 0 };
+        while (poll(&fd, 1, 100) == 1)
+        {
+            coap_HandleMessage();
+        }
+
+        uint8_t response[64];
+        struct pollfd peer = { peer_, POLLIN, 0 };
+        if ((poll(&peer, 1, 1000) != 1) || (recv(peer_, response, sizeof(response), 0) < 4))
+            return -1;
+        EXPECT_EQ(0x60, response[0] & 0xf0);
+        EXPECT_EQ(mid, (response[2] << 8) | response[3]);
+        return response[1];
+    }
+
+    static int requests_;
+    static std::string path_;
+    CoapInfo * coapInfo_;
+    struct sockaddr_in server_;
+    int peer_;
+};
+
+int CoapRegisteredUrisTestSuite::requests_;
+std::string CoapRegisteredUrisTestSuite::path_;
+
+TEST_F(CoapRegisteredUrisTestSuite, test_registered_location_reaches_handler)
+{
+    ASSERT_EQ(0, coap_RegisterUri("/rd"));
+    ASSERT_EQ(0, coap_RegisterUri("/rd/7"));
+
+    EXPECT_EQ(0x44, PutLocation("7", 0x1234));
+    EXPECT_EQ(1, requests_);
+    EXPECT_EQ("/rd/7", path_);
+}
+
+TEST_F(CoapRegisteredUrisTestSuite, test_wildcard_registration_reaches_locations)
+{
+    // the server registers only /rd and /rd/* at startup; client locations have no resource of their own
+    ASSERT_EQ(0, coap_RegisterUri("/rd"));
+    ASSERT_EQ(0, coap_RegisterUri("/rd/*"));
+
+    EXPECT_EQ(0x44, PutLocation("2", 0x2001));
+    EXPECT_EQ("/rd/2", path_);
+    EXPECT_EQ(0x44, PutLocation("1", 0x2002));
+    EXPECT_EQ("/rd/1", path_);
+    EXPECT_EQ(2, requests_);
+}
+
+TEST_F(CoapRegisteredUrisTestSuite, test_wildcard_registration_is_counted)
+{
+    ASSERT_EQ(0, coap_RegisterUri("/rd/*"));
+    ASSERT_EQ(0, coap_RegisterUri("/bs/*"));
+    ASSERT_EQ(0, coap_DeregisterUri("/bs/*"));
+
+    // one wildcard route remains, so locations under it are still reached
+    EXPECT_EQ(0x44, PutLocation("3", 0x3001));
+    EXPECT_EQ("/rd/3", path_);
+    EXPECT_EQ(1, requests_);
+}
@@ -0,0 +1,162 @@
+/************************************************************************************************************************
+ Copyright (c) 2016, Imagination Technologies Limited and/or its affiliated group companies.
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+ following conditions are met:
+     1. Redistributions of source code must retain the above copyright notice, this list of conditions and the
+        following disclaimer.
+     2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the
+        following disclaimer in the documentation and/or other materials provided with the distribution.
+     3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote
+        products derived from this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+ USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+************************************************************************************************************************/
+
+
+#include <gtest/gtest.h>
+#include <string.h>
+
+#include "network_abstraction.h"
+extern "C" {
+#include "erbium/er-coap-transactions.h"
+}
+
+// Nothing listens on this port, so confirmable messages sent to it are never acknowledged
+#define UNACKNOWLEDGED_URI "coap://127.0.0.1:5699"
+
+class CoapTransactionsTestSuite : public testing::Test
+{
+protected:
+    static void SetUpTestCase() { coap_init_transactions(); }
+    static void TearDownTestCase() { coap_destroy_transactions(); }
+
+    void SetUp()
+    {
+        socket_ = NetworkSocket_New(NULL, NetworkSocketType_UDP, 0);
+        ASSERT_TRUE(NULL != socket_);
+        ASSERT_TRUE(NetworkSocket_StartListening(socket_));
+        address_ = NetworkAddress_New(UNACKNOWLEDGED_URI, strlen(UNACKNOWLEDGED_URI));
+        ASSERT_TRUE(NULL != address_);
+    }
+
+    void TearDown()
+    {
+        NetworkAddress_Free(&address_);
+        NetworkSocket_Free(&socket_);
+    }
+
+    coap_transaction_t * NewTransaction(NetworkSocket * socket, coap_message_type_t type, uint16_t mid)
+    {
+        coap_packet_t message;
+        coap_transaction_t * transaction = coap_new_transaction(socket, mid, address_);
+        if (transaction != NULL)
+        {
+            coap_init_message(&message, type, COAP_GET, mid);
+            transaction->packet_len = coap_serialize_message(&message, transaction->packet);
+        }
+        return transaction;
+    }
+
+    NetworkSocket * socket_;
+    NetworkAddress * address_;
+};
+
+TEST_F(CoapTransactionsTestSuite, test_no_transactions_has_no_deadline)
+{
+    EXPECT_EQ(-1, coap_check_transactions());
+}
+
+TEST_F(CoapTransactionsTestSuite, test_non_confirmable_transaction_is_freed_once_sent)
+{
+    coap_transaction_t * transaction = NewTransaction(socket_, COAP_TYPE_NON, 1000);
+    ASSERT_TRUE(NULL != transaction);
+
+    coap_send_transaction(transaction);
+
+    EXPECT_TRUE(NULL == coap_get_transaction_by_mid(1000, address_));
+    EXPECT_EQ(-1, coap_check_transactions());
+}
+
+TEST_F(CoapTransactionsTestSuite, test_confirmable_transaction_waits_for_ack_timeout)
+{
+    coap_transaction_t * transaction = NewTransaction(socket_, COAP_TYPE_CON, 1001);
+    ASSERT_TRUE(NULL != transaction);
+
+    coap_send_transaction(transaction);
+    EXPECT_EQ(transaction, coap_get_transaction_by_mid(1001, address_));
+
+    // first retransmission is due between ACK_TIMEOUT and ACK_TIMEOUT * ACK_RANDOM_FACTOR
+    int timeout = coap_check_transactions();
+    EXPECT_GE(timeout, COAP_RESPONSE_TIMEOUT_MS - 100);
+    EXPECT_LE(timeout, COAP_RESPONSE_TIMEOUT_MS * COAP_RESPONSE_RANDOM_FACTOR);
+    EXPECT_EQ(0, transaction->retrans_counter);
+
+    coap_clear_transaction(&transaction);
+    EXPECT_TRUE(NULL == coap_get_transaction_by_mid(1001, address_));
+    EXPECT_EQ(-1, coap_check_transactions());
+}
+
+TEST_F(CoapTransactionsTestSuite, test_transaction_matched_by_mid_and_peer)
+{
+    coap_transaction_t * transaction = NewTransaction(socket_, COAP_TYPE_CON, 1003);
+    ASSERT_TRUE(NULL != transaction);
+    coap_send_transaction(transaction);
+
+    // the same message ID from another peer belongs to a different exchange
+    NetworkAddress * otherAddress = NetworkAddress_New("coap://127.0.0.1:5698", strlen("coap://127.0.0.1:5698"));
+    ASSERT_TRUE(NULL != otherAddress);
+    EXPECT_TRUE(NULL == coap_get_transaction_by_mid(1003, otherAddress));
+    EXPECT_EQ(transaction, coap_get_transaction_by_mid(1003, address_));
+    NetworkAddress_Free(&otherAddress);
+
+    coap_clear_transaction(&transaction);
+}
+
+TEST_F(CoapTransactionsTestSuite, test_failed_send_is_retried)
+{
+    // a transaction without a socket cannot be sent
+    coap_transaction_t * transaction = NewTransaction(NULL, COAP_TYPE_CON, 1002);
+    ASSERT_TRUE(NULL != transaction);
+
+    coap_send_transaction(transaction);
+    EXPECT_FALSE(transaction->sent);
+
+    int timeout = coap_check_transactions();
+    EXPECT_GE(timeout, 0);
+    EXPECT_LE(timeout, COAP_SEND_RETRY_INTERVAL_MS);
+
+    transaction->networkSocket = socket_;
+    timeout = coap_check_transactions();
+    EXPECT_TRUE(transaction->sent);
+    EXPECT_GT(timeout, COAP_SEND_RETRY_INTERVAL_MS);
+
+    coap_clear_transaction(&transaction);
+    EXPECT_EQ(-1, coap_check_transactions());
+}
+
+TEST_F(CoapTransactionsTestSuite, test_transactions_are_recycled_by_pool)
+{
+    MemoryPoolStats before, after;
+    coap_get_transaction_pool_stats(&before);
+
+    coap_transaction_t * first = NewTransaction(socket_, COAP_TYPE_CON, 1003);
+    ASSERT_TRUE(NULL != first);
+    coap_clear_transaction(&first);
+
+    coap_transaction_t * second = NewTransaction(socket_, COAP_TYPE_CON, 1004);
+    ASSERT_TRUE(NULL != second);
+    coap_clear_transaction(&second);
+
+    coap_get_transaction_pool_stats(&after);
+    EXPECT_EQ(before.Allocations + 2, after.Allocations);
+    EXPECT_GE(after.Reused, before.Reused + 1);
+    EXPECT_EQ(before.InUse, after.InUse);
+}
@@ -0,0 +1,215 @@
+/************************************************************************************************************************
+ Copyright (c) 2016, Imagination Technologies Limited and/or its affiliated group companies.
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+ following conditions are met:
+     1. Redistributions of source code must retain the above copyright notice, this list of conditions and the
+        following disclaimer.
+     2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the
+        following disclaimer in the documentation and/or other materials provided with the distribution.
+     3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote
+        products derived from this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+ USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+************************************************************************************************************************/
+
+#include <gtest/gtest.h>
+#include <poll.h>
+#include <pthread.h>
+#include <string.h>
+
+#include "dtls_handshake_pool.h"
+
+#define NUM_WORKERS (2)
+
+static pthread_mutex_t gate = PTHREAD_MUTEX_INITIALIZER;
+
+// Echo the record back twice and report its length, as a handshake step would answer a flight
+static void EchoWork(DTLS_HandshakeJob * job)
+{
+    pthread_mutex_lock(&gate);
+    pthread_mutex_unlock(&gate);
+    DTLS_HandshakeJob_AddOutput(job, job->Record, job->RecordLength);
+    DTLS_HandshakeJob_AddOutput(job, job->Record, job->RecordLength);
+    job->Result = job->RecordLength;
+}
+
+class DTLSHandshakePoolTestSuite : public testing::Test
+{
+protected:
+    void SetUp()
+    {
+        memset(&pool_, 0, sizeof(pool_));
+        ASSERT_EQ(0, DTLS_HandshakePool_Start(&pool_, NUM_WORKERS, EchoWork));
+    }
+
+    void TearDown()
+    {
+        DTLS_HandshakePool_Stop(&pool_);
+        DTLS_HandshakeJob * job;
+        while ((job = DTLS_HandshakePool_TakeCompleted(&pool_)) != NULL)
+        {
+            DTLS_HandshakeJob_Free(&job);
+        }
+    }
+
+    // Wait for the eventfd and take completed jobs until count have arrived
+    int TakeCompleted(int count, int * sessions)
+    {
+        int taken = 0;
+        while (taken < count)
+        {
+            struct pollfd fd = { DTLS_HandshakePool_GetEventFd(&pool_), POLLIN, 0 };
+            if (poll(&fd, 1, 5000) != 1)
+            {
+                break;
+            }
+            DTLS_HandshakeJob * job;
+            while ((job = DTLS_HandshakePool_TakeCompleted(&pool_)) != NULL)
+            {
+                EXPECT_TRUE(job->Run);
+                EXPECT_EQ(job->RecordLength, job->Result);
+                EXPECT_EQ(2, ListCount(&job->Output));
+                sessions[taken++] = *(int *)job->Session;
+                DTLS_HandshakeJob_Free(&job);
+            }
+        }
+        return taken;
+    }
+
+    DTLS_HandshakePool pool_;
+};
+
+TEST_F(DTLSHandshakePoolTestSuite, test_jobs_complete_through_eventfd)
+{
+    int ids[8];
+    int completed[8];
+    uint8_t record[] = { 0x16, 0xfe, 0xfd, 0x00 };
+    EXPECT_TRUE(DTLS_HandshakePool_IsRunning(&pool_));
+    EXPECT_GE(DTLS_HandshakePool_GetEventFd(&pool_), 0);
+    for (int i = 0; i < 8; i++)
+    {
+        ids[i] = i;
+        DTLS_HandshakeJob * job = DTLS_HandshakeJob_New(&ids[i], record, 1 + (i % sizeof(record)));
+        ASSERT_TRUE(NULL != job);
+        ASSERT_EQ(0, DTLS_HandshakePool_Submit(&pool_, job));
+    }
+    ASSERT_EQ(8, TakeCompleted(8, completed));
+
+    bool seen[8] = { false };
+    for (int i = 0; i < 8; i++)
+    {
+        seen[completed[i]] = true;
+    }
+    for (int i = 0; i < 8; i++)
+    {
+        EXPECT_TRUE(seen[i]);
+    }
+    EXPECT_TRUE(NULL == DTLS_HandshakePool_TakeCompleted(&pool_));
+}
+
+TEST_F(DTLSHandshakePoolTestSuite, test_output_keeps_data)
+{
+    int id = 1;
+    uint8_t record[] = "ClientHello";
+    DTLS_HandshakeJob * job = DTLS_HandshakeJob_New(&id, record, sizeof(record));
+    ASSERT_TRUE(NULL != job);
+    pthread_mutex_lock(&gate);
+    ASSERT_EQ(0, DTLS_HandshakePool_Submit(&pool_, job));
+    pthread_mutex_unlock(&gate);
+
+    struct pollfd fd = { DTLS_HandshakePool_GetEventFd(&pool_), POLLIN, 0 };
+    ASSERT_EQ(1, poll(&fd, 1, 5000));
+    job = DTLS_HandshakePool_TakeCompleted(&pool_);
+    ASSERT_TRUE(NULL != job);
+    struct ListHead * item;
+    ListForEach(item, &job->Output)
+    {
+        DTLS_HandshakeOutput * output = ListEntry(item, DTLS_HandshakeOutput, List);
+        ASSERT_EQ((int)sizeof(record), output->Length);
+        EXPECT_EQ(0, memcmp(record, output->Data, sizeof(record)));
+    }
+    DTLS_HandshakeJob_Free(&job);
+    EXPECT_TRUE(NULL == job);
+}
+
+TEST_F(DTLSHandshakePoolTestSuite, test_full_queue_refuses_jobs)
+{
+    int id = 0;
+    uint8_t record[] = { 0x16 };
+    int accepted = 0;
+    int refused = 0;
+
+    // hold the workers so nothing leaves the queue
+    pthread_mutex_lock(&gate);
+    for (int i = 0; i < DTLS_HANDSHAKE_QUEUE_LENGTH + NUM_WORKERS + 10; i++)
+    {
+        DTLS_HandshakeJob * job = DTLS_HandshakeJob_New(&id, record, sizeof(record));
+        ASSERT_TRUE(NULL != job);
+        if (DTLS_HandshakePool_Submit(&pool_, job) == 0)
+        {
+            accepted++;
+        }
+        else
+        {
+            refused++;
+            DTLS_HandshakeJob_Free(&job);
+        }
+    }
+    pthread_mutex_unlock(&gate);
+
+    // workers may have taken up to one job each before the queue filled
+    EXPECT_GE(accepted, DTLS_HANDSHAKE_QUEUE_LENGTH);
+    EXPECT_LE(accepted, DTLS_HANDSHAKE_QUEUE_LENGTH + NUM_WORKERS);
+    EXPECT_GE(refused, 10);
+
+    DTLS_HandshakePoolStats stats;
+    DTLS_HandshakePool_GetStats(&pool_, &stats);
+    EXPECT_EQ((size_t)accepted, stats.Submitted);
+    EXPECT_EQ((size_t)refused, stats.Dropped);
+    EXPECT_EQ((size_t)DTLS_HANDSHAKE_QUEUE_LENGTH, stats.PeakQueued);
+}
+
+TEST_F(DTLSHandshakePoolTestSuite, test_stop_returns_unrun_jobs)
+{
+    int id = 0;
+    uint8_t record[] = { 0x16 };
+    const int numJobs = 20;
+
+    pthread_mutex_lock(&gate);
+    for (int i = 0; i < numJobs; i++)
+    {
+        DTLS_HandshakeJob * job = DTLS_HandshakeJob_New(&id, record, sizeof(record));
+        ASSERT_TRUE(NULL != job);
+        ASSERT_EQ(0, DTLS_HandshakePool_Submit(&pool_, job));
+    }
+    pthread_mutex_unlock(&gate);
+    DTLS_HandshakePool_Stop(&pool_);
+    EXPECT_FALSE(DTLS_HandshakePool_IsRunning(&pool_));
+    EXPECT_EQ(-1, DTLS_HandshakePool_GetEventFd(&pool_));
+
+    int run = 0;
+    int unrun = 0;
+    DTLS_HandshakeJob * job;
+    while ((job = DTLS_HandshakePool_TakeCompleted(&pool_)) != NULL)
+    {
+        if (job->Run)
+            run++;
+        else
+            unrun++;
+        DTLS_HandshakeJob_Free(&job);
+    }
+    EXPECT_EQ(numJobs, run + unrun);
+
+    // a stopped pool refuses work
+    job = DTLS_HandshakeJob_New(&id, record, sizeof(record));
+    EXPECT_EQ(-1, DTLS_HandshakePool_Submit(&pool_, job));
+    DTLS_HandshakeJob_Free(&job);
+}
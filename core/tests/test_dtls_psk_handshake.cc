@@ -0,0 +1,153 @@
+/************************************************************************************************************************
+ Copyright (c) 2016, Imagination Technologies Limited and/or its affiliated group companies.
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+ following conditions are met:
+     1. Redistributions of source code must retain the above copyright notice, this list of conditions and the
+        following disclaimer.
+     2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the
+        following disclaimer in the documentation and/or other materials provided with the distribution.
+     3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote
+        products derived from this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+ USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+************************************************************************************************************************/
+
+#include <gtest/gtest.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+
+#include "dtls_abstraction.h"
+#include "network_abstraction.h"
+#include "lwm2m_debug.h"
+
+// Runs PSK handshakes between a client and a server socket in this process, through whichever DTLS backend is
+// built, to check which identities the server accepts.
+class DTLSPSKHandshakeTestSuite : public testing::Test
+{
+protected:
+    void SetUp()
+    {
+        Lwm2m_SetLogLevel(DebugLevel_Emerg);
+        DTLS_Init();
+        keystore_ = NULL;
+        strcpy(path_, "/tmp/test_psk_handshake_XXXXXX");
+        int fd = mkstemp(path_);
+        ASSERT_GE(fd, 0);
+        close(fd);
+
+        server_ = NetworkSocket_New("127.0.0.1", (NetworkSocketType)(NetworkSocketType_UDP | NetworkSocketType_Secure), 0);
+        ASSERT_TRUE(NULL != server_);
+        ASSERT_TRUE(NetworkSocket_StartListening(server_));
+        client_ = NetworkSocket_New("127.0.0.1", (NetworkSocketType)(NetworkSocketType_UDP | NetworkSocketType_Secure), 0);
+        ASSERT_TRUE(NULL != client_);
+        ASSERT_TRUE(NetworkSocket_StartListening(client_));
+
+        struct sockaddr_in address;
+        socklen_t length = sizeof(address);
+        ASSERT_EQ(0, getsockname(NetworkSocket_GetFileDescriptor(server_), (struct sockaddr *)&address, &length));
+        char uri[64];
+        snprintf(uri, sizeof(uri), "coaps://127.0.0.1:%d", ntohs(address.sin_port));
+        serverAddress_ = NetworkAddress_New(uri, strlen(uri));
+        ASSERT_TRUE(NULL != serverAddress_);
+    }
+
+    void TearDown()
+    {
+        DTLS_SetPSKKeystore(NULL);
+        DTLS_PSKKeystore_Free(&keystore_);
+        unlink(path_);
+        NetworkAddress_Free(&serverAddress_);
+        NetworkSocket_Free(&client_);
+        NetworkSocket_Free(&server_);
+        DTLS_Shutdown();
+    }
+
+    void LoadKeystore(const char * contents)
+    {
+        FILE * file = fopen(path_, "w");
+        ASSERT_TRUE(NULL != file);
+        fputs(contents, file);
+        fclose(file);
+        keystore_ = DTLS_PSKKeystore_Load(path_);
+        ASSERT_TRUE(NULL != keystore_);
+        DTLS_SetPSKKeystore(keystore_);
+    }
+
+    // Let both sides run the handshake; true once application data from the client reaches the server
+    bool Connect()
+    {
+        uint8_t message[] = "hello";
+        for (int attempt = 0; attempt < 20; attempt++)
+        {
+            NetworkSocket_Send(client_, serverAddress_, message, sizeof(message));
+
+            bool progressed = true;
+            while (progressed)
+            {
+                progressed = false;
+                NetworkSocket * sockets[] = { server_, client_ };
+                for (size_t i = 0; i < sizeof(sockets) / sizeof(sockets[0]); i++)
+                {
+                    struct pollfd fd = { NetworkSocket_GetFileDescriptor(sockets[i]), POLLIN, 0 };
+                    if (NetworkSocket_HasPendingReads(sockets[i]) || (poll(&fd, 1, 50) == 1))
+                    {
+                        uint8_t buffer[1024];
+                        NetworkAddress * sourceAddress = NULL;
+                        int readLength = 0;
+                        NetworkSocket_Read(sockets[i], buffer, sizeof(buffer), &sourceAddress, &readLength);
+                        progressed = true;
+                        if ((sockets[i] == server_) && (readLength == sizeof(message)) && (memcmp(buffer, message, sizeof(message)) == 0))
+                            return true;
+                    }
+                }
+            }
+        }
+        return false;
+    }
+
+    static const char * defaultIdentity_;
+    static const uint8_t defaultKey_[4];
+
+    char path_[64];
+    DTLS_PSKKeystore * keystore_;
+    NetworkSocket * server_;
+    NetworkSocket * client_;
+    NetworkAddress * serverAddress_;
+};
+
+const char * DTLSPSKHandshakeTestSuite::defaultIdentity_ = "oFIrQFrW8EWcZ5u7eGfrkw";
+const uint8_t DTLSPSKHandshakeTestSuite::defaultKey_[4] = { 0x7c, 0xcd, 0xe1, 0x4a };
+
+TEST_F(DTLSPSKHandshakeTestSuite, test_configured_identity_accepted_without_keystore)
+{
+    NetworkSocket_SetPSK(client_, defaultIdentity_, defaultKey_, sizeof(defaultKey_));
+    EXPECT_TRUE(Connect());
+}
+
+TEST_F(DTLSPSKHandshakeTestSuite, test_keystore_identity_accepted)
+{
+    NetworkSocket_SetPSK(client_, "device-1", defaultKey_, sizeof(defaultKey_));
+    LoadKeystore("device-1:7ccde14a\n");
+    EXPECT_TRUE(Connect());
+}
+
+TEST_F(DTLSPSKHandshakeTestSuite, test_configured_identity_rejected_once_keystore_loaded)
+{
+    // the configured identity is the well-known default; a server with per-device keys must not accept it
+    NetworkSocket_SetPSK(client_, defaultIdentity_, defaultKey_, sizeof(defaultKey_));
+    LoadKeystore("device-1:0102030405\n");
+    EXPECT_FALSE(Connect());
+}
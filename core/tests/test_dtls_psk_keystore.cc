@@ -0,0 +1,173 @@
+/************************************************************************************************************************
+ Copyright (c) 2016, Imagination Technologies Limited and/or its affiliated group companies.
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+ following conditions are met:
+     1. Redistributions of source code must retain the above copyright notice, this list of conditions and the
+        following disclaimer.
+     2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the
+        following disclaimer in the documentation and/or other materials provided with the distribution.
+     3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote
+        products derived from this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+ USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+************************************************************************************************************************/
+
+#include <gtest/gtest.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "dtls_psk_keystore.h"
+
+class DTLSPSKKeystoreTestSuite : public testing::Test
+{
+protected:
+    void SetUp()
+    {
+        strcpy(path_, "/tmp/test_psk_keystore_XXXXXX");
+        int fd = mkstemp(path_);
+        ASSERT_GE(fd, 0);
+        close(fd);
+        keystore_ = NULL;
+    }
+
+    void TearDown()
+    {
+        DTLS_PSKKeystore_Free(&keystore_);
+        unlink(path_);
+    }
+
+    void Load(const char * contents)
+    {
+        FILE * file = fopen(path_, "w");
+        ASSERT_TRUE(NULL != file);
+        fputs(contents, file);
+        fclose(file);
+        keystore_ = DTLS_PSKKeystore_Load(path_);
+        ASSERT_TRUE(NULL != keystore_);
+    }
+
+    const uint8_t * Find(const char * identity, size_t * keyLength)
+    {
+        return DTLS_PSKKeystore_Find(keystore_, identity, strlen(identity), keyLength);
+    }
+
+    char path_[64];
+    DTLS_PSKKeystore * keystore_;
+};
+
+TEST_F(DTLSPSKKeystoreTestSuite, test_find_identities)
+{
+    Load("# devices\n"
+         "device-1:0102030405\n"
+         "\n"
+         "device-2:a0B1c2D3\r\n"
+         "device-3:ff");
+    EXPECT_EQ(3u, DTLS_PSKKeystore_GetCount(keystore_));
+
+    size_t keyLength = 0;
+    const uint8_t * key = Find("device-1", &keyLength);
+    ASSERT_TRUE(NULL != key);
+    const uint8_t expected1[] = { 0x01, 0x02, 0x03, 0x04, 0x05 };
+    ASSERT_EQ(sizeof(expected1), keyLength);
+    EXPECT_EQ(0, memcmp(expected1, key, keyLength));
+
+    key = Find("device-2", &keyLength);
+    ASSERT_TRUE(NULL != key);
+    const uint8_t expected2[] = { 0xa0, 0xb1, 0xc2, 0xd3 };
+    ASSERT_EQ(sizeof(expected2), keyLength);
+    EXPECT_EQ(0, memcmp(expected2, key, keyLength));
+
+    key = Find("device-3", &keyLength);
+    ASSERT_TRUE(NULL != key);
+    ASSERT_EQ(1u, keyLength);
+    EXPECT_EQ(0xff, key[0]);
+
+    EXPECT_TRUE(NULL == Find("device-4", &keyLength));
+    EXPECT_TRUE(NULL == Find("device", &keyLength));
+    EXPECT_TRUE(NULL == Find("# devices", &keyLength));
+}
+
+TEST_F(DTLSPSKKeystoreTestSuite, test_invalid_lines_are_skipped)
+{
+    Load("no-separator\n"
+         ":0102\n"
+         "empty-key:\n"
+         "odd-length:123\n"
+         "not-hex:01zz\n"
+         "good:0102\n");
+    EXPECT_EQ(1u, DTLS_PSKKeystore_GetCount(keystore_));
+
+    size_t keyLength = 0;
+    EXPECT_TRUE(NULL != Find("good", &keyLength));
+    EXPECT_TRUE(NULL == Find("empty-key", &keyLength));
+    EXPECT_TRUE(NULL == Find("odd-length", &keyLength));
+    EXPECT_TRUE(NULL == Find("not-hex", &keyLength));
+}
+
+TEST_F(DTLSPSKKeystoreTestSuite, test_first_duplicate_wins)
+{
+    Load("device:0101\n"
+         "device:0202\n");
+    EXPECT_EQ(1u, DTLS_PSKKeystore_GetCount(keystore_));
+
+    size_t keyLength = 0;
+    const uint8_t * key = Find("device", &keyLength);
+    ASSERT_TRUE(NULL != key);
+    ASSERT_EQ(2u, keyLength);
+    EXPECT_EQ(0x01, key[0]);
+}
+
+TEST_F(DTLSPSKKeystoreTestSuite, test_identity_containing_separator)
+{
+    Load("urn:imei:123456:0a0b\n");
+
+    size_t keyLength = 0;
+    const uint8_t * key = Find("urn:imei:123456", &keyLength);
+    ASSERT_TRUE(NULL != key);
+    ASSERT_EQ(2u, keyLength);
+    EXPECT_EQ(0x0a, key[0]);
+    EXPECT_EQ(0x0b, key[1]);
+}
+
+TEST_F(DTLSPSKKeystoreTestSuite, test_file_rewritten_in_place_after_load)
+{
+    Load("device-1:0102\n"
+         "device-2:0304\n");
+
+    // truncating and rewriting the file must not affect the loaded keystore
+    FILE * file = fopen(path_, "w");
+    ASSERT_TRUE(NULL != file);
+    fputs("x", file);
+    fclose(file);
+
+    size_t keyLength = 0;
+    const uint8_t * key = Find("device-2", &keyLength);
+    ASSERT_TRUE(NULL != key);
+    ASSERT_EQ(2u, keyLength);
+    EXPECT_EQ(0x03, key[0]);
+    EXPECT_TRUE(NULL != Find("device-1", &keyLength));
+    EXPECT_TRUE(NULL == Find("x", &keyLength));
+}
+
+TEST_F(DTLSPSKKeystoreTestSuite, test_empty_file)
+{
+    Load("");
+    EXPECT_EQ(0u, DTLS_PSKKeystore_GetCount(keystore_));
+    size_t keyLength = 0;
+    EXPECT_TRUE(NULL == Find("device", &keyLength));
+}
+
+TEST_F(DTLSPSKKeystoreTestSuite, test_missing_file)
+{
+    EXPECT_TRUE(NULL == DTLS_PSKKeystore_Load("/nonexistent/psk_keys"));
+}
@@ -0,0 +1,254 @@
+/************************************************************************************************************************
+ Copyright (c) 2016, Imagination Technologies Limited and/or its affiliated group companies.
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+ following conditions are met:
+     1. Redistributions of source code must retain the above copyright notice, this list of conditions and the
+        following disclaimer.
+     2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the
+        following disclaimer in the documentation and/or other materials provided with the distribution.
+     3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote
+        products derived from this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+ USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+************************************************************************************************************************/
+
+#include <gtest/gtest.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "dtls_session_table.h"
+
+#define NUM_ADDRESSES   (4)
+#define CAPACITY        (3)
+#define IDLE_TIMEOUT_MS (1000)
+
+typedef struct
+{
+    DTLS_SessionTableEntry Entry;
+    int Id;
+} TestSession;
+
+static int releasedIds[NUM_ADDRESSES];
+static int releasedCount;
+
+static void ReleaseTestSession(DTLS_SessionTableEntry * entry)
+{
+    TestSession * session = DTLS_SessionEntry(entry, TestSession, Entry);
+    releasedIds[releasedCount++] = session->Id;
+}
+
+class DTLSSessionTableTestSuite : public testing::Test
+{
+protected:
+    void SetUp()
+    {
+        releasedCount = 0;
+        DTLS_SessionTable_Init(&table_, CAPACITY, IDLE_TIMEOUT_MS, ReleaseTestSession);
+        for (int i = 0; i < NUM_ADDRESSES; i++)
+        {
+            char uri[64];
+            sprintf(uri, "coaps://127.0.0.1:%d", 22000 + i);
+            addresses_[i] = NetworkAddress_New(uri, strlen(uri));
+            ASSERT_TRUE(NULL != addresses_[i]);
+            memset(&sessions_[i], 0, sizeof(sessions_[i]));
+            sessions_[i].Id = i;
+        }
+    }
+
+    void TearDown()
+    {
+        DTLS_SessionTable_Destroy(&table_);
+        for (int i = 0; i < NUM_ADDRESSES; i++)
+        {
+            NetworkAddress_Free(&addresses_[i]);
+        }
+    }
+
+    DTLS_SessionTable table_;
+    NetworkAddress * addresses_[NUM_ADDRESSES];
+    TestSession sessions_[NUM_ADDRESSES];
+};
+
+TEST_F(DTLSSessionTableTestSuite, test_find_by_address)
+{
+    ASSERT_EQ(0, DTLS_SessionTable_Add(&table_, &sessions_[0].Entry, addresses_[0], 0));
+    ASSERT_EQ(0, DTLS_SessionTable_Add(&table_, &sessions_[1].Entry, addresses_[1], 0));
+    EXPECT_EQ(2u, DTLS_SessionTable_GetCount(&table_));
+
+    EXPECT_EQ(&sessions_[1].Entry, DTLS_SessionTable_Find(&table_, addresses_[1], 10));
+    EXPECT_EQ(&sessions_[0].Entry, DTLS_SessionTable_Find(&table_, addresses_[0], 10));
+    EXPECT_TRUE(NULL == DTLS_SessionTable_Find(&table_, addresses_[2], 10));
+
+    DTLS_SessionTable_Remove(&table_, &sessions_[0].Entry);
+    EXPECT_TRUE(NULL == DTLS_SessionTable_Find(&table_, addresses_[0], 10));
+    EXPECT_EQ(1u, DTLS_SessionTable_GetCount(&table_));
+    EXPECT_EQ(0, releasedCount);
+}
+
+TEST_F(DTLSSessionTableTestSuite, test_full_table_evicts_least_recently_used)
+{
+    for (int i = 0; i < CAPACITY; i++)
+    {
+        ASSERT_EQ(0, DTLS_SessionTable_Add(&table_, &sessions_[i].Entry, addresses_[i], i));
+    }
+
+    // touch the oldest so the second session becomes least recently used
+    ASSERT_TRUE(NULL != DTLS_SessionTable_Find(&table_, addresses_[0], 10));
+
+    ASSERT_EQ(0, DTLS_SessionTable_Add(&table_, &sessions_[3].Entry, addresses_[3], 11));
+    ASSERT_EQ(1, releasedCount);
+    EXPECT_EQ(1, releasedIds[0]);
+    EXPECT_EQ((size_t)CAPACITY, DTLS_SessionTable_GetCount(&table_));
+    EXPECT_TRUE(NULL == DTLS_SessionTable_Find(&table_, addresses_[1], 12));
+    EXPECT_TRUE(NULL != DTLS_SessionTable_Find(&table_, addresses_[3], 12));
+
+    DTLS_SessionStats stats;
+    DTLS_SessionTable_GetStats(&table_, &stats);
+    EXPECT_EQ(3ul, stats.Live);
+    EXPECT_EQ(3ul, stats.Peak);
+    EXPECT_EQ(4ul, stats.Handshakes);
+    EXPECT_EQ(1ul, stats.Evictions);
+    EXPECT_EQ(0ul, stats.IdleExpiries);
+}
+
+TEST_F(DTLSSessionTableTestSuite, test_idle_sessions_expire)
+{
+    ASSERT_EQ(0, DTLS_SessionTable_Add(&table_, &sessions_[0].Entry, addresses_[0], 0));
+    ASSERT_EQ(0, DTLS_SessionTable_Add(&table_, &sessions_[1].Entry, addresses_[1], 500));
+
+    DTLS_SessionTable_Expire(&table_, IDLE_TIMEOUT_MS - 1);
+    EXPECT_EQ(0, releasedCount);
+
+    DTLS_SessionTable_Expire(&table_, IDLE_TIMEOUT_MS);
+    ASSERT_EQ(1, releasedCount);
+    EXPECT_EQ(0, releasedIds[0]);
+
+    // use keeps a session alive
+    ASSERT_TRUE(NULL != DTLS_SessionTable_Find(&table_, addresses_[1], 1400));
+    DTLS_SessionTable_Expire(&table_, 2000);
+    EXPECT_EQ(1, releasedCount);
+    DTLS_SessionTable_Expire(&table_, 2400);
+    EXPECT_EQ(2, releasedCount);
+    EXPECT_EQ(0u, DTLS_SessionTable_GetCount(&table_));
+
+    DTLS_SessionStats stats;
+    DTLS_SessionTable_GetStats(&table_, &stats);
+    EXPECT_EQ(0ul, stats.Live);
+    EXPECT_EQ(2ul, stats.IdleExpiries);
+}
+
+TEST_F(DTLSSessionTableTestSuite, test_reducing_capacity_evicts)
+{
+    for (int i = 0; i < CAPACITY; i++)
+    {
+        ASSERT_EQ(0, DTLS_SessionTable_Add(&table_, &sessions_[i].Entry, addresses_[i], i));
+    }
+    DTLS_SessionTable_SetLimits(&table_, 1, 0);
+    EXPECT_EQ(1u, DTLS_SessionTable_GetCount(&table_));
+    ASSERT_EQ(2, releasedCount);
+    EXPECT_EQ(0, releasedIds[0]);
+    EXPECT_EQ(1, releasedIds[1]);
+
+    // no idle timeout
+    DTLS_SessionTable_Expire(&table_, 1000000);
+    EXPECT_EQ(1u, DTLS_SessionTable_GetCount(&table_));
+}
+
+TEST_F(DTLSSessionTableTestSuite, test_destroy_releases_all)
+{
+    for (int i = 0; i < CAPACITY; i++)
+    {
+        ASSERT_EQ(0, DTLS_SessionTable_Add(&table_, &sessions_[i].Entry, addresses_[i], i));
+    }
+    DTLS_SessionTable_Destroy(&table_);
+    EXPECT_EQ(CAPACITY, releasedCount);
+    EXPECT_EQ(0u, DTLS_SessionTable_GetCount(&table_));
+}
+
+TEST_F(DTLSSessionTableTestSuite, test_find_by_connection_id)
+{
+    const uint8_t cid0[] = { 1, 2, 3, 4 };
+    const uint8_t cid1[] = { 5, 6, 7, 8 };
+    ASSERT_EQ(0, DTLS_SessionTable_Add(&table_, &sessions_[0].Entry, addresses_[0], 0));
+    ASSERT_EQ(0, DTLS_SessionTable_Add(&table_, &sessions_[1].Entry, addresses_[1], 0));
+    ASSERT_EQ(0, DTLS_SessionTable_SetConnectionId(&table_, &sessions_[0].Entry, cid0, sizeof(cid0)));
+    ASSERT_EQ(0, DTLS_SessionTable_SetConnectionId(&table_, &sessions_[1].Entry, cid1, sizeof(cid1)));
+
+    EXPECT_EQ(&sessions_[0].Entry, DTLS_SessionTable_FindByConnectionId(&table_, cid0, sizeof(cid0), 10));
+    EXPECT_EQ(&sessions_[1].Entry, DTLS_SessionTable_FindByConnectionId(&table_, cid1, sizeof(cid1), 10));
+    EXPECT_TRUE(NULL == DTLS_SessionTable_FindByConnectionId(&table_, cid0, 3, 10));
+
+    uint8_t tooLong[DTLS_MAX_CONNECTION_ID_LENGTH + 1] = { 0 };
+    EXPECT_EQ(-1, DTLS_SessionTable_SetConnectionId(&table_, &sessions_[0].Entry, tooLong, sizeof(tooLong)));
+
+    // removing a session drops its connection ID
+    DTLS_SessionTable_Remove(&table_, &sessions_[1].Entry);
+    EXPECT_TRUE(NULL == DTLS_SessionTable_FindByConnectionId(&table_, cid1, sizeof(cid1), 10));
+}
+
+TEST_F(DTLSSessionTableTestSuite, test_rebind_moves_session_to_new_address)
+{
+    ASSERT_EQ(0, DTLS_SessionTable_Add(&table_, &sessions_[0].Entry, addresses_[0], 0));
+    ASSERT_EQ(0, DTLS_SessionTable_Add(&table_, &sessions_[1].Entry, addresses_[1], 0));
+
+    // a session already held for the new address is replaced
+    DTLS_SessionTable_Rebind(&table_, &sessions_[0].Entry, addresses_[1]);
+    ASSERT_EQ(1, releasedCount);
+    EXPECT_EQ(1, releasedIds[0]);
+    EXPECT_TRUE(NULL == DTLS_SessionTable_Find(&table_, addresses_[0], 10));
+    EXPECT_EQ(&sessions_[0].Entry, DTLS_SessionTable_Find(&table_, addresses_[1], 10));
+
+    DTLS_SessionTable_Rebind(&table_, &sessions_[0].Entry, addresses_[2]);
+    EXPECT_EQ(&sessions_[0].Entry, DTLS_SessionTable_Find(&table_, addresses_[2], 10));
+    EXPECT_EQ(1u, DTLS_SessionTable_GetCount(&table_));
+
+    DTLS_SessionStats stats;
+    DTLS_SessionTable_GetStats(&table_, &stats);
+    EXPECT_EQ(2ul, stats.Rebinds);
+    EXPECT_EQ(1ul, stats.Live);
+}
+
+TEST_F(DTLSSessionTableTestSuite, test_parse_connection_id)
+{
+    // content type, version, epoch, sequence number, then the connection ID
+    const uint8_t cidRecord[] = { 25, 0xfe, 0xfd, 0, 1, 0, 0, 0, 0, 0, 7, 0xa, 0xb, 0xc, 0xd, 0, 16 };
+    const uint8_t plainRecord[] = { 23, 0xfe, 0xfd, 0, 1, 0, 0, 0, 0, 0, 7, 0, 16 };
+    const uint8_t * connectionId = NULL;
+
+    ASSERT_EQ(0, DTLS_SessionTable_ParseConnectionId(cidRecord, sizeof(cidRecord), 4, &connectionId));
+    EXPECT_EQ(&cidRecord[11], connectionId);
+    EXPECT_EQ(-1, DTLS_SessionTable_ParseConnectionId(cidRecord, 14, 4, &connectionId));
+    EXPECT_EQ(-1, DTLS_SessionTable_ParseConnectionId(cidRecord, sizeof(cidRecord), 0, &connectionId));
+    EXPECT_EQ(-1, DTLS_SessionTable_ParseConnectionId(plainRecord, sizeof(plainRecord), 2, &connectionId));
+}
+
+TEST_F(DTLSSessionTableTestSuite, test_resumption_data_is_taken_once)
+{
+    const char first[] = "first session";
+    const char second[] = "second session";
+    size_t length = 0;
+
+    EXPECT_TRUE(NULL == DTLS_SessionTable_TakeResumption(&table_, addresses_[0], &length));
+
+    ASSERT_EQ(0, DTLS_SessionTable_SaveResumption(&table_, addresses_[0], first, sizeof(first)));
+    ASSERT_EQ(0, DTLS_SessionTable_SaveResumption(&table_, addresses_[0], second, sizeof(second)));
+    ASSERT_EQ(0, DTLS_SessionTable_SaveResumption(&table_, addresses_[1], first, sizeof(first)));
+
+    char * data = (char *)DTLS_SessionTable_TakeResumption(&table_, addresses_[0], &length);
+    ASSERT_TRUE(NULL != data);
+    EXPECT_EQ(sizeof(second), length);
+    EXPECT_STREQ(second, data);
+    free(data);
+    EXPECT_TRUE(NULL == DTLS_SessionTable_TakeResumption(&table_, addresses_[0], &length));
+
+    // left for the table to release
+    EXPECT_TRUE(NULL == DTLS_SessionTable_TakeResumption(&table_, addresses_[2], &length));
+}
@@ -0,0 +1,98 @@
+/************************************************************************************************************************
+ Copyright (c) 2016, Imagination Technologies Limited and/or its affiliated group companies.
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+ following conditions are met:
+     1. Redistributions of source code must retain the above copyright notice, this list of conditions and the
+        following disclaimer.
+     2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the
+        following disclaimer in the documentation and/or other materials provided with the distribution.
+     3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote
+        products derived from this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, 
+ SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, 
+ WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE 
+ USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+************************************************************************************************************************/
+
+#include <gtest/gtest.h>
+
+#include "lwm2m_endpoints.h"
+
+static int DummyHandler(int type, void * ctxt, AddressType * addr, const char * path, const char * query, const char * token,
+                        int tokenLength, AwaContentType contentType, const char * requestContent, size_t requestContentLen,
+                        AwaContentType * responseContentType, char * responseContent, size_t * responseContentLen, int * responseCode)
+{
+    return 0;
+}
+
+class EndPointsTestSuite : public testing::Test
+{
+protected:
+    void SetUp() { Lwm2mEndPoint_InitEndPointList(&endPointList_); }
+    void TearDown() { Lwm2mEndPoint_DestroyEndPointList(&endPointList_); }
+
+    ResourceEndPointList endPointList_;
+};
+
+TEST_F(EndPointsTestSuite, test_find_exact_endpoint)
+{
+    ASSERT_EQ(0, Lwm2mEndPoint_AddResourceEndPoint(&endPointList_, "/rd", DummyHandler));
+    ResourceEndPoint * endPoint = Lwm2mEndPoint_FindResourceEndPoint(&endPointList_, "/rd");
+    ASSERT_TRUE(NULL != endPoint);
+    EXPECT_STREQ("/rd", endPoint->Path);
+    EXPECT_TRUE(NULL == Lwm2mEndPoint_FindResourceEndPoint(&endPointList_, "/rd/1"));
+    EXPECT_TRUE(NULL == Lwm2mEndPoint_FindResourceEndPoint(&endPointList_, "/r"));
+}
+
+TEST_F(EndPointsTestSuite, test_wildcard_matches_single_segment)
+{
+    ASSERT_EQ(0, Lwm2mEndPoint_AddResourceEndPoint(&endPointList_, "/rd", DummyHandler));
+    ASSERT_EQ(0, Lwm2mEndPoint_AddResourceEndPoint(&endPointList_, "/rd/" ENDPOINT_WILDCARD, DummyHandler));
+    EXPECT_TRUE(Lwm2mEndPoint_IsWildcardPath("/rd/" ENDPOINT_WILDCARD));
+    EXPECT_FALSE(Lwm2mEndPoint_IsWildcardPath("/rd"));
+
+    ResourceEndPoint * endPoint = Lwm2mEndPoint_FindResourceEndPoint(&endPointList_, "/rd/42");
+    ASSERT_TRUE(NULL != endPoint);
+    EXPECT_STREQ("/rd/" ENDPOINT_WILDCARD, endPoint->Path);
+
+    EXPECT_STREQ("/rd", Lwm2mEndPoint_FindResourceEndPoint(&endPointList_, "/rd")->Path);
+    EXPECT_TRUE(NULL == Lwm2mEndPoint_FindResourceEndPoint(&endPointList_, "/rd/"));
+    EXPECT_TRUE(NULL == Lwm2mEndPoint_FindResourceEndPoint(&endPointList_, "/rd/1/2"));
+    EXPECT_TRUE(NULL == Lwm2mEndPoint_FindResourceEndPoint(&endPointList_, "/bs/1"));
+}
+
+TEST_F(EndPointsTestSuite, test_exact_endpoint_takes_precedence_over_wildcard)
+{
+    ASSERT_EQ(0, Lwm2mEndPoint_AddResourceEndPoint(&endPointList_, "/rd/" ENDPOINT_WILDCARD, DummyHandler));
+    ASSERT_EQ(0, Lwm2mEndPoint_AddResourceEndPoint(&endPointList_, "/rd/1", DummyHandler));
+    EXPECT_STREQ("/rd/1", Lwm2mEndPoint_FindResourceEndPoint(&endPointList_, "/rd/1")->Path);
+    EXPECT_STREQ("/rd/" ENDPOINT_WILDCARD, Lwm2mEndPoint_FindResourceEndPoint(&endPointList_, "/rd/2")->Path);
+}
+
+TEST_F(EndPointsTestSuite, test_find_ancestors)
+{
+    ASSERT_EQ(0, Lwm2mEndPoint_AddResourceEndPoint(&endPointList_, "/3", DummyHandler));
+    ASSERT_EQ(0, Lwm2mEndPoint_AddResourceEndPoint(&endPointList_, "/3/0", DummyHandler));
+    EXPECT_STREQ("/3/0", Lwm2mEndPoint_FindResourceEndPointAncestors(&endPointList_, "/3/0/1")->Path);
+    EXPECT_STREQ("/3", Lwm2mEndPoint_FindResourceEndPointAncestors(&endPointList_, "/3/1/1")->Path);
+    EXPECT_TRUE(NULL == Lwm2mEndPoint_FindResourceEndPointAncestors(&endPointList_, "/4/0/1"));
+    EXPECT_TRUE(NULL == Lwm2mEndPoint_FindResourceEndPointAncestors(&endPointList_, ""));
+}
+
+TEST_F(EndPointsTestSuite, test_add_existing_and_remove)
+{
+    ASSERT_EQ(0, Lwm2mEndPoint_AddResourceEndPoint(&endPointList_, "/rd/" ENDPOINT_WILDCARD, DummyHandler));
+    ASSERT_EQ(0, Lwm2mEndPoint_AddResourceEndPoint(&endPointList_, "/rd/" ENDPOINT_WILDCARD, DummyHandler));
+    EXPECT_EQ(1, ListCount(&endPointList_.EndPoint));
+
+    EXPECT_EQ(-1, Lwm2mEndPoint_RemoveResourceEndPoint(&endPointList_, "/rd/1"));
+    EXPECT_EQ(0, Lwm2mEndPoint_RemoveResourceEndPoint(&endPointList_, "/rd/" ENDPOINT_WILDCARD));
+    EXPECT_TRUE(NULL == Lwm2mEndPoint_FindResourceEndPoint(&endPointList_, "/rd/1"));
+    EXPECT_EQ(0, ListCount(&endPointList_.EndPoint));
+}
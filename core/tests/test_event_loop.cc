@@ -0,0 +1,220 @@
+/************************************************************************************************************************
+ Copyright (c) 2016, Imagination Technologies Limited and/or its affiliated group companies.
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+ following conditions are met:
+     1. Redistributions of source code must retain the above copyright notice, this list of conditions and the
+        following disclaimer.
+     2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the
+        following disclaimer in the documentation and/or other materials provided with the distribution.
+     3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote
+        products derived from this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+ USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+************************************************************************************************************************/
+
+#include <gtest/gtest.h>
+#include <unistd.h>
+#include <string.h>
+
+#include "lwm2m_event_loop.h"
+#include "lwm2m_util.h"
+
+class EventLoopTestSuite : public testing::Test
+{
+protected:
+    void SetUp()
+    {
+        loop_ = EventLoop_New();
+        ASSERT_TRUE(NULL != loop_);
+        ASSERT_EQ(0, pipe(pipe_));
+        ASSERT_EQ(0, pipe(otherPipe_));
+    }
+
+    void TearDown()
+    {
+        EventLoop_Free(&loop_);
+        EXPECT_TRUE(NULL == loop_);
+        close(pipe_[0]);
+        close(pipe_[1]);
+        close(otherPipe_[0]);
+        close(otherPipe_[1]);
+    }
+
+    EventLoop * loop_;
+    int pipe_[2];
+    int otherPipe_[2];
+};
+
+typedef struct
+{
+    int Calls;
+    int Order;
+    EventLoopTimer * Restart;
+    int RemoveFd;
+} Record;
+
+static int callOrder;
+
+static void ReadByte(EventLoop * loop, int fd, void * context)
+{
+    Record * record = (Record *)context;
+    char byte;
+    EXPECT_EQ(1, read(fd, &byte, 1));
+    record->Calls++;
+    record->Order = ++callOrder;
+    if (record->RemoveFd >= 0)
+    {
+        EXPECT_EQ(0, EventLoop_RemoveFd(loop, record->RemoveFd));
+    }
+}
+
+static void CountTimer(EventLoop * loop, void * context)
+{
+    Record * record = (Record *)context;
+    record->Calls++;
+    record->Order = ++callOrder;
+    if (record->Restart != NULL)
+    {
+        EXPECT_EQ(0, EventLoop_StartTimer(loop, record->Restart, 0));
+    }
+}
+
+TEST_F(EventLoopTestSuite, test_readable_fd_calls_back_until_removed)
+{
+    Record record = { 0, 0, NULL, -1 };
+    ASSERT_EQ(0, EventLoop_AddFd(loop_, pipe_[0], ReadByte, &record));
+    EXPECT_EQ(-1, EventLoop_AddFd(loop_, pipe_[0], ReadByte, &record));
+
+    EXPECT_EQ(0, EventLoop_RunOnce(loop_, 0));
+    EXPECT_EQ(0, record.Calls);
+
+    ASSERT_EQ(1, write(pipe_[1], "x", 1));
+    EXPECT_EQ(1, EventLoop_RunOnce(loop_, 1000));
+    EXPECT_EQ(1, record.Calls);
+
+    ASSERT_EQ(0, EventLoop_RemoveFd(loop_, pipe_[0]));
+    EXPECT_EQ(-1, EventLoop_RemoveFd(loop_, pipe_[0]));
+    ASSERT_EQ(1, write(pipe_[1], "x", 1));
+    EXPECT_EQ(0, EventLoop_RunOnce(loop_, 0));
+    EXPECT_EQ(1, record.Calls);
+}
+
+TEST_F(EventLoopTestSuite, test_wait_lasts_until_timer_is_due)
+{
+    Record record = { 0, 0, NULL, -1 };
+    EventLoopTimer timer;
+    EventLoop_InitTimer(&timer, CountTimer, &record);
+    EXPECT_FALSE(EventLoop_IsTimerRunning(&timer));
+
+    uint64_t start = Lwm2mCore_GetTickCountMs();
+    ASSERT_EQ(0, EventLoop_StartTimer(loop_, &timer, 50));
+    EXPECT_TRUE(EventLoop_IsTimerRunning(&timer));
+
+    // the wait has no limit of its own; the timerfd ends it
+    EXPECT_EQ(1, EventLoop_RunOnce(loop_, -1));
+    uint64_t elapsed = Lwm2mCore_GetTickCountMs() - start;
+    EXPECT_EQ(1, record.Calls);
+    EXPECT_FALSE(EventLoop_IsTimerRunning(&timer));
+    EXPECT_LE(49u, elapsed);
+    EXPECT_GT(1000u, elapsed);
+}
+
+TEST_F(EventLoopTestSuite, test_timers_run_in_deadline_order_and_can_be_stopped)
+{
+    Record early = { 0, 0, NULL, -1 };
+    Record late = { 0, 0, NULL, -1 };
+    Record stopped = { 0, 0, NULL, -1 };
+    EventLoopTimer earlyTimer, lateTimer, stoppedTimer;
+    EventLoop_InitTimer(&earlyTimer, CountTimer, &early);
+    EventLoop_InitTimer(&lateTimer, CountTimer, &late);
+    EventLoop_InitTimer(&stoppedTimer, CountTimer, &stopped);
+
+    ASSERT_EQ(0, EventLoop_StartTimer(loop_, &lateTimer, 0));
+    ASSERT_EQ(0, EventLoop_StartTimer(loop_, &stoppedTimer, 0));
+    ASSERT_EQ(0, EventLoop_StartTimer(loop_, &earlyTimer, 30));
+    // rescheduling moves a started timer
+    ASSERT_EQ(0, EventLoop_StartTimer(loop_, &lateTimer, 60));
+    EventLoop_StopTimer(loop_, &stoppedTimer);
+
+    callOrder = 0;
+    int run = 0;
+    while (run < 2)
+    {
+        int result = EventLoop_RunOnce(loop_, 1000);
+        ASSERT_LT(0, result);
+        run += result;
+    }
+    EXPECT_EQ(1, early.Calls);
+    EXPECT_EQ(1, late.Calls);
+    EXPECT_EQ(1, early.Order);
+    EXPECT_EQ(2, late.Order);
+    EXPECT_EQ(0, stopped.Calls);
+    EXPECT_EQ(0, EventLoop_RunOnce(loop_, 0));
+}
+
+TEST_F(EventLoopTestSuite, test_timer_started_from_fd_callback_runs_in_same_wakeup)
+{
+    Record timerRecord = { 0, 0, NULL, -1 };
+    EventLoopTimer timer;
+    EventLoop_InitTimer(&timer, CountTimer, &timerRecord);
+
+    // a timer restarting itself with no delay waits for the next wakeup rather than looping
+    timerRecord.Restart = &timer;
+    ASSERT_EQ(0, EventLoop_StartTimer(loop_, &timer, 0));
+    EXPECT_EQ(1, EventLoop_RunOnce(loop_, 0));
+    EXPECT_EQ(1, timerRecord.Calls);
+    EXPECT_TRUE(EventLoop_IsTimerRunning(&timer));
+    EXPECT_EQ(1, EventLoop_RunOnce(loop_, 0));
+    EXPECT_EQ(2, timerRecord.Calls);
+    EventLoop_StopTimer(loop_, &timer);
+    timerRecord.Restart = NULL;
+
+    Record fdRecord = { 0, 0, NULL, -1 };
+    ASSERT_EQ(0, EventLoop_AddFd(loop_, pipe_[0], ReadByte, &fdRecord));
+    ASSERT_EQ(1, write(pipe_[1], "x", 1));
+    callOrder = 0;
+
+    // as the daemons do: an fd callback defers follow-up work to a timer with no delay
+    EventLoopTimer followUp;
+    Record followUpRecord = { 0, 0, NULL, -1 };
+    EventLoop_InitTimer(&followUp, CountTimer, &followUpRecord);
+    ASSERT_EQ(0, EventLoop_StartTimer(loop_, &followUp, 0));
+    EXPECT_EQ(2, EventLoop_RunOnce(loop_, 1000));
+    EXPECT_EQ(1, fdRecord.Order);
+    EXPECT_EQ(2, followUpRecord.Order);
+
+    EventLoopStats stats;
+    EventLoop_GetStats(loop_, &stats);
+    EXPECT_EQ(3u, stats.Wakeups);
+    EXPECT_EQ(1u, stats.FdEvents);
+    EXPECT_EQ(3u, stats.TimersRun);
+}
+
+TEST_F(EventLoopTestSuite, test_fd_removed_by_earlier_callback_in_same_wakeup_is_not_called)
+{
+    // both are ready; whichever runs first removes the other, which is then not called
+    Record first = { 0, 0, NULL, otherPipe_[0] };
+    Record second = { 0, 0, NULL, pipe_[0] };
+    ASSERT_EQ(0, EventLoop_AddFd(loop_, pipe_[0], ReadByte, &first));
+    ASSERT_EQ(0, EventLoop_AddFd(loop_, otherPipe_[0], ReadByte, &second));
+    ASSERT_EQ(1, write(pipe_[1], "x", 1));
+    ASSERT_EQ(1, write(otherPipe_[1], "x", 1));
+
+    EXPECT_EQ(1, EventLoop_RunOnce(loop_, 1000));
+    EXPECT_EQ(1, first.Calls + second.Calls);
+
+    // the removed fd can be watched again
+    Record again = { 0, 0, NULL, -1 };
+    int removed = (first.Calls == 1) ? otherPipe_[0] : pipe_[0];
+    ASSERT_EQ(0, EventLoop_AddFd(loop_, removed, ReadByte, &again));
+    EXPECT_EQ(1, EventLoop_RunOnce(loop_, 1000));
+    EXPECT_EQ(1, again.Calls);
+}
@@ -0,0 +1,144 @@
+/************************************************************************************************************************
+ Copyright (c) 2016, Imagination Technologies Limited and/or its affiliated group companies.
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+ following conditions are met:
+     1. Redistributions of source code must retain the above copyright notice, this list of conditions and the
+        following disclaimer.
+     2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the
+        following disclaimer in the documentation and/or other materials provided with the distribution.
+     3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote
+        products derived from this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, 
+ SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, 
+ WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE 
+ USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+************************************************************************************************************************/
+
+#include <gtest/gtest.h>
+#include <stdint.h>
+#include <string.h>
+#include <set>
+
+#include "lwm2m_hash_table.h"
+
+typedef struct
+{
+    HashTableNode Node;
+    int Key;
+} TestEntry;
+
+class HashTableTestSuite : public testing::Test
+{
+protected:
+    void SetUp() { HashTable_Init(&table_); }
+    void TearDown() { HashTable_Destroy(&table_); }
+
+    TestEntry * Find(int key)
+    {
+        TestEntry * result = NULL;
+        for (HashTableNode * node = HashTable_FindFirst(&table_, HashTable_HashUInt32(key)); node != NULL; node = HashTable_FindNext(node))
+        {
+            TestEntry * entry = HashTableEntry(node, TestEntry, Node);
+            if (entry->Key == key)
+            {
+                result = entry;
+                break;
+            }
+        }
+        return result;
+    }
+
+    HashTable table_;
+};
+
+TEST_F(HashTableTestSuite, test_find_in_empty_table)
+{
+    EXPECT_EQ(0u, HashTable_Count(&table_));
+    EXPECT_TRUE(NULL == HashTable_FindFirst(&table_, 0));
+    EXPECT_TRUE(NULL == HashTable_First(&table_));
+}
+
+TEST_F(HashTableTestSuite, test_insert_find_remove)
+{
+    const int count = 1000;
+    TestEntry * entries = new TestEntry[count];
+    for (int i = 0; i < count; i++)
+    {
+        entries[i].Key = i;
+        ASSERT_EQ(0, HashTable_Insert(&table_, &entries[i].Node, HashTable_HashUInt32(i)));
+    }
+    EXPECT_EQ(static_cast<size_t>(count), HashTable_Count(&table_));
+
+    for (int i = 0; i < count; i++)
+    {
+        EXPECT_EQ(&entries[i], Find(i));
+    }
+    EXPECT_TRUE(NULL == Find(count));
+
+    for (int i = 0; i < count; i += 2)
+    {
+        EXPECT_EQ(0, HashTable_Remove(&table_, &entries[i].Node));
+    }
+    EXPECT_EQ(static_cast<size_t>(count / 2), HashTable_Count(&table_));
+    for (int i = 0; i < count; i++)
+    {
+        EXPECT_EQ((i % 2) ? &entries[i] : NULL, Find(i));
+    }
+    delete[] entries;
+}
+
+TEST_F(HashTableTestSuite, test_remove_node_not_in_table)
+{
+    TestEntry entry = { { NULL, 0 }, 1 };
+    EXPECT_EQ(-1, HashTable_Remove(&table_, &entry.Node));
+    ASSERT_EQ(0, HashTable_Insert(&table_, &entry.Node, 42));
+    EXPECT_EQ(0, HashTable_Remove(&table_, &entry.Node));
+    EXPECT_EQ(-1, HashTable_Remove(&table_, &entry.Node));
+}
+
+TEST_F(HashTableTestSuite, test_colliding_hashes_are_all_found)
+{
+    TestEntry entries[3];
+    for (int i = 0; i < 3; i++)
+    {
+        entries[i].Key = i;
+        ASSERT_EQ(0, HashTable_Insert(&table_, &entries[i].Node, 7));
+    }
+    int found = 0;
+    for (HashTableNode * node = HashTable_FindFirst(&table_, 7); node != NULL; node = HashTable_FindNext(node))
+    {
+        found++;
+    }
+    EXPECT_EQ(3, found);
+}
+
+TEST_F(HashTableTestSuite, test_iterate_all_nodes)
+{
+    const int count = 100;
+    TestEntry entries[count];
+    for (int i = 0; i < count; i++)
+    {
+        entries[i].Key = i;
+        ASSERT_EQ(0, HashTable_Insert(&table_, &entries[i].Node, HashTable_HashUInt32(i)));
+    }
+    std::set<int> seen;
+    for (HashTableNode * node = HashTable_First(&table_); node != NULL; node = HashTable_Next(&table_, node))
+    {
+        seen.insert(HashTableEntry(node, TestEntry, Node)->Key);
+    }
+    EXPECT_EQ(static_cast<size_t>(count), seen.size());
+}
+
+TEST_F(HashTableTestSuite, test_hash_functions)
+{
+    const char data[] = "endpoint";
+    EXPECT_EQ(HashTable_HashString(data), HashTable_HashBytes(data, strlen(data)));
+    EXPECT_NE(HashTable_HashString("client1"), HashTable_HashString("client2"));
+    EXPECT_NE(HashTable_HashUInt32(1), HashTable_HashUInt32(2));
+}
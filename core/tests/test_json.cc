@@ -64,7 +64,7 @@ TEST_F(JsonTestSuite, test_serialise_string)
     "}\n";
 
     Lwm2mTreeNode * dest;
-    TreeBuilder_CreateTreeFromObject(&dest, context, Lwm2mRequestOrigin_Client, 0);
+    TreeBuilder_CreateTreeFromObject(&dest, NULL, context, Lwm2mRequestOrigin_Client, 0);
 
     SerdesContext serdesContext = NULL;
     int len = JsonSerialiseObject(&serdesContext, dest, 0, buffer, sizeof(buffer));
@@ -96,7 +96,7 @@ TEST_F(JsonTestSuite, test_serialise_string_multiple)
 
     Lwm2mTreeNode * dest;
 
-    TreeBuilder_CreateTreeFromObject(&dest, context, Lwm2mRequestOrigin_Client, 0);
+    TreeBuilder_CreateTreeFromObject(&dest, NULL, context, Lwm2mRequestOrigin_Client, 0);
 
     SerdesContext serdesContext = NULL;
     int len = JsonSerialiseObject(&serdesContext, dest, 0, buffer, sizeof(buffer));
@@ -128,7 +128,7 @@ TEST_F(JsonTestSuite, test_serialise_opaque)
 
     Lwm2mTreeNode * dest;
 
-    TreeBuilder_CreateTreeFromObject(&dest, context, Lwm2mRequestOrigin_Client, 0);
+    TreeBuilder_CreateTreeFromObject(&dest, NULL, context, Lwm2mRequestOrigin_Client, 0);
   
     SerdesContext serdesContext = NULL;
     int len = JsonSerialiseObject(&serdesContext, dest, 0, buffer, sizeof(buffer));
@@ -160,7 +160,7 @@ TEST_F(JsonTestSuite, test_serialise_boolean)
 
     Lwm2mTreeNode * dest;
 
-    TreeBuilder_CreateTreeFromObject(&dest, context, Lwm2mRequestOrigin_Client, 0);
+    TreeBuilder_CreateTreeFromObject(&dest, NULL, context, Lwm2mRequestOrigin_Client, 0);
 
     //TODO: change other tests to use single instance of an object.
     SerdesContext serdesContext = NULL;
@@ -193,7 +193,7 @@ TEST_F(JsonTestSuite, test_serialise_float)
 
     Lwm2mTreeNode * dest;
 
-    TreeBuilder_CreateTreeFromObject(&dest, context, Lwm2mRequestOrigin_Client, 0);
+    TreeBuilder_CreateTreeFromObject(&dest, NULL, context, Lwm2mRequestOrigin_Client, 0);
 
     SerdesContext serdesContext = NULL;
     int len = JsonSerialiseObject(&serdesContext, dest, 0, buffer, sizeof(buffer));
@@ -224,7 +224,7 @@ TEST_F(JsonTestSuite, test_serialise_integer)
 
     Lwm2mTreeNode * dest;
 
-    TreeBuilder_CreateTreeFromObject(&dest, context, Lwm2mRequestOrigin_Client, 0);
+    TreeBuilder_CreateTreeFromObject(&dest, NULL, context, Lwm2mRequestOrigin_Client, 0);
 
     SerdesContext serdesContext = NULL;
     int len = JsonSerialiseObject(&serdesContext, dest, 0, buffer, sizeof(buffer));
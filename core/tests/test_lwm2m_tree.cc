@@ -192,3 +192,96 @@ TEST_F(Lwm2mTreeNodeTestSuite, test_get_child_count)
 
 
 
+
+TEST_F(Lwm2mTreeNodeTestSuite, test_arena_tree)
+{
+    const char * value = "hello world";
+    const char * larger_value = "this is a larger value";
+    uint8_t arenaBlock[LWM2M_TREE_ARENA_INITIAL_SIZE];
+    MemoryArena arena;
+    MemoryArena_Init(&arena, arenaBlock, sizeof(arenaBlock), LWM2M_TREE_ARENA_BLOCK_SIZE);
+
+    Lwm2mTreeNode * root = Lwm2mTreeNode_CreateInArena(&arena);
+    ASSERT_TRUE(NULL != root);
+    ASSERT_EQ(&arena, Lwm2mTreeNode_GetArena(root));
+
+    // children created through the tree share its arena
+    Lwm2mTreeNode * child = Lwm2mTreeNode_FindOrCreateChildNode(root, 3, Lwm2mTreeNodeType_Object, NULL, false);
+    ASSERT_TRUE(NULL != child);
+    ASSERT_EQ(&arena, Lwm2mTreeNode_GetArena(child));
+
+    uint16_t length;
+    ASSERT_EQ(0, Lwm2mTreeNode_SetValue(child, (const uint8_t *)value, strlen(value)));
+    ASSERT_EQ(0, Lwm2mTreeNode_SetValue(child, (const uint8_t *)larger_value, strlen(larger_value)));
+    ASSERT_EQ(0, memcmp(larger_value, Lwm2mTreeNode_GetValue(child, &length), strlen(larger_value)));
+    ASSERT_EQ(strlen(larger_value), length);
+    ASSERT_EQ(0, Lwm2mTreeNode_SetValue(child, (const uint8_t *)value, strlen(value)));
+    ASSERT_EQ(0, memcmp(value, Lwm2mTreeNode_GetValue(child, &length), strlen(value)));
+    ASSERT_EQ(strlen(value), length);
+
+    // a heap node added to an arena tree is still freed by deleting the tree
+    Lwm2mTreeNode * heapChild = Lwm2mTreeNode_Create();
+    ASSERT_EQ(NULL, Lwm2mTreeNode_GetArena(heapChild));
+    Lwm2mTreeNode_SetID(heapChild, 4);
+    Lwm2mTreeNode_SetValue(heapChild, (const uint8_t *)value, strlen(value));
+    Lwm2mTreeNode_AddChild(root, heapChild);
+    ASSERT_EQ(2, Lwm2mTreeNode_GetChildCount(root));
+
+    // copies are made on the heap
+    Lwm2mTreeNode * copy = Lwm2mTreeNode_CopyRecursive(root);
+    ASSERT_EQ(NULL, Lwm2mTreeNode_GetArena(copy));
+    ASSERT_EQ(0, Lwm2mTreeNode_CompareRecursive(root, copy));
+    Lwm2mTreeNode_DeleteRecursive(copy);
+
+    ASSERT_EQ(0, Lwm2mTreeNode_DeleteRecursive(root));
+    MemoryArena_Destroy(&arena);
+}
+
+TEST_F(Lwm2mTreeNodeTestSuite, test_borrowed_value)
+{
+    char source[] = "a value owned by someone else";
+    const char * value = "hello world";
+    uint16_t length;
+
+    ASSERT_EQ(-1, Lwm2mTreeNode_SetValueReference(NULL, (const uint8_t *)source, strlen(source)));
+
+    Lwm2mTreeNode * node = Lwm2mTreeNode_Create();
+    ASSERT_EQ(-1, Lwm2mTreeNode_SetValueReference(node, NULL, 0));
+    ASSERT_EQ(0, Lwm2mTreeNode_SetValue(node, (const uint8_t *)value, strlen(value)));
+
+    // a borrowed value replaces an owned one without a copy
+    ASSERT_EQ(0, Lwm2mTreeNode_SetValueReference(node, (const uint8_t *)source, strlen(source)));
+    ASSERT_TRUE(Lwm2mTreeNode_IsValueBorrowed(node));
+    ASSERT_EQ((const uint8_t *)source, Lwm2mTreeNode_GetValue(node, &length));
+    ASSERT_EQ(strlen(source), length);
+
+    // setting a value afterwards copies it into the node, leaving the source untouched
+    ASSERT_EQ(0, Lwm2mTreeNode_SetValue(node, (const uint8_t *)value, strlen(value)));
+    ASSERT_FALSE(Lwm2mTreeNode_IsValueBorrowed(node));
+    ASSERT_NE((const uint8_t *)source, Lwm2mTreeNode_GetValue(node, &length));
+    ASSERT_EQ(strlen(value), length);
+    ASSERT_STREQ("a value owned by someone else", source);
+
+    // deleting a node does not free what it borrowed
+    ASSERT_EQ(0, Lwm2mTreeNode_SetValueReference(node, (const uint8_t *)source, strlen(source)));
+    ASSERT_EQ(0, Lwm2mTreeNode_DeleteRecursive(node));
+
+    uint8_t arenaBlock[LWM2M_TREE_ARENA_INITIAL_SIZE];
+    MemoryArena arena;
+    MemoryArena_Init(&arena, arenaBlock, sizeof(arenaBlock), LWM2M_TREE_ARENA_BLOCK_SIZE);
+    node = Lwm2mTreeNode_CreateInArena(&arena);
+    ASSERT_EQ(0, Lwm2mTreeNode_SetValueReference(node, (const uint8_t *)source, strlen(source)));
+
+    // copies own their values
+    Lwm2mTreeNode * copy = Lwm2mTreeNode_CopyRecursive(node);
+    ASSERT_FALSE(Lwm2mTreeNode_IsValueBorrowed(copy));
+    ASSERT_NE((const uint8_t *)source, Lwm2mTreeNode_GetValue(copy, &length));
+    ASSERT_EQ(0, Lwm2mTreeNode_CompareRecursive(node, copy));
+    Lwm2mTreeNode_DeleteRecursive(copy);
+
+    // a shorter value must not be written over the borrowed one
+    ASSERT_EQ(0, Lwm2mTreeNode_SetValue(node, (const uint8_t *)value, strlen(value)));
+    ASSERT_STREQ("a value owned by someone else", source);
+    ASSERT_EQ(0, memcmp(value, Lwm2mTreeNode_GetValue(node, &length), strlen(value)));
+    MemoryArena_Destroy(&arena);
+}
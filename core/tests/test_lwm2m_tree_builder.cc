@@ -57,7 +57,7 @@ TEST_F(Lwm2mTreeBuilderTestSuite, test_build_resource_node)
     Lwm2mCore_SetResourceInstanceValue(context, 0, 0, 0, 0, (char*)expected, strlen(expected));
 
     Lwm2mTreeNode * dest;
-    TreeBuilder_CreateTreeFromResource(&dest,context, Lwm2mRequestOrigin_Client,0,0,0);
+    TreeBuilder_CreateTreeFromResource(&dest, NULL, context, Lwm2mRequestOrigin_Client,0,0,0);
 
     ASSERT_TRUE(dest != NULL);
     ASSERT_TRUE(Lwm2mTreeNode_GetParent(dest) == NULL);
@@ -91,6 +91,69 @@ TEST_F(Lwm2mTreeBuilderTestSuite, test_build_resource_node)
     Lwm2mTreeNode_DeleteRecursive(dest);
 }
 
+static char handlerBuffer[64];
+
+static int ReuseBufferReadHandler(void * context, ObjectIDType objectID, ObjectInstanceIDType objectInstanceID, ResourceIDType resourceID,
+                                  ResourceInstanceIDType resourceInstanceID, const void ** buffer, size_t * bufferLen)
+{
+    snprintf(handlerBuffer, sizeof(handlerBuffer), "generated value for resource %d", resourceID);
+    *buffer = handlerBuffer;
+    *bufferLen = strlen(handlerBuffer);
+    return *bufferLen;
+}
+
+TEST_F(Lwm2mTreeBuilderTestSuite, test_build_resource_node_in_arena_borrows_stable_values)
+{
+    const char * expected = "a string long enough to be kept on the heap by the object store";
+    ResourceOperationHandlers reuseBufferHandlers = defaultResourceOperationHandlers;
+    reuseBufferHandlers.Read = ReuseBufferReadHandler;
+
+    Definition_RegisterObjectType(Lwm2mCore_GetDefinitions(context), (char*)"Test", 0, MultipleInstancesEnum_Single, MandatoryEnum_Mandatory, &defaultObjectOperationHandlers);
+    Lwm2mCore_RegisterResourceType(context, (char*)"Res1", 0, 0, AwaResourceType_String, MultipleInstancesEnum_Single, MandatoryEnum_Mandatory, AwaResourceOperations_ReadWrite, &defaultResourceOperationHandlers);
+    Lwm2mCore_RegisterResourceType(context, (char*)"Res2", 0, 1, AwaResourceType_String, MultipleInstancesEnum_Single, MandatoryEnum_Mandatory, AwaResourceOperations_ReadOnly, &reuseBufferHandlers);
+    Lwm2mCore_CreateObjectInstance(context, 0, 0);
+    Lwm2mCore_SetResourceInstanceValue(context, 0, 0, 0, 0, (char*)expected, strlen(expected));
+
+    EXPECT_TRUE(Lwm2mCore_IsResourceValueStable(context, 0, 0));
+    EXPECT_FALSE(Lwm2mCore_IsResourceValueStable(context, 0, 1));
+    EXPECT_FALSE(Lwm2mCore_IsResourceValueStable(context, 0, 2));
+
+    const void * storeValue = NULL;
+    size_t storeValueLength = 0;
+    ASSERT_EQ((int)strlen(expected), Lwm2mCore_GetResourceInstanceValue(context, 0, 0, 0, 0, &storeValue, &storeValueLength));
+
+    uint8_t arenaBlock[LWM2M_TREE_ARENA_INITIAL_SIZE];
+    MemoryArena arena;
+    MemoryArena_Init(&arena, arenaBlock, sizeof(arenaBlock), LWM2M_TREE_ARENA_BLOCK_SIZE);
+
+    // object store values are referenced by arena trees, not copied
+    Lwm2mTreeNode * dest;
+    ASSERT_EQ(AwaResult_Success, TreeBuilder_CreateTreeFromResource(&dest, &arena, context, Lwm2mRequestOrigin_Client, 0, 0, 0));
+    Lwm2mTreeNode * child = Lwm2mTreeNode_GetFirstChild(dest);
+    ASSERT_TRUE(child != NULL);
+    ASSERT_TRUE(Lwm2mTreeNode_IsValueBorrowed(child));
+    uint16_t length;
+    EXPECT_EQ(storeValue, Lwm2mTreeNode_GetValue(child, &length));
+    EXPECT_EQ(strlen(expected), length);
+
+    // values from a handler that may reuse its buffer are copied
+    ASSERT_EQ(AwaResult_Success, TreeBuilder_CreateTreeFromResource(&dest, &arena, context, Lwm2mRequestOrigin_Client, 0, 0, 1));
+    child = Lwm2mTreeNode_GetFirstChild(dest);
+    ASSERT_TRUE(child != NULL);
+    ASSERT_FALSE(Lwm2mTreeNode_IsValueBorrowed(child));
+    EXPECT_NE((const uint8_t *)handlerBuffer, Lwm2mTreeNode_GetValue(child, &length));
+    EXPECT_EQ(0, memcmp("generated value for resource 1", Lwm2mTreeNode_GetValue(child, &length), length));
+    MemoryArena_Destroy(&arena);
+
+    // heap trees may outlive the request, so they always copy
+    ASSERT_EQ(AwaResult_Success, TreeBuilder_CreateTreeFromResource(&dest, NULL, context, Lwm2mRequestOrigin_Client, 0, 0, 0));
+    child = Lwm2mTreeNode_GetFirstChild(dest);
+    ASSERT_TRUE(child != NULL);
+    ASSERT_FALSE(Lwm2mTreeNode_IsValueBorrowed(child));
+    EXPECT_NE(storeValue, Lwm2mTreeNode_GetValue(child, &length));
+    Lwm2mTreeNode_DeleteRecursive(dest);
+}
+
 // TODO: test_build_[object/object_instance]_node
 // TODO: test multiple instances and non-zero IDs
 
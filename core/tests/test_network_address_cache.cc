@@ -0,0 +1,218 @@
+/************************************************************************************************************************
+ Copyright (c) 2017, Imagination Technologies Limited and/or its affiliated group companies.
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+ following conditions are met:
+     1. Redistributions of source code must retain the above copyright notice, this list of conditions and the
+        following disclaimer.
+     2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the
+        following disclaimer in the documentation and/or other materials provided with the distribution.
+     3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote
+        products derived from this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+ USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+************************************************************************************************************************/
+
+
+#include <gtest/gtest.h>
+#include <string.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+#include "network_abstraction_posix.h"
+
+class NetworkAddressCacheTestSuite : public testing::Test
+{
+protected:
+    void SetUp()
+    {
+        socket_ = NetworkSocket_New("127.0.0.1", NetworkSocketType_UDP, 0);
+        ASSERT_TRUE(NULL != socket_);
+        ASSERT_TRUE(NetworkSocket_StartListening(socket_));
+
+        struct sockaddr_in local;
+        socklen_t localLength = sizeof(local);
+        ASSERT_EQ(0, getsockname(NetworkSocket_GetFileDescriptor(socket_), (struct sockaddr *)&local, &localLength));
+        port_ = ntohs(local.sin_port);
+
+        for (int i = 0; i < NUM_PEERS; i++)
+        {
+            peers_[i] = socket(AF_INET, SOCK_DGRAM, 0);
+            ASSERT_LE(0, peers_[i]);
+        }
+    }
+
+    void TearDown()
+    {
+        for (int i = 0; i < NUM_PEERS; i++)
+        {
+            close(peers_[i]);
+        }
+        NetworkSocket_Free(&socket_);
+        NetworkAddress_SetCacheLimits(NETWORK_ADDRESS_CACHE_MAX_IDLE, NETWORK_ADDRESS_CACHE_IDLE_TIMEOUT);
+    }
+
+    // Send a datagram from a peer and return the address NetworkSocket_Read reports it came from
+    NetworkAddress * Receive(int peer)
+    {
+        struct sockaddr_in destination;
+        memset(&destination, 0, sizeof(destination));
+        destination.sin_family = AF_INET;
+        destination.sin_port = htons(port_);
+        inet_pton(AF_INET, "127.0.0.1", &destination.sin_addr);
+        uint8_t datagram[4] = { 1, 2, 3, 4 };
+        EXPECT_EQ(4, sendto(peers_[peer], datagram, sizeof(datagram), 0, (struct sockaddr *)&destination, sizeof(destination)));
+
+        struct pollfd fd = { NetworkSocket_GetFileDescriptor(socket_), POLLIN, 0 };
+        EXPECT_EQ(1, poll(&fd, 1, 1000));
+
+        uint8_t buffer[16];
+        int readLength = 0;
+        NetworkAddress * sourceAddress = NULL;
+        EXPECT_TRUE(NetworkSocket_Read(socket_, buffer, sizeof(buffer), &sourceAddress, &readLength));
+        EXPECT_EQ(4, readLength);
+        return sourceAddress;
+    }
+
+    static const int NUM_PEERS = 3;
+    NetworkSocket * socket_;
+    uint16_t port_;
+    int peers_[NUM_PEERS];
+};
+
+TEST_F(NetworkAddressCacheTestSuite, test_new_returns_cached_address_for_same_uri)
+{
+    NetworkAddressCacheStats before, after;
+    NetworkAddress_GetCacheStats(&before);
+
+    NetworkAddress * first = NetworkAddress_New("coap://127.0.0.1:5601/rd", strlen("coap://127.0.0.1:5601/rd"));
+    NetworkAddress * second = NetworkAddress_New("coap://127.0.0.1:5601", strlen("coap://127.0.0.1:5601"));
+    ASSERT_TRUE(NULL != first);
+    EXPECT_EQ(first, second);
+
+    NetworkAddress_GetCacheStats(&after);
+    EXPECT_EQ(before.Live + 1, after.Live);
+
+    NetworkAddress_Free(&first);
+    NetworkAddress_Free(&second);
+    EXPECT_TRUE(NULL == first);
+
+    // kept idle once nothing references it
+    NetworkAddress_GetCacheStats(&after);
+    EXPECT_EQ(before.Live + 1, after.Live);
+    EXPECT_EQ(before.Idle + 1, after.Idle);
+}
+
+TEST_F(NetworkAddressCacheTestSuite, test_read_from_known_peer_is_a_cache_hit)
+{
+    NetworkAddressCacheStats before, after;
+    NetworkAddress_GetCacheStats(&before);
+
+    NetworkAddress * first = Receive(0);
+    NetworkAddress * second = Receive(0);
+    ASSERT_TRUE(NULL != first);
+    EXPECT_EQ(first, second);
+
+    NetworkAddress_GetCacheStats(&after);
+    EXPECT_EQ(before.Misses + 1, after.Misses);
+    EXPECT_EQ(before.Hits + 1, after.Hits);
+    EXPECT_EQ(before.Live + 1, after.Live);
+}
+
+TEST_F(NetworkAddressCacheTestSuite, test_received_address_matches_uri_lookup)
+{
+    NetworkAddress * received = Receive(0);
+    ASSERT_TRUE(NULL != received);
+
+    struct sockaddr_in peer;
+    socklen_t peerLength = sizeof(peer);
+    ASSERT_EQ(0, getsockname(peers_[0], (struct sockaddr *)&peer, &peerLength));
+    char uri[64];
+    snprintf(uri, sizeof(uri), "coap://127.0.0.1:%d", ntohs(peer.sin_port));
+
+    NetworkAddress * address = NetworkAddress_New(uri, strlen(uri));
+    EXPECT_EQ(received, address);
+    NetworkAddress_Free(&address);
+}
+
+TEST_F(NetworkAddressCacheTestSuite, test_idle_addresses_are_evicted_beyond_limit)
+{
+    NetworkAddressCacheStats before, after;
+    NetworkAddress_SetCacheLimits(1, NETWORK_ADDRESS_CACHE_IDLE_TIMEOUT);
+    NetworkAddress_GetCacheStats(&before);
+
+    Receive(0);
+    Receive(1);
+    Receive(2);
+
+    // a read first evicts down to the limit, so the oldest peer has gone by the time the third is read
+    NetworkAddress_GetCacheStats(&after);
+    EXPECT_EQ(before.Misses + 3, after.Misses);
+    EXPECT_LE(before.Evicted + 1, after.Evicted);
+    EXPECT_EQ(2u, after.Idle);
+}
+
+TEST_F(NetworkAddressCacheTestSuite, test_retained_address_is_not_evicted)
+{
+    NetworkAddressCacheStats stats;
+    NetworkAddress * retained = NetworkAddress_Retain(Receive(0));
+    ASSERT_TRUE(NULL != retained);
+
+    NetworkAddress_SetCacheLimits(0, 0);
+    NetworkAddress_GetCacheStats(&stats);
+    EXPECT_EQ(0u, stats.Idle);
+
+    NetworkAddress_GetCacheStats(&stats);
+    unsigned long hits = stats.Hits;
+    EXPECT_EQ(retained, Receive(0));
+    NetworkAddress_GetCacheStats(&stats);
+    EXPECT_EQ(hits + 1, stats.Hits);
+
+    NetworkAddress_Free(&retained);
+    NetworkAddress_GetCacheStats(&stats);
+    EXPECT_EQ(1u, stats.Idle);
+}
+
+TEST_F(NetworkAddressCacheTestSuite, test_shard_depends_only_on_address_and_port)
+{
+    NetworkAddress * address = NetworkAddress_New("coap://127.0.0.1:5683", strlen("coap://127.0.0.1:5683"));
+    NetworkAddress * sameAddress = NetworkAddress_New("coaps://127.0.0.1:5683/rd", strlen("coaps://127.0.0.1:5683/rd"));
+    ASSERT_TRUE(NULL != address);
+    ASSERT_TRUE(NULL != sameAddress);
+
+    EXPECT_EQ(0, NetworkAddress_GetShard(address, 1));
+    EXPECT_EQ(0, NetworkAddress_GetShard(NULL, 4));
+    EXPECT_EQ(NetworkAddress_GetShard(address, 4), NetworkAddress_GetShard(sameAddress, 4));
+
+    // different peers spread over the shards
+    int counts[4] = { 0 };
+    for (int port = 6000; port < 6064; port++)
+    {
+        char uri[64];
+        snprintf(uri, sizeof(uri), "coap://127.0.0.1:%d", port);
+        NetworkAddress * peer = NetworkAddress_New(uri, strlen(uri));
+        ASSERT_TRUE(NULL != peer);
+        int shard = NetworkAddress_GetShard(peer, 4);
+        ASSERT_GE(shard, 0);
+        ASSERT_LT(shard, 4);
+        counts[shard]++;
+        NetworkAddress_Free(&peer);
+    }
+    for (int shard = 0; shard < 4; shard++)
+    {
+        EXPECT_GT(counts[shard], 0);
+    }
+
+    NetworkAddress_Free(&sameAddress);
+    NetworkAddress_Free(&address);
+}
@@ -0,0 +1,199 @@
+/************************************************************************************************************************
+ Copyright (c) 2017, Imagination Technologies Limited and/or its affiliated group companies.
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+ following conditions are met:
+     1. Redistributions of source code must retain the above copyright notice, this list of conditions and the
+        following disclaimer.
+     2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the
+        following disclaimer in the documentation and/or other materials provided with the distribution.
+     3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote
+        products derived from this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+ USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+************************************************************************************************************************/
+
+
+#include <gtest/gtest.h>
+#include <string.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+#include "network_abstraction_posix.h"
+
+class NetworkSocketBatchTestSuite : public testing::Test
+{
+protected:
+    void SetUp()
+    {
+        socket_ = NetworkSocket_New("127.0.0.1", NetworkSocketType_UDP, 0);
+        ASSERT_TRUE(NULL != socket_);
+        ASSERT_TRUE(NetworkSocket_StartListening(socket_));
+        ASSERT_EQ(0, GetAddress(NetworkSocket_GetFileDescriptor(socket_), &socketAddress_));
+
+        peer_ = socket(AF_INET, SOCK_DGRAM, 0);
+        ASSERT_LE(0, peer_);
+        struct sockaddr_in local;
+        memset(&local, 0, sizeof(local));
+        local.sin_family = AF_INET;
+        inet_pton(AF_INET, "127.0.0.1", &local.sin_addr);
+        ASSERT_EQ(0, bind(peer_, (struct sockaddr *)&local, sizeof(local)));
+        ASSERT_EQ(0, GetAddress(peer_, &peerAddress_));
+
+        char uri[64];
+        snprintf(uri, sizeof(uri), "coap://127.0.0.1:%d", ntohs(peerAddress_.sin_port));
+        peerNetworkAddress_ = NetworkAddress_New(uri, strlen(uri));
+        ASSERT_TRUE(NULL != peerNetworkAddress_);
+    }
+
+    void TearDown()
+    {
+        NetworkAddress_Free(&peerNetworkAddress_);
+        close(peer_);
+        NetworkSocket_Free(&socket_);
+    }
+
+    static int GetAddress(int fd, struct sockaddr_in * address)
+    {
+        socklen_t length = sizeof(*address);
+        return getsockname(fd, (struct sockaddr *)address, &length);
+    }
+
+    void SendToSocket(uint8_t value)
+    {
+        ASSERT_EQ(1, sendto(peer_, &value, 1, 0, (struct sockaddr *)&socketAddress_, sizeof(socketAddress_)));
+    }
+
+    int ReadFromSocket()
+    {
+        struct pollfd fd = { NetworkSocket_GetFileDescriptor(socket_), POLLIN, 0 };
+        if (!NetworkSocket_HasPendingReads(socket_) && (poll(&fd, 1, 1000) != 1))
+            return -1;
+        uint8_t buffer[16];
+        int readLength = 0;
+        NetworkAddress * sourceAddress = NULL;
+        if (!NetworkSocket_Read(socket_, buffer, sizeof(buffer), &sourceAddress, &readLength) || (readLength != 1))
+            return -1;
+        EXPECT_EQ(peerNetworkAddress_, sourceAddress);
+        return buffer[0];
+    }
+
+    // Returns the byte the peer received, or -1 if nothing arrives within timeoutMs
+    int ReadFromPeer(int timeoutMs)
+    {
+        struct pollfd fd = { peer_, POLLIN, 0 };
+        uint8_t value;
+        if ((poll(&fd, 1, timeoutMs) != 1) || (recv(peer_, &value, 1, 0) != 1))
+            return -1;
+        return value;
+    }
+
+    NetworkSocket * socket_;
+    struct sockaddr_in socketAddress_;
+    int peer_;
+    struct sockaddr_in peerAddress_;
+    NetworkAddress * peerNetworkAddress_;
+};
+
+TEST_F(NetworkSocketBatchTestSuite, test_read_hands_out_datagrams_read_ahead_in_order)
+{
+    for (int i = 0; i < 5; i++)
+    {
+        SendToSocket(i);
+    }
+    // give every datagram time to be queued on the socket, so one receive fetches them all
+    usleep(10000);
+
+    EXPECT_EQ(0, ReadFromSocket());
+    EXPECT_TRUE(NetworkSocket_HasPendingReads(socket_));
+    for (int i = 1; i < 5; i++)
+    {
+        EXPECT_EQ(i, ReadFromSocket());
+    }
+    EXPECT_FALSE(NetworkSocket_HasPendingReads(socket_));
+}
+
+TEST_F(NetworkSocketBatchTestSuite, test_batch_size_one_reads_a_datagram_at_a_time)
+{
+    NetworkSocket_SetBatchSize(socket_, 1);
+    SendToSocket(1);
+    SendToSocket(2);
+    usleep(10000);
+
+    EXPECT_EQ(1, ReadFromSocket());
+    EXPECT_FALSE(NetworkSocket_HasPendingReads(socket_));
+    EXPECT_EQ(2, ReadFromSocket());
+}
+
+TEST_F(NetworkSocketBatchTestSuite, test_sends_are_held_until_batch_ends)
+{
+    NetworkSocket_StartBatch(socket_);
+    for (uint8_t i = 0; i < 3; i++)
+    {
+        EXPECT_TRUE(NetworkSocket_Send(socket_, peerNetworkAddress_, &i, 1));
+    }
+    EXPECT_EQ(-1, ReadFromPeer(10));
+
+    EXPECT_TRUE(NetworkSocket_EndBatch(socket_));
+    for (int i = 0; i < 3; i++)
+    {
+        EXPECT_EQ(i, ReadFromPeer(1000));
+    }
+}
+
+TEST_F(NetworkSocketBatchTestSuite, test_full_batch_is_sent_early)
+{
+    NetworkSocket_StartBatch(socket_);
+    for (int i = 0; i <= NETWORK_BATCH_SIZE; i++)
+    {
+        uint8_t value = i;
+        EXPECT_TRUE(NetworkSocket_Send(socket_, peerNetworkAddress_, &value, 1));
+    }
+    // the first batch went out to make room for the last datagram
+    for (int i = 0; i < NETWORK_BATCH_SIZE; i++)
+    {
+        EXPECT_EQ(i, ReadFromPeer(1000));
+    }
+    EXPECT_EQ(-1, ReadFromPeer(10));
+
+    EXPECT_TRUE(NetworkSocket_EndBatch(socket_));
+    EXPECT_EQ(NETWORK_BATCH_SIZE, ReadFromPeer(1000));
+}
+
+TEST_F(NetworkSocketBatchTestSuite, test_sends_outside_batch_are_immediate)
+{
+    uint8_t value = 7;
+    EXPECT_TRUE(NetworkSocket_Send(socket_, peerNetworkAddress_, &value, 1));
+    EXPECT_EQ(7, ReadFromPeer(1000));
+}
+
+TEST_F(NetworkSocketBatchTestSuite, test_oversized_send_does_not_overtake_held_datagrams)
+{
+    NetworkSocket_StartBatch(socket_);
+    for (uint8_t i = 0; i < 3; i++)
+    {
+        EXPECT_TRUE(NetworkSocket_Send(socket_, peerNetworkAddress_, &i, 1));
+    }
+
+    // too large to hold, so it goes out at once, after the datagrams already held
+    uint8_t large[NETWORK_BATCH_DATAGRAM_SIZE + 1];
+    memset(large, 3, sizeof(large));
+    EXPECT_TRUE(NetworkSocket_Send(socket_, peerNetworkAddress_, large, sizeof(large)));
+    for (int i = 0; i < 4; i++)
+    {
+        EXPECT_EQ(i, ReadFromPeer(1000));
+    }
+
+    EXPECT_TRUE(NetworkSocket_EndBatch(socket_));
+    EXPECT_EQ(-1, ReadFromPeer(10));
+}
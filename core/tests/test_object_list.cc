@@ -0,0 +1,118 @@
+/************************************************************************************************************************
+ Copyright (c) 2016, Imagination Technologies Limited and/or its affiliated group companies.
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+ following conditions are met:
+     1. Redistributions of source code must retain the above copyright notice, this list of conditions and the
+        following disclaimer.
+     2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the
+        following disclaimer in the documentation and/or other materials provided with the distribution.
+     3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote
+        products derived from this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+ USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+************************************************************************************************************************/
+
+
+#include <gtest/gtest.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "server/lwm2m_object_list.h"
+
+class ObjectListTestSuite : public testing::Test
+{
+protected:
+    void SetUp() { ObjectList_Init(&list_); }
+    void TearDown() { ObjectList_Free(&list_); }
+
+    ObjectList list_;
+};
+
+TEST_F(ObjectListTestSuite, test_empty_list)
+{
+    EXPECT_EQ(0u, ObjectList_GetCount(&list_));
+    EXPECT_FALSE(ObjectList_Contains(&list_, 3, -1));
+    EXPECT_FALSE(ObjectList_Contains(&list_, 3, 0));
+    EXPECT_EQ(0u, ObjectList_GetMemoryUsage(&list_));
+}
+
+TEST_F(ObjectListTestSuite, test_entries_are_sorted_and_deduplicated)
+{
+    ASSERT_EQ(0, ObjectList_Add(&list_, 3303, 1));
+    ASSERT_EQ(0, ObjectList_Add(&list_, 3, 0));
+    ASSERT_EQ(0, ObjectList_Add(&list_, 5, -1));
+    ASSERT_EQ(0, ObjectList_Add(&list_, 3303, 0));
+    ASSERT_EQ(0, ObjectList_Add(&list_, 3, 0));
+    ObjectList_Finalise(&list_);
+
+    ASSERT_EQ(4u, ObjectList_GetCount(&list_));
+    EXPECT_EQ(3, ObjectList_GetObjectID(&list_, 0));
+    EXPECT_EQ(0, ObjectList_GetInstanceID(&list_, 0));
+    EXPECT_EQ(5, ObjectList_GetObjectID(&list_, 1));
+    EXPECT_EQ(-1, ObjectList_GetInstanceID(&list_, 1));
+    EXPECT_EQ(3303, ObjectList_GetObjectID(&list_, 2));
+    EXPECT_EQ(0, ObjectList_GetInstanceID(&list_, 2));
+    EXPECT_EQ(3303, ObjectList_GetObjectID(&list_, 3));
+    EXPECT_EQ(1, ObjectList_GetInstanceID(&list_, 3));
+}
+
+TEST_F(ObjectListTestSuite, test_contains)
+{
+    ObjectList_Add(&list_, 3, 0);
+    ObjectList_Add(&list_, 5, -1);
+    ObjectList_Add(&list_, 3303, 2);
+    ObjectList_Finalise(&list_);
+
+    EXPECT_TRUE(ObjectList_Contains(&list_, 3, -1));
+    EXPECT_TRUE(ObjectList_Contains(&list_, 3, 0));
+    EXPECT_FALSE(ObjectList_Contains(&list_, 3, 1));
+    EXPECT_TRUE(ObjectList_Contains(&list_, 5, -1));
+    EXPECT_FALSE(ObjectList_Contains(&list_, 5, 0));
+    EXPECT_TRUE(ObjectList_Contains(&list_, 3303, -1));
+    EXPECT_TRUE(ObjectList_Contains(&list_, 3303, 2));
+    EXPECT_FALSE(ObjectList_Contains(&list_, 3303, 0));
+    EXPECT_FALSE(ObjectList_Contains(&list_, 4, -1));
+    EXPECT_FALSE(ObjectList_Contains(&list_, 3304, -1));
+}
+
+TEST_F(ObjectListTestSuite, test_clear_allows_reuse)
+{
+    ObjectList_Add(&list_, 1, 0);
+    ObjectList_Add(&list_, 1000, 0);
+    ObjectList_Finalise(&list_);
+    ObjectList_Clear(&list_);
+
+    EXPECT_EQ(0u, ObjectList_GetCount(&list_));
+    EXPECT_FALSE(ObjectList_Contains(&list_, 1, -1));
+    EXPECT_FALSE(ObjectList_Contains(&list_, 1000, -1));
+
+    ObjectList_Add(&list_, 2, 0);
+    ObjectList_Finalise(&list_);
+    EXPECT_TRUE(ObjectList_Contains(&list_, 2, 0));
+    EXPECT_FALSE(ObjectList_Contains(&list_, 1, 0));
+}
+
+TEST_F(ObjectListTestSuite, test_many_instances)
+{
+    for (int i = 999; i >= 0; i--)
+    {
+        ASSERT_EQ(0, ObjectList_Add(&list_, 3303, i));
+    }
+    ObjectList_Finalise(&list_);
+
+    EXPECT_EQ(1000u, ObjectList_GetCount(&list_));
+    EXPECT_GE(ObjectList_GetMemoryUsage(&list_), 1000 * sizeof(ObjectListEntry));
+    for (int i = 0; i < 1000; i++)
+    {
+        EXPECT_TRUE(ObjectList_Contains(&list_, 3303, i));
+    }
+    EXPECT_FALSE(ObjectList_Contains(&list_, 3303, 1000));
+}
@@ -0,0 +1,344 @@
+/************************************************************************************************************************
+ Copyright (c) 2016, Imagination Technologies Limited and/or its affiliated group companies.
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+ following conditions are met:
+     1. Redistributions of source code must retain the above copyright notice, this list of conditions and the
+        following disclaimer.
+     2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the
+        following disclaimer in the documentation and/or other materials provided with the distribution.
+     3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote
+        products derived from this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+ USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+************************************************************************************************************************/
+
+#include <gtest/gtest.h>
+#include <stdint.h>
+#include <string.h>
+#include <string>
+
+#include "lwm2m_object_store.h"
+#include "lwm2m_result.h"
+
+class ObjectStoreTestSuite : public testing::Test
+{
+protected:
+    void SetUp()
+    {
+        store_ = ObjectStore_Create();
+        ASSERT_TRUE(NULL != store_);
+    }
+
+    void TearDown()
+    {
+        ObjectStore_Destroy(store_);
+    }
+
+    int SetInteger(ObjectIDType objectID, ObjectInstanceIDType instanceID, ResourceIDType resourceID, ResourceInstanceIDType resourceInstanceID, int64_t value)
+    {
+        bool changed = false;
+        return ObjectStore_SetResourceInstanceValue(store_, objectID, instanceID, resourceID, resourceInstanceID, sizeof(value), &value, 0, sizeof(value), &changed);
+    }
+
+    ObjectStore * store_;
+};
+
+TEST_F(ObjectStoreTestSuite, test_set_and_get_resource_instance_value)
+{
+    ASSERT_EQ(0, ObjectStore_CreateObjectInstance(store_, 3, 0, 1));
+    ASSERT_EQ(9, ObjectStore_CreateResource(store_, 3, 0, 9));
+
+    bool changed = false;
+    int64_t value = 42;
+    EXPECT_EQ(static_cast<int>(sizeof(value)), ObjectStore_SetResourceInstanceValue(store_, 3, 0, 9, 0, sizeof(value), &value, 0, sizeof(value), &changed));
+    EXPECT_TRUE(changed);
+    EXPECT_EQ(static_cast<int>(sizeof(value)), ObjectStore_SetResourceInstanceValue(store_, 3, 0, 9, 0, sizeof(value), &value, 0, sizeof(value), &changed));
+    EXPECT_FALSE(changed);
+
+    const void * stored = NULL;
+    size_t storedSize = 0;
+    EXPECT_EQ(static_cast<int>(sizeof(value)), ObjectStore_GetResourceInstanceValue(store_, 3, 0, 9, 0, &stored, &storedSize));
+    EXPECT_EQ(sizeof(value), storedSize);
+    EXPECT_EQ(42, *static_cast<const int64_t *>(stored));
+    EXPECT_EQ(static_cast<int>(sizeof(value)), ObjectStore_GetResourceInstanceLength(store_, 3, 0, 9, 0));
+
+    EXPECT_EQ(-1, ObjectStore_GetResourceInstanceValue(store_, 3, 0, 9, 1, &stored, &storedSize));
+    EXPECT_EQ(AwaResult_NotFound, AwaResult_GetLastResult());
+    EXPECT_EQ(-1, ObjectStore_GetResourceInstanceValue(store_, 3, 1, 9, 0, &stored, &storedSize));
+}
+
+TEST_F(ObjectStoreTestSuite, test_set_value_fails_without_resource)
+{
+    ASSERT_EQ(0, ObjectStore_CreateObjectInstance(store_, 3, 0, 1));
+    EXPECT_EQ(-1, SetInteger(4, 0, 0, 0, 1));
+    EXPECT_EQ(-1, SetInteger(3, 1, 0, 0, 1));
+    EXPECT_EQ(-1, SetInteger(3, 0, 0, 0, 1));
+}
+
+TEST_F(ObjectStoreTestSuite, test_levels_are_not_confused)
+{
+    ASSERT_EQ(0, ObjectStore_CreateObjectInstance(store_, 1, 0, 1));
+    ASSERT_EQ(0, ObjectStore_CreateResource(store_, 1, 0, 0));
+
+    EXPECT_TRUE(ObjectStore_Exists(store_, 1, -1, -1));
+    EXPECT_TRUE(ObjectStore_Exists(store_, 1, 0, -1));
+    EXPECT_TRUE(ObjectStore_Exists(store_, 1, 0, 0));
+    EXPECT_FALSE(ObjectStore_Exists(store_, 0, -1, -1));
+    EXPECT_FALSE(ObjectStore_Exists(store_, 1, 1, -1));
+    EXPECT_FALSE(ObjectStore_Exists(store_, 1, 0, 1));
+    EXPECT_FALSE(ObjectStore_Exists(store_, -1, -1, -1));
+}
+
+TEST_F(ObjectStoreTestSuite, test_instances_and_resources_are_returned_in_creation_order)
+{
+    ObjectInstanceIDType instances[] = { 5, 2, 9, 0 };
+    for (size_t i = 0; i < sizeof(instances) / sizeof(instances[0]); i++)
+    {
+        ASSERT_EQ(instances[i], ObjectStore_CreateObjectInstance(store_, 3303, instances[i], 10));
+    }
+    ResourceIDType resources[] = { 5700, 5601, 5602 };
+    for (size_t i = 0; i < sizeof(resources) / sizeof(resources[0]); i++)
+    {
+        ASSERT_EQ(resources[i], ObjectStore_CreateResource(store_, 3303, 2, resources[i]));
+    }
+
+    EXPECT_EQ(4, ObjectStore_GetObjectNumInstances(store_, 3303));
+    ObjectInstanceIDType instanceID = -1;
+    for (size_t i = 0; i < sizeof(instances) / sizeof(instances[0]); i++)
+    {
+        instanceID = ObjectStore_GetNextObjectInstanceID(store_, 3303, instanceID);
+        EXPECT_EQ(instances[i], instanceID);
+    }
+    EXPECT_EQ(-1, ObjectStore_GetNextObjectInstanceID(store_, 3303, instanceID));
+    EXPECT_EQ(-1, ObjectStore_GetNextObjectInstanceID(store_, 3303, 7));
+
+    EXPECT_EQ(3, ObjectStore_GetInstanceNumResources(store_, 3303, 2));
+    ResourceIDType resourceID = -1;
+    for (size_t i = 0; i < sizeof(resources) / sizeof(resources[0]); i++)
+    {
+        resourceID = ObjectStore_GetNextResourceID(store_, 3303, 2, resourceID);
+        EXPECT_EQ(resources[i], resourceID);
+    }
+    EXPECT_EQ(-1, ObjectStore_GetNextResourceID(store_, 3303, 2, resourceID));
+}
+
+TEST_F(ObjectStoreTestSuite, test_resource_instances_are_returned_in_id_order)
+{
+    ASSERT_EQ(0, ObjectStore_CreateObjectInstance(store_, 3, 0, 1));
+    ASSERT_EQ(7, ObjectStore_CreateResource(store_, 3, 0, 7));
+    ResourceInstanceIDType ids[] = { 4, 1, 3, 0, 2 };
+    for (size_t i = 0; i < sizeof(ids) / sizeof(ids[0]); i++)
+    {
+        ASSERT_EQ(static_cast<int>(sizeof(int64_t)), SetInteger(3, 0, 7, ids[i], ids[i] * 10));
+    }
+
+    EXPECT_EQ(5, ObjectStore_GetResourceNumInstances(store_, 3, 0, 7));
+    ResourceInstanceIDType id = -1;
+    for (int expected = 0; expected < 5; expected++)
+    {
+        id = ObjectStore_GetNextResourceInstanceID(store_, 3, 0, 7, id);
+        ASSERT_EQ(expected, id);
+
+        const void * value = NULL;
+        size_t size = 0;
+        ASSERT_EQ(static_cast<int>(sizeof(int64_t)), ObjectStore_GetResourceInstanceValue(store_, 3, 0, 7, id, &value, &size));
+        EXPECT_EQ(expected * 10, *static_cast<const int64_t *>(value));
+    }
+    EXPECT_EQ(-1, ObjectStore_GetNextResourceInstanceID(store_, 3, 0, 7, id));
+
+    EXPECT_EQ(0, ObjectStore_Delete(store_, 3, 0, 7, 2));
+    EXPECT_EQ(-1, ObjectStore_Delete(store_, 3, 0, 7, 2));
+    EXPECT_EQ(3, ObjectStore_GetNextResourceInstanceID(store_, 3, 0, 7, 1));
+    EXPECT_EQ(-1, ObjectStore_GetNextResourceInstanceID(store_, 3, 0, 7, 2));
+    EXPECT_EQ(4, ObjectStore_GetResourceNumInstances(store_, 3, 0, 7));
+}
+
+TEST_F(ObjectStoreTestSuite, test_delete_keeps_remaining_order)
+{
+    for (int i = 0; i < 5; i++)
+    {
+        ASSERT_EQ(i, ObjectStore_CreateObjectInstance(store_, 3303, -1, 10));
+        ASSERT_EQ(5700, ObjectStore_CreateResource(store_, 3303, i, 5700));
+        ASSERT_EQ(static_cast<int>(sizeof(int64_t)), SetInteger(3303, i, 5700, 0, i));
+    }
+
+    EXPECT_EQ(0, ObjectStore_Delete(store_, 3303, 1, -1, -1));
+    EXPECT_EQ(-1, ObjectStore_Delete(store_, 3303, 1, -1, -1));
+    EXPECT_FALSE(ObjectStore_Exists(store_, 3303, 1, 5700));
+    EXPECT_EQ(4, ObjectStore_GetObjectNumInstances(store_, 3303));
+    EXPECT_EQ(2, ObjectStore_GetNextObjectInstanceID(store_, 3303, 0));
+    EXPECT_EQ(3, ObjectStore_GetNextObjectInstanceID(store_, 3303, 2));
+
+    // a freed ID is reused for the next generated instance, and is appended
+    EXPECT_EQ(1, ObjectStore_CreateObjectInstance(store_, 3303, -1, 10));
+    EXPECT_EQ(1, ObjectStore_GetNextObjectInstanceID(store_, 3303, 4));
+
+    EXPECT_EQ(0, ObjectStore_Delete(store_, 3303, 3, 5700, -1));
+    EXPECT_FALSE(ObjectStore_Exists(store_, 3303, 3, 5700));
+    EXPECT_TRUE(ObjectStore_Exists(store_, 3303, 3, -1));
+
+    // deleting the object removes its instances but keeps the object
+    EXPECT_EQ(0, ObjectStore_Delete(store_, 3303, -1, -1, -1));
+    EXPECT_TRUE(ObjectStore_Exists(store_, 3303, -1, -1));
+    EXPECT_EQ(0, ObjectStore_GetObjectNumInstances(store_, 3303));
+    EXPECT_FALSE(ObjectStore_Exists(store_, 3303, 4, 5700));
+    EXPECT_EQ(0, ObjectStore_CreateObjectInstance(store_, 3303, 0, 10));
+}
+
+TEST_F(ObjectStoreTestSuite, test_create_object_instance_limits)
+{
+    EXPECT_EQ(0, ObjectStore_CreateObjectInstance(store_, 3, 0, 1));
+    EXPECT_EQ(-1, ObjectStore_CreateObjectInstance(store_, 3, 1, 1));
+    EXPECT_EQ(AwaResult_MethodNotAllowed, AwaResult_GetLastResult());
+    EXPECT_EQ(0, ObjectStore_CreateObjectInstance(store_, 4, 0, 2));
+    EXPECT_EQ(-1, ObjectStore_CreateObjectInstance(store_, 4, 0, 2));
+    EXPECT_EQ(AwaResult_MethodNotAllowed, AwaResult_GetLastResult());
+}
+
+TEST_F(ObjectStoreTestSuite, test_many_instances)
+{
+    const int numInstances = 2000;
+    for (int i = 0; i < numInstances; i++)
+    {
+        ASSERT_EQ(i, ObjectStore_CreateObjectInstance(store_, 3303, i, numInstances));
+        ASSERT_EQ(5700, ObjectStore_CreateResource(store_, 3303, i, 5700));
+        ASSERT_EQ(static_cast<int>(sizeof(int64_t)), SetInteger(3303, i, 5700, 0, i));
+    }
+    for (int i = 0; i < numInstances; i += 2)
+    {
+        ASSERT_EQ(0, ObjectStore_Delete(store_, 3303, i, -1, -1));
+    }
+    EXPECT_EQ(numInstances / 2, ObjectStore_GetObjectNumInstances(store_, 3303));
+
+    int count = 0;
+    ObjectInstanceIDType id = -1;
+    while ((id = ObjectStore_GetNextObjectInstanceID(store_, 3303, id)) != -1)
+    {
+        const void * value = NULL;
+        size_t size = 0;
+        ASSERT_EQ(1, id % 2);
+        ASSERT_EQ(static_cast<int>(sizeof(int64_t)), ObjectStore_GetResourceInstanceValue(store_, 3303, id, 5700, 0, &value, &size));
+        ASSERT_EQ(id, *static_cast<const int64_t *>(value));
+        count++;
+    }
+    EXPECT_EQ(numInstances / 2, count);
+}
+
+TEST_F(ObjectStoreTestSuite, test_iterator_visits_each_level)
+{
+    ASSERT_EQ(4, ObjectStore_CreateObjectInstance(store_, 3303, 4, 10));
+    ASSERT_EQ(1, ObjectStore_CreateObjectInstance(store_, 3303, 1, 10));
+    ASSERT_EQ(0, ObjectStore_CreateObjectInstance(store_, 3, 0, 1));
+    ASSERT_EQ(5700, ObjectStore_CreateResource(store_, 3303, 1, 5700));
+    ASSERT_EQ(5601, ObjectStore_CreateResource(store_, 3303, 1, 5601));
+    ASSERT_EQ(static_cast<int>(sizeof(int64_t)), SetInteger(3303, 1, 5700, 2, 20));
+    ASSERT_EQ(static_cast<int>(sizeof(int64_t)), SetInteger(3303, 1, 5700, 0, 0));
+
+    ObjectStoreIterator iterator;
+    ASSERT_EQ(0, ObjectStore_InitIterator(store_, &iterator, -1, -1, -1));
+    EXPECT_EQ(3303, ObjectStore_IteratorNext(&iterator));
+    EXPECT_EQ(3, ObjectStore_IteratorNext(&iterator));
+    EXPECT_EQ(-1, ObjectStore_IteratorNext(&iterator));
+
+    ASSERT_EQ(0, ObjectStore_InitIterator(store_, &iterator, 3303, -1, -1));
+    EXPECT_EQ(4, ObjectStore_IteratorNext(&iterator));
+    EXPECT_EQ(1, ObjectStore_IteratorNext(&iterator));
+    EXPECT_EQ(-1, ObjectStore_IteratorNext(&iterator));
+
+    ASSERT_EQ(0, ObjectStore_InitIterator(store_, &iterator, 3303, 1, -1));
+    EXPECT_EQ(5700, ObjectStore_IteratorNext(&iterator));
+    EXPECT_EQ(5601, ObjectStore_IteratorNext(&iterator));
+    EXPECT_EQ(-1, ObjectStore_IteratorNext(&iterator));
+
+    // values may be changed during a walk
+    ASSERT_EQ(0, ObjectStore_InitIterator(store_, &iterator, 3303, 1, 5700));
+    EXPECT_EQ(0, ObjectStore_IteratorNext(&iterator));
+    ASSERT_EQ(static_cast<int>(sizeof(int64_t)), SetInteger(3303, 1, 5700, 2, 21));
+    EXPECT_EQ(2, ObjectStore_IteratorNext(&iterator));
+    EXPECT_EQ(-1, ObjectStore_IteratorNext(&iterator));
+
+    ASSERT_EQ(0, ObjectStore_InitIterator(store_, &iterator, 3303, 4, -1));
+    EXPECT_EQ(-1, ObjectStore_IteratorNext(&iterator));
+}
+
+TEST_F(ObjectStoreTestSuite, test_iterator_on_missing_path)
+{
+    ASSERT_EQ(0, ObjectStore_CreateObjectInstance(store_, 3, 0, 1));
+
+    ObjectStoreIterator iterator;
+    EXPECT_EQ(-1, ObjectStore_InitIterator(store_, &iterator, 4, -1, -1));
+    EXPECT_EQ(AwaResult_NotFound, AwaResult_GetLastResult());
+    EXPECT_EQ(-1, ObjectStore_IteratorNext(&iterator));
+    EXPECT_EQ(-1, ObjectStore_InitIterator(store_, &iterator, 3, 1, -1));
+    EXPECT_EQ(-1, ObjectStore_IteratorNext(&iterator));
+    EXPECT_EQ(-1, ObjectStore_InitIterator(store_, &iterator, 3, 0, 9));
+    EXPECT_EQ(-1, ObjectStore_IteratorNext(&iterator));
+    EXPECT_EQ(-1, ObjectStore_InitIterator(store_, &iterator, 3, -1, 0));
+    EXPECT_EQ(-1, ObjectStore_IteratorNext(&iterator));
+}
+
+TEST_F(ObjectStoreTestSuite, test_value_moves_between_inline_and_heap_storage)
+{
+    ASSERT_EQ(0, ObjectStore_CreateObjectInstance(store_, 3, 0, 1));
+    ASSERT_EQ(0, ObjectStore_CreateResource(store_, 3, 0, 0));
+
+    const char * shortValue = "Imagination";
+    std::string longValue(200, 'x');
+    bool changed = false;
+    const void * stored = NULL;
+    size_t storedSize = 0;
+
+    ASSERT_EQ(static_cast<int>(strlen(shortValue)), ObjectStore_SetResourceInstanceValue(store_, 3, 0, 0, 0, strlen(shortValue), shortValue, 0, strlen(shortValue), &changed));
+    ASSERT_EQ(static_cast<int>(strlen(shortValue)), ObjectStore_GetResourceInstanceValue(store_, 3, 0, 0, 0, &stored, &storedSize));
+    EXPECT_EQ(0, memcmp(shortValue, stored, storedSize));
+
+    ASSERT_EQ(static_cast<int>(longValue.size()), ObjectStore_SetResourceInstanceValue(store_, 3, 0, 0, 0, longValue.size(), longValue.data(), 0, longValue.size(), &changed));
+    EXPECT_TRUE(changed);
+    ASSERT_EQ(static_cast<int>(longValue.size()), ObjectStore_GetResourceInstanceValue(store_, 3, 0, 0, 0, &stored, &storedSize));
+    EXPECT_EQ(0, memcmp(longValue.data(), stored, storedSize));
+
+    // a value written in parts keeps its size, and is zeroed when the size changes
+    ASSERT_EQ(1, ObjectStore_SetResourceInstanceValue(store_, 3, 0, 0, 0, 4, "a", 2, 1, &changed));
+    ASSERT_EQ(4, ObjectStore_GetResourceInstanceValue(store_, 3, 0, 0, 0, &stored, &storedSize));
+    EXPECT_EQ(0, memcmp("\0\0a\0", stored, 4));
+
+    ASSERT_EQ(0, ObjectStore_SetResourceInstanceValue(store_, 3, 0, 0, 0, 0, "", 0, 0, &changed));
+    EXPECT_EQ(0, ObjectStore_GetResourceInstanceLength(store_, 3, 0, 0, 0));
+}
+
+TEST_F(ObjectStoreTestSuite, test_mixed_value_sizes_survive_instance_changes)
+{
+    ASSERT_EQ(0, ObjectStore_CreateObjectInstance(store_, 3, 0, 1));
+    ASSERT_EQ(7, ObjectStore_CreateResource(store_, 3, 0, 7));
+
+    std::string values[6];
+    for (int i = 5; i >= 0; i--)
+    {
+        bool changed = false;
+        values[i] = std::string((i % 2) ? 100 : 4, 'a' + i);
+        ASSERT_EQ(static_cast<int>(values[i].size()), ObjectStore_SetResourceInstanceValue(store_, 3, 0, 7, i, values[i].size(), values[i].data(), 0, values[i].size(), &changed));
+    }
+    ASSERT_EQ(0, ObjectStore_Delete(store_, 3, 0, 7, 2));
+    ASSERT_EQ(0, ObjectStore_Delete(store_, 3, 0, 7, 3));
+
+    for (int i = 0; i < 6; i++)
+    {
+        const void * stored = NULL;
+        size_t storedSize = 0;
+        if ((i == 2) || (i == 3))
+        {
+            EXPECT_EQ(-1, ObjectStore_GetResourceInstanceValue(store_, 3, 0, 7, i, &stored, &storedSize));
+            continue;
+        }
+        ASSERT_EQ(static_cast<int>(values[i].size()), ObjectStore_GetResourceInstanceValue(store_, 3, 0, 7, i, &stored, &storedSize));
+        EXPECT_EQ(values[i], std::string(static_cast<const char *>(stored), storedSize));
+    }
+}
@@ -65,3 +65,49 @@ TEST_F(ObjectTreeTestSuite, test_add_object)
 
 
 
+
+TEST_F(ObjectTreeTestSuite, test_child_iterator)
+{
+    Lwm2mObjectTree objectTree;
+    Lwm2mObjectTreeChildIterator iterator;
+
+    Lwm2mObjectTree_Init(&objectTree);
+
+    ASSERT_EQ(0, Lwm2mObjectTree_AddObjectInstance(&objectTree, 3, 0));
+    ASSERT_EQ(0, Lwm2mObjectTree_AddResourceInstance(&objectTree, 1000, 0, 5, 2));
+    ASSERT_EQ(0, Lwm2mObjectTree_AddResourceInstance(&objectTree, 1000, 0, 5, 0));
+    ASSERT_EQ(0, Lwm2mObjectTree_AddResourceInstance(&objectTree, 1000, 0, 5, 1));
+    ASSERT_EQ(0, Lwm2mObjectTree_AddResource(&objectTree, 1000, 0, 1));
+
+    // objects
+    ASSERT_EQ(0, Lwm2mObjectTree_InitChildIterator(&iterator, &objectTree, -1, -1, -1));
+    EXPECT_EQ(3, Lwm2mObjectTree_ChildIteratorNext(&iterator));
+    EXPECT_EQ(1000, Lwm2mObjectTree_ChildIteratorNext(&iterator));
+    EXPECT_EQ(-1, Lwm2mObjectTree_ChildIteratorNext(&iterator));
+
+    // resources of an object instance, in ID order
+    ASSERT_EQ(0, Lwm2mObjectTree_InitChildIterator(&iterator, &objectTree, 1000, 0, -1));
+    EXPECT_EQ(1, Lwm2mObjectTree_ChildIteratorNext(&iterator));
+    EXPECT_EQ(5, Lwm2mObjectTree_ChildIteratorNext(&iterator));
+    EXPECT_EQ(-1, Lwm2mObjectTree_ChildIteratorNext(&iterator));
+
+    // the child last returned may be deleted
+    ASSERT_EQ(0, Lwm2mObjectTree_InitChildIterator(&iterator, &objectTree, 1000, 0, 5));
+    int resourceInstanceID;
+    int count = 0;
+    while ((resourceInstanceID = Lwm2mObjectTree_ChildIteratorNext(&iterator)) != -1)
+    {
+        EXPECT_EQ(count++, resourceInstanceID);
+        ASSERT_EQ(0, Lwm2mObjectTree_DeleteResourceInstance(&objectTree, 1000, 0, 5, resourceInstanceID));
+    }
+    EXPECT_EQ(3, count);
+    EXPECT_FALSE(Lwm2mObjectTree_Exists(&objectTree, 1000, 0, 5, 0));
+
+    ASSERT_EQ(-1, Lwm2mObjectTree_InitChildIterator(&iterator, &objectTree, 1000, 1, -1));
+    EXPECT_EQ(-1, Lwm2mObjectTree_ChildIteratorNext(&iterator));
+    ASSERT_EQ(-1, Lwm2mObjectTree_InitChildIterator(&iterator, &objectTree, 1000, -1, 5));
+    EXPECT_EQ(-1, Lwm2mObjectTree_ChildIteratorNext(&iterator));
+    ASSERT_EQ(-1, Lwm2mObjectTree_InitChildIterator(&iterator, NULL, -1, -1, -1));
+
+    ASSERT_EQ(0, Lwm2mObjectTree_Destroy(&objectTree));
+}
@@ -64,7 +64,7 @@ TEST_F(PlainTextTestSuite, test_serialise_string)
 
     Lwm2mTreeNode * dest;
     int OIR[] = {0,0,0};
-    TreeBuilder_CreateTreeFromOIR(&dest, context, Lwm2mRequestOrigin_Client, OIR, 3);
+    TreeBuilder_CreateTreeFromOIR(&dest, NULL, context, Lwm2mRequestOrigin_Client, OIR, 3);
     
     SerdesContext serdesContext;
     int len = PTSerialiseResource(&serdesContext, dest, 0, 0, 0, buffer, sizeof(buffer));
@@ -88,7 +88,7 @@ TEST_F(PlainTextTestSuite, test_deserialise_string)
 
     Lwm2mTreeNode * dest;
     SerdesContext serdesContext;
-    int result = PTDeserialiseResource(&serdesContext, &dest, Lwm2mCore_GetDefinitions(context), 0, 0, 0, (const uint8_t * )expected, strlen(expected));
+    int result = PTDeserialiseResource(&serdesContext, &dest, NULL, Lwm2mCore_GetDefinitions(context), 0, 0, 0, (const uint8_t * )expected, strlen(expected));
 
     Lwm2mTreeNode * resourceInstanceNode = Lwm2mTreeNode_GetFirstChild(dest);
 
@@ -118,7 +118,7 @@ TEST_F(PlainTextTestSuite, test_serialise_float)
 
     Lwm2mTreeNode * dest;
     int OIR[] = {0,0,0};
-    TreeBuilder_CreateTreeFromOIR(&dest, context, Lwm2mRequestOrigin_Client, OIR, 3);
+    TreeBuilder_CreateTreeFromOIR(&dest, NULL, context, Lwm2mRequestOrigin_Client, OIR, 3);
 
     SerdesContext serdesContext;
     PTSerialiseResource(&serdesContext, dest, 0, 0, 0, buffer, sizeof(buffer));
@@ -143,7 +143,7 @@ TEST_F(PlainTextTestSuite, test_deserialise_float)
 
     Lwm2mTreeNode * dest;
     SerdesContext serdesContext;
-    int result = PTDeserialiseResource(&serdesContext, &dest, Lwm2mCore_GetDefinitions(context), 0, 0, 0, (const uint8_t * )buffer, strlen(buffer));
+    int result = PTDeserialiseResource(&serdesContext, &dest, NULL, Lwm2mCore_GetDefinitions(context), 0, 0, 0, (const uint8_t * )buffer, strlen(buffer));
 
     Lwm2mTreeNode * resourceInstanceNode = Lwm2mTreeNode_GetFirstChild(dest);
 
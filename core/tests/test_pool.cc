@@ -0,0 +1,128 @@
+/************************************************************************************************************************
+ Copyright (c) 2016, Imagination Technologies Limited and/or its affiliated group companies.
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+ following conditions are met:
+     1. Redistributions of source code must retain the above copyright notice, this list of conditions and the
+        following disclaimer.
+     2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the
+        following disclaimer in the documentation and/or other materials provided with the distribution.
+     3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote
+        products derived from this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+ USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+************************************************************************************************************************/
+
+
+#include <gtest/gtest.h>
+#include <stdint.h>
+#include <string.h>
+#include <vector>
+
+#include "lwm2m_pool.h"
+
+typedef struct
+{
+    uint8_t Data[100];
+} PoolObject;
+
+TEST(MemoryPoolTestSuite, test_alloc_and_free)
+{
+    MemoryPool pool;
+    MemoryPoolStats stats;
+    MemoryPool_Init(&pool, sizeof(PoolObject), 0, 4);
+
+    PoolObject * object = (PoolObject *)MemoryPool_Alloc(&pool);
+    ASSERT_TRUE(NULL != object);
+    memset(object, 0xA5, sizeof(PoolObject));
+
+    MemoryPool_GetStats(&pool, &stats);
+    EXPECT_EQ(1u, stats.InUse);
+    EXPECT_EQ(1u, stats.Peak);
+    EXPECT_EQ(1u, stats.Allocations);
+    EXPECT_EQ(0u, stats.Reused);
+
+    MemoryPool_Free(&pool, object);
+    MemoryPool_GetStats(&pool, &stats);
+    EXPECT_EQ(0u, stats.InUse);
+    EXPECT_EQ(1u, stats.Free);
+
+    MemoryPool_Destroy(&pool);
+}
+
+TEST(MemoryPoolTestSuite, test_freed_objects_are_reused)
+{
+    MemoryPool pool;
+    MemoryPoolStats stats;
+    MemoryPool_Init(&pool, sizeof(PoolObject), 0, 4);
+
+    void * first = MemoryPool_Alloc(&pool);
+    MemoryPool_Free(&pool, first);
+    void * second = MemoryPool_Alloc(&pool);
+    EXPECT_EQ(first, second);
+
+    MemoryPool_GetStats(&pool, &stats);
+    EXPECT_EQ(1u, stats.Reused);
+    EXPECT_EQ(0u, stats.Free);
+
+    MemoryPool_Free(&pool, second);
+    MemoryPool_Destroy(&pool);
+}
+
+TEST(MemoryPoolTestSuite, test_max_objects_limits_allocation)
+{
+    MemoryPool pool;
+    MemoryPoolStats stats;
+    MemoryPool_Init(&pool, sizeof(PoolObject), 2, 4);
+
+    void * first = MemoryPool_Alloc(&pool);
+    void * second = MemoryPool_Alloc(&pool);
+    ASSERT_TRUE(NULL != first);
+    ASSERT_TRUE(NULL != second);
+    EXPECT_TRUE(NULL == MemoryPool_Alloc(&pool));
+
+    MemoryPool_GetStats(&pool, &stats);
+    EXPECT_EQ(1u, stats.AllocationFailures);
+    EXPECT_EQ(2u, stats.Peak);
+
+    MemoryPool_Free(&pool, first);
+    void * third = MemoryPool_Alloc(&pool);
+    EXPECT_TRUE(NULL != third);
+
+    MemoryPool_Free(&pool, second);
+    MemoryPool_Free(&pool, third);
+    MemoryPool_Destroy(&pool);
+}
+
+TEST(MemoryPoolTestSuite, test_max_free_limits_retained_objects)
+{
+    MemoryPool pool;
+    MemoryPoolStats stats;
+    std::vector<void *> objects;
+    MemoryPool_Init(&pool, sizeof(PoolObject), 0, 4);
+
+    for (int i = 0; i < 10; i++)
+    {
+        objects.push_back(MemoryPool_Alloc(&pool));
+    }
+    for (size_t i = 0; i < objects.size(); i++)
+    {
+        MemoryPool_Free(&pool, objects[i]);
+    }
+
+    MemoryPool_GetStats(&pool, &stats);
+    EXPECT_EQ(0u, stats.InUse);
+    EXPECT_EQ(10u, stats.Peak);
+    EXPECT_EQ(4u, stats.Free);
+
+    MemoryPool_Destroy(&pool);
+    MemoryPool_GetStats(&pool, &stats);
+    EXPECT_EQ(0u, stats.Free);
+}
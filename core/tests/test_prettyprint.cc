@@ -65,7 +65,7 @@ TEST_F(PrettyPrintTestSuite, test_serialise_string)
 
     Lwm2mTreeNode * dest;
     int OIR[] = {0};
-    TreeBuilder_CreateTreeFromOIR(&dest, context, Lwm2mRequestOrigin_Client, OIR, 1);
+    TreeBuilder_CreateTreeFromOIR(&dest, NULL, context, Lwm2mRequestOrigin_Client, OIR, 1);
 
     SerdesContext serdesContext;
     int len = PPSerialiseObject(&serdesContext, dest, 0, (uint8_t * )buffer, sizeof(buffer));
@@ -96,7 +96,7 @@ TEST_F(PrettyPrintTestSuite, test_serialise_string_multiple)
 
     Lwm2mTreeNode * dest;
     int OIR[] = {0};
-    TreeBuilder_CreateTreeFromOIR(&dest, context, Lwm2mRequestOrigin_Client, OIR, 1);
+    TreeBuilder_CreateTreeFromOIR(&dest, NULL, context, Lwm2mRequestOrigin_Client, OIR, 1);
 
     SerdesContext serdesContext;
     int len = PPSerialiseObject(&serdesContext, dest, 0, (uint8_t * )buffer, sizeof(buffer));
@@ -123,7 +123,7 @@ TEST_F(PrettyPrintTestSuite, test_multiple_object_instance)
 
     Lwm2mTreeNode * dest;
     int OIR[] = {15};
-    TreeBuilder_CreateTreeFromOIR(&dest, context, Lwm2mRequestOrigin_Client, OIR, 1);
+    TreeBuilder_CreateTreeFromOIR(&dest, NULL, context, Lwm2mRequestOrigin_Client, OIR, 1);
 
     uint8_t buffer[512];
     memset(buffer, 0, sizeof(buffer));
@@ -0,0 +1,114 @@
+/************************************************************************************************************************
+ Copyright (c) 2016, Imagination Technologies Limited and/or its affiliated group companies.
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+ following conditions are met:
+     1. Redistributions of source code must retain the above copyright notice, this list of conditions and the
+        following disclaimer.
+     2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the
+        following disclaimer in the documentation and/or other materials provided with the distribution.
+     3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote
+        products derived from this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+ USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+************************************************************************************************************************/
+
+#include <gtest/gtest.h>
+#include <pthread.h>
+#include <stdint.h>
+
+#include "lwm2m_ring_queue.h"
+
+class RingQueueTestSuite : public testing::Test
+{
+protected:
+    void SetUp()
+    {
+        ASSERT_EQ(0, RingQueue_Init(&queue_, 6));
+    }
+
+    void TearDown()
+    {
+        RingQueue_Destroy(&queue_);
+    }
+
+    RingQueue queue_;
+};
+
+TEST_F(RingQueueTestSuite, test_capacity_is_rounded_up_to_a_power_of_two)
+{
+    EXPECT_EQ(8u, RingQueue_Capacity(&queue_));
+}
+
+TEST_F(RingQueueTestSuite, test_pop_returns_entries_in_order_and_push_fails_when_full)
+{
+    int values[9];
+    EXPECT_EQ(NULL, RingQueue_Pop(&queue_));
+    for (int i = 0; i < 8; i++)
+    {
+        EXPECT_TRUE(RingQueue_Push(&queue_, &values[i]));
+    }
+    EXPECT_FALSE(RingQueue_Push(&queue_, &values[8]));
+    EXPECT_EQ(8u, RingQueue_Count(&queue_));
+
+    for (int i = 0; i < 8; i++)
+    {
+        EXPECT_EQ(&values[i], RingQueue_Pop(&queue_));
+    }
+    EXPECT_EQ(NULL, RingQueue_Pop(&queue_));
+    EXPECT_EQ(0u, RingQueue_Count(&queue_));
+}
+
+TEST_F(RingQueueTestSuite, test_indices_wrap_around)
+{
+    int value;
+    for (int i = 0; i < 100; i++)
+    {
+        ASSERT_TRUE(RingQueue_Push(&queue_, &value));
+        ASSERT_EQ(&value, RingQueue_Pop(&queue_));
+    }
+    EXPECT_EQ(0u, RingQueue_Count(&queue_));
+}
+
+#define NUM_TRANSFERS (100000)
+
+static void * Produce(void * context)
+{
+    RingQueue * queue = (RingQueue *)context;
+    for (uintptr_t i = 1; i <= NUM_TRANSFERS; i++)
+    {
+        while (!RingQueue_Push(queue, (void *)i))
+        {
+            sched_yield();
+        }
+    }
+    return NULL;
+}
+
+TEST_F(RingQueueTestSuite, test_entries_pass_between_threads_in_order)
+{
+    pthread_t producer;
+    ASSERT_EQ(0, pthread_create(&producer, NULL, Produce, &queue_));
+
+    uintptr_t expected = 1;
+    while (expected <= NUM_TRANSFERS)
+    {
+        void * entry = RingQueue_Pop(&queue_);
+        if (entry == NULL)
+        {
+            sched_yield();
+            continue;
+        }
+        ASSERT_EQ(expected, (uintptr_t)entry);
+        expected++;
+    }
+    pthread_join(producer, NULL);
+    EXPECT_EQ(NULL, RingQueue_Pop(&queue_));
+}
@@ -0,0 +1,112 @@
+/************************************************************************************************************************
+ Copyright (c) 2016, Imagination Technologies Limited and/or its affiliated group companies.
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+ following conditions are met:
+     1. Redistributions of source code must retain the above copyright notice, this list of conditions and the
+        following disclaimer.
+     2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the
+        following disclaimer in the documentation and/or other materials provided with the distribution.
+     3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote
+        products derived from this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, 
+ SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, 
+ WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE 
+ USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+************************************************************************************************************************/
+
+#include <gtest/gtest.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "lwm2m_timer_queue.h"
+
+class TimerQueueTestSuite : public testing::Test
+{
+protected:
+    void SetUp() { TimerQueue_Init(&queue_); }
+    void TearDown() { TimerQueue_Destroy(&queue_); }
+
+    TimerQueue queue_;
+};
+
+TEST_F(TimerQueueTestSuite, test_empty_queue)
+{
+    EXPECT_TRUE(NULL == TimerQueue_Peek(&queue_));
+    EXPECT_TRUE(NULL == TimerQueue_PopExpired(&queue_, UINT64_MAX));
+    EXPECT_EQ(-1, TimerQueue_GetTimeout(&queue_, 0));
+}
+
+TEST_F(TimerQueueTestSuite, test_pop_in_deadline_order)
+{
+    const int count = 500;
+    TimerQueueNode nodes[count];
+    srand(1);
+    for (int i = 0; i < count; i++)
+    {
+        TimerQueue_InitNode(&nodes[i]);
+        ASSERT_EQ(0, TimerQueue_Schedule(&queue_, &nodes[i], 1000 + rand() % 10000));
+    }
+    EXPECT_EQ(static_cast<size_t>(count), TimerQueue_Count(&queue_));
+
+    uint64_t last = 0;
+    TimerQueueNode * node;
+    int popped = 0;
+    while ((node = TimerQueue_PopExpired(&queue_, UINT64_MAX)) != NULL)
+    {
+        EXPECT_LE(last, node->Deadline);
+        EXPECT_FALSE(TimerQueue_IsScheduled(node));
+        last = node->Deadline;
+        popped++;
+    }
+    EXPECT_EQ(count, popped);
+}
+
+TEST_F(TimerQueueTestSuite, test_pop_expired_only_returns_due_nodes)
+{
+    TimerQueueNode early, late;
+    TimerQueue_InitNode(&early);
+    TimerQueue_InitNode(&late);
+    ASSERT_EQ(0, TimerQueue_Schedule(&queue_, &late, 200));
+    ASSERT_EQ(0, TimerQueue_Schedule(&queue_, &early, 100));
+
+    EXPECT_EQ(50, TimerQueue_GetTimeout(&queue_, 50));
+    EXPECT_TRUE(NULL == TimerQueue_PopExpired(&queue_, 99));
+    EXPECT_EQ(&early, TimerQueue_PopExpired(&queue_, 100));
+    EXPECT_TRUE(NULL == TimerQueue_PopExpired(&queue_, 150));
+    EXPECT_EQ(0, TimerQueue_GetTimeout(&queue_, 250));
+    EXPECT_EQ(&late, TimerQueue_PopExpired(&queue_, 250));
+}
+
+TEST_F(TimerQueueTestSuite, test_reschedule_and_cancel)
+{
+    TimerQueueNode a, b, c;
+    TimerQueue_InitNode(&a);
+    TimerQueue_InitNode(&b);
+    TimerQueue_InitNode(&c);
+    ASSERT_EQ(0, TimerQueue_Schedule(&queue_, &a, 100));
+    ASSERT_EQ(0, TimerQueue_Schedule(&queue_, &b, 200));
+    ASSERT_EQ(0, TimerQueue_Schedule(&queue_, &c, 300));
+
+    // push the earliest timer to the back
+    ASSERT_EQ(0, TimerQueue_Schedule(&queue_, &a, 400));
+    EXPECT_EQ(3u, TimerQueue_Count(&queue_));
+    EXPECT_EQ(&b, TimerQueue_Peek(&queue_));
+
+    TimerQueue_Cancel(&queue_, &b);
+    EXPECT_FALSE(TimerQueue_IsScheduled(&b));
+    EXPECT_EQ(&c, TimerQueue_Peek(&queue_));
+
+    // cancelling twice is harmless
+    TimerQueue_Cancel(&queue_, &b);
+    EXPECT_EQ(2u, TimerQueue_Count(&queue_));
+
+    // bring the last timer to the front
+    ASSERT_EQ(0, TimerQueue_Schedule(&queue_, &a, 10));
+    EXPECT_EQ(&a, TimerQueue_Peek(&queue_));
+}
@@ -60,7 +60,7 @@ void TlvTestSuite::test_with_without_object_instance_header_common(const uint8_t
 
     Lwm2mTreeNode * dest;
     SerdesContext serdesContext;
-    int len = TlvDeserialiseObjectInstance(&serdesContext, &dest, Lwm2mCore_GetDefinitions(context), objectID, objectInstanceID, input, inputSize);
+    int len = TlvDeserialiseObjectInstance(&serdesContext, &dest, NULL, Lwm2mCore_GetDefinitions(context), objectID, objectInstanceID, input, inputSize);
     EXPECT_EQ(static_cast<int>(inputSize), len);
     EXPECT_EQ(19, Lwm2mTreeNode_GetChildCount(dest));
     Lwm2mTreeNode * child = Lwm2mTreeNode_GetFirstChild(dest);
@@ -137,7 +137,7 @@ TEST_F(TlvTestSuite, test_deserialise_single_object_instance_with_unnecessary_ob
 
     Lwm2mTreeNode * dest; 
     SerdesContext serdesContext;
-    int len = TlvDeserialiseObjectInstance(&serdesContext, &dest, Lwm2mCore_GetDefinitions(context), objectID, objectInstanceID, input, sizeof(input));
+    int len = TlvDeserialiseObjectInstance(&serdesContext, &dest, NULL, Lwm2mCore_GetDefinitions(context), objectID, objectInstanceID, input, sizeof(input));
     EXPECT_EQ(-1, len);
     Lwm2mTreeNode_DeleteRecursive(dest);
 }
@@ -178,7 +178,7 @@ TEST_F(TlvTestSuite, test_serialise_string)
 
     Lwm2mTreeNode * dest;
     int OIR[] = {0};
-    TreeBuilder_CreateTreeFromOIR(&dest, context, Lwm2mRequestOrigin_Client, OIR, 1);
+    TreeBuilder_CreateTreeFromOIR(&dest, NULL, context, Lwm2mRequestOrigin_Client, OIR, 1);
 
     //TODO: change other tests to use single instance of an object.
     SerdesContext serdesContext;
@@ -202,7 +202,7 @@ TEST_F(TlvTestSuite, test_small_outputbuffer)
 
     Lwm2mTreeNode * dest;
     int OIR[] = {0};
-    TreeBuilder_CreateTreeFromOIR(&dest, context, Lwm2mRequestOrigin_Client, OIR, 1);
+    TreeBuilder_CreateTreeFromOIR(&dest, NULL, context, Lwm2mRequestOrigin_Client, OIR, 1);
 
     uint8_t buffer[15];
 
@@ -225,7 +225,7 @@ TEST_F(TlvTestSuite, test_serialise_bool)
 
     Lwm2mTreeNode * dest;
     int OIR[] = {1};
-    TreeBuilder_CreateTreeFromOIR(&dest, context, Lwm2mRequestOrigin_Client, OIR, 1);
+    TreeBuilder_CreateTreeFromOIR(&dest, NULL, context, Lwm2mRequestOrigin_Client, OIR, 1);
 
     uint8_t buffer[512];
     uint8_t expected[] = { 0x3, 0, 0xc1, 0, 1 };
@@ -249,7 +249,7 @@ TEST_F(TlvTestSuite, test_serialise_int8)
 
     Lwm2mTreeNode * dest;
     int OIR[] = {2};
-    TreeBuilder_CreateTreeFromOIR(&dest, context, Lwm2mRequestOrigin_Client, OIR, 1);
+    TreeBuilder_CreateTreeFromOIR(&dest, NULL, context, Lwm2mRequestOrigin_Client, OIR, 1);
 
     uint8_t buffer[512];
     uint8_t expected[] = { 0x3, 0, 0xc1, 0, 17 };
@@ -283,7 +283,7 @@ TEST_F(TlvTestSuite, test_serialise_negative_int8)
 
     Lwm2mTreeNode * dest;
     int OIR[] = {3};
-    TreeBuilder_CreateTreeFromOIR(&dest, context, Lwm2mRequestOrigin_Client, OIR, 1);
+    TreeBuilder_CreateTreeFromOIR(&dest, NULL, context, Lwm2mRequestOrigin_Client, OIR, 1);
 
     uint8_t buffer[512];
 
@@ -325,7 +325,7 @@ TEST_F(TlvTestSuite, test_serialise_int16)
 
     Lwm2mTreeNode * dest;
     int OIR[] = {4};
-    TreeBuilder_CreateTreeFromOIR(&dest, context, Lwm2mRequestOrigin_Client, OIR, 1);
+    TreeBuilder_CreateTreeFromOIR(&dest, NULL, context, Lwm2mRequestOrigin_Client, OIR, 1);
 
     uint8_t buffer[512];
     uint8_t expected[] = { 0x4, 0, 0xc2, 0, 0x04, 0x00 }; // type, id, msb, lsb
@@ -360,7 +360,7 @@ TEST_F(TlvTestSuite, test_serialise_negative_int16)
 
     Lwm2mTreeNode * dest;
     int OIR[] = {5};
-    TreeBuilder_CreateTreeFromOIR(&dest, context, Lwm2mRequestOrigin_Client, OIR, 1);
+    TreeBuilder_CreateTreeFromOIR(&dest, NULL, context, Lwm2mRequestOrigin_Client, OIR, 1);
 
     uint8_t buffer[512];
 #ifdef LWM2M_V1_0
@@ -401,7 +401,7 @@ TEST_F(TlvTestSuite, test_serialise_int32)
 
     Lwm2mTreeNode * dest;
     int OIR[] = {6};
-    TreeBuilder_CreateTreeFromOIR(&dest, context, Lwm2mRequestOrigin_Client, OIR, 1);
+    TreeBuilder_CreateTreeFromOIR(&dest, NULL, context, Lwm2mRequestOrigin_Client, OIR, 1);
 
     uint8_t buffer[512];
     uint8_t expected[] = { 0x6, 0, 0xc4, 0, 0x0, 0x1, 0x0, 0x0 }; // type, id, msb, .. ,lsb
@@ -435,7 +435,7 @@ TEST_F(TlvTestSuite, test_serialise_negative_int32)
 
     Lwm2mTreeNode * dest;
     int OIR[] = {7};
-    TreeBuilder_CreateTreeFromOIR(&dest, context, Lwm2mRequestOrigin_Client, OIR, 1);
+    TreeBuilder_CreateTreeFromOIR(&dest, NULL, context, Lwm2mRequestOrigin_Client, OIR, 1);
 
     uint8_t buffer[512];
 #ifdef LWM2M_V1_0
@@ -477,7 +477,7 @@ TEST_F(TlvTestSuite, test_serialise_int64)
 
     Lwm2mTreeNode * dest;
     int OIR[] = {8};
-    TreeBuilder_CreateTreeFromOIR(&dest, context, Lwm2mRequestOrigin_Client, OIR, 1);
+    TreeBuilder_CreateTreeFromOIR(&dest, NULL, context, Lwm2mRequestOrigin_Client, OIR, 1);
 
     uint8_t buffer[512];
     uint8_t expected[] = { 0x8, 0, 0xb, 0xc8, 0, 0x8, 0x0, 0x0, 0x0, 0x02, 0x00, 0x00, 0x00, 0x2c }; // type, id, msb, .. ,lsb
@@ -511,7 +511,7 @@ TEST_F(TlvTestSuite, test_serialise_negative_int64)
 
     Lwm2mTreeNode * dest;
     int OIR[] = {9};
-    TreeBuilder_CreateTreeFromOIR(&dest, context, Lwm2mRequestOrigin_Client, OIR, 1);
+    TreeBuilder_CreateTreeFromOIR(&dest, NULL, context, Lwm2mRequestOrigin_Client, OIR, 1);
 
     uint8_t buffer[512];
 #ifdef LWM2M_V1_0
@@ -551,7 +551,7 @@ TEST_F(TlvTestSuite, test_serialise_float32)
 
     Lwm2mTreeNode * dest;
     int OIR[] = {10};
-    TreeBuilder_CreateTreeFromOIR(&dest, context, Lwm2mRequestOrigin_Client, OIR, 1);
+    TreeBuilder_CreateTreeFromOIR(&dest, NULL, context, Lwm2mRequestOrigin_Client, OIR, 1);
 
     uint8_t buffer[512];
     uint8_t expected[] = { 0x6, 0, 0xc4, 0, 0x41, 0x28, 0xf5, 0xc3}; // type, id, msb, .. ,lsb
@@ -598,7 +598,7 @@ TEST_F(TlvTestSuite, test_serialise_float64)
 
     Lwm2mTreeNode * dest;
     int OIR[] = {11};
-    TreeBuilder_CreateTreeFromOIR(&dest, context, Lwm2mRequestOrigin_Client, OIR, 1);
+    TreeBuilder_CreateTreeFromOIR(&dest, NULL, context, Lwm2mRequestOrigin_Client, OIR, 1);
 
     uint8_t buffer[512];
     uint8_t expected[] = { 0x8, 0, 0xb, 0xc8, 0, 8, 0x48, 0x23, 0xff, 0xff, 0xec, 0x5b, 0x3f, 0x86 };
@@ -683,7 +683,7 @@ TEST_F(TlvTestSuite, test_no_instance)
 
     Lwm2mTreeNode * dest;
     int OIR[] = {55};
-    TreeBuilder_CreateTreeFromOIR(&dest, context, Lwm2mRequestOrigin_Client, OIR, 1);
+    TreeBuilder_CreateTreeFromOIR(&dest, NULL, context, Lwm2mRequestOrigin_Client, OIR, 1);
 
     uint8_t buffer[512];
     SerdesContext serdesContext;
@@ -705,7 +705,7 @@ TEST_F(TlvTestSuite, test_ident_8bit)
 
     Lwm2mTreeNode * dest;
     int OIR[] = {12};
-    TreeBuilder_CreateTreeFromOIR(&dest, context, Lwm2mRequestOrigin_Client, OIR, 1);
+    TreeBuilder_CreateTreeFromOIR(&dest, NULL, context, Lwm2mRequestOrigin_Client, OIR, 1);
 
     uint8_t buffer[512];
     uint8_t expected[] = { 0x3, 0, 0xc1, 1, 1 };
@@ -729,7 +729,7 @@ TEST_F(TlvTestSuite, test_ident_16bit)
 
     Lwm2mTreeNode * dest;
     int OIR[] = {13};
-    TreeBuilder_CreateTreeFromOIR(&dest, context, Lwm2mRequestOrigin_Client, OIR, 1);
+    TreeBuilder_CreateTreeFromOIR(&dest, NULL, context, Lwm2mRequestOrigin_Client, OIR, 1);
 
     uint8_t buffer[512];
     uint8_t expected[] = { 0x4, 0, 0xe1, 0x4, 0x0, 1 };
@@ -788,7 +788,7 @@ TEST_F(TlvTestSuite, test_multiple_instance_resource)
 
     Lwm2mTreeNode * dest;
     int OIR[] = {14};
-    ASSERT_EQ(AwaResult_Success, TreeBuilder_CreateTreeFromOIR(&dest, context, Lwm2mRequestOrigin_Client, OIR, 1));
+    ASSERT_EQ(AwaResult_Success, TreeBuilder_CreateTreeFromOIR(&dest, NULL, context, Lwm2mRequestOrigin_Client, OIR, 1));
 
     uint8_t buffer[512];
     // Note: sometimes the encoding order of the last 3 bytes switches position with the previous 3 bytes
@@ -819,7 +819,7 @@ TEST_F(TlvTestSuite, test_multiple_object_instance)
 
     Lwm2mTreeNode * dest;
     int OIR[] = {15};
-    TreeBuilder_CreateTreeFromOIR(&dest, context, Lwm2mRequestOrigin_Client, OIR, 1);
+    TreeBuilder_CreateTreeFromOIR(&dest, NULL, context, Lwm2mRequestOrigin_Client, OIR, 1);
 
     uint8_t buffer[512];
     uint8_t expected[] = { 0x3, 0, 0xc1, 0, 44, 0x3, 1, 0xc1, 0, 55 };
@@ -845,7 +845,7 @@ TEST_F(TlvTestSuite, test_serialise_object_with_two_resources)
 
     Lwm2mTreeNode * dest;
     int OIR[] = {16};
-    TreeBuilder_CreateTreeFromOIR(&dest, context, Lwm2mRequestOrigin_Client, OIR, 1);
+    TreeBuilder_CreateTreeFromOIR(&dest, NULL, context, Lwm2mRequestOrigin_Client, OIR, 1);
 
     uint8_t buffer[512];
     uint8_t expected[] = { 8, 0, 0x28, 0xc8, 0, 34, 'c','o','a','p',':','/','/','b','o','o','t','s','t','r','a','p',
@@ -21,7 +21,6 @@
 ************************************************************************************************************************/
 
 
-#include <poll.h>
 #include <stdio.h>
 #include <getopt.h>
 #include <string.h>
@@ -46,6 +45,7 @@
 #include "dtls_abstraction.h"
 #include "lwm2m_core.h"
 #include "lwm2m_object_defs.h"
+#include "lwm2m_event_loop.h"
 #include "bootstrap/lwm2m_bootstrap.h"
 #include "bootstrap/lwm2m_bootstrap_cert.h"
 #include "bootstrap/lwm2m_bootstrap_psk.h"
@@ -71,6 +71,7 @@ typedef struct
 static FILE * logFile;
 static const char * version = VERSION; /* from Makefile */
 static volatile int quit = 0;
+static EventLoopTimer serviceTimer;
 
 static void PrintOptions(const Options * options);
 
@@ -79,6 +80,22 @@ static void CtrlCSignalHandler(int dummy)
     quit = 1;
 }
 
+// Start any queued bootstraps and run CoAP retransmissions, then sleep until CoAP has more to do
+static void ServiceTimerExpired(EventLoop * loop, void * context)
+{
+    // CoAP first so bootstraps see any responses and timeouts, then again for the requests they sent
+    coap_Process();
+    int timeout = Lwm2mCore_Process((Lwm2mContextType *)context);
+    EventLoop_StartTimer(loop, &serviceTimer, Lwm2mCore_EarliestTimeout(timeout, coap_Process()));
+}
+
+static void CoapReadable(EventLoop * loop, int fd, void * context)
+{
+    coap_HandleMessage();
+    // a bootstrap request queues a client, so service once this wakeup's events are done
+    EventLoop_StartTimer(loop, &serviceTimer, 0);
+}
+
 // Fork off a daemon process, the parent will exit at this point
 static void Daemonise(bool verbose)
 {
@@ -117,6 +134,7 @@ static void Daemonise(bool verbose)
 
 static int Bootstrap_Start(Options * options)
 {
+    EventLoop * eventLoop = NULL;
     int result = 0;
 
     if (options->Daemonise)
@@ -220,43 +238,36 @@ static int Bootstrap_Start(Options * options)
         goto error_destroy;
     }
 
-    // wait for messages on both the IPC and CoAP interfaces
-    while (!quit)
+    // wait for messages on the CoAP interface
+    eventLoop = EventLoop_New();
+    if ((eventLoop == NULL) ||
+        (EventLoop_AddFd(eventLoop, coap->fd, CoapReadable, NULL) != 0) ||
+        ((coap->ipv6fd >= 0) && (EventLoop_AddFd(eventLoop, coap->ipv6fd, CoapReadable, NULL) != 0)))
     {
-        int loop_result;
-        struct pollfd fds[1];
-        int nfds = 1;
-        int timeout;
-
-        fds[0].fd = coap->fd;
-        fds[0].events = POLLIN;
-
-        timeout = Lwm2mCore_Process(context);
-
-        loop_result = poll(fds, nfds, timeout);
+        result = 1;
+        goto error_destroy;
+    }
+    EventLoop_InitTimer(&serviceTimer, ServiceTimerExpired, context);
+    EventLoop_StartTimer(eventLoop, &serviceTimer, 0);
 
-        if (loop_result < 0)
+    while (!quit)
+    {
+        if ((EventLoop_RunOnce(eventLoop, -1) < 0) && (errno != EINTR))
         {
-            if (errno == EINTR)
-            {
-                continue;
-            }
-
-            perror("poll:");
+            perror("epoll_wait:");
             break;
         }
-        else if (loop_result > 0)
-        {
-            if (fds[0].revents == POLLIN)
-            {
-                coap_HandleMessage();
-            }
-        }
-        coap_Process();
     }
     Lwm2m_Debug("Exit triggered\n");
 
 error_destroy:
+    if (eventLoop != NULL)
+    {
+        EventLoopStats stats;
+        EventLoop_GetStats(eventLoop, &stats);
+        Lwm2m_Debug("Event loop: %lu wakeups, %lu fd events, %lu timers run\n", stats.Wakeups, stats.FdEvents, stats.TimersRun);
+        EventLoop_Free(&eventLoop);
+    }
     Lwm2mBootstrap_Destroy();
     Lwm2mCore_Destroy(context);
     coap_Destroy();
@@ -45,6 +45,7 @@ const char *gengetopt_args_info_help[] = {
   "      --pskKey=KEY              Default pre-shared key for DTLS as a hex string",
   "  -c, --certificate=FILE        Load client certificate from FILE",
   "  -t, --defaultContentType=CONTENTTYPE\n                                Default content type to use when a request\n                                  doesn't specify one (TLV=1542, JSON=50)\n                                  (default=`0')",
+  "  -P, --maxPayloadSize=BYTES    Largest CoAP payload in bytes, serialised whole\n                                  and sent in Block2 blocks  (default=`8192')",
   "  -o, --objDefs=FILE            Load object and resource definitions from FILE",
   "  -d, --daemonize               Detach process from terminal and run in the\n                                  background  (default=off)",
   "  -v, --verbose                 Generate verbose output  (default=off)",
@@ -92,6 +93,7 @@ void clear_given (struct gengetopt_args_info *args_info)
   args_info->pskKey_given = 0 ;
   args_info->certificate_given = 0 ;
   args_info->defaultContentType_given = 0 ;
+  args_info->maxPayloadSize_given = 0 ;
   args_info->objDefs_given = 0 ;
   args_info->daemonize_given = 0 ;
   args_info->verbose_given = 0 ;
@@ -124,6 +126,8 @@ void clear_args (struct gengetopt_args_info *args_info)
   args_info->certificate_orig = NULL;
   args_info->defaultContentType_arg = 0;
   args_info->defaultContentType_orig = NULL;
+  args_info->maxPayloadSize_arg = 8192;
+  args_info->maxPayloadSize_orig = NULL;
   args_info->objDefs_arg = NULL;
   args_info->objDefs_orig = NULL;
   args_info->daemonize_flag = 0;
@@ -151,13 +155,14 @@ void init_args_info(struct gengetopt_args_info *args_info)
   args_info->pskKey_help = gengetopt_args_info_help[9] ;
   args_info->certificate_help = gengetopt_args_info_help[10] ;
   args_info->defaultContentType_help = gengetopt_args_info_help[11] ;
-  args_info->objDefs_help = gengetopt_args_info_help[12] ;
+  args_info->maxPayloadSize_help = gengetopt_args_info_help[12] ;
+  args_info->objDefs_help = gengetopt_args_info_help[13] ;
   args_info->objDefs_min = 1;
   args_info->objDefs_max = 16;
-  args_info->daemonize_help = gengetopt_args_info_help[13] ;
-  args_info->verbose_help = gengetopt_args_info_help[14] ;
-  args_info->logFile_help = gengetopt_args_info_help[15] ;
-  args_info->version_help = gengetopt_args_info_help[16] ;
+  args_info->daemonize_help = gengetopt_args_info_help[14] ;
+  args_info->verbose_help = gengetopt_args_info_help[15] ;
+  args_info->logFile_help = gengetopt_args_info_help[16] ;
+  args_info->version_help = gengetopt_args_info_help[17] ;
   
 }
 
@@ -305,6 +310,7 @@ cmdline_parser_release (struct gengetopt_args_info *args_info)
   free_string_field (&(args_info->certificate_arg));
   free_string_field (&(args_info->certificate_orig));
   free_string_field (&(args_info->defaultContentType_orig));
+  free_string_field (&(args_info->maxPayloadSize_orig));
   free_multiple_string_field (args_info->objDefs_given, &(args_info->objDefs_arg), &(args_info->objDefs_orig));
   free_string_field (&(args_info->logFile_arg));
   free_string_field (&(args_info->logFile_orig));
@@ -416,6 +422,8 @@ cmdline_parser_dump(FILE *outfile, struct gengetopt_args_info *args_info)
     write_into_file(outfile, "certificate", args_info->certificate_orig, 0);
   if (args_info->defaultContentType_given)
     write_into_file(outfile, "defaultContentType", args_info->defaultContentType_orig, 0);
+  if (args_info->maxPayloadSize_given)
+    write_into_file(outfile, "maxPayloadSize", args_info->maxPayloadSize_orig, 0);
   write_multiple_into_file(outfile, args_info->objDefs_given, "objDefs", args_info->objDefs_orig, 0);
   if (args_info->daemonize_given)
     write_into_file(outfile, "daemonize", 0, 0 );
@@ -1591,6 +1599,7 @@ cmdline_parser_internal (
         { "pskKey",	1, NULL, 0 },
         { "certificate",	1, NULL, 'c' },
         { "defaultContentType",	1, NULL, 't' },
+        { "maxPayloadSize",	1, NULL, 'P' },
         { "objDefs",	1, NULL, 'o' },
         { "daemonize",	0, NULL, 'd' },
         { "verbose",	0, NULL, 'v' },
@@ -1604,7 +1613,7 @@ cmdline_parser_internal (
       custom_opterr = opterr;
       custom_optopt = optopt;
 
-      c = custom_getopt_long (argc, argv, "hp:a:i:e:b:f:sc:t:o:dvl:V", long_options, &option_index);
+      c = custom_getopt_long (argc, argv, "hp:a:i:e:b:f:sc:t:P:o:dvl:V", long_options, &option_index);
 
       optarg = custom_optarg;
       optind = custom_optind;
@@ -1725,6 +1734,18 @@ cmdline_parser_internal (
               additional_error))
             goto failure;
         
+          break;
+        case 'P':	/* Largest CoAP payload in bytes, serialised whole and sent in Block2 blocks.  */
+
+
+          if (update_arg( (void *)&(args_info->maxPayloadSize_arg),
+                         &(args_info->maxPayloadSize_orig), &(args_info->maxPayloadSize_given),
+                         &(local_args_info.maxPayloadSize_given), optarg, 0, "8192", ARG_INT,
+                         check_ambiguity, override, 0, 0,
+                         "maxPayloadSize", 'P',
+                         additional_error))
+            goto failure;
+
           break;
         case 'o':	/* Load object and resource definitions from FILE.  */
         
@@ -20,7 +20,6 @@
  USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 ************************************************************************************************************************/
 
-#include <poll.h>
 #include <stdio.h>
 #include <getopt.h>
 #include <string.h>
@@ -54,6 +53,7 @@
 #include "lwm2m_client_xml_handlers.h"
 #include "lwm2m_xml_interface.h"
 #include "lwm2m_object_defs.h"
+#include "lwm2m_event_loop.h"
 #include "lwm2m_client_cert.h"
 #include "lwm2m_client_psk.h"
 
@@ -72,6 +72,7 @@ typedef struct
     const char * FactoryBootstrapFile;
     const char * ObjDefsFiles[MAX_OBJDEFS_FILES];
     AwaContentType DefaultContentType;
+    int MaxPayloadSize;
     size_t NumObjDefsFiles;
     bool Daemonise;
     bool Verbose;
@@ -81,6 +82,7 @@ typedef struct
 
 static const char * version = VERSION; // from Makefile
 static volatile int quit = 0;
+static EventLoopTimer serviceTimer;
 
 static uint8_t* LoadCertificateFile(char * certificateFilename);
 static void PrintOptions(const Options * options);
@@ -90,6 +92,33 @@ static void Lwm2m_CtrlCSignalHandler(int dummy)
     quit = 1;
 }
 
+// Run the LWM2M state machine and CoAP retransmissions, then sleep until either has more to do
+static void ServiceTimerExpired(EventLoop * loop, void * context)
+{
+    // CoAP first so the state machine sees any responses and timeouts, then again for the requests it sent
+    coap_Process();
+    int timeout = Lwm2mCore_Process((Lwm2mContextType *)context);
+    EventLoop_StartTimer(loop, &serviceTimer, Lwm2mCore_EarliestTimeout(timeout, coap_Process()));
+}
+
+// Handling a message may have created work, e.g. a changed resource to notify, so service once this wakeup's events are done
+static void ServiceSoon(EventLoop * loop)
+{
+    EventLoop_StartTimer(loop, &serviceTimer, 0);
+}
+
+static void CoapReadable(EventLoop * loop, int fd, void * context)
+{
+    coap_HandleMessage();
+    ServiceSoon(loop);
+}
+
+static void IpcReadable(EventLoop * loop, int fd, void * context)
+{
+    xmlif_process(fd);
+    ServiceSoon(loop);
+}
+
 static void RegisterObjects(Lwm2mContextType * context, Options * options)
 {
     Lwm2m_Debug("Register built-in objects\n");
@@ -228,6 +257,7 @@ static int Lwm2mClient_Start(Options * options)
 
     Lwm2mCore_SetDefaultContentType(options->DefaultContentType);
 
+    coap_SetMaxPayloadSize(options->MaxPayloadSize);
     CoapInfo * coap = coap_Init((options->AddressFamily == AF_INET) ? "0.0.0.0" : "::", options->CoapPort, false /* not a server */, (options->Verbose) ? DebugLevel_Debug : DebugLevel_Info);
     if (coap == NULL)
     {
@@ -320,46 +350,36 @@ static int Lwm2mClient_Start(Options * options)
     xmlif_RegisterHandlers();
 
     // Wait for messages on both the IPC and CoAP interfaces
-    while (!quit)
+    EventLoop * eventLoop = EventLoop_New();
+    if ((eventLoop == NULL) ||
+        (EventLoop_AddFd(eventLoop, coap->fd, CoapReadable, NULL) != 0) ||
+        ((coap->ipv6fd >= 0) && (EventLoop_AddFd(eventLoop, coap->ipv6fd, CoapReadable, NULL) != 0)) ||
+        (EventLoop_AddFd(eventLoop, xmlFd, IpcReadable, NULL) != 0))
     {
-        int loop_result;
-        struct pollfd fds[2];
-        int nfds = 2;
-        int timeout;
-
-        fds[0].fd = coap->fd;
-        fds[0].events = POLLIN;
-
-        fds[1].fd = xmlFd;
-        fds[1].events = POLLIN;
-
-        timeout = Lwm2mCore_Process(context);
+        result = 1;
+        goto error_event_loop;
+    }
+    EventLoop_InitTimer(&serviceTimer, ServiceTimerExpired, context);
+    ServiceSoon(eventLoop);
 
-        loop_result = poll(fds, nfds, timeout);
-        if (loop_result < 0)
+    while (!quit)
+    {
+        if ((EventLoop_RunOnce(eventLoop, -1) < 0) && (errno != EINTR))
         {
-            if (errno == EINTR)
-            {
-                continue;
-            }
-            perror("poll:");
+            perror("epoll_wait:");
             break;
         }
-        else if (loop_result > 0)
-        {
-            if (fds[0].revents == POLLIN)
-            {
-                coap_HandleMessage();
-            }
-            if (fds[1].revents == POLLIN)
-            {
-                xmlif_process(fds[1].fd);
-            }
-        }
-        coap_Process();
     }
     Lwm2m_Debug("Exit triggered\n");
 
+error_event_loop:
+    if (eventLoop != NULL)
+    {
+        EventLoopStats stats;
+        EventLoop_GetStats(eventLoop, &stats);
+        Lwm2m_Debug("Event loop: %lu wakeups, %lu fd events, %lu timers run\n", stats.Wakeups, stats.FdEvents, stats.TimersRun);
+        EventLoop_Free(&eventLoop);
+    }
     xmlif_DestroyExecuteHandlers();
     xmlif_destroy(xmlFd);
 error_core:
@@ -446,6 +466,7 @@ static void PrintOptions(const Options * options)
             printf("\n");
             break;
     }
+    printf("  MaxPayloadSize       (--maxPayloadSize)   : %d\n", options->MaxPayloadSize);
     int i;
     for (i = 0; i < options->NumObjDefsFiles; ++i)
     {
@@ -488,6 +509,7 @@ static int ParseOptions(int argc, char ** argv, struct gengetopt_args_info * ai,
         {
             options->DefaultContentType = (AwaContentType)ai->defaultContentType_arg;
         }
+        options->MaxPayloadSize = ai->maxPayloadSize_arg;
         options->NumObjDefsFiles = ai->objDefs_given;
         options->Daemonise = ai->daemonize_flag;
         options->Verbose = ai->verbose_flag;
@@ -500,6 +522,11 @@ static int ParseOptions(int argc, char ** argv, struct gengetopt_args_info * ai,
             printf("Error: specify a bootstrap option (--bootstrap or --factoryBootstrap) or --version\n\n");
             result = EXIT_FAILURE;
         }
+        if (options->MaxPayloadSize <= 0)
+        {
+            printf("Error: --maxPayloadSize must be positive\n\n");
+            result = EXIT_FAILURE;
+        }
     }
     else
     {
@@ -524,6 +551,7 @@ int main(int argc, char ** argv)
         .CertificateFile = NULL,
         .FactoryBootstrapFile = NULL,
         .DefaultContentType = AwaContentType_ApplicationPlainText,
+        .MaxPayloadSize = COAP_MAX_PAYLOAD_SIZE,
         .ObjDefsFiles = {0},
         .NumObjDefsFiles = 0,
         .Daemonise = false,
@@ -438,8 +438,10 @@ static AwaError AddResourceToGetResponse(Lwm2mContextType * context, int objectI
     AwaError result = AwaError_Success;
     if (Definition_IsTypeMultiInstance(Lwm2mCore_GetDefinitions(context), objectID, resourceID))
     {
-        int resourceInstanceID = -1;
-        while ((resourceInstanceID = Lwm2mCore_GetNextResourceInstanceID(context, objectID, instanceID, resourceID, resourceInstanceID)) != -1)
+        Lwm2mCoreIterator iterator;
+        int resourceInstanceID;
+        Lwm2mCore_InitIterator(context, &iterator, objectID, instanceID, resourceID);
+        while ((resourceInstanceID = Lwm2mCore_IteratorNext(&iterator)) != -1)
         {
             if (((idRangeStart != -1) && (idRangeStart > resourceInstanceID)) ||
                 ((idRangeEndExclusive != -1) && (idRangeEndExclusive <= resourceInstanceID)))
@@ -463,9 +465,11 @@ static AwaError AddResourceToGetResponse(Lwm2mContextType * context, int objectI
 static AwaError AddResourcesToGetResponse(Lwm2mContextType * context, int objectID, int instanceID, TreeNode responseObjectInstanceNode)
 {
     AwaError result = AwaError_Success;
-    int resourceID = -1;
+    Lwm2mCoreIterator iterator;
+    int resourceID;
 
-    while ((resourceID = Lwm2mCore_GetNextResourceID(context, objectID, instanceID, resourceID)) != -1)
+    Lwm2mCore_InitIterator(context, &iterator, objectID, instanceID, -1);
+    while ((resourceID = Lwm2mCore_IteratorNext(&iterator)) != -1)
     {
         TreeNode responseResourceNode = ObjectsTree_FindOrCreateChildNode(responseObjectInstanceNode, "Resource", resourceID);
         if ((result = AddResourceToGetResponse(context, objectID, instanceID, resourceID, responseResourceNode, -1, -1)) != AwaError_Success)
@@ -479,9 +483,11 @@ static AwaError AddResourcesToGetResponse(Lwm2mContextType * context, int object
 static AwaError AddObjectInstancesToGetResponse(Lwm2mContextType * context, int objectID, TreeNode responseObjectNode)
 {
     AwaError result = AwaError_Success;
-    int instanceID = -1;
+    Lwm2mCoreIterator iterator;
+    int instanceID;
 
-    while ((instanceID = Lwm2mCore_GetNextObjectInstanceID(context, objectID, instanceID)) != -1)
+    Lwm2mCore_InitIterator(context, &iterator, objectID, -1, -1);
+    while ((instanceID = Lwm2mCore_IteratorNext(&iterator)) != -1)
     {
         TreeNode responseObjectInstanceNode = ObjectsTree_FindOrCreateChildNode(responseObjectNode, "ObjectInstance", instanceID);
         if ((result = AddResourcesToGetResponse(context, objectID, instanceID, responseObjectInstanceNode)) != AwaError_Success)
@@ -569,9 +575,9 @@ error:
     return result;
 }
 
-static Lwm2mTreeNode * xmlif_xmlObjectToLwm2mObject(Lwm2mContextType * context, const TreeNode xmlObjectNode, bool readValues)
+static Lwm2mTreeNode * xmlif_xmlObjectToLwm2mObject(Lwm2mContextType * context, MemoryArena * arena, const TreeNode xmlObjectNode, bool readValues)
 {
-    Lwm2mTreeNode * objectNode = Lwm2mTreeNode_Create();
+    Lwm2mTreeNode * objectNode = Lwm2mTreeNode_CreateInArena(arena);
     Lwm2mTreeNode_SetType(objectNode, Lwm2mTreeNodeType_Object);
     int objectID = xmlif_GetInteger(xmlObjectNode, "Object/ID");
     Lwm2mTreeNode_SetCreateFlag(objectNode, Xml_Find(xmlObjectNode, "Create"));
@@ -599,7 +605,7 @@ static Lwm2mTreeNode * xmlif_xmlObjectToLwm2mObject(Lwm2mContextType * context,
                 goto error;
             }
 
-            Lwm2mTreeNode * objectInstanceNode = Lwm2mTreeNode_Create();
+            Lwm2mTreeNode * objectInstanceNode = Lwm2mTreeNode_CreateInArena(arena);
             if (instanceID != -1)
             {
                 Lwm2mTreeNode_SetID(objectInstanceNode, (uint16_t)instanceID);
@@ -625,7 +631,7 @@ static Lwm2mTreeNode * xmlif_xmlObjectToLwm2mObject(Lwm2mContextType * context,
                         goto error;
                     }
 
-                    Lwm2mTreeNode * resourceNode = Lwm2mTreeNode_Create();
+                    Lwm2mTreeNode * resourceNode = Lwm2mTreeNode_CreateInArena(arena);
                     Lwm2mTreeNode_SetID(resourceNode, resourceID);
                     Lwm2mTreeNode_SetType(resourceNode, Lwm2mTreeNodeType_Resource);
                     Lwm2mTreeNode_SetCreateFlag(resourceNode, createOptionalResource);
@@ -639,7 +645,7 @@ static Lwm2mTreeNode * xmlif_xmlObjectToLwm2mObject(Lwm2mContextType * context,
                         if (!IS_MULTIPLE_INSTANCE(resourceDefinition))
                         {
                             uint16_t resourceInstanceID = 0;
-                            Lwm2mTreeNode * resourceInstanceNode = Lwm2mTreeNode_Create();
+                            Lwm2mTreeNode * resourceInstanceNode = Lwm2mTreeNode_CreateInArena(arena);
                             Lwm2mTreeNode_SetID(resourceInstanceNode, resourceInstanceID);
                             Lwm2mTreeNode_SetType(resourceInstanceNode, Lwm2mTreeNodeType_ResourceInstance);
 
@@ -705,7 +711,7 @@ static Lwm2mTreeNode * xmlif_xmlObjectToLwm2mObject(Lwm2mContextType * context,
                                 if (readValues)
                                 {
                                     int valueID = xmlif_GetInteger(xmlResourceInstanceNode, "ResourceInstance/ID");
-                                    Lwm2mTreeNode * resourceInstanceNode = Lwm2mTreeNode_Create();
+                                    Lwm2mTreeNode * resourceInstanceNode = Lwm2mTreeNode_CreateInArena(arena);
                                     Lwm2mTreeNode_SetID(resourceInstanceNode, valueID);
                                     Lwm2mTreeNode_SetType(resourceInstanceNode, Lwm2mTreeNodeType_ResourceInstance);
 
@@ -774,13 +780,17 @@ static int xmlif_HandlerSetRequest(RequestInfoType * request, TreeNode content)
     Lwm2mContextType * context = (Lwm2mContextType *)request->Context;
     TreeNode requestObjectsNode = TreeNode_Navigate(content, "Content/Objects");
     TreeNode responseObjectsTree = ObjectsTree_New();
+    uint8_t arenaBlock[LWM2M_TREE_ARENA_INITIAL_SIZE];
+    MemoryArena arena;
+
+    MemoryArena_Init(&arena, arenaBlock, sizeof(arenaBlock), LWM2M_TREE_ARENA_BLOCK_SIZE);
 
     TreeNode requestObjectNode = NULL;
     int objectIndex = 0;
     while ((requestObjectNode = TreeNode_GetChild(requestObjectsNode, objectIndex++)) != NULL)
     {
         // convert to Object Lwm2mTreeNode so we can check permissions / write as a single entity.
-        Lwm2mTreeNode * object = xmlif_xmlObjectToLwm2mObject(context, requestObjectNode, true);
+        Lwm2mTreeNode * object = xmlif_xmlObjectToLwm2mObject(context, &arena, requestObjectNode, true);
 
         if (object != NULL)
         {
@@ -846,7 +856,6 @@ static int xmlif_HandlerSetRequest(RequestInfoType * request, TreeNode content)
                 }
                 IPC_AddResultTag(responseObjectNode, objectError);
             }
-            Lwm2mTreeNode_DeleteRecursive(object);
         }
         else
         {
@@ -857,6 +866,7 @@ static int xmlif_HandlerSetRequest(RequestInfoType * request, TreeNode content)
     }
 
 error:
+    MemoryArena_Destroy(&arena);
     xmlif_GenerateResponse(request, NULL, NULL, result, IPC_MESSAGE_SUB_TYPE_SET, responseObjectsTree);
     return result;
 }
@@ -41,6 +41,9 @@ const char *gengetopt_args_info_help[] = {
   "  -i, --ipcPort=PORT      Use port number PORT for IPC communications\n                            (default=`54321')",
   "  -m, --contentType=ID    Use Content Type ID (TLV=1542, JSON=50)  (possible\n                            values=\"50\", \"1542\" default=`1542')",
   "  -s, --secure            CoAP communications are secured with DTLS\n                            (default=off)",
+  "  -k, --pskFile=FILE      Load DTLS pre-shared keys from FILE, reloaded on\n                            SIGHUP",
+  "  -w, --dtlsWorkers=N     Run DTLS handshakes on N worker threads (0 runs them\n                            in the main loop)  (default=`0')",
+  "  -P, --maxPayloadSize=BYTES\n                          Largest CoAP payload in bytes, serialised whole\n                            and sent in Block2 blocks  (default=`8192')",
   "  -o, --objDefs=FILE      Load object and resource definitions from FILE",
   "  -d, --daemonize         Detach process from terminal and run in the\n                            background  (default=off)",
   "  -v, --verbose           Generate verbose output  (default=off)",
@@ -85,6 +88,9 @@ void clear_given (struct gengetopt_args_info *args_info)
   args_info->ipcPort_given = 0 ;
   args_info->contentType_given = 0 ;
   args_info->secure_given = 0 ;
+  args_info->pskFile_given = 0 ;
+  args_info->dtlsWorkers_given = 0 ;
+  args_info->maxPayloadSize_given = 0 ;
   args_info->objDefs_given = 0 ;
   args_info->daemonize_given = 0 ;
   args_info->verbose_given = 0 ;
@@ -109,6 +115,12 @@ void clear_args (struct gengetopt_args_info *args_info)
   args_info->contentType_arg = 1542;
   args_info->contentType_orig = NULL;
   args_info->secure_flag = 0;
+  args_info->pskFile_arg = NULL;
+  args_info->pskFile_orig = NULL;
+  args_info->dtlsWorkers_arg = 0;
+  args_info->dtlsWorkers_orig = NULL;
+  args_info->maxPayloadSize_arg = 8192;
+  args_info->maxPayloadSize_orig = NULL;
   args_info->objDefs_arg = NULL;
   args_info->objDefs_orig = NULL;
   args_info->daemonize_flag = 0;
@@ -132,13 +144,16 @@ void init_args_info(struct gengetopt_args_info *args_info)
   args_info->ipcPort_help = gengetopt_args_info_help[5] ;
   args_info->contentType_help = gengetopt_args_info_help[6] ;
   args_info->secure_help = gengetopt_args_info_help[7] ;
-  args_info->objDefs_help = gengetopt_args_info_help[8] ;
+  args_info->pskFile_help = gengetopt_args_info_help[8] ;
+  args_info->dtlsWorkers_help = gengetopt_args_info_help[9] ;
+  args_info->maxPayloadSize_help = gengetopt_args_info_help[10] ;
+  args_info->objDefs_help = gengetopt_args_info_help[11] ;
   args_info->objDefs_min = 1;
   args_info->objDefs_max = 16;
-  args_info->daemonize_help = gengetopt_args_info_help[9] ;
-  args_info->verbose_help = gengetopt_args_info_help[10] ;
-  args_info->logFile_help = gengetopt_args_info_help[11] ;
-  args_info->version_help = gengetopt_args_info_help[12] ;
+  args_info->daemonize_help = gengetopt_args_info_help[12] ;
+  args_info->verbose_help = gengetopt_args_info_help[13] ;
+  args_info->logFile_help = gengetopt_args_info_help[14] ;
+  args_info->version_help = gengetopt_args_info_help[15] ;
 
 }
 
@@ -278,6 +293,10 @@ cmdline_parser_release (struct gengetopt_args_info *args_info)
   free_string_field (&(args_info->port_orig));
   free_string_field (&(args_info->ipcPort_orig));
   free_string_field (&(args_info->contentType_orig));
+  free_string_field (&(args_info->pskFile_arg));
+  free_string_field (&(args_info->pskFile_orig));
+  free_string_field (&(args_info->dtlsWorkers_orig));
+  free_string_field (&(args_info->maxPayloadSize_orig));
   free_multiple_string_field (args_info->objDefs_given, &(args_info->objDefs_arg), &(args_info->objDefs_orig));
   free_string_field (&(args_info->logFile_arg));
   free_string_field (&(args_info->logFile_orig));
@@ -381,6 +400,12 @@ cmdline_parser_dump(FILE *outfile, struct gengetopt_args_info *args_info)
     write_into_file(outfile, "contentType", args_info->contentType_orig, cmdline_parser_contentType_values);
   if (args_info->secure_given)
     write_into_file(outfile, "secure", 0, 0 );
+  if (args_info->pskFile_given)
+    write_into_file(outfile, "pskFile", args_info->pskFile_orig, 0);
+  if (args_info->dtlsWorkers_given)
+    write_into_file(outfile, "dtlsWorkers", args_info->dtlsWorkers_orig, 0);
+  if (args_info->maxPayloadSize_given)
+    write_into_file(outfile, "maxPayloadSize", args_info->maxPayloadSize_orig, 0);
   write_multiple_into_file(outfile, args_info->objDefs_given, "objDefs", args_info->objDefs_orig, 0);
   if (args_info->daemonize_given)
     write_into_file(outfile, "daemonize", 0, 0 );
@@ -1552,6 +1577,9 @@ cmdline_parser_internal (
         { "ipcPort",	1, NULL, 'i' },
         { "contentType",	1, NULL, 'm' },
         { "secure",	0, NULL, 's' },
+        { "pskFile",	1, NULL, 'k' },
+        { "dtlsWorkers",	1, NULL, 'w' },
+        { "maxPayloadSize",	1, NULL, 'P' },
         { "objDefs",	1, NULL, 'o' },
         { "daemonize",	0, NULL, 'd' },
         { "verbose",	0, NULL, 'v' },
@@ -1565,7 +1593,7 @@ cmdline_parser_internal (
       custom_opterr = opterr;
       custom_optopt = optopt;
 
-      c = custom_getopt_long (argc, argv, "ha:e:f:p:i:m:so:dvl:V", long_options, &option_index);
+      c = custom_getopt_long (argc, argv, "ha:e:f:p:i:m:sk:w:P:o:dvl:V", long_options, &option_index);
 
       optarg = custom_optarg;
       optind = custom_optind;
@@ -1662,6 +1690,42 @@ cmdline_parser_internal (
                          additional_error))
             goto failure;
 
+          break;
+        case 'k':	/* Load DTLS pre-shared keys from FILE, reloaded on SIGHUP.  */
+
+
+          if (update_arg( (void *)&(args_info->pskFile_arg),
+                         &(args_info->pskFile_orig), &(args_info->pskFile_given),
+                         &(local_args_info.pskFile_given), optarg, 0, 0, ARG_STRING,
+                         check_ambiguity, override, 0, 0,
+                         "pskFile", 'k',
+                         additional_error))
+            goto failure;
+
+          break;
+        case 'w':	/* Run DTLS handshakes on N worker threads (0 runs them in the main loop).  */
+
+
+          if (update_arg( (void *)&(args_info->dtlsWorkers_arg),
+                         &(args_info->dtlsWorkers_orig), &(args_info->dtlsWorkers_given),
+                         &(local_args_info.dtlsWorkers_given), optarg, 0, "0", ARG_INT,
+                         check_ambiguity, override, 0, 0,
+                         "dtlsWorkers", 'w',
+                         additional_error))
+            goto failure;
+
+          break;
+        case 'P':	/* Largest CoAP payload in bytes, serialised whole and sent in Block2 blocks.  */
+
+
+          if (update_arg( (void *)&(args_info->maxPayloadSize_arg),
+                         &(args_info->maxPayloadSize_orig), &(args_info->maxPayloadSize_given),
+                         &(local_args_info.maxPayloadSize_given), optarg, 0, "8192", ARG_INT,
+                         check_ambiguity, override, 0, 0,
+                         "maxPayloadSize", 'P',
+                         additional_error))
+            goto failure;
+
           break;
         case 'o':	/* Load object and resource definitions from FILE.  */
 
@@ -58,6 +58,15 @@ struct gengetopt_args_info
   const char *contentType_help; /**< @brief Use Content Type ID (TLV=1542, JSON=50) help description.  */
   int secure_flag;	/**< @brief CoAP communications are secured with DTLS (default=off).  */
   const char *secure_help; /**< @brief CoAP communications are secured with DTLS help description.  */
+  char * pskFile_arg;	/**< @brief Load DTLS pre-shared keys from FILE, reloaded on SIGHUP.  */
+  char * pskFile_orig;	/**< @brief Load DTLS pre-shared keys from FILE, reloaded on SIGHUP original value given at command line.  */
+  const char *pskFile_help; /**< @brief Load DTLS pre-shared keys from FILE, reloaded on SIGHUP help description.  */
+  int dtlsWorkers_arg;	/**< @brief Run DTLS handshakes on N worker threads (0 runs them in the main loop) (default='0').  */
+  char * dtlsWorkers_orig;	/**< @brief Run DTLS handshakes on N worker threads (0 runs them in the main loop) original value given at command line.  */
+  const char *dtlsWorkers_help; /**< @brief Run DTLS handshakes on N worker threads (0 runs them in the main loop) help description.  */
+  int maxPayloadSize_arg;	/**< @brief Largest CoAP payload in bytes, serialised whole and sent in Block2 blocks (default='8192').  */
+  char * maxPayloadSize_orig;	/**< @brief Largest CoAP payload in bytes, serialised whole and sent in Block2 blocks original value given at command line.  */
+  const char *maxPayloadSize_help; /**< @brief Largest CoAP payload in bytes, serialised whole and sent in Block2 blocks help description.  */
   char ** objDefs_arg;	/**< @brief Load object and resource definitions from FILE.  */
   char ** objDefs_orig;	/**< @brief Load object and resource definitions from FILE original value given at command line.  */
   unsigned int objDefs_min; /**< @brief Load object and resource definitions from FILE's minimum occurreces */
@@ -81,6 +90,9 @@ struct gengetopt_args_info
   unsigned int ipcPort_given ;	/**< @brief Whether ipcPort was given.  */
   unsigned int contentType_given ;	/**< @brief Whether contentType was given.  */
   unsigned int secure_given ;	/**< @brief Whether secure was given.  */
+  unsigned int pskFile_given ;	/**< @brief Whether pskFile was given.  */
+  unsigned int dtlsWorkers_given ;	/**< @brief Whether dtlsWorkers was given.  */
+  unsigned int maxPayloadSize_given ;	/**< @brief Whether maxPayloadSize was given.  */
   unsigned int objDefs_given ;	/**< @brief Whether objDefs was given.  */
   unsigned int daemonize_given ;	/**< @brief Whether daemonize was given.  */
   unsigned int verbose_given ;	/**< @brief Whether verbose was given.  */
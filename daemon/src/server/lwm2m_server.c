@@ -20,7 +20,6 @@
  USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 ************************************************************************************************************************/
 
-#include <poll.h>
 #include <stdio.h>
 #include <getopt.h>
 #include <string.h>
@@ -50,6 +49,7 @@
 #include "lwm2m_serdes.h"
 #include "lwm2m_object_defs.h"
 #include "lwm2m_core.h"
+#include "lwm2m_event_loop.h"
 #include "lwm2m_server_cert.h"
 #include "lwm2m_server_psk.h"
 
@@ -65,6 +65,9 @@ typedef struct
     int IpcPort;
     int ContentType;
     bool Secure;
+    char * PskFile;
+    int DtlsWorkers;
+    int MaxPayloadSize;
     const char * ObjDefsFiles[MAX_OBJDEFS_FILES];
     size_t NumObjDefsFiles;
     bool Daemonise;
@@ -76,6 +79,9 @@ typedef struct
 static FILE * logFile = NULL;
 static const char * version = VERSION;  // from Makefile
 static volatile int quit = 0;
+static volatile int reloadKeys = 0;
+static DTLS_PSKKeystore * pskKeystore = NULL;
+static EventLoopTimer serviceTimer;
 
 static void PrintOptions(const Options * options);
 
@@ -84,6 +90,65 @@ static void Lwm2m_CtrlCSignalHandler(int dummy)
     quit = 1;
 }
 
+static void Lwm2m_HangupSignalHandler(int dummy)
+{
+    reloadKeys = 1;
+}
+
+// Run the LWM2M state machine and CoAP retransmissions, then sleep until either has more to do
+static void ServiceTimerExpired(EventLoop * loop, void * context)
+{
+    // CoAP first so the state machine sees any responses and timeouts, then again for the requests it sent
+    coap_Process();
+    int timeout = Lwm2mCore_Process((Lwm2mContextType *)context);
+    EventLoop_StartTimer(loop, &serviceTimer, Lwm2mCore_EarliestTimeout(timeout, coap_Process()));
+}
+
+// Handling a message may have created work, so service once this wakeup's events are done
+static void ServiceSoon(EventLoop * loop)
+{
+    EventLoop_StartTimer(loop, &serviceTimer, 0);
+}
+
+static void CoapReadable(EventLoop * loop, int fd, void * context)
+{
+    coap_HandleMessage();
+    ServiceSoon(loop);
+}
+
+static void IpcReadable(EventLoop * loop, int fd, void * context)
+{
+    xmlif_process(fd);
+    ServiceSoon(loop);
+}
+
+static void HandshakesFinished(EventLoop * loop, int fd, void * context)
+{
+    // finished handshakes may have released records for CoAP to read
+    int waiting = DTLS_ProcessHandshakes();
+    while (waiting-- > 0)
+    {
+        coap_HandleMessage();
+    }
+    ServiceSoon(loop);
+}
+
+// Replace the PSK keystore with a fresh load of the key file. The old keystore is kept if the file can't be read.
+static void ReloadPSKKeystore(const char * path)
+{
+    DTLS_PSKKeystore * keystore = DTLS_PSKKeystore_Load(path);
+    if (keystore != NULL)
+    {
+        DTLS_SetPSKKeystore(keystore);
+        DTLS_PSKKeystore_Free(&pskKeystore);
+        pskKeystore = keystore;
+    }
+    else
+    {
+        Lwm2m_Error("Failed to load PSK file %s\n", path);
+    }
+}
+
 // Fork off a daemon process, the parent will exit at this point
 static void Daemonise(bool verbose)
 {
@@ -123,6 +188,7 @@ static void Daemonise(bool verbose)
 static int Lwm2mServer_Start(Options * options)
 {
     int xmlFd;
+    EventLoop * eventLoop = NULL;
     int result = 0;
 
     if (options->Daemonise)
@@ -201,6 +267,7 @@ static int Lwm2mServer_Start(Options * options)
 
     srandom((int)time(NULL)*getpid());
 
+    coap_SetMaxPayloadSize(options->MaxPayloadSize);
     CoapInfo * coap = coap_Init(ipAddress, options->CoapPort, options->Secure, (options->Verbose) ? DebugLevel_Debug : DebugLevel_Info);
     if (coap == NULL)
     {
@@ -212,8 +279,18 @@ static int Lwm2mServer_Start(Options * options)
     if (options->Secure)
     {
     	coap_SetCertificate(serverCert, sizeof(serverCert), AwaCertificateFormat_PEM);
-        coap_SetPSK(pskIdentity, pskKey, sizeof(pskKey));
+        if (options->PskFile != NULL)
+        {
+            // only the per-device keys are accepted, never the built-in default
+            ReloadPSKKeystore(options->PskFile);
+            signal(SIGHUP, Lwm2m_HangupSignalHandler);
+        }
+        else
+        {
+            coap_SetPSK(pskIdentity, pskKey, sizeof(pskKey));
+        }
     }
+    int handshakeFd = options->Secure ? DTLS_SetHandshakeWorkers(options->DtlsWorkers) : -1;
 
     Lwm2mContextType * context = Lwm2mCore_Init(NULL, options->ContentType);  // NULL, don't map coap with objectStore
 
@@ -235,52 +312,50 @@ static int Lwm2mServer_Start(Options * options)
     }
     xmlif_RegisterHandlers();
 
-    // wait for messages on both the IPC and CoAP interfaces
-    while (!quit)
+    // wait for messages on the IPC and CoAP interfaces and for finished DTLS handshakes
+    eventLoop = EventLoop_New();
+    if ((eventLoop == NULL) ||
+        (EventLoop_AddFd(eventLoop, coap->fd, CoapReadable, NULL) != 0) ||
+        ((coap->ipv6fd >= 0) && (EventLoop_AddFd(eventLoop, coap->ipv6fd, CoapReadable, NULL) != 0)) ||
+        (EventLoop_AddFd(eventLoop, xmlFd, IpcReadable, NULL) != 0) ||
+        ((handshakeFd >= 0) && (EventLoop_AddFd(eventLoop, handshakeFd, HandshakesFinished, NULL) != 0)))
     {
-        int loop_result;
-        struct pollfd fds[2];
-        int nfds = 2;
-        int timeout;
-
-        fds[0].fd = coap->fd;
-        fds[0].events = POLLIN;
-
-        fds[1].fd = xmlFd;
-        fds[1].events = POLLIN;
-
-        timeout = Lwm2mCore_Process(context);
-
-        loop_result = poll(fds, nfds, timeout);
+        result = 1;
+        goto error_destroy;
+    }
+    EventLoop_InitTimer(&serviceTimer, ServiceTimerExpired, context);
+    ServiceSoon(eventLoop);
 
-        if (loop_result < 0)
+    while (!quit)
+    {
+        if (reloadKeys)
         {
-            if (errno == EINTR)
-            {
-                continue;
-            }
-            perror("poll:");
-            break;
+            reloadKeys = 0;
+            ReloadPSKKeystore(options->PskFile);
         }
-        else if (loop_result > 0)
+
+        if ((EventLoop_RunOnce(eventLoop, -1) < 0) && (errno != EINTR))
         {
-            if (fds[0].revents == POLLIN)
-            {
-                coap_HandleMessage();
-            }
-            if (fds[1].revents == POLLIN)
-            {
-                xmlif_process(fds[1].fd);
-            }
+            perror("epoll_wait:");
+            break;
         }
-        coap_Process();
     }
     Lwm2m_Debug("Exit triggered\n");
 
 error_destroy:
+    if (eventLoop != NULL)
+    {
+        EventLoopStats stats;
+        EventLoop_GetStats(eventLoop, &stats);
+        Lwm2m_Debug("Event loop: %lu wakeups, %lu fd events, %lu timers run\n", stats.Wakeups, stats.FdEvents, stats.TimersRun);
+        EventLoop_Free(&eventLoop);
+    }
     xmlif_destroy(xmlFd);
     Lwm2mCore_Destroy(context);
+    DTLS_SetHandshakeWorkers(0);
     coap_Destroy();
+    DTLS_SetPSKKeystore(NULL);
+    DTLS_PSKKeystore_Free(&pskKeystore);
 
 error_close_log:
     Lwm2m_Info("Server exiting\n");
@@ -302,6 +377,9 @@ static void PrintOptions(const Options * options)
     printf("  IpcPort           (--ipcPort)        : %d\n", options->IpcPort);
     printf("  ContentType       (--content)        : %d\n", options->ContentType);
     printf("  Secure            (--secure)         : %d\n", options->Secure);
+    printf("  PskFile           (--pskFile)        : %s\n", options->PskFile ? options->PskFile : "");
+    printf("  DtlsWorkers       (--dtlsWorkers)    : %d\n", options->DtlsWorkers);
+    printf("  MaxPayloadSize    (--maxPayloadSize) : %d\n", options->MaxPayloadSize);
     int i;
     for (i = 0; i < options->NumObjDefsFiles; ++i)
     {
@@ -325,6 +403,9 @@ static int ParseOptions(int argc, char ** argv, struct gengetopt_args_info * ai,
         options->IpcPort = ai->ipcPort_arg;
         options->ContentType = ai->contentType_arg;
         options->Secure = ai->secure_flag;
+        options->PskFile = ai->pskFile_arg;
+        options->DtlsWorkers = ai->dtlsWorkers_arg;
+        options->MaxPayloadSize = ai->maxPayloadSize_arg;
         int i;
         for (i = 0; i < ai->objDefs_given; ++i)
         {
@@ -341,6 +422,11 @@ static int ParseOptions(int argc, char ** argv, struct gengetopt_args_info * ai,
             printf("Error: not built with DTLS support\n\n");
             result = EXIT_FAILURE;
         }
+        if (options->MaxPayloadSize <= 0)
+        {
+            printf("Error: --maxPayloadSize must be positive\n\n");
+            result = EXIT_FAILURE;
+        }
     }
     else
     {
@@ -362,6 +448,9 @@ int main(int argc, char ** argv)
         .IpcPort = 0,
         .ContentType = 0,
         .Secure = false,
+        .PskFile = NULL,
+        .DtlsWorkers = 0,
+        .MaxPayloadSize = COAP_MAX_PAYLOAD_SIZE,
         .ObjDefsFiles = {0},
         .NumObjDefsFiles = 0,
         .Daemonise = false,
@@ -994,20 +994,24 @@ static void xmlif_HandlerSuccessfulReadResponse(IpcCoapRequestContext * requestC
     Lwm2mContextType * context = (Lwm2mContextType *)request->Context;
     ObjectInstanceResourceKey key = UriToOir(responsePath);
     Lwm2mTreeNode * root = NULL;
+    uint8_t arenaBlock[LWM2M_TREE_ARENA_INITIAL_SIZE];
+    MemoryArena arena;
+
+    MemoryArena_Init(&arena, arenaBlock, sizeof(arenaBlock), LWM2M_TREE_ARENA_BLOCK_SIZE);
 
     int len;
 
     if (key.ResourceID != -1)
     {
-        len = DeserialiseResource(contentType, &root, Lwm2mCore_GetDefinitions(context), key.ObjectID, key.InstanceID, key.ResourceID, payload, payloadLen);
+        len = DeserialiseResource(contentType, &root, &arena, Lwm2mCore_GetDefinitions(context), key.ObjectID, key.InstanceID, key.ResourceID, payload, payloadLen);
     }
     else if (key.InstanceID != -1)
     {
-        len = DeserialiseObjectInstance(contentType, &root, Lwm2mCore_GetDefinitions(context), key.ObjectID, key.InstanceID, payload, payloadLen);
+        len = DeserialiseObjectInstance(contentType, &root, &arena, Lwm2mCore_GetDefinitions(context), key.ObjectID, key.InstanceID, payload, payloadLen);
     }
     else
     {
-        len = DeserialiseObject(contentType, &root, Lwm2mCore_GetDefinitions(context), key.ObjectID, payload, payloadLen);
+        len = DeserialiseObject(contentType, &root, &arena, Lwm2mCore_GetDefinitions(context), key.ObjectID, payload, payloadLen);
     }
 
     if (len >= 0)
@@ -1051,7 +1055,7 @@ static void xmlif_HandlerSuccessfulReadResponse(IpcCoapRequestContext * requestC
         }
     }
 
-    Lwm2mTreeNode_DeleteRecursive(root);
+    MemoryArena_Destroy(&arena);
 }
 
 static int xmlif_HandlerObserveRequest(RequestInfoType * request, TreeNode content)
@@ -1483,6 +1487,10 @@ static int xmlif_HandlerWriteRequest(RequestInfoType * request, TreeNode content
     Lwm2mClientType * client;
     int numCoapRequests = 0;
     Lwm2mTreeNode * root = NULL;
+    uint8_t arenaBlock[LWM2M_TREE_ARENA_INITIAL_SIZE];
+    MemoryArena arena;
+
+    MemoryArena_Init(&arena, arenaBlock, sizeof(arenaBlock), LWM2M_TREE_ARENA_BLOCK_SIZE);
 
     if (xmlif_HandleRequestHeader(request, content, &requestContext, &requestObjectsNode, &client) != 0)
     {
@@ -1503,7 +1511,7 @@ static int xmlif_HandlerWriteRequest(RequestInfoType * request, TreeNode content
         goto error;
     }
 
-    root = Lwm2mTreeNode_Create();
+    root = Lwm2mTreeNode_CreateInArena(&arena);
     Lwm2mTreeNode_SetType(root, Lwm2mTreeNodeType_Root);
 
     // Read each leaf node and if it is valid place its value in the internal tree to serialize
@@ -1600,7 +1608,7 @@ static int xmlif_HandlerWriteRequest(RequestInfoType * request, TreeNode content
                         {
                             // add the value within a resource instance because the core still treats
                             // single instance resources as a resource with a single resource instance.
-                            Lwm2mTreeNode * resourceInstanceNode = Lwm2mTreeNode_Create();
+                            Lwm2mTreeNode * resourceInstanceNode = Lwm2mTreeNode_CreateInArena(&arena);
                             int resourceInstanceID = 0;
                             Lwm2mTreeNode_SetID(resourceInstanceNode, resourceInstanceID);
                             Lwm2mTreeNode_SetType(resourceInstanceNode, Lwm2mTreeNodeType_ResourceInstance);
@@ -1636,7 +1644,7 @@ static int xmlif_HandlerWriteRequest(RequestInfoType * request, TreeNode content
                             TreeNode valueNode = NULL;
                             if ((valueNode = Xml_Find(requestResourceInstance, "Value")) != NULL) // resourceNode.hasChild("Value")
                             {
-                                Lwm2mTreeNode * resourceInstanceNode = Lwm2mTreeNode_Create();
+                                Lwm2mTreeNode * resourceInstanceNode = Lwm2mTreeNode_CreateInArena(&arena);
                                 Lwm2mTreeNode_SetID(resourceInstanceNode, resourceInstanceID);
                                 Lwm2mTreeNode_SetType(resourceInstanceNode, Lwm2mTreeNodeType_ResourceInstance);
                                 Lwm2mTreeNode_AddChild(resourceNode, resourceInstanceNode);
@@ -1777,7 +1785,9 @@ static int xmlif_HandlerWriteRequest(RequestInfoType * request, TreeNode content
     }
 
 error:
+    // Frees the default values xmlif_AddDefaultsForMissingMandatoryValues added to the tree on the heap
     Lwm2mTreeNode_DeleteRecursive(root);
+    MemoryArena_Destroy(&arena);
     return xmlif_HandleError(requestContext, client, xmlif_HandlerWriteResponse, numCoapRequests);
 }
 
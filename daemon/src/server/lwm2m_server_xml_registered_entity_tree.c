@@ -32,13 +32,11 @@ TreeNode BuildRegisteredEntityTree(const Lwm2mClientType * client)
     TreeNode objectsTree = ObjectsTree_New();
 
     // build object/instance list
-    struct ListHead * j;
-    ListForEach(j, &client->ObjectList)
+    size_t j;
+    for (j = 0; j < ObjectList_GetCount(&client->Objects); j++)
     {
-        ObjectListEntry * entry = ListEntry(j, ObjectListEntry, list);
-
         char path[MAX_PATH_LENGTH] = { 0 };
-        if (Path_MakePath(path, MAX_PATH_LENGTH, entry->ObjectID, entry->InstanceID, AWA_INVALID_ID) == AwaError_Success)
+        if (Path_MakePath(path, MAX_PATH_LENGTH, ObjectList_GetObjectID(&client->Objects, j), ObjectList_GetInstanceID(&client->Objects, j), AWA_INVALID_ID) == AwaError_Success)
         {
             ObjectsTree_AddPath(objectsTree, path, NULL);
         }